@@ -97,6 +97,7 @@ protected:
     bool _isBinary;
     bool lazy;
     bool omitTermFreqAndPositions;
+    DocValuesType docValuesType;
     double boost;
 
     // the data object for all different kind of field values
@@ -202,6 +203,16 @@ public:
     /// to find results.
     virtual void setOmitTermFreqAndPositions(bool omitTermFreqAndPositions);
 
+    /// @see #setDocValuesType
+    virtual DocValuesType getDocValuesType();
+
+    /// Sets how the value of this field is written to the doc values file.  Numeric types take the field's
+    /// numeric value, or parse its string value.  A field may have at most one value per document.
+    virtual void setDocValuesType(DocValuesType docValuesType);
+
+    /// Returns null; only {@link PointField} and point indexed {@link NumericField}s write points.
+    virtual Collection<int64_t> getPointValue();
+
     /// Indicates whether a Field is Lazy or not.  The semantics of Lazy loading are such that if a Field
     /// is lazily loaded, retrieving it's values via {@link #stringValue()} or {@link #getBinaryValue()}
     /// is only valid as long as the {@link IndexReader} that retrieved the {@link Document} is still open.
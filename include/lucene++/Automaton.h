@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOMATON_H
+#define AUTOMATON_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Deterministic finite automaton over characters, used to enumerate only the terms of a dictionary
+/// that a pattern can match.
+///
+/// Transitions are character ranges sorted by their first character.  Every state can reach an accept
+/// state, so a missing transition means no string with the current prefix is accepted.
+class LPPAPI Automaton : public LuceneObject {
+public:
+    Automaton();
+    virtual ~Automaton();
+
+    LUCENE_CLASS(Automaton);
+
+public:
+    /// Largest character the automata built here match with a wildcard or an edit.
+    static const int32_t MAX_CHAR;
+
+    /// Default limit on the number of states built by determinization.
+    static const int32_t DEFAULT_MAX_STATES;
+
+protected:
+    struct NFA;
+
+    /// Transitions of state s are [stateTransitions[s], stateTransitions[s + 1]).
+    std::vector<int32_t> stateTransitions;
+    std::vector<uint8_t> accept;
+    std::vector<int32_t> transitionMin;
+    std::vector<int32_t> transitionMax;
+    std::vector<int32_t> transitionTarget;
+
+public:
+    /// Returns an automaton accepting the strings matched by a wildcard pattern, where '*' matches any
+    /// sequence of characters and '?' any single character, or null if it needs more than maxStates states.
+    static AutomatonPtr makeWildcard(const String& pattern, int32_t maxStates = DEFAULT_MAX_STATES);
+
+    /// Returns an automaton accepting the strings that start with prefix followed by a string within
+    /// maxEdits insertions, deletions or substitutions of text, or null if it needs more than maxStates states.
+    static AutomatonPtr makeLevenshtein(const String& prefix, const String& text, int32_t maxEdits, int32_t maxStates = DEFAULT_MAX_STATES);
+
+    int32_t getNumStates();
+
+    /// Returns the state reached from state on character c, or -1.
+    int32_t step(int32_t state, int32_t c);
+
+    bool isAccept(int32_t state);
+
+    /// Returns true if the automaton accepts the given string.
+    bool run(const String& text);
+
+    /// Returns a lower bound of the smallest accepted string.
+    String getInitialString();
+
+    /// Finds the smallest string greater than text such that no accepted string lies between the two.
+    /// Returns false if no accepted string is greater than text.
+    bool nextString(const String& text, String& next);
+
+protected:
+    static AutomatonPtr determinize(const NFA& nfa, int32_t maxStates);
+
+    /// Removes the transitions to states that cannot reach an accept state.
+    void removeDeadTransitions();
+
+    /// Appends to next the smallest characters leading from state towards an accept state.
+    void appendMinimal(int32_t state, String& next);
+
+    /// Returns the first transition of state that accepts a character of at least c, or -1.
+    int32_t ceilTransition(int32_t state, int32_t c);
+};
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOMATONTERMENUM_H
+#define AUTOMATONTERMENUM_H
+
+#include "FilteredTermEnum.h"
+
+namespace Lucene {
+
+/// Subclass of FilteredTermEnum that intersects the terms dictionary with an {@link Automaton}.
+///
+/// A term the automaton rejects tells the enumeration the smallest string that could still be accepted;
+/// the terms before it are skipped, by reading on when only a few are in the way and by seeking the
+/// dictionary otherwise.  Terms the automaton accepts are passed to {@link #termCompare} for a final
+/// check.  Without an automaton every term from the start term on goes through {@link #termCompare}.
+class LPPAPI AutomatonTermEnum : public FilteredTermEnum {
+public:
+    AutomatonTermEnum();
+    virtual ~AutomatonTermEnum();
+
+    LUCENE_CLASS(AutomatonTermEnum);
+
+public:
+    /// Number of terms read before seeking the dictionary to the next string the automaton may accept.
+    static const int32_t MAX_SCAN_TERMS;
+
+protected:
+    IndexReaderPtr reader;
+    String automatonField;
+    AutomatonPtr automaton;
+    bool automatonEnd;
+
+public:
+    virtual bool next();
+    virtual void close();
+
+protected:
+    /// Positions the enumeration on the first matching term of field.  Falls back to filtering every term
+    /// from startTerm on when automaton is null.
+    void setAutomatonEnum(const IndexReaderPtr& reader, const String& field, const AutomatonPtr& automaton, const TermPtr& startTerm);
+
+    /// Moves on from term to the first term accepted by the automaton and {@link #termCompare}.
+    bool findMatch(TermPtr term);
+};
+
+}
+
+#endif
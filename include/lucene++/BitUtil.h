@@ -12,6 +12,9 @@
 namespace Lucene {
 
 /// A variety of high efficiency bit twiddling routines.
+///
+/// On x86 the popcount and bulk word routines pick popcnt and AVX2 kernels at runtime when the CPU
+/// has them, and fall back to portable carry-save adder code otherwise.
 class LPPAPI BitUtil : public LuceneObject {
 public:
     virtual ~BitUtil();
@@ -40,6 +43,21 @@ public:
     /// Returns the popcount or cardinality of A ^ B.  Neither array is modified.
     static int64_t pop_xor(const int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords);
 
+    /// Returns the number of set bits in an array of bytes.
+    static int64_t pop_bytes(const uint8_t* A, int32_t numBytes);
+
+    /// Sets A to A & B over the given words.
+    static void and_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords);
+
+    /// Sets A to A | B over the given words.
+    static void or_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords);
+
+    /// Sets A to A & ~B over the given words.
+    static void andnot_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords);
+
+    /// Sets A to A ^ B over the given words.
+    static void xor_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords);
+
     /// Returns number of trailing zeros in a 64 bit long value.
     static int32_t ntz(int64_t val);
 
@@ -36,6 +36,10 @@ public:
     /// @see IndexOutput#writeByte(uint8_t)
     virtual uint8_t readByte();
 
+    /// Reads count ints stored in variable-length format, decoding straight from the buffer.
+    /// @see IndexInput#readVInts(int32_t*, int32_t)
+    virtual void readVInts(int32_t* values, int32_t count);
+
     /// Change the buffer size used by this IndexInput.
     void setBufferSize(int32_t newSize);
 
@@ -0,0 +1,60 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef BYTESREF_H
+#define BYTESREF_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A slice of a byte array holding the UTF-8 encoding of a term's text.
+///
+/// Terms are stored as UTF-8 in the term dictionary, so comparing their bytes avoids converting them to
+/// wide strings.  Unsigned byte order of UTF-8 is Unicode code point order, which is the order of
+/// {@link Term#compareTo} wherever wchar_t holds whole code points.
+class LPPAPI BytesRef : public LuceneObject {
+public:
+    BytesRef();
+
+    /// Constructs a BytesRef holding the UTF-8 encoding of text.
+    BytesRef(const String& text);
+
+    /// Constructs a BytesRef over length bytes of bytes from offset, without copying them.
+    BytesRef(ByteArray bytes, int32_t offset, int32_t length);
+
+    virtual ~BytesRef();
+
+    LUCENE_CLASS(BytesRef);
+
+public:
+    ByteArray bytes;
+    int32_t offset;
+    int32_t length;
+
+public:
+    /// Replaces the contents with the UTF-8 encoding of text.
+    void copyChars(const wchar_t* text, int32_t length);
+
+    /// Replaces the contents with a copy of length bytes from offset.
+    void copyBytes(const uint8_t* bytes, int32_t offset, int32_t length);
+
+    /// Decodes the contents to a String.
+    String utf8ToString();
+
+    /// Compares two byte ranges as unsigned bytes.
+    static int32_t compareBytes(const uint8_t* bytes1, int32_t length1, const uint8_t* bytes2, int32_t length2);
+
+    virtual int32_t compareTo(const LuceneObjectPtr& other);
+    virtual bool equals(const LuceneObjectPtr& other);
+    virtual int32_t hashCode();
+    virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
+    virtual String toString();
+};
+
+}
+
+#endif
@@ -53,7 +53,8 @@ protected:
     /// Provide the DocIdSet to be cached, using the DocIdSet provided by the wrapped Filter.
     ///
     /// This implementation returns the given {@link DocIdSet}, if {@link DocIdSet#isCacheable} returns
-    /// true, else it copies the {@link DocIdSetIterator} into an {@link OpenBitSetDISI}.
+    /// true, else it copies the {@link DocIdSetIterator} into a {@link RoaringDocIdSet}, which stores each
+    /// block of docs as an array, bitmap or runs depending on how many docs it holds.
     DocIdSetPtr docIdSetToCache(const DocIdSetPtr& docIdSet, const IndexReaderPtr& reader);
 
 public:
@@ -13,7 +13,7 @@ namespace Lucene {
 
 class CharBlockPool : public LuceneObject {
 public:
-    CharBlockPool(const DocumentsWriterPtr& docWriter);
+    CharBlockPool(const DocumentsWriterPerThreadPtr& docWriter);
     virtual ~CharBlockPool();
 
     LUCENE_CLASS(CharBlockPool);
@@ -28,7 +28,7 @@ public:
     int32_t charOffset; // Current head offset
 
 protected:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
 
 public:
     void reset();
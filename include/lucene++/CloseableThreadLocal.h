@@ -7,51 +7,180 @@
 #ifndef CLOSEABLETHREADLOCAL_H
 #define CLOSEABLETHREADLOCAL_H
 
+#include <atomic>
 #include "LuceneThread.h"
 
 namespace Lucene {
 
 /// General purpose thread-local map.
+///
+/// Values are kept in a fixed table of {@link #SLOT_COUNT} slots keyed by {@link LuceneThread#currentId()}.
+/// Each slot is guarded by its own ownership word, so lookups never take a shared lock and the number of
+/// live values is bounded no matter how many short-lived threads call {@link #get()}.
+///
+/// When constructed with recycle enabled, a thread without a slot of its own takes over the value of an
+/// idle slot (one whose value is no longer referenced outside the table) instead of creating a new one
+/// through {@link #initialValue()}. Only use this for values that hold no per-thread state callers
+/// depend on across calls.
 template <typename TYPE>
 class CloseableThreadLocal : public LuceneObject {
 public:
     typedef std::shared_ptr<TYPE> localDataPtr;
-    typedef Map<int64_t, localDataPtr> MapLocalData;
 
-    CloseableThreadLocal() {
-        localData = MapLocalData::newInstance();
+    CloseableThreadLocal(bool recycle = false) {
+        this->recycle = recycle;
+        for (int32_t i = 0; i < SLOT_COUNT; ++i) {
+            slots[i].owner.store(SLOT_FREE, std::memory_order_relaxed);
+        }
     }
 
+    /// Maximum number of values held at once.
+    static const int32_t SLOT_COUNT = 64;
+
 public:
     localDataPtr get() {
-        SyncLock syncLock(this);
-        typename MapLocalData::iterator local = localData.find(LuceneThread::currentId());
-        if (local != localData.end()) {
-            return local->second;
+        int64_t id = LuceneThread::currentId();
+        localDataPtr data;
+        if (lookup(id, data)) {
+            return data;
+        }
+        if (recycle && takeIdle(id, data)) {
+            return data;
         }
         localDataPtr initial(initialValue());
         if (initial) {
-            localData.put(LuceneThread::currentId(), initial);
+            store(id, initial);
         }
         return initial;
     }
 
     void set(const localDataPtr& data) {
-        SyncLock syncLock(this);
-        localData.put(LuceneThread::currentId(), data);
+        store(LuceneThread::currentId(), data);
     }
 
+    /// Release all values held by this thread-local.
     void close() {
-        SyncLock syncLock(this);
-        localData.remove(LuceneThread::currentId());
+        for (int32_t i = 0; i < SLOT_COUNT; ++i) {
+            int64_t owner = slots[i].owner.load(std::memory_order_relaxed);
+            while (owner != SLOT_FREE) {
+                if (owner != SLOT_BUSY && slots[i].owner.compare_exchange_weak(owner, SLOT_BUSY, std::memory_order_acquire)) {
+                    localDataPtr released;
+                    released.swap(slots[i].data);
+                    slots[i].owner.store(SLOT_FREE, std::memory_order_release);
+                    break;
+                }
+                if (owner == SLOT_BUSY) {
+                    LuceneThread::threadYield();
+                    owner = slots[i].owner.load(std::memory_order_relaxed);
+                }
+            }
+        }
     }
 
 protected:
-    MapLocalData localData;
+    static const int64_t SLOT_FREE = 0;
+    static const int64_t SLOT_BUSY = -1;
+
+    struct Slot {
+        std::atomic<int64_t> owner;
+        localDataPtr data;
+    };
+
+    Slot slots[SLOT_COUNT];
+    bool recycle;
 
     virtual localDataPtr initialValue() {
         return localDataPtr(); // override
     }
+
+    static int32_t homeSlot(int64_t id) {
+        uint64_t hash = (uint64_t)id * 0x9e3779b97f4a7c15ULL;
+        return (int32_t)(hash >> 58) & (SLOT_COUNT - 1);
+    }
+
+    /// Lock the slot if it is currently owned by the given id.
+    bool acquire(Slot& slot, int64_t id) {
+        int64_t owner = id;
+        while (!slot.owner.compare_exchange_weak(owner, SLOT_BUSY, std::memory_order_acquire)) {
+            if (owner != SLOT_BUSY && owner != id) {
+                return false;
+            }
+            if (owner == SLOT_BUSY) {
+                LuceneThread::threadYield();
+            }
+            owner = id;
+        }
+        return true;
+    }
+
+    bool lookup(int64_t id, localDataPtr& data) {
+        int32_t home = homeSlot(id);
+        for (int32_t i = 0; i < SLOT_COUNT; ++i) {
+            Slot& slot = slots[(home + i) & (SLOT_COUNT - 1)];
+            if (slot.owner.load(std::memory_order_relaxed) == id && acquire(slot, id)) {
+                data = slot.data;
+                slot.owner.store(id, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool takeIdle(int64_t id, localDataPtr& data) {
+        int32_t home = homeSlot(id);
+        for (int32_t i = 0; i < SLOT_COUNT; ++i) {
+            Slot& slot = slots[(home + i) & (SLOT_COUNT - 1)];
+            int64_t owner = slot.owner.load(std::memory_order_relaxed);
+            if (owner == SLOT_FREE || owner == SLOT_BUSY || !slot.owner.compare_exchange_strong(owner, SLOT_BUSY, std::memory_order_acquire)) {
+                continue;
+            }
+            // the table holds the only reference, so no other thread can be using this value
+            if (slot.data && slot.data.use_count() == 1) {
+                data = slot.data;
+                slot.owner.store(id, std::memory_order_release);
+                return true;
+            }
+            slot.owner.store(owner, std::memory_order_release);
+        }
+        return false;
+    }
+
+    void store(int64_t id, const localDataPtr& data) {
+        int32_t home = homeSlot(id);
+        localDataPtr released;
+        for (int32_t i = 0; i < SLOT_COUNT; ++i) {
+            Slot& slot = slots[(home + i) & (SLOT_COUNT - 1)];
+            if (slot.owner.load(std::memory_order_relaxed) == id && acquire(slot, id)) {
+                released.swap(slot.data);
+                slot.data = data;
+                slot.owner.store(id, std::memory_order_release);
+                return;
+            }
+        }
+        for (int32_t i = 0; i < SLOT_COUNT; ++i) {
+            Slot& slot = slots[(home + i) & (SLOT_COUNT - 1)];
+            int64_t owner = SLOT_FREE;
+            if (slot.owner.compare_exchange_strong(owner, SLOT_BUSY, std::memory_order_acquire)) {
+                slot.data = data;
+                slot.owner.store(id, std::memory_order_release);
+                return;
+            }
+        }
+        // table is full, evict the first slot we can lock; its owner simply creates a new value next time
+        for (int32_t i = 0; ; i = (i + 1) & (SLOT_COUNT - 1)) {
+            Slot& slot = slots[(home + i) & (SLOT_COUNT - 1)];
+            int64_t owner = slot.owner.load(std::memory_order_relaxed);
+            if (owner != SLOT_BUSY && slot.owner.compare_exchange_strong(owner, SLOT_BUSY, std::memory_order_acquire)) {
+                released.swap(slot.data);
+                slot.data = data;
+                slot.owner.store(id, std::memory_order_release);
+                return;
+            }
+            if (i == SLOT_COUNT - 1) {
+                LuceneThread::threadYield();
+            }
+        }
+    }
 };
 
 }
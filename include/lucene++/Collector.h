@@ -113,6 +113,9 @@ public:
     /// Note: This is called in an inner search loop. For good search performance, implementations of this
     /// method should not call {@link Searcher#doc(int32_t)} or {@link IndexReader#document(int32_t)} on
     /// every hit.  Doing so can slow searches by an order of magnitude or more.
+    ///
+    /// A collector that needs no more hits from the current reader may throw CollectionTerminatedException;
+    /// {@link IndexSearcher} then moves on to the next reader.
     virtual void collect(int32_t doc) = 0;
 
     /// Called before collecting from each IndexReader. All doc ids in {@link #collect(int32_t)} will
@@ -131,6 +134,19 @@ public:
     ///
     /// Many collectors don't mind getting docIDs out of order, so it's important to return true here.
     virtual bool acceptsDocsOutOfOrder() = 0;
+
+    /// Return true if this collector can take hits in batches through {@link #collectBatch}.  Scorers that
+    /// compute scores for a run of documents at once, such as {@link TermScorer}, then skip the per hit
+    /// {@link #collect(int32_t)} and {@link Scorer#score()} calls.  The default is false.
+    virtual bool acceptsBatches();
+
+    /// Called with a batch of matching documents in increasing order, together with their scores, instead of
+    /// once per document through {@link #collect(int32_t)}.  Only called when {@link #acceptsBatches()}
+    /// returns true.
+    /// @param docs unbased document numbers
+    /// @param scores the score of each document
+    /// @param count number of documents in the batch
+    virtual void collectBatch(const int32_t* docs, const double* scores, int32_t count);
 };
 
 }
@@ -40,6 +40,9 @@ public:
     /// Decompress the byte array previously returned by compressString back into a String
     static String decompressString(ByteArray value);
 
+    /// Compression level favouring speed over size, as used for chunks of stored fields
+    static const int32_t BEST_SPEED;
+
 protected:
     static const int32_t COMPRESS_BUFFER;
 };
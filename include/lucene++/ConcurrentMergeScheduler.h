@@ -31,6 +31,12 @@ protected:
     /// Max number of threads allowed to be merging at once
     int32_t maxThreadCount;
 
+    /// Pool each merge runs its independent parts on
+    ThreadPoolPtr mergeExecutor;
+
+    /// Throttles the bytes written by all merges
+    MergeRateLimiterPtr rateLimiter;
+
     DirectoryPtr dir;
 
     bool closed;
@@ -52,6 +58,30 @@ public:
     /// Get the max # simultaneous threads that may be running. @see #setMaxThreadCount.
     virtual int32_t getMaxThreadCount();
 
+    /// Number of worker threads of the pool returned by {@link #getMergePool()}.
+    static const int32_t MERGE_POOL_SIZE;
+
+    /// Returns the pool merges run their parts on by default.  It is kept apart from {@link
+    /// ThreadPool#getInstance()}, so that merges throttled by a {@link MergeRateLimiter} sleep on threads
+    /// that searches never wait for.
+    static ThreadPoolPtr getMergePool();
+
+    /// Sets the thread pool each merge runs its independent parts on: stored fields, term vectors, postings,
+    /// norms and doc values are written in parallel.  Null merges them one after another on the merge
+    /// thread.  Defaults to {@link #getMergePool()}.  The parts pause on the pool's threads to hold the
+    /// rate of the merge rate limiter, so a pool shared with searches slows those searches down.
+    virtual void setMergeExecutor(const ThreadPoolPtr& executor);
+
+    /// @see #setMergeExecutor
+    virtual ThreadPoolPtr getMergeExecutor();
+
+    /// Sets the rate limiter that throttles the bytes merges write, or null for none.  The default limiter
+    /// is unthrottled until it is given a rate or a target search latency.
+    virtual void setMergeRateLimiter(const MergeRateLimiterPtr& rateLimiter);
+
+    /// @see #setMergeRateLimiter
+    virtual MergeRateLimiterPtr getMergeRateLimiter();
+
     /// Return the priority that merge threads run at.  By default the priority is 1 plus the
     /// priority of (ie, slightly higher priority than) the first thread that calls merge.
     virtual int32_t getMergeThreadPriority();
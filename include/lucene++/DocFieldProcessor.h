@@ -16,16 +16,18 @@ namespace Lucene {
 /// DocFieldConsumer.
 class DocFieldProcessor : public DocConsumer {
 public:
-    DocFieldProcessor(const DocumentsWriterPtr& docWriter, const DocFieldConsumerPtr& consumer);
+    DocFieldProcessor(const DocumentsWriterPerThreadPtr& docWriter, const DocFieldConsumerPtr& consumer);
     virtual ~DocFieldProcessor();
 
     LUCENE_CLASS(DocFieldProcessor);
 
 public:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
     FieldInfosPtr fieldInfos;
     DocFieldConsumerPtr consumer;
     StoredFieldsWriterPtr fieldsWriter;
+    DocValuesWriterPtr docValuesWriter;
+    PointsWriterPtr pointsWriter;
 
 public:
     virtual void closeDocStore(const SegmentWriteStatePtr& state);
@@ -37,6 +37,8 @@ public:
     int32_t totalFieldCount;
 
     StoredFieldsWriterPerThreadPtr fieldsWriter;
+    DocValuesWriterPerThreadPtr docValuesWriter;
+    PointsWriterPerThreadPtr pointsWriter;
     DocStatePtr docState;
 
     Collection<DocFieldProcessorPerThreadPerDocPtr> docFreeList;
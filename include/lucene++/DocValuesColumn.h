@@ -0,0 +1,86 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCVALUESCOLUMN_H
+#define DOCVALUESCOLUMN_H
+
+#include "Fieldable.h"
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// The doc values of one field of one segment, loaded from the segment's doc values file.
+///
+/// Numeric columns are held packed; binary and sorted columns hold their strings as UTF-8 with packed
+/// start offsets, and sorted columns a packed ordinal per document.  Documents without a value read as
+/// 0 or the empty string.
+/// @see IndexReader#getDocValuesColumn
+class LPPAPI DocValuesColumn : public LuceneObject {
+public:
+    /// Reads a column of the given type for maxDoc documents.
+    DocValuesColumn(const IndexInputPtr& input, Fieldable::DocValuesType type, int32_t maxDoc);
+    virtual ~DocValuesColumn();
+
+    LUCENE_CLASS(DocValuesColumn);
+
+protected:
+    Fieldable::DocValuesType type;
+    int32_t maxDoc;
+    int32_t valueCount;
+
+    /// Numeric values or sorted ordinals, one per document.
+    PackedLongsPtr values;
+
+    /// Start offsets of the strings in bytes, one more than the number of strings.
+    PackedLongsPtr addresses;
+    ByteArray bytes;
+
+public:
+    Fieldable::DocValuesType getType();
+
+    /// Returns true for numeric and double columns.
+    bool isNumeric();
+
+    /// Returns the number of documents of the column.
+    int32_t size();
+
+    /// Returns the value of a numeric or double column.
+    int64_t getLong(int32_t doc);
+
+    /// Returns the value of a numeric or double column.
+    double getDouble(int32_t doc);
+
+    /// Returns the ordinal of the value of doc in a sorted column: 0 if the document has no value, else
+    /// from 1 to {@link #getValueCount}.
+    int32_t getOrd(int32_t doc);
+
+    /// Returns the number of unique values of a sorted column.
+    int32_t getValueCount();
+
+    /// Returns the value of a sorted column with the given ordinal; the empty string for ordinal 0.
+    String lookup(int32_t ord);
+
+    /// Returns the value of doc in a binary or sorted column.
+    String getString(int32_t doc);
+
+    /// Compares the value of doc in a binary or sorted column with the UTF-8 bytes of value, without decoding
+    /// it.  UTF-8 bytes sort in the order of the Strings they encode.
+    int32_t compareString(int32_t doc, const BytesRefPtr& value);
+
+    /// Compares the value of a sorted column with the given ordinal with the UTF-8 bytes of value.
+    int32_t compareLookup(int32_t ord, const BytesRefPtr& value);
+
+    /// Returns the memory used by the column.
+    int64_t sizeInBytes();
+
+protected:
+    String getStringAt(int32_t index);
+    int32_t compareStringAt(int32_t index, const BytesRefPtr& value);
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCVALUESREADER_H
+#define DOCVALUESREADER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Reads the directory of a segment's doc values file when opened and loads columns on request.  A column
+/// is decoded once and shared by every reader of the segment until the reader is closed.
+/// @see DocValuesWriter
+class DocValuesReader : public LuceneObject {
+public:
+    DocValuesReader(const DirectoryPtr& dir, const String& segment, const FieldInfosPtr& fieldInfos, int32_t readBufferSize);
+    virtual ~DocValuesReader();
+
+    LUCENE_CLASS(DocValuesReader);
+
+protected:
+    FieldInfosPtr fieldInfos;
+    IndexInputPtr input;
+    int32_t maxDoc;
+
+    /// File pointer of the column of each field number, or -1.
+    Collection<int64_t> pointers;
+
+    /// Columns decoded so far, by field number.
+    Collection<DocValuesColumnPtr> columns;
+
+public:
+    /// Returns the column of the given field, loading it on first use, or null if the field has no doc values.
+    DocValuesColumnPtr getColumn(const String& field);
+
+    int32_t getMaxDoc();
+
+    void close();
+};
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCVALUESWRITER_H
+#define DOCVALUESWRITER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Buffers the doc values of the documents in RAM and writes them to the segment's doc values file on flush.
+///
+/// The file holds an Int format and the VInt number of documents, then the column of every field with
+/// doc values, then a directory of the columns (a VInt count and for each column its VInt field number,
+/// its type as a Byte and the VLong file pointer of its data) whose own file pointer ends the file as a Long.
+class DocValuesWriter : public LuceneObject {
+public:
+    DocValuesWriter(const FieldInfosPtr& fieldInfos);
+    virtual ~DocValuesWriter();
+
+    LUCENE_CLASS(DocValuesWriter);
+
+public:
+    static const int32_t FORMAT_CURRENT;
+
+    FieldInfosPtr fieldInfos;
+
+public:
+    DocValuesWriterPerThreadPtr addThread(const DocStatePtr& docState);
+    void flush(Collection<DocValuesWriterPerThreadPtr> threads, const SegmentWriteStatePtr& state);
+
+    /// Writes the file header.
+    static void writeHeader(const IndexOutputPtr& output, int32_t maxDoc);
+
+    /// Writes a numeric column, one value per document; double columns are written as sortable longs.
+    static void writeNumeric(const IndexOutputPtr& output, Collection<int64_t> values);
+
+    /// Writes a binary column, one value per document.
+    static void writeBinary(const IndexOutputPtr& output, Collection<String> values);
+
+    /// Writes a sorted column, one value per document; empty values are missing.
+    static void writeSorted(const IndexOutputPtr& output, Collection<String> values);
+
+    /// Writes the directory of the columns and ends the file.
+    static void writeDirectory(const IndexOutputPtr& output, Collection<FieldInfoPtr> fields, Collection<int64_t> pointers);
+
+protected:
+    static void writeStrings(const IndexOutputPtr& output, const String* values, int32_t count);
+};
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCVALUESWRITERPERTHREAD_H
+#define DOCVALUESWRITERPERTHREAD_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Buffers the doc values of the documents indexed by one thread, by field number.
+class DocValuesWriterPerThread : public LuceneObject {
+public:
+    DocValuesWriterPerThread(const DocStatePtr& docState);
+    virtual ~DocValuesWriterPerThread();
+
+    LUCENE_CLASS(DocValuesWriterPerThread);
+
+public:
+    DocStatePtr docState;
+
+    /// Per field number: the documents with a value, in the order they were added, and their values.
+    Collection< Collection<int32_t> > docs;
+    Collection< Collection<int64_t> > longs;
+    Collection< Collection<String> > strings;
+
+public:
+    void addField(const FieldablePtr& field, const FieldInfoPtr& fieldInfo);
+    void reset();
+    void abort();
+};
+
+}
+
+#endif
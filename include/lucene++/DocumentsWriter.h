@@ -12,7 +12,7 @@
 
 namespace Lucene {
 
-/// This class accepts multiple added documents and directly writes a single segment file.  It does this more
+/// This class accepts multiple added documents and directly writes segment files.  It does this more
 /// efficiently than creating a single segment per document (with DocumentWriter) and doing standard merges on
 /// those segments.
 ///
@@ -24,28 +24,29 @@ namespace Lucene {
 /// Other consumers, eg {@link FreqProxTermsWriter} and {@link NormsWriter}, buffer bytes in RAM and flush only
 /// when a new segment is produced.
 ///
-/// Once we have used our allowed RAM buffer, or the number of added docs is large enough (in the case we are
-/// flushing by doc count instead of RAM usage), we create a real segment and flush it to the Directory.
-///
 /// Threads:
-/// Multiple threads are allowed into addDocument at once. There is an initial synchronized call to
-/// getThreadState which allocates a ThreadState for this thread.  The same thread will get the same ThreadState
-/// over time (thread affinity) so that if there are consistent patterns (for example each thread is indexing a
-/// different content source) then we make better use of RAM.  Then processDocument is called on that ThreadState
-/// without synchronization (most of the "heavy lifting" is in this call).  Finally the synchronized
-/// "finishDocument" is called to flush changes to the directory.
+/// Documents are buffered in {@link DocumentsWriterPerThread} instances, each of which owns its own indexing
+/// chain and becomes its own segment.  Multiple threads are allowed into addDocument at once.  There is an
+/// initial synchronized call to getThreadState which binds this thread to a DocumentsWriterPerThread.  The same
+/// thread will get the same instance over time (thread affinity) until that instance is flushed.  Then
+/// processDocument is called on it without synchronization (most of the "heavy lifting" is in this call).
+///
+/// Once an instance has buffered maxBufferedDocs documents, or the largest instance is chosen because the RAM
+/// used by all of them reached the RAM buffer size, it is marked flush pending.  IndexWriter then flushes it to
+/// a new segment while the other threads keep indexing into their own instances; threads bound to the pending
+/// instance move on to another one.
 ///
-/// When flush is called by IndexWriter we forcefully idle all threads and flush only once they are all idle.
-/// This means you can call flush with a given thread even while other threads are actively adding/deleting
-/// documents.
+/// When a full flush is called by IndexWriter (eg on commit, or to apply buffered deletes) we forcefully idle
+/// all threads and flush every instance once they are all idle.  This means you can call flush with a given
+/// thread even while other threads are actively adding/deleting documents.
 ///
 /// Exceptions:
 /// Because this class directly updates in-memory posting lists, and flushes stored fields and term vectors
 /// directly to files in the directory, there are certain limited times when an exception can corrupt this state.
 /// For example, a disk full while flushing stored fields leaves this file in a corrupt state.  Or, an
 /// std::bad_alloc exception while appending to the in-memory posting lists can corrupt that posting list.
-/// We call such exceptions "aborting exceptions".  In these cases we must call abort() to discard all docs added
-/// since the last flush.
+/// We call such exceptions "aborting exceptions".  In these cases we must call abort() on the instance that
+/// hit it to discard all docs it buffered since its last flush.
 ///
 /// All other exceptions ("non-aborting exceptions") can still partially update the index structures.  These
 /// updates are consistent, but, they represent only a part of the document seen up until the exception was hit.
@@ -59,23 +60,16 @@ public:
     LUCENE_CLASS(DocumentsWriter);
 
 protected:
-    String docStoreSegment; // Current doc-store segment we are writing
-    int32_t docStoreOffset; // Current starting doc-store offset of current segment
-
-    int32_t nextDocID; // Next docID to be added
-    int32_t numDocsInRAM; // # docs buffered in RAM
-
-    /// Max # ThreadState instances; if there are more threads than this they share ThreadStates
-    static const int32_t MAX_THREAD_STATE;
-    Collection<DocumentsWriterThreadStatePtr> threadStates;
-    MapThreadDocumentsWriterThreadState threadBindings;
+    /// Max # DocumentsWriterPerThread instances; if there are more threads than this they share them
+    int32_t maxThreadStates;
+    Collection<DocumentsWriterPerThreadPtr> perThreads;
+    MapThreadDocumentsWriterPerThread threadBindings;
 
     int32_t pauseThreads; // Non-zero when we need all threads to pause (eg to flush)
     bool aborting; // True if an abort is pending
 
-    DocFieldProcessorPtr docFieldProcessor;
-
-    /// Deletes done after the last flush; these are discarded on abort
+    /// Deletes done after the last flush against the flushed segments; these are discarded on abort.  Each
+    /// DocumentsWriterPerThread buffers the same deletes against its own documents.
     BufferedDeletesPtr deletesInRAM;
 
     /// Deletes done before the last flush; these are still kept on abort
@@ -103,10 +97,6 @@ protected:
 
     /// List of files that were written before last abort()
     HashSet<String> _abortedFiles;
-    SegmentWriteStatePtr flushState;
-
-    Collection<IntArray> freeIntBlocks;
-    Collection<CharArray> freeCharBlocks;
 
 public:
     /// Coarse estimates used to measure RAM usage of buffered deletes
@@ -155,49 +145,25 @@ INTERNAL:
     IndexWriterWeakPtr _writer;
     DirectoryPtr directory;
     IndexingChainPtr indexingChain;
-    String segment; // Current segment we are working on
-
-    int32_t numDocsInStore; // # docs written to doc stores
 
-    bool flushPending; // True when a thread has decided to flush
-    bool bufferIsFull; // True when it's time to write segment
+    bool flushPending; // True when a thread has decided to flush everything
 
     InfoStreamPtr infoStream;
     int32_t maxFieldLength;
     SimilarityPtr similarity;
 
-    DocConsumerPtr consumer;
-
-    HashSet<String> _openFiles;
-    HashSet<String> _closedFiles;
-
-    WaitQueuePtr waitQueue;
-    SkipDocWriterPtr skipDocWriter;
-
-    ByteBlockAllocatorPtr byteBlockAllocator;
-    ByteBlockAllocatorPtr perDocAllocator;
-
-    int64_t numBytesAlloc;
-    int64_t numBytesUsed;
-
     // used only by assert
     TermPtr lastDeleteTerm;
 
 public:
     virtual void initialize();
 
-    /// Create and return a new DocWriterBuffer.
-    PerDocBufferPtr newPerDocBuffer();
-
     static IndexingChainPtr getDefaultIndexingChain();
 
     void updateFlushedDocCount(int32_t n);
     int32_t getFlushedDocCount();
     void setFlushedDocCount(int32_t n);
 
-    /// Returns true if any of the fields in the current buffered docs have omitTermFreqAndPositions==false
-    bool hasProx();
-
     /// If non-null, various details of indexing are printed here.
     void setInfoStream(const InfoStreamPtr& infoStream);
 
@@ -212,34 +178,20 @@ public:
     void setMaxBufferedDocs(int32_t count);
     int32_t getMaxBufferedDocs();
 
-    /// Get current segment name we are writing.
-    String getSegment();
+    /// Set the max number of DocumentsWriterPerThread instances, ie the number of segments that can be
+    /// buffered (and flushed) concurrently.
+    void setMaxThreadStates(int32_t maxThreadStates);
+    int32_t getMaxThreadStates();
 
     /// Returns how many docs are currently buffered in RAM.
     int32_t getNumDocsInRAM();
 
-    /// Returns the current doc store segment we are writing to.
-    String getDocStoreSegment();
-
-    /// Returns the doc offset into the shared doc store for the current buffered docs.
-    int32_t getDocStoreOffset();
-
-    /// Closes the current open doc stores an returns the doc store segment name.  This returns null if there
-    /// are no buffered documents.
-    String closeDocStore();
-
     HashSet<String> abortedFiles();
 
     void message(const String& message);
 
     /// Returns Collection of files in use by this instance, including any flushed segments.
     HashSet<String> openFiles();
-    HashSet<String> closedFiles();
-
-    void addOpenFile(const String& name);
-    void removeOpenFile(const String& name);
-
-    void setAborting();
 
     /// Called if we hit an exception at a bad time (when updating the index files) and must discard all
     /// currently buffered docs.  This resets our state, discarding any docs added since last flush.
@@ -251,31 +203,34 @@ public:
 
     bool anyChanges();
 
-    void initFlushState(bool onlyDocStore);
-
-    /// Flush all pending docs to a new segment
-    int32_t flush(bool _closeDocStore);
-
-    HashSet<String> getFlushedFiles();
-
-    /// Build compound file for the segment we just flushed
-    void createCompoundFile(const String& segment);
-
     /// Set flushPending if it is not already set and returns whether it was set. This is used by IndexWriter
     /// to trigger a single flush even when multiple threads are trying to do so.
     bool setFlushPending();
     void clearFlushPending();
 
+    /// Returns true if a flush of everything buffered is pending.
+    bool isFlushPending();
+
+    /// Waits until an instance that is flush pending is idle and returns it, marked busy, for the caller to
+    /// flush.  If flushAll is true any instance that buffered documents is returned; the caller must have
+    /// paused all threads first.  Returns null once there is nothing left to flush.
+    DocumentsWriterPerThreadPtr checkoutFlushPending(bool flushAll);
+
+    /// Called once perThread has written its segment: counts its documents as flushed, resets it for reuse and
+    /// returns the deletes it buffered against the new segment.
+    BufferedDeletesPtr finishFlush(const DocumentsWriterPerThreadPtr& perThread);
+
+    /// Returns an instance taken by {@link #checkoutFlushPending} to the indexing threads.
+    void checkin(const DocumentsWriterPerThreadPtr& perThread);
+
     void pushDeletes();
 
     void close();
 
-    void initSegmentName(bool onlyDocStore);
-
-    /// Returns a free (idle) ThreadState that may be used for indexing this one document.  This call also
-    /// pauses if a flush is pending.  If delTerm is non-null then we buffer this deleted term after the
-    /// thread state has been acquired.
-    DocumentsWriterThreadStatePtr getThreadState(const DocumentPtr& doc, const TermPtr& delTerm);
+    /// Returns a free (idle) DocumentsWriterPerThread that may be used for indexing this one document and
+    /// allocates the document's docID.  This call also pauses if a flush is pending.  If delTerm is non-null
+    /// then we buffer this deleted term after the instance has been acquired.
+    DocumentsWriterPerThreadPtr getThreadState(const TermPtr& delTerm);
 
     /// Returns true if the caller (IndexWriter) should now flush.
     bool addDocument(const DocumentPtr& doc, const AnalyzerPtr& analyzer);
@@ -301,25 +256,19 @@ public:
 
     bool hasDeletes();
     bool applyDeletes(const SegmentInfosPtr& infos);
-    bool doBalanceRAM();
-
-    void waitForWaitQueue();
 
-    int64_t getRAMUsed();
+    /// Applies deletes buffered by a DocumentsWriterPerThread to the segment it just flushed.
+    bool applyDeletes(const BufferedDeletesPtr& deletes, const SegmentInfoPtr& info);
 
-    IntArray getIntBlock(bool trackAllocations);
-    void bytesAllocated(int64_t numBytes);
-    void bytesUsed(int64_t numBytes);
-    void recycleIntBlocks(Collection<IntArray> blocks, int32_t start, int32_t end);
+    bool doBalanceRAM();
 
-    CharArray getCharBlock();
-    void recycleCharBlocks(Collection<CharArray> blocks, int32_t numBlocks);
+    int64_t getRAMUsed();
 
     String toMB(int64_t v);
 
-    /// We have four pools of RAM: Postings, byte blocks (holds freq/prox posting data), char blocks (holds
-    /// characters in the term) and per-doc buffers (stored fields/term vectors).  Different docs require
-    /// varying amount of storage from these four classes.
+    /// Each DocumentsWriterPerThread has four pools of RAM: Postings, byte blocks (holds freq/prox posting
+    /// data), char blocks (holds characters in the term) and per-doc buffers (stored fields/term vectors).
+    /// Different docs require varying amount of storage from these four classes.
     ///
     /// For example, docs with many unique single-occurrence short terms will use up the Postings
     /// RAM and hardly any of the other two.  Whereas docs with very large terms will use alot of char blocks
@@ -328,28 +277,24 @@ public:
     void balanceRAM();
 
 protected:
-    /// Reset after a flush
-    void doAfterFlush();
-
     bool allThreadsIdle();
 
-    void waitReady(const DocumentsWriterThreadStatePtr& state);
+    void waitReady(const DocumentsWriterPerThreadPtr& perThread);
 
     bool timeToFlushDeletes();
 
+    /// Marks the largest instance that is not yet flush pending if the RAM used by documents and deletes
+    /// buffered outside pending instances reached the RAM buffer size.  Returns true if one was marked.
+    bool setFlushPendingByRAM();
+
     // used only by assert
     bool checkDeleteTerm(const TermPtr& term);
 
-    bool applyDeletes(const IndexReaderPtr& reader, int32_t docIDStart);
-    void addDeleteTerm(const TermPtr& term, int32_t docCount);
-
-    /// Buffer a specific docID for deletion.  Currently only used when we hit a exception when adding a document
-    void addDeleteDocID(int32_t docID);
-    void addDeleteQuery(const QueryPtr& query, int32_t docID);
-
-    /// Does the synchronized work to finish/flush the inverted document.
-    void finishDocument(const DocumentsWriterThreadStatePtr& perThread, const DocWriterPtr& docWriter);
+    bool applyDeletes(const BufferedDeletesPtr& deletes, const IndexReaderPtr& reader, int32_t docIDStart);
+    void addDeleteTerm(const TermPtr& term);
+    void addDeleteQuery(const QueryPtr& query);
 
+    friend class DocumentsWriterPerThread;
     friend class WaitQueue;
 };
 
@@ -361,7 +306,7 @@ public:
     LUCENE_CLASS(DocState);
 
 public:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
     AnalyzerPtr analyzer;
     int32_t maxFieldLength;
     InfoStreamPtr infoStream;
@@ -380,13 +325,13 @@ public:
 /// RAMFile buffer for DocWriters.
 class PerDocBuffer : public RAMFile {
 public:
-    PerDocBuffer(const DocumentsWriterPtr& docWriter);
+    PerDocBuffer(const DocumentsWriterPerThreadPtr& docWriter);
     virtual ~PerDocBuffer();
 
     LUCENE_CLASS(PerDocBuffer);
 
 protected:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
 
 public:
     /// Recycle the bytes used.
@@ -418,8 +363,8 @@ public:
     virtual void setNext(const DocWriterPtr& next);
 };
 
-/// The IndexingChain must define the {@link #getChain(DocumentsWriter)} method which returns the DocConsumer
-/// that the DocumentsWriter calls to process the documents.
+/// The IndexingChain must define the {@link #getChain(DocumentsWriterPerThread)} method which returns the
+/// DocConsumer that each DocumentsWriterPerThread calls to process its documents.
 class IndexingChain : public LuceneObject {
 public:
     virtual ~IndexingChain();
@@ -427,7 +372,7 @@ public:
     LUCENE_CLASS(IndexingChain);
 
 public:
-    virtual DocConsumerPtr getChain(const DocumentsWriterPtr& documentsWriter) = 0;
+    virtual DocConsumerPtr getChain(const DocumentsWriterPerThreadPtr& documentsWriter) = 0;
 };
 
 /// This is the current indexing chain:
@@ -451,7 +396,7 @@ public:
     LUCENE_CLASS(DefaultIndexingChain);
 
 public:
-    virtual DocConsumerPtr getChain(const DocumentsWriterPtr& documentsWriter);
+    virtual DocConsumerPtr getChain(const DocumentsWriterPerThreadPtr& documentsWriter);
 };
 
 class SkipDocWriter : public DocWriter {
@@ -468,13 +413,13 @@ public:
 
 class WaitQueue : public LuceneObject {
 public:
-    WaitQueue(const DocumentsWriterPtr& docWriter);
+    WaitQueue(const DocumentsWriterPerThreadPtr& docWriter);
     virtual ~WaitQueue();
 
     LUCENE_CLASS(WaitQueue);
 
 protected:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
 
 public:
     Collection<DocWriterPtr> waiting;
@@ -496,13 +441,13 @@ protected:
 
 class ByteBlockAllocator : public ByteBlockPoolAllocatorBase {
 public:
-    ByteBlockAllocator(const DocumentsWriterPtr& docWriter, int32_t blockSize);
+    ByteBlockAllocator(const DocumentsWriterPerThreadPtr& docWriter, int32_t blockSize);
     virtual ~ByteBlockAllocator();
 
     LUCENE_CLASS(ByteBlockAllocator);
 
 protected:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
 
 public:
     int32_t blockSize;
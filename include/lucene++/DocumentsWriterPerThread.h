@@ -0,0 +1,206 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DOCUMENTSWRITERPERTHREAD_H
+#define DOCUMENTSWRITERPERTHREAD_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A private in-memory segment of {@link DocumentsWriter}.
+///
+/// Each indexing thread is bound to one of these.  It runs its own indexing chain, writes its own doc stores
+/// and buffers its own postings, so documents are added and the segment is flushed without synchronizing
+/// with the other indexing threads.  Only one thread uses an instance at a time: DocumentsWriter marks it
+/// busy while a document is processed or the segment is flushed.
+///
+/// Doc stores are closed on every flush, so flushed segments never share doc stores with each other.
+///
+/// Deletes buffered here hold docIDs local to the segment and are applied to it as soon as it is flushed.
+class LPPAPI DocumentsWriterPerThread : public LuceneObject {
+public:
+    DocumentsWriterPerThread(const DocumentsWriterPtr& docWriter);
+    virtual ~DocumentsWriterPerThread();
+
+    LUCENE_CLASS(DocumentsWriterPerThread);
+
+protected:
+    String docStoreSegment; // Current doc-store segment we are writing
+    int32_t docStoreOffset; // Current starting doc-store offset of current segment
+
+    int32_t nextDocID; // Next docID to be added
+    int32_t numDocsInRAM; // # docs buffered in RAM
+
+    bool aborting; // True if an abort is pending
+
+    DocFieldProcessorPtr docFieldProcessor;
+
+    /// List of files that were written before last abort()
+    HashSet<String> _abortedFiles;
+    SegmentWriteStatePtr flushState;
+
+    Collection<IntArray> freeIntBlocks;
+    Collection<CharArray> freeCharBlocks;
+
+INTERNAL:
+    DocumentsWriterWeakPtr _docWriter;
+    IndexWriterWeakPtr _writer;
+    DirectoryPtr directory;
+    String segment; // Current segment we are working on
+
+    int32_t numDocsInStore; // # docs written to doc stores
+
+    bool isIdle; // false if this is currently in use by a thread
+    int32_t numThreads; // Number of threads bound to this instance
+    bool flushPending; // True once this segment should be flushed
+
+    InfoStreamPtr infoStream;
+    int32_t maxFieldLength;
+    SimilarityPtr similarity;
+
+    DocConsumerPtr consumer;
+    DocumentsWriterThreadStatePtr threadState;
+
+    /// Deletes done since the last flush, holding docIDs local to this segment; these are discarded on abort.
+    /// Guarded by their own lock so deletes can be buffered while this segment is being flushed.
+    BufferedDeletesPtr deletesInRAM;
+
+    HashSet<String> _openFiles;
+    HashSet<String> _closedFiles;
+
+    WaitQueuePtr waitQueue;
+    SkipDocWriterPtr skipDocWriter;
+
+    ByteBlockAllocatorPtr byteBlockAllocator;
+    ByteBlockAllocatorPtr perDocAllocator;
+
+    int64_t numBytesAlloc;
+    int64_t numBytesUsed;
+
+    /// RAM held by the buffered doc values, which is released at flush rather than pooled.
+    int64_t numDocValuesBytes;
+
+    /// RAM held by the buffered points, which is released at flush as well.
+    int64_t numPointsBytes;
+
+public:
+    virtual void initialize();
+
+    /// Create and return a new DocWriterBuffer.
+    PerDocBufferPtr newPerDocBuffer();
+
+    /// Returns true if any of the fields in the current buffered docs have omitTermFreqAndPositions==false
+    bool hasProx();
+
+    /// Returns true if the last flushed segment wrote its postings in bit-packed blocks
+    bool hasPackedPostings();
+
+    void setInfoStream(const InfoStreamPtr& infoStream);
+    void setMaxFieldLength(int32_t maxFieldLength);
+    void setSimilarity(const SimilarityPtr& similarity);
+
+    /// Get current segment name we are writing.
+    String getSegment();
+
+    /// Returns how many docs are currently buffered in RAM.
+    int32_t getNumDocsInRAM();
+
+    /// Returns the current doc store segment we are writing to.
+    String getDocStoreSegment();
+
+    /// Returns the doc offset into the shared doc store for the current buffered docs.
+    int32_t getDocStoreOffset();
+
+    /// Closes the current open doc stores an returns the doc store segment name.  This returns null if there
+    /// are no buffered documents.
+    String closeDocStore();
+
+    HashSet<String> abortedFiles();
+
+    void message(const String& message);
+
+    /// Returns Collection of files in use by this instance, including any flushed segments.
+    HashSet<String> openFiles();
+    HashSet<String> closedFiles();
+
+    void addOpenFile(const String& name);
+    void removeOpenFile(const String& name);
+
+    void setAborting();
+
+    /// Called if we hit an exception at a bad time (when updating the index files) and must discard all
+    /// currently buffered docs.  This resets our state, discarding any docs and deletes added since last flush.
+    void abort();
+
+    /// Returns true if any documents are buffered.  Deletes buffered here only apply to those documents.
+    bool anyChanges();
+
+    void initFlushState(bool onlyDocStore);
+
+    /// Flush all pending docs to a new segment
+    int32_t flush(bool _closeDocStore);
+
+    HashSet<String> getFlushedFiles();
+
+    /// Build compound file for the segment we just flushed
+    void createCompoundFile(const String& segment);
+
+    void initSegmentName(bool onlyDocStore);
+
+    /// Allocates the docID of the next document, buffering delTerm for the documents before it if non-null.
+    /// Called by DocumentsWriter once the calling thread owns this instance.
+    void startDocument(const TermPtr& delTerm);
+
+    /// Runs the document allocated by {@link #startDocument} through the indexing chain.
+    void processDocument(const DocumentPtr& doc, const AnalyzerPtr& analyzer);
+
+    /// Called when {@link #processDocument} failed.  Marks the partially added document as deleted, or aborts
+    /// if the exception left the buffered documents corrupt.  Returns false if this instance was aborted.
+    bool discardDocument();
+
+    void addDeleteTerm(const TermPtr& term);
+    void addDeleteQuery(const QueryPtr& query);
+
+    /// Returns the RAM used by the buffered documents and deletes.
+    int64_t getRAMUsed();
+
+    /// Returns the RAM allocated by the pools, whether in use or free.
+    int64_t getRAMAllocated();
+
+    IntArray getIntBlock(bool trackAllocations);
+    void bytesAllocated(int64_t numBytes);
+    void bytesUsed(int64_t numBytes);
+    void docValuesBytesUsed(int64_t numBytes);
+    void pointsBytesUsed(int64_t numBytes);
+    void recycleIntBlocks(Collection<IntArray> blocks, int32_t start, int32_t end);
+
+    CharArray getCharBlock();
+    void recycleCharBlocks(Collection<CharArray> blocks, int32_t numBlocks);
+
+    /// Frees recycled allocations from one of the pools, taking turns by iteration: byte blocks, char blocks,
+    /// int blocks, per-doc buffers and then the consumer's own free lists.  Returns true if anything was freed.
+    bool freeRAM(int32_t iteration);
+
+protected:
+    /// Reset after a flush
+    void doAfterFlush();
+
+    /// Buffer a specific docID for deletion.  Currently only used when we hit a exception when adding a document
+    void addDeleteDocID(int32_t docID);
+
+    /// Does the synchronized work to finish/flush the inverted document.
+    void finishDocument(const DocWriterPtr& docWriter);
+
+    void waitForWaitQueue();
+
+    friend class DocumentsWriter;
+    friend class WaitQueue;
+};
+
+}
+
+#endif
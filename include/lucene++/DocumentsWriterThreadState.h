@@ -11,27 +11,21 @@
 
 namespace Lucene {
 
-/// Used by DocumentsWriter to maintain per-thread state.
-/// We keep a separate Posting hash and other state for each thread and then merge postings
-/// hashes from all threads when writing the segment.
+/// Used by DocumentsWriterPerThread to maintain the per-thread state of its indexing chain.
 class DocumentsWriterThreadState : public LuceneObject {
 public:
-    DocumentsWriterThreadState(const DocumentsWriterPtr& docWriter);
+    DocumentsWriterThreadState(const DocumentsWriterPerThreadPtr& docWriter);
     virtual ~DocumentsWriterThreadState();
 
     LUCENE_CLASS(DocumentsWriterThreadState);
 
 public:
-    bool isIdle; // false if this is currently in use by a thread
-    int32_t numThreads; // Number of threads that share this instance
-    bool doFlushAfter; // true if we should flush after processing current doc
     DocConsumerPerThreadPtr consumer;
     DocStatePtr docState;
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
 
 public:
     virtual void initialize();
-    void doAfterFlush();
 };
 
 }
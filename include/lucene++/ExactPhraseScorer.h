@@ -11,15 +11,57 @@
 
 namespace Lucene {
 
+/// Scorer for phrases without slop.  Documents holding every term are found by advancing the rarest term
+/// and skipping the others to each of its documents.  For such a document the positions of every term are
+/// read in one block each, shifted by the term's offset in the phrase and intersected: through a bitset
+/// over the positions the terms have in common when that window is small, and by merging the sorted
+/// positions otherwise.
 class ExactPhraseScorer : public PhraseScorer {
 public:
     ExactPhraseScorer(const WeightPtr& weight, Collection<TermPositionsPtr> tps, Collection<int32_t> offsets, const SimilarityPtr& similarity, ByteArray norms);
+
+    /// @param docFreqs the number of documents holding each term, used to pick the term that leads.
+    ExactPhraseScorer(const WeightPtr& weight, Collection<TermPositionsPtr> tps, Collection<int32_t> offsets, Collection<int32_t> docFreqs, const SimilarityPtr& similarity, ByteArray norms);
     virtual ~ExactPhraseScorer();
 
     LUCENE_CLASS(ExactPhraseScorer);
 
 protected:
+    /// The terms of the phrase, rarest first.
+    Collection<PhrasePositionsPtr> postings;
+
+    /// The positions of each term in the current document, less the term's offset.
+    Collection< Collection<int32_t> > positions;
+    Collection<int32_t> freqs;
+
+    /// How far the merge has got through the positions of each term.
+    Collection<int32_t> cursors;
+
+    /// Words of the position window the terms share, and of the term being added to it.
+    Collection<int64_t> bits;
+    Collection<int64_t> termBits;
+
+    int32_t doc;
+
+public:
+    virtual int32_t docID();
+    virtual int32_t nextDoc();
+    virtual int32_t advance(int32_t target);
+    virtual double score();
+
+protected:
+    void ConstructScorer(Collection<int32_t> docFreqs);
+
+    /// Finds the first document from the current one of the leading term that holds the phrase.
+    int32_t doNextMatch();
+
     virtual double phraseFreq();
+
+    /// Counts the positions from lower to upper held by every term by and-ing their bitsets.
+    int32_t intersectBits(int32_t lower, int32_t upper);
+
+    /// Counts the positions held by every term by merging them into the positions of the least frequent.
+    int32_t intersectPositions();
 };
 
 }
@@ -13,6 +13,10 @@
 namespace Lucene {
 
 /// Maintains caches of term values.
+///
+/// When a segment has doc values for a field, values requested without a custom parser are read from the
+/// doc values column instead of uninverting the field's terms.  {@link #getDocValues} gives the column
+/// itself, which avoids a per-document array altogether.
 /// @see FieldCacheSanityChecker
 class LPPAPI FieldCache {
 public:
@@ -146,6 +150,13 @@ public:
     /// @return Array of terms and index into the array for each document.
     virtual StringIndexPtr getStringIndex(const IndexReaderPtr& reader, const String& field);
 
+    /// Returns the doc values column of field in a segment reader, or null if there is none.  The column is
+    /// decoded once per segment and shared with the reader, not copied into an array of size reader.maxDoc().
+    /// @param reader Used to get field values.
+    /// @param field Which field has doc values.
+    /// @return The column of the field.
+    virtual DocValuesColumnPtr getDocValues(const IndexReaderPtr& reader, const String& field);
+
     /// Generates an array of CacheEntry objects representing all items currently in the FieldCache.
     virtual Collection<FieldCacheEntryPtr> getCacheEntries() = 0;
 
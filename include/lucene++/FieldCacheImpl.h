@@ -43,6 +43,7 @@ public:
 
     virtual Collection<String> getStrings(const IndexReaderPtr& reader, const String& field);
     virtual StringIndexPtr getStringIndex(const IndexReaderPtr& reader, const String& field);
+    virtual DocValuesColumnPtr getDocValues(const IndexReaderPtr& reader, const String& field);
 
     virtual void setInfoStream(const InfoStreamPtr& stream);
     virtual InfoStreamPtr getInfoStream();
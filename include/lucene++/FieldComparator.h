@@ -108,6 +108,9 @@ protected:
     String field;
     TYPE bottom;
 
+    /// Column read in place of currentReaderValues when the current segment has doc values for the field.
+    DocValuesColumnPtr docValues;
+
 public:
     virtual int32_t compare(int32_t slot1, int32_t slot2) {
         return (int32_t)(values[slot1] - values[slot2]);
@@ -176,6 +179,7 @@ protected:
 public:
     virtual int32_t compare(int32_t slot1, int32_t slot2);
     virtual int32_t compareBottom(int32_t doc);
+    virtual void copy(int32_t slot, int32_t doc);
     virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
 };
 
@@ -193,6 +197,7 @@ protected:
 public:
     virtual int32_t compare(int32_t slot1, int32_t slot2);
     virtual int32_t compareBottom(int32_t doc);
+    virtual void copy(int32_t slot, int32_t doc);
     virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
 };
 
@@ -210,6 +215,7 @@ protected:
 public:
     virtual int32_t compare(int32_t slot1, int32_t slot2);
     virtual int32_t compareBottom(int32_t doc);
+    virtual void copy(int32_t slot, int32_t doc);
     virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
 };
 
@@ -245,6 +251,7 @@ public:
 protected:
     Collection<String> values;
     Collection<String> currentReaderValues;
+    DocValuesColumnPtr docValues;
     String field;
     CollatorPtr collator;
     String bottom;
@@ -278,6 +285,15 @@ protected:
     int32_t currentReaderGen;
     Collection<String> lookup;
     Collection<int32_t> order;
+
+    /// Sorted column read in place of order and lookup when the current segment has one for the field.
+    DocValuesColumnPtr docValues;
+    int32_t lookupSize;
+
+    /// UTF-8 of bottomValue and of the key being searched, which are compared with the column's values.
+    BytesRefPtr bottomBytes;
+    BytesRefPtr keyBytes;
+
     String field;
 
     int32_t bottomSlot;
@@ -300,6 +316,12 @@ public:
 protected:
     void convert(int32_t slot);
     int32_t binarySearch(Collection<String> lookup, const String& key, int32_t low, int32_t high);
+
+    /// Same as {@link #binarySearch} over the values of the sorted column.
+    int32_t binarySearchDocValues(const String& key, int32_t low, int32_t high);
+
+    int32_t getOrd(int32_t doc);
+    String getLookup(int32_t ord);
 };
 
 /// Sorts by field's natural String sort order.  All comparisons are done using String.compare, which is
@@ -314,9 +336,13 @@ public:
 protected:
     Collection<String> values;
     Collection<String> currentReaderValues;
+    DocValuesColumnPtr docValues;
     String field;
     String bottom;
 
+    /// UTF-8 of bottom, compared with the values of docValues.
+    BytesRefPtr bottomBytes;
+
 public:
     virtual int32_t compare(int32_t slot1, int32_t slot2);
     virtual int32_t compareBottom(int32_t doc);
@@ -7,7 +7,7 @@
 #ifndef FIELDINFO_H
 #define FIELDINFO_H
 
-#include "LuceneObject.h"
+#include "Fieldable.h"
 
 namespace Lucene {
 
@@ -34,11 +34,21 @@ public:
 
     bool storePayloads; // whether this field stores payloads together with term positions
 
+    Fieldable::DocValuesType docValuesType; // column written to the doc values file, if any
+
+    int32_t pointDimensions; // dimensions of the points written to the points file, or 0
+
 public:
     virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
 
     void update(bool isIndexed, bool storeTermVector, bool storePositionWithTermVector, bool storeOffsetWithTermVector,
                 bool omitNorms, bool storePayloads, bool omitTermFreqAndPositions);
+
+    /// Records the doc values type of the field; a field keeps the same type for life.
+    void setDocValuesType(Fieldable::DocValuesType docValuesType);
+
+    /// Records the number of dimensions of the field's points; a field keeps the same number for life.
+    void setPointDimensions(int32_t pointDimensions);
 };
 
 }
@@ -35,6 +35,12 @@ public:
     // First used in 2.9; prior to 2.9 there was no format header
     static const int32_t FORMAT_START;
 
+    // Adds the doc values type of fields that have one
+    static const int32_t FORMAT_DOC_VALUES;
+
+    // Adds the point dimensions of every field
+    static const int32_t FORMAT_POINTS;
+
     static const int32_t CURRENT_FORMAT;
 
     static const uint8_t IS_INDEXED;
@@ -44,6 +50,7 @@ public:
     static const uint8_t OMIT_NORMS;
     static const uint8_t STORE_PAYLOADS;
     static const uint8_t OMIT_TERM_FREQ_AND_POSITIONS;
+    static const uint8_t HAS_DOC_VALUES;
 
 protected:
     Collection<FieldInfoPtr> byNumber;
@@ -136,6 +143,12 @@ public:
 
     bool hasVectors();
 
+    /// Returns true if any field writes doc values
+    bool hasDocValues();
+
+    /// Returns true if any field writes points
+    bool hasPoints();
+
     void write(const DirectoryPtr& d, const String& name);
     void write(const IndexOutputPtr& output);
 
@@ -22,6 +22,28 @@ public:
     LUCENE_INTERFACE(Fieldable);
     virtual ~Fieldable() {}
 
+public:
+    /// Specifies whether and how a per-document value of the field is written to the segment's doc values
+    /// file, a column that sorting, function queries and the {@link FieldCache} read without uninverting
+    /// the field's terms.
+    enum DocValuesType {
+        /// Do not write doc values.
+        DOC_VALUES_NONE,
+
+        /// Write the value as a 64 bit integer.  Columns are packed to the bits needed by their value range.
+        DOC_VALUES_NUMERIC,
+
+        /// Write the value as a double.
+        DOC_VALUES_DOUBLE,
+
+        /// Write the string value of every document as is.
+        DOC_VALUES_BINARY,
+
+        /// Write the string value as an ordinal into the segment's sorted unique values, the layout of
+        /// {@link StringIndex}.
+        DOC_VALUES_SORTED
+    };
+
 public:
     /// Sets the boost factor hits on this field.  This value will be multiplied into the score of all
     /// hits on this this field of this document.
@@ -145,6 +167,18 @@ public:
     /// positional information, such as {@link PhraseQuery} or {@link SpanQuery} subclasses will silently fail
     /// to find results.
     virtual void setOmitTermFreqAndPositions(bool omitTermFreqAndPositions) = 0;
+
+    /// @see #setDocValuesType
+    virtual DocValuesType getDocValuesType() = 0;
+
+    /// Sets how the value of this field is written to the doc values file.  Numeric types take the field's
+    /// numeric value, or parse its string value.  A field may have at most one value per document.
+    virtual void setDocValuesType(DocValuesType docValuesType) = 0;
+
+    /// Returns the point this field writes to the segment's points file, one sortable long per dimension, or
+    /// null if it writes none.
+    /// @see PointField
+    virtual Collection<int64_t> getPointValue() = 0;
 };
 
 }
@@ -49,6 +49,17 @@ protected:
     CloseableThreadLocal<IndexInput> fieldsStreamTL;
     bool isOriginal;
 
+    // The stream fields of the current document are read from: fieldsStream, or the chunk holding the document
+    IndexInputPtr docStream;
+    FieldsChunkPtr docChunk;
+
+    // Most recently used chunks first
+    Collection<FieldsChunkPtr> chunkCache;
+
+public:
+    /// Number of decompressed chunks kept by each reader, so documents read together are only decompressed once.
+    static const int32_t CHUNK_CACHE_SIZE;
+
 public:
     /// Returns a cloned FieldsReader that shares open IndexInputs with the original one.  It is the caller's job not to
     /// close the original FieldsReader until all clones are called (eg, currently SegmentReader manages this logic).
@@ -75,6 +86,12 @@ protected:
 
     void seekIndex(int32_t docID);
 
+    /// Returns the decompressed chunk starting at pointer in the fields stream.
+    FieldsChunkPtr getChunk(int64_t pointer);
+
+    /// Returns the index of document docID of this reader within chunk.
+    int32_t chunkIndex(const FieldsChunkPtr& chunk, int32_t docID);
+
     /// Skip the field.  We still have to read some of the information about the field, but can skip past the actual content.
     /// This will have the most payoff on large fields.
     void skipField(bool binary, bool compressed);
@@ -96,8 +113,8 @@ protected:
 
 class LazyField : public AbstractField {
 public:
-    LazyField(const FieldsReaderPtr& reader, const String& name, Store store, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed);
-    LazyField(const FieldsReaderPtr& reader, const String& name, Store store, Index index, TermVector termVector, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed);
+    LazyField(const FieldsReaderPtr& reader, const String& name, Store store, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed, const FieldsChunkPtr& chunk = FieldsChunkPtr());
+    LazyField(const FieldsReaderPtr& reader, const String& name, Store store, Index index, TermVector termVector, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed, const FieldsChunkPtr& chunk = FieldsChunkPtr());
     virtual ~LazyField();
 
     LUCENE_CLASS(LazyField);
@@ -105,7 +122,10 @@ public:
 protected:
     FieldsReaderWeakPtr _reader;
     int32_t toRead;
-    int64_t pointer;
+    int64_t pointer; // Into chunk if the field is in a compressed chunk, otherwise into the fields stream
+
+    /// The chunk holding the field, or null if the fields stream is not compressed.
+    FieldsChunkPtr chunk;
 
     /// @deprecated Only kept for backward-compatibility with <3.0 indexes.
     bool isCompressed;
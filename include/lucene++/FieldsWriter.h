@@ -11,6 +11,14 @@
 
 namespace Lucene {
 
+/// Writes stored fields to <segment>.fdt and <segment>.fdx.
+///
+/// Documents are buffered and written to the fields stream in chunks of consecutive documents, compressed
+/// together once a chunk holds {@link #CHUNK_SIZE} bytes or {@link #MAX_CHUNK_DOCS} documents.  A chunk
+/// starts with the number of its first document, the number of documents it holds and the length of each,
+/// followed by the length of the stored data, shifted left by one with the lowest bit set if it is
+/// compressed, and then the data.  Uncompressed, the data is each document as the previous format stored
+/// it.  The index stream still holds one pointer per document, to the chunk holding it.
 class FieldsWriter : public LuceneObject {
 public:
     FieldsWriter(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn);
@@ -25,6 +33,10 @@ protected:
     IndexOutputPtr indexStream;
     bool doClose;
 
+    RAMOutputStreamPtr chunkBuffer; // Documents of the chunk being buffered
+    Collection<int32_t> chunkDocLengths;
+    int32_t numDocs; // Documents written, including those still buffered
+
 public:
     static const uint8_t FIELD_IS_TOKENIZED;
     static const uint8_t FIELD_IS_BINARY;
@@ -33,11 +45,18 @@ public:
     static const int32_t FORMAT; // Original format
     static const int32_t FORMAT_VERSION_UTF8_LENGTH_IN_BYTES; // Changed strings to UTF8
     static const int32_t FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS; // Lucene 3.0: Removal of compressed fields
+    static const int32_t FORMAT_COMPRESSED_CHUNKS; // Documents compressed together in chunks
 
     // NOTE: if you introduce a new format, make it 1 higher than the current one, and always change this
     // if you switch to a new format!
     static const int32_t FORMAT_CURRENT;
 
+    /// Number of buffered bytes at which a chunk is compressed and written.
+    static const int32_t CHUNK_SIZE;
+
+    /// Maximum number of documents in a chunk.
+    static const int32_t MAX_CHUNK_DOCS;
+
 public:
     void setFieldsStream(const IndexOutputPtr& stream);
 
@@ -55,6 +74,18 @@ public:
     void addRawDocuments(const IndexInputPtr& stream, Collection<int32_t> lengths, int32_t numDocs);
 
     void addDocument(const DocumentPtr& doc);
+
+protected:
+    void writeField(const IndexOutputPtr& out, const FieldInfoPtr& fi, const FieldablePtr& field);
+
+    /// Adds the index entry of a document about to be buffered, and returns where it starts in the chunk.
+    int64_t startDocument();
+
+    /// Records the length of the document just buffered, and writes the chunk if it is full.
+    void finishDocument(int64_t start);
+
+    /// Compresses the buffered documents and writes them to the fields stream.
+    void flushChunk();
 };
 
 }
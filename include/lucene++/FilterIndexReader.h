@@ -48,6 +48,9 @@ public:
     virtual bool hasNorms(const String& field);
     virtual ByteArray norms(const String& field);
     virtual void norms(const String& field, ByteArray norms, int32_t offset);
+    virtual double maxNorm(const String& field);
+    virtual DocValuesColumnPtr getDocValuesColumn(const String& field);
+    virtual PointValuesPtr getPointValues(const String& field);
     virtual TermEnumPtr terms();
     virtual TermEnumPtr terms(const TermPtr& t);
     virtual int32_t docFreq(const TermPtr& t);
@@ -36,6 +36,24 @@ public:
     int32_t lastDocID;
     int32_t df;
 
+    /// Set when doc deltas and freqs are written in {@link PForUtils} blocks
+    bool packedPostings;
+    IntArray blockDocDeltas;
+    IntArray blockFreqs; // freq - 1, so that blocks of single occurrences pack to nothing
+    int32_t blockCount;
+    ByteArray blockScratch;
+
+    /// Largest freq of the last block written and of the whole term, recorded with the skip entries so that
+    /// scorers can bound the score of documents they have not read yet
+    int32_t blockMaxFreq;
+    int32_t termMaxFreq;
+
+    /// One entry per packed block followed by more docs, written after the term's postings and its max freq
+    RAMOutputStreamPtr blockSkipBuffer;
+    int32_t lastBlockSkipDoc;
+    int64_t lastBlockSkipFreqPointer;
+    int64_t lastBlockSkipProxPointer;
+
     TermInfoPtr termInfo; // minimize consing
     UTF8ResultPtr utf8;
 
@@ -51,6 +69,16 @@ public:
     virtual void finish();
 
     void close();
+
+protected:
+    /// Write the buffered block of doc deltas and freqs.
+    void writeBlock();
+
+    /// Record where the block following the one just written starts.
+    void bufferBlockSkip();
+
+    /// Write the docs left over after the last full block as legacy VInts.
+    void writeTail();
 };
 
 }
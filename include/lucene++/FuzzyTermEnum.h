@@ -7,7 +7,7 @@
 #ifndef FUZZYTERMENUM_H
 #define FUZZYTERMENUM_H
 
-#include "FilteredTermEnum.h"
+#include "AutomatonTermEnum.h"
 
 namespace Lucene {
 
@@ -15,7 +15,10 @@ namespace Lucene {
 ///
 /// Term enumerations are always ordered by Term.compareTo().  Each term in the enumeration is greater
 /// than all that precede it.
-class LPPAPI FuzzyTermEnum : public FilteredTermEnum {
+///
+/// When the maximum edit distance is small the terms dictionary is intersected with a Levenshtein automaton,
+/// so only terms within reach of the search term are read and scored.
+class LPPAPI FuzzyTermEnum : public AutomatonTermEnum {
 public:
     /// Constructor for enumeration of all terms from specified reader which share a prefix of length
     /// prefixLength with term and which have a fuzzy similarity > minSimilarity.
@@ -34,6 +37,11 @@ public:
 
     LUCENE_CLASS(FuzzyTermEnum);
 
+public:
+    /// Largest edit distance for which a Levenshtein automaton is built; above it every term sharing the
+    /// prefix is scored.
+    static const int32_t MAX_AUTOMATON_EDITS;
+
 protected:
     /// Allows us save time required to create a new array every time similarity is called.
     Collection<int32_t> p;
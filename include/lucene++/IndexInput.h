@@ -56,6 +56,11 @@ public:
     /// @see IndexOutput#writeVInt(int32_t)
     virtual int32_t readVInt();
 
+    /// Reads count ints stored in variable-length format into values.  Implementations that hold the
+    /// underlying bytes in memory decode them in bulk.
+    /// @see #readVInt()
+    virtual void readVInts(int32_t* values, int32_t count);
+
     /// Reads eight bytes and returns a int64.
     /// @see IndexOutput#writeLong(int64_t)
     virtual int64_t readLong();
@@ -96,7 +96,7 @@ public:
     /// system to pre-allocate the file to the specified size.  If the length is longer than the current file length,
     /// the bytes added to the file are undefined.  Otherwise the file is truncated.
     /// @param length file length.
-    void setLength(int64_t length);
+    virtual void setLength(int64_t length);
 
     /// Write string map as a series of key/value pairs.
     /// @param map map of string-string key-values.
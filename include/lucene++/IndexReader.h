@@ -380,6 +380,26 @@ public:
     /// @see Field#setBoost(double)
     virtual void norms(const String& field, ByteArray norms, int32_t offset) = 0;
 
+    /// Returns the largest decoded norm of the documents with tokens in the named field, or 1 if the field
+    /// has no norms.  This bounds the scores of the field's terms.  A {@link SegmentReader} computes it once
+    /// and keeps it with the field's norms; other readers scan the norms on every call.
+    virtual double maxNorm(const String& field);
+
+    /// Returns the largest decoded value of the given norms, skipping documents without tokens, or 1 when
+    /// there are no norms.
+    static double decodeMaxNorm(ByteArray norms);
+
+    /// Loads the doc values written for the named field, or returns null if the field has none or this
+    /// reader is made of several segments.  Every call reads the column again, so callers should keep it;
+    /// the {@link FieldCache} does.
+    /// @see Fieldable#setDocValuesType
+    virtual DocValuesColumnPtr getDocValuesColumn(const String& field);
+
+    /// Returns the point tree written for the named field, or null if the field has no points or this
+    /// reader is made of several segments.
+    /// @see PointField
+    virtual PointValuesPtr getPointValues(const String& field);
+
     /// Resets the normalization factor for the named field of the named  document.  The norm represents
     /// the product of the field's {@link Fieldable#setBoost(double) boost} and its {@link
     /// Similarity#lengthNorm(String, int) length normalization}.  Thus, to preserve the length normalization
@@ -51,6 +51,21 @@ protected:
     bool fieldSortDoTrackScores;
     bool fieldSortDoMaxScore;
 
+    /// Pool used to search slices concurrently, null to search on the calling thread.
+    ThreadPoolPtr executor;
+
+    /// Limiter the latency of each search is reported to, or null.
+    MergeRateLimiterPtr rateLimiter;
+
+    /// Sub-reader index and doc id range [min, max) of each slice.
+    Collection<int32_t> sliceReaders;
+    Collection<int32_t> sliceMinDocs;
+    Collection<int32_t> sliceMaxDocs;
+
+public:
+    /// Default maximum number of documents in one slice, see {@link #setExecutor}.
+    static const int32_t DEFAULT_MAX_SLICE_DOCS;
+
 public:
     /// Return the {@link IndexReader} this searches.
     IndexReaderPtr getIndexReader();
@@ -91,10 +106,36 @@ public:
     /// @param doMaxScore If true, then the max score for all matching docs is computed.
     virtual void setDefaultFieldSortScoring(bool doTrackScores, bool doMaxScore);
 
+    /// Search segments concurrently on the given pool.  Segments with more than maxSliceDocs documents are
+    /// split into doc id slices of that size.  Each slice is collected into its own top hits collector and
+    /// the results are merged on the calling thread.  This applies to the methods returning {@link TopDocs}
+    /// or {@link TopFieldDocs}; searches with a caller-supplied {@link Collector} still run sequentially.
+    /// Pass a null pool to go back to sequential searching.
+    virtual void setExecutor(const ThreadPoolPtr& executor, int32_t maxSliceDocs = DEFAULT_MAX_SLICE_DOCS);
+
+    /// Return the pool used to search slices concurrently, or null.
+    ThreadPoolPtr getExecutor();
+
+    /// Report the latency of every search to the given limiter, so that merges throttled by it back off
+    /// while searches are slower than its target.  Pass null to stop reporting.
+    /// @see MergeRateLimiter#setTargetLatency
+    virtual void setMergeRateLimiter(const MergeRateLimiterPtr& rateLimiter);
+
+    /// Return the limiter search latencies are reported to, or null.
+    MergeRateLimiterPtr getMergeRateLimiter();
+
 protected:
     void ConstructSearcher(const IndexReaderPtr& reader, bool closeReader);
     void gatherSubReaders(Collection<IndexReaderPtr> allSubReaders, const IndexReaderPtr& reader);
     void searchWithFilter(const IndexReaderPtr& reader, const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& collector);
+
+    /// Search every slice on the executor and merge the per-slice top hits.
+    TopDocsPtr searchSlices(const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort);
+
+    /// Collect the hits of one slice.
+    void searchSlice(int32_t slice, const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& collector);
+
+    friend class IndexSearcherSlice;
 };
 
 }
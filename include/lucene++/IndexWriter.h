@@ -101,14 +101,15 @@ public:
 
     LUCENE_CLASS(IndexWriter);
 
-protected:
-    int64_t writeLockTimeout;
-
     /// The normal read buffer size defaults to 1024, but increasing this during merging seems to
     /// yield performance gains.  However we don't want to increase it too much because there are
-    /// quite a few BufferedIndexInputs created during merging.
+    /// quite a few BufferedIndexInputs created during merging.  Directories can also tell from it
+    /// that a file is opened to be merged.
     static const int32_t MERGE_READ_BUFFER_SIZE;
 
+protected:
+    int64_t writeLockTimeout;
+
     SynchronizePtr messageIDLock;
     static int32_t MESSAGE_ID;
     int32_t messageID;
@@ -144,11 +145,16 @@ protected:
     LockPtr writeLock;
 
     int32_t termIndexInterval;
+    bool usePackedPostings;
+    SortPtr indexSort;
 
     bool closed;
     bool closing;
 
     SetSegmentInfo mergingSegments;
+
+    /// Segments flushed in an index sort whose order has not been checked yet.
+    Collection<SegmentInfoPtr> flushedUnchecked;
     MergePolicyPtr mergePolicy;
     MergeSchedulerPtr mergeScheduler;
     Collection<OneMergePtr> pendingMerges;
@@ -228,6 +234,9 @@ public:
     /// Default value is 10,000. Change using {@link #setMaxFieldLength(int32_t)}.
     static const int32_t DEFAULT_MAX_FIELD_LENGTH;
 
+    /// Default value is 8. Change using {@link #setMaxThreadStates(int32_t)}.
+    static const int32_t DEFAULT_MAX_THREAD_STATES;
+
     /// Default value is 128. Change using {@link #setTermIndexInterval(int32_t)}.
     static const int32_t DEFAULT_TERM_INDEX_INTERVAL;
 
@@ -299,6 +308,10 @@ public:
     /// the segmentInfo's delCount is returned.
     virtual int32_t numDeletedDocs(const SegmentInfoPtr& info);
 
+    /// Returns a snapshot of the segments that registered merges are currently merging, so merge
+    /// policies can leave those segments out of new merges.
+    virtual SetSegmentInfo getMergingSegments();
+
     virtual void acquireWrite();
     virtual void releaseWrite();
     virtual void acquireRead();
@@ -358,6 +371,29 @@ public:
     /// @see #setTermIndexInterval(int32_t)
     virtual int32_t getTermIndexInterval();
 
+    /// Determines whether newly flushed and merged segments write doc deltas and freqs in bit-packed blocks
+    /// (frame of reference with patched exceptions) instead of one VInt per value.  Packed postings are
+    /// smaller for frequent terms and much faster to decode, but can only be read by versions that know the
+    /// format.  Existing segments are left as they are until merged; readers handle both formats.
+    /// Default value is false.
+    virtual void setUsePackedPostings(bool value);
+
+    /// Returns true if new segments are written with packed postings.
+    /// @see #setUsePackedPostings(bool)
+    virtual bool getUsePackedPostings();
+
+    /// Keeps the documents of every segment ordered by the given sort.  Each merge writes its documents in
+    /// sort order, and segments that were flushed or added unsorted are rewritten in sort order on their own
+    /// by the merge scheduler.  A flushed segment whose documents were added in sort order is kept as it is.
+    /// A {@link TopFieldCollector} searching with this sort, or a leading part of it, stops collecting a
+    /// sorted segment at its first hit that is not competitive.  The sort must not use relevance, and its
+    /// fields must be usable with the {@link FieldCache}.  Pass null to stop sorting.  Default value is null.
+    virtual void setIndexSort(const SortPtr& sort);
+
+    /// Returns the sort segments are kept in, or null.
+    /// @see #setIndexSort(SortPtr)
+    virtual SortPtr getIndexSort();
+
     /// Set the merge policy used by this writer.
     virtual void setMergePolicy(const MergePolicyPtr& mp);
 
@@ -475,6 +511,19 @@ public:
     /// @see #setMaxBufferedDeleteTerms
     virtual int32_t getMaxBufferedDeleteTerms();
 
+    /// Sets the maximum number of in-memory segments that documents are buffered in concurrently.  Each
+    /// indexing thread adds documents to its own in-memory segment, and a segment that is full is flushed
+    /// while the other threads keep indexing into theirs.  If more threads than this are indexing at once,
+    /// they share the in-memory segments.  The RAM buffer set by {@link #setRAMBufferSizeMB} is shared by
+    /// all of them.
+    ///
+    /// The default value is {@link #DEFAULT_MAX_THREAD_STATES}.
+    virtual void setMaxThreadStates(int32_t maxThreadStates);
+
+    /// Returns the maximum number of in-memory segments.
+    /// @see #setMaxThreadStates
+    virtual int32_t getMaxThreadStates();
+
     /// Determines how often segment indices are merged by addDocument().  With smaller values, less
     /// RAM is used while indexing, and searches on unoptimized indices are faster, but indexing
     /// speed is slower.  With larger values, more RAM is used during indexing, and while searches
@@ -975,10 +1024,6 @@ protected:
     virtual bool shouldClose();
     virtual void closeInternal(bool waitForMerges);
 
-    /// Tells the docWriter to close its currently open shared doc stores (stored fields & vectors
-    /// files).  Return value specifies whether new doc store files are compound or not.
-    virtual bool flushDocStores();
-
     /// Returns true if any merges in pendingMerges or runningMerges are optimization merges.
     virtual bool optimizeMergesPending();
 
@@ -986,6 +1031,19 @@ protected:
     virtual void maybeMerge(int32_t maxNumSegmentsOptimize, bool optimize);
     virtual void updatePendingMerges(int32_t maxNumSegmentsOptimize, bool optimize);
 
+    /// Registers a single segment merge for every segment not yet written in index sort order.
+    virtual void registerSortMerges(int32_t maxNumSegmentsOptimize, bool optimize);
+
+    /// Returns true if the segment's documents are in index sort order.
+    virtual bool isSorted(const SegmentInfoPtr& info);
+
+    /// Marks the segments flushed since the last call sorted if their documents happen to be in index sort
+    /// order already.  Runs outside the writer's lock, as it reads the sort values of every document.
+    virtual void checkFlushedOrder();
+
+    /// Returns true if the documents of a newly flushed segment happen to be in index sort order already.
+    virtual bool isFlushedInOrder(const SegmentInfoPtr& info);
+
     /// Like {@link #getNextMerge()} except only returns a merge if it's external.
     virtual OneMergePtr getNextExternalMerge();
 
@@ -1039,20 +1097,26 @@ protected:
 
     /// Flush all in-memory buffered updates (adds and deletes) to the Directory.
     /// @param triggerMerge if true, we may merge segments (if deletes or docs were flushed) if necessary
-    /// @param flushDocStores if false we are allowed to keep doc stores open to share with the next segment
+    /// @param flushDocStores if false only the in-memory segments that are full are flushed, without
+    /// waiting for threads that are indexing into the others
     /// @param flushDeletes whether pending deletes should also be flushed
     virtual void flush(bool triggerMerge, bool flushDocStores, bool flushDeletes);
     virtual bool doFlush(bool flushDocStores, bool flushDeletes);
     virtual bool doFlushInternal(bool flushDocStores, bool flushDeletes);
 
+    /// Writes the documents buffered by perThread as a new segment, adds it to the index and applies the
+    /// deletes buffered against it.  Returns false if there was nothing to flush.
+    virtual bool flushSegment(const DocumentsWriterPerThreadPtr& perThread);
+
     virtual int32_t ensureContiguousMerge(const OneMergePtr& merge);
 
     /// Carefully merges deletes for the segments we just merged.  This is tricky because, although merging
     /// will clear all deletes (compacts the documents), new deletes may have been flushed to the segments
     /// since the merge was started.  This method "carries over" such new deletes onto the newly merged
     /// segment, and saves the resulting deletes file (incrementing the delete generation for merge.info).
-    /// If no deletes were flushed, no new deletes file is saved.
-    virtual void commitMergedDeletes(const OneMergePtr& merge, const SegmentReaderPtr& mergeReader);
+    /// If no deletes were flushed, no new deletes file is saved.  docMaps, when not null, gives each source
+    /// document's position among the merged documents of its segment, which is how sorted merges reorder them.
+    virtual void commitMergedDeletes(const OneMergePtr& merge, const SegmentReaderPtr& mergeReader, Collection< Collection<int32_t> > docMaps);
     virtual bool commitMerge(const OneMergePtr& merge, const SegmentMergerPtr& merger, int32_t mergedDocCount, const SegmentReaderPtr& mergedReader);
 
     virtual LuceneException handleMergeException(const LuceneException& exc, const OneMergePtr& merge);
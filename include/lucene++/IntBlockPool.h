@@ -13,7 +13,7 @@ namespace Lucene {
 
 class IntBlockPool : public LuceneObject {
 public:
-    IntBlockPool(const DocumentsWriterPtr& docWriter, bool trackAllocations);
+    IntBlockPool(const DocumentsWriterPerThreadPtr& docWriter, bool trackAllocations);
     virtual ~IntBlockPool();
 
     LUCENE_CLASS(IntBlockPool);
@@ -29,7 +29,7 @@ public:
     bool trackAllocations;
 
 protected:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
 
 public:
     void reset();
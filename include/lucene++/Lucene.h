@@ -190,7 +190,7 @@ typedef WeakHashMap< LuceneObjectWeakPtr, LuceneObjectPtr, luceneWeakHash<Lucene
 typedef WeakHashMap< LuceneObjectWeakPtr, MapEntryAny, luceneWeakHash<LuceneObjectWeakPtr>, luceneWeakEquals<LuceneObjectWeakPtr> > WeakMapLuceneObjectMapEntryAny;
 
 typedef Map< String, AttributePtr > MapStringAttribute;
-typedef Map< int64_t, DocumentsWriterThreadStatePtr > MapThreadDocumentsWriterThreadState;
+typedef Map< int64_t, DocumentsWriterPerThreadPtr > MapThreadDocumentsWriterPerThread;
 typedef Map< String, IndexReaderPtr > MapStringIndexReader;
 typedef Map< TermPtr, NumPtr, luceneCompare<TermPtr> > MapTermNum;
 
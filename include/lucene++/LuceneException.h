@@ -42,7 +42,8 @@ public:
         Temporary,
         TimeExceeded,
         TooManyClauses,
-        UnsupportedOperation
+        UnsupportedOperation,
+        CollectionTerminated
     };
 
     LuceneException(const String& error = EmptyString, LuceneException::ExceptionType type = Null) throw();
@@ -78,6 +79,7 @@ typedef ExceptionTemplate<RuntimeException, LuceneException::IllegalArgument> Il
 typedef ExceptionTemplate<RuntimeException, LuceneException::IndexOutOfBounds> IndexOutOfBoundsException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::NullPointer> NullPointerException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::FieldReader> FieldReaderException;
+typedef ExceptionTemplate<LuceneException, LuceneException::CollectionTerminated> CollectionTerminatedException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::Merge> MergeException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::StopFillCache> StopFillCacheException;
 typedef ExceptionTemplate<RuntimeException, LuceneException::TimeExceeded> TimeExceededException;
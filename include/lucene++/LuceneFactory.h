@@ -8,57 +8,74 @@
 #define LUCENEFACTORY_H
 
 #include <memory>
+#include "SearchArena.h"
 
 namespace Lucene {
 
 template <class T>
 std::shared_ptr<T> newInstance() {
-    return std::make_shared<T>();
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena)) : std::make_shared<T>();
 }
 
 template <class T, class A1>
 std::shared_ptr<T> newInstance(A1 const& a1) {
-    return std::make_shared<T>(a1);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1) : std::make_shared<T>(a1);
 }
 
 template <class T, class A1, class A2>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2) {
-    return std::make_shared<T>(a1, a2);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2) : std::make_shared<T>(a1, a2);
 }
 
 template <class T, class A1, class A2, class A3>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3) {
-    return std::make_shared<T>(a1, a2, a3);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3) : std::make_shared<T>(a1, a2, a3);
 }
 
 template <class T, class A1, class A2, class A3, class A4>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4) {
-    return std::make_shared<T>(a1, a2, a3, a4);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3, a4) : std::make_shared<T>(a1, a2, a3, a4);
 }
 
 template <class T, class A1, class A2, class A3, class A4, class A5>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4, A5 const& a5) {
-    return std::make_shared<T>(a1, a2, a3, a4, a5);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3, a4, a5) : std::make_shared<T>(a1, a2, a3, a4, a5);
 }
 
 template <class T, class A1, class A2, class A3, class A4, class A5, class A6>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4, A5 const& a5, A6 const& a6) {
-    return std::make_shared<T>(a1, a2, a3, a4, a5, a6);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3, a4, a5, a6) : std::make_shared<T>(a1, a2, a3, a4, a5, a6);
 }
 
 template <class T, class A1, class A2, class A3, class A4, class A5, class A6, class A7>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4, A5 const& a5, A6 const& a6, A7 const& a7) {
-    return std::make_shared<T>(a1, a2, a3, a4, a5, a6, a7);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3, a4, a5, a6, a7) : std::make_shared<T>(a1, a2, a3, a4, a5, a6, a7);
 }
 
 template <class T, class A1, class A2, class A3, class A4, class A5, class A6, class A7, class A8>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4, A5 const& a5, A6 const& a6, A7 const& a7, A8 const& a8) {
-    return std::make_shared<T>(a1, a2, a3, a4, a5, a6, a7, a8);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3, a4, a5, a6, a7, a8) : std::make_shared<T>(a1, a2, a3, a4, a5, a6, a7, a8);
 }
 
 template <class T, class A1, class A2, class A3, class A4, class A5, class A6, class A7, class A8, class A9>
 std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4, A5 const& a5, A6 const& a6, A7 const& a7, A8 const& a8, A9 const& a9) {
-    return std::make_shared<T>(a1, a2, a3, a4, a5, a6, a7, a8, a9);
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3, a4, a5, a6, a7, a8, a9) : std::make_shared<T>(a1, a2, a3, a4, a5, a6, a7, a8, a9);
+}
+
+template <class T, class A1, class A2, class A3, class A4, class A5, class A6, class A7, class A8, class A9, class A10>
+std::shared_ptr<T> newInstance(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4, A5 const& a5, A6 const& a6, A7 const& a7, A8 const& a8, A9 const& a9, A10 const& a10) {
+    SearchArena* arena = SearchArena::current();
+    return arena ? std::allocate_shared<T>(ArenaAllocator<T>(arena), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10) : std::make_shared<T>(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10);
 }
 
 template <class T>
@@ -131,6 +148,13 @@ std::shared_ptr<T> newLucene(A1 const& a1, A2 const& a2, A3 const& a3, A4 const&
     return instance;
 }
 
+template <class T, class A1, class A2, class A3, class A4, class A5, class A6, class A7, class A8, class A9, class A10>
+std::shared_ptr<T> newLucene(A1 const& a1, A2 const& a2, A3 const& a3, A4 const& a4, A5 const& a5, A6 const& a6, A7 const& a7, A8 const& a8, A9 const& a9, A10 const& a10) {
+    std::shared_ptr<T> instance(newInstance<T>(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10));
+    instance->initialize();
+    return instance;
+}
+
 }
 
 #endif
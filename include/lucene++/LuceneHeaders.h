@@ -50,6 +50,7 @@
 #include "Term.h"
 #include "TermDocs.h"
 #include "TermEnum.h"
+#include "TieredMergePolicy.h"
 
 // Include most common files: queryparser
 #include "MultiFieldQueryParser.h"
@@ -79,6 +79,7 @@ DECLARE_SHARED_PTR(LoadFirstFieldSelector)
 DECLARE_SHARED_PTR(MapFieldSelector)
 DECLARE_SHARED_PTR(NumberTools)
 DECLARE_SHARED_PTR(NumericField)
+DECLARE_SHARED_PTR(PointField)
 DECLARE_SHARED_PTR(SetBasedFieldSelector)
 
 // index
@@ -121,13 +122,20 @@ DECLARE_SHARED_PTR(DocInverterPerField)
 DECLARE_SHARED_PTR(DocInverterPerThread)
 DECLARE_SHARED_PTR(DocState)
 DECLARE_SHARED_PTR(DocumentsWriter)
+DECLARE_SHARED_PTR(DocumentsWriterPerThread)
 DECLARE_SHARED_PTR(DocumentsWriterThreadState)
+DECLARE_SHARED_PTR(DocValuesColumn)
+DECLARE_SHARED_PTR(DocValuesReader)
+DECLARE_SHARED_PTR(DocValuesWriter)
+DECLARE_SHARED_PTR(DocValuesWriterPerThread)
 DECLARE_SHARED_PTR(DocWriter)
 DECLARE_SHARED_PTR(FieldInfo)
 DECLARE_SHARED_PTR(FieldInfos)
 DECLARE_SHARED_PTR(FieldInvertState)
 DECLARE_SHARED_PTR(FieldNormStatus)
 DECLARE_SHARED_PTR(FieldSortedTermVectorMapper)
+DECLARE_SHARED_PTR(FieldsChunk)
+DECLARE_SHARED_PTR(FieldsChunkInput)
 DECLARE_SHARED_PTR(FieldsReader)
 DECLARE_SHARED_PTR(FieldsReaderLocal)
 DECLARE_SHARED_PTR(FieldsWriter)
@@ -171,6 +179,8 @@ DECLARE_SHARED_PTR(LogByteSizeMergePolicy)
 DECLARE_SHARED_PTR(LogDocMergePolicy)
 DECLARE_SHARED_PTR(LogMergePolicy)
 DECLARE_SHARED_PTR(MergeDocIDRemapper)
+DECLARE_SHARED_PTR(MergePointVisitor)
+DECLARE_SHARED_PTR(MergeRateLimiter)
 DECLARE_SHARED_PTR(MergePolicy)
 DECLARE_SHARED_PTR(MergeScheduler)
 DECLARE_SHARED_PTR(MergeSpecification)
@@ -197,6 +207,11 @@ DECLARE_SHARED_PTR(ParallelTermDocs)
 DECLARE_SHARED_PTR(ParallelTermPositions)
 DECLARE_SHARED_PTR(Payload)
 DECLARE_SHARED_PTR(PerDocBuffer)
+DECLARE_SHARED_PTR(PointsReader)
+DECLARE_SHARED_PTR(PointsWriter)
+DECLARE_SHARED_PTR(PointsWriterPerThread)
+DECLARE_SHARED_PTR(PointValues)
+DECLARE_SHARED_PTR(PointVisitor)
 DECLARE_SHARED_PTR(PositionBasedTermVectorMapper)
 DECLARE_SHARED_PTR(RawPostingList)
 DECLARE_SHARED_PTR(ReaderCommit)
@@ -212,6 +227,7 @@ DECLARE_SHARED_PTR(SegmentInfoStatus)
 DECLARE_SHARED_PTR(SegmentMergeInfo)
 DECLARE_SHARED_PTR(SegmentMergeQueue)
 DECLARE_SHARED_PTR(SegmentMerger)
+DECLARE_SHARED_PTR(SegmentMergerPart)
 DECLARE_SHARED_PTR(SegmentReader)
 DECLARE_SHARED_PTR(SegmentReaderRef)
 DECLARE_SHARED_PTR(SegmentTermDocs)
@@ -249,6 +265,7 @@ DECLARE_SHARED_PTR(TermsHashConsumerPerField)
 DECLARE_SHARED_PTR(TermsHashConsumerPerThread)
 DECLARE_SHARED_PTR(TermsHashPerField)
 DECLARE_SHARED_PTR(TermsHashPerThread)
+DECLARE_SHARED_PTR(TermsIndexFST)
 DECLARE_SHARED_PTR(TermVectorEntry)
 DECLARE_SHARED_PTR(TermVectorEntryFreqSortedComparator)
 DECLARE_SHARED_PTR(TermVectorMapper)
@@ -262,6 +279,7 @@ DECLARE_SHARED_PTR(TermVectorsTermsWriterPerThread)
 DECLARE_SHARED_PTR(TermVectorsTermsWriterPostingList)
 DECLARE_SHARED_PTR(TermVectorsWriter)
 DECLARE_SHARED_PTR(TermVectorsPositionInfo)
+DECLARE_SHARED_PTR(TieredMergePolicy)
 DECLARE_SHARED_PTR(WaitQueue)
 
 // query parser
@@ -371,6 +389,7 @@ DECLARE_SHARED_PTR(HitQueue)
 DECLARE_SHARED_PTR(HitQueueBase)
 DECLARE_SHARED_PTR(IDFExplanation)
 DECLARE_SHARED_PTR(IndexSearcher)
+DECLARE_SHARED_PTR(IndexSearcherSlice)
 DECLARE_SHARED_PTR(IntCache)
 DECLARE_SHARED_PTR(IntFieldSource)
 DECLARE_SHARED_PTR(IntParser)
@@ -411,6 +430,9 @@ DECLARE_SHARED_PTR(PhrasePositions)
 DECLARE_SHARED_PTR(PhraseQuery)
 DECLARE_SHARED_PTR(PhraseQueue)
 DECLARE_SHARED_PTR(PhraseScorer)
+DECLARE_SHARED_PTR(PointRangeFilter)
+DECLARE_SHARED_PTR(PointRangeQuery)
+DECLARE_SHARED_PTR(PointRangeVisitor)
 DECLARE_SHARED_PTR(PositionInfo)
 DECLARE_SHARED_PTR(PositiveScoresOnlyCollector)
 DECLARE_SHARED_PTR(PrefixFilter)
@@ -506,6 +528,8 @@ DECLARE_SHARED_PTR(RAMDirectory)
 DECLARE_SHARED_PTR(RAMFile)
 DECLARE_SHARED_PTR(RAMInputStream)
 DECLARE_SHARED_PTR(RAMOutputStream)
+DECLARE_SHARED_PTR(RateLimitedDirectory)
+DECLARE_SHARED_PTR(RateLimitedIndexOutput)
 DECLARE_SHARED_PTR(SimpleFSDirectory)
 DECLARE_SHARED_PTR(SimpleFSIndexInput)
 DECLARE_SHARED_PTR(SimpleFSIndexOutput)
@@ -519,9 +543,11 @@ DECLARE_SHARED_PTR(Attribute)
 DECLARE_SHARED_PTR(AttributeFactory)
 DECLARE_SHARED_PTR(AttributeSource)
 DECLARE_SHARED_PTR(AttributeSourceState)
+DECLARE_SHARED_PTR(Automaton)
 DECLARE_SHARED_PTR(BitSet)
 DECLARE_SHARED_PTR(BitVector)
 DECLARE_SHARED_PTR(BufferedReader)
+DECLARE_SHARED_PTR(BytesRef)
 DECLARE_SHARED_PTR(Collator)
 DECLARE_SHARED_PTR(DefaultAttributeFactory)
 DECLARE_SHARED_PTR(DocIdBitSet)
@@ -543,9 +569,14 @@ DECLARE_SHARED_PTR(NumericUtils)
 DECLARE_SHARED_PTR(OpenBitSet)
 DECLARE_SHARED_PTR(OpenBitSetDISI)
 DECLARE_SHARED_PTR(OpenBitSetIterator)
+DECLARE_SHARED_PTR(PackedLongs)
 DECLARE_SHARED_PTR(Random)
 DECLARE_SHARED_PTR(Reader)
 DECLARE_SHARED_PTR(ReaderField)
+DECLARE_SHARED_PTR(RoaringContainer)
+DECLARE_SHARED_PTR(RoaringDocIdSet)
+DECLARE_SHARED_PTR(RoaringDocIdSetBuilder)
+DECLARE_SHARED_PTR(RoaringDocIdSetIterator)
 DECLARE_SHARED_PTR(ScorerDocQueue)
 DECLARE_SHARED_PTR(SortedVIntList)
 DECLARE_SHARED_PTR(StringReader)
@@ -13,6 +13,10 @@ namespace Lucene {
 
 /// File-based {@link Directory} implementation that uses mmap for reading, and {@link SimpleFSIndexOutput} for writing.
 ///
+/// Files are read straight from the mapping with 64-bit offsets, and each mapping is given an access pattern hint:
+/// random for the term dictionary, stored fields and term vectors, sequential for files opened by a merge.  With
+/// {@link #setPreload(bool)} every page of a file is faulted in when it is opened.
+///
 /// NOTE: memory mapping uses up a portion of the virtual memory address space in your process equal to the size of the
 /// file being mapped.  Before using this class, be sure your have plenty of virtual address space.
 ///
@@ -30,14 +34,37 @@ public:
 
     LUCENE_CLASS(MMapDirectory);
 
+public:
+    /// How a mapped file is expected to be read.
+    enum ReadAdvice {
+        ADVICE_NORMAL,
+        ADVICE_RANDOM,
+        ADVICE_SEQUENTIAL
+    };
+
+protected:
+    bool preload;
+
 public:
     using FSDirectory::openInput;
 
+    /// Set to true to fault in every page of a file when it is opened, so that the first searches don't wait on
+    /// disk.  Defaults to false.
+    void setPreload(bool preload);
+
+    /// @see #setPreload(bool)
+    bool getPreload();
+
     /// Creates an IndexInput for the file with the given name.
     virtual IndexInputPtr openInput(const String& name, int32_t bufferSize);
 
     /// Creates an IndexOutput for the file with the given name.
     virtual IndexOutputPtr createOutput(const String& name);
+
+protected:
+    /// Returns the access pattern hint for the named file.  Merges open their readers with {@link
+    /// IndexWriter#MERGE_READ_BUFFER_SIZE}, which marks their files as read sequentially.
+    virtual ReadAdvice readAdvice(const String& name, int32_t bufferSize);
 };
 
 }
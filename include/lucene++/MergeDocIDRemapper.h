@@ -11,9 +11,9 @@
 
 namespace Lucene {
 
-/// Remaps docIDs after a merge has completed, where the merged segments had at least one deletion.
-/// This is used to renumber the buffered deletes in IndexWriter when a merge of segments with deletions
-/// commits.
+/// Remaps docIDs after a merge has completed, where the merged segments had at least one deletion or
+/// the merge reordered their documents into the index sort.  This is used to renumber the buffered deletes
+/// in IndexWriter when such a merge commits.
 class MergeDocIDRemapper : public LuceneObject {
 public:
     MergeDocIDRemapper(const SegmentInfosPtr& infos, Collection< Collection<int32_t> > docMaps, Collection<int32_t> delCounts, const OneMergePtr& merge, int32_t mergedDocCount);
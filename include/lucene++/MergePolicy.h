@@ -90,6 +90,9 @@ public:
     int32_t maxNumSegmentsOptimize; // used by IndexWriter
     Collection<SegmentReaderPtr> readers; // used by IndexWriter
     Collection<SegmentReaderPtr> readersClone; // used by IndexWriter
+    ThreadPoolPtr executor; // set by the MergeScheduler; runs the independent parts of the merge in parallel
+    MergeRateLimiterPtr rateLimiter; // set by the MergeScheduler; throttles the merge's writes
+    SortPtr indexSort; // set by IndexWriter; the merged documents are written in this order
 
     SegmentInfosPtr segments;
     bool useCompoundFile;
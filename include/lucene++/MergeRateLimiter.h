@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef MERGERATELIMITER_H
+#define MERGERATELIMITER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Throttles the bytes written by merges to a rate in MB/sec.  All merges that share a limiter share its
+/// rate, so the total merge write bandwidth stays bounded however many merges run at once.
+///
+/// The rate can be fixed with {@link #setMBPerSec}, or it can adapt to foreground search latency: after
+/// {@link #setTargetLatency} each search's latency must be reported through {@link #observeLatency}, which
+/// an {@link IndexSearcher} does once it is given the limiter with {@link IndexSearcher#setMergeRateLimiter}.
+/// Nothing else reports latency, so searches that do not go through such a searcher must be reported by
+/// the application.  Whenever the smoothed latency rises above the target the rate is halved, and while it
+/// stays below the rate grows back by a fifth, always within the range given to {@link #setMBPerSecRange}.
+class LPPAPI MergeRateLimiter : public LuceneObject {
+public:
+    /// Creates a limiter writing at most mbPerSec; 0 means unthrottled.
+    MergeRateLimiter(double mbPerSec = 0.0);
+    virtual ~MergeRateLimiter();
+
+    LUCENE_CLASS(MergeRateLimiter);
+
+public:
+    /// Default lowest rate the adaptive throttle backs off to.
+    static const double DEFAULT_MIN_MB_PER_SEC;
+
+    /// Default highest rate the adaptive throttle grows to.
+    static const double DEFAULT_MAX_MB_PER_SEC;
+
+    /// How often, in milliseconds, the adaptive throttle may change the rate.
+    static const int32_t ADJUST_INTERVAL_MILLIS;
+
+    /// Shortest pause worth sleeping for, in milliseconds.  Shorter pauses are carried over to later writes.
+    static const int32_t MIN_PAUSE_MILLIS;
+
+protected:
+    double mbPerSec;
+    double nsPerByte;
+    double minMBPerSec;
+    double maxMBPerSec;
+    int64_t lastNS;
+
+    int64_t targetLatency;
+    double averageLatency;
+    int64_t lastAdjustNS;
+
+public:
+    /// Sets the write rate in MB/sec; 0 disables throttling.
+    void setMBPerSec(double mbPerSec);
+
+    /// Returns the current write rate in MB/sec, or 0 if unthrottled.
+    double getMBPerSec();
+
+    /// Sets the range the adaptive throttle keeps the rate within.
+    void setMBPerSecRange(double minMBPerSec, double maxMBPerSec);
+
+    double getMinMBPerSec();
+    double getMaxMBPerSec();
+
+    /// Sets the foreground latency, in microseconds, above which merges back off; 0 disables adapting.
+    void setTargetLatency(int64_t micros);
+
+    /// Returns the target latency in microseconds.  @see #setTargetLatency
+    int64_t getTargetLatency();
+
+    /// Reports the latency of one foreground search, in microseconds.
+    void observeLatency(int64_t micros);
+
+    /// Returns the smoothed foreground latency in microseconds.
+    double getAverageLatency();
+
+    /// Accounts for bytes about to be written, sleeping as long as needed to hold the rate.
+    /// @return the time paused, in milliseconds.
+    int64_t pause(int64_t bytes);
+
+protected:
+    /// Returns a monotonic timestamp in nanoseconds.
+    static int64_t nanoTime();
+
+    void setRate(double mbPerSec);
+};
+
+}
+
+#endif
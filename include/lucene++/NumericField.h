@@ -98,6 +98,7 @@ public:
 
 protected:
     NumericTokenStreamPtr tokenStream;
+    bool pointIndexed;
 
 public:
     /// Returns a {@link NumericTokenStream} for indexing the numeric value.
@@ -115,6 +116,9 @@ public:
     /// Returns the current numeric value.
     virtual int64_t getNumericValue();
 
+    /// Returns the current numeric value as a double, without the rounding of {@link #stringValue()}.
+    virtual double getDoubleValue();
+
     /// Initializes the field with the supplied long value.
     /// @param value the numeric value
     virtual NumericFieldPtr setLongValue(int64_t value);
@@ -126,6 +130,17 @@ public:
     /// Initializes the field with the supplied double value.
     /// @param value the numeric value
     virtual NumericFieldPtr setDoubleValue(double value);
+
+    /// @see #setPointIndexed
+    virtual bool isPointIndexed();
+
+    /// Sets whether the value is also written as a one dimensional point to the segment's points file, which
+    /// {@link PointRangeQuery} searches without the trie terms.  Create the field with index set to false
+    /// to write the point only.  Doubles are written as sortable longs.
+    virtual void setPointIndexed(bool pointIndexed);
+
+    /// Returns the value as a one dimensional point if the field is point indexed, otherwise null.
+    virtual Collection<int64_t> getPointValue();
 };
 
 }
@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef PFORUTILS_H
+#define PFORUTILS_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Frame of reference coding with patched exceptions (PFOR) for blocks of non-negative ints.
+///
+/// A block is written as a byte holding the bit width, a byte holding the number of exceptions, the
+/// values packed little-endian at that width and then, for every value too wide for the block, its
+/// index as a byte followed by its remaining high bits as a VInt.  The width is chosen to minimise the
+/// encoded size, so a few large values do not inflate the whole block.
+class LPPAPI PForUtils : public LuceneObject {
+public:
+    virtual ~PForUtils();
+    LUCENE_CLASS(PForUtils);
+
+public:
+    /// Number of postings in a packed block.
+    static const int32_t BLOCK_SIZE;
+
+public:
+    /// Returns the size of the scratch buffer needed to encode or decode count values.
+    static int32_t scratchSize(int32_t count);
+
+    /// Encodes count values (fewer than 256) to the given output.
+    static void encode(const int32_t* values, int32_t count, const IndexOutputPtr& out, uint8_t* scratch);
+
+    /// Decodes count values written by {@link #encode}.
+    static void decode(const IndexInputPtr& in, int32_t* values, int32_t count, uint8_t* scratch);
+
+protected:
+    /// Returns the bit width giving the smallest encoding of the values.
+    static int32_t bitWidth(const int32_t* values, int32_t count);
+};
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef PACKEDLONGS_H
+#define PACKEDLONGS_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// A read-only array of longs stored as offsets from their minimum, packed at the number of bits the
+/// largest offset needs.
+///
+/// The file layout is the minimum as a Long, the bit width as a Byte and then the offsets packed
+/// little-endian into Longs.  A column of equal values is just its header.
+class LPPAPI PackedLongs : public LuceneObject {
+public:
+    /// Reads count values written by {@link #write}.
+    PackedLongs(const IndexInputPtr& input, int32_t count);
+    virtual ~PackedLongs();
+
+    LUCENE_CLASS(PackedLongs);
+
+protected:
+    int32_t count;
+    int64_t minValue;
+    int32_t bitsPerValue;
+    LongArray blocks;
+
+public:
+    /// Writes count values.
+    static void write(const IndexOutputPtr& output, const int64_t* values, int32_t count);
+
+    /// Returns the number of bits needed to store values up to maxValue, taken as unsigned.
+    static int32_t bitsRequired(uint64_t maxValue);
+
+    int64_t get(int32_t index);
+    int32_t size();
+    int32_t getBitsPerValue();
+
+    /// Returns the memory used by the packed values.
+    int64_t sizeInBytes();
+};
+
+}
+
+#endif
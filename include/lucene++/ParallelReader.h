@@ -107,6 +107,15 @@ public:
     /// Reads the byte-encoded normalization factor for the named field of every document.
     virtual void norms(const String& field, ByteArray norms, int32_t offset);
 
+    /// Returns the largest decoded norm of the named field, from the reader holding the field.
+    virtual double maxNorm(const String& field);
+
+    /// Loads the doc values written for the named field, or returns null if the field has none.
+    virtual DocValuesColumnPtr getDocValuesColumn(const String& field);
+
+    /// Returns the point tree written for the named field, or null if the field has none.
+    virtual PointValuesPtr getPointValues(const String& field);
+
     /// Returns an enumeration of all the terms in the index. The enumeration is ordered by
     /// Term::compareTo(). Each term is greater than all that precede it in the enumeration.
     /// Note that after calling terms(), {@link TermEnum#next()} must be called on the resulting
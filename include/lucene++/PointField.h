@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef POINTFIELD_H
+#define POINTFIELD_H
+
+#include "AbstractField.h"
+
+namespace Lucene {
+
+/// A field that indexes a point of one or more numeric dimensions in the segment's points file, a block
+/// k-d tree searched by {@link PointRangeQuery} and {@link PointRangeFilter}.  The field is neither
+/// stored nor inverted; add a stored field alongside it to retrieve the values.
+///
+/// Integer dimensions are indexed as they are and double dimensions as sortable longs (see {@link
+/// NumericUtils#doubleToSortableLong}), so a field should use the same kind of value in every document
+/// and be searched with the matching factory.  A document may hold several points of a field, which must
+/// all have the same number of dimensions.  For one dimensional values, {@link NumericField#setPointIndexed}
+/// does the same for a NumericField.
+///
+/// <pre>
+/// document->add(newLucene<PointField>(L"location", newCollection<double>(latitude, longitude)));
+/// ...
+/// QueryPtr query = PointRangeQuery::newDoubleBox(L"location", newCollection<double>(50.0, -1.0), newCollection<double>(52.0, 1.0));
+/// </pre>
+class LPPAPI PointField : public AbstractField {
+public:
+    /// Creates a field holding a point of integer dimensions.
+    PointField(const String& name, Collection<int64_t> point);
+
+    /// Creates a field holding a point of double dimensions.
+    PointField(const String& name, Collection<double> point);
+
+    virtual ~PointField();
+
+    LUCENE_CLASS(PointField);
+
+public:
+    /// Largest number of dimensions of a point.
+    static const int32_t MAX_DIMENSIONS;
+
+protected:
+    Collection<int64_t> point;
+
+public:
+    /// Returns always null for point fields
+    virtual TokenStreamPtr tokenStreamValue();
+
+    /// Returns always null for point fields
+    virtual ByteArray getBinaryValue(ByteArray result);
+
+    /// Returns always null for point fields
+    virtual ReaderPtr readerValue();
+
+    /// Returns the indexed dimensions separated by commas.
+    virtual String stringValue();
+
+    /// Returns the point, doubles encoded as sortable longs.
+    virtual Collection<int64_t> getPointValue();
+
+protected:
+    void checkDimensions(int32_t numDims);
+};
+
+}
+
+#endif
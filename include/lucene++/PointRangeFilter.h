@@ -0,0 +1,74 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef POINTRANGEFILTER_H
+#define POINTRANGEFILTER_H
+
+#include "Filter.h"
+
+namespace Lucene {
+
+/// A {@link Filter} that accepts documents with a point inside a box, searching the block k-d tree of the
+/// field in each segment's points file.  To use this, index the values with {@link PointField} or with
+/// {@link NumericField#setPointIndexed}.
+///
+/// Unlike {@link NumericRangeFilter}, which unions the postings of up to hundreds of trie terms, only the
+/// leaf blocks of the tree that cross the box are read and checked point by point; the documents of blocks
+/// inside the box are taken without looking at their values.
+///
+/// You create a new PointRangeFilter with the static factory methods, eg:
+/// <pre>
+/// FilterPtr f = PointRangeFilter::newDoubleRange(L"weight", 0.03, 0.10, true, true);
+/// </pre>
+class LPPAPI PointRangeFilter : public Filter {
+public:
+    /// Creates a filter accepting points whose every dimension lies between the lower and upper value of
+    /// the dimension, inclusive.  Double dimensions must be given as sortable longs.
+    PointRangeFilter(const String& field, Collection<int64_t> lowerValue, Collection<int64_t> upperValue);
+    virtual ~PointRangeFilter();
+
+    LUCENE_CLASS(PointRangeFilter);
+
+protected:
+    String field;
+    Collection<int64_t> lowerValue;
+    Collection<int64_t> upperValue;
+
+public:
+    /// Factory that creates a PointRangeFilter, that filters a one dimensional long range.
+    static PointRangeFilterPtr newLongRange(const String& field, int64_t min, int64_t max, bool minInclusive, bool maxInclusive);
+
+    /// Factory that creates a PointRangeFilter, that filters a one dimensional int range.
+    static PointRangeFilterPtr newIntRange(const String& field, int32_t min, int32_t max, bool minInclusive, bool maxInclusive);
+
+    /// Factory that creates a PointRangeFilter, that filters a one dimensional double range.
+    static PointRangeFilterPtr newDoubleRange(const String& field, double min, double max, bool minInclusive, bool maxInclusive);
+
+    /// Factory that creates a PointRangeFilter, that filters an inclusive box of long dimensions.
+    static PointRangeFilterPtr newBox(const String& field, Collection<int64_t> lowerValue, Collection<int64_t> upperValue);
+
+    /// Factory that creates a PointRangeFilter, that filters an inclusive box of double dimensions.
+    static PointRangeFilterPtr newDoubleBox(const String& field, Collection<double> lowerValue, Collection<double> upperValue);
+
+    /// Returns the field name for this filter
+    String getField();
+
+    /// Returns the inclusive lower value of each dimension
+    Collection<int64_t> getLowerValue();
+
+    /// Returns the inclusive upper value of each dimension
+    Collection<int64_t> getUpperValue();
+
+    virtual DocIdSetPtr getDocIdSet(const IndexReaderPtr& reader);
+
+    virtual String toString();
+    virtual bool equals(const LuceneObjectPtr& other);
+    virtual int32_t hashCode();
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef POINTRANGEQUERY_H
+#define POINTRANGEQUERY_H
+
+#include "ConstantScoreQuery.h"
+
+namespace Lucene {
+
+/// A {@link Query} that matches documents with a point inside a box, scoring each of them with the query
+/// boost.  It searches the block k-d tree written for fields indexed with {@link PointField} or {@link
+/// NumericField#setPointIndexed}; see {@link PointRangeFilter}.
+///
+/// You create a new PointRangeQuery with the static factory methods, eg:
+/// <pre>
+/// QueryPtr q = PointRangeQuery::newIntRange(L"year", 2008, 2012, true, true);
+/// QueryPtr box = PointRangeQuery::newDoubleBox(L"location", newCollection<double>(50.0, -1.0), newCollection<double>(52.0, 1.0));
+/// </pre>
+class LPPAPI PointRangeQuery : public ConstantScoreQuery {
+public:
+    PointRangeQuery(const PointRangeFilterPtr& filter);
+    virtual ~PointRangeQuery();
+
+    LUCENE_CLASS(PointRangeQuery);
+
+public:
+    using ConstantScoreQuery::toString;
+
+    /// Factory that creates a PointRangeQuery, that queries a one dimensional long range.
+    static PointRangeQueryPtr newLongRange(const String& field, int64_t min, int64_t max, bool minInclusive, bool maxInclusive);
+
+    /// Factory that creates a PointRangeQuery, that queries a one dimensional int range.
+    static PointRangeQueryPtr newIntRange(const String& field, int32_t min, int32_t max, bool minInclusive, bool maxInclusive);
+
+    /// Factory that creates a PointRangeQuery, that queries a one dimensional double range.
+    static PointRangeQueryPtr newDoubleRange(const String& field, double min, double max, bool minInclusive, bool maxInclusive);
+
+    /// Factory that creates a PointRangeQuery, that queries an inclusive box of long dimensions.
+    static PointRangeQueryPtr newBox(const String& field, Collection<int64_t> lowerValue, Collection<int64_t> upperValue);
+
+    /// Factory that creates a PointRangeQuery, that queries an inclusive box of double dimensions.
+    static PointRangeQueryPtr newDoubleBox(const String& field, Collection<double> lowerValue, Collection<double> upperValue);
+
+    virtual String toString(const String& field);
+    virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
+};
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef POINTVALUES_H
+#define POINTVALUES_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Receives the points of a {@link PointValues} tree that may match a query.  The tree first asks how each
+/// cell, a box holding some of the points, relates to the query; cells outside are skipped, the documents
+/// of cells inside are passed without their values, and the points of leaf cells crossing the query are
+/// passed one by one to be checked.
+class LPPAPI PointVisitor : public LuceneObject {
+public:
+    virtual ~PointVisitor();
+
+    LUCENE_CLASS(PointVisitor);
+
+public:
+    enum Relation {
+        /// Every point of the cell matches.
+        CELL_INSIDE_QUERY,
+
+        /// No point of the cell matches.
+        CELL_OUTSIDE_QUERY,
+
+        /// Some points of the cell may match.
+        CELL_CROSSES_QUERY
+    };
+
+public:
+    /// Called for a document with a point in a cell inside the query.
+    virtual void visit(int32_t doc) = 0;
+
+    /// Called for a document with a point in a leaf cell crossing the query.
+    /// @param point the value of each dimension
+    virtual void visit(int32_t doc, const int64_t* point) = 0;
+
+    /// Returns how the cell with the given inclusive bounds in each dimension relates to the query.
+    virtual Relation compare(const int64_t* minValues, const int64_t* maxValues) = 0;
+};
+
+/// The block k-d tree holding the points of one field of one segment, read from the segment's points file.
+///
+/// The points are split in leaf blocks of at most {@link PointsWriter#MAX_POINTS_IN_LEAF} points by
+/// recursively halving them along the dimension with the widest spread, so every leaf covers a small box.
+/// The bounds of every leaf are held in memory and combined into the bounds of the inner cells of the tree,
+/// so a search reads only the leaf blocks of the cells it cannot decide from their bounds alone.
+/// @see IndexReader#getPointValues
+class LPPAPI PointValues : public LuceneObject {
+public:
+    /// Reads the tree of a field, positioned at the tree by the caller.  Leaf blocks are read from clones of
+    /// input on each search.
+    PointValues(const IndexInputPtr& input);
+    virtual ~PointValues();
+
+    LUCENE_CLASS(PointValues);
+
+protected:
+    IndexInputPtr input;
+    int32_t numDims;
+    int32_t numLeaves;
+    int64_t numPoints;
+
+    /// File pointer of each leaf block.
+    Collection<int64_t> leafPointers;
+
+    /// Bounds of each cell by dimension, cell 1 being the root and cell n having the children 2n and 2n+1.
+    Collection<int64_t> minValues;
+    Collection<int64_t> maxValues;
+
+public:
+    /// Returns the number of dimensions of the points.
+    int32_t getNumDimensions();
+
+    /// Returns the number of points, counting each point of a document.
+    int64_t size();
+
+    /// Returns the smallest value of a dimension.
+    int64_t getMinValue(int32_t dim);
+
+    /// Returns the largest value of a dimension.
+    int64_t getMaxValue(int32_t dim);
+
+    /// Passes the points that may match to visitor.  Documents are passed in increasing order within a
+    /// leaf block, but not across blocks.
+    void intersect(const PointVisitorPtr& visitor);
+
+protected:
+    void intersect(const PointVisitorPtr& visitor, const IndexInputPtr& in, int32_t node, Collection<int32_t>& docs, Collection<int64_t>& values);
+
+    /// Reads the documents of a leaf block, returning their number.
+    int32_t readLeafDocs(const IndexInputPtr& in, int32_t leaf, Collection<int32_t>& docs);
+
+    /// Reads the values of a leaf block after its documents, by point then dimension.
+    void readLeafValues(const IndexInputPtr& in, int32_t leaf, int32_t count, Collection<int64_t>& values);
+};
+
+}
+
+#endif
@@ -0,0 +1,39 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef POINTSREADER_H
+#define POINTSREADER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Reads the trees of a segment's points file when opened; leaf blocks are read as they are searched.
+/// @see PointsWriter
+class PointsReader : public LuceneObject {
+public:
+    PointsReader(const DirectoryPtr& dir, const String& segment, const FieldInfosPtr& fieldInfos, int32_t readBufferSize);
+    virtual ~PointsReader();
+
+    LUCENE_CLASS(PointsReader);
+
+protected:
+    FieldInfosPtr fieldInfos;
+    IndexInputPtr input;
+
+    /// The tree of each field number, or null.
+    Collection<PointValuesPtr> values;
+
+public:
+    /// Returns the tree of the given field, or null if the field has no points.
+    PointValuesPtr getPointValues(const String& field);
+
+    void close();
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef POINTSWRITER_H
+#define POINTSWRITER_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Buffers the points of the documents in RAM and writes them to the segment's points file on flush.
+///
+/// The file holds an Int format, then the leaf blocks and the tree of every field with points, then a
+/// directory of the trees (a VInt count and for each tree its VInt field number and the VLong file pointer
+/// of the tree) whose own file pointer ends the file as a Long.
+///
+/// A tree is the VInt number of dimensions, the VInt number of leaves, a power of two, and the VLong number
+/// of points, followed for each leaf by the VLong delta of its file pointer and the smallest and largest
+/// value of each dimension as Longs.  A leaf block is the VInt number of its points, their documents in
+/// increasing order as VInt deltas, then for each dimension the VLong offset of every point's value from
+/// the smallest value of the leaf.
+class PointsWriter : public LuceneObject {
+public:
+    PointsWriter(const FieldInfosPtr& fieldInfos);
+    virtual ~PointsWriter();
+
+    LUCENE_CLASS(PointsWriter);
+
+public:
+    static const int32_t FORMAT_CURRENT;
+
+    /// Largest number of points of a leaf block.
+    static const int32_t MAX_POINTS_IN_LEAF;
+
+    FieldInfosPtr fieldInfos;
+
+public:
+    PointsWriterPerThreadPtr addThread(const DocStatePtr& docState);
+    void flush(Collection<PointsWriterPerThreadPtr> threads, const SegmentWriteStatePtr& state);
+
+    /// Writes the file header.
+    static void writeHeader(const IndexOutputPtr& output);
+
+    /// Writes the leaf blocks and the tree of a field and returns the file pointer of the tree.
+    /// @param docs the document of each point
+    /// @param values the values of each point, numDims per point
+    static int64_t writeField(const IndexOutputPtr& output, int32_t numDims, Collection<int32_t> docs, Collection<int64_t> values);
+
+    /// Writes the directory of the trees and ends the file.
+    static void writeDirectory(const IndexOutputPtr& output, Collection<FieldInfoPtr> fields, Collection<int64_t> pointers);
+
+protected:
+    static void build(const IndexOutputPtr& output, int32_t numDims, int32_t numLeaves, int32_t node, Collection<int32_t> docs, Collection<int64_t> values,
+                      Collection<int32_t> ords, int32_t from, int32_t to, Collection<int64_t> leafPointers, Collection<int64_t> leafBounds);
+    static void writeLeaf(const IndexOutputPtr& output, int32_t numDims, int32_t leaf, Collection<int32_t> docs, Collection<int64_t> values,
+                          Collection<int32_t> ords, int32_t from, int32_t to, Collection<int64_t> leafPointers, Collection<int64_t> leafBounds);
+};
+
+}
+
+#endif
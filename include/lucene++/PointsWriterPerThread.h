@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef POINTSWRITERPERTHREAD_H
+#define POINTSWRITERPERTHREAD_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Buffers the points of the documents indexed by one thread, by field number.
+class PointsWriterPerThread : public LuceneObject {
+public:
+    PointsWriterPerThread(const DocStatePtr& docState);
+    virtual ~PointsWriterPerThread();
+
+    LUCENE_CLASS(PointsWriterPerThread);
+
+public:
+    DocStatePtr docState;
+
+    /// Per field number: the document of each point, in the order they were added, and the values of the
+    /// points one after the other.
+    Collection< Collection<int32_t> > docs;
+    Collection< Collection<int64_t> > values;
+
+public:
+    void addField(Collection<int64_t> point, const FieldInfoPtr& fieldInfo);
+    void reset();
+    void abort();
+};
+
+}
+
+#endif
@@ -14,6 +14,9 @@ namespace Lucene {
 /// A memory-resident {@link Directory} implementation.  Locking implementation is by default the
 /// {@link SingleInstanceLockFactory} but can be changed with {@link #setLockFactory}.
 /// Lock acquisition sequence:  RAMDirectory, then RAMFile
+///
+/// Files are written in large pages, which are reused from file to file.  A file starts in a small buffer
+/// that grows to a page, and once it is closed its last page is cut to the end of the file.
 class LPPAPI RAMDirectory : public Directory {
 public:
     /// Constructs an empty {@link Directory}.
@@ -36,6 +39,12 @@ public:
 
     LUCENE_CLASS(RAMDirectory);
 
+    /// Default size of the pages files are written in.
+    static const int32_t DEFAULT_PAGE_SIZE;
+
+    /// Number of free pages kept for reuse.
+    static const int32_t MAX_FREE_PAGES;
+
 INTERNAL:
     int64_t _sizeInBytes;
     MapStringRAMFile fileMap;
@@ -44,6 +53,8 @@ protected:
     DirectoryWeakPtr _dirSource;
     bool copyDirectory;
     bool closeDir;
+    int32_t pageSize;
+    Collection<ByteArray> freePages;
 
 public:
     virtual void initialize();
@@ -64,9 +75,16 @@ public:
     virtual int64_t fileLength(const String& name);
 
     /// Return total size in bytes of all files in this directory.
-    /// This is currently quantized to RAMOutputStream::BUFFER_SIZE.
+    /// This is quantized to the page size for files that are still being written.
     int64_t sizeInBytes();
 
+    /// Set the size of the pages files created from now on are written in.  Sizes up to {@link
+    /// RAMOutputStream#BUFFER_SIZE} write files in small buffers that are kept as they are once closed.
+    void setPageSize(int32_t pageSize);
+
+    /// @see #setPageSize(int32_t)
+    int32_t getPageSize();
+
     /// Removes an existing file in the directory.
     virtual void deleteFile(const String& name);
 
@@ -79,6 +97,13 @@ public:
 
     /// Closes the store.
     virtual void close();
+
+INTERNAL:
+    /// Returns a buffer for a file, reusing a free page when one of the requested size is available.
+    ByteArray newPage(int32_t size);
+
+    /// Keep the pages of a sealed file for reuse.
+    void recyclePages(Collection<ByteArray> pages);
 };
 
 }
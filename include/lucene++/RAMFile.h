@@ -27,6 +27,10 @@ INTERNAL:
 protected:
     Collection<ByteArray> buffers;
 
+    /// Size of the buffers the file is made of.  The first buffer of a file that is smaller than that grows
+    /// towards it, and the last buffer of a sealed file is cut to the end of the file.
+    int32_t bufferSize;
+
     int64_t sizeInBytes;
 
     /// This is publicly modifiable via Directory.touchFile(), so direct access not supported
@@ -44,9 +48,20 @@ public:
     int64_t getSizeInBytes();
 
     ByteArray addBuffer(int32_t size);
+
+    /// Replace the only buffer of the file with a larger copy of it.
+    ByteArray growBuffer(int32_t size);
+
     ByteArray getBuffer(int32_t index);
     int32_t numBuffers();
 
+    int32_t getBufferSize();
+
+    /// Called once the file has been written.  For a {@link RAMDirectory} that writes in large pages, the
+    /// last buffer is cut to the end of the file and its page goes back to the directory for the next file.
+    /// Only that tail is copied.  The file must not have been opened for reading before.
+    void seal();
+
 protected:
     /// Allocate a new buffer.  Subclasses can allocate differently.
     virtual ByteArray newBuffer(int32_t size);
@@ -25,6 +25,7 @@ public:
 
 protected:
     RAMFilePtr file;
+    int32_t bufferSize;
     int64_t _length;
     ByteArray currentBuffer;
     int32_t currentBufferIndex;
@@ -43,6 +44,10 @@ public:
     /// @see IndexOutput#writeByte(uint8_t)
     virtual uint8_t readByte();
 
+    /// Reads count ints stored in variable-length format, decoding straight from the current buffer.
+    /// @see IndexInput#readVInts(int32_t*, int32_t)
+    virtual void readVInts(int32_t* values, int32_t count);
+
     /// Reads a specified number of bytes into an array at the specified offset.
     /// @param b the array to read bytes into.
     /// @param offset the offset in the array to start storing bytes.
@@ -26,6 +26,7 @@ public:
 
 protected:
     RAMFilePtr file;
+    int32_t bufferSize;
     ByteArray currentBuffer;
     int32_t currentBufferIndex;
     int32_t bufferPosition;
@@ -36,6 +37,10 @@ public:
     /// Copy the current contents of this buffer to the named output.
     void writeTo(const IndexOutputPtr& out);
 
+    /// Copy the current contents of this buffer to the given array, which must hold {@link #length()}
+    /// bytes from offset.
+    void writeTo(uint8_t* bytes, int32_t offset);
+
     /// Resets this to an empty file.
     void reset();
 
@@ -69,6 +74,9 @@ public:
     int64_t sizeInBytes();
 
 protected:
+    /// Move on to the next buffer, or grow the first one while it is smaller than a buffer of the file.
+    void nextBuffer();
+
     void switchCurrentBuffer();
     void setFileLength();
 };
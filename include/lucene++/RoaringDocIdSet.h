@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef ROARINGDOCIDSET_H
+#define ROARINGDOCIDSET_H
+
+#include "DocIdSet.h"
+
+namespace Lucene {
+
+/// A compressed, immutable {@link DocIdSet} in the manner of roaring bitmaps.
+///
+/// Doc ids are split in blocks of 65536 by their upper 16 bits.  Each non-empty block is stored in whichever
+/// container is smallest for it: a sorted array of the lower 16 bits when the block is sparse, a bitmap when
+/// it is dense, or the first and last doc of each run when its docs are clustered.  Sparse sets therefore
+/// cost a few bytes per doc rather than maxDoc/8 bytes, while dense sets cost about the same as a bit set.
+///
+/// Use {@link RoaringDocIdSetBuilder} to add docs one at a time.
+class LPPAPI RoaringDocIdSet : public DocIdSet {
+public:
+    /// Creates a set of the docs of iterator, which must all be less than maxDoc.
+    RoaringDocIdSet(const DocIdSetIteratorPtr& iterator, int32_t maxDoc);
+
+    /// Creates a set of the given containers, one per block and null for empty blocks.
+    RoaringDocIdSet(Collection<RoaringContainerPtr> containers, int32_t maxDoc);
+
+    virtual ~RoaringDocIdSet();
+
+    LUCENE_CLASS(RoaringDocIdSet);
+
+public:
+    /// Number of upper bits of a doc id selecting its block.
+    static const int32_t BLOCK_SHIFT;
+
+    /// Largest number of docs of a block stored as an array, beyond which a bitmap is smaller.
+    static const int32_t MAX_ARRAY_LENGTH;
+
+protected:
+    Collection<RoaringContainerPtr> containers;
+    int32_t maxDoc;
+    int32_t cardinality;
+
+public:
+    /// Returns the number of docs in the set.
+    int32_t size();
+
+    /// Returns true if doc is in the set.
+    bool get(int32_t doc);
+
+    /// Returns the approximate number of bytes used by the set.
+    int64_t sizeInBytes();
+
+    /// Returns a new set holding the docs in both this set and other.
+    RoaringDocIdSetPtr intersect(const RoaringDocIdSetPtr& other);
+
+    /// Returns a new set holding the docs in this set or other.
+    RoaringDocIdSetPtr _union(const RoaringDocIdSetPtr& other);
+
+    /// This DocIdSet implementation is cacheable.
+    virtual bool isCacheable();
+
+    virtual DocIdSetIteratorPtr iterator();
+
+    friend class RoaringDocIdSetIterator;
+};
+
+/// Builds a {@link RoaringDocIdSet} from docs added in order.
+class LPPAPI RoaringDocIdSetBuilder : public LuceneObject {
+public:
+    RoaringDocIdSetBuilder(int32_t maxDoc);
+    virtual ~RoaringDocIdSetBuilder();
+
+    LUCENE_CLASS(RoaringDocIdSetBuilder);
+
+protected:
+    int32_t maxDoc;
+    Collection<RoaringContainerPtr> containers;
+    Array<uint16_t> buffer; // Lower bits of the docs of the current block
+    int32_t bufferSize;
+    int32_t currentBlock;
+    int32_t lastDoc;
+
+public:
+    /// Adds doc, which must not be less than the last doc added.  Adding the last doc again has no effect.
+    void add(int32_t doc);
+
+    /// Returns the set of the docs added.
+    RoaringDocIdSetPtr build();
+
+protected:
+    void flushBlock();
+};
+
+}
+
+#endif
@@ -56,6 +56,11 @@ public:
     /// #nextDoc()} or {@link #advance(int32_t)} is called the first time, or when called from within
     /// {@link Collector#collect}.
     virtual double score() = 0;
+
+    /// Called by collectors that only keep documents scoring strictly above the given score, once they know
+    /// it.  Scorers may then skip documents that cannot score higher.  The score never decreases between
+    /// calls.  The default implementation ignores it.
+    virtual void setMinCompetitiveScore(double minScore);
     
     void visitSubScorers(QueryPtr parent, BooleanClause::Occur relationship,
                          ScorerVisitor *visitor);
@@ -0,0 +1,142 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef SEARCHARENA_H
+#define SEARCHARENA_H
+
+#include <atomic>
+#include <vector>
+#include "Config.h"
+
+namespace Lucene {
+
+/// Bump allocator for the short-lived objects created while serving one request.
+///
+/// While a {@link SearchArena.Scope} is installed on the calling thread, every object created through
+/// newLucene / newInstance on that thread (queries, weights, scorers, collectors, hits) is carved out of the
+/// arena's blocks instead of being a separate heap allocation.  Freeing such an object costs no call to the
+/// allocator; the memory is reclaimed in bulk by {@link #reset()} once every object is gone.
+///
+/// Objects may outlive the scope and the arena itself, and may be released from any thread: blocks that
+/// still hold live objects are handed over to those objects and freed with the last of them.  Objects kept
+/// for a long time (caches filled during the first search, for example) would therefore pin their blocks,
+/// so code filling such caches creates their entries under a {@link SearchArena.Suspend}.
+///
+/// Blocks of the default size are not returned to the heap when they are freed but kept, up to a limit,
+/// for the arenas of later requests.
+///
+/// An arena must only be installed on one thread at a time.
+class LPPAPI SearchArena {
+public:
+    SearchArena(int32_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~SearchArena();
+
+    /// Default size of the blocks objects are allocated from.
+    static const int32_t DEFAULT_BLOCK_SIZE;
+
+    /// Installs an arena on the calling thread for the lifetime of the scope.  Scopes can be nested.
+    class LPPAPI Scope {
+    public:
+        Scope(SearchArena& arena);
+        ~Scope();
+
+    protected:
+        SearchArena* previous;
+        bool installed;
+        bool claimed;
+    };
+
+    /// Sends the allocations of the calling thread to the heap for the lifetime of the object, while an
+    /// arena is installed on it.
+    class LPPAPI Suspend {
+    public:
+        Suspend();
+        ~Suspend();
+
+        /// Returns true if an arena was installed, so objects from the request may live in it.
+        bool isSuspending() const {
+            return suspended != NULL;
+        }
+
+    protected:
+        SearchArena* suspended;
+    };
+
+    class Region;
+
+protected:
+    int32_t blockSize;
+    Region* region;
+
+    /// Number of scopes installed on any thread, so that newInstance does not look up the current arena
+    /// when there can be none.  Otherwise the lookup only probes for a slot if a thread hashing to the
+    /// same home slot as the calling thread has an arena.
+    static std::atomic<int32_t> activeScopes;
+
+public:
+    /// Returns the arena installed on the calling thread, or null.
+    static SearchArena* current() {
+        return activeScopes.load(std::memory_order_relaxed) == 0 ? NULL : lookupCurrent();
+    }
+
+    /// Allocate a block of memory from the arena.  Requests too large for a block go to the heap.
+    void* allocate(size_t size);
+
+    /// Release memory returned by {@link #allocate(size_t)} of any arena.
+    static void deallocate(void* memory);
+
+    /// Reuse the blocks for new objects if none of the objects allocated so far is still alive, otherwise
+    /// leave the blocks to those objects and start over with new ones.
+    void reset();
+
+    /// Returns the number of bytes taken from the blocks since the last {@link #reset()}.
+    int64_t getBytesUsed();
+
+    /// Returns the number of blocks held by the arena.
+    int32_t getNumBlocks();
+
+protected:
+    static SearchArena* lookupCurrent();
+};
+
+/// Standard allocator drawing from a {@link SearchArena}, used by newInstance to create objects and their
+/// reference counts in a single arena allocation.
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    ArenaAllocator(SearchArena* arena) : arena(arena) {
+    }
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {
+    }
+
+    SearchArena* arena;
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) {
+        SearchArena::deallocate(p);
+    }
+};
+
+template <class T, class U>
+inline bool operator== (const ArenaAllocator<T>& first, const ArenaAllocator<U>& second) {
+    return first.arena == second.arena;
+}
+
+template <class T, class U>
+inline bool operator!= (const ArenaAllocator<T>& first, const ArenaAllocator<U>& second) {
+    return first.arena != second.arena;
+}
+
+}
+
+#endif
@@ -85,6 +85,9 @@ protected:
     // True if this segment has any fields with omitTermFreqAndPositions == false
     bool hasProx;
 
+    // True if doc deltas and freqs in this segment are written in bit-packed blocks
+    bool packedPostings;
+
     MapStringString diagnostics;
 
 public:
@@ -149,6 +152,9 @@ public:
     void setHasProx(bool hasProx);
     bool getHasProx();
 
+    void setPackedPostings(bool packedPostings);
+    bool getPackedPostings();
+
     /// Return all files referenced by this SegmentInfo.  The returns List is a locally cached List so
     /// you should not modify it.
     HashSet<String> files();
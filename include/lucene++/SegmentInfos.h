@@ -51,6 +51,10 @@ public:
     /// This format adds optional per-segment string diagnostics storage, and switches userData to Map
     static const int32_t FORMAT_DIAGNOSTICS;
 
+    /// This format adds the boolean packedPostings to record if the segment's doc deltas and freqs are written
+    /// in bit-packed blocks
+    static const int32_t FORMAT_PACKED_POSTINGS;
+
     /// This must always point to the most recent file format.
     static const int32_t CURRENT_FORMAT;
 
@@ -29,6 +29,7 @@ protected:
     DirectoryPtr directory;
     String segment;
     int32_t termIndexInterval;
+    bool packedPostings;
 
     Collection<IndexReaderPtr> readers;
     FieldInfosPtr fieldInfos;
@@ -36,6 +37,9 @@ protected:
     int32_t mergedDocs;
     CheckAbortPtr checkAbort;
 
+    /// Pool the independent parts of the merge run on, or null to write them one after another
+    ThreadPoolPtr executor;
+
     /// Whether we should merge doc stores (stored fields and vectors files).  When all segments we
     /// are merging already share the same doc store files, we don't need to merge the doc stores.
     bool mergeDocStores;
@@ -45,7 +49,8 @@ protected:
 
     Collection<SegmentReaderPtr> matchingSegmentReaders;
     Collection<int32_t> rawDocLengths;
-    Collection<int32_t> rawDocLengths2;
+    Collection<int32_t> rawVectorLengths;
+    Collection<int32_t> rawVectorLengths2;
 
     SegmentMergeQueuePtr queue;
     bool omitTermFreqAndPositions;
@@ -54,6 +59,23 @@ protected:
     Collection< Collection<int32_t> > docMaps;
     Collection<int32_t> delCounts;
 
+    /// Sort the merged documents are written in, or null to keep the readers' order
+    SortPtr indexSort;
+
+    /// The reader and document number of each merged document, when sorting
+    Collection<int32_t> sortedReaders;
+    Collection<int32_t> sortedDocs;
+
+    /// Postings of the current term gathered from all readers, keyed by (merged doc << 32 | posting)
+    Collection<int64_t> sortedPostings;
+    Collection<int32_t> postingFreqs;
+    Collection<int32_t> postingStarts;
+    Collection<int32_t> positions;
+    Collection<int32_t> payloadStarts;
+    Collection<int32_t> payloadLengths;
+    ByteArray payloads;
+    int32_t payloadsUpto;
+
 public:
     /// norms header placeholder
     static const uint8_t NORMS_HEADER[];
@@ -62,6 +84,9 @@ public:
 public:
     bool hasProx();
 
+    /// Returns true if the merged segment writes its postings in bit-packed blocks
+    bool hasPackedPostings();
+
     /// Add an IndexReader to the collection of readers that are to be merged
     void add(const IndexReaderPtr& reader);
 
@@ -87,23 +112,48 @@ public:
     /// @return The number of documents in all of the readers
     int32_t mergeFields();
 
+    /// Returns, for each reader that has deletions or when sorting for every reader, where each of its
+    /// documents went relative to the reader's first merged document, or -1 if it was deleted.
     Collection< Collection<int32_t> > getDocMaps();
     Collection<int32_t> getDelCounts();
 
+    /// Returns true if the live documents of reader are already in the order of sort, so a sorted merge of
+    /// the reader on its own would not move any of them.
+    static bool isInOrder(const IndexReaderPtr& reader, const SortPtr& sort);
+
 protected:
     void addIndexed(const IndexReaderPtr& reader, const FieldInfosPtr& fInfos, HashSet<String> names, bool storeTermVectors,
                     bool storePositionWithTermVector, bool storeOffsetWithTermVector, bool storePayloads,
                     bool omitTFAndPositions);
 
     void setMatchingSegmentReaders();
+
+    /// Orders the non-deleted documents of all readers by the index sort using the sort's {@link
+    /// FieldComparator}s.  Ties keep the order of the readers.
+    void sortDocuments();
+
+    /// Merges the field names of all readers and writes them to the new segment.
+    void mergeFieldInfos();
+
+    /// Copies the stored fields of the non-deleted documents of every reader.
+    /// @return The number of documents in all of the readers
+    int32_t mergeStoredFields();
+
+    /// Writes stored fields, term vectors, postings, norms and doc values on the executor at once; they
+    /// only share the merged field infos.
+    void mergeParts();
     int32_t copyFieldsWithDeletions(const FieldsWriterPtr& fieldsWriter, const IndexReaderPtr& reader, const FieldsReaderPtr& matchingFieldsReader);
     int32_t copyFieldsNoDeletions(const FieldsWriterPtr& fieldsWriter, const IndexReaderPtr& reader, const FieldsReaderPtr& matchingFieldsReader);
 
+    /// Copies stored fields in sorted order, bulk-copying runs of documents that stay adjacent.
+    int32_t copyFieldsSorted(const FieldsWriterPtr& fieldsWriter, Collection<FieldsReaderPtr> matchingFieldsReaders);
+
     /// Merge the TermVectors from each of the segments into the new one.
     void mergeVectors();
 
     void copyVectorsWithDeletions(const TermVectorsWriterPtr& termVectorsWriter, const TermVectorsReaderPtr& matchingVectorsReader, const IndexReaderPtr& reader);
     void copyVectorsNoDeletions(const TermVectorsWriterPtr& termVectorsWriter, const TermVectorsReaderPtr& matchingVectorsReader, const IndexReaderPtr& reader);
+    void copyVectorsSorted(const TermVectorsWriterPtr& termVectorsWriter, Collection<TermVectorsReaderPtr> matchingVectorsReaders);
 
     void mergeTerms();
 
@@ -116,7 +166,19 @@ protected:
     /// @return number of documents across all segments where this term was found
     int32_t appendPostings(const FormatPostingsTermsConsumerPtr& termsConsumer, Collection<SegmentMergeInfoPtr> smis, int32_t n);
 
+    /// Like {@link #appendPostings} for sorted merges: the postings of all segments are gathered first and
+    /// written in merged doc order.
+    int32_t appendSortedPostings(const FormatPostingsTermsConsumerPtr& termsConsumer, Collection<SegmentMergeInfoPtr> smis, int32_t n);
+
     void mergeNorms();
+
+    /// Writes the doc values of the non-deleted documents of every reader.
+    void mergeDocValues();
+
+    /// Rebuilds the point trees from the points of the non-deleted documents of every reader.
+    void mergePoints();
+
+    friend class SegmentMergerPart;
 };
 
 class CheckAbort : public LuceneObject {
@@ -134,7 +196,8 @@ protected:
 public:
     /// Records the fact that roughly units amount of work have been done since this method was last called.
     /// When adding time-consuming code into SegmentMerger, you should test different values for units to
-    /// ensure that the time in between calls to merge.checkAborted is up to ~ 1 second.
+    /// ensure that the time in between calls to merge.checkAborted is up to ~ 1 second.  Parts of a merge
+    /// running in parallel share one CheckAbort.
     virtual void work(double units);
 };
 
@@ -122,6 +122,15 @@ public:
     /// Read norms into a pre-allocated array.
     virtual void norms(const String& field, ByteArray norms, int32_t offset);
 
+    /// Returns the largest decoded norm of the field, computed once and kept with its norms.
+    virtual double maxNorm(const String& field);
+
+    /// Loads the doc values written for the named field, or returns null if the field has none.
+    virtual DocValuesColumnPtr getDocValuesColumn(const String& field);
+
+    /// Returns the point tree written for the named field, or null if the field has none.
+    virtual PointValuesPtr getPointValues(const String& field);
+
     bool termsIndexLoaded();
 
     /// NOTE: only called from IndexWriter when a near real-time reader is opened, or applyDeletes is run, sharing a
@@ -18,6 +18,9 @@ public:
 
     LUCENE_CLASS(SegmentTermDocs);
 
+    /// Number of postings values {@link #read} decodes from the freq stream at a time.
+    static const int32_t BLOCK_SIZE;
+
 protected:
     SegmentReaderWeakPtr _parent;
     IndexInputPtr _freqStream;
@@ -40,6 +43,43 @@ protected:
     bool currentFieldStoresPayloads;
     bool currentFieldOmitTermFreqAndPositions;
 
+    /// Doc codes and freqs decoded ahead of the current document by {@link #read}.
+    IntArray pendingCodes;
+    int32_t pendingPosition;
+    int32_t pendingLength;
+
+    /// Set when the segment stores doc deltas and freqs in {@link PForUtils} blocks.
+    bool packedPostings;
+    IntArray blockDocs;
+    IntArray blockFreqs;
+    int32_t blockPosition;
+    int32_t blockLength;
+    int32_t blocksRead;
+    ByteArray blockScratch;
+
+    /// Reads the per-block skip entries of packed postings.
+    IndexInputPtr blockSkipStream;
+    int32_t blockSkipCount;
+    bool blockSkipPending;
+    int32_t blockSkipDoc;
+    int64_t blockSkipFreqPointer;
+    int64_t blockSkipProxPointer;
+    int32_t blockSkipPayloadLength;
+    /// The entry read ahead of the last one passed, if blockSkipPending.
+    int32_t pendingSkipDoc;
+    int64_t pendingSkipFreqPointer;
+    int64_t pendingSkipProxPointer;
+    int32_t pendingSkipPayloadLength;
+
+    /// Reads the max freqs recorded with packed postings, independently of the enumeration.
+    IndexInputPtr impactStream;
+    bool impactsLoaded;
+    int32_t termMaxFreq;
+    int32_t impactCount;
+    bool impactPending;
+    int32_t impactDoc;
+    int32_t impactBlockFreq;
+
 public:
     /// Sets this to the data for a term.
     virtual void seek(const TermPtr& term);
@@ -66,6 +106,12 @@ public:
     /// Optimized implementation.
     virtual bool skipTo(int32_t target);
 
+    /// Known for terms of packed postings segments.
+    virtual int32_t maxFreq();
+
+    virtual int32_t advanceShallow(int32_t target);
+    virtual int32_t blockMaxFreq();
+
     /// Used for testing
     virtual IndexInputPtr freqStream();
     virtual void freqStream(const IndexInputPtr& freqStream);
@@ -76,6 +122,23 @@ protected:
 
     /// Overridden by SegmentTermPositions to skip in prox stream.
     virtual void skipProx(int64_t proxPointer, int32_t payloadLength);
+
+    /// Decode the next block of postings values.
+    void fillPending();
+
+    /// Returns the next postings value, taking it from the decoded block when there is one.
+    int32_t nextCode();
+
+    /// Decode the next packed block of the current term, or the VInt docs that follow the last one.
+    void readBlock();
+
+    int32_t readPacked(Collection<int32_t> docs, Collection<int32_t> freqs);
+
+    /// Jump over whole packed blocks that end before the target.
+    void skipBlocks(int32_t target);
+
+    /// Read the max freq of the current term and position the impact cursor on its first block.
+    void loadImpacts();
 };
 
 }
@@ -23,7 +23,6 @@ protected:
     IndexInputPtr input;
     TermBufferPtr termBuffer;
     TermBufferPtr prevBuffer;
-    TermBufferPtr scanBuffer; // used for scanning
 
     TermInfoPtr _termInfo;
 
@@ -46,6 +45,9 @@ public:
 
     void seek(int64_t pointer, int64_t p, const TermPtr& t, const TermInfoPtr& ti);
 
+    /// Seek to an index entry without creating a {@link Term}.
+    void seek(int64_t pointer, int64_t p, const String& field, const wchar_t* text, int32_t length, const TermInfoPtr& ti);
+
     /// Increments the enumeration to the next element.  True if one exists.
     virtual bool next();
 
@@ -59,6 +61,23 @@ public:
     /// Returns the previous Term enumerated. Initially null.
     TermPtr prev();
 
+    /// Returns true if there is a current term, which is the case after next() returned true.
+    bool hasTerm();
+
+    /// Returns true if there is a previous term.
+    bool hasPrev();
+
+    /// Compares the current term to term without creating a {@link Term}, comparing the UTF-8 bytes of
+    /// the terms.  There must be a current term.
+    int32_t compareTerm(const TermPtr& term);
+
+    /// Compares the previous term to term without creating a {@link Term}.  There must be a previous term.
+    int32_t comparePrev(const TermPtr& term);
+
+    /// Sets result to the UTF-8 bytes of the current term without decoding them.  result shares the bytes
+    /// of this enumeration, which are only valid until it moves.
+    void termBytes(const BytesRefPtr& result);
+
     /// Returns the current TermInfo in the enumeration.
     /// Initially invalid, valid after next() called for the first time.
     TermInfoPtr termInfo();
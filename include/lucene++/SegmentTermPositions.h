@@ -42,6 +42,10 @@ public:
     /// Returns next position in the current document.
     virtual int32_t nextPosition();
 
+    /// Reads the next count positions of the current document, decoding the deltas in one block when the
+    /// field has no payloads.
+    virtual void readPositions(int32_t* positions, int32_t count);
+
     /// Moves to the next pair in the enumeration.
     virtual bool next();
 
@@ -13,7 +13,7 @@ namespace Lucene {
 
 class SegmentWriteState : public LuceneObject {
 public:
-    SegmentWriteState(const DocumentsWriterPtr& docWriter, const DirectoryPtr& directory, const String& segmentName,
+    SegmentWriteState(const DocumentsWriterPerThreadPtr& docWriter, const DirectoryPtr& directory, const String& segmentName,
                       const String& docStoreSegmentName, int32_t numDocs, int32_t numDocsInStore,
                       int32_t termIndexInterval);
     virtual ~SegmentWriteState();
@@ -21,13 +21,14 @@ public:
     LUCENE_CLASS(SegmentWriteState);
 
 public:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
     DirectoryPtr directory;
     String segmentName;
     String docStoreSegmentName;
     int32_t numDocs;
     int32_t termIndexInterval;
     int32_t numDocsInStore;
+    bool packedPostings;
     HashSet<String> flushedFiles;
 
 public:
@@ -106,6 +106,10 @@ public:
     Collection<SortFieldPtr> getSort();
 
     virtual String toString();
+
+    /// Returns the {@link SortField#getIndexKey()} of each field, in succession.
+    String getIndexKey();
+
     virtual bool equals(const LuceneObjectPtr& other);
     virtual int32_t hashCode();
 };
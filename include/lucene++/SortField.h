@@ -125,6 +125,10 @@ public:
 
     virtual String toString();
 
+    /// Returns a description of this sort order that, unlike {@link #toString()}, tells locales and the
+    /// classes of comparator sources and parsers apart.  Segments written in an index sort are tagged with it.
+    String getIndexKey();
+
     /// Returns true if other is equal to this.  If a {@link FieldComparatorSource} or {@link Parser} was provided,
     /// it must properly implement equals (unless a singleton is always used).
     virtual bool equals(const LuceneObjectPtr& other);
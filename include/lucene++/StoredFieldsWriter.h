@@ -14,14 +14,14 @@ namespace Lucene {
 /// This is a DocFieldConsumer that writes stored fields.
 class StoredFieldsWriter : public LuceneObject {
 public:
-    StoredFieldsWriter(const DocumentsWriterPtr& docWriter, const FieldInfosPtr& fieldInfos);
+    StoredFieldsWriter(const DocumentsWriterPerThreadPtr& docWriter, const FieldInfosPtr& fieldInfos);
     virtual ~StoredFieldsWriter();
 
     LUCENE_CLASS(StoredFieldsWriter);
 
 public:
     FieldsWriterPtr fieldsWriter;
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
     FieldInfosPtr fieldInfos;
     int32_t lastDocID;
 
@@ -29,6 +29,9 @@ public:
     String _field;
     String _text;
 
+protected:
+    BytesRefPtr _bytes; // UTF-8 encoding of _text, computed on first use
+
 public:
     /// Returns the field of this term, an interned string.   The field indicates the part of a document
     /// which this term came from.
@@ -38,6 +41,10 @@ public:
     /// the case of dates and other types, this is an encoding of the object as a string.
     String text();
 
+    /// Returns the text of this term encoded as UTF-8, as stored in the term dictionary.  This is computed
+    /// once and shared, so it must not be modified.
+    BytesRefPtr bytes();
+
     /// Optimized construction of new Terms by reusing same field as this Term
     /// @param text The text of the new term (field is implicitly same as this Term instance)
     /// @return A new Term
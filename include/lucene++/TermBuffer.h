@@ -11,6 +11,10 @@
 
 namespace Lucene {
 
+/// Holds the current term of a {@link SegmentTermEnum}.
+///
+/// Terms stored as UTF-8 are kept as their bytes and compared as bytes; their text is only decoded when
+/// {@link #toTerm} is called.  Terms stored in the older "modified UTF8" format are kept as chars.
 class TermBuffer : public LuceneObject {
 public:
     TermBuffer();
@@ -23,8 +27,8 @@ protected:
     TermPtr term; // cached
     bool preUTF8Strings; // true if strings are stored in modified UTF8 encoding
 
-    UnicodeResultPtr text;
-    UTF8ResultPtr bytes;
+    UnicodeResultPtr text; // Only used if preUTF8Strings
+    UTF8ResultPtr bytes; // Only used unless preUTF8Strings
 
 public:
     virtual int32_t compareTo(const LuceneObjectPtr& other);
@@ -32,9 +36,20 @@ public:
     /// Call this if the IndexInput passed to {@link #read} stores terms in the "modified UTF8" format.
     void setPreUTF8Strings();
 
+    /// Returns true if a term is set.
+    bool hasTerm();
+
+    /// Compares the term held by this buffer to term, without creating a {@link Term}.
+    int32_t compareTerm(const TermPtr& term);
+
+    /// Sets result to the UTF-8 encoding of the term.  Unless the term is stored in modified UTF8, result
+    /// shares the bytes of this buffer, which are only valid until the buffer changes.
+    void termBytes(const BytesRefPtr& result);
+
     void read(const IndexInputPtr& input, const FieldInfosPtr& fieldInfos);
 
     void set(const TermPtr& term);
+    void set(const String& field, const wchar_t* text, int32_t length);
     void set(const TermBufferPtr& other);
     void reset();
 
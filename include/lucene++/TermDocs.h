@@ -52,6 +52,19 @@ public:
 
     /// Frees associated resources.
     virtual void close() = 0;
+
+    /// Returns the largest frequency of the current term in any document, or -1 if the index does not record
+    /// it.  Scorers use this to bound the score of documents they have not read yet.
+    virtual int32_t maxFreq();
+
+    /// Moves the impact cursor to the block of postings that may contain target, without moving the
+    /// enumeration itself, and returns the last document number of that block.  {@link #blockMaxFreq()} then
+    /// bounds the frequency of every document from target up to the returned number.  Targets must not
+    /// decrease between calls for the same term.
+    virtual int32_t advanceShallow(int32_t target);
+
+    /// Returns the largest frequency within the block found by the last call to {@link #advanceShallow}.
+    virtual int32_t blockMaxFreq();
 };
 
 }
@@ -29,9 +29,17 @@ protected:
     SegmentTermEnumPtr origEnum;
     int64_t _size;
 
-    Collection<TermPtr> indexTerms;
-    Collection<TermInfoPtr> indexInfos;
-    Collection<int64_t> indexPointers;
+    /// Terms index, mapping every indexInterval-th term to its entry in the arrays below.
+    TermsIndexFSTPtr index;
+    int32_t indexSize;
+    IntArray indexDocFreqs;
+    LongArray indexFreqPointers;
+    LongArray indexProxPointers;
+    IntArray indexSkipOffsets;
+    LongArray indexPointers;
+
+    /// Index entries of the ordinals of the terms index; only needed when two entries hold the same term.
+    IntArray indexOffsets;
 
     int32_t totalIndexInterval;
 
@@ -60,14 +68,21 @@ public:
 protected:
     TermInfosReaderThreadResourcesPtr getThreadResources();
 
-    /// Returns the offset of the greatest index entry which is less than or equal to term.
-    int32_t getIndexOffset(const TermPtr& term);
+    /// Returns the ordinal in the terms index of the greatest index entry which is less than or equal to term.
+    int32_t getIndexOrdinal(const TermPtr& term);
 
-    void seekEnum(const SegmentTermEnumPtr& enumerator, int32_t indexOffset);
+    /// Returns the offset of the index entry of an ordinal.
+    int32_t getIndexOffset(int32_t indexOrdinal);
+
+    void seekEnum(const TermInfosReaderThreadResourcesPtr& resources, const SegmentTermEnumPtr& enumerator, int32_t indexOrdinal);
 
     /// Returns the TermInfo for a Term in the set, or null.
     TermInfoPtr get(const TermPtr& term, bool useCache);
 
+    /// Returns the TermInfo for a Term in the set, or null, leaving the enum of the given resources
+    /// positioned at or after the term.
+    TermInfoPtr get(const TermInfosReaderThreadResourcesPtr& resources, const TermPtr& term, bool useCache);
+
     void ensureIndexIsRead();
 };
 
@@ -82,6 +97,11 @@ public:
 
     // Used for caching the least recently looked-up Terms
     TermInfoCachePtr termInfoCache;
+
+    // Used for seeking to index entries
+    String indexField;
+    CharArray indexText;
+    TermInfoPtr indexInfo;
 };
 
 }
@@ -29,6 +29,10 @@ public:
     // the first time.
     virtual int32_t nextPosition();
 
+    /// Reads the next count positions of the current document into positions, as count calls to {@link
+    /// #nextPosition()} would.  Implementations may decode them in one block.
+    virtual void readPositions(int32_t* positions, int32_t count);
+
     /// Returns the length of the payload at the current term position.  This is invalid until {@link
     /// #nextPosition()} is called for the first time.
     /// @return length of the current payload in number of bytes
@@ -41,6 +41,7 @@ protected:
 
     static const int32_t SCORE_CACHE_SIZE;
     Collection<double> scoreCache;
+    Collection<double> batchScores; // scores of the buffered docs, for collectors that accept batches
     
     
 
@@ -69,10 +70,34 @@ public:
         return freq;
     }
 
+    /// Returns the largest frequency of the term in any document, or -1 if the index does not record it.
+    int32_t maxFreq();
+
+    /// Returns the last document of the postings block that may contain target.  {@link #blockMaxFreq()}
+    /// then bounds the frequency of the documents from target up to it.
+    /// @see TermDocs#advanceShallow(int32_t)
+    int32_t advanceShallow(int32_t target);
+
+    int32_t blockMaxFreq();
+
+    /// Returns an upper bound for the score of documents holding the term at most freq times.
+    /// Assumes {@link Similarity#tf} does not decrease with the frequency.
+    /// @param normBound The largest decoded norm of the field.
+    double scoreBound(int32_t freq, double normBound);
+
+    ByteArray getNorms();
+
+    /// Returns the field of the scored term, or an empty string if the weight is not a {@link TermQuery}'s.
+    String getField();
+
 protected:
     static const Collection<double> SIM_NORM_DECODER();
 
     virtual bool score(const CollectorPtr& collector, int32_t max, int32_t firstDocID);
+
+    /// Scores the buffered docs in the window a buffer at a time and hands them to {@link
+    /// Collector#collectBatch}.
+    bool scoreBatches(const CollectorPtr& collector, int32_t max);
 };
 
 }
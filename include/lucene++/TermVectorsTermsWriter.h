@@ -15,13 +15,13 @@ namespace Lucene {
 
 class TermVectorsTermsWriter : public TermsHashConsumer {
 public:
-    TermVectorsTermsWriter(const DocumentsWriterPtr& docWriter);
+    TermVectorsTermsWriter(const DocumentsWriterPerThreadPtr& docWriter);
     virtual ~TermVectorsTermsWriter();
 
     LUCENE_CLASS(TermVectorsTermsWriter);
 
 public:
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
     TermVectorsWriterPtr termVectorsWriter;
     Collection<TermVectorsTermsWriterPerDocPtr> docFreeList;
     int32_t freeCount;
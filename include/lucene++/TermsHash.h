@@ -17,7 +17,7 @@ namespace Lucene {
 /// under each term.
 class TermsHash : public InvertedDocConsumer {
 public:
-    TermsHash(const DocumentsWriterPtr& docWriter, bool trackAllocations, const TermsHashConsumerPtr& consumer, const TermsHashPtr& nextTermsHash);
+    TermsHash(const DocumentsWriterPerThreadPtr& docWriter, bool trackAllocations, const TermsHashConsumerPtr& consumer, const TermsHashPtr& nextTermsHash);
     virtual ~TermsHash();
 
     LUCENE_CLASS(TermsHash);
@@ -27,7 +27,7 @@ public:
     TermsHashPtr nextTermsHash;
     int32_t bytesPerPosting;
     int32_t postingsFreeChunk;
-    DocumentsWriterWeakPtr _docWriter;
+    DocumentsWriterPerThreadWeakPtr _docWriter;
     bool trackAllocations;
 
 protected:
@@ -44,11 +44,23 @@ public:
     IntArray intUptos;
     int32_t intUptoStart;
 
+    /// Initial number of hash slots, to which the hash is shrunk again after flushing.
+    static const int32_t HASH_INIT_SIZE;
+
+    /// Number of consecutive slots compared at once when probing the hash.
+    static const int32_t HASH_GROUP_SIZE;
+
 protected:
+    /// The hash is an open-addressing table probed linearly in groups of {@link #HASH_GROUP_SIZE} slots.  Each
+    /// slot holds the hash code of its term inline, so probing only has to look at a posting when the codes
+    /// are equal.  Postings are kept densely in the order their terms were first seen, so flushing sorts them
+    /// in place without compacting the table first.
     int32_t postingsHashSize;
     int32_t postingsHashHalfSize;
     int32_t postingsHashMask;
-    Collection<RawPostingListPtr> postingsHash;
+    IntArray postingsHashCodes; // Hash code of the term in each slot
+    IntArray postingsHashIds; // Index into postings of the term in each slot, or -1 if the slot is free
+    Collection<RawPostingListPtr> postings;
     RawPostingListPtr p;
     bool doCall;
     bool doNextCall;
@@ -63,7 +75,7 @@ public:
 
     void initReader(const ByteSliceReaderPtr& reader, const RawPostingListPtr& p, int32_t stream);
 
-    /// Collapse the hash table and sort in-place.
+    /// Sort the postings in-place.  The hash can no longer be probed until it is reset.
     Collection<RawPostingListPtr> sortPostings();
 
     /// Called before a field instance is being processed
@@ -88,10 +100,18 @@ public:
     void rehashPostings(int32_t newSize);
 
 protected:
-    void compactPostings();
+    /// Returns the slot holding the term with the given hash code, or the free slot it should be added to.
+    /// Terms are compared by their text when tokenText is given, and by their code alone otherwise.
+    int32_t findSlot(int32_t code, const wchar_t* tokenText, int32_t tokenTextLen);
+
+    /// Returns the first slot probed for a hash code; the low bits of term hash codes are spread poorly.
+    static int32_t hashStart(int32_t code, int32_t mask);
+
+    /// Test whether the text for posting equals current tokenText.
+    bool postingEquals(const RawPostingListPtr& posting, const wchar_t* tokenText, int32_t tokenTextLen);
 
-    /// Test whether the text for current RawPostingList p equals current tokenText.
-    bool postingEquals(const wchar_t* tokenText, int32_t tokenTextLen);
+    /// Adds a new posting for the term at textStart to the free slot, and starts its streams.
+    void addPosting(int32_t slot, int32_t code, int32_t textStart);
 };
 
 }
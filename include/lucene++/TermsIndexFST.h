@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef TERMSINDEXFST_H
+#define TERMSINDEXFST_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// In-memory terms index: a minimal acyclic finite state transducer mapping every index term to its
+/// ordinal, the position of the term in the index.
+///
+/// A key is the number of the term's field, fields being numbered in name order, followed by the
+/// characters of its text.  Common prefixes and suffixes of the keys are stored once.  Every arc carries
+/// the number of keys sorting before the ones reached through it, so the ordinal of a key is the sum of
+/// the outputs along its path, and the key of an ordinal can be rebuilt by following the outputs.
+///
+/// Keys must be added in {@link Term} order through {@link #add} and the index completed with {@link
+/// #finish()} before it is searched.
+class LPPAPI TermsIndexFST : public LuceneObject {
+public:
+    TermsIndexFST();
+    virtual ~TermsIndexFST();
+
+    LUCENE_CLASS(TermsIndexFST);
+
+protected:
+    /// Field names in sorted order, indexed by the first label of the keys.
+    Collection<String> fields;
+
+    /// Arcs of node n are [nodeArcs[n], nodeArcs[n + 1]), sorted by label.
+    std::vector<int32_t> nodeArcs;
+    /// Number of keys accepted from each node, including the node itself when it is final.
+    std::vector<int32_t> nodeCounts;
+    std::vector<uint8_t> nodeFinals;
+
+    std::vector<int32_t> arcLabels;
+    std::vector<int32_t> arcTargets;
+    /// Number of keys below the arc's node that sort before the ones reached through the arc.
+    std::vector<int32_t> arcOutputs;
+
+    int32_t root;
+    int32_t numKeys;
+
+    /// Build state, released by {@link #finish()}.
+    struct PendingNode {
+        bool final;
+        std::vector<int32_t> labels;
+        std::vector<int32_t> targets;
+    };
+
+    std::vector<PendingNode> frontier;
+    std::vector<int32_t> lastKey;
+    std::vector<int32_t> key;
+    std::vector<int32_t> registry;
+    int32_t registered;
+
+public:
+    /// Adds the next index term, which must not sort before the previous one.  Returns the ordinal of the
+    /// term, which is the ordinal of the previous term when both are equal.
+    int32_t add(const String& field, const wchar_t* text, int32_t length);
+
+    /// Completes the index.
+    void finish();
+
+    /// Returns the number of distinct keys.
+    int32_t size();
+
+    /// Returns the ordinal of the greatest key less than or equal to the given term, or -1 if every key
+    /// is greater.
+    int32_t floor(const String& field, const String& text);
+
+    /// Rebuilds the key of an ordinal.  The text is written to the given buffer, grown as needed, and its
+    /// length returned; the field is returned through field.
+    int32_t getTerm(int32_t ordinal, String& field, CharArray& text);
+
+    /// Returns the approximate memory used by the index.
+    int64_t sizeInBytes();
+
+protected:
+    /// Freezes a pending node, returning the number of an equivalent node if there is one already.
+    int32_t compileNode(PendingNode& node);
+
+    int32_t hashPending(const PendingNode& node);
+    int32_t hashCompiled(int32_t node);
+    bool equalsCompiled(const PendingNode& node, int32_t compiled);
+    void growRegistry();
+
+    /// Returns the position of the first arc of node with a label not less than label.
+    int32_t findArc(int32_t node, int32_t label);
+};
+
+}
+
+#endif
@@ -7,8 +7,10 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
-#include <queue>
+#include <atomic>
+#include <deque>
 #include <boost/any.hpp>
+#include "cc/sync.h"
 #include "LuceneObject.h"
 
 namespace Lucene {
@@ -18,10 +20,13 @@ namespace Lucene {
 /// retrieved using method get when the computation has completed, blocking if necessary until it is ready.
 class Future : public LuceneObject {
 public:
+    Future();
     virtual ~Future();
 
 protected:
     boost::any value;
+    LuceneException exception;
+    bool failed;
 
 public:
     void set(const boost::any& value) {
@@ -29,62 +34,174 @@ public:
         this->value = value;
     }
 
+    /// Complete the computation with an exception, which {@link #get()} rethrows.
+    void setException(const LuceneException& exception) {
+        SyncLock syncLock(this);
+        this->exception = exception;
+        failed = true;
+    }
+
+    /// Complete the computation with the exception being handled; must be called from a catch block.
+    /// Exceptions other than a {@link LuceneException} are rethrown as a RuntimeException.
+    void setCurrentException();
+
     template <typename TYPE>
     TYPE get() {
         SyncLock syncLock(this);
-        while (value.empty()) {
+        while (value.empty() && !failed) {
             wait();
         }
-        return value.empty() ? TYPE() : boost::any_cast<TYPE>(value);
+        if (failed) {
+            exception.throwException();
+        }
+        return boost::any_cast<TYPE>(value);
     }
 };
 
-/// Utility class to handle a pool of threads.
+/// A unit of work that can be queued on a {@link ThreadPool} without any allocation.  The task is owned by
+/// the caller, who must keep it alive until {@link #join()} returns.
+class ThreadPoolTask {
+public:
+    ThreadPoolTask();
+    virtual ~ThreadPoolTask();
+
+protected:
+    std::atomic<bool> done;
+    bool detached;
+    ThreadPool* pool;
+    LuceneException exception;
+
+public:
+    /// Override to provide the body of the task.
+    virtual void run() = 0;
+
+    /// Returns true once the task has finished running.
+    bool isDone();
+
+    /// Wait for the task to finish, running other queued tasks in the meantime and blocking when there are
+    /// none.  Rethrows any exception raised by the task.
+    void join();
+
+    friend class ThreadPool;
+};
+
+/// A {@link ThreadPoolTask} that computes a result of the given type.
+template <typename TYPE>
+class ThreadPoolCallable : public ThreadPoolTask {
+public:
+    virtual ~ThreadPoolCallable() {
+    }
+
+protected:
+    TYPE result;
+
+public:
+    /// Override to compute the result.
+    virtual TYPE call() = 0;
+
+    virtual void run() {
+        result = call();
+    }
+
+    /// Wait for the task to finish and return its result.
+    TYPE get() {
+        join();
+        return result;
+    }
+};
+
+/// Pool of worker threads, each with its own task deque.  Workers take tasks from the back of their own deque
+/// and steal from the front of the others when it runs dry, so tasks forked from inside a worker stay local.
 class ThreadPool : public LuceneObject {
 public:
-    ThreadPool();
+    ThreadPool(int32_t size = DEFAULT_POOL_SIZE);
     virtual ~ThreadPool();
 
     LUCENE_CLASS(ThreadPool);
 
-    static constexpr int32_t THREADPOOL_SIZE = 10;
+    static const int32_t DEFAULT_POOL_SIZE;
+
 protected:
-    std::queue<std::function<void()>> works;
+    struct WorkQueue {
+        rt::Spin lock;
+        std::deque<ThreadPoolTask*> tasks;
+    };
+
+    int32_t size;
     bool running;
-    int running_threads;
-    rt::Mutex worksLock;
-    rt::CondVar worksCV;
-    rt::Thread threads[THREADPOOL_SIZE];
+    std::unique_ptr<WorkQueue[]> queues;
+    Collection<threadPtr> threads;
+    std::unique_ptr< std::atomic<int64_t>[] > threadIds;
+    std::atomic<int32_t> pending;
+    std::atomic<int32_t> idleThreads;
+    std::atomic<uint32_t> nextQueue;
+    rt::Mutex idleLock;
+    rt::CondVar idleCV;
+
+    /// Threads blocked in {@link ThreadPoolTask#join()}, woken when a task finishes or is queued.
+    std::atomic<int32_t> joiners;
+    rt::Mutex joinLock;
+    rt::CondVar joinCV;
+
+    static int32_t poolSize;
 
 public:
     /// Get singleton thread pool instance.
     static ThreadPoolPtr getInstance();
 
+    /// Set the number of worker threads used when the singleton instance is created.  Has no effect once
+    /// {@link #getInstance()} has been called.
+    static void setPoolSize(int32_t size);
+
+    /// Returns the number of worker threads.
+    int32_t getSize();
+
+    /// Queue a caller-owned task.  Tasks submitted from a worker thread go to that worker's own deque.
+    void submit(ThreadPoolTask* task);
+
     template <typename FUNC>
     FuturePtr scheduleTask(FUNC func) {
         FuturePtr future(newInstance<Future>());
-	worksLock.Lock();
-	works.push(std::bind(&ThreadPool::execute<FUNC>, this, func, future));
-	if (running_threads < THREADPOOL_SIZE) {
-            worksCV.Signal();
-	}
-	worksLock.Unlock();
-
+        ThreadPoolTask* task = new FunctionTask<FUNC>(func, future);
+        task->detached = true;
+        submit(task);
         return future;
     }
 
 protected:
-    // this will be executed when one of the threads is available
     template <typename FUNC>
-    void execute(FUNC func, const FuturePtr& future) {
-        future->set(func());
-        future->notifyAll();
-    }
+    class FunctionTask : public ThreadPoolTask {
+    public:
+        FunctionTask(FUNC func, const FuturePtr& future) : func(func), future(future) {
+        }
 
-    void _run();
-    static void run() {
-        getInstance()->_run();
-    }
+    protected:
+        FUNC func;
+        FuturePtr future;
+
+    public:
+        virtual void run() {
+            // the task is detached, so an exception can only reach the caller through the future
+            try {
+                future->set(func());
+            } catch (...) {
+                future->setCurrentException();
+            }
+            future->notifyAll();
+        }
+    };
+
+    /// Returns the index of the worker deque owned by the calling thread, or -1.
+    int32_t currentQueue();
+
+    /// Take a queued task, preferring the given deque; returns null if every deque is empty.
+    ThreadPoolTask* nextTask(int32_t queue);
+
+    void execute(ThreadPoolTask* task);
+
+    void run(int32_t queue);
+
+    friend class ThreadPoolTask;
 };
 
 }
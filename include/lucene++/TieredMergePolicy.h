@@ -0,0 +1,107 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIEREDMERGEPOLICY_H
+#define TIEREDMERGEPOLICY_H
+
+#include "LogByteSizeMergePolicy.h"
+
+namespace Lucene {
+
+/// Merges segments of approximately equal size, subject to an allowed number of segments per tier.
+/// Unlike {@link LogMergePolicy}, which merges whole levels, this policy first computes how many segments
+/// the index may hold given its size, and only merges while it holds more.  It then picks, among all runs
+/// of adjacent segments, the run with the best score: runs of similar sized segments are preferred over
+/// lopsided ones, smaller merges over larger ones, and runs carrying many deletes over clean ones.
+///
+/// The settings inherited from {@link LogByteSizeMergePolicy} take these meanings:
+/// <ul>
+/// <li>{@link #setMergeFactor} is the largest number of segments merged at once during normal merging.
+/// <li>{@link #setMaxMergeMB} caps the size of a merged segment (5 GB by default).  Segments larger than
+/// half of it are no longer merged, except by optimize.
+/// <li>{@link #setMinMergeMB} is the floor size: smaller segments are treated as this size when
+/// computing the tier budget and scoring merges (2 MB by default).
+/// </ul>
+/// Segment sizes always discount deleted documents.
+///
+/// Because {@link IndexWriter} can only commit merges of adjacent segments, candidate merges are runs of
+/// adjacent segments rather than arbitrary subsets.
+class LPPAPI TieredMergePolicy : public LogByteSizeMergePolicy {
+public:
+    TieredMergePolicy(const IndexWriterPtr& writer);
+    virtual ~TieredMergePolicy();
+
+    LUCENE_CLASS(TieredMergePolicy);
+
+public:
+    /// Default maximum merged segment size.  @see #setMaxMergeMB
+    static const double DEFAULT_MAX_MERGED_SEGMENT_MB;
+
+    /// Default floor segment size.  @see #setMinMergeMB
+    static const double DEFAULT_FLOOR_SEGMENT_MB;
+
+    /// Default number of segments allowed per tier.  @see #setSegmentsPerTier
+    static const double DEFAULT_SEGMENTS_PER_TIER;
+
+    /// Default weight of reclaimed deletes.  @see #setReclaimDeletesWeight
+    static const double DEFAULT_RECLAIM_DELETES_WEIGHT;
+
+    /// Default percentage of deletes a segment may keep through expungeDeletes.
+    /// @see #setExpungeDeletesPctAllowed
+    static const double DEFAULT_EXPUNGE_DELETES_PCT_ALLOWED;
+
+protected:
+    double segsPerTier;
+    double reclaimDeletesWeight;
+    double expungeDeletesPctAllowed;
+
+public:
+    /// Sets the allowed number of segments per tier.  Smaller values mean more merging but fewer segments.
+    /// This should be at least the merge factor, otherwise too much merging happens.
+    void setSegmentsPerTier(double segsPerTier);
+
+    /// @see #setSegmentsPerTier
+    double getSegmentsPerTier();
+
+    /// Controls how aggressively merges that reclaim more deletions are favored.  Higher values favor
+    /// selecting merges that reclaim deletions.  A value of 0.0 means deletions don't impact merge selection.
+    void setReclaimDeletesWeight(double reclaimDeletesWeight);
+
+    /// @see #setReclaimDeletesWeight
+    double getReclaimDeletesWeight();
+
+    /// When expungeDeletes is called, only segments with more than this percentage of deleted documents
+    /// are merged.
+    void setExpungeDeletesPctAllowed(double expungeDeletesPctAllowed);
+
+    /// @see #setExpungeDeletesPctAllowed
+    double getExpungeDeletesPctAllowed();
+
+    /// Merges the best scoring runs of adjacent segments while the index holds more segments than its
+    /// tiers allow.
+    virtual MergeSpecificationPtr findMerges(const SegmentInfosPtr& segmentInfos);
+
+    /// Merges runs of adjacent segments that hold more than the allowed percentage of deleted documents.
+    virtual MergeSpecificationPtr findMergesToExpungeDeletes(const SegmentInfosPtr& segmentInfos);
+
+protected:
+    /// Returns the number of segments the index may hold before merging is needed.
+    double allowedSegmentCount(int64_t totalBytes, int64_t minSegmentBytes);
+
+    /// Scores merging the segments [start, end); lower is better.
+    /// @param hitTooLarge true when the run stopped growing because the merged segment would be too large.
+    double score(const SegmentInfosPtr& infos, int32_t start, int32_t end, bool hitTooLarge);
+
+    /// Returns the size used for tiering, with tiny segments rounded up to the floor size.
+    int64_t floorSize(int64_t bytes);
+
+    /// Returns true if the segment is not excluded and may take part in normal merges.
+    bool isEligible(const SegmentInfoPtr& info, SetSegmentInfo excluded);
+};
+
+}
+
+#endif
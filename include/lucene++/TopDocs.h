@@ -42,6 +42,11 @@ public:
 
     /// Sets the maximum score value encountered.
     void setMaxScore(double maxScore);
+
+    /// Merge the results of several searches into the overall top n.  The hits of each shard must already be in
+    /// rank order and carry top-level doc ids.  If sort is null hits are ranked by score, otherwise every shard
+    /// must be a {@link TopFieldDocs} with filled fields and the result is a {@link TopFieldDocs}.
+    static TopDocsPtr merge(const SortPtr& sort, int32_t n, Collection<TopDocsPtr> shardHits);
 };
 
 }
@@ -33,6 +33,10 @@ protected:
     bool queueFull;
     int32_t docBase;
 
+    /// True while collecting a segment whose documents are already in this collector's sort order
+    bool segmentSorted;
+    String sortKey;
+
 public:
     /// Creates a new {@link TopFieldCollector} from the given arguments.
     ///
@@ -52,6 +56,10 @@ public:
     /// @param docsScoredInOrder Specifies whether documents are scored in doc Id order or not by the given
     /// {@link Scorer} in {@link #setScorer(ScorerPtr)}.
     /// @return a {@link TopFieldCollector} instance which will sort the results by the sort criteria.
+    ///
+    /// NOTE: If docsScoredInOrder is true and trackMaxScore is false, the collector stops collecting a segment
+    /// that {@link IndexWriter#setIndexSort} wrote in this sort order (or an order starting with it) at the
+    /// first hit that is not competitive.  {@link TopDocs#totalHits} then only counts the hits visited.
     static TopFieldCollectorPtr create(const SortPtr& sort, int32_t numHits, bool fillFields, bool trackDocScores, bool trackMaxScore, bool docsScoredInOrder);
 
     virtual void add(int32_t slot, int32_t doc, double score);
@@ -66,6 +74,13 @@ protected:
     virtual void populateResults(Collection<ScoreDocPtr> results, int32_t howMany);
 
     virtual TopDocsPtr newTopDocs(Collection<ScoreDocPtr> results, int32_t start);
+
+    /// Returns true if the reader is a segment whose documents are in this collector's sort order.
+    bool isSorted(const IndexReaderPtr& reader);
+
+    /// Called by the in-order collectors on a hit that is not competitive.  In a sorted segment no later hit
+    /// can compete either, so this ends the segment's collection.
+    void terminateIfSorted();
 };
 
 }
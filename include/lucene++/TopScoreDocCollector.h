@@ -37,6 +37,13 @@ public:
     /// NOTE: The instances returned by this method pre-allocate a full array of length numHits.
     static TopScoreDocCollectorPtr create(int32_t numHits, bool docsScoredInOrder);
 
+    /// Creates a new {@link TopScoreDocCollector} that, unless trackTotalHits is set, passes the score of the
+    /// weakest hit in a full queue on to {@link Scorer#setMinCompetitiveScore(double)}.  Scorers that support it,
+    /// such as disjunctions of terms from packed postings, then skip documents that cannot enter the queue, and
+    /// {@link TopDocs#totalHits} only counts the documents that were collected.  Such a collector requires
+    /// documents to be scored in order, whatever docsScoredInOrder says.
+    static TopScoreDocCollectorPtr create(int32_t numHits, bool docsScoredInOrder, bool trackTotalHits);
+
     virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase);
     virtual void setScorer(const ScorerPtr& scorer);
 
@@ -0,0 +1,31 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef VINTUTILS_H
+#define VINTUTILS_H
+
+#include "LuceneObject.h"
+
+namespace Lucene {
+
+/// Bulk decoding of the variable-length integers written by {@link IndexOutput#writeVInt(int32_t)}.
+class LPPAPI VIntUtils : public LuceneObject {
+public:
+    virtual ~VIntUtils();
+    LUCENE_CLASS(VIntUtils);
+
+public:
+    /// Decodes up to count VInts from bytes[offset, end) into values.  Runs of single byte values are
+    /// decoded sixteen at a time where SSE2 is available.  Stops early rather than decode a value that
+    /// is not complete within the range.
+    /// @param offset position of the first byte to decode, advanced past the last decoded value.
+    /// @return the number of values decoded.
+    static int32_t decode(const uint8_t* bytes, int32_t& offset, int32_t end, int32_t* values, int32_t count);
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef WANDSCORER_H
+#define WANDSCORER_H
+
+#include "Scorer.h"
+
+namespace Lucene {
+
+/// A Scorer for disjunctions of terms that skips documents which cannot score above the minimum competitive
+/// score passed to {@link #setMinCompetitiveScore(double)}.
+///
+/// Each term is bounded by the max freq the index records for it, and more tightly by the max freq of the
+/// postings block a candidate falls in (block-max WAND).  Sub-scorers are kept ordered by their current doc;
+/// the pivot is the first one at which the summed bounds exceed the minimum score, so every document before
+/// the pivot's doc is skipped.  Until a minimum score is set this matches every document, like {@link
+/// DisjunctionSumScorer} with the coord factor applied.
+class WANDScorer : public Scorer {
+public:
+    WANDScorer(const SimilarityPtr& similarity, Collection<TermScorerPtr> subScorers, Collection<double> normBounds);
+    virtual ~WANDScorer();
+
+    LUCENE_CLASS(WANDScorer);
+
+protected:
+    Collection<TermScorerPtr> subScorers;
+    int32_t nrScorers;
+
+    /// Current doc of each sub-scorer.
+    Collection<int32_t> subDocs;
+
+    /// Sub-scorer indexes ordered by their current doc.
+    Collection<int32_t> ordered;
+
+    /// Largest decoded norm of each sub-scorer's field.
+    Collection<double> normBounds;
+
+    /// Bound of each sub-scorer's score over all its documents.
+    Collection<double> maxScores;
+
+    /// coord(i, nrScorers), and its largest value for up to i matches, which is what bounds are scaled by.
+    Collection<double> coordFactors;
+    Collection<double> maxCoordFactors;
+
+    double minCompetitiveScore;
+    int32_t currentDoc;
+    double currentScore;
+
+public:
+    /// Returns a WANDScorer over the given sub-scorers, or null if one of them is not a {@link TermScorer}
+    /// over postings that record their max freqs.  The reader gives the largest norm of each term's field.
+    /// @see IndexReader#maxNorm(const String&)
+    static ScorerPtr create(const SimilarityPtr& similarity, const IndexReaderPtr& reader, Collection<ScorerPtr> subScorers);
+
+    virtual int32_t docID();
+    virtual int32_t nextDoc();
+    virtual int32_t advance(int32_t target);
+    virtual double score();
+    virtual void setMinCompetitiveScore(double minScore);
+
+protected:
+    /// Find the next document, at or after the current sub-scorer docs, that may score above the minimum.
+    int32_t findNext();
+
+    /// Restore the doc order of the sub-scorers.
+    void sortByDoc();
+};
+
+}
+
+#endif
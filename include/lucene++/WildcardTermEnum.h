@@ -7,7 +7,7 @@
 #ifndef WILDCARDTERMENUM_H
 #define WILDCARDTERMENUM_H
 
-#include "FilteredTermEnum.h"
+#include "AutomatonTermEnum.h"
 
 namespace Lucene {
 
@@ -15,7 +15,10 @@ namespace Lucene {
 ///
 /// Term enumerations are always ordered by Term.compareTo().  Each term in the enumeration is greater than
 /// all that precede it.
-class LPPAPI WildcardTermEnum : public FilteredTermEnum {
+///
+/// The pattern is compiled into an automaton so that runs of terms that cannot match are skipped by
+/// seeking the terms dictionary instead of being compared one by one.
+class LPPAPI WildcardTermEnum : public AutomatonTermEnum {
 public:
     /// Creates a new WildcardTermEnum.
     ///
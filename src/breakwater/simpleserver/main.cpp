@@ -35,6 +35,7 @@ extern "C" {
 #include "IndexSearcher.h"
 #include "KeywordAnalyzer.h"
 #include "Query.h"
+#include "SearchArena.h"
 #include "cc/net.h"
 #include "cc/runtime.h"
 #include "breakwater/rpc++.h"
@@ -240,7 +241,9 @@ void RequestHandler(struct srpc_ctx *ctx) {
   const payload *in = reinterpret_cast<const payload *>(ctx->req_buf);
   int core_id = get_current_affinity();
 
-  // Perform work
+  // Perform work, creating the request's objects in one arena
+  SearchArena arena;
+  SearchArena::Scope arenaScope(arena);
   QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"contents", terms[ntoh64(in->term_index)]));
   Collection<ScoreDocPtr> hits = searchers[core_id]->search(query, FilterPtr(), searchN)->scoreDocs;
 
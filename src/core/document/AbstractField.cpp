@@ -25,6 +25,7 @@ AbstractField::AbstractField() {
 
     this->lazy = false;
     this->omitTermFreqAndPositions = false;
+    this->docValuesType = DOC_VALUES_NONE;
     this->boost = 1.0;
     this->fieldsData = VariantUtils::null();
 
@@ -42,6 +43,7 @@ AbstractField::AbstractField(const String& name, Field::Store store, Field::Inde
 
     this->lazy = false;
     this->omitTermFreqAndPositions = false;
+    this->docValuesType = DOC_VALUES_NONE;
     this->boost = 1.0;
     this->fieldsData = VariantUtils::null();
 
@@ -136,6 +138,18 @@ void AbstractField::setOmitTermFreqAndPositions(bool omitTermFreqAndPositions) {
     this->omitTermFreqAndPositions = omitTermFreqAndPositions;
 }
 
+Fieldable::DocValuesType AbstractField::getDocValuesType() {
+    return docValuesType;
+}
+
+void AbstractField::setDocValuesType(DocValuesType docValuesType) {
+    this->docValuesType = docValuesType;
+}
+
+Collection<int64_t> AbstractField::getPointValue() {
+    return Collection<int64_t>();
+}
+
 bool AbstractField::isLazy() {
     return lazy;
 }
@@ -187,6 +201,12 @@ String AbstractField::toString() {
     if (omitTermFreqAndPositions) {
         result << L",omitTermFreqAndPositions";
     }
+    if (docValuesType != DOC_VALUES_NONE) {
+        result << L",docValues";
+    }
+    if (getPointValue()) {
+        result << L",points";
+    }
     if (lazy) {
         result << L",lazy";
     }
@@ -18,6 +18,7 @@
 namespace Lucene {
 
 const int32_t CompressionTools::COMPRESS_BUFFER = 4096;
+const int32_t CompressionTools::BEST_SPEED = 1; // zlib's Z_BEST_SPEED
 
 String ZLibToMessage(int32_t error) {
     if (error == boost::iostreams::zlib::okay) {
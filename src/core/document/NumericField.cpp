@@ -10,30 +10,35 @@
 #include "NumericUtils.h"
 #include "NumericTokenStream.h"
 #include "StringUtils.h"
+#include "VariantUtils.h"
 
 namespace Lucene {
 
 NumericField::NumericField(const String& name)
     : AbstractField(name, Field::STORE_NO, Field::INDEX_ANALYZED_NO_NORMS, Field::TERM_VECTOR_NO) {
     setOmitTermFreqAndPositions(true);
+    pointIndexed = false;
     tokenStream = newLucene<NumericTokenStream>(NumericUtils::PRECISION_STEP_DEFAULT);
 }
 
 NumericField::NumericField(const String& name, Field::Store store, bool index)
     : AbstractField(name, store, index ? Field::INDEX_ANALYZED_NO_NORMS : Field::INDEX_NO, Field::TERM_VECTOR_NO) {
     setOmitTermFreqAndPositions(true);
+    pointIndexed = false;
     tokenStream = newLucene<NumericTokenStream>(NumericUtils::PRECISION_STEP_DEFAULT);
 }
 
 NumericField::NumericField(const String& name, int32_t precisionStep)
     : AbstractField(name, Field::STORE_NO, Field::INDEX_ANALYZED_NO_NORMS, Field::TERM_VECTOR_NO) {
     setOmitTermFreqAndPositions(true);
+    pointIndexed = false;
     tokenStream = newLucene<NumericTokenStream>(precisionStep);
 }
 
 NumericField::NumericField(const String& name, int32_t precisionStep, Field::Store store, bool index)
     : AbstractField(name, store, index ? Field::INDEX_ANALYZED_NO_NORMS : Field::INDEX_NO, Field::TERM_VECTOR_NO) {
     setOmitTermFreqAndPositions(true);
+    pointIndexed = false;
     tokenStream = newLucene<NumericTokenStream>(precisionStep);
 }
 
@@ -62,6 +67,17 @@ int64_t NumericField::getNumericValue() {
     return StringUtils::toLong(stringValue());
 }
 
+double NumericField::getDoubleValue() {
+    if (VariantUtils::typeOf<double>(fieldsData)) {
+        return VariantUtils::get<double>(fieldsData);
+    } else if (VariantUtils::typeOf<int32_t>(fieldsData)) {
+        return (double)VariantUtils::get<int32_t>(fieldsData);
+    } else if (VariantUtils::typeOf<int64_t>(fieldsData)) {
+        return (double)VariantUtils::get<int64_t>(fieldsData);
+    }
+    return 0.0;
+}
+
 NumericFieldPtr NumericField::setLongValue(int64_t value) {
     tokenStream->setLongValue(value);
     fieldsData = value;
@@ -80,4 +96,26 @@ NumericFieldPtr NumericField::setDoubleValue(double value) {
     return shared_from_this();
 }
 
+bool NumericField::isPointIndexed() {
+    return pointIndexed;
+}
+
+void NumericField::setPointIndexed(bool pointIndexed) {
+    this->pointIndexed = pointIndexed;
+}
+
+Collection<int64_t> NumericField::getPointValue() {
+    if (!pointIndexed) {
+        return Collection<int64_t>();
+    }
+    if (VariantUtils::typeOf<double>(fieldsData)) {
+        return newCollection<int64_t>(NumericUtils::doubleToSortableLong(VariantUtils::get<double>(fieldsData)));
+    } else if (VariantUtils::typeOf<int32_t>(fieldsData)) {
+        return newCollection<int64_t>(VariantUtils::get<int32_t>(fieldsData));
+    } else if (VariantUtils::typeOf<int64_t>(fieldsData)) {
+        return newCollection<int64_t>(VariantUtils::get<int64_t>(fieldsData));
+    }
+    return Collection<int64_t>();
+}
+
 }
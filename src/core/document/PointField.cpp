@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PointField.h"
+#include "Field.h"
+#include "NumericUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+const int32_t PointField::MAX_DIMENSIONS = 8;
+
+PointField::PointField(const String& name, Collection<int64_t> point)
+    : AbstractField(name, Field::STORE_NO, Field::INDEX_NO, Field::TERM_VECTOR_NO) {
+    checkDimensions(point.size());
+    this->point = Collection<int64_t>::newInstance(point.begin(), point.end());
+}
+
+PointField::PointField(const String& name, Collection<double> point)
+    : AbstractField(name, Field::STORE_NO, Field::INDEX_NO, Field::TERM_VECTOR_NO) {
+    checkDimensions(point.size());
+    this->point = Collection<int64_t>::newInstance(point.size());
+    for (int32_t dim = 0; dim < point.size(); ++dim) {
+        this->point[dim] = NumericUtils::doubleToSortableLong(point[dim]);
+    }
+}
+
+PointField::~PointField() {
+}
+
+void PointField::checkDimensions(int32_t numDims) {
+    if (numDims < 1 || numDims > MAX_DIMENSIONS) {
+        boost::throw_exception(IllegalArgumentException(L"a point must have between 1 and " + StringUtils::toString(MAX_DIMENSIONS) + L" dimensions"));
+    }
+}
+
+TokenStreamPtr PointField::tokenStreamValue() {
+    return TokenStreamPtr();
+}
+
+ByteArray PointField::getBinaryValue(ByteArray result) {
+    return ByteArray();
+}
+
+ReaderPtr PointField::readerValue() {
+    return ReaderPtr();
+}
+
+String PointField::stringValue() {
+    StringStream value;
+    for (int32_t dim = 0; dim < point.size(); ++dim) {
+        if (dim > 0) {
+            value << L",";
+        }
+        value << point[dim];
+    }
+    return value.str();
+}
+
+Collection<int64_t> PointField::getPointValue() {
+    return point;
+}
+
+}
@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _FIELDSREADER_H
+#define _FIELDSREADER_H
+
+#include "IndexInput.h"
+
+namespace Lucene {
+
+/// A decompressed chunk of stored documents.
+class FieldsChunk : public LuceneObject {
+public:
+    FieldsChunk(int64_t pointer, int32_t firstDoc, Collection<int32_t> docStarts, ByteArray bytes);
+    virtual ~FieldsChunk();
+
+    LUCENE_CLASS(FieldsChunk);
+
+public:
+    int64_t pointer; // Where the chunk starts in the fields stream
+    int32_t firstDoc;
+    Collection<int32_t> docStarts; // Start of each document in bytes, followed by the end of the last one
+    ByteArray bytes;
+
+public:
+    int32_t numDocs();
+};
+
+/// Reads the documents of a decompressed chunk.
+class FieldsChunkInput : public IndexInput {
+public:
+    FieldsChunkInput(ByteArray bytes, int32_t length);
+    virtual ~FieldsChunkInput();
+
+    LUCENE_CLASS(FieldsChunkInput);
+
+protected:
+    ByteArray bytes;
+    int32_t _length;
+    int32_t position;
+
+public:
+    /// Reads and returns a single byte.
+    virtual uint8_t readByte();
+
+    /// Reads a specified number of bytes into an array at the specified offset.
+    virtual void readBytes(uint8_t* b, int32_t offset, int32_t length);
+
+    /// Returns the current position in this file, where the next read will occur.
+    virtual int64_t getFilePointer();
+
+    /// Sets current position in this file, where the next read will occur.
+    virtual void seek(int64_t pos);
+
+    /// The number of bytes in the file.
+    virtual int64_t length();
+
+    /// Closes the stream to further operations.
+    virtual void close();
+
+    /// Returns a clone of this stream.
+    virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
+};
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _INDEXSEARCHER_H
+#define _INDEXSEARCHER_H
+
+#include "ThreadPool.h"
+
+namespace Lucene {
+
+/// Collects the top hits of one slice of an {@link IndexSearcher} into a private collector.
+class IndexSearcherSlice : public LuceneObject, public ThreadPoolCallable<TopDocsPtr> {
+public:
+    IndexSearcherSlice(const IndexSearcherPtr& searcher, int32_t slice, const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort);
+    virtual ~IndexSearcherSlice();
+
+    LUCENE_CLASS(IndexSearcherSlice);
+
+protected:
+    IndexSearcherPtr searcher;
+    int32_t slice;
+    WeightPtr weight;
+    FilterPtr filter;
+    int32_t n;
+    SortPtr sort;
+
+public:
+    virtual TopDocsPtr call();
+};
+
+}
+
+#endif
@@ -9,27 +9,45 @@
 
 #include <boost/iostreams/device/mapped_file.hpp>
 #include "IndexInput.h"
+#include "MMapDirectory.h"
 
 namespace Lucene {
 
 class MMapIndexInput : public IndexInput {
 public:
-    MMapIndexInput(const String& path = L"");
+    MMapIndexInput(const String& path = L"", MMapDirectory::ReadAdvice advice = MMapDirectory::ADVICE_NORMAL, bool preload = false);
     virtual ~MMapIndexInput();
 
     LUCENE_CLASS(MMapIndexInput);
 
 protected:
-    int32_t _length;
+    int64_t _length;
     bool isClone;
     boost::iostreams::mapped_file_source file;
-    int32_t bufferPosition; // next byte to read
+    const uint8_t* data; // start of the mapping
+    int64_t bufferPosition; // next byte to read
 
 public:
     /// Reads and returns a single byte.
     /// @see IndexOutput#writeByte(uint8_t)
     virtual uint8_t readByte();
 
+    /// Reads four bytes straight from the mapped file.
+    /// @see IndexInput#readInt()
+    virtual int32_t readInt();
+
+    /// Reads an int stored in variable-length format straight from the mapped file.
+    /// @see IndexInput#readVInt()
+    virtual int32_t readVInt();
+
+    /// Reads count ints stored in variable-length format, decoding straight from the mapped file.
+    /// @see IndexInput#readVInts(int32_t*, int32_t)
+    virtual void readVInts(int32_t* values, int32_t count);
+
+    /// Reads a long stored in variable-length format straight from the mapped file.
+    /// @see IndexInput#readVLong()
+    virtual int64_t readVLong();
+
     /// Reads a specified number of bytes into an array at the specified offset.
     /// @param b the array to read bytes into.
     /// @param offset the offset in the array to start storing bytes.
@@ -53,6 +71,13 @@ public:
 
     /// Returns a clone of this stream.
     virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
+
+protected:
+    /// Pass the access pattern hint for the whole mapping on to the kernel.
+    void advise(MMapDirectory::ReadAdvice advice);
+
+    /// Fault in every page of the mapping.
+    void touchPages();
 };
 
 }
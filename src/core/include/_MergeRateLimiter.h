@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MERGERATELIMITER_H
+#define _MERGERATELIMITER_H
+
+#include "Directory.h"
+#include "BufferedIndexOutput.h"
+
+namespace Lucene {
+
+/// Directory used by a merge: every output it creates is throttled by the merge's {@link MergeRateLimiter},
+/// everything else goes straight to the writer's directory.
+class RateLimitedDirectory : public Directory {
+public:
+    RateLimitedDirectory(const DirectoryPtr& directory, const MergeRateLimiterPtr& rateLimiter);
+    virtual ~RateLimitedDirectory();
+
+    LUCENE_CLASS(RateLimitedDirectory);
+
+protected:
+    DirectoryPtr directory;
+    MergeRateLimiterPtr rateLimiter;
+
+public:
+    /// Returns the wrapped directory.
+    DirectoryPtr getDelegate();
+
+    virtual HashSet<String> listAll();
+    virtual bool fileExists(const String& name);
+    virtual uint64_t fileModified(const String& name);
+    virtual void touchFile(const String& name);
+    virtual void deleteFile(const String& name);
+    virtual int64_t fileLength(const String& name);
+    virtual IndexOutputPtr createOutput(const String& name);
+    virtual IndexInputPtr openInput(const String& name);
+    virtual IndexInputPtr openInput(const String& name, int32_t bufferSize);
+    virtual void sync(const String& name);
+    virtual LockPtr makeLock(const String& name);
+    virtual String getLockID();
+    virtual void close();
+    virtual String toString();
+};
+
+/// Buffers writes and passes each full buffer to the wrapped output once the rate limiter allows it.
+class RateLimitedIndexOutput : public BufferedIndexOutput {
+public:
+    RateLimitedIndexOutput(const IndexOutputPtr& output, const MergeRateLimiterPtr& rateLimiter);
+    virtual ~RateLimitedIndexOutput();
+
+    LUCENE_CLASS(RateLimitedIndexOutput);
+
+protected:
+    IndexOutputPtr output;
+    MergeRateLimiterPtr rateLimiter;
+
+public:
+    virtual void flushBuffer(const uint8_t* b, int32_t offset, int32_t length);
+    virtual void flush();
+    virtual void close();
+    virtual void seek(int64_t pos);
+    virtual int64_t length();
+    virtual void setLength(int64_t length);
+};
+
+}
+
+#endif
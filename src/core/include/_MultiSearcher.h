@@ -9,6 +9,7 @@
 
 #include "Searcher.h"
 #include "Collector.h"
+#include "ThreadPool.h"
 
 namespace Lucene {
 
@@ -39,8 +40,9 @@ public:
     virtual TopFieldDocsPtr search(const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort);
 };
 
-/// A subclass for searching a single searchable
-class MultiSearcherCallableNoSort : public LuceneObject {
+/// A subclass for searching a single searchable.  Hits are merged into the given queue under the given lock;
+/// without a queue they are only converted to top-level doc ids and returned.
+class MultiSearcherCallableNoSort : public LuceneObject, public ThreadPoolCallable<TopDocsPtr> {
 public:
     MultiSearcherCallableNoSort(const SynchronizePtr& lock, const SearchablePtr& searchable, const WeightPtr& weight, const FilterPtr& filter, int32_t nDocs,
                                 const HitQueuePtr& hq, int32_t i, Collection<int32_t> starts);
@@ -59,11 +61,12 @@ protected:
     Collection<int32_t> starts;
 
 public:
-    TopDocsPtr call();
+    virtual TopDocsPtr call();
 };
 
-/// A subclass for searching a single searchable
-class MultiSearcherCallableWithSort : public LuceneObject {
+/// A subclass for searching a single searchable, allowing sorting.  Hits are merged into the given queue under
+/// the given lock; without a queue they are only converted to top-level doc ids and returned.
+class MultiSearcherCallableWithSort : public LuceneObject, public ThreadPoolCallable<TopFieldDocsPtr> {
 public:
     MultiSearcherCallableWithSort(const SynchronizePtr& lock, const SearchablePtr& searchable, const WeightPtr& weight, const FilterPtr& filter,
                                   int32_t nDocs, const FieldDocSortedHitQueuePtr& hq, const SortPtr& sort, int32_t i, Collection<int32_t> starts);
@@ -83,7 +86,7 @@ protected:
     SortPtr sort;
 
 public:
-    TopFieldDocsPtr call();
+    virtual TopFieldDocsPtr call();
 };
 
 class MultiSearcherCollector : public Collector {
@@ -0,0 +1,36 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _POINTRANGEFILTER_H
+#define _POINTRANGEFILTER_H
+
+#include "PointValues.h"
+
+namespace Lucene {
+
+/// Sets the bits of the documents with a point inside the box of a {@link PointRangeFilter}.
+class PointRangeVisitor : public PointVisitor {
+public:
+    PointRangeVisitor(Collection<int64_t> lowerValue, Collection<int64_t> upperValue, const OpenBitSetPtr& bits);
+    virtual ~PointRangeVisitor();
+
+    LUCENE_CLASS(PointRangeVisitor);
+
+protected:
+    Collection<int64_t> lowerValue;
+    Collection<int64_t> upperValue;
+    int32_t numDims;
+    OpenBitSetPtr bits;
+
+public:
+    virtual void visit(int32_t doc);
+    virtual void visit(int32_t doc, const int64_t* point);
+    virtual Relation compare(const int64_t* minValues, const int64_t* maxValues);
+};
+
+}
+
+#endif
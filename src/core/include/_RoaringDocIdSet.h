@@ -0,0 +1,79 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _ROARINGDOCIDSET_H
+#define _ROARINGDOCIDSET_H
+
+#include "DocIdSetIterator.h"
+
+namespace Lucene {
+
+/// The docs of one block of a {@link RoaringDocIdSet}, by the lower 16 bits of their ids.
+class RoaringContainer : public LuceneObject {
+public:
+    enum ContainerType { ARRAY, BITMAP, RUN };
+
+    RoaringContainer(ContainerType type, int32_t cardinality);
+    virtual ~RoaringContainer();
+
+    LUCENE_CLASS(RoaringContainer);
+
+public:
+    /// Number of words of a bitmap container.
+    static const int32_t BITMAP_WORDS;
+
+    ContainerType type;
+    int32_t cardinality;
+    Array<uint16_t> values; // ARRAY: the sorted docs; RUN: the first and last doc of each run
+    int32_t numRuns;
+    LongArray bits; // BITMAP
+
+public:
+    /// Returns the smallest container holding count sorted, distinct docs.
+    static RoaringContainerPtr fromSorted(const uint16_t* docs, int32_t count);
+
+    /// Returns the smallest container holding the docs set in bits, or null if there are none.
+    static RoaringContainerPtr fromBitmap(LongArray bits);
+
+    static RoaringContainerPtr intersect(const RoaringContainerPtr& a, const RoaringContainerPtr& b);
+    static RoaringContainerPtr _union(const RoaringContainerPtr& a, const RoaringContainerPtr& b);
+
+    bool get(int32_t doc);
+
+    /// Returns the first doc at or after target, or -1 if there is none.  index is where the previous search
+    /// ended for array and run containers, and searches must be for increasing targets.
+    int32_t nextDoc(int32_t target, int32_t& index);
+
+    /// Sets the docs of this container in bitmap.
+    void toBitmap(int64_t* bitmap);
+
+    int64_t sizeInBytes();
+};
+
+class RoaringDocIdSetIterator : public DocIdSetIterator {
+public:
+    RoaringDocIdSetIterator(const RoaringDocIdSetPtr& set);
+    virtual ~RoaringDocIdSetIterator();
+
+    LUCENE_CLASS(RoaringDocIdSetIterator);
+
+protected:
+    Collection<RoaringContainerPtr> containers;
+    int32_t maxDoc;
+    int32_t block;
+    RoaringContainerPtr container;
+    int32_t index;
+    int32_t doc;
+
+public:
+    virtual int32_t docID();
+    virtual int32_t nextDoc();
+    virtual int32_t advance(int32_t target);
+};
+
+}
+
+#endif
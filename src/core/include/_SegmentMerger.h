@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SEGMENTMERGER_H
+#define _SEGMENTMERGER_H
+
+#include "ThreadPool.h"
+#include "PointValues.h"
+
+namespace Lucene {
+
+/// Writes one of the independent files of a merged segment on the merge's thread pool.
+class SegmentMergerPart : public LuceneObject, public ThreadPoolTask {
+public:
+    enum Part {
+        STORED_FIELDS,
+        VECTORS,
+        POSTINGS,
+        NORMS,
+        DOC_VALUES,
+        POINTS
+    };
+
+    SegmentMergerPart(const SegmentMergerPtr& merger, Part part);
+    virtual ~SegmentMergerPart();
+
+    LUCENE_CLASS(SegmentMergerPart);
+
+protected:
+    SegmentMergerPtr merger;
+    Part part;
+
+public:
+    virtual void run();
+};
+
+/// Gathers every point of a segment being merged, dropping those of deleted documents and renumbering the
+/// others to their merged document.
+class MergePointVisitor : public PointVisitor {
+public:
+    MergePointVisitor(Collection<int32_t> docMap, int32_t numDims, Collection<int32_t> docs, Collection<int64_t> values);
+    virtual ~MergePointVisitor();
+
+    LUCENE_CLASS(MergePointVisitor);
+
+protected:
+    /// The merged document of each document of the segment, or -1 if it was deleted.
+    Collection<int32_t> docMap;
+    int32_t numDims;
+    Collection<int32_t> docs;
+    Collection<int64_t> values;
+
+public:
+    virtual void visit(int32_t doc);
+    virtual void visit(int32_t doc, const int64_t* point);
+    virtual Relation compare(const int64_t* minValues, const int64_t* maxValues);
+};
+
+}
+
+#endif
@@ -33,6 +33,8 @@ public:
     IndexInputPtr freqStream;
     IndexInputPtr proxStream;
     TermInfosReaderPtr tisNoIndex;
+    DocValuesReaderPtr docValuesReader;
+    PointsReaderPtr pointsReader;
 
     DirectoryPtr dir;
     DirectoryPtr cfsDir;
@@ -125,6 +127,9 @@ protected:
     int32_t number;
     bool rollbackDirty;
 
+    /// Largest decoded norm in _bytes, or -1 until it is first asked for.
+    double _maxNorm;
+
 public:
     void incRef();
     void decRef();
@@ -142,6 +147,10 @@ public:
     // with others
     ByteArray copyOnWrite();
 
+    /// Load & cache full bytes array and return the largest of its decoded norms, which is only computed
+    /// again once the bytes are changed.
+    double maxNorm();
+
     /// Returns a copy of this Norm instance that shares IndexInput & bytes with the original one
     virtual LuceneObjectPtr clone(const LuceneObjectPtr& other = LuceneObjectPtr());
 
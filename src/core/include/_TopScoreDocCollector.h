@@ -22,6 +22,23 @@ public:
 public:
     virtual void collect(int32_t doc);
     virtual bool acceptsDocsOutOfOrder();
+    virtual bool acceptsBatches();
+    virtual void collectBatch(const int32_t* docs, const double* scores, int32_t count);
+};
+
+/// Assumes docs are scored in order, and lets the scorer skip docs that score no higher than the queue's
+/// weakest hit once it is full.
+class MinCompetitiveTopScoreDocCollector : public InOrderTopScoreDocCollector {
+public:
+    MinCompetitiveTopScoreDocCollector(int32_t numHits);
+    virtual ~MinCompetitiveTopScoreDocCollector();
+
+    LUCENE_CLASS(MinCompetitiveTopScoreDocCollector);
+
+public:
+    virtual void setScorer(const ScorerPtr& scorer);
+    virtual void collect(int32_t doc);
+    virtual void collectBatch(const int32_t* docs, const double* scores, int32_t count);
 };
 
 /// Assumes docs are scored out of order.
@@ -35,6 +52,8 @@ public:
 public:
     virtual void collect(int32_t doc);
     virtual bool acceptsDocsOutOfOrder();
+    virtual bool acceptsBatches();
+    virtual void collectBatch(const int32_t* docs, const double* scores, int32_t count);
 };
 
 }
@@ -7,10 +7,11 @@
 #include "LuceneInc.h"
 #include "CharBlockPool.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 
 namespace Lucene {
 
-CharBlockPool::CharBlockPool(const DocumentsWriterPtr& docWriter) {
+CharBlockPool::CharBlockPool(const DocumentsWriterPerThreadPtr& docWriter) {
     numBuffer = 0;
     bufferUpto = -1;
     charUpto = DocumentsWriter::CHAR_BLOCK_SIZE;
@@ -23,7 +24,7 @@ CharBlockPool::~CharBlockPool() {
 }
 
 void CharBlockPool::reset() {
-    DocumentsWriterPtr(_docWriter)->recycleCharBlocks(buffers, 1 + bufferUpto);
+    DocumentsWriterPerThreadPtr(_docWriter)->recycleCharBlocks(buffers, 1 + bufferUpto);
     bufferUpto = -1;
     charUpto = DocumentsWriter::CHAR_BLOCK_SIZE;
     charOffset = -DocumentsWriter::CHAR_BLOCK_SIZE;
@@ -33,7 +34,7 @@ void CharBlockPool::nextBuffer() {
     if (1 + bufferUpto == buffers.size()) {
         buffers.resize((int32_t)((double)buffers.size() * 1.5));
     }
-    buffers[1 + bufferUpto] = DocumentsWriterPtr(_docWriter)->getCharBlock();
+    buffers[1 + bufferUpto] = DocumentsWriterPerThreadPtr(_docWriter)->getCharBlock();
     buffer = buffers[1 + bufferUpto];
     ++bufferUpto;
 
@@ -109,6 +109,8 @@ IndexStatusPtr CheckIndex::checkIndex(Collection<String> onlySegments) {
             sFormat = L"FORMAT_USER_DATA [Lucene 2.9]";
         } else if (format == SegmentInfos::FORMAT_DIAGNOSTICS) {
             sFormat = L"FORMAT_DIAGNOSTICS [Lucene 2.9]";
+        } else if (format == SegmentInfos::FORMAT_PACKED_POSTINGS) {
+            sFormat = L"FORMAT_PACKED_POSTINGS";
         } else if (format < SegmentInfos::CURRENT_FORMAT) {
             sFormat = L"int=" + StringUtils::toString(format) + L" [newer version of Lucene than this tool]";
             skip = true;
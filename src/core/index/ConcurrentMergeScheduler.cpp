@@ -5,9 +5,12 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "LuceneInc.h"
+#include <thread>
 #include "ConcurrentMergeScheduler.h"
 #include "_ConcurrentMergeScheduler.h"
 #include "IndexWriter.h"
+#include "MergeRateLimiter.h"
+#include "ThreadPool.h"
 #include "TestPoint.h"
 #include "StringUtils.h"
 
@@ -15,11 +18,15 @@ namespace Lucene {
 
 Collection<ConcurrentMergeSchedulerPtr> ConcurrentMergeScheduler::allInstances;
 bool ConcurrentMergeScheduler::anyExceptions = false;
+const int32_t ConcurrentMergeScheduler::MERGE_POOL_SIZE = 4;
 
 ConcurrentMergeScheduler::ConcurrentMergeScheduler() {
     mergeThreadPriority = -1;
     mergeThreads = SetMergeThread::newInstance();
-    maxThreadCount = 1;
+    // Leave half of the cores to indexing and searching
+    maxThreadCount = std::max(1, std::min(3, (int32_t)std::thread::hardware_concurrency() / 2));
+    mergeExecutor = getMergePool();
+    rateLimiter = newLucene<MergeRateLimiter>();
     suppressExceptions = false;
     closed = false;
 }
@@ -45,6 +52,37 @@ int32_t ConcurrentMergeScheduler::getMaxThreadCount() {
     return maxThreadCount;
 }
 
+ThreadPoolPtr ConcurrentMergeScheduler::getMergePool() {
+    static rt::Mutex lockMutex;
+    static ThreadPoolPtr mergePool;
+    rt::ScopedLock<rt::Mutex> syncLock(&lockMutex); // the first merges may start together
+    if (!mergePool) {
+        mergePool = newLucene<ThreadPool>(MERGE_POOL_SIZE);
+        CycleCheck::addStatic(mergePool);
+    }
+    return mergePool;
+}
+
+void ConcurrentMergeScheduler::setMergeExecutor(const ThreadPoolPtr& executor) {
+    SyncLock syncLock(this);
+    mergeExecutor = executor;
+}
+
+ThreadPoolPtr ConcurrentMergeScheduler::getMergeExecutor() {
+    SyncLock syncLock(this);
+    return mergeExecutor;
+}
+
+void ConcurrentMergeScheduler::setMergeRateLimiter(const MergeRateLimiterPtr& rateLimiter) {
+    SyncLock syncLock(this);
+    this->rateLimiter = rateLimiter;
+}
+
+MergeRateLimiterPtr ConcurrentMergeScheduler::getMergeRateLimiter() {
+    SyncLock syncLock(this);
+    return rateLimiter;
+}
+
 int32_t ConcurrentMergeScheduler::getMergeThreadPriority() {
     SyncLock syncLock(this);
     initMergeThreadPriority();
@@ -166,6 +204,11 @@ void ConcurrentMergeScheduler::merge(const IndexWriterPtr& writer) {
 
 void ConcurrentMergeScheduler::doMerge(const OneMergePtr& merge) {
     TestScope testScope(L"ConcurrentMergeScheduler", L"doMerge");
+    {
+        SyncLock syncLock(this);
+        merge->executor = mergeExecutor;
+        merge->rateLimiter = rateLimiter;
+    }
     IndexWriterPtr(_writer)->merge(merge);
 }
 
@@ -10,6 +10,8 @@
 #include "DocFieldConsumerPerThread.h"
 #include "DocFieldConsumer.h"
 #include "StoredFieldsWriter.h"
+#include "DocValuesWriter.h"
+#include "PointsWriter.h"
 #include "SegmentWriteState.h"
 #include "IndexFileNames.h"
 #include "FieldInfos.h"
@@ -17,12 +19,14 @@
 
 namespace Lucene {
 
-DocFieldProcessor::DocFieldProcessor(const DocumentsWriterPtr& docWriter, const DocFieldConsumerPtr& consumer) {
+DocFieldProcessor::DocFieldProcessor(const DocumentsWriterPerThreadPtr& docWriter, const DocFieldConsumerPtr& consumer) {
     this->fieldInfos = newLucene<FieldInfos>();
     this->_docWriter = docWriter;
     this->consumer = consumer;
     consumer->setFieldInfos(fieldInfos);
     fieldsWriter = newLucene<StoredFieldsWriter>(docWriter, fieldInfos);
+    docValuesWriter = newLucene<DocValuesWriter>(fieldInfos);
+    pointsWriter = newLucene<PointsWriter>(fieldInfos);
 }
 
 DocFieldProcessor::~DocFieldProcessor() {
@@ -36,14 +40,20 @@ void DocFieldProcessor::closeDocStore(const SegmentWriteStatePtr& state) {
 void DocFieldProcessor::flush(Collection<DocConsumerPerThreadPtr> threads, const SegmentWriteStatePtr& state) {
     TestScope testScope(L"DocFieldProcessor", L"flush");
     MapDocFieldConsumerPerThreadCollectionDocFieldConsumerPerField childThreadsAndFields(MapDocFieldConsumerPerThreadCollectionDocFieldConsumerPerField::newInstance());
+    Collection<DocValuesWriterPerThreadPtr> docValuesThreads(Collection<DocValuesWriterPerThreadPtr>::newInstance());
+    Collection<PointsWriterPerThreadPtr> pointsThreads(Collection<PointsWriterPerThreadPtr>::newInstance());
 
     for (Collection<DocConsumerPerThreadPtr>::iterator thread = threads.begin(); thread != threads.end(); ++thread) {
         DocFieldProcessorPerThreadPtr perThread(std::static_pointer_cast<DocFieldProcessorPerThread>(*thread));
         childThreadsAndFields.put(perThread->consumer, perThread->fields());
+        docValuesThreads.add(perThread->docValuesWriter);
+        pointsThreads.add(perThread->pointsWriter);
         perThread->trimFields(state);
     }
     fieldsWriter->flush(state);
     consumer->flush(childThreadsAndFields, state);
+    docValuesWriter->flush(docValuesThreads, state);
+    pointsWriter->flush(pointsThreads, state);
 
     // Important to save after asking consumer to flush so consumer can alter the FieldInfo* if necessary.
     // eg FreqProxTermsWriter does this with FieldInfo.storePayload.
@@ -13,8 +13,13 @@
 #include "DocFieldConsumerPerField.h"
 #include "DocumentsWriterThreadState.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 #include "StoredFieldsWriter.h"
 #include "StoredFieldsWriterPerThread.h"
+#include "DocValuesWriter.h"
+#include "DocValuesWriterPerThread.h"
+#include "PointsWriter.h"
+#include "PointsWriterPerThread.h"
 #include "SegmentWriteState.h"
 #include "FieldInfo.h"
 #include "FieldInfos.h"
@@ -51,6 +56,8 @@ void DocFieldProcessorPerThread::initialize() {
     DocFieldProcessorPtr docFieldProcessor(_docFieldProcessor);
     consumer = docFieldProcessor->consumer->addThread(shared_from_this());
     fieldsWriter = docFieldProcessor->fieldsWriter->addThread(docState);
+    docValuesWriter = docFieldProcessor->docValuesWriter->addThread(docState);
+    pointsWriter = docFieldProcessor->pointsWriter->addThread(docState);
 }
 
 void DocFieldProcessorPerThread::abort() {
@@ -63,6 +70,8 @@ void DocFieldProcessorPerThread::abort() {
         }
     }
     fieldsWriter->abort();
+    docValuesWriter->abort();
+    pointsWriter->abort();
     consumer->abort();
 }
 
@@ -95,7 +104,7 @@ void DocFieldProcessorPerThread::trimFields(const SegmentWriteStatePtr& state) {
                     lastPerField->next = current->next;
                 }
 
-                DocumentsWriterPtr docWriter(state->_docWriter);
+                DocumentsWriterPerThreadPtr docWriter(state->_docWriter);
                 if (docWriter->infoStream) {
                     *(docWriter->infoStream) << L"  purge field=" << current->fieldInfo->name << L"\n";
                 }
@@ -148,7 +157,7 @@ DocWriterPtr DocFieldProcessorPerThread::processDocument() {
     DocumentPtr doc(docState->doc);
 
     DocFieldProcessorPtr docFieldProcessor(_docFieldProcessor);
-    DocumentsWriterPtr docWriter(docFieldProcessor->_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(docFieldProcessor->_docWriter);
     bool testPoint = IndexWriterPtr(docWriter->_writer)->testPoint(L"DocumentsWriter.ThreadState.init start");
     BOOST_ASSERT(testPoint);
 
@@ -210,6 +219,15 @@ DocWriterPtr DocFieldProcessorPerThread::processDocument() {
         if ((*field)->isStored()) {
             fieldsWriter->addField(*field, fp->fieldInfo);
         }
+        if ((*field)->getDocValuesType() != Fieldable::DOC_VALUES_NONE) {
+            fp->fieldInfo->setDocValuesType((*field)->getDocValuesType());
+            docValuesWriter->addField(*field, fp->fieldInfo);
+        }
+        Collection<int64_t> point((*field)->getPointValue());
+        if (point) {
+            fp->fieldInfo->setPointDimensions(point.size());
+            pointsWriter->addField(point, fp->fieldInfo);
+        }
     }
 
     // If we are writing vectors then we must visit fields in sorted order so they are written in sorted order.
@@ -15,6 +15,7 @@
 #include "FieldInfo.h"
 #include "FieldInvertState.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 #include "Document.h"
 #include "Analyzer.h"
 #include "ReusableStringReader.h"
@@ -53,7 +54,7 @@ void DocInverterPerField::processFields(Collection<FieldablePtr> fields, int32_t
 
     int32_t maxFieldLength = docState->maxFieldLength;
     bool doInvert = consumer->start(fields, count);
-    DocumentsWriterPtr docWriter(docState->_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(docState->_docWriter);
     DocInverterPerThreadPtr perThread(_perThread);
 
     for (int32_t i = 0; i < count; ++i) {
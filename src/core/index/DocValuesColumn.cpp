@@ -0,0 +1,133 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocValuesColumn.h"
+#include "PackedLongs.h"
+#include "IndexInput.h"
+#include "NumericUtils.h"
+#include "StringUtils.h"
+#include "BytesRef.h"
+
+namespace Lucene {
+
+DocValuesColumn::DocValuesColumn(const IndexInputPtr& input, Fieldable::DocValuesType type, int32_t maxDoc) {
+    this->type = type;
+    this->maxDoc = maxDoc;
+    this->valueCount = 0;
+    switch (type) {
+    case Fieldable::DOC_VALUES_NUMERIC:
+    case Fieldable::DOC_VALUES_DOUBLE:
+        values = newLucene<PackedLongs>(input, maxDoc);
+        break;
+    case Fieldable::DOC_VALUES_BINARY:
+    case Fieldable::DOC_VALUES_SORTED: {
+        int32_t numStrings = maxDoc;
+        if (type == Fieldable::DOC_VALUES_SORTED) {
+            valueCount = input->readVInt();
+            numStrings = valueCount;
+        }
+        addresses = newLucene<PackedLongs>(input, numStrings + 1);
+        bytes = ByteArray::newInstance((int32_t)addresses->get(numStrings));
+        if (bytes.size() > 0) {
+            input->readBytes(bytes.get(), 0, bytes.size());
+        }
+        if (type == Fieldable::DOC_VALUES_SORTED) {
+            values = newLucene<PackedLongs>(input, maxDoc);
+        }
+        break;
+    }
+    default:
+        boost::throw_exception(CorruptIndexException(L"unknown doc values type " + StringUtils::toString((int32_t)type)));
+    }
+}
+
+DocValuesColumn::~DocValuesColumn() {
+}
+
+Fieldable::DocValuesType DocValuesColumn::getType() {
+    return type;
+}
+
+bool DocValuesColumn::isNumeric() {
+    return (type == Fieldable::DOC_VALUES_NUMERIC || type == Fieldable::DOC_VALUES_DOUBLE);
+}
+
+int32_t DocValuesColumn::size() {
+    return maxDoc;
+}
+
+int64_t DocValuesColumn::getLong(int32_t doc) {
+    if (type == Fieldable::DOC_VALUES_DOUBLE) {
+        return (int64_t)getDouble(doc);
+    }
+    return type == Fieldable::DOC_VALUES_NUMERIC ? values->get(doc) : 0;
+}
+
+double DocValuesColumn::getDouble(int32_t doc) {
+    if (type == Fieldable::DOC_VALUES_DOUBLE) {
+        return NumericUtils::sortableLongToDouble(values->get(doc));
+    }
+    return type == Fieldable::DOC_VALUES_NUMERIC ? (double)values->get(doc) : 0.0;
+}
+
+int32_t DocValuesColumn::getOrd(int32_t doc) {
+    return type == Fieldable::DOC_VALUES_SORTED ? (int32_t)values->get(doc) : 0;
+}
+
+int32_t DocValuesColumn::getValueCount() {
+    return valueCount;
+}
+
+String DocValuesColumn::lookup(int32_t ord) {
+    return ord == 0 ? L"" : getStringAt(ord - 1);
+}
+
+String DocValuesColumn::getString(int32_t doc) {
+    switch (type) {
+    case Fieldable::DOC_VALUES_BINARY:
+        return getStringAt(doc);
+    case Fieldable::DOC_VALUES_SORTED:
+        return lookup(getOrd(doc));
+    case Fieldable::DOC_VALUES_DOUBLE:
+        return StringUtils::toString(getDouble(doc));
+    default:
+        return StringUtils::toString(getLong(doc));
+    }
+}
+
+String DocValuesColumn::getStringAt(int32_t index) {
+    int32_t start = (int32_t)addresses->get(index);
+    int32_t end = (int32_t)addresses->get(index + 1);
+    return start == end ? L"" : StringUtils::toUnicode(bytes.get() + start, end - start);
+}
+
+int32_t DocValuesColumn::compareString(int32_t doc, const BytesRefPtr& value) {
+    return type == Fieldable::DOC_VALUES_SORTED ? compareLookup(getOrd(doc), value) : compareStringAt(doc, value);
+}
+
+int32_t DocValuesColumn::compareLookup(int32_t ord, const BytesRefPtr& value) {
+    return ord == 0 ? (value->length == 0 ? 0 : -1) : compareStringAt(ord - 1, value);
+}
+
+int32_t DocValuesColumn::compareStringAt(int32_t index, const BytesRefPtr& value) {
+    int32_t start = (int32_t)addresses->get(index);
+    int32_t end = (int32_t)addresses->get(index + 1);
+    return BytesRef::compareBytes(bytes.get() + start, end - start, value->bytes.get() + value->offset, value->length);
+}
+
+int64_t DocValuesColumn::sizeInBytes() {
+    int64_t size = bytes ? bytes.size() : 0;
+    if (values) {
+        size += values->sizeInBytes();
+    }
+    if (addresses) {
+        size += addresses->sizeInBytes();
+    }
+    return size;
+}
+
+}
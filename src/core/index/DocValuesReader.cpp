@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocValuesReader.h"
+#include "DocValuesWriter.h"
+#include "DocValuesColumn.h"
+#include "IndexFileNames.h"
+#include "IndexInput.h"
+#include "Directory.h"
+#include "FieldInfo.h"
+#include "FieldInfos.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+DocValuesReader::DocValuesReader(const DirectoryPtr& dir, const String& segment, const FieldInfosPtr& fieldInfos, int32_t readBufferSize) {
+    this->fieldInfos = fieldInfos;
+    this->maxDoc = 0;
+    pointers = Collection<int64_t>::newInstance(fieldInfos->size());
+    std::fill(pointers.begin(), pointers.end(), -1);
+    columns = Collection<DocValuesColumnPtr>::newInstance(fieldInfos->size());
+
+    input = dir->openInput(segment + L"." + IndexFileNames::DOC_VALUES_EXTENSION(), readBufferSize);
+    bool success = false;
+    LuceneException finally;
+    try {
+        int32_t format = input->readInt();
+        if (format != DocValuesWriter::FORMAT_CURRENT) {
+            boost::throw_exception(CorruptIndexException(L"unknown doc values format version: " + StringUtils::toString(format)));
+        }
+        maxDoc = input->readVInt();
+        input->seek(input->length() - 8);
+        input->seek(input->readLong());
+        int32_t numFields = input->readVInt();
+        for (int32_t i = 0; i < numFields; ++i) {
+            int32_t number = input->readVInt();
+            uint8_t type = input->readByte();
+            int64_t pointer = input->readVLong();
+            FieldInfoPtr fi(fieldInfos->fieldInfo(number));
+            if (!fi || (uint8_t)fi->docValuesType != type) {
+                boost::throw_exception(CorruptIndexException(L"doc values of field " + StringUtils::toString(number) + L" do not match the field infos"));
+            }
+            pointers[number] = pointer;
+        }
+        success = true;
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    if (!success) {
+        close();
+    }
+    finally.throwException();
+}
+
+DocValuesReader::~DocValuesReader() {
+}
+
+DocValuesColumnPtr DocValuesReader::getColumn(const String& field) {
+    FieldInfoPtr fi(fieldInfos->fieldInfo(field));
+    if (!fi || fi->number >= pointers.size() || pointers[fi->number] == -1) {
+        return DocValuesColumnPtr();
+    }
+    SyncLock syncLock(this);
+    if (!input) {
+        boost::throw_exception(AlreadyClosedException(L"this DocValuesReader is closed"));
+    }
+    if (!columns[fi->number]) {
+        IndexInputPtr columnInput(std::dynamic_pointer_cast<IndexInput>(input->clone()));
+        columnInput->seek(pointers[fi->number]);
+        columns[fi->number] = newLucene<DocValuesColumn>(columnInput, fi->docValuesType, maxDoc);
+    }
+    return columns[fi->number];
+}
+
+int32_t DocValuesReader::getMaxDoc() {
+    return maxDoc;
+}
+
+void DocValuesReader::close() {
+    SyncLock syncLock(this);
+    if (input) {
+        input->close();
+        input.reset();
+    }
+    columns.reset();
+}
+
+}
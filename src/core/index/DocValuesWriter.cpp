@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocValuesWriter.h"
+#include "DocValuesWriterPerThread.h"
+#include "SegmentWriteState.h"
+#include "IndexFileNames.h"
+#include "IndexOutput.h"
+#include "Directory.h"
+#include "FieldInfo.h"
+#include "FieldInfos.h"
+#include "PackedLongs.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+const int32_t DocValuesWriter::FORMAT_CURRENT = -1;
+
+DocValuesWriter::DocValuesWriter(const FieldInfosPtr& fieldInfos) {
+    this->fieldInfos = fieldInfos;
+}
+
+DocValuesWriter::~DocValuesWriter() {
+}
+
+DocValuesWriterPerThreadPtr DocValuesWriter::addThread(const DocStatePtr& docState) {
+    return newLucene<DocValuesWriterPerThread>(docState);
+}
+
+void DocValuesWriter::flush(Collection<DocValuesWriterPerThreadPtr> threads, const SegmentWriteStatePtr& state) {
+    if (!fieldInfos->hasDocValues()) {
+        return;
+    }
+    String fileName(state->segmentFileName(IndexFileNames::DOC_VALUES_EXTENSION()));
+    IndexOutputPtr output(state->directory->createOutput(fileName));
+    LuceneException finally;
+    try {
+        writeHeader(output, state->numDocs);
+        Collection<FieldInfoPtr> fields(Collection<FieldInfoPtr>::newInstance());
+        Collection<int64_t> pointers(Collection<int64_t>::newInstance());
+        for (int32_t number = 0; number < fieldInfos->size(); ++number) {
+            FieldInfoPtr fi(fieldInfos->fieldInfo(number));
+            if (fi->docValuesType == Fieldable::DOC_VALUES_NONE) {
+                continue;
+            }
+            fields.add(fi);
+            pointers.add(output->getFilePointer());
+
+            // gather the values buffered by every thread into one value per document
+            bool numeric = (fi->docValuesType == Fieldable::DOC_VALUES_NUMERIC || fi->docValuesType == Fieldable::DOC_VALUES_DOUBLE);
+            Collection<int64_t> longs;
+            Collection<String> strings;
+            if (numeric) {
+                longs = Collection<int64_t>::newInstance(state->numDocs);
+            } else {
+                strings = Collection<String>::newInstance(state->numDocs);
+            }
+            for (Collection<DocValuesWriterPerThreadPtr>::iterator thread = threads.begin(); thread != threads.end(); ++thread) {
+                if (number >= (*thread)->docs.size() || !(*thread)->docs[number]) {
+                    continue;
+                }
+                Collection<int32_t> docs((*thread)->docs[number]);
+                for (int32_t i = 0; i < docs.size(); ++i) {
+                    if (numeric) {
+                        longs[docs[i]] = (*thread)->longs[number][i];
+                    } else {
+                        strings[docs[i]] = (*thread)->strings[number][i];
+                    }
+                }
+            }
+
+            if (numeric) {
+                writeNumeric(output, longs);
+            } else if (fi->docValuesType == Fieldable::DOC_VALUES_BINARY) {
+                writeBinary(output, strings);
+            } else {
+                writeSorted(output, strings);
+            }
+        }
+        writeDirectory(output, fields, pointers);
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    output->close();
+    finally.throwException();
+
+    for (Collection<DocValuesWriterPerThreadPtr>::iterator thread = threads.begin(); thread != threads.end(); ++thread) {
+        (*thread)->reset();
+    }
+    state->flushedFiles.add(fileName);
+}
+
+void DocValuesWriter::writeHeader(const IndexOutputPtr& output, int32_t maxDoc) {
+    output->writeInt(FORMAT_CURRENT);
+    output->writeVInt(maxDoc);
+}
+
+void DocValuesWriter::writeNumeric(const IndexOutputPtr& output, Collection<int64_t> values) {
+    PackedLongs::write(output, values.empty() ? NULL : &values[0], values.size());
+}
+
+void DocValuesWriter::writeBinary(const IndexOutputPtr& output, Collection<String> values) {
+    writeStrings(output, values.empty() ? NULL : &values[0], values.size());
+}
+
+void DocValuesWriter::writeSorted(const IndexOutputPtr& output, Collection<String> values) {
+    Collection<String> sorted(Collection<String>::newInstance());
+    for (Collection<String>::iterator value = values.begin(); value != values.end(); ++value) {
+        if (!value->empty()) {
+            sorted.add(*value);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    sorted.resize((int32_t)(std::unique(sorted.begin(), sorted.end()) - sorted.begin()));
+
+    output->writeVInt(sorted.size());
+    writeStrings(output, sorted.empty() ? NULL : &sorted[0], sorted.size());
+
+    Collection<int64_t> ords(Collection<int64_t>::newInstance(values.size()));
+    for (int32_t doc = 0; doc < values.size(); ++doc) {
+        if (!values[doc].empty()) {
+            ords[doc] = (int64_t)(std::lower_bound(sorted.begin(), sorted.end(), values[doc]) - sorted.begin()) + 1;
+        }
+    }
+    writeNumeric(output, ords);
+}
+
+void DocValuesWriter::writeStrings(const IndexOutputPtr& output, const String* values, int32_t count) {
+    Collection<int64_t> addresses(Collection<int64_t>::newInstance(count + 1));
+    Collection<SingleString> utf8(Collection<SingleString>::newInstance(count));
+    for (int32_t i = 0; i < count; ++i) {
+        utf8[i] = StringUtils::toUTF8(values[i]);
+        addresses[i + 1] = addresses[i] + (int64_t)utf8[i].length();
+    }
+    PackedLongs::write(output, &addresses[0], addresses.size());
+    for (int32_t i = 0; i < count; ++i) {
+        if (!utf8[i].empty()) {
+            output->writeBytes((const uint8_t*)utf8[i].c_str(), (int32_t)utf8[i].length());
+        }
+    }
+}
+
+void DocValuesWriter::writeDirectory(const IndexOutputPtr& output, Collection<FieldInfoPtr> fields, Collection<int64_t> pointers) {
+    int64_t directoryPointer = output->getFilePointer();
+    output->writeVInt(fields.size());
+    for (int32_t i = 0; i < fields.size(); ++i) {
+        output->writeVInt(fields[i]->number);
+        output->writeByte((uint8_t)fields[i]->docValuesType);
+        output->writeVLong(pointers[i]);
+    }
+    output->writeLong(directoryPointer);
+}
+
+}
@@ -0,0 +1,85 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocValuesWriterPerThread.h"
+#include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
+#include "FieldInfo.h"
+#include "NumericField.h"
+#include "NumericUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+DocValuesWriterPerThread::DocValuesWriterPerThread(const DocStatePtr& docState) {
+    this->docState = docState;
+    docs = Collection< Collection<int32_t> >::newInstance();
+    longs = Collection< Collection<int64_t> >::newInstance();
+    strings = Collection< Collection<String> >::newInstance();
+}
+
+DocValuesWriterPerThread::~DocValuesWriterPerThread() {
+}
+
+void DocValuesWriterPerThread::addField(const FieldablePtr& field, const FieldInfoPtr& fieldInfo) {
+    int32_t number = fieldInfo->number;
+    if (number >= docs.size()) {
+        docs.resize(number + 1);
+        longs.resize(number + 1);
+        strings.resize(number + 1);
+    }
+    if (!docs[number]) {
+        docs[number] = Collection<int32_t>::newInstance();
+    }
+    Collection<int32_t> fieldDocs(docs[number]);
+    if (!fieldDocs.empty() && fieldDocs[fieldDocs.size() - 1] == docState->docID) {
+        boost::throw_exception(IllegalArgumentException(L"field \"" + fieldInfo->name + L"\" has more than one doc value in a document"));
+    }
+
+    Fieldable::DocValuesType type = field->getDocValuesType();
+    int64_t numBytes = DocumentsWriter::INT_NUM_BYTE;
+    NumericFieldPtr numericField(std::dynamic_pointer_cast<NumericField>(field));
+    if (type == Fieldable::DOC_VALUES_NUMERIC || type == Fieldable::DOC_VALUES_DOUBLE) {
+        int64_t value;
+        if (type == Fieldable::DOC_VALUES_NUMERIC) {
+            value = numericField ? numericField->getNumericValue() : StringUtils::toLong(field->stringValue());
+        } else {
+            value = NumericUtils::doubleToSortableLong(numericField ? numericField->getDoubleValue() : StringUtils::toDouble(field->stringValue()));
+        }
+        if (!longs[number]) {
+            longs[number] = Collection<int64_t>::newInstance();
+        }
+        longs[number].add(value);
+        numBytes += sizeof(int64_t);
+    } else {
+        if (!strings[number]) {
+            strings[number] = Collection<String>::newInstance();
+        }
+        String value(field->stringValue());
+        strings[number].add(value);
+        numBytes += DocumentsWriter::OBJECT_HEADER_BYTES + DocumentsWriter::POINTER_NUM_BYTE + value.length() * sizeof(wchar_t);
+    }
+    fieldDocs.add(docState->docID);
+
+    // the buffered values count towards the RAM that triggers a flush
+    DocumentsWriterPerThreadPtr docWriter(docState->_docWriter.lock());
+    if (docWriter) {
+        docWriter->docValuesBytesUsed(numBytes);
+    }
+}
+
+void DocValuesWriterPerThread::reset() {
+    docs.clear();
+    longs.clear();
+    strings.clear();
+}
+
+void DocValuesWriterPerThread::abort() {
+    reset();
+}
+
+}
@@ -6,6 +6,7 @@
 
 #include "LuceneInc.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 #include "DocumentsWriterThreadState.h"
 #include "LuceneThread.h"
 #include "IndexWriter.h"
@@ -42,9 +43,6 @@
 
 namespace Lucene {
 
-/// Max # ThreadState instances; if there are more threads than this they share ThreadStates
-const int32_t DocumentsWriter::MAX_THREAD_STATE = 5;
-
 /// Coarse estimates used to measure RAM usage of buffered deletes
 const int32_t DocumentsWriter::OBJECT_HEADER_BYTES = 8;
 #ifdef LPP_BUILD_64
@@ -102,12 +100,8 @@ const int32_t DocumentsWriter::INT_BLOCK_MASK = DocumentsWriter::INT_BLOCK_SIZE
 const int32_t DocumentsWriter::PER_DOC_BLOCK_SIZE = 1024;
 
 DocumentsWriter::DocumentsWriter(const DirectoryPtr& directory,  const IndexWriterPtr& writer, const IndexingChainPtr& indexingChain) {
-    this->threadStates = Collection<DocumentsWriterThreadStatePtr>::newInstance();
-    this->threadBindings = MapThreadDocumentsWriterThreadState::newInstance();
-    this->_openFiles = HashSet<String>::newInstance();
-    this->_closedFiles = HashSet<String>::newInstance();
-    this->freeIntBlocks = Collection<IntArray>::newInstance();
-    this->freeCharBlocks = Collection<CharArray>::newInstance();
+    this->perThreads = Collection<DocumentsWriterPerThreadPtr>::newInstance();
+    this->threadBindings = MapThreadDocumentsWriterPerThread::newInstance();
 
     this->directory = directory;
     this->_writer = writer;
@@ -118,13 +112,9 @@ DocumentsWriter::~DocumentsWriter() {
 }
 
 void DocumentsWriter::initialize() {
-    docStoreOffset = 0;
-    nextDocID = 0;
-    numDocsInRAM = 0;
-    numDocsInStore = 0;
+    maxThreadStates = IndexWriter::DEFAULT_MAX_THREAD_STATES;
     pauseThreads = 0;
     flushPending = false;
-    bufferIsFull = false;
     aborting = false;
     maxFieldLength = IndexWriter::DEFAULT_MAX_FIELD_LENGTH;
     deletesInRAM = newLucene<BufferedDeletes>(false);
@@ -138,23 +128,10 @@ void DocumentsWriter::initialize() {
     maxBufferedDocs = IndexWriter::DEFAULT_MAX_BUFFERED_DOCS;
     flushedDocCount = 0;
     closed = false;
-    waitQueue = newLucene<WaitQueue>(shared_from_this());
-    skipDocWriter = newLucene<SkipDocWriter>();
-    numBytesAlloc = 0;
-    numBytesUsed = 0;
-    byteBlockAllocator = newLucene<ByteBlockAllocator>(shared_from_this(), BYTE_BLOCK_SIZE);
-    perDocAllocator = newLucene<ByteBlockAllocator>(shared_from_this(), PER_DOC_BLOCK_SIZE);
 
     IndexWriterPtr writer(_writer);
     this->similarity = writer->getSimilarity();
     flushedDocCount = writer->maxDoc();
-
-    consumer = indexingChain->getChain(shared_from_this());
-    docFieldProcessor = std::dynamic_pointer_cast<DocFieldProcessor>(consumer);
-}
-
-PerDocBufferPtr DocumentsWriter::newPerDocBuffer() {
-    return newLucene<PerDocBuffer>(shared_from_this());
 }
 
 IndexingChainPtr DocumentsWriter::getDefaultIndexingChain() {
@@ -181,31 +158,27 @@ void DocumentsWriter::setFlushedDocCount(int32_t n) {
     flushedDocCount = n;
 }
 
-bool DocumentsWriter::hasProx() {
-    return docFieldProcessor ? docFieldProcessor->fieldInfos->hasProx() : true;
-}
-
 void DocumentsWriter::setInfoStream(const InfoStreamPtr& infoStream) {
     SyncLock syncLock(this);
     this->infoStream = infoStream;
-    for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
-        (*threadState)->docState->infoStream = infoStream;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        (*perThread)->setInfoStream(infoStream);
     }
 }
 
 void DocumentsWriter::setMaxFieldLength(int32_t maxFieldLength) {
     SyncLock syncLock(this);
     this->maxFieldLength = maxFieldLength;
-    for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
-        (*threadState)->docState->maxFieldLength = maxFieldLength;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        (*perThread)->setMaxFieldLength(maxFieldLength);
     }
 }
 
 void DocumentsWriter::setSimilarity(const SimilarityPtr& similarity) {
     SyncLock syncLock(this);
     this->similarity = similarity;
-    for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
-        (*threadState)->docState->similarity = similarity;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        (*perThread)->setSimilarity(similarity);
     }
 }
 
@@ -241,56 +214,23 @@ int32_t DocumentsWriter::getMaxBufferedDocs() {
     return maxBufferedDocs;
 }
 
-String DocumentsWriter::getSegment() {
-    return segment;
-}
-
-int32_t DocumentsWriter::getNumDocsInRAM() {
-    return numDocsInRAM;
-}
-
-String DocumentsWriter::getDocStoreSegment() {
+void DocumentsWriter::setMaxThreadStates(int32_t maxThreadStates) {
     SyncLock syncLock(this);
-    return docStoreSegment;
+    this->maxThreadStates = maxThreadStates;
 }
 
-int32_t DocumentsWriter::getDocStoreOffset() {
-    return docStoreOffset;
+int32_t DocumentsWriter::getMaxThreadStates() {
+    SyncLock syncLock(this);
+    return maxThreadStates;
 }
 
-String DocumentsWriter::closeDocStore() {
-    TestScope testScope(L"DocumentsWriter", L"closeDocStore");
+int32_t DocumentsWriter::getNumDocsInRAM() {
     SyncLock syncLock(this);
-    BOOST_ASSERT(allThreadsIdle());
-
-    if (infoStream) {
-        message(L"closeDocStore: " + StringUtils::toString(_openFiles.size()) + L" files to flush to segment " +
-                docStoreSegment + L" numDocs=" + StringUtils::toString(numDocsInStore));
+    int32_t numDocs = 0;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        numDocs += (*perThread)->getNumDocsInRAM();
     }
-
-    bool success = false;
-    LuceneException finally;
-    String s;
-    try {
-        initFlushState(true);
-        _closedFiles.clear();
-
-        consumer->closeDocStore(flushState);
-        BOOST_ASSERT(_openFiles.empty());
-
-        s = docStoreSegment;
-        docStoreSegment.clear();
-        docStoreOffset = 0;
-        numDocsInStore = 0;
-        success = true;
-    } catch (LuceneException& e) {
-        finally = e;
-    }
-    if (!success) {
-        abort();
-    }
-    finally.throwException();
-    return s;
+    return numDocs;
 }
 
 HashSet<String> DocumentsWriter::abortedFiles() {
@@ -305,30 +245,12 @@ void DocumentsWriter::message(const String& message) {
 
 HashSet<String> DocumentsWriter::openFiles() {
     SyncLock syncLock(this);
-    return HashSet<String>::newInstance(_openFiles.begin(), _openFiles.end());
-}
-
-HashSet<String> DocumentsWriter::closedFiles() {
-    SyncLock syncLock(this);
-    return HashSet<String>::newInstance(_closedFiles.begin(), _closedFiles.end());
-}
-
-void DocumentsWriter::addOpenFile(const String& name) {
-    SyncLock syncLock(this);
-    BOOST_ASSERT(!_openFiles.contains(name));
-    _openFiles.add(name);
-}
-
-void DocumentsWriter::removeOpenFile(const String& name) {
-    SyncLock syncLock(this);
-    BOOST_ASSERT(_openFiles.contains(name));
-    _openFiles.remove(name);
-    _closedFiles.add(name);
-}
-
-void DocumentsWriter::setAborting() {
-    SyncLock syncLock(this);
-    aborting = true;
+    HashSet<String> files(HashSet<String>::newInstance());
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        HashSet<String> perThreadFiles((*perThread)->openFiles());
+        files.addAll(perThreadFiles.begin(), perThreadFiles.end());
+    }
+    return files;
 }
 
 void DocumentsWriter::abort() {
@@ -340,45 +262,28 @@ void DocumentsWriter::abort() {
             message(L"docWriter: now abort");
         }
 
-        // Forcefully remove waiting ThreadStates from line
-        waitQueue->abort();
+        aborting = true;
 
         // Wait for all other threads to finish with DocumentsWriter
         pauseAllThreads();
 
         try {
-            BOOST_ASSERT(waitQueue->numWaiting == 0);
-
-            waitQueue->waitingBytes = 0;
-
-            try {
-                _abortedFiles = openFiles();
-            } catch (...) {
-                _abortedFiles.reset();
-            }
-
-            deletesInRAM->clear();
-            deletesFlushed->clear();
-            _openFiles.clear();
-
-            for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
+            HashSet<String> files(HashSet<String>::newInstance());
+            for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
                 try {
-                    (*threadState)->consumer->abort();
+                    (*perThread)->abort();
                 } catch (...) {
                 }
+                HashSet<String> perThreadFiles((*perThread)->abortedFiles());
+                if (perThreadFiles) {
+                    files.addAll(perThreadFiles.begin(), perThreadFiles.end());
+                }
             }
+            _abortedFiles = files;
 
-            try {
-                consumer->abort();
-            } catch (...) {
-            }
-
-            docStoreSegment.clear();
-            numDocsInStore = 0;
-            docStoreOffset = 0;
-
-            // Reset all postings data
-            doAfterFlush();
+            deletesInRAM->clear();
+            deletesFlushed->clear();
+            threadBindings.clear();
         } catch (LuceneException& e) {
             finally = e;
         }
@@ -396,22 +301,6 @@ void DocumentsWriter::abort() {
     finally.throwException();
 }
 
-void DocumentsWriter::doAfterFlush() {
-    // All ThreadStates should be idle when we are called
-    BOOST_ASSERT(allThreadsIdle());
-    threadBindings.clear();
-    waitQueue->reset();
-    segment.clear();
-    numDocsInRAM = 0;
-    nextDocID = 0;
-    bufferIsFull = false;
-    flushPending = false;
-    for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
-        (*threadState)->doAfterFlush();
-    }
-    numBytesUsed = 0;
-}
-
 bool DocumentsWriter::pauseAllThreads() {
     SyncLock syncLock(this);
     ++pauseThreads;
@@ -432,8 +321,8 @@ void DocumentsWriter::resumeAllThreads() {
 
 bool DocumentsWriter::allThreadsIdle() {
     SyncLock syncLock(this);
-    for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
-        if (!(*threadState)->isIdle) {
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        if (!(*perThread)->isIdle) {
             return false;
         }
     }
@@ -442,107 +331,89 @@ bool DocumentsWriter::allThreadsIdle() {
 
 bool DocumentsWriter::anyChanges() {
     SyncLock syncLock(this);
-    return (numDocsInRAM != 0 || deletesInRAM->numTerms != 0 || !deletesInRAM->docIDs.empty() || !deletesInRAM->queries.empty());
+    if (deletesInRAM->any()) {
+        return true;
+    }
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        if ((*perThread)->anyChanges()) {
+            return true;
+        }
+    }
+    return false;
 }
 
-void DocumentsWriter::initFlushState(bool onlyDocStore) {
+bool DocumentsWriter::setFlushPending() {
     SyncLock syncLock(this);
-    initSegmentName(onlyDocStore);
-    flushState = newLucene<SegmentWriteState>(shared_from_this(), directory, segment, docStoreSegment, numDocsInRAM, numDocsInStore, IndexWriterPtr(_writer)->getTermIndexInterval());
+    if (flushPending) {
+        return false;
+    } else {
+        flushPending = true;
+        return true;
+    }
 }
 
-int32_t DocumentsWriter::flush(bool _closeDocStore) {
+void DocumentsWriter::clearFlushPending() {
     SyncLock syncLock(this);
-    BOOST_ASSERT(allThreadsIdle());
-
-    BOOST_ASSERT(numDocsInRAM > 0);
-
-    BOOST_ASSERT(nextDocID == numDocsInRAM);
-    BOOST_ASSERT(waitQueue->numWaiting == 0);
-    BOOST_ASSERT(waitQueue->waitingBytes == 0);
-
-    initFlushState(false);
-
-    docStoreOffset = numDocsInStore;
-
-    if (infoStream) {
-        message(L"flush postings as segment " + flushState->segmentName + L" numDocs=" + StringUtils::toString(numDocsInRAM));
-    }
-
-    bool success = false;
-    LuceneException finally;
-
-    try {
-        if (_closeDocStore) {
-            BOOST_ASSERT(!flushState->docStoreSegmentName.empty());
-            BOOST_ASSERT(flushState->docStoreSegmentName == flushState->segmentName);
-
-            closeDocStore();
-            flushState->numDocsInStore = 0;
-        }
+    flushPending = false;
+    notifyAll();
+}
 
-        Collection<DocConsumerPerThreadPtr> threads(Collection<DocConsumerPerThreadPtr>::newInstance());
-        for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
-            threads.add((*threadState)->consumer);
-        }
-        consumer->flush(threads, flushState);
+bool DocumentsWriter::isFlushPending() {
+    SyncLock syncLock(this);
+    return flushPending;
+}
 
-        if (infoStream) {
-            SegmentInfoPtr si(newLucene<SegmentInfo>(flushState->segmentName, flushState->numDocs, directory));
-            int64_t newSegmentSize = si->sizeInBytes();
-            if (infoStream) {
-                message(L"  oldRAMSize=" + StringUtils::toString(numBytesUsed) + L" newFlushedSize=" +
-                        StringUtils::toString(newSegmentSize) + L" docs/MB=" +
-                        StringUtils::toString((double)numDocsInRAM / ((double)newSegmentSize / 1024.0 / 1024.0)) +
-                        L" new/old=" + StringUtils::toString(100.0 * (double)newSegmentSize / (double)numBytesUsed) + L"%");
+DocumentsWriterPerThreadPtr DocumentsWriter::checkoutFlushPending(bool flushAll) {
+    SyncLock syncLock(this);
+    while (true) {
+        DocumentsWriterPerThreadPtr busy;
+        for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+            if ((flushAll || (*perThread)->flushPending) && (*perThread)->getNumDocsInRAM() > 0) {
+                if ((*perThread)->isIdle) {
+                    (*perThread)->flushPending = true;
+                    (*perThread)->isIdle = false;
+                    return *perThread;
+                }
+                busy = *perThread;
             }
         }
-
-        flushedDocCount += flushState->numDocs;
-
-        doAfterFlush();
-
-        success = true;
-    } catch (LuceneException& e) {
-        finally = e;
-    }
-    if (!success) {
-        abort();
+        if (!busy || closed) {
+            return DocumentsWriterPerThreadPtr();
+        }
+        // The thread adding the last document to this instance will idle it shortly
+        wait(1000);
     }
-    finally.throwException();
-
-    BOOST_ASSERT(waitQueue->waitingBytes == 0);
-
-    return flushState->numDocs;
 }
 
-HashSet<String> DocumentsWriter::getFlushedFiles() {
-    return flushState->flushedFiles;
-}
-
-void DocumentsWriter::createCompoundFile(const String& segment) {
-    CompoundFileWriterPtr cfsWriter(newLucene<CompoundFileWriter>(directory, segment + L"." + IndexFileNames::COMPOUND_FILE_EXTENSION()));
-    for (HashSet<String>::iterator flushedFile = flushState->flushedFiles.begin(); flushedFile != flushState->flushedFiles.end(); ++flushedFile) {
-        cfsWriter->addFile(*flushedFile);
+BufferedDeletesPtr DocumentsWriter::finishFlush(const DocumentsWriterPerThreadPtr& perThread) {
+    SyncLock syncLock(this);
+    BOOST_ASSERT(!perThread->isIdle);
+    flushedDocCount += perThread->getNumDocsInRAM();
+    BufferedDeletesPtr deletes(perThread->deletesInRAM);
+    perThread->deletesInRAM = newLucene<BufferedDeletes>(true);
+    perThread->doAfterFlush();
+
+    // Threads bound to this instance pick again once it is back in the pool
+    for (MapThreadDocumentsWriterPerThread::iterator binding = threadBindings.begin(); binding != threadBindings.end();) {
+        if (binding->second == perThread) {
+            threadBindings.remove(binding++);
+        } else {
+            ++binding;
+        }
     }
+    perThread->numThreads = 0;
 
-    // Perform the merge
-    cfsWriter->close();
+    return deletes;
 }
 
-bool DocumentsWriter::setFlushPending() {
+void DocumentsWriter::checkin(const DocumentsWriterPerThreadPtr& perThread) {
     SyncLock syncLock(this);
-    if (flushPending) {
-        return false;
-    } else {
-        flushPending = true;
-        return true;
+    if (perThread->getNumDocsInRAM() == 0) {
+        // A failed flush aborts the instance, which discards its documents
+        perThread->flushPending = false;
     }
-}
-
-void DocumentsWriter::clearFlushPending() {
-    SyncLock syncLock(this);
-    flushPending = false;
+    perThread->isIdle = true;
+    notifyAll();
 }
 
 void DocumentsWriter::pushDeletes() {
@@ -556,87 +427,59 @@ void DocumentsWriter::close() {
     notifyAll();
 }
 
-void DocumentsWriter::initSegmentName(bool onlyDocStore) {
+DocumentsWriterPerThreadPtr DocumentsWriter::getThreadState(const TermPtr& delTerm) {
     SyncLock syncLock(this);
-    if (segment.empty() && (!onlyDocStore || docStoreSegment.empty())) {
-        segment = IndexWriterPtr(_writer)->newSegmentName();
-        BOOST_ASSERT(numDocsInRAM == 0);
+    // First, find an instance.  If this thread already has affinity to a specific instance that is not about
+    // to be flushed, use that one again.
+    DocumentsWriterPerThreadPtr state(threadBindings.get(LuceneThread::currentId()));
+    if (state && state->flushPending) {
+        --state->numThreads;
+        threadBindings.remove(LuceneThread::currentId());
+        state.reset();
     }
-    if (docStoreSegment.empty()) {
-        docStoreSegment = segment;
-        BOOST_ASSERT(numDocsInStore == 0);
-    }
-}
-
-DocumentsWriterThreadStatePtr DocumentsWriter::getThreadState(const DocumentPtr& doc, const TermPtr& delTerm) {
-    SyncLock syncLock(this);
-    // First, find a thread state.  If this thread already has affinity to a specific ThreadState, use that one again.
-    DocumentsWriterThreadStatePtr state(threadBindings.get(LuceneThread::currentId()));
     if (!state) {
-        // First time this thread has called us since last flush.  Find the least loaded thread state
-        DocumentsWriterThreadStatePtr minThreadState;
-        for (Collection<DocumentsWriterThreadStatePtr>::iterator threadState = threadStates.begin(); threadState != threadStates.end(); ++threadState) {
-            if (!minThreadState || (*threadState)->numThreads < minThreadState->numThreads) {
-                minThreadState = *threadState;
+        // Find the least loaded instance that is not flush pending
+        DocumentsWriterPerThreadPtr minPerThread;
+        DocumentsWriterPerThreadPtr minPendingPerThread;
+        for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+            DocumentsWriterPerThreadPtr& candidate = (*perThread)->flushPending ? minPendingPerThread : minPerThread;
+            if (!candidate || (*perThread)->numThreads < candidate->numThreads) {
+                candidate = *perThread;
             }
         }
-        if (minThreadState && (minThreadState->numThreads == 0 || threadStates.size() >= MAX_THREAD_STATE)) {
-            state = minThreadState;
-            ++state->numThreads;
+        if (minPerThread && (minPerThread->numThreads == 0 || perThreads.size() >= maxThreadStates)) {
+            state = minPerThread;
+        } else if (perThreads.size() < maxThreadStates || !minPendingPerThread) {
+            // Just create a new "private" instance
+            state = newLucene<DocumentsWriterPerThread>(shared_from_this());
+            state->numThreads = 0;
+            perThreads.add(state);
         } else {
-            // Just create a new "private" thread state
-            threadStates.resize(threadStates.size() + 1);
-            state = newLucene<DocumentsWriterThreadState>(shared_from_this());
-            threadStates[threadStates.size() - 1] = state;
+            // Every instance is being flushed; wait for one
+            state = minPendingPerThread;
         }
+        ++state->numThreads;
         threadBindings.put(LuceneThread::currentId(), state);
     }
 
-    // Next, wait until my thread state is idle (in case it's shared with other threads) and for threads to
-    // not be paused nor a flush pending
+    // Next, wait until my instance is idle (in case it's shared with other threads) and for threads to not be
+    // paused nor a flush pending
     waitReady(state);
 
-    // Allocate segment name if this is the first doc since last flush
-    initSegmentName(false);
-
     state->isIdle = false;
 
     bool success = false;
     LuceneException finally;
     try {
-        state->docState->docID = nextDocID;
-
-        BOOST_ASSERT(IndexWriterPtr(_writer)->testPoint(L"DocumentsWriter.ThreadState.init start"));
-
-        if (delTerm) {
-            addDeleteTerm(delTerm, state->docState->docID);
-            state->doFlushAfter = timeToFlushDeletes();
-        }
-
-        BOOST_ASSERT(IndexWriterPtr(_writer)->testPoint(L"DocumentsWriter.ThreadState.init after delTerm"));
-
-        ++nextDocID;
-        ++numDocsInRAM;
-
-        // We must at this point commit to flushing to ensure we always get N docs when we flush by doc
-        // count, even if > 1 thread is adding documents
-        if (!flushPending && maxBufferedDocs != IndexWriter::DISABLE_AUTO_FLUSH && numDocsInRAM >= maxBufferedDocs) {
-            flushPending = true;
-            state->doFlushAfter = true;
-        }
-
+        state->startDocument(delTerm);
         success = true;
     } catch (LuceneException& e) {
         finally = e;
     }
     if (!success) {
-        // Forcefully idle this ThreadState
+        // Forcefully idle this instance
         state->isIdle = true;
         notifyAll();
-        if (state->doFlushAfter) {
-            state->doFlushAfter = false;
-            flushPending = false;
-        }
     }
     finally.throwException();
 
@@ -653,73 +496,46 @@ bool DocumentsWriter::updateDocument(const TermPtr& t, const DocumentPtr& doc, c
 
 bool DocumentsWriter::updateDocument(const DocumentPtr& doc, const AnalyzerPtr& analyzer, const TermPtr& delTerm) {
     // This call is synchronized but fast
-    DocumentsWriterThreadStatePtr state(getThreadState(doc, delTerm));
-
-    DocStatePtr docState(state->docState);
-    docState->doc = doc;
-    docState->analyzer = analyzer;
+    DocumentsWriterPerThreadPtr perThread(getThreadState(delTerm));
 
     bool success = false;
     LuceneException finally;
     try {
         // This call is not synchronized and does all the work
-        DocWriterPtr perDoc;
-        try {
-            perDoc = state->consumer->processDocument();
-        } catch (LuceneException& e) {
-            finally = e;
-        }
-        docState->clear();
-        finally.throwException();
-
-        // This call is synchronized but fast
-        finishDocument(state, perDoc);
-
+        perThread->processDocument(doc, analyzer);
         success = true;
     } catch (LuceneException& e) {
         finally = e;
     }
-    if (!success) {
-        SyncLock syncLock(this);
-        if (aborting) {
-            state->isIdle = true;
-            notifyAll();
-            abort();
-        } else {
-            skipDocWriter->docID = docState->docID;
-            bool success2 = false;
-            try {
-                waitQueue->add(skipDocWriter);
-                success2 = true;
-            } catch (LuceneException& e) {
-                finally = e;
-            }
-            if (!success2) {
-                state->isIdle = true;
-                notifyAll();
-                abort();
-                return false;
-            }
 
-            state->isIdle = true;
-            notifyAll();
-
-            // If this thread state had decided to flush, we must clear it so another thread can flush
-            if (state->doFlushAfter) {
-                state->doFlushAfter = false;
-                flushPending = false;
-                notifyAll();
-            }
+    if (success && doBalanceRAM()) {
+        // Must call this without holding synchronized(this) else we'll hit deadlock
+        balanceRAM();
+    }
 
-            // Immediately mark this document as deleted since likely it was partially added.  This keeps
-            // indexing as "all or none" (atomic) when adding a document
-            addDeleteDocID(state->docState->docID);
+    SyncLock syncLock(this);
+    bool doFlush = false;
+    if (!success) {
+        if (!perThread->discardDocument()) {
+            _abortedFiles = perThread->abortedFiles();
+        }
+    } else {
+        // We must at this point commit to flushing to ensure we always get N docs when we flush by doc
+        // count, even if > 1 thread is adding documents
+        if (!perThread->flushPending && maxBufferedDocs != IndexWriter::DISABLE_AUTO_FLUSH && perThread->getNumDocsInRAM() >= maxBufferedDocs) {
+            perThread->flushPending = true;
+            doFlush = true;
+        }
+        if (setFlushPendingByRAM()) {
+            doFlush = true;
         }
     }
+    perThread->isIdle = true;
+    notifyAll();
 
     finally.throwException();
 
-    return (state->doFlushAfter || timeToFlushDeletes());
+    return (doFlush || (delTerm && timeToFlushDeletes()));
 }
 
 int32_t DocumentsWriter::getNumBufferedDeleteTerms() {
@@ -744,9 +560,9 @@ void DocumentsWriter::remapDeletes(const SegmentInfosPtr& infos, Collection< Col
     flushedDocCount -= mapper->docShift;
 }
 
-void DocumentsWriter::waitReady(const DocumentsWriterThreadStatePtr& state) {
+void DocumentsWriter::waitReady(const DocumentsWriterPerThreadPtr& perThread) {
     SyncLock syncLock(this);
-    while (!closed && ((state && !state->isIdle) || pauseThreads != 0 || flushPending || aborting)) {
+    while (!closed && ((perThread && (!perThread->isIdle || perThread->flushPending)) || pauseThreads != 0 || flushPending || aborting)) {
         wait(1000);
     }
     if (closed) {
@@ -756,50 +572,50 @@ void DocumentsWriter::waitReady(const DocumentsWriterThreadStatePtr& state) {
 
 bool DocumentsWriter::bufferDeleteTerms(Collection<TermPtr> terms) {
     SyncLock syncLock(this);
-    waitReady(DocumentsWriterThreadStatePtr());
+    waitReady(DocumentsWriterPerThreadPtr());
     for (Collection<TermPtr>::iterator term = terms.begin(); term != terms.end(); ++term) {
-        addDeleteTerm(*term, numDocsInRAM);
+        addDeleteTerm(*term);
     }
     return timeToFlushDeletes();
 }
 
 bool DocumentsWriter::bufferDeleteTerm(const TermPtr& term) {
     SyncLock syncLock(this);
-    waitReady(DocumentsWriterThreadStatePtr());
-    addDeleteTerm(term, numDocsInRAM);
+    waitReady(DocumentsWriterPerThreadPtr());
+    addDeleteTerm(term);
     return timeToFlushDeletes();
 }
 
 bool DocumentsWriter::bufferDeleteQueries(Collection<QueryPtr> queries) {
     SyncLock syncLock(this);
-    waitReady(DocumentsWriterThreadStatePtr());
+    waitReady(DocumentsWriterPerThreadPtr());
     for (Collection<QueryPtr>::iterator query = queries.begin(); query != queries.end(); ++query) {
-        addDeleteQuery(*query, numDocsInRAM);
+        addDeleteQuery(*query);
     }
     return timeToFlushDeletes();
 }
 
 bool DocumentsWriter::bufferDeleteQuery(const QueryPtr& query) {
     SyncLock syncLock(this);
-    waitReady(DocumentsWriterThreadStatePtr());
-    addDeleteQuery(query, numDocsInRAM);
+    waitReady(DocumentsWriterPerThreadPtr());
+    addDeleteQuery(query);
     return timeToFlushDeletes();
 }
 
 bool DocumentsWriter::deletesFull() {
     SyncLock syncLock(this);
     return ((ramBufferSize != IndexWriter::DISABLE_AUTO_FLUSH &&
-             (deletesInRAM->bytesUsed + deletesFlushed->bytesUsed + numBytesUsed) >= ramBufferSize) ||
+             (deletesInRAM->bytesUsed + deletesFlushed->bytesUsed) >= ramBufferSize) ||
             (maxBufferedDeleteTerms != IndexWriter::DISABLE_AUTO_FLUSH &&
              ((deletesInRAM->size() + deletesFlushed->size()) >= maxBufferedDeleteTerms)));
 }
 
 bool DocumentsWriter::doApplyDeletes() {
     SyncLock syncLock(this);
-    // Very similar to deletesFull(), except we don't count numBytesAlloc, because we are checking whether
-    // deletes (alone) are consuming too many resources now and thus should be applied.  We apply deletes
-    // if RAM usage is > 1/2 of our allowed RAM buffer, to prevent too-frequent flushing of a long tail of
-    // tiny segments when merges (which always apply deletes) are infrequent.
+    // Very similar to deletesFull(), except we are checking whether deletes (alone) are consuming too many
+    // resources now and thus should be applied.  We apply deletes if RAM usage is > 1/2 of our allowed RAM
+    // buffer, to prevent too-frequent flushing of a long tail of tiny segments when merges (which always
+    // apply deletes) are infrequent.
     return ((ramBufferSize != IndexWriter::DISABLE_AUTO_FLUSH &&
              (deletesInRAM->bytesUsed + deletesFlushed->bytesUsed) >= ramBufferSize / 2) ||
             (maxBufferedDeleteTerms != IndexWriter::DISABLE_AUTO_FLUSH &&
@@ -808,7 +624,33 @@ bool DocumentsWriter::doApplyDeletes() {
 
 bool DocumentsWriter::timeToFlushDeletes() {
     SyncLock syncLock(this);
-    return ((bufferIsFull || deletesFull()) && setFlushPending());
+    return (deletesFull() && setFlushPending());
+}
+
+bool DocumentsWriter::setFlushPendingByRAM() {
+    SyncLock syncLock(this);
+    if (ramBufferSize == IndexWriter::DISABLE_AUTO_FLUSH) {
+        return false;
+    }
+    int64_t activeBytes = deletesInRAM->bytesUsed + deletesFlushed->bytesUsed;
+    DocumentsWriterPerThreadPtr largest;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        if (!(*perThread)->flushPending) {
+            activeBytes += (*perThread)->getRAMUsed();
+            if ((*perThread)->getNumDocsInRAM() > 0 && (!largest || (*perThread)->getRAMUsed() > largest->getRAMUsed())) {
+                largest = *perThread;
+            }
+        }
+    }
+    if (!largest || activeBytes < ramBufferSize) {
+        return false;
+    }
+    if (infoStream) {
+        message(L"  RAM: now flush segment " + largest->getSegment() + L" @ usedMB=" + toMB(largest->getRAMUsed()) +
+                L" activeMB=" + toMB(activeBytes) + L" triggerMB=" + toMB(ramBufferSize));
+    }
+    largest->flushPending = true;
+    return true;
 }
 
 bool DocumentsWriter::checkDeleteTerm(const TermPtr& term) {
@@ -858,7 +700,7 @@ bool DocumentsWriter::applyDeletes(const SegmentInfosPtr& infos) {
         SegmentReaderPtr reader(writer->readerPool->get(infos->info(i), false));
         LuceneException finally;
         try {
-            if (applyDeletes(reader, docStart)) {
+            if (applyDeletes(deletesFlushed, reader, docStart)) {
                 any = true;
             }
             docStart += reader->maxDoc();
@@ -874,8 +716,32 @@ bool DocumentsWriter::applyDeletes(const SegmentInfosPtr& infos) {
     return any;
 }
 
-bool DocumentsWriter::applyDeletes(const IndexReaderPtr& reader, int32_t docIDStart) {
-    SyncLock syncLock(this);
+bool DocumentsWriter::applyDeletes(const BufferedDeletesPtr& deletes, const SegmentInfoPtr& info) {
+    if (!deletes->any()) {
+        return false;
+    }
+
+    if (infoStream) {
+        message(L"apply " + StringUtils::toString(deletes->numTerms) + L" buffered deleted terms and " +
+                StringUtils::toString(deletes->docIDs.size()) + L" deleted docIDs and " +
+                StringUtils::toString(deletes->queries.size()) + L" deleted queries on new segment " + info->name);
+    }
+
+    IndexWriterPtr writer(_writer);
+    SegmentReaderPtr reader(writer->readerPool->get(info, false));
+    bool any = false;
+    LuceneException finally;
+    try {
+        any = applyDeletes(deletes, reader, 0);
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    writer->readerPool->release(reader);
+    finally.throwException();
+    return any;
+}
+
+bool DocumentsWriter::applyDeletes(const BufferedDeletesPtr& deletes, const IndexReaderPtr& reader, int32_t docIDStart) {
     int32_t docEnd = docIDStart + reader->maxDoc();
     bool any = false;
 
@@ -885,7 +751,7 @@ bool DocumentsWriter::applyDeletes(const IndexReaderPtr& reader, int32_t docIDSt
     TermDocsPtr docs(reader->termDocs());
     LuceneException finally;
     try {
-        for (MapTermNum::iterator entry = deletesFlushed->terms.begin(); entry != deletesFlushed->terms.end(); ++entry) {
+        for (MapTermNum::iterator entry = deletes->terms.begin(); entry != deletes->terms.end(); ++entry) {
             // we should be iterating a Map here, so terms better be in order
             BOOST_ASSERT(checkDeleteTerm(entry->first));
             docs->seek(entry->first);
@@ -906,7 +772,7 @@ bool DocumentsWriter::applyDeletes(const IndexReaderPtr& reader, int32_t docIDSt
     finally.throwException();
 
     // Delete by docID
-    for (Collection<int32_t>::iterator docID = deletesFlushed->docIDs.begin(); docID != deletesFlushed->docIDs.end(); ++docID) {
+    for (Collection<int32_t>::iterator docID = deletes->docIDs.begin(); docID != deletes->docIDs.end(); ++docID) {
         if (*docID >= docIDStart && *docID < docEnd) {
             reader->deleteDocument(*docID - docIDStart);
             any = true;
@@ -915,7 +781,7 @@ bool DocumentsWriter::applyDeletes(const IndexReaderPtr& reader, int32_t docIDSt
 
     // Delete by query
     IndexSearcherPtr searcher(newLucene<IndexSearcher>(reader));
-    for (MapQueryInt::iterator entry = deletesFlushed->queries.begin(); entry != deletesFlushed->queries.end(); ++entry) {
+    for (MapQueryInt::iterator entry = deletes->queries.begin(); entry != deletes->queries.end(); ++entry) {
         WeightPtr weight(entry->first->weight(searcher));
         ScorerPtr scorer(weight->scorer(reader, true, false));
         if (scorer) {
@@ -933,160 +799,52 @@ bool DocumentsWriter::applyDeletes(const IndexReaderPtr& reader, int32_t docIDSt
     return any;
 }
 
-void DocumentsWriter::addDeleteTerm(const TermPtr& term, int32_t docCount) {
+void DocumentsWriter::addDeleteTerm(const TermPtr& term) {
     SyncLock syncLock(this);
     NumPtr num(deletesInRAM->terms.get(term));
-    int32_t docIDUpto = flushedDocCount + docCount;
     if (!num) {
-        deletesInRAM->terms.put(term, newLucene<Num>(docIDUpto));
+        deletesInRAM->terms.put(term, newLucene<Num>(flushedDocCount));
     } else {
-        num->setNum(docIDUpto);
+        num->setNum(flushedDocCount);
     }
     ++deletesInRAM->numTerms;
 
     deletesInRAM->addBytesUsed(BYTES_PER_DEL_TERM + term->_text.length() * CHAR_NUM_BYTE);
-}
 
-void DocumentsWriter::addDeleteDocID(int32_t docID) {
-    SyncLock syncLock(this);
-    deletesInRAM->docIDs.add(flushedDocCount + docID);
-    deletesInRAM->addBytesUsed(BYTES_PER_DEL_DOCID);
-}
-
-void DocumentsWriter::addDeleteQuery(const QueryPtr& query, int32_t docID) {
-    SyncLock syncLock(this);
-    deletesInRAM->queries.put(query, flushedDocCount + docID);
-    deletesInRAM->addBytesUsed(BYTES_PER_DEL_QUERY);
-}
-
-bool DocumentsWriter::doBalanceRAM() {
-    SyncLock syncLock(this);
-    return (ramBufferSize != IndexWriter::DISABLE_AUTO_FLUSH && !bufferIsFull &&
-            (numBytesUsed + deletesInRAM->bytesUsed + deletesFlushed->bytesUsed >= ramBufferSize ||
-             numBytesAlloc >= freeTrigger));
-}
-
-void DocumentsWriter::finishDocument(const DocumentsWriterThreadStatePtr& perThread, const DocWriterPtr& docWriter) {
-    if (doBalanceRAM()) {
-        // Must call this without holding synchronized(this) else we'll hit deadlock
-        balanceRAM();
-    }
-
-    {
-        SyncLock syncLock(this);
-        BOOST_ASSERT(!docWriter || docWriter->docID == perThread->docState->docID);
-
-        if (aborting) {
-            // We are currently aborting, and another thread is waiting for me to become idle.  We
-            // just forcefully idle this threadState; it will be fully reset by abort()
-            if (docWriter) {
-                try {
-                    docWriter->abort();
-                } catch (...) {
-                }
-            }
-
-            perThread->isIdle = true;
-            notifyAll();
-            return;
-        }
-
-        bool doPause;
-
-        if (docWriter) {
-            doPause = waitQueue->add(docWriter);
-        } else {
-            skipDocWriter->docID = perThread->docState->docID;
-            doPause = waitQueue->add(skipDocWriter);
-        }
-
-        if (doPause) {
-            waitForWaitQueue();
-        }
-
-        if (bufferIsFull && !flushPending) {
-            flushPending = true;
-            perThread->doFlushAfter = true;
-        }
-
-        perThread->isIdle = true;
-        notifyAll();
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        (*perThread)->addDeleteTerm(term);
     }
 }
 
-void DocumentsWriter::waitForWaitQueue() {
+void DocumentsWriter::addDeleteQuery(const QueryPtr& query) {
     SyncLock syncLock(this);
-    do {
-        wait(1000);
-    } while (!waitQueue->doResume());
-}
-
-int64_t DocumentsWriter::getRAMUsed() {
-    return numBytesUsed + deletesInRAM->bytesUsed + deletesFlushed->bytesUsed;
-}
+    deletesInRAM->queries.put(query, flushedDocCount);
+    deletesInRAM->addBytesUsed(BYTES_PER_DEL_QUERY);
 
-IntArray DocumentsWriter::getIntBlock(bool trackAllocations) {
-    SyncLock syncLock(this);
-    int32_t size = freeIntBlocks.size();
-    IntArray b;
-    if (size == 0) {
-        // Always record a block allocated, even if trackAllocations is false.  This is necessary because
-        // this block will be shared between things that don't track allocations (term vectors) and things
-        // that do (freq/prox postings).
-        numBytesAlloc += INT_BLOCK_SIZE * INT_NUM_BYTE;
-        b = IntArray::newInstance(INT_BLOCK_SIZE);
-    } else {
-        b = freeIntBlocks.removeLast();
-    }
-    if (trackAllocations) {
-        numBytesUsed += INT_BLOCK_SIZE * INT_NUM_BYTE;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        (*perThread)->addDeleteQuery(query);
     }
-    BOOST_ASSERT(numBytesUsed <= numBytesAlloc);
-    return b;
-}
-
-void DocumentsWriter::bytesAllocated(int64_t numBytes) {
-    SyncLock syncLock(this);
-    numBytesAlloc += numBytes;
-}
-
-void DocumentsWriter::bytesUsed(int64_t numBytes) {
-    SyncLock syncLock(this);
-    numBytesUsed += numBytes;
-    BOOST_ASSERT(numBytesUsed <= numBytesAlloc);
 }
 
-void DocumentsWriter::recycleIntBlocks(Collection<IntArray> blocks, int32_t start, int32_t end) {
+bool DocumentsWriter::doBalanceRAM() {
     SyncLock syncLock(this);
-    for (int32_t i = start; i < end; ++i) {
-        freeIntBlocks.add(blocks[i]);
-        blocks[i].reset();
+    if (ramBufferSize == IndexWriter::DISABLE_AUTO_FLUSH) {
+        return false;
     }
-}
-
-CharArray DocumentsWriter::getCharBlock() {
-    SyncLock syncLock(this);
-    int32_t size = freeCharBlocks.size();
-    CharArray c;
-    if (size == 0) {
-        numBytesAlloc += CHAR_BLOCK_SIZE * CHAR_NUM_BYTE;
-        c = CharArray::newInstance(CHAR_BLOCK_SIZE);
-    } else {
-        c = freeCharBlocks.removeLast();
+    int64_t bytesAlloc = deletesInRAM->bytesUsed + deletesFlushed->bytesUsed;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        bytesAlloc += (*perThread)->getRAMAllocated();
     }
-    // We always track allocations of char blocks for now because nothing that skips allocation tracking
-    // (currently only term vectors) uses its own char blocks.
-    numBytesUsed += CHAR_BLOCK_SIZE * CHAR_NUM_BYTE;
-    BOOST_ASSERT(numBytesUsed <= numBytesAlloc);
-    return c;
+    return (bytesAlloc >= freeTrigger);
 }
 
-void DocumentsWriter::recycleCharBlocks(Collection<CharArray> blocks, int32_t numBlocks) {
+int64_t DocumentsWriter::getRAMUsed() {
     SyncLock syncLock(this);
-    for (int32_t i = 0; i < numBlocks; ++i) {
-        freeCharBlocks.add(blocks[i]);
-        blocks[i].reset();
+    int64_t bytesUsed = deletesInRAM->bytesUsed + deletesFlushed->bytesUsed;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+        bytesUsed += (*perThread)->getRAMUsed();
     }
+    return bytesUsed;
 }
 
 String DocumentsWriter::toMB(int64_t v) {
@@ -1094,102 +852,54 @@ String DocumentsWriter::toMB(int64_t v) {
 }
 
 void DocumentsWriter::balanceRAM() {
-    // We flush when we've used our target usage
-    int64_t flushTrigger = ramBufferSize;
-
-    int64_t deletesRAMUsed = deletesInRAM->bytesUsed + deletesFlushed->bytesUsed;
-
-    if (numBytesAlloc + deletesRAMUsed > freeTrigger) {
-        if (infoStream) {
-            message(L"  RAM: now balance allocations: usedMB=" + toMB(numBytesUsed) +
-                    L" vs trigger=" + toMB(flushTrigger) +
-                    L" allocMB=" + toMB(numBytesAlloc) +
-                    L" deletesMB=" + toMB(deletesRAMUsed) +
-                    L" vs trigger=" + toMB(freeTrigger) +
-                    L" byteBlockFree=" + toMB(byteBlockAllocator->freeByteBlocks.size() * BYTE_BLOCK_SIZE) +
-                    L" perDocFree=" + toMB(perDocAllocator->freeByteBlocks.size() * PER_DOC_BLOCK_SIZE) +
-                    L" charBlockFree=" + toMB(freeCharBlocks.size() * CHAR_BLOCK_SIZE * CHAR_NUM_BYTE));
+    Collection<DocumentsWriterPerThreadPtr> candidates(Collection<DocumentsWriterPerThreadPtr>::newInstance());
+    int64_t deletesRAMUsed = 0;
+    {
+        SyncLock syncLock(this);
+        deletesRAMUsed = deletesInRAM->bytesUsed + deletesFlushed->bytesUsed;
+        // Instances being flushed are reset by the flush; leave their pools alone meanwhile
+        for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = perThreads.begin(); perThread != perThreads.end(); ++perThread) {
+            if (!(*perThread)->flushPending) {
+                candidates.add(*perThread);
+            }
         }
+    }
 
-        int64_t startBytesAlloc = numBytesAlloc + deletesRAMUsed;
-
-        int32_t iter = 0;
-
-        // We free equally from each pool in 32 KB chunks until we are below our threshold (freeLevel)
-
-        bool any = true;
-
-        while (numBytesAlloc + deletesRAMUsed > freeLevel) {
-            {
-                SyncLock syncLock(this);
-                if (perDocAllocator->freeByteBlocks.empty() && byteBlockAllocator->freeByteBlocks.empty() &&
-                        freeCharBlocks.empty() && freeIntBlocks.empty() && !any) {
-                    // Nothing else to free -- must flush now.
-                    bufferIsFull = (numBytesUsed + deletesRAMUsed > flushTrigger);
-                    if (infoStream) {
-                        if (bufferIsFull) {
-                            message(L"    nothing to free; now set bufferIsFull");
-                        } else {
-                            message(L"    nothing to free");
-                        }
-                    }
-                    BOOST_ASSERT(numBytesUsed <= numBytesAlloc);
-                    break;
-                }
-
-                if ((iter % 5) == 0 && !byteBlockAllocator->freeByteBlocks.empty()) {
-                    byteBlockAllocator->freeByteBlocks.removeLast();
-                    numBytesAlloc -= BYTE_BLOCK_SIZE;
-                }
-
-                if ((iter % 5) == 1 && !freeCharBlocks.empty()) {
-                    freeCharBlocks.removeLast();
-                    numBytesAlloc -= CHAR_BLOCK_SIZE * CHAR_NUM_BYTE;
-                }
-
-                if ((iter % 5) == 2 && !freeIntBlocks.empty()) {
-                    freeIntBlocks.removeLast();
-                    numBytesAlloc -= INT_BLOCK_SIZE * INT_NUM_BYTE;
-                }
+    int64_t numBytesAlloc = 0;
+    for (Collection<DocumentsWriterPerThreadPtr>::iterator perThread = candidates.begin(); perThread != candidates.end(); ++perThread) {
+        numBytesAlloc += (*perThread)->getRAMAllocated();
+    }
 
-                if ((iter % 5) == 3 && !perDocAllocator->freeByteBlocks.empty()) {
-                    // Remove upwards of 32 blocks (each block is 1K)
-                    for (int32_t i = 0; i < 32; ++i) {
-                        perDocAllocator->freeByteBlocks.removeLast();
-                        numBytesAlloc -= PER_DOC_BLOCK_SIZE;
-                        if (perDocAllocator->freeByteBlocks.empty()) {
-                            break;
-                        }
-                    }
-                }
-            }
+    if (candidates.empty() || numBytesAlloc + deletesRAMUsed <= freeTrigger) {
+        return;
+    }
 
-            if ((iter % 5) == 4 && any) {
-                // Ask consumer to free any recycled state
-                any = consumer->freeRAM();
-            }
+    if (infoStream) {
+        message(L"  RAM: now balance allocations: allocMB=" + toMB(numBytesAlloc) +
+                L" deletesMB=" + toMB(deletesRAMUsed) +
+                L" vs trigger=" + toMB(freeTrigger));
+    }
 
-            ++iter;
+    int64_t startBytesAlloc = numBytesAlloc;
+
+    // We free equally from each pool of each instance until we are below our threshold (freeLevel), giving up
+    // once a full round over every pool freed nothing
+    int32_t iter = 0;
+    int32_t idleIters = 0;
+    while (numBytesAlloc + deletesRAMUsed > freeLevel && idleIters < 5 * candidates.size()) {
+        DocumentsWriterPerThreadPtr perThread(candidates[iter % candidates.size()]);
+        int64_t before = perThread->getRAMAllocated();
+        if (perThread->freeRAM(iter / candidates.size())) {
+            numBytesAlloc -= before - perThread->getRAMAllocated();
+            idleIters = 0;
+        } else {
+            ++idleIters;
         }
+        ++iter;
+    }
 
-        if (infoStream) {
-            message(L"    after free: freedMB=" + StringUtils::toString((double)(startBytesAlloc - numBytesAlloc - deletesRAMUsed) / 1024.0 / 1024.0) +
-                    L" usedMB=" + StringUtils::toString((double)(numBytesUsed + deletesRAMUsed) / 1024.0 / 1024.0) +
-                    L" allocMB=" + StringUtils::toString((double)numBytesAlloc / 1024.0 / 1024.0));
-        }
-    } else {
-        // If we have not crossed the 100% mark, but have crossed the 95% mark of RAM we are actually
-        // using, go ahead and flush.  This prevents over-allocating and then freeing, with every flush.
-        SyncLock syncLock(this);
-        if (numBytesUsed + deletesRAMUsed > flushTrigger) {
-            if (infoStream) {
-                message(L"  RAM: now flush @ usedMB=" + StringUtils::toString((double)numBytesUsed / 1024.0 / 1024.0) +
-                        L" allocMB=" + StringUtils::toString((double)numBytesAlloc / 1024.0 / 1024.0) +
-                        L" deletesMB=" + StringUtils::toString((double)deletesRAMUsed / 1024.0 / 1024.0) +
-                        L" triggerMB=" + StringUtils::toString((double)flushTrigger / 1024.0 / 1024.0));
-            }
-            bufferIsFull = true;
-        }
+    if (infoStream) {
+        message(L"    after free: freedMB=" + toMB(startBytesAlloc - numBytesAlloc) + L" allocMB=" + toMB(numBytesAlloc));
     }
 }
 
@@ -1202,7 +912,7 @@ DocState::~DocState() {
 }
 
 bool DocState::testPoint(const String& name) {
-    return IndexWriterPtr(DocumentsWriterPtr(_docWriter)->_writer)->testPoint(name);
+    return IndexWriterPtr(DocumentsWriterPerThreadPtr(_docWriter)->_writer)->testPoint(name);
 }
 
 void DocState::clear() {
@@ -1211,7 +921,7 @@ void DocState::clear() {
     analyzer.reset();
 }
 
-PerDocBuffer::PerDocBuffer(const DocumentsWriterPtr& docWriter) {
+PerDocBuffer::PerDocBuffer(const DocumentsWriterPerThreadPtr& docWriter) {
     _docWriter = docWriter;
 }
 
@@ -1220,7 +930,7 @@ PerDocBuffer::~PerDocBuffer() {
 
 ByteArray PerDocBuffer::newBuffer(int32_t size) {
     BOOST_ASSERT(size == DocumentsWriter::PER_DOC_BLOCK_SIZE);
-    return DocumentsWriterPtr(_docWriter)->perDocAllocator->getByteBlock(false);
+    return DocumentsWriterPerThreadPtr(_docWriter)->perDocAllocator->getByteBlock(false);
 }
 
 void PerDocBuffer::recycle() {
@@ -1229,7 +939,7 @@ void PerDocBuffer::recycle() {
         setLength(0);
 
         // Recycle the blocks
-        DocumentsWriterPtr(_docWriter)->perDocAllocator->recycleByteBlocks(buffers);
+        DocumentsWriterPerThreadPtr(_docWriter)->perDocAllocator->recycleByteBlocks(buffers);
         buffers.clear();
         sizeInBytes = 0;
 
@@ -1254,7 +964,7 @@ IndexingChain::~IndexingChain() {
 DefaultIndexingChain::~DefaultIndexingChain() {
 }
 
-DocConsumerPtr DefaultIndexingChain::getChain(const DocumentsWriterPtr& documentsWriter) {
+DocConsumerPtr DefaultIndexingChain::getChain(const DocumentsWriterPerThreadPtr& documentsWriter) {
     TermsHashConsumerPtr termVectorsWriter(newLucene<TermVectorsTermsWriter>(documentsWriter));
     TermsHashConsumerPtr freqProxWriter(newLucene<FreqProxTermsWriter>());
 
@@ -1279,7 +989,7 @@ int64_t SkipDocWriter::sizeInBytes() {
     return 0;
 }
 
-WaitQueue::WaitQueue(const DocumentsWriterPtr& docWriter) {
+WaitQueue::WaitQueue(const DocumentsWriterPerThreadPtr& docWriter) {
     this->_docWriter = docWriter;
     waiting = Collection<DocWriterPtr>::newInstance(10);
     nextWriteDocID = 0;
@@ -1301,12 +1011,12 @@ void WaitQueue::reset() {
 
 bool WaitQueue::doResume() {
     SyncLock syncLock(this);
-    return (waitingBytes <= DocumentsWriterPtr(_docWriter)->waitQueueResumeBytes);
+    return (waitingBytes <= DocumentsWriterPtr(DocumentsWriterPerThreadPtr(_docWriter)->_docWriter)->waitQueueResumeBytes);
 }
 
 bool WaitQueue::doPause() {
     SyncLock syncLock(this);
-    return (waitingBytes > DocumentsWriterPtr(_docWriter)->waitQueuePauseBytes);
+    return (waitingBytes > DocumentsWriterPtr(DocumentsWriterPerThreadPtr(_docWriter)->_docWriter)->waitQueuePauseBytes);
 }
 
 void WaitQueue::abort() {
@@ -1325,8 +1035,8 @@ void WaitQueue::abort() {
 }
 
 void WaitQueue::writeDocument(const DocWriterPtr& doc) {
-    DocumentsWriterPtr docWriter(_docWriter);
-    BOOST_ASSERT(doc == DocumentsWriterPtr(docWriter)->skipDocWriter || nextWriteDocID == doc->docID);
+    DocumentsWriterPerThreadPtr docWriter(_docWriter);
+    BOOST_ASSERT(doc == docWriter->skipDocWriter || nextWriteDocID == doc->docID);
     bool success = false;
     LuceneException finally;
     try {
@@ -1399,7 +1109,7 @@ bool WaitQueue::add(const DocWriterPtr& doc) {
     return doPause();
 }
 
-ByteBlockAllocator::ByteBlockAllocator(const DocumentsWriterPtr& docWriter, int32_t blockSize) {
+ByteBlockAllocator::ByteBlockAllocator(const DocumentsWriterPerThreadPtr& docWriter, int32_t blockSize) {
     this->blockSize = blockSize;
     this->freeByteBlocks = Collection<ByteArray>::newInstance();
     this->_docWriter = docWriter;
@@ -1409,7 +1119,7 @@ ByteBlockAllocator::~ByteBlockAllocator() {
 }
 
 ByteArray ByteBlockAllocator::getByteBlock(bool trackAllocations) {
-    DocumentsWriterPtr docWriter(_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(_docWriter);
     SyncLock syncLock(docWriter);
     int32_t size = freeByteBlocks.size();
     ByteArray b;
@@ -1430,7 +1140,7 @@ ByteArray ByteBlockAllocator::getByteBlock(bool trackAllocations) {
 }
 
 void ByteBlockAllocator::recycleByteBlocks(Collection<ByteArray> blocks, int32_t start, int32_t end) {
-    DocumentsWriterPtr docWriter(_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(_docWriter);
     SyncLock syncLock(docWriter);
     for (int32_t i = start; i < end; ++i) {
         freeByteBlocks.add(blocks[i]);
@@ -1439,7 +1149,7 @@ void ByteBlockAllocator::recycleByteBlocks(Collection<ByteArray> blocks, int32_t
 }
 
 void ByteBlockAllocator::recycleByteBlocks(Collection<ByteArray> blocks) {
-    DocumentsWriterPtr docWriter(_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(_docWriter);
     SyncLock syncLock(docWriter);
     int32_t size = blocks.size();
     for (int32_t i = 0; i < size; ++i) {
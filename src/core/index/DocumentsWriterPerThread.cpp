@@ -0,0 +1,576 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "DocumentsWriterPerThread.h"
+#include "DocumentsWriter.h"
+#include "DocumentsWriterThreadState.h"
+#include "IndexWriter.h"
+#include "DocFieldProcessor.h"
+#include "DocConsumerPerThread.h"
+#include "BufferedDeletes.h"
+#include "FieldInfos.h"
+#include "InfoStream.h"
+#include "SegmentWriteState.h"
+#include "SegmentInfo.h"
+#include "IndexFileNames.h"
+#include "CompoundFileWriter.h"
+#include "Term.h"
+#include "TestPoint.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+DocumentsWriterPerThread::DocumentsWriterPerThread(const DocumentsWriterPtr& docWriter) {
+    this->_openFiles = HashSet<String>::newInstance();
+    this->_closedFiles = HashSet<String>::newInstance();
+    this->freeIntBlocks = Collection<IntArray>::newInstance();
+    this->freeCharBlocks = Collection<CharArray>::newInstance();
+
+    this->_docWriter = docWriter;
+    this->_writer = docWriter->_writer;
+    this->directory = docWriter->directory;
+    this->infoStream = docWriter->infoStream;
+    this->maxFieldLength = docWriter->maxFieldLength;
+    this->similarity = docWriter->similarity;
+}
+
+DocumentsWriterPerThread::~DocumentsWriterPerThread() {
+}
+
+void DocumentsWriterPerThread::initialize() {
+    docStoreOffset = 0;
+    nextDocID = 0;
+    numDocsInRAM = 0;
+    numDocsInStore = 0;
+    aborting = false;
+    isIdle = true;
+    numThreads = 0;
+    flushPending = false;
+    deletesInRAM = newLucene<BufferedDeletes>(true);
+    waitQueue = newLucene<WaitQueue>(shared_from_this());
+    skipDocWriter = newLucene<SkipDocWriter>();
+    numBytesAlloc = 0;
+    numBytesUsed = 0;
+    numDocValuesBytes = 0;
+    numPointsBytes = 0;
+    byteBlockAllocator = newLucene<ByteBlockAllocator>(shared_from_this(), DocumentsWriter::BYTE_BLOCK_SIZE);
+    perDocAllocator = newLucene<ByteBlockAllocator>(shared_from_this(), DocumentsWriter::PER_DOC_BLOCK_SIZE);
+
+    consumer = DocumentsWriterPtr(_docWriter)->indexingChain->getChain(shared_from_this());
+    docFieldProcessor = std::dynamic_pointer_cast<DocFieldProcessor>(consumer);
+    threadState = newLucene<DocumentsWriterThreadState>(shared_from_this());
+}
+
+PerDocBufferPtr DocumentsWriterPerThread::newPerDocBuffer() {
+    return newLucene<PerDocBuffer>(shared_from_this());
+}
+
+bool DocumentsWriterPerThread::hasProx() {
+    return docFieldProcessor ? docFieldProcessor->fieldInfos->hasProx() : true;
+}
+
+bool DocumentsWriterPerThread::hasPackedPostings() {
+    return flushState ? flushState->packedPostings : false;
+}
+
+void DocumentsWriterPerThread::setInfoStream(const InfoStreamPtr& infoStream) {
+    SyncLock syncLock(this);
+    this->infoStream = infoStream;
+    threadState->docState->infoStream = infoStream;
+}
+
+void DocumentsWriterPerThread::setMaxFieldLength(int32_t maxFieldLength) {
+    SyncLock syncLock(this);
+    this->maxFieldLength = maxFieldLength;
+    threadState->docState->maxFieldLength = maxFieldLength;
+}
+
+void DocumentsWriterPerThread::setSimilarity(const SimilarityPtr& similarity) {
+    SyncLock syncLock(this);
+    this->similarity = similarity;
+    threadState->docState->similarity = similarity;
+}
+
+String DocumentsWriterPerThread::getSegment() {
+    return segment;
+}
+
+int32_t DocumentsWriterPerThread::getNumDocsInRAM() {
+    return numDocsInRAM;
+}
+
+String DocumentsWriterPerThread::getDocStoreSegment() {
+    SyncLock syncLock(this);
+    return docStoreSegment;
+}
+
+int32_t DocumentsWriterPerThread::getDocStoreOffset() {
+    return docStoreOffset;
+}
+
+String DocumentsWriterPerThread::closeDocStore() {
+    TestScope testScope(L"DocumentsWriter", L"closeDocStore");
+    SyncLock syncLock(this);
+
+    if (infoStream) {
+        message(L"closeDocStore: " + StringUtils::toString(_openFiles.size()) + L" files to flush to segment " +
+                docStoreSegment + L" numDocs=" + StringUtils::toString(numDocsInStore));
+    }
+
+    bool success = false;
+    LuceneException finally;
+    String s;
+    try {
+        initFlushState(true);
+        _closedFiles.clear();
+
+        consumer->closeDocStore(flushState);
+        BOOST_ASSERT(_openFiles.empty());
+
+        s = docStoreSegment;
+        docStoreSegment.clear();
+        docStoreOffset = 0;
+        numDocsInStore = 0;
+        success = true;
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    if (!success) {
+        abort();
+    }
+    finally.throwException();
+    return s;
+}
+
+HashSet<String> DocumentsWriterPerThread::abortedFiles() {
+    return _abortedFiles;
+}
+
+void DocumentsWriterPerThread::message(const String& message) {
+    if (infoStream) {
+        *infoStream << L"DW " << message << L"\n";
+    }
+}
+
+HashSet<String> DocumentsWriterPerThread::openFiles() {
+    SyncLock syncLock(this);
+    return HashSet<String>::newInstance(_openFiles.begin(), _openFiles.end());
+}
+
+HashSet<String> DocumentsWriterPerThread::closedFiles() {
+    SyncLock syncLock(this);
+    return HashSet<String>::newInstance(_closedFiles.begin(), _closedFiles.end());
+}
+
+void DocumentsWriterPerThread::addOpenFile(const String& name) {
+    SyncLock syncLock(this);
+    BOOST_ASSERT(!_openFiles.contains(name));
+    _openFiles.add(name);
+}
+
+void DocumentsWriterPerThread::removeOpenFile(const String& name) {
+    SyncLock syncLock(this);
+    BOOST_ASSERT(_openFiles.contains(name));
+    _openFiles.remove(name);
+    _closedFiles.add(name);
+}
+
+void DocumentsWriterPerThread::setAborting() {
+    SyncLock syncLock(this);
+    aborting = true;
+}
+
+void DocumentsWriterPerThread::abort() {
+    TestScope testScope(L"DocumentsWriter", L"abort");
+    SyncLock syncLock(this);
+    LuceneException finally;
+    try {
+        if (infoStream) {
+            message(L"docWriter: now abort segment " + segment);
+        }
+
+        // Forcefully remove waiting documents from line
+        waitQueue->abort();
+        waitQueue->waitingBytes = 0;
+
+        try {
+            _abortedFiles = openFiles();
+        } catch (...) {
+            _abortedFiles.reset();
+        }
+
+        _openFiles.clear();
+
+        try {
+            threadState->consumer->abort();
+        } catch (...) {
+        }
+
+        try {
+            consumer->abort();
+        } catch (...) {
+        }
+
+        docStoreSegment.clear();
+        numDocsInStore = 0;
+        docStoreOffset = 0;
+
+        // Reset all postings data
+        doAfterFlush();
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    aborting = false;
+    if (infoStream) {
+        message(L"docWriter: done abort");
+    }
+    finally.throwException();
+}
+
+void DocumentsWriterPerThread::doAfterFlush() {
+    waitQueue->reset();
+    segment.clear();
+    numDocsInRAM = 0;
+    nextDocID = 0;
+    flushPending = false;
+    {
+        SyncLock deletesLock(deletesInRAM);
+        deletesInRAM->clear();
+    }
+    numBytesUsed = 0;
+    numDocValuesBytes = 0;
+    numPointsBytes = 0;
+}
+
+bool DocumentsWriterPerThread::anyChanges() {
+    return (numDocsInRAM != 0);
+}
+
+void DocumentsWriterPerThread::initFlushState(bool onlyDocStore) {
+    SyncLock syncLock(this);
+    initSegmentName(onlyDocStore);
+    IndexWriterPtr writer(_writer);
+    flushState = newLucene<SegmentWriteState>(shared_from_this(), directory, segment, docStoreSegment, numDocsInRAM, numDocsInStore, writer->getTermIndexInterval());
+    flushState->packedPostings = writer->getUsePackedPostings();
+}
+
+int32_t DocumentsWriterPerThread::flush(bool _closeDocStore) {
+    SyncLock syncLock(this);
+    BOOST_ASSERT(numDocsInRAM > 0);
+
+    BOOST_ASSERT(nextDocID == numDocsInRAM);
+    BOOST_ASSERT(waitQueue->numWaiting == 0);
+    BOOST_ASSERT(waitQueue->waitingBytes == 0);
+
+    initFlushState(false);
+
+    docStoreOffset = numDocsInStore;
+
+    if (infoStream) {
+        message(L"flush postings as segment " + flushState->segmentName + L" numDocs=" + StringUtils::toString(numDocsInRAM));
+    }
+
+    bool success = false;
+    LuceneException finally;
+
+    try {
+        if (_closeDocStore) {
+            BOOST_ASSERT(!flushState->docStoreSegmentName.empty());
+            BOOST_ASSERT(flushState->docStoreSegmentName == flushState->segmentName);
+
+            closeDocStore();
+            flushState->numDocsInStore = 0;
+        }
+
+        consumer->flush(newCollection<DocConsumerPerThreadPtr>(threadState->consumer), flushState);
+
+        if (infoStream) {
+            SegmentInfoPtr si(newLucene<SegmentInfo>(flushState->segmentName, flushState->numDocs, directory));
+            int64_t newSegmentSize = si->sizeInBytes();
+            message(L"  oldRAMSize=" + StringUtils::toString(numBytesUsed) + L" newFlushedSize=" +
+                    StringUtils::toString(newSegmentSize) + L" docs/MB=" +
+                    StringUtils::toString((double)numDocsInRAM / ((double)newSegmentSize / 1024.0 / 1024.0)) +
+                    L" new/old=" + StringUtils::toString(100.0 * (double)newSegmentSize / (double)numBytesUsed) + L"%");
+        }
+
+        success = true;
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    if (!success) {
+        abort();
+    }
+    finally.throwException();
+
+    BOOST_ASSERT(waitQueue->waitingBytes == 0);
+
+    return flushState->numDocs;
+}
+
+HashSet<String> DocumentsWriterPerThread::getFlushedFiles() {
+    return flushState->flushedFiles;
+}
+
+void DocumentsWriterPerThread::createCompoundFile(const String& segment) {
+    CompoundFileWriterPtr cfsWriter(newLucene<CompoundFileWriter>(directory, segment + L"." + IndexFileNames::COMPOUND_FILE_EXTENSION()));
+    for (HashSet<String>::iterator flushedFile = flushState->flushedFiles.begin(); flushedFile != flushState->flushedFiles.end(); ++flushedFile) {
+        cfsWriter->addFile(*flushedFile);
+    }
+
+    // Perform the merge
+    cfsWriter->close();
+}
+
+void DocumentsWriterPerThread::initSegmentName(bool onlyDocStore) {
+    SyncLock syncLock(this);
+    if (segment.empty() && (!onlyDocStore || docStoreSegment.empty())) {
+        segment = IndexWriterPtr(_writer)->newSegmentName();
+        BOOST_ASSERT(numDocsInRAM == 0);
+    }
+    if (docStoreSegment.empty()) {
+        docStoreSegment = segment;
+        BOOST_ASSERT(numDocsInStore == 0);
+    }
+}
+
+void DocumentsWriterPerThread::startDocument(const TermPtr& delTerm) {
+    // Allocate segment name if this is the first doc since last flush
+    initSegmentName(false);
+
+    threadState->docState->docID = nextDocID;
+
+    BOOST_ASSERT(IndexWriterPtr(_writer)->testPoint(L"DocumentsWriter.ThreadState.init start"));
+
+    if (delTerm) {
+        DocumentsWriterPtr(_docWriter)->addDeleteTerm(delTerm);
+    }
+
+    BOOST_ASSERT(IndexWriterPtr(_writer)->testPoint(L"DocumentsWriter.ThreadState.init after delTerm"));
+
+    ++nextDocID;
+    ++numDocsInRAM;
+}
+
+void DocumentsWriterPerThread::processDocument(const DocumentPtr& doc, const AnalyzerPtr& analyzer) {
+    DocStatePtr docState(threadState->docState);
+    docState->doc = doc;
+    docState->analyzer = analyzer;
+
+    DocWriterPtr perDoc;
+    LuceneException finally;
+    try {
+        perDoc = threadState->consumer->processDocument();
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    docState->clear();
+    finally.throwException();
+
+    finishDocument(perDoc);
+}
+
+bool DocumentsWriterPerThread::discardDocument() {
+    if (!aborting) {
+        skipDocWriter->docID = threadState->docState->docID;
+        bool success = false;
+        try {
+            waitQueue->add(skipDocWriter);
+            success = true;
+        } catch (...) {
+        }
+        if (success) {
+            // Immediately mark this document as deleted since likely it was partially added.  This keeps
+            // indexing as "all or none" (atomic) when adding a document
+            addDeleteDocID(threadState->docState->docID);
+            return true;
+        }
+    }
+    try {
+        abort();
+    } catch (...) {
+    }
+    return false;
+}
+
+void DocumentsWriterPerThread::finishDocument(const DocWriterPtr& docWriter) {
+    SyncLock syncLock(this);
+    BOOST_ASSERT(!docWriter || docWriter->docID == threadState->docState->docID);
+
+    bool doPause;
+    if (docWriter) {
+        doPause = waitQueue->add(docWriter);
+    } else {
+        skipDocWriter->docID = threadState->docState->docID;
+        doPause = waitQueue->add(skipDocWriter);
+    }
+
+    if (doPause) {
+        waitForWaitQueue();
+    }
+}
+
+void DocumentsWriterPerThread::waitForWaitQueue() {
+    SyncLock syncLock(this);
+    do {
+        wait(1000);
+    } while (!waitQueue->doResume());
+}
+
+void DocumentsWriterPerThread::addDeleteTerm(const TermPtr& term) {
+    SyncLock deletesLock(deletesInRAM);
+    if (numDocsInRAM == 0) {
+        return;
+    }
+    NumPtr num(deletesInRAM->terms.get(term));
+    if (!num) {
+        deletesInRAM->terms.put(term, newLucene<Num>(numDocsInRAM));
+    } else {
+        num->setNum(numDocsInRAM);
+    }
+    ++deletesInRAM->numTerms;
+
+    deletesInRAM->addBytesUsed(DocumentsWriter::BYTES_PER_DEL_TERM + term->_text.length() * DocumentsWriter::CHAR_NUM_BYTE);
+}
+
+void DocumentsWriterPerThread::addDeleteQuery(const QueryPtr& query) {
+    SyncLock deletesLock(deletesInRAM);
+    if (numDocsInRAM == 0) {
+        return;
+    }
+    deletesInRAM->queries.put(query, numDocsInRAM);
+    deletesInRAM->addBytesUsed(DocumentsWriter::BYTES_PER_DEL_QUERY);
+}
+
+void DocumentsWriterPerThread::addDeleteDocID(int32_t docID) {
+    SyncLock deletesLock(deletesInRAM);
+    deletesInRAM->docIDs.add(docID);
+    deletesInRAM->addBytesUsed(DocumentsWriter::BYTES_PER_DEL_DOCID);
+}
+
+int64_t DocumentsWriterPerThread::getRAMUsed() {
+    return numBytesUsed + numDocValuesBytes + numPointsBytes + deletesInRAM->bytesUsed;
+}
+
+int64_t DocumentsWriterPerThread::getRAMAllocated() {
+    return numBytesAlloc + deletesInRAM->bytesUsed;
+}
+
+IntArray DocumentsWriterPerThread::getIntBlock(bool trackAllocations) {
+    SyncLock syncLock(this);
+    int32_t size = freeIntBlocks.size();
+    IntArray b;
+    if (size == 0) {
+        // Always record a block allocated, even if trackAllocations is false.  This is necessary because
+        // this block will be shared between things that don't track allocations (term vectors) and things
+        // that do (freq/prox postings).
+        numBytesAlloc += DocumentsWriter::INT_BLOCK_SIZE * DocumentsWriter::INT_NUM_BYTE;
+        b = IntArray::newInstance(DocumentsWriter::INT_BLOCK_SIZE);
+    } else {
+        b = freeIntBlocks.removeLast();
+    }
+    if (trackAllocations) {
+        numBytesUsed += DocumentsWriter::INT_BLOCK_SIZE * DocumentsWriter::INT_NUM_BYTE;
+    }
+    BOOST_ASSERT(numBytesUsed <= numBytesAlloc);
+    return b;
+}
+
+void DocumentsWriterPerThread::bytesAllocated(int64_t numBytes) {
+    SyncLock syncLock(this);
+    numBytesAlloc += numBytes;
+}
+
+void DocumentsWriterPerThread::bytesUsed(int64_t numBytes) {
+    SyncLock syncLock(this);
+    numBytesUsed += numBytes;
+    BOOST_ASSERT(numBytesUsed <= numBytesAlloc);
+}
+
+void DocumentsWriterPerThread::docValuesBytesUsed(int64_t numBytes) {
+    SyncLock syncLock(this);
+    numDocValuesBytes += numBytes;
+}
+
+void DocumentsWriterPerThread::pointsBytesUsed(int64_t numBytes) {
+    SyncLock syncLock(this);
+    numPointsBytes += numBytes;
+}
+
+void DocumentsWriterPerThread::recycleIntBlocks(Collection<IntArray> blocks, int32_t start, int32_t end) {
+    SyncLock syncLock(this);
+    for (int32_t i = start; i < end; ++i) {
+        freeIntBlocks.add(blocks[i]);
+        blocks[i].reset();
+    }
+}
+
+CharArray DocumentsWriterPerThread::getCharBlock() {
+    SyncLock syncLock(this);
+    int32_t size = freeCharBlocks.size();
+    CharArray c;
+    if (size == 0) {
+        numBytesAlloc += DocumentsWriter::CHAR_BLOCK_SIZE * DocumentsWriter::CHAR_NUM_BYTE;
+        c = CharArray::newInstance(DocumentsWriter::CHAR_BLOCK_SIZE);
+    } else {
+        c = freeCharBlocks.removeLast();
+    }
+    // We always track allocations of char blocks for now because nothing that skips allocation tracking
+    // (currently only term vectors) uses its own char blocks.
+    numBytesUsed += DocumentsWriter::CHAR_BLOCK_SIZE * DocumentsWriter::CHAR_NUM_BYTE;
+    BOOST_ASSERT(numBytesUsed <= numBytesAlloc);
+    return c;
+}
+
+void DocumentsWriterPerThread::recycleCharBlocks(Collection<CharArray> blocks, int32_t numBlocks) {
+    SyncLock syncLock(this);
+    for (int32_t i = 0; i < numBlocks; ++i) {
+        freeCharBlocks.add(blocks[i]);
+        blocks[i].reset();
+    }
+}
+
+bool DocumentsWriterPerThread::freeRAM(int32_t iteration) {
+    if ((iteration % 5) == 4) {
+        // Ask consumer to free any recycled state
+        return consumer->freeRAM();
+    }
+
+    SyncLock syncLock(this);
+    if ((iteration % 5) == 0 && !byteBlockAllocator->freeByteBlocks.empty()) {
+        byteBlockAllocator->freeByteBlocks.removeLast();
+        numBytesAlloc -= DocumentsWriter::BYTE_BLOCK_SIZE;
+        return true;
+    }
+
+    if ((iteration % 5) == 1 && !freeCharBlocks.empty()) {
+        freeCharBlocks.removeLast();
+        numBytesAlloc -= DocumentsWriter::CHAR_BLOCK_SIZE * DocumentsWriter::CHAR_NUM_BYTE;
+        return true;
+    }
+
+    if ((iteration % 5) == 2 && !freeIntBlocks.empty()) {
+        freeIntBlocks.removeLast();
+        numBytesAlloc -= DocumentsWriter::INT_BLOCK_SIZE * DocumentsWriter::INT_NUM_BYTE;
+        return true;
+    }
+
+    if ((iteration % 5) == 3 && !perDocAllocator->freeByteBlocks.empty()) {
+        // Remove upwards of 32 blocks (each block is 1K)
+        for (int32_t i = 0; i < 32; ++i) {
+            perDocAllocator->freeByteBlocks.removeLast();
+            numBytesAlloc -= DocumentsWriter::PER_DOC_BLOCK_SIZE;
+            if (perDocAllocator->freeByteBlocks.empty()) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+}
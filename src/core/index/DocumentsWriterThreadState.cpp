@@ -6,12 +6,13 @@
 
 #include "LuceneInc.h"
 #include "DocumentsWriterThreadState.h"
+#include "DocumentsWriterPerThread.h"
 #include "DocumentsWriter.h"
 #include "DocConsumer.h"
 
 namespace Lucene {
 
-DocumentsWriterThreadState::DocumentsWriterThreadState(const DocumentsWriterPtr& docWriter) {
+DocumentsWriterThreadState::DocumentsWriterThreadState(const DocumentsWriterPerThreadPtr& docWriter) {
     this->_docWriter = docWriter;
 }
 
@@ -19,10 +20,7 @@ DocumentsWriterThreadState::~DocumentsWriterThreadState() {
 }
 
 void DocumentsWriterThreadState::initialize() {
-    isIdle = true;
-    doFlushAfter = false;
-    numThreads = 1;
-    DocumentsWriterPtr docWriter(_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(_docWriter);
     docState = newLucene<DocState>();
     docState->maxFieldLength = docWriter->maxFieldLength;
     docState->infoStream = docWriter->infoStream;
@@ -31,9 +29,4 @@ void DocumentsWriterThreadState::initialize() {
     consumer = docWriter->consumer->addThread(shared_from_this());
 }
 
-void DocumentsWriterThreadState::doAfterFlush() {
-    numThreads = 0;
-    doFlushAfter = false;
-}
-
 }
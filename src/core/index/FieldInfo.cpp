@@ -22,14 +22,19 @@ FieldInfo::FieldInfo(const String& name, bool isIndexed, int32_t number, bool st
     this->storePayloads = isIndexed ? storePayloads : false;
     this->omitNorms = isIndexed ? omitNorms : true;
     this->omitTermFreqAndPositions = isIndexed ? omitTermFreqAndPositions : false;
+    this->docValuesType = Fieldable::DOC_VALUES_NONE;
+    this->pointDimensions = 0;
 }
 
 FieldInfo::~FieldInfo() {
 }
 
 LuceneObjectPtr FieldInfo::clone(const LuceneObjectPtr& other) {
-    return newLucene<FieldInfo>(name, isIndexed, number, storeTermVector, storePositionWithTermVector,
-                                storeOffsetWithTermVector, omitNorms, storePayloads, omitTermFreqAndPositions);
+    FieldInfoPtr fi(newLucene<FieldInfo>(name, isIndexed, number, storeTermVector, storePositionWithTermVector,
+                                         storeOffsetWithTermVector, omitNorms, storePayloads, omitTermFreqAndPositions));
+    fi->docValuesType = docValuesType;
+    fi->pointDimensions = pointDimensions;
+    return fi;
 }
 
 void FieldInfo::update(bool isIndexed, bool storeTermVector, bool storePositionWithTermVector,
@@ -60,4 +65,24 @@ void FieldInfo::update(bool isIndexed, bool storeTermVector, bool storePositionW
     }
 }
 
+void FieldInfo::setDocValuesType(Fieldable::DocValuesType docValuesType) {
+    if (docValuesType == Fieldable::DOC_VALUES_NONE || docValuesType == this->docValuesType) {
+        return;
+    }
+    if (this->docValuesType != Fieldable::DOC_VALUES_NONE) {
+        boost::throw_exception(IllegalArgumentException(L"cannot change the doc values type of field \"" + name + L"\""));
+    }
+    this->docValuesType = docValuesType;
+}
+
+void FieldInfo::setPointDimensions(int32_t pointDimensions) {
+    if (pointDimensions == 0 || pointDimensions == this->pointDimensions) {
+        return;
+    }
+    if (this->pointDimensions != 0) {
+        boost::throw_exception(IllegalArgumentException(L"cannot change the point dimensions of field \"" + name + L"\""));
+    }
+    this->pointDimensions = pointDimensions;
+}
+
 }
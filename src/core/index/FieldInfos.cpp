@@ -22,7 +22,13 @@ const int32_t FieldInfos::FORMAT_PRE = -1;
 // First used in 2.9; prior to 2.9 there was no format header
 const int32_t FieldInfos::FORMAT_START = -2;
 
-const int32_t FieldInfos::CURRENT_FORMAT = FieldInfos::FORMAT_START;
+// Adds the doc values type of fields that have one
+const int32_t FieldInfos::FORMAT_DOC_VALUES = -3;
+
+// Adds the point dimensions of every field
+const int32_t FieldInfos::FORMAT_POINTS = -4;
+
+const int32_t FieldInfos::CURRENT_FORMAT = FieldInfos::FORMAT_POINTS;
 
 const uint8_t FieldInfos::IS_INDEXED = 0x1;
 const uint8_t FieldInfos::STORE_TERMVECTOR = 0x2;
@@ -31,6 +37,7 @@ const uint8_t FieldInfos::STORE_OFFSET_WITH_TERMVECTOR = 0x8;
 const uint8_t FieldInfos::OMIT_NORMS = 0x10;
 const uint8_t FieldInfos::STORE_PAYLOADS = 0x20;
 const uint8_t FieldInfos::OMIT_TERM_FREQ_AND_POSITIONS = 0x40;
+const uint8_t FieldInfos::HAS_DOC_VALUES = 0x80;
 
 FieldInfos::FieldInfos() {
     format = 0;
@@ -187,6 +194,24 @@ bool FieldInfos::hasVectors() {
     return false;
 }
 
+bool FieldInfos::hasDocValues() {
+    for (Collection<FieldInfoPtr>::iterator fi = byNumber.begin(); fi != byNumber.end(); ++fi) {
+        if ((*fi)->docValuesType != Fieldable::DOC_VALUES_NONE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FieldInfos::hasPoints() {
+    for (Collection<FieldInfoPtr>::iterator fi = byNumber.begin(); fi != byNumber.end(); ++fi) {
+        if ((*fi)->pointDimensions != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void FieldInfos::write(const DirectoryPtr& d, const String& name) {
     IndexOutputPtr output(d->createOutput(name));
     LuceneException finally;
@@ -225,9 +250,16 @@ void FieldInfos::write(const IndexOutputPtr& output) {
         if ((*fi)->omitTermFreqAndPositions) {
             bits |= OMIT_TERM_FREQ_AND_POSITIONS;
         }
+        if ((*fi)->docValuesType != Fieldable::DOC_VALUES_NONE) {
+            bits |= HAS_DOC_VALUES;
+        }
 
         output->writeString((*fi)->name);
         output->writeByte(bits);
+        if ((bits & HAS_DOC_VALUES) != 0) {
+            output->writeByte((uint8_t)(*fi)->docValuesType);
+        }
+        output->writeVInt((*fi)->pointDimensions);
     }
 }
 
@@ -235,7 +267,7 @@ void FieldInfos::read(const IndexInputPtr& input, const String& fileName) {
     int32_t firstInt = input->readVInt();
     format = firstInt < 0 ? firstInt : FORMAT_PRE; // This is a real format?
 
-    if (format != FORMAT_PRE && format != FORMAT_START) {
+    if (format != FORMAT_PRE && format != FORMAT_START && format != FORMAT_DOC_VALUES && format != FORMAT_POINTS) {
         boost::throw_exception(CorruptIndexException(L"unrecognized format " + StringUtils::toString(format) + L" in file \"" + fileName + L"\""));
     }
 
@@ -244,9 +276,15 @@ void FieldInfos::read(const IndexInputPtr& input, const String& fileName) {
         String name(input->readString());
         uint8_t bits = input->readByte();
 
-        addInternal(name, (bits & IS_INDEXED) != 0, (bits & STORE_TERMVECTOR) != 0, (bits & STORE_POSITIONS_WITH_TERMVECTOR) != 0,
-                    (bits & STORE_OFFSET_WITH_TERMVECTOR) != 0, (bits & OMIT_NORMS) != 0, (bits & STORE_PAYLOADS) != 0,
-                    (bits & OMIT_TERM_FREQ_AND_POSITIONS) != 0);
+        FieldInfoPtr fi(addInternal(name, (bits & IS_INDEXED) != 0, (bits & STORE_TERMVECTOR) != 0, (bits & STORE_POSITIONS_WITH_TERMVECTOR) != 0,
+                                    (bits & STORE_OFFSET_WITH_TERMVECTOR) != 0, (bits & OMIT_NORMS) != 0, (bits & STORE_PAYLOADS) != 0,
+                                    (bits & OMIT_TERM_FREQ_AND_POSITIONS) != 0));
+        if (format <= FORMAT_DOC_VALUES && (bits & HAS_DOC_VALUES) != 0) {
+            fi->docValuesType = (Fieldable::DocValuesType)input->readByte();
+        }
+        if (format <= FORMAT_POINTS) {
+            fi->pointDimensions = input->readVInt();
+        }
     }
 
     if (input->getFilePointer() != input->length()) {
@@ -6,6 +6,7 @@
 
 #include "LuceneInc.h"
 #include "FieldsReader.h"
+#include "_FieldsReader.h"
 #include "BufferedIndexInput.h"
 #include "IndexFileNames.h"
 #include "FieldsWriter.h"
@@ -22,9 +23,11 @@
 
 namespace Lucene {
 
+const int32_t FieldsReader::CHUNK_CACHE_SIZE = 4;
+
 FieldsReader::FieldsReader(const FieldInfosPtr& fieldInfos, int32_t numTotalDocs, int32_t size, int32_t format,
                            int32_t formatSize, int32_t docStoreOffset, const IndexInputPtr& cloneableFieldsStream,
-                           const IndexInputPtr& cloneableIndexStream) {
+                           const IndexInputPtr& cloneableIndexStream) : fieldsStreamTL(true) {
     closed = false;
     isOriginal = false;
     this->fieldInfos = fieldInfos;
@@ -37,13 +40,14 @@ FieldsReader::FieldsReader(const FieldInfosPtr& fieldInfos, int32_t numTotalDocs
     this->cloneableIndexStream = cloneableIndexStream;
     fieldsStream = std::dynamic_pointer_cast<IndexInput>(cloneableFieldsStream->clone());
     indexStream = std::dynamic_pointer_cast<IndexInput>(cloneableIndexStream->clone());
+    chunkCache = Collection<FieldsChunkPtr>::newInstance();
 }
 
-FieldsReader::FieldsReader(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn) {
+FieldsReader::FieldsReader(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn) : fieldsStreamTL(true) {
     ConstructReader(d, segment, fn, BufferedIndexInput::BUFFER_SIZE, -1, 0);
 }
 
-FieldsReader::FieldsReader(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn, int32_t readBufferSize, int32_t docStoreOffset, int32_t size) {
+FieldsReader::FieldsReader(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn, int32_t readBufferSize, int32_t docStoreOffset, int32_t size) : fieldsStreamTL(true) {
     ConstructReader(d, segment, fn, readBufferSize, docStoreOffset, size);
 }
 
@@ -59,6 +63,7 @@ void FieldsReader::ConstructReader(const DirectoryPtr& d, const String& segment,
     format = 0;
     formatSize = 0;
     docStoreOffset = docStoreOffset;
+    chunkCache = Collection<FieldsChunkPtr>::newInstance();
     LuceneException finally;
     try {
         fieldInfos = fn;
@@ -139,6 +144,9 @@ void FieldsReader::close() {
             indexStream->close();
         }
         fieldsStreamTL.close();
+        docStream.reset();
+        docChunk.reset();
+        chunkCache.clear();
         closed = true;
     }
 }
@@ -151,6 +159,54 @@ void FieldsReader::seekIndex(int32_t docID) {
     indexStream->seek(formatSize + (docID + docStoreOffset) * 8);
 }
 
+FieldsChunkPtr FieldsReader::getChunk(int64_t pointer) {
+    for (int32_t i = 0; i < chunkCache.size(); ++i) {
+        FieldsChunkPtr chunk(chunkCache[i]);
+        if (chunk->pointer == pointer) {
+            if (i > 0) {
+                chunkCache.remove(chunkCache.begin() + i);
+                chunkCache.add(0, chunk);
+            }
+            return chunk;
+        }
+    }
+
+    fieldsStream->seek(pointer);
+    int32_t firstDoc = fieldsStream->readVInt();
+    int32_t numDocs = fieldsStream->readVInt();
+    Collection<int32_t> docStarts(Collection<int32_t>::newInstance(numDocs + 1));
+    docStarts[0] = 0;
+    for (int32_t i = 0; i < numDocs; ++i) {
+        docStarts[i + 1] = docStarts[i] + fieldsStream->readVInt();
+    }
+    int32_t storedLength = fieldsStream->readVInt();
+    ByteArray bytes(ByteArray::newInstance(MiscUtils::unsignedShift(storedLength, 1)));
+    fieldsStream->readBytes(bytes.get(), 0, bytes.size());
+    if ((storedLength & 1) != 0) {
+        bytes = uncompress(bytes);
+    }
+    if (bytes.size() != docStarts[numDocs]) {
+        boost::throw_exception(CorruptIndexException(L"chunk at " + StringUtils::toString(pointer) + L" holds " +
+                               StringUtils::toString(bytes.size()) + L" bytes, expected " + StringUtils::toString(docStarts[numDocs])));
+    }
+
+    FieldsChunkPtr chunk(newLucene<FieldsChunk>(pointer, firstDoc, docStarts, bytes));
+    if (chunkCache.size() == CHUNK_CACHE_SIZE) {
+        chunkCache.removeLast();
+    }
+    chunkCache.add(0, chunk);
+    return chunk;
+}
+
+int32_t FieldsReader::chunkIndex(const FieldsChunkPtr& chunk, int32_t docID) {
+    int32_t index = docStoreOffset + docID - chunk->firstDoc;
+    if (index < 0 || index >= chunk->numDocs()) {
+        boost::throw_exception(CorruptIndexException(L"chunk at " + StringUtils::toString(chunk->pointer) +
+                               L" does not hold document " + StringUtils::toString(docStoreOffset + docID)));
+    }
+    return index;
+}
+
 bool FieldsReader::canReadRawDocs() {
     // Disable reading raw docs in 2.x format, because of the removal of compressed fields in 3.0.
     // We don't want rawDocs() to decode field bits to figure out if a field was compressed, hence
@@ -161,16 +217,23 @@ bool FieldsReader::canReadRawDocs() {
 DocumentPtr FieldsReader::doc(int32_t n, const FieldSelectorPtr& fieldSelector) {
     seekIndex(n);
     int64_t position = indexStream->readLong();
-    fieldsStream->seek(position);
+    if (format >= FieldsWriter::FORMAT_COMPRESSED_CHUNKS) {
+        docChunk = getChunk(position);
+        docStream = newLucene<FieldsChunkInput>(docChunk->bytes, docChunk->bytes.size());
+        docStream->seek(docChunk->docStarts[chunkIndex(docChunk, n)]);
+    } else {
+        docStream = fieldsStream;
+        docStream->seek(position);
+    }
 
     DocumentPtr doc(newLucene<Document>());
-    int32_t numFields = fieldsStream->readVInt();
+    int32_t numFields = docStream->readVInt();
     for (int32_t i = 0; i < numFields; ++i) {
-        int32_t fieldNumber = fieldsStream->readVInt();
+        int32_t fieldNumber = docStream->readVInt();
         FieldInfoPtr fi = fieldInfos->fieldInfo(fieldNumber);
         FieldSelector::FieldSelectorResult acceptField = fieldSelector ? fieldSelector->accept(fi->name) : FieldSelector::SELECTOR_LOAD;
 
-        uint8_t bits = fieldsStream->readByte();
+        uint8_t bits = docStream->readByte();
         BOOST_ASSERT(bits <= FieldsWriter::FIELD_IS_COMPRESSED + FieldsWriter::FIELD_IS_TOKENIZED + FieldsWriter::FIELD_IS_BINARY);
 
         bool compressed = ((bits & FieldsWriter::FIELD_IS_COMPRESSED) != 0);
@@ -202,6 +265,25 @@ DocumentPtr FieldsReader::doc(int32_t n, const FieldSelectorPtr& fieldSelector)
 }
 
 IndexInputPtr FieldsReader::rawDocs(Collection<int32_t> lengths, int32_t startDocID, int32_t numDocs) {
+    if (format >= FieldsWriter::FORMAT_COMPRESSED_CHUNKS) {
+        // gather the decompressed documents, which are laid out as raw documents of older formats
+        seekIndex(startDocID);
+        ByteArray bytes(ByteArray::newInstance(FieldsWriter::CHUNK_SIZE));
+        int32_t length = 0;
+        for (int32_t i = 0; i < numDocs; ++i) {
+            FieldsChunkPtr chunk(getChunk(indexStream->readLong()));
+            int32_t index = chunkIndex(chunk, startDocID + i);
+            int32_t start = chunk->docStarts[index];
+            lengths[i] = chunk->docStarts[index + 1] - start;
+            if (length + lengths[i] > bytes.size()) {
+                bytes.resize(MiscUtils::getNextSize(length + lengths[i]));
+            }
+            MiscUtils::arrayCopy(chunk->bytes.get(), start, bytes.get(), length, lengths[i]);
+            length += lengths[i];
+        }
+        return newLucene<FieldsChunkInput>(bytes, length);
+    }
+
     seekIndex(startDocID);
     int64_t startOffset = indexStream->readLong();
     int64_t lastOffset = startOffset;
@@ -220,24 +302,24 @@ IndexInputPtr FieldsReader::rawDocs(Collection<int32_t> lengths, int32_t startDo
 }
 
 void FieldsReader::skipField(bool binary, bool compressed) {
-    skipField(binary, compressed, fieldsStream->readVInt());
+    skipField(binary, compressed, docStream->readVInt());
 }
 
 void FieldsReader::skipField(bool binary, bool compressed, int32_t toRead) {
     if (format >= FieldsWriter::FORMAT_VERSION_UTF8_LENGTH_IN_BYTES || binary || compressed) {
-        fieldsStream->seek(fieldsStream->getFilePointer() + toRead);
+        docStream->seek(docStream->getFilePointer() + toRead);
     } else {
         // We need to skip chars.  This will slow us down, but still better
-        fieldsStream->skipChars(toRead);
+        docStream->skipChars(toRead);
     }
 }
 
 void FieldsReader::addFieldLazy(const DocumentPtr& doc, const FieldInfoPtr& fi, bool binary, bool compressed, bool tokenize) {
     if (binary) {
-        int32_t toRead = fieldsStream->readVInt();
-        int64_t pointer = fieldsStream->getFilePointer();
-        doc->add(newLucene<LazyField>(shared_from_this(), fi->name, Field::STORE_YES, toRead, pointer, binary, compressed));
-        fieldsStream->seek(pointer + toRead);
+        int32_t toRead = docStream->readVInt();
+        int64_t pointer = docStream->getFilePointer();
+        doc->add(newLucene<LazyField>(shared_from_this(), fi->name, Field::STORE_YES, toRead, pointer, binary, compressed, docChunk));
+        docStream->seek(pointer + toRead);
     } else {
         Field::Store store = Field::STORE_YES;
         Field::Index index = Field::toIndex(fi->isIndexed, tokenize);
@@ -245,23 +327,23 @@ void FieldsReader::addFieldLazy(const DocumentPtr& doc, const FieldInfoPtr& fi,
 
         AbstractFieldPtr f;
         if (compressed) {
-            int32_t toRead = fieldsStream->readVInt();
-            int64_t pointer = fieldsStream->getFilePointer();
+            int32_t toRead = docStream->readVInt();
+            int64_t pointer = docStream->getFilePointer();
             f = newLucene<LazyField>(shared_from_this(), fi->name, store, toRead, pointer, binary, compressed);
             // skip over the part that we aren't loading
-            fieldsStream->seek(pointer + toRead);
+            docStream->seek(pointer + toRead);
             f->setOmitNorms(fi->omitNorms);
             f->setOmitTermFreqAndPositions(fi->omitTermFreqAndPositions);
         } else {
-            int32_t length = fieldsStream->readVInt();
-            int64_t pointer = fieldsStream->getFilePointer();
+            int32_t length = docStream->readVInt();
+            int64_t pointer = docStream->getFilePointer();
             // skip ahead of where we are by the length of what is stored
             if (format >= FieldsWriter::FORMAT_VERSION_UTF8_LENGTH_IN_BYTES) {
-                fieldsStream->seek(pointer + length);
+                docStream->seek(pointer + length);
             } else {
-                fieldsStream->skipChars(length);
+                docStream->skipChars(length);
             }
-            f = newLucene<LazyField>(shared_from_this(), fi->name, store, index, termVector, length, pointer, binary, compressed);
+            f = newLucene<LazyField>(shared_from_this(), fi->name, store, index, termVector, length, pointer, binary, compressed, docChunk);
             f->setOmitNorms(fi->omitNorms);
             f->setOmitTermFreqAndPositions(fi->omitTermFreqAndPositions);
         }
@@ -273,9 +355,9 @@ void FieldsReader::addFieldLazy(const DocumentPtr& doc, const FieldInfoPtr& fi,
 void FieldsReader::addField(const DocumentPtr& doc, const FieldInfoPtr& fi, bool binary, bool compressed, bool tokenize) {
     // we have a binary stored field, and it may be compressed
     if (binary) {
-        int32_t toRead = fieldsStream->readVInt();
+        int32_t toRead = docStream->readVInt();
         ByteArray b(ByteArray::newInstance(toRead));
-        fieldsStream->readBytes(b.get(), 0, b.size());
+        docStream->readBytes(b.get(), 0, b.size());
         if (compressed) {
             doc->add(newLucene<Field>(fi->name, uncompress(b), Field::STORE_YES));
         } else {
@@ -288,15 +370,15 @@ void FieldsReader::addField(const DocumentPtr& doc, const FieldInfoPtr& fi, bool
 
         AbstractFieldPtr f;
         if (compressed) {
-            int32_t toRead = fieldsStream->readVInt();
+            int32_t toRead = docStream->readVInt();
 
             ByteArray b(ByteArray::newInstance(toRead));
-            fieldsStream->readBytes(b.get(), 0, b.size());
+            docStream->readBytes(b.get(), 0, b.size());
             f = newLucene<Field>(fi->name, uncompressString(b), store, index, termVector);
             f->setOmitTermFreqAndPositions(fi->omitTermFreqAndPositions);
             f->setOmitNorms(fi->omitNorms);
         } else {
-            f = newLucene<Field>(fi->name, fieldsStream->readString(), store, index, termVector);
+            f = newLucene<Field>(fi->name, docStream->readString(), store, index, termVector);
             f->setOmitTermFreqAndPositions(fi->omitTermFreqAndPositions);
             f->setOmitNorms(fi->omitNorms);
         }
@@ -306,7 +388,7 @@ void FieldsReader::addField(const DocumentPtr& doc, const FieldInfoPtr& fi, bool
 }
 
 int32_t FieldsReader::addFieldSize(const DocumentPtr& doc, const FieldInfoPtr& fi, bool binary, bool compressed) {
-    int32_t size = fieldsStream->readVInt();
+    int32_t size = docStream->readVInt();
     int32_t bytesize = (binary || compressed) ? size : 2 * size;
     ByteArray sizebytes(ByteArray::newInstance(4));
     sizebytes[0] = (uint8_t)MiscUtils::unsignedShift(bytesize, 24);
@@ -335,11 +417,12 @@ String FieldsReader::uncompressString(ByteArray b) {
     return L"";
 }
 
-LazyField::LazyField(const FieldsReaderPtr& reader, const String& name, Field::Store store, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed) :
+LazyField::LazyField(const FieldsReaderPtr& reader, const String& name, Field::Store store, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed, const FieldsChunkPtr& chunk) :
     AbstractField(name, store, Field::INDEX_NO, Field::TERM_VECTOR_NO) {
     this->_reader = reader;
     this->toRead = toRead;
     this->pointer = pointer;
+    this->chunk = chunk;
     this->_isBinary = isBinary;
     if (isBinary) {
         binaryLength = toRead;
@@ -348,11 +431,12 @@ LazyField::LazyField(const FieldsReaderPtr& reader, const String& name, Field::S
     this->isCompressed = isCompressed;
 }
 
-LazyField::LazyField(const FieldsReaderPtr& reader, const String& name, Field::Store store, Field::Index index, Field::TermVector termVector, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed) :
+LazyField::LazyField(const FieldsReaderPtr& reader, const String& name, Field::Store store, Field::Index index, Field::TermVector termVector, int32_t toRead, int64_t pointer, bool isBinary, bool isCompressed, const FieldsChunkPtr& chunk) :
     AbstractField(name, store, index, termVector) {
     this->_reader = reader;
     this->toRead = toRead;
     this->pointer = pointer;
+    this->chunk = chunk;
     this->_isBinary = isBinary;
     if (isBinary) {
         binaryLength = toRead;
@@ -365,6 +449,9 @@ LazyField::~LazyField() {
 }
 
 IndexInputPtr LazyField::getFieldStream() {
+    if (chunk) {
+        return newLucene<FieldsChunkInput>(chunk->bytes, chunk->bytes.size());
+    }
     FieldsReaderPtr reader(_reader);
     IndexInputPtr localFieldsStream = reader->fieldsStreamTL.get();
     if (!localFieldsStream) {
@@ -478,4 +565,64 @@ ByteArray LazyField::getBinaryValue(ByteArray result) {
     }
 }
 
+FieldsChunk::FieldsChunk(int64_t pointer, int32_t firstDoc, Collection<int32_t> docStarts, ByteArray bytes) {
+    this->pointer = pointer;
+    this->firstDoc = firstDoc;
+    this->docStarts = docStarts;
+    this->bytes = bytes;
+}
+
+FieldsChunk::~FieldsChunk() {
+}
+
+int32_t FieldsChunk::numDocs() {
+    return docStarts.size() - 1;
+}
+
+FieldsChunkInput::FieldsChunkInput(ByteArray bytes, int32_t length) {
+    this->bytes = bytes;
+    this->_length = length;
+    this->position = 0;
+}
+
+FieldsChunkInput::~FieldsChunkInput() {
+}
+
+uint8_t FieldsChunkInput::readByte() {
+    if (position >= _length) {
+        boost::throw_exception(IOException(L"Read past EOF"));
+    }
+    return bytes[position++];
+}
+
+void FieldsChunkInput::readBytes(uint8_t* b, int32_t offset, int32_t length) {
+    if (length > _length - position) {
+        boost::throw_exception(IOException(L"Read past EOF"));
+    }
+    MiscUtils::arrayCopy(bytes.get(), position, b, offset, length);
+    position += length;
+}
+
+int64_t FieldsChunkInput::getFilePointer() {
+    return position;
+}
+
+void FieldsChunkInput::seek(int64_t pos) {
+    position = (int32_t)pos;
+}
+
+int64_t FieldsChunkInput::length() {
+    return _length;
+}
+
+void FieldsChunkInput::close() {
+}
+
+LuceneObjectPtr FieldsChunkInput::clone(const LuceneObjectPtr& other) {
+    LuceneObjectPtr clone = IndexInput::clone(other ? other : newLucene<FieldsChunkInput>(bytes, _length));
+    FieldsChunkInputPtr cloneInput(std::dynamic_pointer_cast<FieldsChunkInput>(clone));
+    cloneInput->position = position;
+    return cloneInput;
+}
+
 }
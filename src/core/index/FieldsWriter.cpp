@@ -14,6 +14,7 @@
 #include "FieldInfos.h"
 #include "Fieldable.h"
 #include "Document.h"
+#include "CompressionTools.h"
 #include "TestPoint.h"
 
 namespace Lucene {
@@ -25,13 +26,20 @@ const uint8_t FieldsWriter::FIELD_IS_COMPRESSED = 0x4;
 const int32_t FieldsWriter::FORMAT = 0; // Original format
 const int32_t FieldsWriter::FORMAT_VERSION_UTF8_LENGTH_IN_BYTES = 1; // Changed strings to UTF8
 const int32_t FieldsWriter::FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS = 2; // Lucene 3.0: Removal of compressed fields
+const int32_t FieldsWriter::FORMAT_COMPRESSED_CHUNKS = 3; // Documents compressed together in chunks
 
 // NOTE: if you introduce a new format, make it 1 higher than the current one, and always change this if you
 // switch to a new format!
-const int32_t FieldsWriter::FORMAT_CURRENT = FieldsWriter::FORMAT_LUCENE_3_0_NO_COMPRESSED_FIELDS;
+const int32_t FieldsWriter::FORMAT_CURRENT = FieldsWriter::FORMAT_COMPRESSED_CHUNKS;
+
+const int32_t FieldsWriter::CHUNK_SIZE = 16384;
+const int32_t FieldsWriter::MAX_CHUNK_DOCS = 128;
 
 FieldsWriter::FieldsWriter(const DirectoryPtr& d, const String& segment, const FieldInfosPtr& fn) {
     fieldInfos = fn;
+    chunkBuffer = newLucene<RAMOutputStream>();
+    chunkDocLengths = Collection<int32_t>::newInstance();
+    numDocs = 0;
 
     bool success = false;
     String fieldsName(segment + L"." + IndexFileNames::FIELDS_EXTENSION());
@@ -81,6 +89,9 @@ FieldsWriter::FieldsWriter(const IndexOutputPtr& fdx, const IndexOutputPtr& fdt,
     fieldsStream = fdt;
     indexStream = fdx;
     doClose = false;
+    chunkBuffer = newLucene<RAMOutputStream>();
+    chunkDocLengths = Collection<int32_t>::newInstance();
+    numDocs = 0;
 }
 
 FieldsWriter::~FieldsWriter() {
@@ -92,17 +103,62 @@ void FieldsWriter::setFieldsStream(const IndexOutputPtr& stream) {
 
 void FieldsWriter::flushDocument(int32_t numStoredFields, const RAMOutputStreamPtr& buffer) {
     TestScope testScope(L"FieldsWriter", L"flushDocument");
-    indexStream->writeLong(fieldsStream->getFilePointer());
-    fieldsStream->writeVInt(numStoredFields);
-    buffer->writeTo(fieldsStream);
+    int64_t start = startDocument();
+    chunkBuffer->writeVInt(numStoredFields);
+    buffer->writeTo(chunkBuffer);
+    finishDocument(start);
 }
 
 void FieldsWriter::skipDocument() {
+    int64_t start = startDocument();
+    chunkBuffer->writeVInt(0);
+    finishDocument(start);
+}
+
+int64_t FieldsWriter::startDocument() {
+    // the pending chunk is written next, so this is where it will start
     indexStream->writeLong(fieldsStream->getFilePointer());
-    fieldsStream->writeVInt(0);
+    return chunkBuffer->getFilePointer();
+}
+
+void FieldsWriter::finishDocument(int64_t start) {
+    chunkDocLengths.add((int32_t)(chunkBuffer->getFilePointer() - start));
+    ++numDocs;
+    if (chunkBuffer->getFilePointer() >= CHUNK_SIZE || chunkDocLengths.size() >= MAX_CHUNK_DOCS) {
+        flushChunk();
+    }
+}
+
+void FieldsWriter::flushChunk() {
+    if (chunkDocLengths.empty()) {
+        return;
+    }
+    fieldsStream->writeVInt(numDocs - chunkDocLengths.size());
+    fieldsStream->writeVInt(chunkDocLengths.size());
+    for (Collection<int32_t>::iterator length = chunkDocLengths.begin(); length != chunkDocLengths.end(); ++length) {
+        fieldsStream->writeVInt(*length);
+    }
+
+    int32_t length = (int32_t)chunkBuffer->getFilePointer();
+    ByteArray bytes(ByteArray::newInstance(length));
+    chunkBuffer->writeTo(bytes.get(), 0);
+    ByteArray compressed(CompressionTools::compress(bytes.get(), 0, length, CompressionTools::BEST_SPEED));
+
+    // chunks that do not shrink, such as those holding already compressed binary fields, are stored as they are
+    if (compressed.size() < length) {
+        fieldsStream->writeVInt((compressed.size() << 1) | 1);
+        fieldsStream->writeBytes(compressed.get(), compressed.size());
+    } else {
+        fieldsStream->writeVInt(length << 1);
+        fieldsStream->writeBytes(bytes.get(), length);
+    }
+
+    chunkBuffer->reset();
+    chunkDocLengths.clear();
 }
 
 void FieldsWriter::flush() {
+    flushChunk();
     indexStream->flush();
     fieldsStream->flush();
 }
@@ -112,6 +168,7 @@ void FieldsWriter::close() {
         LuceneException finally;
         if (fieldsStream) {
             try {
+                flushChunk();
                 fieldsStream->close();
             } catch (LuceneException& e) {
                 finally = e;
@@ -133,7 +190,11 @@ void FieldsWriter::close() {
 }
 
 void FieldsWriter::writeField(const FieldInfoPtr& fi, const FieldablePtr& field) {
-    fieldsStream->writeVInt(fi->number);
+    writeField(fieldsStream, fi, field);
+}
+
+void FieldsWriter::writeField(const IndexOutputPtr& out, const FieldInfoPtr& fi, const FieldablePtr& field) {
+    out->writeVInt(fi->number);
     uint8_t bits = 0;
     if (field->isTokenized()) {
         bits |= FIELD_IS_TOKENIZED;
@@ -142,33 +203,31 @@ void FieldsWriter::writeField(const FieldInfoPtr& fi, const FieldablePtr& field)
         bits |= FIELD_IS_BINARY;
     }
 
-    fieldsStream->writeByte(bits);
+    out->writeByte(bits);
 
     if (field->isBinary()) {
         ByteArray data(field->getBinaryValue());
         int32_t len = field->getBinaryLength();
         int32_t offset = field->getBinaryOffset();
 
-        fieldsStream->writeVInt(len);
-        fieldsStream->writeBytes(data.get(), offset, len);
+        out->writeVInt(len);
+        out->writeBytes(data.get(), offset, len);
     } else {
-        fieldsStream->writeString(field->stringValue());
+        out->writeString(field->stringValue());
     }
 }
 
 void FieldsWriter::addRawDocuments(const IndexInputPtr& stream, Collection<int32_t> lengths, int32_t numDocs) {
-    int64_t position = fieldsStream->getFilePointer();
-    int64_t start = position;
+    // raw documents are uncompressed, so they are buffered into chunks like any other
     for (int32_t i = 0; i < numDocs; ++i) {
-        indexStream->writeLong(position);
-        position += lengths[i];
+        int64_t start = startDocument();
+        chunkBuffer->copyBytes(stream, lengths[i]);
+        finishDocument(start);
     }
-    fieldsStream->copyBytes(stream, position - start);
-    BOOST_ASSERT(fieldsStream->getFilePointer() == position);
 }
 
 void FieldsWriter::addDocument(const DocumentPtr& doc) {
-    indexStream->writeLong(fieldsStream->getFilePointer());
+    int64_t start = startDocument();
 
     int32_t storedCount = 0;
     Collection<FieldablePtr> fields(doc->getFields());
@@ -177,13 +236,14 @@ void FieldsWriter::addDocument(const DocumentPtr& doc) {
             ++storedCount;
         }
     }
-    fieldsStream->writeVInt(storedCount);
+    chunkBuffer->writeVInt(storedCount);
 
     for (Collection<FieldablePtr>::iterator field = fields.begin(); field != fields.end(); ++field) {
         if ((*field)->isStored()) {
-            writeField(fieldInfos->fieldInfo((*field)->name()), *field);
+            writeField(chunkBuffer, fieldInfos->fieldInfo((*field)->name()), *field);
         }
     }
+    finishDocument(start);
 }
 
 }
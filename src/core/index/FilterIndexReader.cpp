@@ -80,11 +80,26 @@ ByteArray FilterIndexReader::norms(const String& field) {
     return in->norms(field);
 }
 
+DocValuesColumnPtr FilterIndexReader::getDocValuesColumn(const String& field) {
+    ensureOpen();
+    return in->getDocValuesColumn(field);
+}
+
+PointValuesPtr FilterIndexReader::getPointValues(const String& field) {
+    ensureOpen();
+    return in->getPointValues(field);
+}
+
 void FilterIndexReader::norms(const String& field, ByteArray norms, int32_t offset) {
     ensureOpen();
     in->norms(field, norms, offset);
 }
 
+double FilterIndexReader::maxNorm(const String& field) {
+    ensureOpen();
+    return in->maxNorm(field);
+}
+
 void FilterIndexReader::doSetNorm(int32_t doc, const String& field, uint8_t value) {
     in->setNorm(doc, field, value);
 }
@@ -17,6 +17,8 @@
 #include "FieldInfo.h"
 #include "IndexOutput.h"
 #include "TermInfo.h"
+#include "RAMOutputStream.h"
+#include "PForUtils.h"
 #include "MiscUtils.h"
 #include "UnicodeUtils.h"
 #include "StringUtils.h"
@@ -42,6 +44,20 @@ FormatPostingsDocsWriter::FormatPostingsDocsWriter(const SegmentWriteStatePtr& s
     skipListWriter = parentPostings->skipListWriter;
     skipListWriter->setFreqOutput(out);
 
+    packedPostings = state->packedPostings;
+    blockCount = 0;
+    blockMaxFreq = 0;
+    termMaxFreq = 0;
+    lastBlockSkipDoc = 0;
+    lastBlockSkipFreqPointer = 0;
+    lastBlockSkipProxPointer = 0;
+    if (packedPostings) {
+        blockDocDeltas = IntArray::newInstance(PForUtils::BLOCK_SIZE);
+        blockFreqs = IntArray::newInstance(PForUtils::BLOCK_SIZE);
+        blockScratch = ByteArray::newInstance(PForUtils::scratchSize(PForUtils::BLOCK_SIZE));
+        blockSkipBuffer = newLucene<RAMOutputStream>();
+    }
+
     termInfo = newLucene<TermInfo>();
     utf8 = newLucene<UTF8Result>();
 }
@@ -67,6 +83,24 @@ FormatPostingsPositionsConsumerPtr FormatPostingsDocsWriter::addDoc(int32_t docI
         boost::throw_exception(CorruptIndexException(L"docs out of order (" + StringUtils::toString(docID) + L" <= " + StringUtils::toString(lastDocID) + L" )"));
     }
 
+    if (packedPostings) {
+        if (df == 0) {
+            FormatPostingsTermsWriterPtr parent(_parent);
+            lastBlockSkipFreqPointer = parent->freqStart;
+            lastBlockSkipProxPointer = parent->proxStart;
+        } else if (blockCount == PForUtils::BLOCK_SIZE) {
+            writeBlock();
+            bufferBlockSkip();
+        }
+        blockDocDeltas[blockCount] = delta;
+        blockFreqs[blockCount] = termDocFreq - 1;
+        ++blockCount;
+        termMaxFreq = std::max(termMaxFreq, termDocFreq);
+        ++df;
+        lastDocID = docID;
+        return posWriter;
+    }
+
     if ((++df % skipInterval) == 0) {
         skipListWriter->setSkipData(lastDocID, storePayloads, posWriter->lastPayloadLength);
         skipListWriter->bufferSkip(df);
@@ -88,7 +122,24 @@ FormatPostingsPositionsConsumerPtr FormatPostingsDocsWriter::addDoc(int32_t docI
 }
 
 void FormatPostingsDocsWriter::finish() {
-    int64_t skipPointer = skipListWriter->writeSkip(out);
+    int64_t skipPointer;
+    if (packedPostings) {
+        if (blockCount == PForUtils::BLOCK_SIZE) {
+            writeBlock();
+        } else {
+            writeTail();
+        }
+        skipPointer = out->getFilePointer();
+        if (!omitTermFreqAndPositions) {
+            out->writeVInt(termMaxFreq);
+        }
+        blockSkipBuffer->writeTo(out);
+        blockSkipBuffer->reset();
+        lastBlockSkipDoc = 0;
+        termMaxFreq = 0;
+    } else {
+        skipPointer = skipListWriter->writeSkip(out);
+    }
     FormatPostingsTermsWriterPtr parent(_parent);
     termInfo->set(df, parent->freqStart, parent->proxStart, (int32_t)(skipPointer - parent->freqStart));
 
@@ -102,6 +153,48 @@ void FormatPostingsDocsWriter::finish() {
     df = 0;
 }
 
+void FormatPostingsDocsWriter::writeBlock() {
+    PForUtils::encode(blockDocDeltas.get(), blockCount, out, blockScratch.get());
+    if (!omitTermFreqAndPositions) {
+        blockMaxFreq = *std::max_element(blockFreqs.get(), blockFreqs.get() + blockCount) + 1;
+        PForUtils::encode(blockFreqs.get(), blockCount, out, blockScratch.get());
+    }
+    blockCount = 0;
+}
+
+void FormatPostingsDocsWriter::bufferBlockSkip() {
+    // the positions of every doc in the block have been written by now
+    int64_t freqPointer = out->getFilePointer();
+    int64_t proxPointer = posWriter->out ? posWriter->out->getFilePointer() : 0;
+    blockSkipBuffer->writeVInt(lastDocID - lastBlockSkipDoc);
+    blockSkipBuffer->writeVLong(freqPointer - lastBlockSkipFreqPointer);
+    blockSkipBuffer->writeVLong(proxPointer - lastBlockSkipProxPointer);
+    if (storePayloads) {
+        blockSkipBuffer->writeVInt(posWriter->lastPayloadLength);
+    }
+    if (!omitTermFreqAndPositions) {
+        blockSkipBuffer->writeVInt(blockMaxFreq);
+    }
+    lastBlockSkipDoc = lastDocID;
+    lastBlockSkipFreqPointer = freqPointer;
+    lastBlockSkipProxPointer = proxPointer;
+}
+
+void FormatPostingsDocsWriter::writeTail() {
+    for (int32_t i = 0; i < blockCount; ++i) {
+        int32_t delta = blockDocDeltas[i];
+        if (omitTermFreqAndPositions) {
+            out->writeVInt(delta);
+        } else if (blockFreqs[i] == 0) {
+            out->writeVInt((delta << 1) | 1);
+        } else {
+            out->writeVInt(delta << 1);
+            out->writeVInt(blockFreqs[i] + 1);
+        }
+    }
+    blockCount = 0;
+}
+
 void FormatPostingsDocsWriter::close() {
     out->close();
     posWriter->close();
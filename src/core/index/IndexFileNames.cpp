@@ -35,6 +35,16 @@ const String& IndexFileNames::NORMS_EXTENSION() {
     return _NORMS_EXTENSION;
 }
 
+const String& IndexFileNames::DOC_VALUES_EXTENSION() {
+    static String _DOC_VALUES_EXTENSION(L"dv");
+    return _DOC_VALUES_EXTENSION;
+}
+
+const String& IndexFileNames::POINTS_EXTENSION() {
+    static String _POINTS_EXTENSION(L"pnt");
+    return _POINTS_EXTENSION;
+}
+
 const String& IndexFileNames::FREQ_EXTENSION() {
     static String _FREQ_EXTENSION(L"frq");
     return _FREQ_EXTENSION;
@@ -133,6 +143,8 @@ const HashSet<String> IndexFileNames::INDEX_EXTENSIONS() {
         _INDEX_EXTENSIONS.add(VECTORS_FIELDS_EXTENSION());
         _INDEX_EXTENSIONS.add(GEN_EXTENSION());
         _INDEX_EXTENSIONS.add(NORMS_EXTENSION());
+        _INDEX_EXTENSIONS.add(DOC_VALUES_EXTENSION());
+        _INDEX_EXTENSIONS.add(POINTS_EXTENSION());
         _INDEX_EXTENSIONS.add(COMPOUND_FILE_STORE_EXTENSION());
     }
     return _INDEX_EXTENSIONS;
@@ -153,6 +165,8 @@ const HashSet<String> IndexFileNames::INDEX_EXTENSIONS_IN_COMPOUND_FILE() {
         _INDEX_EXTENSIONS_IN_COMPOUND_FILE.add(VECTORS_DOCUMENTS_EXTENSION());
         _INDEX_EXTENSIONS_IN_COMPOUND_FILE.add(VECTORS_FIELDS_EXTENSION());
         _INDEX_EXTENSIONS_IN_COMPOUND_FILE.add(NORMS_EXTENSION());
+        _INDEX_EXTENSIONS_IN_COMPOUND_FILE.add(DOC_VALUES_EXTENSION());
+        _INDEX_EXTENSIONS_IN_COMPOUND_FILE.add(POINTS_EXTENSION());
     }
     return _INDEX_EXTENSIONS_IN_COMPOUND_FILE;
 };
@@ -180,6 +194,8 @@ const HashSet<String> IndexFileNames::NON_STORE_INDEX_EXTENSIONS() {
         _NON_STORE_INDEX_EXTENSIONS.add(TERMS_EXTENSION());
         _NON_STORE_INDEX_EXTENSIONS.add(TERMS_INDEX_EXTENSION());
         _NON_STORE_INDEX_EXTENSIONS.add(NORMS_EXTENSION());
+        _NON_STORE_INDEX_EXTENSIONS.add(DOC_VALUES_EXTENSION());
+        _NON_STORE_INDEX_EXTENSIONS.add(POINTS_EXTENSION());
     }
     return _NON_STORE_INDEX_EXTENSIONS;
 };
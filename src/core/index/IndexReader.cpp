@@ -188,6 +188,33 @@ bool IndexReader::hasNorms(const String& field) {
     return norms(field);
 }
 
+double IndexReader::maxNorm(const String& field) {
+    return decodeMaxNorm(norms(field));
+}
+
+double IndexReader::decodeMaxNorm(ByteArray norms) {
+    if (!norms) {
+        return 1.0;
+    }
+    // 0xff is the infinite norm of a field without tokens, and such a document matches no term
+    uint8_t maxByte = 0;
+    const uint8_t* bytes = norms.get();
+    for (int32_t i = 0; i < norms.size() && maxByte != 0xfe; ++i) {
+        if (bytes[i] != 0xff) {
+            maxByte = std::max(maxByte, bytes[i]);
+        }
+    }
+    return Similarity::decodeNorm(maxByte); // decoding preserves the order of the bytes
+}
+
+DocValuesColumnPtr IndexReader::getDocValuesColumn(const String& field) {
+    return DocValuesColumnPtr();
+}
+
+PointValuesPtr IndexReader::getPointValues(const String& field) {
+    return PointValuesPtr();
+}
+
 void IndexReader::setNorm(int32_t doc, const String& field, uint8_t value) {
     SyncLock syncLock(this);
     ensureOpen();
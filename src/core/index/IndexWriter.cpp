@@ -11,6 +11,7 @@
 #include "Analyzer.h"
 #include "KeepOnlyLastCommitDeletionPolicy.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 #include "IndexFileDeleter.h"
 #include "IndexFileNames.h"
 #include "Lock.h"
@@ -24,6 +25,8 @@
 #include "ConcurrentMergeScheduler.h"
 #include "CompoundFileWriter.h"
 #include "SegmentMerger.h"
+#include "Sort.h"
+#include "SortField.h"
 #include "DateTools.h"
 #include "Constants.h"
 #include "InfoStream.h"
@@ -60,6 +63,9 @@ const int32_t IndexWriter::DEFAULT_MAX_BUFFERED_DELETE_TERMS = IndexWriter::DISA
 /// Default value is 10000.
 const int32_t IndexWriter::DEFAULT_MAX_FIELD_LENGTH = 10000;
 
+/// Default value is 8.
+const int32_t IndexWriter::DEFAULT_MAX_THREAD_STATES = 8;
+
 /// Default value is 128.
 const int32_t IndexWriter::DEFAULT_TERM_INDEX_INTERVAL = 128;
 
@@ -132,6 +138,7 @@ void IndexWriter::initialize() {
     segmentsToOptimize = SetSegmentInfo::newInstance();
     optimizeMaxNumSegments = 0;
     mergingSegments = SetSegmentInfo::newInstance();
+    flushedUnchecked = Collection<SegmentInfoPtr>::newInstance();
     runningMerges = SetOneMerge::newInstance();
     synced = HashSet<String>::newInstance();
     syncing = HashSet<String>::newInstance();
@@ -156,6 +163,7 @@ void IndexWriter::initialize() {
     mergeScheduler = newLucene<ConcurrentMergeScheduler>();
     similarity = Similarity::getDefault();
     termIndexInterval = DEFAULT_TERM_INDEX_INTERVAL;
+    usePackedPostings = false;
     commitLock  = newInstance<Synchronize>();
 
     if (!indexingChain) {
@@ -315,6 +323,11 @@ int32_t IndexWriter::numDeletedDocs(const SegmentInfoPtr& info) {
     return deletedDocs;
 }
 
+SetSegmentInfo IndexWriter::getMergingSegments() {
+    SyncLock syncLock(this);
+    return SetSegmentInfo::newInstance(mergingSegments.begin(), mergingSegments.end());
+}
+
 void IndexWriter::acquireWrite() {
     SyncLock syncLock(this);
     BOOST_ASSERT(writeThread != LuceneThread::currentId());
@@ -436,6 +449,36 @@ int32_t IndexWriter::getTermIndexInterval() {
     return termIndexInterval;
 }
 
+void IndexWriter::setUsePackedPostings(bool value) {
+    ensureOpen();
+    this->usePackedPostings = value;
+}
+
+bool IndexWriter::getUsePackedPostings() {
+    // We pass false because this method is called by SegmentMerger while we are in the process of closing
+    ensureOpen(false);
+    return usePackedPostings;
+}
+
+void IndexWriter::setIndexSort(const SortPtr& sort) {
+    ensureOpen();
+    if (sort) {
+        Collection<SortFieldPtr> fields(sort->getSort());
+        for (Collection<SortFieldPtr>::iterator field = fields.begin(); field != fields.end(); ++field) {
+            if ((*field)->getType() == SortField::SCORE) {
+                boost::throw_exception(IllegalArgumentException(L"index sort cannot sort by relevance: " + sort->toString()));
+            }
+        }
+    }
+    SyncLock syncLock(this);
+    this->indexSort = sort;
+}
+
+SortPtr IndexWriter::getIndexSort() {
+    SyncLock syncLock(this);
+    return indexSort;
+}
+
 void IndexWriter::setRollbackSegmentInfos(const SegmentInfosPtr& infos) {
     SyncLock syncLock(this);
     rollbackSegmentInfos = std::dynamic_pointer_cast<SegmentInfos>(infos->clone());
@@ -598,6 +641,22 @@ int32_t IndexWriter::getMaxBufferedDeleteTerms() {
     return docWriter->getMaxBufferedDeleteTerms();
 }
 
+void IndexWriter::setMaxThreadStates(int32_t maxThreadStates) {
+    ensureOpen();
+    if (maxThreadStates < 1) {
+        boost::throw_exception(IllegalArgumentException(L"maxThreadStates must at least be 1"));
+    }
+    docWriter->setMaxThreadStates(maxThreadStates);
+    if (infoStream) {
+        message(L"setMaxThreadStates " + StringUtils::toString(maxThreadStates));
+    }
+}
+
+int32_t IndexWriter::getMaxThreadStates() {
+    ensureOpen();
+    return docWriter->getMaxThreadStates();
+}
+
 void IndexWriter::setMergeFactor(int32_t mergeFactor) {
     getLogMergePolicy()->setMergeFactor(mergeFactor);
 }
@@ -771,90 +830,6 @@ void IndexWriter::closeInternal(bool waitForMerges) {
     finally.throwException();
 }
 
-bool IndexWriter::flushDocStores() {
-    SyncLock syncLock(this);
-
-    if (infoStream) {
-        message(L"flushDocStores segment=" + docWriter->getDocStoreSegment());
-    }
-
-    bool useCompoundDocStore = false;
-
-    if (infoStream) {
-        message(L"closeDocStores segment=" + docWriter->getDocStoreSegment());
-    }
-
-    String docStoreSegment;
-
-    bool success = false;
-    LuceneException finally;
-    try {
-        docStoreSegment = docWriter->closeDocStore();
-        success = true;
-    } catch (LuceneException& e) {
-        finally = e;
-    }
-    if (!success && infoStream) {
-        message(L"hit exception closing doc store segment");
-    }
-    finally.throwException();
-
-    if (infoStream) {
-        message(L"flushDocStores files=" + StringUtils::toString(docWriter->closedFiles()));
-    }
-
-    useCompoundDocStore = mergePolicy->useCompoundDocStore(segmentInfos);
-    HashSet<String> closedFiles(docWriter->closedFiles());
-
-    if (useCompoundDocStore && !docStoreSegment.empty() && !closedFiles.empty()) {
-        // Now build compound doc store file
-        if (infoStream) {
-            message(L"create compound file " + docStoreSegment + L"." + IndexFileNames::COMPOUND_FILE_STORE_EXTENSION());
-        }
-
-        success = false;
-
-        int32_t numSegments = segmentInfos->size();
-        String compoundFileName(docStoreSegment + L"." + IndexFileNames::COMPOUND_FILE_STORE_EXTENSION());
-
-        try {
-            CompoundFileWriterPtr cfsWriter(newLucene<CompoundFileWriter>(directory, compoundFileName));
-            for (HashSet<String>::iterator file = closedFiles.begin(); file != closedFiles.end(); ++file) {
-                cfsWriter->addFile(*file);
-            }
-
-            // Perform the merge
-            cfsWriter->close();
-            success = true;
-        } catch (LuceneException& e) {
-            finally = e;
-        }
-
-        if (!success) {
-            if (infoStream) {
-                message(L"hit exception building compound file doc store for segment " + docStoreSegment);
-            }
-            deleter->deleteFile(compoundFileName);
-            docWriter->abort();
-        }
-        finally.throwException();
-
-        for (int32_t i = 0; i < numSegments; ++i) {
-            SegmentInfoPtr si(segmentInfos->info(i));
-            if (si->getDocStoreOffset() != -1 && si->getDocStoreSegment() == docStoreSegment) {
-                si->setDocStoreIsCompoundFile(true);
-            }
-        }
-
-        checkpoint();
-
-        // In case the files we just merged into a CFS were not previously checkpointed
-        deleter->deleteNewFiles(docWriter->closedFiles());
-    }
-
-    return useCompoundDocStore;
-}
-
 DirectoryPtr IndexWriter::getDirectory() {
     ensureOpen(false); // Pass false because the flush during closing calls getDirectory
     return directory;
@@ -1264,6 +1239,83 @@ void IndexWriter::updatePendingMerges(int32_t maxNumSegmentsOptimize, bool optim
             registerMerge(*merge);
         }
     }
+
+    if (indexSort) {
+        registerSortMerges(maxNumSegmentsOptimize, optimize);
+    }
+}
+
+void IndexWriter::registerSortMerges(int32_t maxNumSegmentsOptimize, bool optimize) {
+    SyncLock syncLock(this);
+    // Merges chosen by the policy sort their documents anyway, so this only picks up the segments they left out
+    for (int32_t i = 0; i < segmentInfos->size(); ++i) {
+        SegmentInfoPtr info(segmentInfos->info(i));
+        if (info->dir != directory || mergingSegments.contains(info) || isSorted(info)) {
+            continue;
+        }
+        OneMergePtr merge(newLucene<OneMerge>(segmentInfos->range(i, i + 1), mergePolicy->useCompoundFile(segmentInfos, info)));
+        merge->optimize = optimize;
+        merge->maxNumSegmentsOptimize = maxNumSegmentsOptimize;
+        registerMerge(merge);
+    }
+}
+
+void IndexWriter::checkFlushedOrder() {
+    Collection<SegmentInfoPtr> flushed;
+    {
+        SyncLock syncLock(this);
+        flushed = flushedUnchecked;
+        flushedUnchecked = Collection<SegmentInfoPtr>::newInstance();
+    }
+    for (Collection<SegmentInfoPtr>::iterator info = flushed.begin(); info != flushed.end(); ++info) {
+        HashSet<String> files;
+        {
+            SyncLock syncLock(this);
+            // a segment merged meanwhile needs no check; the others keep their files while they are read
+            if (!indexSort || !segmentInfos->contains(*info) || mergingSegments.contains(*info)) {
+                continue;
+            }
+            files = (*info)->files();
+            deleter->incRef(files);
+        }
+        bool inOrder = false;
+        LuceneException finally;
+        try {
+            inOrder = isFlushedInOrder(*info);
+        } catch (LuceneException& e) {
+            finally = e;
+        }
+        {
+            SyncLock syncLock(this);
+            deleter->decRef(files);
+            // a segment flushed in sort order already is marked sorted, so it is not rewritten by a sort merge
+            if (inOrder && indexSort) {
+                (*info)->getDiagnostics().put(L"sort", indexSort->getIndexKey());
+            }
+        }
+        finally.throwException();
+    }
+}
+
+bool IndexWriter::isFlushedInOrder(const SegmentInfoPtr& info) {
+    // the sort values are read through the field cache, which needs the terms index; the reader is not
+    // pooled, so closing it evicts its field cache entries
+    SegmentReaderPtr reader(SegmentReader::get(true, info->dir, info, BufferedIndexInput::BUFFER_SIZE, false, readerTermsIndexDivisor));
+    bool inOrder = false;
+    LuceneException finally;
+    try {
+        inOrder = SegmentMerger::isInOrder(reader, indexSort);
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    reader->close();
+    finally.throwException();
+    return inOrder;
+}
+
+bool IndexWriter::isSorted(const SegmentInfoPtr& info) {
+    MapStringString diagnostics(info->getDiagnostics());
+    return (diagnostics && diagnostics.get(L"sort") == indexSort->getIndexKey());
 }
 
 OneMergePtr IndexWriter::getNextMerge() {
@@ -1874,6 +1926,7 @@ void IndexWriter::addIndexes(Collection<IndexReaderPtr> readers) {
                     SyncLock syncLock(this);
                     segmentInfos->clear(); // pop old infos & add new
                     info = newLucene<SegmentInfo>(mergedName, docCount, directory, false, true, -1, L"", false, merger->hasProx());
+                    info->setPackedPostings(merger->hasPackedPostings());
                     setDiagnostics(info, L"addIndexes(Collection<IndexReaderPtr>)");
                     segmentInfos->add(info);
                 }
@@ -2066,7 +2119,9 @@ void IndexWriter::finishCommit() {
 void IndexWriter::flush(bool triggerMerge, bool flushDocStores, bool flushDeletes) {
     // We can be called during close, when closing = true, so we must pass false to ensureOpen
     ensureOpen(false);
-    if (doFlush(flushDocStores, flushDeletes) && triggerMerge) {
+    bool flushed = doFlush(flushDocStores, flushDeletes);
+    checkFlushedOrder();
+    if (flushed && triggerMerge) {
         maybeMerge();
     }
 }
@@ -2113,6 +2168,37 @@ bool IndexWriter::doFlushInternal(bool flushDocStores, bool flushDeletes) {
         flushDeletes = true;
     }
 
+    bool flushDocs = false;
+
+    if (!flushDocStores && !flushDeletes && !docWriter->isFlushPending()) {
+        // Only flush the segments that are full; threads indexing into the others carry on meanwhile
+        if (infoStream) {
+            message(L"flush: pending segments");
+        }
+        LuceneException finally;
+        try {
+            for (DocumentsWriterPerThreadPtr perThread(docWriter->checkoutFlushPending(false)); perThread; perThread = docWriter->checkoutFlushPending(false)) {
+                if (flushSegment(perThread)) {
+                    flushDocs = true;
+                }
+            }
+            if (flushDocs) {
+                docWriter->pushDeletes();
+                if (docWriter->doApplyDeletes()) {
+                    applyDeletes();
+                }
+                doAfterFlush();
+            }
+        } catch (std::bad_alloc& oom) {
+            finally = handleOOM(oom, L"doFlush");
+            flushDocs = false;
+        } catch (LuceneException& e) {
+            finally = e;
+        }
+        finally.throwException();
+        return flushDocs;
+    }
+
     // Make sure no threads are actively adding a document. Returns true if docWriter is currently aborting, in
     // which case we skip flushing this segment
     if (infoStream) {
@@ -2123,108 +2209,95 @@ bool IndexWriter::doFlushInternal(bool flushDocStores, bool flushDeletes) {
         return false;
     }
 
-    bool flushDocs = false;
-
     LuceneException finally;
     try {
-        SegmentInfoPtr newSegment;
-
-        int32_t numDocs = docWriter->getNumDocsInRAM();
-
-        // Always flush docs if there are any
-        flushDocs = (numDocs > 0);
-
-        String docStoreSegment(docWriter->getDocStoreSegment());
-
-        BOOST_ASSERT(!docStoreSegment.empty() || numDocs == 0);
-
-        if (docStoreSegment.empty()) {
-            flushDocStores = false;
-        }
-
-        int32_t docStoreOffset = docWriter->getDocStoreOffset();
-
-        bool docStoreIsCompoundFile = false;
-
         if (infoStream) {
-            message(L" flush: segment=" + docWriter->getSegment() +
-                    L" docStoreSegment=" + StringUtils::toString(docWriter->getDocStoreSegment()) +
-                    L" docStoreOffset=" + StringUtils::toString(docStoreOffset) +
-                    L" flushDocs=" + StringUtils::toString(flushDocs) +
-                    L" flushDeletes=" + StringUtils::toString(flushDeletes) +
+            message(L" flush: flushDeletes=" + StringUtils::toString(flushDeletes) +
                     L" flushDocStores=" + StringUtils::toString(flushDocStores) +
-                    L" numDocs=" + StringUtils::toString(numDocs) +
+                    L" numDocs=" + StringUtils::toString(docWriter->getNumDocsInRAM()) +
                     L" numBufDelTerms=" + StringUtils::toString(docWriter->getNumBufferedDeleteTerms()));
             message(L" index before flush " + segString());
         }
 
-        // Check if the doc stores must be separately flushed because other segments, besides the one we are
-        // about to flush, reference it
-        if (flushDocStores && (!flushDocs || docWriter->getSegment() != docWriter->getDocStoreSegment())) {
-            // We must separately flush the doc store
-            if (infoStream) {
-                message(L" flush shared docStore segment " + docStoreSegment);
+        // Always flush docs if there are any
+        for (DocumentsWriterPerThreadPtr perThread(docWriter->checkoutFlushPending(true)); perThread; perThread = docWriter->checkoutFlushPending(true)) {
+            if (flushSegment(perThread)) {
+                flushDocs = true;
             }
-
-            docStoreIsCompoundFile = IndexWriter::flushDocStores();
-            flushDocStores = false;
         }
 
-        String segment(docWriter->getSegment());
+        docWriter->pushDeletes();
 
-        // If we are flushing docs, segment must not be null
-        BOOST_ASSERT(!segment.empty() || !flushDocs);
+        if (flushDeletes) {
+            applyDeletes();
+        }
 
         if (flushDocs) {
-            bool success = false;
-            int32_t flushedDocCount;
+            checkpoint();
+        }
 
-            try {
-                flushedDocCount = docWriter->flush(flushDocStores);
-                if (infoStream) {
-                    message(L"flushedFiles=" + StringUtils::toString(docWriter->getFlushedFiles()));
-                }
-                success = true;
-            } catch (LuceneException& e) {
-                finally = e;
-            }
+        doAfterFlush();
+    } catch (std::bad_alloc& oom) {
+        finally = handleOOM(oom, L"doFlush");
+        flushDocs = false;
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    docWriter->resumeAllThreads();
+    finally.throwException();
 
-            if (!success) {
-                if (infoStream) {
-                    message(L"hit exception flushing segment " + segment);
-                }
-                deleter->refresh(segment);
-            }
+    return flushDocs;
+}
 
-            finally.throwException();
+bool IndexWriter::flushSegment(const DocumentsWriterPerThreadPtr& perThread) {
+    SyncLock syncLock(this);
+    String segment(perThread->getSegment());
+    bool flushed = false;
 
-            if (docStoreOffset == 0 && flushDocStores) {
-                // This means we are flushing private doc stores with this segment, so it will not be shared
-                // with other segments
-                BOOST_ASSERT(!docStoreSegment.empty());
-                BOOST_ASSERT(docStoreSegment == segment);
-                docStoreOffset = -1;
-                docStoreIsCompoundFile = false;
-                docStoreSegment.clear();
+    LuceneException finally;
+    try {
+        if (infoStream) {
+            message(L" flush: segment=" + segment + L" numDocs=" + StringUtils::toString(perThread->getNumDocsInRAM()));
+        }
+
+        bool success = false;
+        int32_t flushedDocCount = 0;
+
+        try {
+            flushedDocCount = perThread->flush(true);
+            if (infoStream) {
+                message(L"flushedFiles=" + StringUtils::toString(perThread->getFlushedFiles()));
             }
+            success = true;
+        } catch (LuceneException& e) {
+            finally = e;
+        }
 
-            // Create new SegmentInfo, but do not add to our segmentInfos until deletes are flushed successfully.
-            newSegment = newLucene<SegmentInfo>(segment, flushedDocCount, directory, false, true, docStoreOffset, docStoreSegment, docStoreIsCompoundFile, docWriter->hasProx());
-            setDiagnostics(newSegment, L"flush");
+        if (!success) {
+            if (infoStream) {
+                message(L"hit exception flushing segment " + segment);
+            }
+            deleter->refresh(segment);
         }
 
-        docWriter->pushDeletes();
+        finally.throwException();
 
-        if (flushDocs) {
-            segmentInfos->add(newSegment);
-            checkpoint();
-        }
+        // The deletes buffered against these documents are applied once the segment is in the index
+        BufferedDeletesPtr deletes(docWriter->finishFlush(perThread));
 
-        if (flushDocs && mergePolicy->useCompoundFile(segmentInfos, newSegment)) {
+        // Doc stores are always closed with the segment, so they are never shared with other segments
+        SegmentInfoPtr newSegment(newLucene<SegmentInfo>(segment, flushedDocCount, directory, false, true, -1, L"", false, perThread->hasProx()));
+        newSegment->setPackedPostings(perThread->hasPackedPostings());
+        setDiagnostics(newSegment, L"flush");
+
+        segmentInfos->add(newSegment);
+        checkpoint();
+
+        if (mergePolicy->useCompoundFile(segmentInfos, newSegment)) {
             // Now build compound file
-            bool success = false;
+            success = false;
             try {
-                docWriter->createCompoundFile(segment);
+                perThread->createCompoundFile(segment);
                 success = true;
             } catch (LuceneException& e) {
                 finally = e;
@@ -2243,25 +2316,22 @@ bool IndexWriter::doFlushInternal(bool flushDocStores, bool flushDeletes) {
             checkpoint();
         }
 
-        if (flushDeletes) {
-            applyDeletes();
+        if (docWriter->applyDeletes(deletes, newSegment)) {
+            checkpoint();
         }
 
-        if (flushDocs) {
-            checkpoint();
+        // whether the documents happen to be in sort order is checked once the writer is unlocked
+        if (indexSort) {
+            flushedUnchecked.add(newSegment);
         }
 
-        doAfterFlush();
-    } catch (std::bad_alloc& oom) {
-        finally = handleOOM(oom, L"doFlush");
-        flushDocs = false;
+        flushed = true;
     } catch (LuceneException& e) {
         finally = e;
     }
-    docWriter->resumeAllThreads();
+    docWriter->checkin(perThread);
     finally.throwException();
-
-    return flushDocs;
+    return flushed;
 }
 
 int64_t IndexWriter::ramSizeInBytes() {
@@ -2299,7 +2369,7 @@ int32_t IndexWriter::ensureContiguousMerge(const OneMergePtr& merge) {
     return first;
 }
 
-void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentReaderPtr& mergeReader) {
+void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentReaderPtr& mergeReader, Collection< Collection<int32_t> > docMaps) {
     SyncLock syncLock(this);
     BOOST_ASSERT(testPoint(L"startCommitMergeDeletes"));
 
@@ -2318,6 +2388,8 @@ void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentRea
         int32_t docCount = info->docCount;
         SegmentReaderPtr previousReader(merge->readersClone[i]);
         SegmentReaderPtr currentReader(merge->readers[i]);
+        Collection<int32_t> docMap(docMaps ? docMaps[i] : Collection<int32_t>());
+        int32_t docStart = docUpto;
         if (previousReader->hasDeletions()) {
             // There were deletes on this segment when the merge started.  The merge has collapsed away those deletes,
             // but if new deletes were flushed since the merge started, we must now carefully keep any newly flushed
@@ -2330,7 +2402,7 @@ void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentRea
                         BOOST_ASSERT(currentReader->isDeleted(j));
                     } else {
                         if (currentReader->isDeleted(j)) {
-                            mergeReader->doDelete(docUpto);
+                            mergeReader->doDelete(docMap ? docStart + docMap[j] : docUpto);
                             ++delCount;
                         }
                         ++docUpto;
@@ -2343,7 +2415,7 @@ void IndexWriter::commitMergedDeletes(const OneMergePtr& merge, const SegmentRea
             // This segment had no deletes before but now it does
             for (int32_t j = 0; j < docCount; ++j) {
                 if (currentReader->isDeleted(j)) {
-                    mergeReader->doDelete(docUpto);
+                    mergeReader->doDelete(docMap ? docStart + docMap[j] : docUpto);
                     ++delCount;
                 }
                 ++docUpto;
@@ -2385,7 +2457,7 @@ bool IndexWriter::commitMerge(const OneMergePtr& merge, const SegmentMergerPtr&
 
     int32_t start = ensureContiguousMerge(merge);
 
-    commitMergedDeletes(merge, mergedReader);
+    commitMergedDeletes(merge, mergedReader, merger->getDocMaps());
     docWriter->remapDeletes(segmentInfos, merger->getDocMaps(), merger->getDelCounts(), merge, mergedDocCount);
 
     // If the doc store we are using has been closed and is in now compound format (but wasn't when we started),
@@ -2393,6 +2465,7 @@ bool IndexWriter::commitMerge(const OneMergePtr& merge, const SegmentMergerPtr&
     setMergeDocStoreIsCompoundFile(merge);
 
     merge->info->setHasProx(merger->hasProx());
+    merge->info->setPackedPostings(merger->hasPackedPostings());
 
     segmentInfos->remove(start, start + merge->segments->size());
     BOOST_ASSERT(!segmentInfos->contains(merge->info));
@@ -2596,8 +2669,6 @@ void IndexWriter::_mergeInit(const OneMergePtr& merge) {
     int32_t next = -1;
 
     bool mergeDocStores = false;
-    bool doFlushDocStore = false;
-    String currentDocStoreSegment(docWriter->getDocStoreSegment());
 
     // Test each segment to be merged: check if we need to flush/merge doc stores
     for (int32_t i = 0; i < end; ++i) {
@@ -2637,16 +2708,10 @@ void IndexWriter::_mergeInit(const OneMergePtr& merge) {
         if (lastDir != si->dir) {
             mergeDocStores = true;
         }
-
-        // If the segment is referencing the current "live" doc store outputs then we must merge
-        if (si->getDocStoreOffset() != -1 && !currentDocStoreSegment.empty() && si->getDocStoreSegment() == currentDocStoreSegment) {
-            doFlushDocStore = true;
-        }
     }
 
-    // if a mergedSegmentWarmer is installed, we must merge the doc stores because we will open a full
-    // SegmentReader on the merged segment
-    if (!mergeDocStores && mergedSegmentWarmer && !currentDocStoreSegment.empty() && !lastDocStoreSegment.empty() && lastDocStoreSegment == currentDocStoreSegment) {
+    // Sorting reorders the documents, so they can never keep the doc stores they share
+    if (indexSort) {
         mergeDocStores = true;
     }
 
@@ -2665,16 +2730,8 @@ void IndexWriter::_mergeInit(const OneMergePtr& merge) {
         docStoreIsCompoundFile = si->getDocStoreIsCompoundFile();
     }
 
-    if (mergeDocStores && doFlushDocStore) {
-        // SegmentMerger intends to merge the doc stores (stored fields, vectors), and at
-        // least one of the segments to be merged refers to the currently live doc stores.
-        if (infoStream) {
-            message(L"now flush at merge");
-        }
-        doFlush(true, false);
-    }
-
     merge->mergeDocStores = mergeDocStores;
+    merge->indexSort = indexSort;
 
     // Bind a new segment name here so even with ConcurrentMergePolicy we keep deterministic segment names.
     merge->info = newLucene<SegmentInfo>(newSegmentName(), 0, directory, false, true, docStoreOffset, docStoreSegment, docStoreIsCompoundFile, false);
@@ -2683,6 +2740,9 @@ void IndexWriter::_mergeInit(const OneMergePtr& merge) {
     details.put(L"optimize", StringUtils::toString(merge->optimize));
     details.put(L"mergeFactor", StringUtils::toString(end));
     details.put(L"mergeDocStores", StringUtils::toString(mergeDocStores));
+    if (indexSort) {
+        details.put(L"sort", indexSort->getIndexKey());
+    }
     setDiagnostics(merge->info, L"merge", details);
 
     // Also enroll the merged segment into mergingSegments; this prevents it from getting
@@ -2804,14 +2864,6 @@ int32_t IndexWriter::mergeMiddle(const OneMergePtr& merge) {
 
     bool mergeDocStores = false;
 
-    String currentDocStoreSegment;
-    {
-        SyncLock syncLock(this);
-        currentDocStoreSegment = docWriter->getDocStoreSegment();
-    }
-
-    bool currentDSSMerged = false;
-
     LuceneException finally;
     // This is try/finally to make sure merger's readers are closed
     bool success = false;
@@ -2820,8 +2872,9 @@ int32_t IndexWriter::mergeMiddle(const OneMergePtr& merge) {
         for (int32_t i = 0; i < numSegments; ++i) {
             SegmentInfoPtr info(sourceSegments->info(i));
 
-            // Hold onto the "live" reader; we will use this to commit merged deletes
-            merge->readers[i] = readerPool->get(info, merge->mergeDocStores, MERGE_READ_BUFFER_SIZE, -1);
+            // Hold onto the "live" reader; we will use this to commit merged deletes.  A sorted merge reads the
+            // sort values through the field cache, which needs the terms index
+            merge->readers[i] = readerPool->get(info, merge->mergeDocStores, MERGE_READ_BUFFER_SIZE, merge->indexSort ? readerTermsIndexDivisor : -1);
             SegmentReaderPtr reader(merge->readers[i]);
 
             // We clone the segment readers because other deletes may come in while we're merging so we need readers that will not change
@@ -2833,10 +2886,6 @@ int32_t IndexWriter::mergeMiddle(const OneMergePtr& merge) {
                 mergeDocStores = true;
             }
 
-            if (info->getDocStoreOffset() != -1 && !currentDocStoreSegment.empty()) {
-                currentDSSMerged = currentDSSMerged || (currentDocStoreSegment == info->getDocStoreSegment());
-            }
-
             totDocCount += clone->numDocs();
         }
 
@@ -2850,16 +2899,6 @@ int32_t IndexWriter::mergeMiddle(const OneMergePtr& merge) {
         if (mergeDocStores && !merge->mergeDocStores) {
             merge->mergeDocStores = true;
 
-            {
-                SyncLock syncLock(this);
-                if (currentDSSMerged) {
-                    if (infoStream) {
-                        message(L"now flush at mergeMiddle");
-                    }
-                    doFlush(true, false);
-                }
-            }
-
             for (Collection<SegmentReaderPtr>::iterator reader = merge->readersClone.begin(); reader != merge->readersClone.end(); ++reader) {
                 (*reader)->openDocStores();
             }
@@ -2933,11 +2972,7 @@ int32_t IndexWriter::mergeMiddle(const OneMergePtr& merge) {
         int32_t termsIndexDivisor = -1;
         bool loadDocStores = false;
 
-        // if the merged segment warmer was not installed when this merge was started, causing us
-        // to not force the docStores to close, we can't warm it now
-        bool canWarm = (merge->info->getDocStoreSegment().empty() || currentDocStoreSegment.empty() || merge->info->getDocStoreSegment() == currentDocStoreSegment);
-
-        if (poolReaders && mergedSegmentWarmer && canWarm) {
+        if (poolReaders && mergedSegmentWarmer) {
             // Load terms index & doc stores so the segment warmer can run searches, load documents/term vectors
             termsIndexDivisor = readerTermsIndexDivisor;
             loadDocStores = true;
@@ -3150,23 +3185,8 @@ void IndexWriter::startCommit(int64_t sizeInBytes, MapStringString commitUserDat
 
                 readerPool->commit();
 
-                // It's possible another flush (that did not close the open do stores) snook in after the flush we
-                // just did, so we remove any tail segments referencing the open doc store from the SegmentInfos
-                // we are about to sync (the main SegmentInfos will keep them)
                 toSync = std::dynamic_pointer_cast<SegmentInfos>(segmentInfos->clone());
 
-                String dss(docWriter->getDocStoreSegment());
-                if (!dss.empty()) {
-                    while (true) {
-                        String dss2(toSync->info(toSync->size() - 1)->getDocStoreSegment());
-                        if (dss2.empty() || dss2 != dss) {
-                            break;
-                        }
-                        toSync->remove(toSync->size() - 1);
-                        ++changeCount;
-                    }
-                }
-
                 if (commitUserData) {
                     toSync->setUserData(commitUserData);
                 }
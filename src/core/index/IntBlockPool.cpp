@@ -7,10 +7,11 @@
 #include "LuceneInc.h"
 #include "IntBlockPool.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 
 namespace Lucene {
 
-IntBlockPool::IntBlockPool(const DocumentsWriterPtr& docWriter, bool trackAllocations) {
+IntBlockPool::IntBlockPool(const DocumentsWriterPerThreadPtr& docWriter, bool trackAllocations) {
     this->buffers = Collection<IntArray>::newInstance(10);
     this->bufferUpto = -1;
     this->intUpto = DocumentsWriter::INT_BLOCK_SIZE;
@@ -26,7 +27,7 @@ void IntBlockPool::reset() {
     if (bufferUpto != -1) {
         if (bufferUpto > 0) {
             // Recycle all but the first buffer
-            DocumentsWriterPtr(_docWriter)->recycleIntBlocks(buffers, 1, 1 + bufferUpto);
+            DocumentsWriterPerThreadPtr(_docWriter)->recycleIntBlocks(buffers, 1, 1 + bufferUpto);
         }
 
         // Reuse first buffer
@@ -41,7 +42,7 @@ void IntBlockPool::nextBuffer() {
     if (bufferUpto + 1 == buffers.size()) {
         buffers.resize((int32_t)((double)buffers.size() * 1.5));
     }
-    buffer = DocumentsWriterPtr(_docWriter)->getIntBlock(trackAllocations);
+    buffer = DocumentsWriterPerThreadPtr(_docWriter)->getIntBlock(trackAllocations);
     buffers[1 + bufferUpto] = buffer;
     ++bufferUpto;
 
@@ -0,0 +1,262 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include <chrono>
+#include "MergeRateLimiter.h"
+#include "_MergeRateLimiter.h"
+#include "LuceneThread.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+const double MergeRateLimiter::DEFAULT_MIN_MB_PER_SEC = 5.0;
+const double MergeRateLimiter::DEFAULT_MAX_MB_PER_SEC = 1024.0;
+const int32_t MergeRateLimiter::ADJUST_INTERVAL_MILLIS = 100;
+const int32_t MergeRateLimiter::MIN_PAUSE_MILLIS = 1;
+
+MergeRateLimiter::MergeRateLimiter(double mbPerSec) {
+    minMBPerSec = DEFAULT_MIN_MB_PER_SEC;
+    maxMBPerSec = DEFAULT_MAX_MB_PER_SEC;
+    lastNS = 0;
+    targetLatency = 0;
+    averageLatency = 0.0;
+    lastAdjustNS = 0;
+    setMBPerSec(mbPerSec);
+}
+
+MergeRateLimiter::~MergeRateLimiter() {
+}
+
+int64_t MergeRateLimiter::nanoTime() {
+    return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void MergeRateLimiter::setMBPerSec(double mbPerSec) {
+    if (mbPerSec < 0.0) {
+        boost::throw_exception(IllegalArgumentException(L"mbPerSec must be >= 0.0; got " + StringUtils::toString(mbPerSec)));
+    }
+    SyncLock syncLock(this);
+    setRate(mbPerSec);
+}
+
+void MergeRateLimiter::setRate(double mbPerSec) {
+    this->mbPerSec = mbPerSec;
+    nsPerByte = mbPerSec > 0.0 ? (1000000000.0 / (mbPerSec * 1024.0 * 1024.0)) : 0.0;
+}
+
+double MergeRateLimiter::getMBPerSec() {
+    SyncLock syncLock(this);
+    return mbPerSec;
+}
+
+void MergeRateLimiter::setMBPerSecRange(double minMBPerSec, double maxMBPerSec) {
+    if (minMBPerSec <= 0.0 || maxMBPerSec < minMBPerSec) {
+        boost::throw_exception(IllegalArgumentException(L"invalid MB/sec range " + StringUtils::toString(minMBPerSec) + L" .. " + StringUtils::toString(maxMBPerSec)));
+    }
+    SyncLock syncLock(this);
+    this->minMBPerSec = minMBPerSec;
+    this->maxMBPerSec = maxMBPerSec;
+    if (mbPerSec > 0.0 && targetLatency > 0) {
+        setRate(std::min(maxMBPerSec, std::max(minMBPerSec, mbPerSec)));
+    }
+}
+
+double MergeRateLimiter::getMinMBPerSec() {
+    SyncLock syncLock(this);
+    return minMBPerSec;
+}
+
+double MergeRateLimiter::getMaxMBPerSec() {
+    SyncLock syncLock(this);
+    return maxMBPerSec;
+}
+
+void MergeRateLimiter::setTargetLatency(int64_t micros) {
+    if (micros < 0) {
+        boost::throw_exception(IllegalArgumentException(L"target latency must be >= 0; got " + StringUtils::toString(micros)));
+    }
+    SyncLock syncLock(this);
+    targetLatency = micros;
+    if (targetLatency > 0 && mbPerSec == 0.0) {
+        // adapting starts from the fastest allowed rate and backs off from there
+        setRate(maxMBPerSec);
+    }
+}
+
+int64_t MergeRateLimiter::getTargetLatency() {
+    SyncLock syncLock(this);
+    return targetLatency;
+}
+
+void MergeRateLimiter::observeLatency(int64_t micros) {
+    SyncLock syncLock(this);
+    if (averageLatency == 0.0) {
+        averageLatency = (double)micros;
+    } else {
+        averageLatency += ((double)micros - averageLatency) / 8.0;
+    }
+    if (targetLatency <= 0) {
+        return;
+    }
+    int64_t now = nanoTime();
+    if (lastAdjustNS != 0 && now - lastAdjustNS < (int64_t)ADJUST_INTERVAL_MILLIS * 1000000) {
+        return;
+    }
+    lastAdjustNS = now;
+    if (averageLatency > (double)targetLatency) {
+        setRate(std::max(minMBPerSec, mbPerSec / 2.0));
+    } else {
+        setRate(std::min(maxMBPerSec, mbPerSec * 1.2));
+    }
+}
+
+double MergeRateLimiter::getAverageLatency() {
+    SyncLock syncLock(this);
+    return averageLatency;
+}
+
+int64_t MergeRateLimiter::pause(int64_t bytes) {
+    int64_t now;
+    int64_t target;
+    {
+        SyncLock syncLock(this);
+        if (mbPerSec <= 0.0) {
+            return 0;
+        }
+        now = nanoTime();
+        // idle time does not build up credit, but pauses too short to sleep for are carried over
+        target = std::max(lastNS, now) + (int64_t)((double)bytes * nsPerByte);
+        lastNS = target;
+    }
+    int64_t pauseMillis = (target - now) / 1000000;
+    if (pauseMillis < MIN_PAUSE_MILLIS) {
+        return 0;
+    }
+    LuceneThread::threadSleep((int32_t)pauseMillis);
+    return pauseMillis;
+}
+
+RateLimitedDirectory::RateLimitedDirectory(const DirectoryPtr& directory, const MergeRateLimiterPtr& rateLimiter) {
+    this->directory = directory;
+    this->rateLimiter = rateLimiter;
+    this->lockFactory = directory->getLockFactory();
+}
+
+RateLimitedDirectory::~RateLimitedDirectory() {
+}
+
+DirectoryPtr RateLimitedDirectory::getDelegate() {
+    return directory;
+}
+
+HashSet<String> RateLimitedDirectory::listAll() {
+    return directory->listAll();
+}
+
+bool RateLimitedDirectory::fileExists(const String& name) {
+    return directory->fileExists(name);
+}
+
+uint64_t RateLimitedDirectory::fileModified(const String& name) {
+    return directory->fileModified(name);
+}
+
+void RateLimitedDirectory::touchFile(const String& name) {
+    directory->touchFile(name);
+}
+
+void RateLimitedDirectory::deleteFile(const String& name) {
+    directory->deleteFile(name);
+}
+
+int64_t RateLimitedDirectory::fileLength(const String& name) {
+    return directory->fileLength(name);
+}
+
+IndexOutputPtr RateLimitedDirectory::createOutput(const String& name) {
+    return newLucene<RateLimitedIndexOutput>(directory->createOutput(name), rateLimiter);
+}
+
+IndexInputPtr RateLimitedDirectory::openInput(const String& name) {
+    return directory->openInput(name);
+}
+
+IndexInputPtr RateLimitedDirectory::openInput(const String& name, int32_t bufferSize) {
+    return directory->openInput(name, bufferSize);
+}
+
+void RateLimitedDirectory::sync(const String& name) {
+    directory->sync(name);
+}
+
+LockPtr RateLimitedDirectory::makeLock(const String& name) {
+    return directory->makeLock(name);
+}
+
+String RateLimitedDirectory::getLockID() {
+    return directory->getLockID();
+}
+
+void RateLimitedDirectory::close() {
+    // the wrapped directory belongs to the writer
+}
+
+String RateLimitedDirectory::toString() {
+    return L"RateLimitedDirectory(" + directory->toString() + L")";
+}
+
+RateLimitedIndexOutput::RateLimitedIndexOutput(const IndexOutputPtr& output, const MergeRateLimiterPtr& rateLimiter) {
+    this->output = output;
+    this->rateLimiter = rateLimiter;
+}
+
+RateLimitedIndexOutput::~RateLimitedIndexOutput() {
+}
+
+void RateLimitedIndexOutput::flushBuffer(const uint8_t* b, int32_t offset, int32_t length) {
+    rateLimiter->pause(length);
+    output->writeBytes(b, offset, length);
+}
+
+void RateLimitedIndexOutput::flush() {
+    LuceneException finally;
+    try {
+        BufferedIndexOutput::flush();
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    output->flush();
+    finally.throwException();
+}
+
+void RateLimitedIndexOutput::close() {
+    LuceneException finally;
+    try {
+        BufferedIndexOutput::close();
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    output->close();
+    finally.throwException();
+}
+
+void RateLimitedIndexOutput::seek(int64_t pos) {
+    BufferedIndexOutput::seek(pos);
+    output->seek(pos);
+}
+
+int64_t RateLimitedIndexOutput::length() {
+    flush(); // the wrapped output has not seen the buffered bytes yet
+    return output->length();
+}
+
+void RateLimitedIndexOutput::setLength(int64_t length) {
+    flush();
+    output->setLength(length);
+}
+
+}
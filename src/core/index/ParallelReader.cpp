@@ -264,6 +264,18 @@ ByteArray ParallelReader::norms(const String& field) {
     return reader == fieldToReader.end() ? ByteArray() : reader->second->norms(field);
 }
 
+DocValuesColumnPtr ParallelReader::getDocValuesColumn(const String& field) {
+    ensureOpen();
+    MapStringIndexReader::iterator reader = fieldToReader.find(field);
+    return reader == fieldToReader.end() ? DocValuesColumnPtr() : reader->second->getDocValuesColumn(field);
+}
+
+PointValuesPtr ParallelReader::getPointValues(const String& field) {
+    ensureOpen();
+    MapStringIndexReader::iterator reader = fieldToReader.find(field);
+    return reader == fieldToReader.end() ? PointValuesPtr() : reader->second->getPointValues(field);
+}
+
 void ParallelReader::norms(const String& field, ByteArray norms, int32_t offset) {
     ensureOpen();
     MapStringIndexReader::iterator reader = fieldToReader.find(field);
@@ -272,6 +284,12 @@ void ParallelReader::norms(const String& field, ByteArray norms, int32_t offset)
     }
 }
 
+double ParallelReader::maxNorm(const String& field) {
+    ensureOpen();
+    MapStringIndexReader::iterator reader = fieldToReader.find(field);
+    return reader == fieldToReader.end() ? 1.0 : reader->second->maxNorm(field);
+}
+
 void ParallelReader::doSetNorm(int32_t doc, const String& field, uint8_t value) {
     ensureOpen();
     MapStringIndexReader::iterator reader = fieldToReader.find(field);
@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PointValues.h"
+#include "IndexInput.h"
+
+namespace Lucene {
+
+PointVisitor::~PointVisitor() {
+}
+
+PointValues::PointValues(const IndexInputPtr& input) {
+    this->input = input;
+    numDims = input->readVInt();
+    numLeaves = input->readVInt();
+    numPoints = input->readVLong();
+
+    leafPointers = Collection<int64_t>::newInstance(numLeaves);
+    minValues = Collection<int64_t>::newInstance(2 * numLeaves * numDims);
+    maxValues = Collection<int64_t>::newInstance(2 * numLeaves * numDims);
+    int64_t pointer = 0;
+    for (int32_t leaf = 0; leaf < numLeaves; ++leaf) {
+        pointer += input->readVLong();
+        leafPointers[leaf] = pointer;
+        int32_t offset = (numLeaves + leaf) * numDims;
+        for (int32_t dim = 0; dim < numDims; ++dim) {
+            minValues[offset + dim] = input->readLong();
+        }
+        for (int32_t dim = 0; dim < numDims; ++dim) {
+            maxValues[offset + dim] = input->readLong();
+        }
+    }
+
+    // the bounds of an inner cell are those of its children together
+    for (int32_t node = numLeaves - 1; node >= 1; --node) {
+        int32_t offset = node * numDims;
+        int32_t left = node * 2 * numDims;
+        int32_t right = (node * 2 + 1) * numDims;
+        for (int32_t dim = 0; dim < numDims; ++dim) {
+            minValues[offset + dim] = std::min(minValues[left + dim], minValues[right + dim]);
+            maxValues[offset + dim] = std::max(maxValues[left + dim], maxValues[right + dim]);
+        }
+    }
+}
+
+PointValues::~PointValues() {
+}
+
+int32_t PointValues::getNumDimensions() {
+    return numDims;
+}
+
+int64_t PointValues::size() {
+    return numPoints;
+}
+
+int64_t PointValues::getMinValue(int32_t dim) {
+    return minValues[numDims + dim];
+}
+
+int64_t PointValues::getMaxValue(int32_t dim) {
+    return maxValues[numDims + dim];
+}
+
+void PointValues::intersect(const PointVisitorPtr& visitor) {
+    IndexInputPtr in(std::dynamic_pointer_cast<IndexInput>(input->clone()));
+    Collection<int32_t> docs(Collection<int32_t>::newInstance());
+    Collection<int64_t> values(Collection<int64_t>::newInstance());
+    intersect(visitor, in, 1, docs, values);
+}
+
+void PointValues::intersect(const PointVisitorPtr& visitor, const IndexInputPtr& in, int32_t node, Collection<int32_t>& docs, Collection<int64_t>& values) {
+    PointVisitor::Relation relation = visitor->compare(&minValues[node * numDims], &maxValues[node * numDims]);
+    if (relation == PointVisitor::CELL_OUTSIDE_QUERY) {
+        return;
+    }
+    if (relation == PointVisitor::CELL_INSIDE_QUERY) {
+        // the leaves under a cell are consecutive, so walk down both edges of the subtree to find them
+        int32_t first = node;
+        int32_t last = node;
+        while (first < numLeaves) {
+            first = first * 2;
+            last = last * 2 + 1;
+        }
+        for (int32_t leaf = first - numLeaves; leaf <= last - numLeaves; ++leaf) {
+            int32_t count = readLeafDocs(in, leaf, docs);
+            for (int32_t i = 0; i < count; ++i) {
+                visitor->visit(docs[i]);
+            }
+        }
+        return;
+    }
+    if (node < numLeaves) {
+        intersect(visitor, in, node * 2, docs, values);
+        intersect(visitor, in, node * 2 + 1, docs, values);
+        return;
+    }
+
+    int32_t leaf = node - numLeaves;
+    int32_t count = readLeafDocs(in, leaf, docs);
+    readLeafValues(in, leaf, count, values);
+    for (int32_t i = 0; i < count; ++i) {
+        visitor->visit(docs[i], &values[i * numDims]);
+    }
+}
+
+int32_t PointValues::readLeafDocs(const IndexInputPtr& in, int32_t leaf, Collection<int32_t>& docs) {
+    in->seek(leafPointers[leaf]);
+    int32_t count = in->readVInt();
+    if (docs.size() < count) {
+        docs.resize(count);
+    }
+    int32_t doc = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        doc += in->readVInt();
+        docs[i] = doc;
+    }
+    return count;
+}
+
+void PointValues::readLeafValues(const IndexInputPtr& in, int32_t leaf, int32_t count, Collection<int64_t>& values) {
+    if (values.size() < count * numDims) {
+        values.resize(count * numDims);
+    }
+    const int64_t* leafMinValues = &minValues[(numLeaves + leaf) * numDims];
+    for (int32_t dim = 0; dim < numDims; ++dim) {
+        for (int32_t i = 0; i < count; ++i) {
+            values[i * numDims + dim] = (int64_t)((uint64_t)leafMinValues[dim] + (uint64_t)in->readVLong());
+        }
+    }
+}
+
+}
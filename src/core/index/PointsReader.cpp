@@ -0,0 +1,79 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PointsReader.h"
+#include "PointsWriter.h"
+#include "PointValues.h"
+#include "IndexFileNames.h"
+#include "IndexInput.h"
+#include "Directory.h"
+#include "FieldInfo.h"
+#include "FieldInfos.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+PointsReader::PointsReader(const DirectoryPtr& dir, const String& segment, const FieldInfosPtr& fieldInfos, int32_t readBufferSize) {
+    this->fieldInfos = fieldInfos;
+    values = Collection<PointValuesPtr>::newInstance(fieldInfos->size());
+
+    input = dir->openInput(segment + L"." + IndexFileNames::POINTS_EXTENSION(), readBufferSize);
+    bool success = false;
+    LuceneException finally;
+    try {
+        int32_t format = input->readInt();
+        if (format != PointsWriter::FORMAT_CURRENT) {
+            boost::throw_exception(CorruptIndexException(L"unknown points format version: " + StringUtils::toString(format)));
+        }
+        input->seek(input->length() - 8);
+        input->seek(input->readLong());
+        int32_t numFields = input->readVInt();
+        Collection<int32_t> numbers(Collection<int32_t>::newInstance(numFields));
+        Collection<int64_t> pointers(Collection<int64_t>::newInstance(numFields));
+        for (int32_t i = 0; i < numFields; ++i) {
+            numbers[i] = input->readVInt();
+            pointers[i] = input->readVLong();
+        }
+        for (int32_t i = 0; i < numFields; ++i) {
+            FieldInfoPtr fi(fieldInfos->fieldInfo(numbers[i]));
+            input->seek(pointers[i]);
+            PointValuesPtr tree(newLucene<PointValues>(input));
+            if (!fi || fi->pointDimensions != tree->getNumDimensions()) {
+                boost::throw_exception(CorruptIndexException(L"points of field " + StringUtils::toString(numbers[i]) + L" do not match the field infos"));
+            }
+            values[numbers[i]] = tree;
+        }
+        success = true;
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    if (!success) {
+        close();
+    }
+    finally.throwException();
+}
+
+PointsReader::~PointsReader() {
+}
+
+PointValuesPtr PointsReader::getPointValues(const String& field) {
+    FieldInfoPtr fi(fieldInfos->fieldInfo(field));
+    if (!fi || fi->number >= values.size()) {
+        return PointValuesPtr();
+    }
+    return values[fi->number];
+}
+
+void PointsReader::close() {
+    SyncLock syncLock(this);
+    if (input) {
+        input->close();
+        input.reset();
+    }
+}
+
+}
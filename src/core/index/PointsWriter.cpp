@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PointsWriter.h"
+#include "PointsWriterPerThread.h"
+#include "SegmentWriteState.h"
+#include "IndexFileNames.h"
+#include "IndexOutput.h"
+#include "Directory.h"
+#include "FieldInfo.h"
+#include "FieldInfos.h"
+
+namespace Lucene {
+
+/// Orders the points of a field by their value in one dimension.
+struct lessPointValue {
+    lessPointValue(const int64_t* values, int32_t numDims, int32_t dim) : values(values), numDims(numDims), dim(dim) {}
+    inline bool operator()(int32_t first, int32_t second) const {
+        return values[first * numDims + dim] < values[second * numDims + dim];
+    }
+    const int64_t* values;
+    int32_t numDims;
+    int32_t dim;
+};
+
+/// Orders the points of a field by their document.
+struct lessPointDoc {
+    lessPointDoc(const int32_t* docs) : docs(docs) {}
+    inline bool operator()(int32_t first, int32_t second) const {
+        return docs[first] < docs[second];
+    }
+    const int32_t* docs;
+};
+
+const int32_t PointsWriter::FORMAT_CURRENT = -1;
+const int32_t PointsWriter::MAX_POINTS_IN_LEAF = 512;
+
+PointsWriter::PointsWriter(const FieldInfosPtr& fieldInfos) {
+    this->fieldInfos = fieldInfos;
+}
+
+PointsWriter::~PointsWriter() {
+}
+
+PointsWriterPerThreadPtr PointsWriter::addThread(const DocStatePtr& docState) {
+    return newLucene<PointsWriterPerThread>(docState);
+}
+
+void PointsWriter::flush(Collection<PointsWriterPerThreadPtr> threads, const SegmentWriteStatePtr& state) {
+    if (!fieldInfos->hasPoints()) {
+        return;
+    }
+    String fileName(state->segmentFileName(IndexFileNames::POINTS_EXTENSION()));
+    IndexOutputPtr output(state->directory->createOutput(fileName));
+    LuceneException finally;
+    try {
+        writeHeader(output);
+        Collection<FieldInfoPtr> fields(Collection<FieldInfoPtr>::newInstance());
+        Collection<int64_t> pointers(Collection<int64_t>::newInstance());
+        for (int32_t number = 0; number < fieldInfos->size(); ++number) {
+            FieldInfoPtr fi(fieldInfos->fieldInfo(number));
+            if (fi->pointDimensions == 0) {
+                continue;
+            }
+
+            // gather the points buffered by every thread
+            Collection<int32_t> docs(Collection<int32_t>::newInstance());
+            Collection<int64_t> values(Collection<int64_t>::newInstance());
+            for (Collection<PointsWriterPerThreadPtr>::iterator thread = threads.begin(); thread != threads.end(); ++thread) {
+                if (number < (*thread)->docs.size() && (*thread)->docs[number]) {
+                    docs.addAll((*thread)->docs[number].begin(), (*thread)->docs[number].end());
+                    values.addAll((*thread)->values[number].begin(), (*thread)->values[number].end());
+                }
+            }
+            if (docs.empty()) {
+                continue;
+            }
+            fields.add(fi);
+            pointers.add(writeField(output, fi->pointDimensions, docs, values));
+        }
+        writeDirectory(output, fields, pointers);
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    output->close();
+    finally.throwException();
+
+    for (Collection<PointsWriterPerThreadPtr>::iterator thread = threads.begin(); thread != threads.end(); ++thread) {
+        (*thread)->reset();
+    }
+    state->flushedFiles.add(fileName);
+}
+
+void PointsWriter::writeHeader(const IndexOutputPtr& output) {
+    output->writeInt(FORMAT_CURRENT);
+}
+
+int64_t PointsWriter::writeField(const IndexOutputPtr& output, int32_t numDims, Collection<int32_t> docs, Collection<int64_t> values) {
+    int32_t numPoints = docs.size();
+    int32_t numLeaves = 1;
+    while ((int64_t)numLeaves * MAX_POINTS_IN_LEAF < numPoints) {
+        numLeaves <<= 1;
+    }
+
+    Collection<int32_t> ords(Collection<int32_t>::newInstance(numPoints));
+    for (int32_t i = 0; i < numPoints; ++i) {
+        ords[i] = i;
+    }
+    Collection<int64_t> leafPointers(Collection<int64_t>::newInstance(numLeaves));
+    Collection<int64_t> leafBounds(Collection<int64_t>::newInstance(numLeaves * 2 * numDims));
+    build(output, numDims, numLeaves, 1, docs, values, ords, 0, numPoints, leafPointers, leafBounds);
+
+    int64_t treePointer = output->getFilePointer();
+    output->writeVInt(numDims);
+    output->writeVInt(numLeaves);
+    output->writeVLong(numPoints);
+    int64_t lastPointer = 0;
+    for (int32_t leaf = 0; leaf < numLeaves; ++leaf) {
+        output->writeVLong(leafPointers[leaf] - lastPointer);
+        lastPointer = leafPointers[leaf];
+        for (int32_t i = 0; i < 2 * numDims; ++i) {
+            output->writeLong(leafBounds[leaf * 2 * numDims + i]);
+        }
+    }
+    return treePointer;
+}
+
+void PointsWriter::build(const IndexOutputPtr& output, int32_t numDims, int32_t numLeaves, int32_t node, Collection<int32_t> docs, Collection<int64_t> values,
+                         Collection<int32_t> ords, int32_t from, int32_t to, Collection<int64_t> leafPointers, Collection<int64_t> leafBounds) {
+    if (node >= numLeaves) {
+        writeLeaf(output, numDims, node - numLeaves, docs, values, ords, from, to, leafPointers, leafBounds);
+        return;
+    }
+
+    // split along the dimension whose values are spread the widest, comparing spreads as unsigned so
+    // the full range of a long does not overflow
+    int32_t splitDim = 0;
+    uint64_t widest = 0;
+    for (int32_t dim = 0; dim < numDims; ++dim) {
+        int64_t minValue = values[ords[from] * numDims + dim];
+        int64_t maxValue = minValue;
+        for (int32_t i = from + 1; i < to; ++i) {
+            int64_t value = values[ords[i] * numDims + dim];
+            minValue = std::min(minValue, value);
+            maxValue = std::max(maxValue, value);
+        }
+        uint64_t spread = (uint64_t)maxValue - (uint64_t)minValue;
+        if (dim == 0 || spread > widest) {
+            splitDim = dim;
+            widest = spread;
+        }
+    }
+
+    int32_t mid = from + (to - from) / 2;
+    std::nth_element(ords.begin() + from, ords.begin() + mid, ords.begin() + to, lessPointValue(&values[0], numDims, splitDim));
+    build(output, numDims, numLeaves, node * 2, docs, values, ords, from, mid, leafPointers, leafBounds);
+    build(output, numDims, numLeaves, node * 2 + 1, docs, values, ords, mid, to, leafPointers, leafBounds);
+}
+
+void PointsWriter::writeLeaf(const IndexOutputPtr& output, int32_t numDims, int32_t leaf, Collection<int32_t> docs, Collection<int64_t> values,
+                             Collection<int32_t> ords, int32_t from, int32_t to, Collection<int64_t> leafPointers, Collection<int64_t> leafBounds) {
+    std::sort(ords.begin() + from, ords.begin() + to, lessPointDoc(&docs[0]));
+    leafPointers[leaf] = output->getFilePointer();
+
+    int64_t* minValues = &leafBounds[leaf * 2 * numDims];
+    int64_t* maxValues = minValues + numDims;
+    for (int32_t dim = 0; dim < numDims; ++dim) {
+        minValues[dim] = values[ords[from] * numDims + dim];
+        maxValues[dim] = minValues[dim];
+        for (int32_t i = from + 1; i < to; ++i) {
+            int64_t value = values[ords[i] * numDims + dim];
+            minValues[dim] = std::min(minValues[dim], value);
+            maxValues[dim] = std::max(maxValues[dim], value);
+        }
+    }
+
+    output->writeVInt(to - from);
+    int32_t lastDoc = 0;
+    for (int32_t i = from; i < to; ++i) {
+        output->writeVInt(docs[ords[i]] - lastDoc);
+        lastDoc = docs[ords[i]];
+    }
+    for (int32_t dim = 0; dim < numDims; ++dim) {
+        for (int32_t i = from; i < to; ++i) {
+            output->writeVLong((int64_t)((uint64_t)values[ords[i] * numDims + dim] - (uint64_t)minValues[dim]));
+        }
+    }
+}
+
+void PointsWriter::writeDirectory(const IndexOutputPtr& output, Collection<FieldInfoPtr> fields, Collection<int64_t> pointers) {
+    int64_t directoryPointer = output->getFilePointer();
+    output->writeVInt(fields.size());
+    for (int32_t i = 0; i < fields.size(); ++i) {
+        output->writeVInt(fields[i]->number);
+        output->writeVLong(pointers[i]);
+    }
+    output->writeLong(directoryPointer);
+}
+
+}
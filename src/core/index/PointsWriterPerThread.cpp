@@ -0,0 +1,53 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PointsWriterPerThread.h"
+#include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
+#include "FieldInfo.h"
+
+namespace Lucene {
+
+PointsWriterPerThread::PointsWriterPerThread(const DocStatePtr& docState) {
+    this->docState = docState;
+    docs = Collection< Collection<int32_t> >::newInstance();
+    values = Collection< Collection<int64_t> >::newInstance();
+}
+
+PointsWriterPerThread::~PointsWriterPerThread() {
+}
+
+void PointsWriterPerThread::addField(Collection<int64_t> point, const FieldInfoPtr& fieldInfo) {
+    int32_t number = fieldInfo->number;
+    if (number >= docs.size()) {
+        docs.resize(number + 1);
+        values.resize(number + 1);
+    }
+    if (!docs[number]) {
+        docs[number] = Collection<int32_t>::newInstance();
+        values[number] = Collection<int64_t>::newInstance();
+    }
+    docs[number].add(docState->docID);
+    values[number].addAll(point.begin(), point.end());
+
+    // the buffered points count towards the RAM that triggers a flush
+    DocumentsWriterPerThreadPtr docWriter(docState->_docWriter.lock());
+    if (docWriter) {
+        docWriter->pointsBytesUsed(DocumentsWriter::INT_NUM_BYTE + point.size() * sizeof(int64_t));
+    }
+}
+
+void PointsWriterPerThread::reset() {
+    docs.clear();
+    values.clear();
+}
+
+void PointsWriterPerThread::abort() {
+    reset();
+}
+
+}
@@ -39,6 +39,7 @@ SegmentInfo::SegmentInfo(const String& name, int32_t docCount, const DirectoryPt
     docStoreIsCompoundFile = false;
     delCount = 0;
     hasProx = true;
+    packedPostings = false;
 }
 
 SegmentInfo::SegmentInfo(const String& name, int32_t docCount, const DirectoryPtr& dir, bool isCompoundFile, bool hasSingleNormFile) {
@@ -54,6 +55,7 @@ SegmentInfo::SegmentInfo(const String& name, int32_t docCount, const DirectoryPt
     docStoreIsCompoundFile = false;
     delCount = 0;
     hasProx = true;
+    packedPostings = false;
 }
 
 SegmentInfo::SegmentInfo(const String& name, int32_t docCount, const DirectoryPtr& dir, bool isCompoundFile, bool hasSingleNormFile,
@@ -71,6 +73,7 @@ SegmentInfo::SegmentInfo(const String& name, int32_t docCount, const DirectoryPt
     this->docStoreIsCompoundFile = docStoreIsCompoundFile;
     delCount = 0;
     this->hasProx = hasProx;
+    packedPostings = false;
 }
 
 SegmentInfo::SegmentInfo(const DirectoryPtr& dir, int32_t format, const IndexInputPtr& input) {
@@ -120,6 +123,12 @@ SegmentInfo::SegmentInfo(const DirectoryPtr& dir, int32_t format, const IndexInp
             hasProx = true;
         }
 
+        if (format <= SegmentInfos::FORMAT_PACKED_POSTINGS) {
+            packedPostings = (input->readByte() == 1);
+        } else {
+            packedPostings = false;
+        }
+
         if (format <= SegmentInfos::FORMAT_DIAGNOSTICS) {
             diagnostics = input->readStringStringMap();
         } else {
@@ -134,6 +143,7 @@ SegmentInfo::SegmentInfo(const DirectoryPtr& dir, int32_t format, const IndexInp
         docStoreIsCompoundFile = false;
         delCount = -1;
         hasProx = true;
+        packedPostings = false;
         diagnostics = MapStringString::newInstance();
     }
 }
@@ -158,6 +168,7 @@ void SegmentInfo::reset(const SegmentInfoPtr& src) {
     isCompoundFile = src->isCompoundFile;
     hasSingleNormFile = src->hasSingleNormFile;
     delCount = src->delCount;
+    packedPostings = src->packedPostings;
 }
 
 void SegmentInfo::setDiagnostics(MapStringString diagnostics) {
@@ -231,6 +242,7 @@ LuceneObjectPtr SegmentInfo::clone(const LuceneObjectPtr& other) {
     si->delGen = delGen;
     si->delCount = delCount;
     si->hasProx = hasProx;
+    si->packedPostings = packedPostings;
     si->preLockless = preLockless;
     si->hasSingleNormFile = hasSingleNormFile;
     si->diagnostics = MapStringString::newInstance();
@@ -411,6 +423,7 @@ void SegmentInfo::write(const IndexOutputPtr& output) {
     output->writeByte(isCompoundFile);
     output->writeInt(delCount);
     output->writeByte((uint8_t)(hasProx ? 1 : 0));
+    output->writeByte((uint8_t)(packedPostings ? 1 : 0));
     output->writeStringStringMap(diagnostics);
 }
 
@@ -423,6 +436,14 @@ bool SegmentInfo::getHasProx() {
     return hasProx;
 }
 
+void SegmentInfo::setPackedPostings(bool packedPostings) {
+    this->packedPostings = packedPostings;
+}
+
+bool SegmentInfo::getPackedPostings() {
+    return packedPostings;
+}
+
 void SegmentInfo::addIfExists(HashSet<String> files, const String& fileName) {
     if (dir->fileExists(fileName)) {
         files.add(fileName);
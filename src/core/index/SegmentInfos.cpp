@@ -52,8 +52,12 @@ const int32_t SegmentInfos::FORMAT_USER_DATA = -8;
 /// This format adds optional per-segment string diagnostics storage, and switches userData to Map
 const int32_t SegmentInfos::FORMAT_DIAGNOSTICS = -9;
 
+/// This format adds the boolean packedPostings to record if the segment's doc deltas and freqs are written
+/// in bit-packed blocks
+const int32_t SegmentInfos::FORMAT_PACKED_POSTINGS = -10;
+
 /// This must always point to the most recent file format.
-const int32_t SegmentInfos::CURRENT_FORMAT = SegmentInfos::FORMAT_DIAGNOSTICS;
+const int32_t SegmentInfos::CURRENT_FORMAT = SegmentInfos::FORMAT_PACKED_POSTINGS;
 
 /// Advanced configuration of retry logic in loading segments_N file.
 int32_t SegmentInfos::defaultGenFileRetryCount = 10;
@@ -6,6 +6,8 @@
 
 #include "LuceneInc.h"
 #include "SegmentMerger.h"
+#include "_SegmentMerger.h"
+#include "_MergeRateLimiter.h"
 #include "MergePolicy.h"
 #include "IndexWriter.h"
 #include "IndexOutput.h"
@@ -13,6 +15,9 @@
 #include "FieldInfo.h"
 #include "FieldsReader.h"
 #include "FieldsWriter.h"
+#include "DocValuesWriter.h"
+#include "DocValuesColumn.h"
+#include "PointsWriter.h"
 #include "IndexFileNames.h"
 #include "CompoundFileWriter.h"
 #include "SegmentReader.h"
@@ -27,9 +32,13 @@
 #include "FormatPostingsTermsConsumer.h"
 #include "SegmentMergeInfo.h"
 #include "SegmentMergeQueue.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "FieldComparator.h"
 #include "SegmentWriteState.h"
 #include "TestPoint.h"
 #include "MiscUtils.h"
+#include "NumericUtils.h"
 #include "StringUtils.h"
 
 namespace Lucene {
@@ -41,12 +50,33 @@ const int32_t SegmentMerger::MAX_RAW_MERGE_DOCS = 4192;
 const uint8_t SegmentMerger::NORMS_HEADER[] = {'N', 'R', 'M', static_cast<uint8_t>(-1) };
 const int32_t SegmentMerger::NORMS_HEADER_LENGTH = 4;
 
+/// Orders comparator slots by the index sort
+struct lessIndexSortSlot {
+    lessIndexSortSlot(Collection<FieldComparatorPtr> comparators, Collection<int32_t> reverseMul) : comparators(comparators), reverseMul(reverseMul) {
+    }
+
+    Collection<FieldComparatorPtr> comparators;
+    Collection<int32_t> reverseMul;
+
+    inline bool operator()(int32_t first, int32_t second) const {
+        for (int32_t i = 0; i < comparators.size(); ++i) {
+            int32_t c = reverseMul[i] * comparators[i]->compare(first, second);
+            if (c != 0) {
+                return (c < 0);
+            }
+        }
+        return false;
+    }
+};
+
 SegmentMerger::SegmentMerger(const DirectoryPtr& dir, const String& name) {
     readers = Collection<IndexReaderPtr>::newInstance();
     termIndexInterval = IndexWriter::DEFAULT_TERM_INDEX_INTERVAL;
+    packedPostings = false;
     mergedDocs = 0;
     mergeDocStores = false;
     omitTermFreqAndPositions = false;
+    payloadsUpto = 0;
 
     directory = dir;
     segment = name;
@@ -58,16 +88,23 @@ SegmentMerger::SegmentMerger(const IndexWriterPtr& writer, const String& name, c
     mergedDocs = 0;
     mergeDocStores = false;
     omitTermFreqAndPositions = false;
+    payloadsUpto = 0;
 
     directory = writer->getDirectory();
     segment = name;
 
     if (merge) {
         checkAbort = newLucene<CheckAbort>(merge, directory);
+        if (merge->rateLimiter) {
+            directory = newLucene<RateLimitedDirectory>(directory, merge->rateLimiter);
+        }
+        executor = merge->executor;
+        indexSort = merge->indexSort;
     } else {
         checkAbort = newLucene<CheckAbortNull>();
     }
     termIndexInterval = writer->getTermIndexInterval();
+    packedPostings = writer->getUsePackedPostings();
 }
 
 SegmentMerger::~SegmentMerger() {
@@ -77,6 +114,10 @@ bool SegmentMerger::hasProx() {
     return fieldInfos->hasProx();
 }
 
+bool SegmentMerger::hasPackedPostings() {
+    return packedPostings;
+}
+
 void SegmentMerger::add(const IndexReaderPtr& reader) {
     readers.add(reader);
 }
@@ -95,9 +136,24 @@ int32_t SegmentMerger::merge(bool mergeDocStores) {
     // NOTE: it's important to add calls to checkAbort.work(...) if you make any changes to this method that will spend a lot of time.
     // The frequency of this check impacts how long IndexWriter.close(false) takes to actually stop the threads.
 
+    if (executor) {
+        mergeFieldInfos();
+        mergedDocs = 0;
+        for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+            mergedDocs += (*reader)->numDocs();
+        }
+        if (indexSort) {
+            sortDocuments();
+        }
+        mergeParts();
+        return mergedDocs;
+    }
+
     mergedDocs = mergeFields();
     mergeTerms();
     mergeNorms();
+    mergeDocValues();
+    mergePoints();
 
     if (mergeDocStores && fieldInfos->hasVectors()) {
         mergeVectors();
@@ -106,6 +162,42 @@ int32_t SegmentMerger::merge(bool mergeDocStores) {
     return mergedDocs;
 }
 
+void SegmentMerger::mergeParts() {
+    SegmentMergerPtr merger(std::static_pointer_cast<SegmentMerger>(shared_from_this()));
+    Collection<SegmentMergerPartPtr> parts(Collection<SegmentMergerPartPtr>::newInstance());
+
+    // postings are usually the largest part, so start them first
+    parts.add(newLucene<SegmentMergerPart>(merger, SegmentMergerPart::POSTINGS));
+    if (mergeDocStores) {
+        parts.add(newLucene<SegmentMergerPart>(merger, SegmentMergerPart::STORED_FIELDS));
+        if (fieldInfos->hasVectors()) {
+            parts.add(newLucene<SegmentMergerPart>(merger, SegmentMergerPart::VECTORS));
+        }
+    }
+    parts.add(newLucene<SegmentMergerPart>(merger, SegmentMergerPart::NORMS));
+    if (fieldInfos->hasDocValues()) {
+        parts.add(newLucene<SegmentMergerPart>(merger, SegmentMergerPart::DOC_VALUES));
+    }
+    if (fieldInfos->hasPoints()) {
+        parts.add(newLucene<SegmentMergerPart>(merger, SegmentMergerPart::POINTS));
+    }
+
+    for (Collection<SegmentMergerPartPtr>::iterator part = parts.begin(); part != parts.end(); ++part) {
+        executor->submit(part->get());
+    }
+
+    // every part must be joined before the parts go out of scope, even if one of them failed
+    LuceneException finally;
+    for (Collection<SegmentMergerPartPtr>::iterator part = parts.begin(); part != parts.end(); ++part) {
+        try {
+            (*part)->join();
+        } catch (LuceneException& e) {
+            finally = e;
+        }
+    }
+    finally.throwException();
+}
+
 void SegmentMerger::closeReaders() {
     for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
         (*reader)->close();
@@ -135,6 +227,14 @@ HashSet<String> SegmentMerger::getMergedFiles() {
         }
     }
 
+    if (fieldInfos->hasDocValues()) {
+        fileSet.add(segment + L"." + IndexFileNames::DOC_VALUES_EXTENSION());
+    }
+
+    if (fieldInfos->hasPoints()) {
+        fileSet.add(segment + L"." + IndexFileNames::POINTS_EXTENSION());
+    }
+
     // Vector files
     if (fieldInfos->hasVectors() && mergeDocStores) {
         for (HashSet<String>::iterator ext = IndexFileNames::VECTOR_EXTENSIONS().begin(); ext != IndexFileNames::VECTOR_EXTENSIONS().end(); ++ext) {
@@ -195,10 +295,122 @@ void SegmentMerger::setMatchingSegmentReaders() {
 
     // Used for bulk-reading raw bytes for stored fields
     rawDocLengths = Collection<int32_t>::newInstance(MAX_RAW_MERGE_DOCS);
-    rawDocLengths2 = Collection<int32_t>::newInstance(MAX_RAW_MERGE_DOCS);
+    rawVectorLengths = Collection<int32_t>::newInstance(MAX_RAW_MERGE_DOCS);
+    rawVectorLengths2 = Collection<int32_t>::newInstance(MAX_RAW_MERGE_DOCS);
 }
 
 int32_t SegmentMerger::mergeFields() {
+    mergeFieldInfos();
+    if (indexSort) {
+        sortDocuments();
+    }
+    return mergeStoredFields();
+}
+
+void SegmentMerger::sortDocuments() {
+    int32_t numReaders = readers.size();
+    int32_t numDocs = 0;
+    for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
+        numDocs += (*reader)->numDocs();
+    }
+
+    Collection<SortFieldPtr> fields(indexSort->getSort());
+    Collection<FieldComparatorPtr> comparators(Collection<FieldComparatorPtr>::newInstance(fields.size()));
+    Collection<int32_t> reverseMul(Collection<int32_t>::newInstance(fields.size()));
+    for (int32_t i = 0; i < fields.size(); ++i) {
+        comparators[i] = fields[i]->getComparator(numDocs, i);
+        reverseMul[i] = fields[i]->getReverse() ? -1 : 1;
+    }
+
+    // Every live document gets its own comparator slot, in the order of the readers
+    Collection<int32_t> slotReaders(Collection<int32_t>::newInstance(numDocs));
+    Collection<int32_t> slotDocs(Collection<int32_t>::newInstance(numDocs));
+    Collection<int32_t> order(Collection<int32_t>::newInstance(numDocs));
+    int32_t slot = 0;
+    int32_t docBase = 0;
+    for (int32_t i = 0; i < numReaders; ++i) {
+        IndexReaderPtr reader(readers[i]);
+        int32_t maxDoc = reader->maxDoc();
+        for (Collection<FieldComparatorPtr>::iterator comparator = comparators.begin(); comparator != comparators.end(); ++comparator) {
+            (*comparator)->setNextReader(reader, docBase);
+        }
+        for (int32_t doc = 0; doc < maxDoc; ++doc) {
+            if (reader->isDeleted(doc)) {
+                continue;
+            }
+            for (Collection<FieldComparatorPtr>::iterator comparator = comparators.begin(); comparator != comparators.end(); ++comparator) {
+                (*comparator)->copy(slot, doc);
+            }
+            slotReaders[slot] = i;
+            slotDocs[slot] = doc;
+            order[slot] = slot;
+            ++slot;
+        }
+        docBase += maxDoc;
+        checkAbort->work(maxDoc);
+    }
+    BOOST_ASSERT(slot == numDocs);
+
+    std::stable_sort(order.begin(), order.end(), lessIndexSortSlot(comparators, reverseMul));
+    checkAbort->work(numDocs);
+
+    // docMaps are relative to each reader's first merged document, as they are for merges that only
+    // remove deletions, so IndexWriter and MergeDocIDRemapper handle both the same way
+    docMaps = Collection< Collection<int32_t> >::newInstance(numReaders);
+    delCounts = Collection<int32_t>::newInstance(numReaders);
+    Collection<int32_t> starts(Collection<int32_t>::newInstance(numReaders));
+    int32_t start = 0;
+    for (int32_t i = 0; i < numReaders; ++i) {
+        int32_t maxDoc = readers[i]->maxDoc();
+        docMaps[i] = Collection<int32_t>::newInstance(maxDoc);
+        std::fill(docMaps[i].begin(), docMaps[i].end(), -1);
+        delCounts[i] = maxDoc - readers[i]->numDocs();
+        starts[i] = start;
+        start += readers[i]->numDocs();
+    }
+
+    sortedReaders = Collection<int32_t>::newInstance(numDocs);
+    sortedDocs = Collection<int32_t>::newInstance(numDocs);
+    for (int32_t doc = 0; doc < numDocs; ++doc) {
+        int32_t reader = slotReaders[order[doc]];
+        sortedReaders[doc] = reader;
+        sortedDocs[doc] = slotDocs[order[doc]];
+        docMaps[reader][sortedDocs[doc]] = doc - starts[reader];
+    }
+}
+
+bool SegmentMerger::isInOrder(const IndexReaderPtr& reader, const SortPtr& sort) {
+    Collection<SortFieldPtr> fields(sort->getSort());
+    Collection<FieldComparatorPtr> comparators(Collection<FieldComparatorPtr>::newInstance(fields.size()));
+    Collection<int32_t> reverseMul(Collection<int32_t>::newInstance(fields.size()));
+    for (int32_t i = 0; i < fields.size(); ++i) {
+        comparators[i] = fields[i]->getComparator(2, i);
+        reverseMul[i] = fields[i]->getReverse() ? -1 : 1;
+        comparators[i]->setNextReader(reader, 0);
+    }
+
+    // each live document goes into the slot the one before the last left, and is compared with the last
+    lessIndexSortSlot less(comparators, reverseMul);
+    int32_t slot = 0;
+    bool first = true;
+    int32_t maxDoc = reader->maxDoc();
+    for (int32_t doc = 0; doc < maxDoc; ++doc) {
+        if (reader->isDeleted(doc)) {
+            continue;
+        }
+        for (Collection<FieldComparatorPtr>::iterator comparator = comparators.begin(); comparator != comparators.end(); ++comparator) {
+            (*comparator)->copy(slot, doc);
+        }
+        if (!first && less(slot, 1 - slot)) {
+            return false;
+        }
+        first = false;
+        slot = 1 - slot;
+    }
+    return true;
+}
+
+void SegmentMerger::mergeFieldInfos() {
     if (!mergeDocStores) {
         // When we are not merging by doc stores, their field name -> number mapping are the same.
         // So, we start with the fieldInfos of the last segment in this case, to keep that numbering
@@ -214,9 +426,11 @@ int32_t SegmentMerger::mergeFields() {
             int32_t numReaderFieldInfos = readerFieldInfos->size();
             for (int32_t j = 0; j < numReaderFieldInfos; ++j) {
                 FieldInfoPtr fi(readerFieldInfos->fieldInfo(j));
-                fieldInfos->add(fi->name, fi->isIndexed, fi->storeTermVector, fi->storePositionWithTermVector,
-                                fi->storeOffsetWithTermVector, !(*reader)->hasNorms(fi->name), fi->storePayloads,
-                                fi->omitTermFreqAndPositions);
+                FieldInfoPtr mergedFieldInfo(fieldInfos->add(fi->name, fi->isIndexed, fi->storeTermVector, fi->storePositionWithTermVector,
+                                             fi->storeOffsetWithTermVector, !(*reader)->hasNorms(fi->name), fi->storePayloads,
+                                             fi->omitTermFreqAndPositions));
+                mergedFieldInfo->setDocValuesType(fi->docValuesType);
+                mergedFieldInfo->setPointDimensions(fi->pointDimensions);
             }
         } else {
             addIndexed(*reader, fieldInfos, (*reader)->getFieldNames(IndexReader::FIELD_OPTION_TERMVECTOR_WITH_POSITION_OFFSET), true, true, true, false, false);
@@ -231,9 +445,11 @@ int32_t SegmentMerger::mergeFields() {
     }
     fieldInfos->write(directory, segment + L".fnm");
 
-    int32_t docCount = 0;
-
     setMatchingSegmentReaders();
+}
+
+int32_t SegmentMerger::mergeStoredFields() {
+    int32_t docCount = 0;
 
     if (mergeDocStores) {
         // merge field values
@@ -241,20 +457,25 @@ int32_t SegmentMerger::mergeFields() {
 
         LuceneException finally;
         try {
-            int32_t idx = 0;
-            for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
-                SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[idx++]);
-                FieldsReaderPtr matchingFieldsReader;
+            Collection<FieldsReaderPtr> matchingFieldsReaders(Collection<FieldsReaderPtr>::newInstance(readers.size()));
+            for (int32_t i = 0; i < readers.size(); ++i) {
+                SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[i]);
                 if (matchingSegmentReader) {
                     FieldsReaderPtr fieldsReader(matchingSegmentReader->getFieldsReader());
                     if (fieldsReader && fieldsReader->canReadRawDocs()) {
-                        matchingFieldsReader = fieldsReader;
+                        matchingFieldsReaders[i] = fieldsReader;
                     }
                 }
-                if ((*reader)->hasDeletions()) {
-                    docCount += copyFieldsWithDeletions(fieldsWriter, *reader, matchingFieldsReader);
-                } else {
-                    docCount += copyFieldsNoDeletions(fieldsWriter, *reader, matchingFieldsReader);
+            }
+            if (sortedReaders) {
+                docCount = copyFieldsSorted(fieldsWriter, matchingFieldsReaders);
+            } else {
+                for (int32_t i = 0; i < readers.size(); ++i) {
+                    if (readers[i]->hasDeletions()) {
+                        docCount += copyFieldsWithDeletions(fieldsWriter, readers[i], matchingFieldsReaders[i]);
+                    } else {
+                        docCount += copyFieldsNoDeletions(fieldsWriter, readers[i], matchingFieldsReaders[i]);
+                    }
                 }
             }
         } catch (LuceneException& e) {
@@ -353,27 +574,54 @@ int32_t SegmentMerger::copyFieldsNoDeletions(const FieldsWriterPtr& fieldsWriter
     return docCount;
 }
 
+int32_t SegmentMerger::copyFieldsSorted(const FieldsWriterPtr& fieldsWriter, Collection<FieldsReaderPtr> matchingFieldsReaders) {
+    int32_t numDocs = sortedDocs.size();
+    for (int32_t docNum = 0; docNum < numDocs;) {
+        int32_t reader = sortedReaders[docNum];
+        int32_t start = sortedDocs[docNum];
+        int32_t len = 1;
+        if (matchingFieldsReaders[reader]) {
+            // Documents that are still next to each other after sorting are bulk-copied together
+            while (docNum + len < numDocs && len < MAX_RAW_MERGE_DOCS && sortedReaders[docNum + len] == reader && sortedDocs[docNum + len] == start + len) {
+                ++len;
+            }
+            IndexInputPtr stream(matchingFieldsReaders[reader]->rawDocs(rawDocLengths, start, len));
+            fieldsWriter->addRawDocuments(stream, rawDocLengths, len);
+        } else {
+            fieldsWriter->addDocument(readers[reader]->document(start));
+        }
+        docNum += len;
+        checkAbort->work(300 * len);
+    }
+    return numDocs;
+}
+
 void SegmentMerger::mergeVectors() {
     TermVectorsWriterPtr termVectorsWriter(newLucene<TermVectorsWriter>(directory, segment, fieldInfos));
 
     LuceneException finally;
     try {
-        int32_t idx = 0;
-        for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
-            SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[idx++]);
-            TermVectorsReaderPtr matchingVectorsReader;
+        Collection<TermVectorsReaderPtr> matchingVectorsReaders(Collection<TermVectorsReaderPtr>::newInstance(readers.size()));
+        for (int32_t i = 0; i < readers.size(); ++i) {
+            SegmentReaderPtr matchingSegmentReader(matchingSegmentReaders[i]);
             if (matchingSegmentReader) {
                 TermVectorsReaderPtr vectorsReader(matchingSegmentReader->getTermVectorsReaderOrig());
 
                 // If the TV* files are an older format then they cannot read raw docs
                 if (vectorsReader && vectorsReader->canReadRawDocs()) {
-                    matchingVectorsReader = vectorsReader;
+                    matchingVectorsReaders[i] = vectorsReader;
                 }
             }
-            if ((*reader)->hasDeletions()) {
-                copyVectorsWithDeletions(termVectorsWriter, matchingVectorsReader, *reader);
-            } else {
-                copyVectorsNoDeletions(termVectorsWriter, matchingVectorsReader, *reader);
+        }
+        if (sortedReaders) {
+            copyVectorsSorted(termVectorsWriter, matchingVectorsReaders);
+        } else {
+            for (int32_t i = 0; i < readers.size(); ++i) {
+                if (readers[i]->hasDeletions()) {
+                    copyVectorsWithDeletions(termVectorsWriter, matchingVectorsReaders[i], readers[i]);
+                } else {
+                    copyVectorsNoDeletions(termVectorsWriter, matchingVectorsReaders[i], readers[i]);
+                }
             }
         }
     } catch (LuceneException& e) {
@@ -419,8 +667,8 @@ void SegmentMerger::copyVectorsWithDeletions(const TermVectorsWriterPtr& termVec
                 }
             } while (numDocs < MAX_RAW_MERGE_DOCS);
 
-            matchingVectorsReader->rawDocs(rawDocLengths, rawDocLengths2, start, numDocs);
-            termVectorsWriter->addRawDocuments(matchingVectorsReader, rawDocLengths, rawDocLengths2, numDocs);
+            matchingVectorsReader->rawDocs(rawVectorLengths, rawVectorLengths2, start, numDocs);
+            termVectorsWriter->addRawDocuments(matchingVectorsReader, rawVectorLengths, rawVectorLengths2, numDocs);
             checkAbort->work(300 * numDocs);
         }
     } else {
@@ -444,8 +692,8 @@ void SegmentMerger::copyVectorsNoDeletions(const TermVectorsWriterPtr& termVecto
         int32_t docCount = 0;
         while (docCount < maxDoc) {
             int32_t len = std::min(MAX_RAW_MERGE_DOCS, maxDoc - docCount);
-            matchingVectorsReader->rawDocs(rawDocLengths, rawDocLengths2, docCount, len);
-            termVectorsWriter->addRawDocuments(matchingVectorsReader, rawDocLengths, rawDocLengths2, len);
+            matchingVectorsReader->rawDocs(rawVectorLengths, rawVectorLengths2, docCount, len);
+            termVectorsWriter->addRawDocuments(matchingVectorsReader, rawVectorLengths, rawVectorLengths2, len);
             docCount += len;
             checkAbort->work(300 * len);
         }
@@ -458,10 +706,31 @@ void SegmentMerger::copyVectorsNoDeletions(const TermVectorsWriterPtr& termVecto
     }
 }
 
+void SegmentMerger::copyVectorsSorted(const TermVectorsWriterPtr& termVectorsWriter, Collection<TermVectorsReaderPtr> matchingVectorsReaders) {
+    int32_t numDocs = sortedDocs.size();
+    for (int32_t docNum = 0; docNum < numDocs;) {
+        int32_t reader = sortedReaders[docNum];
+        int32_t start = sortedDocs[docNum];
+        int32_t len = 1;
+        if (matchingVectorsReaders[reader]) {
+            while (docNum + len < numDocs && len < MAX_RAW_MERGE_DOCS && sortedReaders[docNum + len] == reader && sortedDocs[docNum + len] == start + len) {
+                ++len;
+            }
+            matchingVectorsReaders[reader]->rawDocs(rawVectorLengths, rawVectorLengths2, start, len);
+            termVectorsWriter->addRawDocuments(matchingVectorsReaders[reader], rawVectorLengths, rawVectorLengths2, len);
+        } else {
+            termVectorsWriter->addAllDocVectors(readers[reader]->getTermFreqVectors(start));
+        }
+        docNum += len;
+        checkAbort->work(300 * len);
+    }
+}
+
 void SegmentMerger::mergeTerms() {
     TestScope testScope(L"SegmentMerger", L"mergeTerms");
 
-    SegmentWriteStatePtr state(newLucene<SegmentWriteState>(DocumentsWriterPtr(), directory, segment, L"", mergedDocs, 0, termIndexInterval));
+    SegmentWriteStatePtr state(newLucene<SegmentWriteState>(DocumentsWriterPerThreadPtr(), directory, segment, L"", mergedDocs, 0, termIndexInterval));
+    state->packedPostings = packedPostings;
 
     FormatPostingsFieldsConsumerPtr consumer(newLucene<FormatPostingsFieldsWriter>(state, fieldInfos));
 
@@ -486,8 +755,9 @@ void SegmentMerger::mergeTermInfos(const FormatPostingsFieldsConsumerPtr& consum
         IndexReaderPtr reader(readers[i]);
         TermEnumPtr termEnum(reader->terms());
         SegmentMergeInfoPtr smi(newLucene<SegmentMergeInfo>(base, termEnum, reader));
+        smi->ord = i;
         Collection<int32_t> docMap(smi->getDocMap());
-        if (docMap) {
+        if (docMap && !sortedReaders) {
             if (!docMaps) {
                 docMaps = Collection< Collection<int32_t> >::newInstance(readerCount);
                 delCounts = Collection<int32_t>::newInstance(readerCount);
@@ -534,7 +804,7 @@ void SegmentMerger::mergeTermInfos(const FormatPostingsFieldsConsumerPtr& consum
             omitTermFreqAndPositions = fieldInfo->omitTermFreqAndPositions;
         }
 
-        int32_t df = appendPostings(termsConsumer, match, matchSize); // add new TermInfo
+        int32_t df = sortedReaders ? appendSortedPostings(termsConsumer, match, matchSize) : appendPostings(termsConsumer, match, matchSize); // add new TermInfo
 
         checkAbort->work(df / 3.0);
 
@@ -603,6 +873,79 @@ int32_t SegmentMerger::appendPostings(const FormatPostingsTermsConsumerPtr& term
     return df;
 }
 
+int32_t SegmentMerger::appendSortedPostings(const FormatPostingsTermsConsumerPtr& termsConsumer, Collection<SegmentMergeInfoPtr> smis, int32_t n) {
+    if (!sortedPostings) {
+        sortedPostings = Collection<int64_t>::newInstance();
+        postingFreqs = Collection<int32_t>::newInstance();
+        postingStarts = Collection<int32_t>::newInstance();
+        positions = Collection<int32_t>::newInstance();
+        payloadStarts = Collection<int32_t>::newInstance();
+        payloadLengths = Collection<int32_t>::newInstance();
+    }
+    sortedPostings.clear();
+    postingFreqs.clear();
+    postingStarts.clear();
+    positions.clear();
+    payloadStarts.clear();
+    payloadLengths.clear();
+    payloadsUpto = 0;
+
+    for (int32_t i = 0; i < n; ++i) {
+        SegmentMergeInfoPtr smi(smis[i]);
+        TermPositionsPtr postings(smi->getPositions());
+        BOOST_ASSERT(postings);
+        Collection<int32_t> docMap(docMaps[smi->ord]);
+        postings->seek(smi->termEnum);
+
+        while (postings->next()) {
+            int32_t doc = smi->base + docMap[postings->doc()];
+            int32_t freq = postings->freq();
+            sortedPostings.add(((int64_t)doc << 32) | (int64_t)postingFreqs.size());
+            postingFreqs.add(freq);
+            postingStarts.add(positions.size());
+
+            if (!omitTermFreqAndPositions) {
+                for (int32_t j = 0; j < freq; ++j) {
+                    positions.add(postings->nextPosition());
+                    int32_t payloadLength = postings->getPayloadLength();
+                    payloadStarts.add(payloadsUpto);
+                    payloadLengths.add(payloadLength);
+                    if (payloadLength > 0) {
+                        if (!payloads) {
+                            payloads = ByteArray::newInstance(MiscUtils::getNextSize(payloadLength));
+                        }
+                        if (payloads.size() < payloadsUpto + payloadLength) {
+                            payloads.resize(MiscUtils::getNextSize(payloadsUpto + payloadLength));
+                        }
+                        postings->getPayload(payloads, payloadsUpto);
+                        payloadsUpto += payloadLength;
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(sortedPostings.begin(), sortedPostings.end());
+
+    FormatPostingsDocsConsumerPtr docConsumer(termsConsumer->addTerm(smis[0]->term->_text));
+    for (Collection<int64_t>::iterator key = sortedPostings.begin(); key != sortedPostings.end(); ++key) {
+        int32_t doc = (int32_t)(*key >> 32);
+        int32_t posting = (int32_t)(*key & 0xffffffff);
+        int32_t freq = postingFreqs[posting];
+        FormatPostingsPositionsConsumerPtr posConsumer(docConsumer->addDoc(doc, freq));
+
+        if (!omitTermFreqAndPositions) {
+            for (int32_t j = postingStarts[posting]; j < postingStarts[posting] + freq; ++j) {
+                posConsumer->addPosition(positions[j], payloads, payloadStarts[j], payloadLengths[j]);
+            }
+            posConsumer->finish();
+        }
+    }
+    docConsumer->finish();
+
+    return sortedPostings.size();
+}
+
 void SegmentMerger::mergeNorms() {
     ByteArray normBuffer;
     IndexOutputPtr output;
@@ -616,6 +959,28 @@ void SegmentMerger::mergeNorms() {
                     output = directory->createOutput(segment + L"." + IndexFileNames::NORMS_EXTENSION());
                     output->writeBytes(NORMS_HEADER, SIZEOF_ARRAY(NORMS_HEADER));
                 }
+                if (sortedReaders) {
+                    // Read the norms of every reader, then write them out in merged order
+                    int32_t numDocs = sortedDocs.size();
+                    Collection<ByteArray> readerNorms(Collection<ByteArray>::newInstance(readers.size()));
+                    for (int32_t j = 0; j < readers.size(); ++j) {
+                        readerNorms[j] = ByteArray::newInstance(readers[j]->maxDoc());
+                        MiscUtils::arrayFill(readerNorms[j].get(), 0, readerNorms[j].size(), 0);
+                        readers[j]->norms(fi->name, readerNorms[j], 0);
+                    }
+                    if (!normBuffer) {
+                        normBuffer = ByteArray::newInstance(numDocs);
+                    }
+                    if (normBuffer.size() < numDocs) {
+                        normBuffer.resize(numDocs);
+                    }
+                    for (int32_t doc = 0; doc < numDocs; ++doc) {
+                        normBuffer[doc] = readerNorms[sortedReaders[doc]][sortedDocs[doc]];
+                    }
+                    output->writeBytes(normBuffer.get(), numDocs);
+                    checkAbort->work(numDocs);
+                    continue;
+                }
                 for (Collection<IndexReaderPtr>::iterator reader = readers.begin(); reader != readers.end(); ++reader) {
                     int32_t maxDoc = (*reader)->maxDoc();
 
@@ -651,6 +1016,198 @@ void SegmentMerger::mergeNorms() {
     finally.throwException();
 }
 
+void SegmentMerger::mergeDocValues() {
+    if (!fieldInfos->hasDocValues()) {
+        return;
+    }
+    IndexOutputPtr output(directory->createOutput(segment + L"." + IndexFileNames::DOC_VALUES_EXTENSION()));
+    LuceneException finally;
+    try {
+        DocValuesWriter::writeHeader(output, mergedDocs);
+        Collection<FieldInfoPtr> fields(Collection<FieldInfoPtr>::newInstance());
+        Collection<int64_t> pointers(Collection<int64_t>::newInstance());
+        int32_t numFieldInfos = fieldInfos->size();
+        for (int32_t i = 0; i < numFieldInfos; ++i) {
+            FieldInfoPtr fi(fieldInfos->fieldInfo(i));
+            if (fi->docValuesType == Fieldable::DOC_VALUES_NONE) {
+                continue;
+            }
+            fields.add(fi);
+            pointers.add(output->getFilePointer());
+
+            bool numeric = (fi->docValuesType == Fieldable::DOC_VALUES_NUMERIC || fi->docValuesType == Fieldable::DOC_VALUES_DOUBLE);
+            Collection<int64_t> longs;
+            Collection<String> strings;
+            if (numeric) {
+                longs = Collection<int64_t>::newInstance(mergedDocs);
+            } else {
+                strings = Collection<String>::newInstance(mergedDocs);
+            }
+            int32_t docUpto = 0;
+            for (int32_t i = 0; i < readers.size(); ++i) {
+                IndexReaderPtr reader(readers[i]);
+                int32_t maxDoc = reader->maxDoc();
+                int32_t readerStart = docUpto;
+                DocValuesColumnPtr column(reader->getDocValuesColumn(fi->name));
+                for (int32_t doc = 0; doc < maxDoc; ++doc) {
+                    if (reader->isDeleted(doc)) {
+                        continue;
+                    }
+                    int32_t target = sortedReaders ? readerStart + docMaps[i][doc] : docUpto;
+                    if (column) {
+                        if (fi->docValuesType == Fieldable::DOC_VALUES_DOUBLE) {
+                            longs[target] = NumericUtils::doubleToSortableLong(column->getDouble(doc));
+                        } else if (numeric) {
+                            longs[target] = column->getLong(doc);
+                        } else {
+                            strings[target] = column->getString(doc);
+                        }
+                    }
+                    ++docUpto;
+                }
+                checkAbort->work(maxDoc);
+            }
+            BOOST_ASSERT(docUpto == mergedDocs);
+
+            if (numeric) {
+                DocValuesWriter::writeNumeric(output, longs);
+            } else if (fi->docValuesType == Fieldable::DOC_VALUES_BINARY) {
+                DocValuesWriter::writeBinary(output, strings);
+            } else {
+                DocValuesWriter::writeSorted(output, strings);
+            }
+        }
+        DocValuesWriter::writeDirectory(output, fields, pointers);
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    output->close();
+    finally.throwException();
+}
+
+void SegmentMerger::mergePoints() {
+    if (!fieldInfos->hasPoints()) {
+        return;
+    }
+
+    // the merged document of every document of each reader
+    Collection< Collection<int32_t> > readerDocMaps(Collection< Collection<int32_t> >::newInstance(readers.size()));
+    int32_t docUpto = 0;
+    for (int32_t i = 0; i < readers.size(); ++i) {
+        IndexReaderPtr reader(readers[i]);
+        int32_t maxDoc = reader->maxDoc();
+        int32_t readerStart = docUpto;
+        readerDocMaps[i] = Collection<int32_t>::newInstance(maxDoc);
+        for (int32_t doc = 0; doc < maxDoc; ++doc) {
+            if (reader->isDeleted(doc)) {
+                readerDocMaps[i][doc] = -1;
+                continue;
+            }
+            readerDocMaps[i][doc] = sortedReaders ? readerStart + docMaps[i][doc] : docUpto;
+            ++docUpto;
+        }
+    }
+
+    IndexOutputPtr output(directory->createOutput(segment + L"." + IndexFileNames::POINTS_EXTENSION()));
+    LuceneException finally;
+    try {
+        PointsWriter::writeHeader(output);
+        Collection<FieldInfoPtr> fields(Collection<FieldInfoPtr>::newInstance());
+        Collection<int64_t> pointers(Collection<int64_t>::newInstance());
+        int32_t numFieldInfos = fieldInfos->size();
+        for (int32_t i = 0; i < numFieldInfos; ++i) {
+            FieldInfoPtr fi(fieldInfos->fieldInfo(i));
+            if (fi->pointDimensions == 0) {
+                continue;
+            }
+            Collection<int32_t> docs(Collection<int32_t>::newInstance());
+            Collection<int64_t> values(Collection<int64_t>::newInstance());
+            for (int32_t j = 0; j < readers.size(); ++j) {
+                PointValuesPtr pointValues(readers[j]->getPointValues(fi->name));
+                if (pointValues) {
+                    pointValues->intersect(newLucene<MergePointVisitor>(readerDocMaps[j], fi->pointDimensions, docs, values));
+                    checkAbort->work((double)pointValues->size());
+                }
+            }
+            if (docs.empty()) {
+                continue;
+            }
+            fields.add(fi);
+            pointers.add(PointsWriter::writeField(output, fi->pointDimensions, docs, values));
+        }
+        PointsWriter::writeDirectory(output, fields, pointers);
+    } catch (LuceneException& e) {
+        finally = e;
+    }
+    output->close();
+    finally.throwException();
+}
+
+SegmentMergerPart::SegmentMergerPart(const SegmentMergerPtr& merger, Part part) {
+    this->merger = merger;
+    this->part = part;
+}
+
+SegmentMergerPart::~SegmentMergerPart() {
+}
+
+void SegmentMergerPart::run() {
+    switch (part) {
+    case STORED_FIELDS: {
+        int32_t docCount = merger->mergeStoredFields();
+        if (docCount != merger->mergedDocs) {
+            boost::throw_exception(RuntimeException(L"mergeFields produced an invalid result: docCount is " +
+                                                    StringUtils::toString(docCount) + L" but the readers hold " +
+                                                    StringUtils::toString(merger->mergedDocs) + L" documents" +
+                                                    L"; now aborting this merge to prevent index corruption"));
+        }
+        break;
+    }
+    case VECTORS:
+        merger->mergeVectors();
+        break;
+    case POSTINGS:
+        merger->mergeTerms();
+        break;
+    case NORMS:
+        merger->mergeNorms();
+        break;
+    case DOC_VALUES:
+        merger->mergeDocValues();
+        break;
+    case POINTS:
+        merger->mergePoints();
+        break;
+    }
+}
+
+MergePointVisitor::MergePointVisitor(Collection<int32_t> docMap, int32_t numDims, Collection<int32_t> docs, Collection<int64_t> values) {
+    this->docMap = docMap;
+    this->numDims = numDims;
+    this->docs = docs;
+    this->values = values;
+}
+
+MergePointVisitor::~MergePointVisitor() {
+}
+
+void MergePointVisitor::visit(int32_t doc) {
+    // every cell crosses, so the points always come with their values
+    BOOST_ASSERT(false);
+}
+
+void MergePointVisitor::visit(int32_t doc, const int64_t* point) {
+    if (docMap[doc] == -1) {
+        return;
+    }
+    docs.add(docMap[doc]);
+    values.addAll(point, point + numDims);
+}
+
+PointVisitor::Relation MergePointVisitor::compare(const int64_t* minValues, const int64_t* maxValues) {
+    return CELL_CROSSES_QUERY;
+}
+
 CheckAbort::CheckAbort(const OneMergePtr& merge, const DirectoryPtr& dir) {
     workCount = 0;
     this->merge = merge;
@@ -661,6 +1218,7 @@ CheckAbort::~CheckAbort() {
 }
 
 void CheckAbort::work(double units) {
+    SyncLock syncLock(this);
     workCount += units;
     if (workCount >= 10000.0) {
         merge->checkAborted(DirectoryPtr(_dir));
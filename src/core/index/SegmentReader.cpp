@@ -17,6 +17,8 @@
 #include "TermInfo.h"
 #include "TermInfosReader.h"
 #include "TermVectorsReader.h"
+#include "DocValuesReader.h"
+#include "PointsReader.h"
 #include "IndexOutput.h"
 #include "ReadOnlySegmentReader.h"
 #include "BitVector.h"
@@ -32,7 +34,7 @@
 
 namespace Lucene {
 
-SegmentReader::SegmentReader() {
+SegmentReader::SegmentReader() : termVectorsLocal(true) {
     _norms = MapStringNorm::newInstance();
     readOnly = false;
     deletedDocsDirty = false;
@@ -485,6 +487,16 @@ ByteArray SegmentReader::norms(const String& field) {
     return getNorms(field);
 }
 
+DocValuesColumnPtr SegmentReader::getDocValuesColumn(const String& field) {
+    ensureOpen();
+    return core->docValuesReader ? core->docValuesReader->getColumn(field) : DocValuesColumnPtr();
+}
+
+PointValuesPtr SegmentReader::getPointValues(const String& field) {
+    ensureOpen();
+    return core->pointsReader ? core->pointsReader->getPointValues(field) : PointValuesPtr();
+}
+
 void SegmentReader::doSetNorm(int32_t doc, const String& field, uint8_t value) {
     NormPtr norm(_norms.get(field));
     if (!norm) { // not an indexed field
@@ -499,6 +511,13 @@ void SegmentReader::doSetNorm(int32_t doc, const String& field, uint8_t value) {
     bytes[doc] = value; // set the value
 }
 
+double SegmentReader::maxNorm(const String& field) {
+    SyncLock syncLock(this);
+    ensureOpen();
+    NormPtr norm(_norms.get(field));
+    return norm ? norm->maxNorm() : 1.0;
+}
+
 void SegmentReader::norms(const String& field, ByteArray norms, int32_t offset) {
     SyncLock syncLock(this);
     ensureOpen();
@@ -770,6 +789,14 @@ CoreReaders::CoreReaders(const SegmentReaderPtr& origInstance, const DirectoryPt
             proxStream = cfsDir->openInput(segment + L"." + IndexFileNames::PROX_EXTENSION(), readBufferSize);
         }
 
+        if (fieldInfos->hasDocValues()) {
+            docValuesReader = newLucene<DocValuesReader>(cfsDir, segment, fieldInfos, readBufferSize);
+        }
+
+        if (fieldInfos->hasPoints()) {
+            pointsReader = newLucene<PointsReader>(cfsDir, segment, fieldInfos, readBufferSize);
+        }
+
         success = true;
     } catch (LuceneException& e) {
         finally = e;
@@ -854,6 +881,12 @@ void CoreReaders::decRef() {
         if (proxStream) {
             proxStream->close();
         }
+        if (docValuesReader) {
+            docValuesReader->close();
+        }
+        if (pointsReader) {
+            pointsReader->close();
+        }
         if (termVectorsReaderOrig) {
             termVectorsReaderOrig->close();
         }
@@ -921,7 +954,7 @@ void CoreReaders::openDocStores(const SegmentInfoPtr& si) {
     }
 }
 
-FieldsReaderLocal::FieldsReaderLocal(const SegmentReaderPtr& reader) {
+FieldsReaderLocal::FieldsReaderLocal(const SegmentReaderPtr& reader) : CloseableThreadLocal<FieldsReader>(true) {
     this->_reader = reader;
 }
 
@@ -965,6 +998,7 @@ Norm::Norm() {
     this->dirty = false;
     this->rollbackDirty = false;
     this->number = 0;
+    this->_maxNorm = -1.0;
 }
 
 Norm::Norm(const SegmentReaderPtr& reader, const IndexInputPtr& in, int32_t number, int64_t normSeek) {
@@ -972,6 +1006,7 @@ Norm::Norm(const SegmentReaderPtr& reader, const IndexInputPtr& in, int32_t numb
     this->refCount = 1;
     this->dirty = false;
     this->rollbackDirty = false;
+    this->_maxNorm = -1.0;
     this->in = in;
     this->number = number;
     this->normSeek = normSeek;
@@ -1110,9 +1145,18 @@ ByteArray Norm::copyOnWrite() {
         oldRef->decRef();
     }
     dirty = true;
+    _maxNorm = -1.0; // the caller is about to change a norm
     return _bytes;
 }
 
+double Norm::maxNorm() {
+    SyncLock syncLock(this);
+    if (_maxNorm < 0.0) {
+        _maxNorm = IndexReader::decodeMaxNorm(bytes());
+    }
+    return _maxNorm;
+}
+
 LuceneObjectPtr Norm::clone(const LuceneObjectPtr& other) {
     SyncLock syncLock(this);
 
@@ -1128,6 +1172,7 @@ LuceneObjectPtr Norm::clone(const LuceneObjectPtr& other) {
     cloneNorm->dirty = dirty;
     cloneNorm->number = number;
     cloneNorm->rollbackDirty = rollbackDirty;
+    cloneNorm->_maxNorm = _bytes ? _maxNorm : -1.0;
 
     cloneNorm->refCount = 1;
 
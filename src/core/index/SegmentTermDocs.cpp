@@ -17,10 +17,14 @@
 #include "TermInfo.h"
 #include "DefaultSkipListReader.h"
 #include "BitVector.h"
+#include "SegmentInfo.h"
+#include "PForUtils.h"
 #include "MiscUtils.h"
 
 namespace Lucene {
 
+const int32_t SegmentTermDocs::BLOCK_SIZE = 128;
+
 SegmentTermDocs::SegmentTermDocs(const SegmentReaderPtr& parent) {
     this->_parent = parent;
     this->count = 0;
@@ -33,6 +37,34 @@ SegmentTermDocs::SegmentTermDocs(const SegmentReaderPtr& parent) {
     this->haveSkipped = false;
     this->currentFieldStoresPayloads = false;
     this->currentFieldOmitTermFreqAndPositions = false;
+    this->pendingCodes = IntArray::newInstance(BLOCK_SIZE);
+    this->pendingPosition = 0;
+    this->pendingLength = 0;
+    this->packedPostings = parent->getSegmentInfo()->getPackedPostings();
+    this->blockPosition = 0;
+    this->blockLength = 0;
+    this->blocksRead = 0;
+    this->blockSkipCount = 0;
+    this->blockSkipPending = false;
+    this->blockSkipDoc = 0;
+    this->blockSkipFreqPointer = 0;
+    this->blockSkipProxPointer = 0;
+    this->blockSkipPayloadLength = 0;
+    this->pendingSkipDoc = 0;
+    this->pendingSkipFreqPointer = 0;
+    this->pendingSkipProxPointer = 0;
+    this->pendingSkipPayloadLength = 0;
+    this->impactsLoaded = false;
+    this->termMaxFreq = -1;
+    this->impactCount = 0;
+    this->impactPending = false;
+    this->impactDoc = 0;
+    this->impactBlockFreq = -1;
+    if (packedPostings) {
+        this->blockDocs = IntArray::newInstance(PForUtils::BLOCK_SIZE);
+        this->blockFreqs = IntArray::newInstance(PForUtils::BLOCK_SIZE);
+        this->blockScratch = ByteArray::newInstance(PForUtils::scratchSize(PForUtils::BLOCK_SIZE));
+    }
 
     this->_freqStream = std::dynamic_pointer_cast<IndexInput>(parent->core->freqStream->clone());
     {
@@ -72,6 +104,12 @@ void SegmentTermDocs::seek(const TermEnumPtr& termEnum) {
 
 void SegmentTermDocs::seek(const TermInfoPtr& ti, const TermPtr& term) {
     count = 0;
+    pendingPosition = 0;
+    pendingLength = 0;
+    blockPosition = 0;
+    blockLength = 0;
+    blocksRead = 0;
+    impactsLoaded = false;
     FieldInfoPtr fi(SegmentReaderPtr(_parent)->core->fieldInfos->fieldInfo(term->_field));
     currentFieldOmitTermFreqAndPositions = fi ? fi->omitTermFreqAndPositions : false;
     currentFieldStoresPayloads = fi ? fi->storePayloads : false;
@@ -90,6 +128,12 @@ void SegmentTermDocs::seek(const TermInfoPtr& ti, const TermPtr& term) {
 
 void SegmentTermDocs::close() {
     _freqStream->close();
+    if (blockSkipStream) {
+        blockSkipStream->close();
+    }
+    if (impactStream) {
+        impactStream->close();
+    }
     if (skipListReader) {
         skipListReader->close();
     }
@@ -111,7 +155,20 @@ bool SegmentTermDocs::next() {
         if (count == df) {
             return false;
         }
-        int32_t docCode = _freqStream->readVInt();
+        if (packedPostings) {
+            if (blockPosition == blockLength) {
+                readBlock();
+            }
+            _doc = blockDocs[blockPosition];
+            _freq = blockFreqs[blockPosition++];
+            ++count;
+            if (!deletedDocs || !deletedDocs->get(_doc)) {
+                break;
+            }
+            skippingDoc();
+            continue;
+        }
+        int32_t docCode = nextCode();
 
         if (currentFieldOmitTermFreqAndPositions) {
             _doc += docCode;
@@ -121,7 +178,7 @@ bool SegmentTermDocs::next() {
             if ((docCode & 1) != 0) { // if low bit is set
                 _freq = 1;    // freq is one
             } else {
-                _freq = _freqStream->readVInt();    // else read freq
+                _freq = nextCode();    // else read freq
             }
         }
 
@@ -137,54 +194,286 @@ bool SegmentTermDocs::next() {
 
 int32_t SegmentTermDocs::read(Collection<int32_t> docs, Collection<int32_t> freqs) {
     int32_t length = docs.size();
-    if (currentFieldOmitTermFreqAndPositions) {
+    if (packedPostings) {
+        return readPacked(docs, freqs);
+    } else if (currentFieldOmitTermFreqAndPositions) {
         return readNoTf(docs, freqs, length);
     } else {
+        BitVector* deleted = deletedDocs.get();
         int32_t i = 0;
         while (i < length && count < df) {
             // manually inlined call to next() for speed
-            int32_t docCode = _freqStream->readVInt();
+            if (pendingPosition == pendingLength) {
+                fillPending();
+            }
+            int32_t docCode = pendingCodes[pendingPosition++];
             _doc += MiscUtils::unsignedShift(docCode, 1); // shift off low bit
             if ((docCode & 1) != 0) { // if low bit is set
                 _freq = 1;    // freq is one
             } else {
-                _freq = _freqStream->readVInt();    // else read freq
+                if (pendingPosition == pendingLength) {
+                    fillPending();
+                }
+                _freq = pendingCodes[pendingPosition++];    // else read freq
             }
             ++count;
 
-            if (!deletedDocs || !deletedDocs->get(_doc)) {
-                docs[i] = _doc;
-                freqs[i] = _freq;
-                ++i;
-            }
+            // deleted docs are written and then overwritten by the next live one
+            docs[i] = _doc;
+            freqs[i] = _freq;
+            i += (deleted && deleted->get(_doc)) ? 0 : 1;
         }
         return i;
     }
 }
 
 int32_t SegmentTermDocs::readNoTf(Collection<int32_t> docs, Collection<int32_t> freqs, int32_t length) {
+    BitVector* deleted = deletedDocs.get();
     int32_t i = 0;
     while (i < length && count < df) {
-        // manually inlined call to next() for speed
-        _doc += _freqStream->readVInt();
-        ++count;
-
-        if (!deletedDocs || !deletedDocs->get(_doc)) {
+        if (pendingPosition == pendingLength) {
+            fillPending();
+        }
+        // a block only holds doc deltas here, so accumulate it without further checks
+        int32_t block = std::min(std::min(length - i, df - count), pendingLength - pendingPosition);
+        const int32_t* codes = pendingCodes.get() + pendingPosition;
+        pendingPosition += block;
+        count += block;
+        for (int32_t j = 0; j < block; ++j) {
+            _doc += codes[j];
             docs[i] = _doc;
 
             // Hardware freq to 1 when term freqs were not stored in the index
             freqs[i] = 1;
-            ++i;
+            i += (deleted && deleted->get(_doc)) ? 0 : 1;
+        }
+    }
+    return i;
+}
+
+void SegmentTermDocs::fillPending() {
+    // every remaining document still has its doc code in the stream, so this never reads past the term's postings
+    pendingPosition = 0;
+    pendingLength = std::min(BLOCK_SIZE, df - count);
+    _freqStream->readVInts(pendingCodes.get(), pendingLength);
+}
+
+int32_t SegmentTermDocs::readPacked(Collection<int32_t> docs, Collection<int32_t> freqs) {
+    int32_t length = docs.size();
+    BitVector* deleted = deletedDocs.get();
+    int32_t i = 0;
+    while (i < length && count < df) {
+        if (blockPosition == blockLength) {
+            readBlock();
         }
+        int32_t n = std::min(length - i, blockLength - blockPosition);
+        const int32_t* blockDoc = blockDocs.get() + blockPosition;
+        const int32_t* blockFreq = blockFreqs.get() + blockPosition;
+        for (int32_t j = 0; j < n; ++j) {
+            docs[i] = blockDoc[j];
+            freqs[i] = blockFreq[j];
+            i += (deleted && deleted->get(blockDoc[j])) ? 0 : 1;
+        }
+        blockPosition += n;
+        count += n;
+        _doc = blockDoc[n - 1];
+        _freq = blockFreq[n - 1];
     }
     return i;
 }
 
+void SegmentTermDocs::readBlock() {
+    int32_t left = df - count;
+    int32_t* blockDoc = blockDocs.get();
+    int32_t* blockFreq = blockFreqs.get();
+    int32_t doc = _doc;
+    if (left >= PForUtils::BLOCK_SIZE) {
+        PForUtils::decode(_freqStream, blockDoc, PForUtils::BLOCK_SIZE, blockScratch.get());
+        if (currentFieldOmitTermFreqAndPositions) {
+            std::fill(blockFreq, blockFreq + PForUtils::BLOCK_SIZE, 1);
+        } else {
+            PForUtils::decode(_freqStream, blockFreq, PForUtils::BLOCK_SIZE, blockScratch.get());
+            for (int32_t i = 0; i < PForUtils::BLOCK_SIZE; ++i) {
+                ++blockFreq[i]; // stored as freq - 1
+            }
+        }
+        for (int32_t i = 0; i < PForUtils::BLOCK_SIZE; ++i) {
+            doc += blockDoc[i];
+            blockDoc[i] = doc;
+        }
+        blockLength = PForUtils::BLOCK_SIZE;
+        ++blocksRead;
+    } else {
+        // docs after the last full block are written as in the legacy format; each has at least its doc
+        // code left in the stream, so the first left values can be decoded at once
+        int32_t decoded = std::min(left, pendingCodes.size());
+        _freqStream->readVInts(pendingCodes.get(), decoded);
+        int32_t code = 0;
+        for (int32_t i = 0; i < left; ++i) {
+            int32_t docCode = code < decoded ? pendingCodes[code++] : _freqStream->readVInt();
+            if (currentFieldOmitTermFreqAndPositions) {
+                doc += docCode;
+                blockFreq[i] = 1;
+            } else {
+                doc += MiscUtils::unsignedShift(docCode, 1);
+                if ((docCode & 1) != 0) {
+                    blockFreq[i] = 1;
+                } else {
+                    blockFreq[i] = code < decoded ? pendingCodes[code++] : _freqStream->readVInt();
+                }
+            }
+            blockDoc[i] = doc;
+        }
+        blockLength = left;
+    }
+    blockPosition = 0;
+}
+
+void SegmentTermDocs::skipBlocks(int32_t target) {
+    if (!blockSkipStream) {
+        blockSkipStream = std::dynamic_pointer_cast<IndexInput>(_freqStream->clone()); // lazily clone
+    }
+    if (!haveSkipped) {
+        blockSkipStream->seek(skipPointer);
+        if (!currentFieldOmitTermFreqAndPositions) {
+            blockSkipStream->readVInt(); // max freq of the term
+        }
+        blockSkipCount = 0;
+        blockSkipPending = false;
+        blockSkipDoc = 0;
+        blockSkipFreqPointer = freqBasePointer;
+        blockSkipProxPointer = proxBasePointer;
+        blockSkipPayloadLength = 0;
+        haveSkipped = true;
+    }
+
+    // entry i holds the last doc of block i and where block i + 1 starts
+    int32_t numEntries = (df - 1) / PForUtils::BLOCK_SIZE;
+    int32_t newBlocksRead = -1;
+    while (blockSkipCount < numEntries) {
+        if (!blockSkipPending) {
+            pendingSkipDoc = blockSkipDoc + blockSkipStream->readVInt();
+            pendingSkipFreqPointer = blockSkipFreqPointer + blockSkipStream->readVLong();
+            pendingSkipProxPointer = blockSkipProxPointer + blockSkipStream->readVLong();
+            pendingSkipPayloadLength = currentFieldStoresPayloads ? blockSkipStream->readVInt() : blockSkipPayloadLength;
+            if (!currentFieldOmitTermFreqAndPositions) {
+                blockSkipStream->readVInt(); // max freq of the block
+            }
+            blockSkipPending = true;
+        }
+        bool passed = (blockSkipCount + 1 < blocksRead); // the block after this entry has been read already
+        if (!passed && pendingSkipDoc >= target) {
+            break;
+        }
+        // the entry is passed, so the block after it is where reading resumes
+        blockSkipDoc = pendingSkipDoc;
+        blockSkipFreqPointer = pendingSkipFreqPointer;
+        blockSkipProxPointer = pendingSkipProxPointer;
+        blockSkipPayloadLength = pendingSkipPayloadLength;
+        blockSkipPending = false;
+        ++blockSkipCount;
+        if (!passed) {
+            newBlocksRead = blockSkipCount;
+        }
+    }
+
+    if (newBlocksRead != -1) {
+        _freqStream->seek(blockSkipFreqPointer);
+        skipProx(blockSkipProxPointer, blockSkipPayloadLength);
+        _doc = blockSkipDoc;
+        count = newBlocksRead * PForUtils::BLOCK_SIZE;
+        blocksRead = newBlocksRead;
+        blockPosition = 0;
+        blockLength = 0;
+    }
+}
+
+int32_t SegmentTermDocs::maxFreq() {
+    if (!packedPostings) {
+        return -1;
+    }
+    if (df == 0) {
+        return 0;
+    }
+    if (currentFieldOmitTermFreqAndPositions) {
+        return 1;
+    }
+    if (!impactsLoaded) {
+        loadImpacts();
+    }
+    return termMaxFreq;
+}
+
+void SegmentTermDocs::loadImpacts() {
+    if (!impactStream) {
+        impactStream = std::dynamic_pointer_cast<IndexInput>(_freqStream->clone()); // lazily clone
+    }
+    if (df >= skipInterval) {
+        impactStream->seek(skipPointer);
+        termMaxFreq = impactStream->readVInt();
+    } else if (df <= PForUtils::BLOCK_SIZE) {
+        // no skip data is stored for the term, but its few docs are all VInt coded
+        impactStream->seek(freqBasePointer);
+        termMaxFreq = 0;
+        for (int32_t i = 0; i < df; ++i) {
+            int32_t docCode = impactStream->readVInt();
+            termMaxFreq = std::max(termMaxFreq, (docCode & 1) != 0 ? 1 : impactStream->readVInt());
+        }
+    } else {
+        termMaxFreq = -1;
+    }
+    impactCount = 0;
+    impactPending = false;
+    impactDoc = 0;
+    impactBlockFreq = termMaxFreq;
+    impactsLoaded = true;
+}
+
+int32_t SegmentTermDocs::advanceShallow(int32_t target) {
+    maxFreq(); // loads the impacts where there are any
+    if (!impactsLoaded || termMaxFreq == -1) {
+        return INT_MAX;
+    }
+    // entry i holds the last doc and the max freq of block i; the last block is bounded by the term
+    int32_t numEntries = df >= skipInterval ? (df - 1) / PForUtils::BLOCK_SIZE : 0;
+    while (impactCount < numEntries) {
+        if (!impactPending) {
+            impactDoc += impactStream->readVInt();
+            impactStream->readVLong();
+            impactStream->readVLong();
+            if (currentFieldStoresPayloads) {
+                impactStream->readVInt();
+            }
+            impactBlockFreq = impactStream->readVInt();
+            impactPending = true;
+        }
+        if (impactDoc >= target) {
+            return impactDoc;
+        }
+        impactPending = false;
+        ++impactCount;
+    }
+    impactBlockFreq = termMaxFreq;
+    return INT_MAX;
+}
+
+int32_t SegmentTermDocs::blockMaxFreq() {
+    return impactsLoaded ? impactBlockFreq : maxFreq();
+}
+
+int32_t SegmentTermDocs::nextCode() {
+    return pendingPosition < pendingLength ? pendingCodes[pendingPosition++] : _freqStream->readVInt();
+}
+
 void SegmentTermDocs::skipProx(int64_t proxPointer, int32_t payloadLength) {
 }
 
 bool SegmentTermDocs::skipTo(int32_t target) {
-    if (df >= skipInterval) { // optimized case
+    if (packedPostings) {
+        if (df >= skipInterval && df > PForUtils::BLOCK_SIZE) {
+            skipBlocks(target);
+        }
+    } else if (df >= skipInterval) { // optimized case
         if (!skipListReader) {
             skipListReader = newLucene<DefaultSkipListReader>(std::dynamic_pointer_cast<IndexInput>(_freqStream->clone()), maxSkipLevels, skipInterval);    // lazily clone
         }
@@ -197,6 +486,8 @@ bool SegmentTermDocs::skipTo(int32_t target) {
         int32_t newCount = skipListReader->skipTo(target);
         if (newCount > count) {
             _freqStream->seek(skipListReader->getFreqPointer());
+            pendingPosition = 0;
+            pendingLength = 0;
             skipProx(skipListReader->getProxPointer(), skipListReader->getPayloadLength());
 
             _doc = skipListReader->getDoc();
@@ -219,6 +510,8 @@ IndexInputPtr SegmentTermDocs::freqStream() {
 
 void SegmentTermDocs::freqStream(const IndexInputPtr& freqStream) {
     _freqStream = freqStream;
+    pendingPosition = 0;
+    pendingLength = 0;
 }
 
 }
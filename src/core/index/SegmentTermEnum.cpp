@@ -18,7 +18,6 @@ SegmentTermEnum::SegmentTermEnum() {
     format = 0;
     termBuffer = newLucene<TermBuffer>();
     prevBuffer = newLucene<TermBuffer>();
-    scanBuffer = newLucene<TermBuffer>();
     _termInfo = newLucene<TermInfo>();
     formatM1SkipInterval = 0;
     size = 0;
@@ -36,7 +35,6 @@ SegmentTermEnum::SegmentTermEnum(const IndexInputPtr& i, const FieldInfosPtr& fi
     format = 0;
     termBuffer = newLucene<TermBuffer>();
     prevBuffer = newLucene<TermBuffer>();
-    scanBuffer = newLucene<TermBuffer>();
     _termInfo = newLucene<TermInfo>();
     formatM1SkipInterval = 0;
     size = 0;
@@ -92,7 +90,6 @@ SegmentTermEnum::SegmentTermEnum(const IndexInputPtr& i, const FieldInfosPtr& fi
     }
     if (format > TermInfosWriter::FORMAT_VERSION_UTF8_LENGTH_IN_BYTES) {
         termBuffer->setPreUTF8Strings();
-        scanBuffer->setPreUTF8Strings();
         prevBuffer->setPreUTF8Strings();
     }
 }
@@ -119,7 +116,6 @@ LuceneObjectPtr SegmentTermEnum::clone(const LuceneObjectPtr& other) {
 
     cloneEnum->termBuffer = std::dynamic_pointer_cast<TermBuffer>(termBuffer->clone());
     cloneEnum->prevBuffer = std::dynamic_pointer_cast<TermBuffer>(prevBuffer->clone());
-    cloneEnum->scanBuffer = newLucene<TermBuffer>();
 
     return cloneEnum;
 }
@@ -132,6 +128,14 @@ void SegmentTermEnum::seek(int64_t pointer, int64_t p, const TermPtr& t, const T
     _termInfo->set(ti);
 }
 
+void SegmentTermEnum::seek(int64_t pointer, int64_t p, const String& field, const wchar_t* text, int32_t length, const TermInfoPtr& ti) {
+    input->seek(pointer);
+    position = p;
+    termBuffer->set(field, text, length);
+    prevBuffer->reset();
+    _termInfo->set(ti);
+}
+
 bool SegmentTermEnum::next() {
     if (position++ >= size - 1) {
         prevBuffer->set(termBuffer);
@@ -164,9 +168,9 @@ bool SegmentTermEnum::next() {
 }
 
 int32_t SegmentTermEnum::scanTo(const TermPtr& term) {
-    scanBuffer->set(term);
+    // before the first term, there is no current term to compare with
     int32_t count = 0;
-    while (scanBuffer->compareTo(termBuffer) > 0 && next()) {
+    while ((!termBuffer->hasTerm() || termBuffer->compareTerm(term) < 0) && next()) {
         ++count;
     }
     return count;
@@ -180,6 +184,26 @@ TermPtr SegmentTermEnum::prev() {
     return prevBuffer->toTerm();
 }
 
+bool SegmentTermEnum::hasTerm() {
+    return termBuffer->hasTerm();
+}
+
+bool SegmentTermEnum::hasPrev() {
+    return prevBuffer->hasTerm();
+}
+
+int32_t SegmentTermEnum::compareTerm(const TermPtr& term) {
+    return termBuffer->compareTerm(term);
+}
+
+int32_t SegmentTermEnum::comparePrev(const TermPtr& term) {
+    return prevBuffer->compareTerm(term);
+}
+
+void SegmentTermEnum::termBytes(const BytesRefPtr& result) {
+    termBuffer->termBytes(result);
+}
+
 TermInfoPtr SegmentTermEnum::termInfo() {
     return newLucene<TermInfo>(_termInfo);
 }
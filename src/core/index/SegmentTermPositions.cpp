@@ -57,6 +57,23 @@ int32_t SegmentTermPositions::nextPosition() {
     return position;
 }
 
+void SegmentTermPositions::readPositions(int32_t* positions, int32_t count) {
+    if (currentFieldOmitTermFreqAndPositions || currentFieldStoresPayloads) {
+        // payload lengths are interleaved with the deltas
+        TermPositions::readPositions(positions, count);
+        return;
+    }
+
+    // perform lazy skips if necessary
+    lazySkip();
+    proxCount -= count;
+    proxStream->readVInts(positions, count);
+    for (int32_t i = 0; i < count; ++i) {
+        position += positions[i];
+        positions[i] = position;
+    }
+}
+
 int32_t SegmentTermPositions::readDeltaPosition() {
     int32_t delta = proxStream->readVInt();
     if (currentFieldStoresPayloads) {
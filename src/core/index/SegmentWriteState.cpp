@@ -9,7 +9,7 @@
 
 namespace Lucene {
 
-SegmentWriteState::SegmentWriteState(const DocumentsWriterPtr& docWriter, const DirectoryPtr& directory, const String& segmentName,
+SegmentWriteState::SegmentWriteState(const DocumentsWriterPerThreadPtr& docWriter, const DirectoryPtr& directory, const String& segmentName,
                                      const String& docStoreSegmentName, int32_t numDocs, int32_t numDocsInStore,
                                      int32_t termIndexInterval) {
     this->_docWriter = docWriter;
@@ -19,6 +19,7 @@ SegmentWriteState::SegmentWriteState(const DocumentsWriterPtr& docWriter, const
     this->numDocs = numDocs;
     this->numDocsInStore = numDocsInStore;
     this->termIndexInterval = termIndexInterval;
+    this->packedPostings = false;
     this->flushedFiles = HashSet<String>::newInstance();
 }
 
@@ -12,13 +12,14 @@
 #include "FieldsWriter.h"
 #include "IndexFileNames.h"
 #include "IndexWriter.h"
+#include "DocumentsWriterPerThread.h"
 #include "Directory.h"
 #include "MiscUtils.h"
 #include "StringUtils.h"
 
 namespace Lucene {
 
-StoredFieldsWriter::StoredFieldsWriter(const DocumentsWriterPtr& docWriter, const FieldInfosPtr& fieldInfos) {
+StoredFieldsWriter::StoredFieldsWriter(const DocumentsWriterPerThreadPtr& docWriter, const FieldInfosPtr& fieldInfos) {
     lastDocID = 0;
     docFreeList = Collection<StoredFieldsWriterPerDocPtr>::newInstance(1);
     freeCount = 0;
@@ -44,7 +45,7 @@ void StoredFieldsWriter::flush(const SegmentWriteStatePtr& state) {
 
         // Fill fdx file to include any final docs that we skipped because they hit non-aborting
         // exceptions
-        fill(state->numDocsInStore - DocumentsWriterPtr(_docWriter)->getDocStoreOffset());
+        fill(state->numDocsInStore - DocumentsWriterPerThreadPtr(_docWriter)->getDocStoreOffset());
     }
 
     if (fieldsWriter) {
@@ -54,7 +55,7 @@ void StoredFieldsWriter::flush(const SegmentWriteStatePtr& state) {
 
 void StoredFieldsWriter::initFieldsWriter() {
     if (!fieldsWriter) {
-        DocumentsWriterPtr docWriter(_docWriter);
+        DocumentsWriterPerThreadPtr docWriter(_docWriter);
         String docStoreSegment(docWriter->getDocStoreSegment());
         if (!docStoreSegment.empty()) {
             fieldsWriter = newLucene<FieldsWriter>(docWriter->directory, docStoreSegment, fieldInfos);
@@ -70,7 +71,7 @@ void StoredFieldsWriter::closeDocStore(const SegmentWriteStatePtr& state) {
     int32_t inc = state->numDocsInStore - lastDocID;
     if (inc > 0) {
         initFieldsWriter();
-        fill(state->numDocsInStore - DocumentsWriterPtr(_docWriter)->getDocStoreOffset());
+        fill(state->numDocsInStore - DocumentsWriterPerThreadPtr(_docWriter)->getDocStoreOffset());
     }
 
     if (fieldsWriter) {
@@ -81,7 +82,7 @@ void StoredFieldsWriter::closeDocStore(const SegmentWriteStatePtr& state) {
         state->flushedFiles.add(state->docStoreSegmentName + L"." + IndexFileNames::FIELDS_EXTENSION());
         state->flushedFiles.add(state->docStoreSegmentName + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION());
 
-        DocumentsWriterPtr docWriter(state->_docWriter);
+        DocumentsWriterPerThreadPtr docWriter(state->_docWriter);
         docWriter->removeOpenFile(state->docStoreSegmentName + L"." + IndexFileNames::FIELDS_EXTENSION());
         docWriter->removeOpenFile(state->docStoreSegmentName + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION());
 
@@ -125,7 +126,7 @@ void StoredFieldsWriter::abort() {
 }
 
 void StoredFieldsWriter::fill(int32_t docID) {
-    int32_t docStoreOffset = DocumentsWriterPtr(_docWriter)->getDocStoreOffset();
+    int32_t docStoreOffset = DocumentsWriterPerThreadPtr(_docWriter)->getDocStoreOffset();
 
     // We must "catch up" for all docs before us that had no stored fields
     int32_t end = docID + docStoreOffset;
@@ -137,7 +138,7 @@ void StoredFieldsWriter::fill(int32_t docID) {
 
 void StoredFieldsWriter::finishDocument(const StoredFieldsWriterPerDocPtr& perDoc) {
     SyncLock syncLock(this);
-    IndexWriterPtr writer(DocumentsWriterPtr(_docWriter)->_writer);
+    IndexWriterPtr writer(DocumentsWriterPerThreadPtr(_docWriter)->_writer);
     BOOST_ASSERT(writer->testPoint(L"StoredFieldsWriter.finishDocument start"));
     initFieldsWriter();
 
@@ -166,7 +167,7 @@ void StoredFieldsWriter::free(const StoredFieldsWriterPerDocPtr& perDoc) {
 
 StoredFieldsWriterPerDoc::StoredFieldsWriterPerDoc(const StoredFieldsWriterPtr& fieldsWriter) {
     this->_fieldsWriter = fieldsWriter;
-    buffer = DocumentsWriterPtr(fieldsWriter->_docWriter)->newPerDocBuffer();
+    buffer = DocumentsWriterPerThreadPtr(fieldsWriter->_docWriter)->newPerDocBuffer();
     fdt = newLucene<RAMOutputStream>(buffer);
     numStoredFields = 0;
 }
@@ -7,6 +7,7 @@
 #include "LuceneInc.h"
 #include "Term.h"
 #include "MiscUtils.h"
+#include "BytesRef.h"
 #include "StringUtils.h"
 
 namespace Lucene {
@@ -25,6 +26,16 @@ String Term::text() {
     return _text;
 }
 
+BytesRefPtr Term::bytes() {
+    // terms are shared by searching threads, which may encode the text concurrently
+    BytesRefPtr bytes(std::atomic_load(&_bytes));
+    if (!bytes) {
+        bytes = newLucene<BytesRef>(_text);
+        std::atomic_store(&_bytes, bytes);
+    }
+    return bytes;
+}
+
 TermPtr Term::createTerm(const String& text) {
     return newLucene<Term>(_field, text);
 }
@@ -66,6 +77,7 @@ int32_t Term::compareTo(const LuceneObjectPtr& other) {
 void Term::set(const String& fld, const String& txt) {
     _field = fld;
     _text = txt;
+    _bytes.reset();
 }
 
 String Term::toString() {
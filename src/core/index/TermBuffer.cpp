@@ -9,6 +9,7 @@
 #include "IndexInput.h"
 #include "FieldInfos.h"
 #include "Term.h"
+#include "BytesRef.h"
 #include "MiscUtils.h"
 #include "UnicodeUtils.h"
 #include "StringUtils.h"
@@ -27,12 +28,27 @@ TermBuffer::~TermBuffer() {
 int32_t TermBuffer::compareTo(const LuceneObjectPtr& other) {
     TermBufferPtr otherTermBuffer(std::static_pointer_cast<TermBuffer>(other));
     if (field == otherTermBuffer->field) {
-        return compareChars(text->result.get(), text->length, otherTermBuffer->text->result.get(), otherTermBuffer->text->length);
+        if (preUTF8Strings) {
+            return compareChars(text->result.get(), text->length, otherTermBuffer->text->result.get(), otherTermBuffer->text->length);
+        }
+        return BytesRef::compareBytes(bytes->result.get(), bytes->length, otherTermBuffer->bytes->result.get(), otherTermBuffer->bytes->length);
     } else {
         return field.compare(otherTermBuffer->field);
     }
 }
 
+int32_t TermBuffer::compareTerm(const TermPtr& term) {
+    if (field == term->_field) {
+        if (preUTF8Strings) {
+            return compareChars(text->result.get(), text->length, const_cast<wchar_t*>(term->_text.c_str()), (int32_t)term->_text.length());
+        }
+        BytesRefPtr termBytes(term->bytes());
+        return BytesRef::compareBytes(bytes->result.get(), bytes->length, termBytes->bytes.get() + termBytes->offset, termBytes->length);
+    } else {
+        return field.compare(term->_field);
+    }
+}
+
 int32_t TermBuffer::compareChars(wchar_t* chars1, int32_t len1, wchar_t* chars2, int32_t len2) {
     int32_t end = len1 < len2 ? len1 : len2;
     for (int32_t k = 0; k < end; ++k) {
@@ -49,6 +65,20 @@ void TermBuffer::setPreUTF8Strings() {
     preUTF8Strings = true;
 }
 
+bool TermBuffer::hasTerm() {
+    return !field.empty();
+}
+
+void TermBuffer::termBytes(const BytesRefPtr& result) {
+    if (preUTF8Strings) {
+        result->copyChars(text->result.get(), text->length);
+    } else {
+        result->bytes = bytes->result;
+        result->offset = 0;
+        result->length = bytes->length;
+    }
+}
+
 void TermBuffer::read(const IndexInputPtr& input, const FieldInfosPtr& fieldInfos) {
     this->term.reset(); // invalidate cache
     int32_t start = input->readVInt();
@@ -58,10 +88,9 @@ void TermBuffer::read(const IndexInputPtr& input, const FieldInfosPtr& fieldInfo
         text->setLength(totalLength);
         text->setLength(start + input->readChars(text->result.get(), start, length));
     } else {
-        StringUtils::toUTF8(text->result.get(), text->length, bytes);
+        // the shared prefix is already in place, so only the suffix is read and nothing is decoded
         bytes->setLength(totalLength);
         input->readBytes(bytes->result.get(), start, length);
-        StringUtils::toUnicode(bytes->result.get(), totalLength, text);
     }
     this->field = fieldInfos->fieldName(input->readVInt());
 }
@@ -71,16 +100,37 @@ void TermBuffer::set(const TermPtr& term) {
         reset();
         return;
     }
-    String termText(term->text());
-    int32_t termLen = termText.length();
-    text->setLength(termLen);
-    MiscUtils::arrayCopy(termText.begin(), 0, text->result.get(), 0, termLen);
+    if (preUTF8Strings) {
+        String termText(term->text());
+        int32_t termLen = termText.length();
+        text->setLength(termLen);
+        MiscUtils::arrayCopy(termText.begin(), 0, text->result.get(), 0, termLen);
+    } else {
+        BytesRefPtr termBytes(term->bytes());
+        bytes->setLength(termBytes->length);
+        MiscUtils::arrayCopy(termBytes->bytes.get(), termBytes->offset, bytes->result.get(), 0, termBytes->length);
+    }
     field = term->field();
     this->term = term;
 }
 
+void TermBuffer::set(const String& field, const wchar_t* text, int32_t length) {
+    if (preUTF8Strings) {
+        this->text->setLength(length);
+        MiscUtils::arrayCopy(text, 0, this->text->result.get(), 0, length);
+    } else {
+        StringUtils::toUTF8(text, length, bytes);
+    }
+    this->field = field;
+    this->term.reset();
+}
+
 void TermBuffer::set(const TermBufferPtr& other) {
-    text->copyText(other->text);
+    if (preUTF8Strings) {
+        text->copyText(other->text);
+    } else {
+        bytes->copyText(other->bytes);
+    }
     field = other->field;
     term = other->term;
 }
@@ -88,6 +138,7 @@ void TermBuffer::set(const TermBufferPtr& other) {
 void TermBuffer::reset() {
     field.clear();
     text->setLength(0);
+    bytes->setLength(0);
     term.reset();
 }
 
@@ -97,7 +148,11 @@ TermPtr TermBuffer::toTerm() {
     }
 
     if (!term) {
-        term = newLucene<Term>(field, String(text->result.get(), text->length));
+        if (preUTF8Strings) {
+            term = newLucene<Term>(field, String(text->result.get(), text->length));
+        } else {
+            term = newLucene<Term>(field, StringUtils::toUnicode(bytes->result.get(), bytes->length));
+        }
     }
 
     return term;
@@ -111,6 +166,7 @@ LuceneObjectPtr TermBuffer::clone(const LuceneObjectPtr& other) {
     cloneBuffer->preUTF8Strings = preUTF8Strings;
 
     cloneBuffer->bytes = newLucene<UTF8Result>();
+    cloneBuffer->bytes->copyText(bytes);
     cloneBuffer->text = newLucene<UnicodeResult>();
     cloneBuffer->text->copyText(text);
     return cloneBuffer;
@@ -52,4 +52,16 @@ void TermDocs::close() {
     // override
 }
 
+int32_t TermDocs::maxFreq() {
+    return -1; // not recorded
+}
+
+int32_t TermDocs::advanceShallow(int32_t target) {
+    return INT_MAX; // a single block holding every document
+}
+
+int32_t TermDocs::blockMaxFreq() {
+    return maxFreq();
+}
+
 }
@@ -10,13 +10,16 @@
 #include "Directory.h"
 #include "IndexFileNames.h"
 #include "Term.h"
+#include "TermInfo.h"
+#include "TermsIndexFST.h"
 #include "StringUtils.h"
+#include "SearchArena.h"
 
 namespace Lucene {
 
 const int32_t TermInfosReader::DEFAULT_CACHE_SIZE = 1024;
 
-TermInfosReader::TermInfosReader(const DirectoryPtr& dir, const String& seg, const FieldInfosPtr& fis, int32_t readBufferSize, int32_t indexDivisor) {
+TermInfosReader::TermInfosReader(const DirectoryPtr& dir, const String& seg, const FieldInfosPtr& fis, int32_t readBufferSize, int32_t indexDivisor) : threadResources(true) {
     bool success = false;
 
     if (indexDivisor < 1 && indexDivisor != -1) {
@@ -28,6 +31,7 @@ TermInfosReader::TermInfosReader(const DirectoryPtr& dir, const String& seg, con
         directory = dir;
         segment = seg;
         fieldInfos = fis;
+        indexSize = 0;
 
         origEnum = newLucene<SegmentTermEnum>(directory->openInput(segment + L"." + IndexFileNames::TERMS_EXTENSION(), readBufferSize), fieldInfos, false);
         _size = origEnum->size;
@@ -38,16 +42,38 @@ TermInfosReader::TermInfosReader(const DirectoryPtr& dir, const String& seg, con
             SegmentTermEnumPtr indexEnum(newLucene<SegmentTermEnum>(directory->openInput(segment + L"." + IndexFileNames::TERMS_INDEX_EXTENSION(), readBufferSize), fieldInfos, true));
 
             try {
-                int32_t indexSize = 1 + ((int32_t)indexEnum->size - 1) / indexDivisor; // otherwise read index
-
-                indexTerms = Collection<TermPtr>::newInstance(indexSize);
-                indexInfos = Collection<TermInfoPtr>::newInstance(indexSize);
-                indexPointers = Collection<int64_t>::newInstance(indexSize);
-
-                for (int32_t i = 0; indexEnum->next(); ++i) {
-                    indexTerms[i] = indexEnum->term();
-                    indexInfos[i] = indexEnum->termInfo();
-                    indexPointers[i] = indexEnum->indexPointer;
+                int32_t maxIndexSize = 1 + ((int32_t)indexEnum->size - 1) / indexDivisor; // otherwise read index
+
+                TermsIndexFSTPtr fst(newLucene<TermsIndexFST>());
+                indexDocFreqs = IntArray::newInstance(maxIndexSize);
+                indexFreqPointers = LongArray::newInstance(maxIndexSize);
+                indexProxPointers = LongArray::newInstance(maxIndexSize);
+                indexSkipOffsets = IntArray::newInstance(maxIndexSize);
+                indexPointers = LongArray::newInstance(maxIndexSize);
+                TermInfoPtr ti(newLucene<TermInfo>());
+
+                indexSize = 0;
+                while (indexEnum->next()) {
+                    // the first entry is the empty term, which sorts before every other
+                    TermPtr term(indexEnum->term());
+                    int32_t ordinal = term ? fst->add(term->_field, term->_text.c_str(), (int32_t)term->_text.length()) : fst->add(L"", L"", 0);
+                    if (ordinal != indexSize && !indexOffsets) {
+                        // an entry repeats the previous term, from now on ordinals and entries differ
+                        indexOffsets = IntArray::newInstance(maxIndexSize);
+                        for (int32_t i = 0; i < ordinal; ++i) {
+                            indexOffsets[i] = i;
+                        }
+                    }
+                    if (indexOffsets) {
+                        indexOffsets[ordinal] = indexSize;
+                    }
+                    indexEnum->termInfo(ti);
+                    indexDocFreqs[ordinal] = ti->docFreq;
+                    indexFreqPointers[ordinal] = ti->freqPointer;
+                    indexProxPointers[ordinal] = ti->proxPointer;
+                    indexSkipOffsets[ordinal] = ti->skipOffset;
+                    indexPointers[ordinal] = indexEnum->indexPointer;
+                    ++indexSize;
 
                     for (int32_t j = 1; j < indexDivisor; ++j) {
                         if (!indexEnum->next()) {
@@ -55,6 +81,8 @@ TermInfosReader::TermInfosReader(const DirectoryPtr& dir, const String& seg, con
                         }
                     }
                 }
+                fst->finish();
+                index = fst;
             } catch (LuceneException& e) {
                 finally = e;
             }
@@ -100,24 +128,32 @@ int64_t TermInfosReader::size() {
 TermInfosReaderThreadResourcesPtr TermInfosReader::getThreadResources() {
     TermInfosReaderThreadResourcesPtr resources(threadResources.get());
     if (!resources) {
+        // the resources outlive the request, so they must not pin its arena
+        SearchArena::Suspend suspend;
         resources = newLucene<TermInfosReaderThreadResources>();
         resources->termEnum = terms();
 
         // Cache does not have to be thread-safe, it is only used by one thread at the same time
         resources->termInfoCache = newInstance<TermInfoCache>(DEFAULT_CACHE_SIZE);
+        resources->indexInfo = newLucene<TermInfo>();
         threadResources.set(resources);
     }
     return resources;
 }
 
-int32_t TermInfosReader::getIndexOffset(const TermPtr& term) {
-    // binary search indexTerms
-    Collection<TermPtr>::iterator indexTerm = std::upper_bound(indexTerms.begin(), indexTerms.end(), term, luceneCompare<TermPtr>());
-    return (std::distance(indexTerms.begin(), indexTerm) - 1);
+int32_t TermInfosReader::getIndexOrdinal(const TermPtr& term) {
+    return index->floor(term->_field, term->_text);
 }
 
-void TermInfosReader::seekEnum(const SegmentTermEnumPtr& enumerator, int32_t indexOffset) {
-    enumerator->seek(indexPointers[indexOffset], ((int64_t)indexOffset * (int64_t)totalIndexInterval) - 1, indexTerms[indexOffset], indexInfos[indexOffset]);
+int32_t TermInfosReader::getIndexOffset(int32_t indexOrdinal) {
+    return (indexOffsets && indexOrdinal >= 0) ? indexOffsets[indexOrdinal] : indexOrdinal;
+}
+
+void TermInfosReader::seekEnum(const TermInfosReaderThreadResourcesPtr& resources, const SegmentTermEnumPtr& enumerator, int32_t indexOrdinal) {
+    int32_t length = index->getTerm(indexOrdinal, resources->indexField, resources->indexText);
+    resources->indexInfo->set(indexDocFreqs[indexOrdinal], indexFreqPointers[indexOrdinal], indexProxPointers[indexOrdinal], indexSkipOffsets[indexOrdinal]);
+    int64_t position = ((int64_t)getIndexOffset(indexOrdinal) * (int64_t)totalIndexInterval) - 1;
+    enumerator->seek(indexPointers[indexOrdinal], position, resources->indexField, resources->indexText.get(), length, resources->indexInfo);
 }
 
 TermInfoPtr TermInfosReader::get(const TermPtr& term) {
@@ -128,11 +164,21 @@ TermInfoPtr TermInfosReader::get(const TermPtr& term, bool useCache) {
     if (_size == 0) {
         return TermInfoPtr();
     }
+    return get(getThreadResources(), term, useCache);
+}
+
+TermInfoPtr TermInfosReader::get(const TermInfosReaderThreadResourcesPtr& resources, const TermPtr& term, bool useCache) {
+    if (_size == 0) {
+        return TermInfoPtr();
+    }
 
     ensureIndexIsRead();
 
+    // the cache entries and the state of the enum outlive the request, so they must not pin its arena;
+    // the term looked up may come from the arena and is copied before it is cached
+    SearchArena::Suspend suspend;
+
     TermInfoPtr ti;
-    TermInfosReaderThreadResourcesPtr resources(getThreadResources());
     TermInfoCachePtr cache;
 
     if (useCache) {
@@ -146,22 +192,31 @@ TermInfoPtr TermInfosReader::get(const TermPtr& term, bool useCache) {
 
     // optimize sequential access: first try scanning cached enum without seeking
     SegmentTermEnumPtr enumerator = resources->termEnum;
+    int32_t indexOrdinal = -1;
+    bool indexLookedUp = false;
 
-    if (enumerator->term() && // term is at or past current
-            ((enumerator->prev() && term->compareTo(enumerator->prev()) > 0) ||
-             term->compareTo(enumerator->term()) >= 0)) {
+    // terms are compared as the UTF-8 bytes held by the enum, without decoding them to Terms
+    if (enumerator->hasTerm() && // term is at or past current
+            ((enumerator->hasPrev() && enumerator->comparePrev(term) < 0) ||
+             enumerator->compareTerm(term) <= 0)) {
         int32_t enumOffset = (int32_t)(enumerator->position / totalIndexInterval ) + 1;
-        if (indexTerms.size() == enumOffset || // but before end of block
-                term->compareTo(indexTerms[enumOffset]) < 0) {
+        bool beforeNextEntry = (indexSize == enumOffset);
+        if (!beforeNextEntry) {
+            // the term sorts before the next index entry if its floor entry comes before that one
+            indexOrdinal = getIndexOrdinal(term);
+            indexLookedUp = true;
+            beforeNextEntry = (getIndexOffset(indexOrdinal) < enumOffset);
+        }
+        if (beforeNextEntry) { // but before end of block
             // no need to seek
             int32_t numScans = enumerator->scanTo(term);
-            if (enumerator->term() && term->compareTo(enumerator->term()) == 0) {
+            if (enumerator->hasTerm() && enumerator->compareTerm(term) == 0) {
                 ti = enumerator->termInfo();
                 if (cache && numScans > 1) {
                     // we only want to put this TermInfo into the cache if scanEnum skipped more
                     // than one dictionary entry. This prevents RangeQueries or WildcardQueries to
                     // wipe out the cache when they iterate over a large numbers of terms in order.
-                    cache->put(term, ti);
+                    cache->put(suspend.isSuspending() ? newLucene<Term>(term->_field, term->_text) : term, ti);
                 }
             } else {
                 ti.reset();
@@ -171,12 +226,12 @@ TermInfoPtr TermInfosReader::get(const TermPtr& term, bool useCache) {
     }
 
     // random-access: must seek
-    seekEnum(enumerator, getIndexOffset(term));
+    seekEnum(resources, enumerator, indexLookedUp ? indexOrdinal : getIndexOrdinal(term));
     enumerator->scanTo(term);
-    if (enumerator->term() && term->compareTo(enumerator->term()) == 0) {
+    if (enumerator->hasTerm() && enumerator->compareTerm(term) == 0) {
         ti = enumerator->termInfo();
         if (cache) {
-            cache->put(term, ti);
+            cache->put(suspend.isSuspending() ? newLucene<Term>(term->_field, term->_text) : term, ti);
         }
     } else {
         ti.reset();
@@ -185,7 +240,7 @@ TermInfoPtr TermInfosReader::get(const TermPtr& term, bool useCache) {
 }
 
 void TermInfosReader::ensureIndexIsRead() {
-    if (!indexTerms) {
+    if (!index) {
         boost::throw_exception(IllegalStateException(L"terms index was not loaded when this reader was created"));
     }
 }
@@ -196,15 +251,16 @@ int64_t TermInfosReader::getPosition(const TermPtr& term) {
     }
 
     ensureIndexIsRead();
-    int32_t indexOffset = getIndexOffset(term);
+    int32_t indexOrdinal = getIndexOrdinal(term);
 
-    SegmentTermEnumPtr enumerator(getThreadResources()->termEnum);
-    seekEnum(enumerator, indexOffset);
+    TermInfosReaderThreadResourcesPtr resources(getThreadResources());
+    SegmentTermEnumPtr enumerator(resources->termEnum);
+    seekEnum(resources, enumerator, indexOrdinal);
 
-    while (term->compareTo(enumerator->term()) > 0 && enumerator->next()) {
+    while (enumerator->compareTerm(term) < 0 && enumerator->next()) {
     }
 
-    return term->compareTo(enumerator->term()) == 0 ? enumerator->position : -1;
+    return (enumerator->hasTerm() && enumerator->compareTerm(term) == 0) ? enumerator->position : -1;
 }
 
 SegmentTermEnumPtr TermInfosReader::terms() {
@@ -212,9 +268,11 @@ SegmentTermEnumPtr TermInfosReader::terms() {
 }
 
 SegmentTermEnumPtr TermInfosReader::terms(const TermPtr& term) {
-    // don't use the cache in this call because we want to reposition the enumeration
-    get(term, false);
-    return std::static_pointer_cast<SegmentTermEnum>(getThreadResources()->termEnum->clone());
+    // don't use the cache in this call because we want to reposition the enumeration.  The resources are
+    // held across the seek and the clone, so that their slot can't be handed to another thread in between
+    TermInfosReaderThreadResourcesPtr resources(getThreadResources());
+    get(resources, term, false);
+    return std::static_pointer_cast<SegmentTermEnum>(resources->termEnum->clone());
 }
 
 TermInfosReaderThreadResources::~TermInfosReaderThreadResources() {
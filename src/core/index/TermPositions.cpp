@@ -20,6 +20,12 @@ int32_t TermPositions::nextPosition() {
     return 0; // override
 }
 
+void TermPositions::readPositions(int32_t* positions, int32_t count) {
+    for (int32_t i = 0; i < count; ++i) {
+        positions[i] = nextPosition();
+    }
+}
+
 int32_t TermPositions::getPayloadLength() {
     BOOST_ASSERT(false);
     return 0; // override
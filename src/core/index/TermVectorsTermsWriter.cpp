@@ -13,6 +13,7 @@
 #include "TermsHashPerThread.h"
 #include "RAMOutputStream.h"
 #include "IndexWriter.h"
+#include "DocumentsWriterPerThread.h"
 #include "IndexFileNames.h"
 #include "SegmentWriteState.h"
 #include "Directory.h"
@@ -21,7 +22,7 @@
 
 namespace Lucene {
 
-TermVectorsTermsWriter::TermVectorsTermsWriter(const DocumentsWriterPtr& docWriter) {
+TermVectorsTermsWriter::TermVectorsTermsWriter(const DocumentsWriterPerThreadPtr& docWriter) {
     this->freeCount = 0;
     this->lastDocID = 0;
     this->allocCount = 0;
@@ -53,7 +54,7 @@ void TermVectorsTermsWriter::flush(MapTermsHashConsumerPerThreadCollectionTermsH
     if (tvx) {
         if (state->numDocsInStore > 0) {
             // In case there are some final documents that we didn't see (because they hit a non-aborting exception)
-            fill(state->numDocsInStore - DocumentsWriterPtr(_docWriter)->getDocStoreOffset());
+            fill(state->numDocsInStore - DocumentsWriterPerThreadPtr(_docWriter)->getDocStoreOffset());
         }
 
         tvx->flush();
@@ -76,7 +77,7 @@ void TermVectorsTermsWriter::flush(MapTermsHashConsumerPerThreadCollectionTermsH
 void TermVectorsTermsWriter::closeDocStore(const SegmentWriteStatePtr& state) {
     SyncLock syncLock(this);
     if (tvx) {
-        DocumentsWriterPtr docWriter(_docWriter);
+        DocumentsWriterPerThreadPtr docWriter(_docWriter);
 
         // At least one doc in this run had term vectors enabled
         fill(state->numDocsInStore - docWriter->getDocStoreOffset());
@@ -121,7 +122,7 @@ TermVectorsTermsWriterPerDocPtr TermVectorsTermsWriter::getPerDoc() {
 }
 
 void TermVectorsTermsWriter::fill(int32_t docID) {
-    int32_t docStoreOffset = DocumentsWriterPtr(_docWriter)->getDocStoreOffset();
+    int32_t docStoreOffset = DocumentsWriterPerThreadPtr(_docWriter)->getDocStoreOffset();
     int32_t end = docID + docStoreOffset;
     if (lastDocID < end) {
         int64_t tvfPosition = tvf->getFilePointer();
@@ -137,7 +138,7 @@ void TermVectorsTermsWriter::fill(int32_t docID) {
 void TermVectorsTermsWriter::initTermVectorsWriter() {
     SyncLock syncLock(this);
     if (!tvx) {
-        DocumentsWriterPtr docWriter(_docWriter);
+        DocumentsWriterPerThreadPtr docWriter(_docWriter);
 
         String docStoreSegment(docWriter->getDocStoreSegment());
         if (docStoreSegment.empty()) {
@@ -164,7 +165,7 @@ void TermVectorsTermsWriter::initTermVectorsWriter() {
 
 void TermVectorsTermsWriter::finishDocument(const TermVectorsTermsWriterPerDocPtr& perDoc) {
     SyncLock syncLock(this);
-    DocumentsWriterPtr docWriter(_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(_docWriter);
 
     BOOST_ASSERT(IndexWriterPtr(docWriter->_writer)->testPoint(L"TermVectorsTermsWriter.finishDocument start"));
 
@@ -243,7 +244,7 @@ int32_t TermVectorsTermsWriter::bytesPerPosting() {
 
 TermVectorsTermsWriterPerDoc::TermVectorsTermsWriterPerDoc(const TermVectorsTermsWriterPtr& termsWriter) {
     this->_termsWriter = termsWriter;
-    buffer = DocumentsWriterPtr(termsWriter->_docWriter)->newPerDocBuffer();
+    buffer = DocumentsWriterPerThreadPtr(termsWriter->_docWriter)->newPerDocBuffer();
     perDocTvf = newLucene<RAMOutputStream>(buffer);
     numVectorFields = 0;
     fieldNumbers = Collection<int32_t>::newInstance(1);
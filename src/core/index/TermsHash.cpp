@@ -7,6 +7,7 @@
 #include "LuceneInc.h"
 #include "TermsHash.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 #include "TermsHashConsumer.h"
 #include "TermsHashPerThread.h"
 #include "TermsHashPerField.h"
@@ -18,7 +19,7 @@
 
 namespace Lucene {
 
-TermsHash::TermsHash(const DocumentsWriterPtr& docWriter, bool trackAllocations, const TermsHashConsumerPtr& consumer, const TermsHashPtr& nextTermsHash) {
+TermsHash::TermsHash(const DocumentsWriterPerThreadPtr& docWriter, bool trackAllocations, const TermsHashConsumerPtr& consumer, const TermsHashPtr& nextTermsHash) {
     this->postingsFreeCount = 0;
     this->postingsAllocCount = 0;
     this->trackAllocations = false;
@@ -63,7 +64,7 @@ void TermsHash::shrinkFreePostings(MapInvertedDocConsumerPerThreadCollectionInve
     if (newSize != postingsFreeList.size()) {
         if (postingsFreeCount > newSize) {
             if (trackAllocations) {
-                DocumentsWriterPtr(_docWriter)->bytesAllocated(-(postingsFreeCount - newSize) * bytesPerPosting);
+                DocumentsWriterPerThreadPtr(_docWriter)->bytesAllocated(-(postingsFreeCount - newSize) * bytesPerPosting);
             }
             postingsFreeCount = newSize;
             postingsAllocCount = newSize;
@@ -138,7 +139,7 @@ bool TermsHash::freeRAM() {
     }
 
     if (any) {
-        DocumentsWriterPtr(_docWriter)->bytesAllocated(bytesFreed);
+        DocumentsWriterPerThreadPtr(_docWriter)->bytesAllocated(bytesFreed);
     }
 
     if (nextTermsHash && nextTermsHash->freeRAM()) {
@@ -161,7 +162,7 @@ void TermsHash::recyclePostings(Collection<RawPostingListPtr> postings, int32_t
 
 void TermsHash::getPostings(Collection<RawPostingListPtr> postings) {
     SyncLock syncLock(this);
-    DocumentsWriterPtr docWriter(_docWriter);
+    DocumentsWriterPerThreadPtr docWriter(_docWriter);
     IndexWriterPtr writer(docWriter->_writer);
 
     BOOST_ASSERT(writer->testPoint(L"TermsHash.getPostings start"));
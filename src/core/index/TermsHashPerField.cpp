@@ -22,8 +22,17 @@
 #include "UTF8Stream.h"
 #include "MiscUtils.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace Lucene {
 
+const int32_t TermsHashPerField::HASH_INIT_SIZE = 16;
+
+// Four 32-bit hash codes fill one SSE2 register
+const int32_t TermsHashPerField::HASH_GROUP_SIZE = 4;
+
 TermsHashPerField::TermsHashPerField(const DocInverterPerFieldPtr& docInverterPerField, const TermsHashPerThreadPtr& perThread, const TermsHashPerThreadPtr& nextPerThread, const FieldInfoPtr& fieldInfo) {
     this->_docInverterPerField = docInverterPerField;
     this->_perThread = perThread;
@@ -37,10 +46,13 @@ TermsHashPerField::~TermsHashPerField() {
 void TermsHashPerField::initialize() {
     this->postingsCompacted = false;
     this->numPostings = 0;
-    this->postingsHashSize = 4;
+    this->postingsHashSize = HASH_INIT_SIZE;
     this->postingsHashHalfSize = this->postingsHashSize / 2;
     this->postingsHashMask = this->postingsHashSize - 1;
-    this->postingsHash = Collection<RawPostingListPtr>::newInstance(postingsHashSize);
+    this->postingsHashCodes = IntArray::newInstance(postingsHashSize);
+    this->postingsHashIds = IntArray::newInstance(postingsHashSize);
+    MiscUtils::arrayFill(postingsHashIds.get(), 0, postingsHashSize, -1);
+    this->postings = Collection<RawPostingListPtr>::newInstance(postingsHashHalfSize);
     this->doCall = false;
     this->doNextCall = false;
     this->intUptoStart = 0;
@@ -63,24 +75,25 @@ void TermsHashPerField::initialize() {
 void TermsHashPerField::shrinkHash(int32_t targetSize) {
     BOOST_ASSERT(postingsCompacted || numPostings == 0);
 
-    int32_t newSize = 4;
-    if (newSize != postingsHash.size()) {
-        postingsHash.resize(newSize);
+    int32_t newSize = HASH_INIT_SIZE;
+    if (newSize != postingsHashSize) {
+        postingsHashCodes.resize(newSize);
+        postingsHashIds.resize(newSize);
+        postings.resize(newSize / 2);
         postingsHashSize = newSize;
         postingsHashHalfSize = newSize / 2;
         postingsHashMask = newSize - 1;
     }
-    MiscUtils::arrayFill(postingsHash.begin(), 0, postingsHash.size(), RawPostingListPtr());
+    MiscUtils::arrayFill(postingsHashIds.get(), 0, postingsHashSize, -1);
+    MiscUtils::arrayFill(postings.begin(), 0, postings.size(), RawPostingListPtr());
 }
 
 void TermsHashPerField::reset() {
-    if (!postingsCompacted) {
-        compactPostings();
-    }
-    BOOST_ASSERT(numPostings <= postingsHash.size());
+    BOOST_ASSERT(numPostings <= postings.size());
     if (numPostings > 0) {
-        TermsHashPtr(TermsHashPerThreadPtr(_perThread)->_termsHash)->recyclePostings(postingsHash, numPostings);
-        MiscUtils::arrayFill(postingsHash.begin(), 0, numPostings, RawPostingListPtr());
+        TermsHashPtr(TermsHashPerThreadPtr(_perThread)->_termsHash)->recyclePostings(postings, numPostings);
+        MiscUtils::arrayFill(postings.begin(), 0, numPostings, RawPostingListPtr());
+        MiscUtils::arrayFill(postingsHashIds.get(), 0, postingsHashSize, -1);
         numPostings = 0;
     }
     postingsCompacted = false;
@@ -104,23 +117,6 @@ void TermsHashPerField::initReader(const ByteSliceReaderPtr& reader, const RawPo
     reader->init(bytePool, p->byteStart + stream * ByteBlockPool::FIRST_LEVEL_SIZE(), ints[upto + stream]);
 }
 
-void TermsHashPerField::compactPostings() {
-    SyncLock syncLock(this);
-    int32_t upto = 0;
-    for (int32_t i = 0; i < postingsHashSize; ++i) {
-        if (postingsHash[i]) {
-            if (upto < i) {
-                postingsHash[upto] = postingsHash[i];
-                postingsHash[i].reset();
-            }
-            ++upto;
-        }
-    }
-
-    BOOST_ASSERT(upto == numPostings);
-    postingsCompacted = true;
-}
-
 struct comparePostings {
     comparePostings(Collection<CharArray> buffers) {
         this->buffers = buffers;
@@ -161,15 +157,54 @@ struct comparePostings {
 };
 
 Collection<RawPostingListPtr> TermsHashPerField::sortPostings() {
-    compactPostings();
-    std::sort(postingsHash.begin(), postingsHash.begin() + numPostings, comparePostings(charPool->buffers));
-    return postingsHash;
+    postingsCompacted = true;
+    std::sort(postings.begin(), postings.begin() + numPostings, comparePostings(charPool->buffers));
+    return postings;
+}
+
+int32_t TermsHashPerField::hashStart(int32_t code, int32_t mask) {
+    uint32_t hash = (uint32_t)code * 0x9e3779b9;
+    return (int32_t)(hash ^ (hash >> 16)) & mask;
+}
+
+int32_t TermsHashPerField::findSlot(int32_t code, const wchar_t* tokenText, int32_t tokenTextLen) {
+    BOOST_ASSERT(!postingsCompacted);
+    int32_t group = hashStart(code, postingsHashMask) & ~(HASH_GROUP_SIZE - 1);
+    while (true) {
+#ifdef __SSE2__
+        __m128i codes = _mm_loadu_si128((const __m128i*)(postingsHashCodes.get() + group));
+        __m128i ids = _mm_loadu_si128((const __m128i*)(postingsHashIds.get() + group));
+        uint32_t free = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(ids, _mm_set1_epi32(-1))));
+        uint32_t matches = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(codes, _mm_set1_epi32(code)))) & ~free;
+        while (matches != 0) {
+            int32_t slot = group + __builtin_ctz(matches);
+            if (!tokenText || postingEquals(postings[postingsHashIds[slot]], tokenText, tokenTextLen)) {
+                return slot;
+            }
+            matches &= matches - 1;
+        }
+        if (free != 0) {
+            // Slots are never freed while the hash is in use, so the term is not in a later group
+            return group + __builtin_ctz(free);
+        }
+#else
+        for (int32_t slot = group; slot < group + HASH_GROUP_SIZE; ++slot) {
+            if (postingsHashIds[slot] == -1) {
+                return slot;
+            }
+            if (postingsHashCodes[slot] == code && (!tokenText || postingEquals(postings[postingsHashIds[slot]], tokenText, tokenTextLen))) {
+                return slot;
+            }
+        }
+#endif
+        group = (group + HASH_GROUP_SIZE) & postingsHashMask;
+    }
 }
 
-bool TermsHashPerField::postingEquals(const wchar_t* tokenText, int32_t tokenTextLen) {
-    wchar_t* text = TermsHashPerThreadPtr(_perThread)->charPool->buffers[p->textStart >> DocumentsWriter::CHAR_BLOCK_SHIFT].get();
+bool TermsHashPerField::postingEquals(const RawPostingListPtr& posting, const wchar_t* tokenText, int32_t tokenTextLen) {
+    wchar_t* text = charPool->buffers[posting->textStart >> DocumentsWriter::CHAR_BLOCK_SHIFT].get();
     BOOST_ASSERT(text);
-    int32_t pos = (p->textStart & DocumentsWriter::CHAR_BLOCK_MASK);
+    int32_t pos = (posting->textStart & DocumentsWriter::CHAR_BLOCK_MASK);
     int32_t tokenPos = 0;
     for (; tokenPos < tokenTextLen; ++pos, ++tokenPos) {
         if (tokenText[tokenPos] != text[pos]) {
@@ -196,76 +231,67 @@ bool TermsHashPerField::start(Collection<FieldablePtr> fields, int32_t count) {
 }
 
 void TermsHashPerField::add(int32_t textStart) {
-    // Secondary entry point (for 2nd and subsequent TermsHash), we hash by textStart
-    int32_t code = textStart;
-
-    int32_t hashPos = (code & postingsHashMask);
+    // Secondary entry point (for 2nd and subsequent TermsHash), we hash by textStart, which is unique per term
+    int32_t slot = findSlot(textStart, NULL, 0);
+    int32_t id = postingsHashIds[slot];
 
-    BOOST_ASSERT(!postingsCompacted);
-
-    // Locate RawPostingList in hash
-    p = postingsHash[hashPos];
-
-    if (p && p->textStart != textStart) {
-        // Conflict: keep searching different locations in the hash table.
-        int32_t inc = (((code >> 8) + code) | 1);
-        do {
-            code += inc;
-            hashPos = (code & postingsHashMask);
-            p = postingsHash[hashPos];
-        } while (p && p->textStart != textStart);
-    }
-
-    if (!p) {
+    if (id == -1) {
         // First time we are seeing this token since we last flushed the hash.
-        TermsHashPerThreadPtr perThread(_perThread);
+        addPosting(slot, textStart, textStart);
+    } else {
+        p = postings[id];
+        BOOST_ASSERT(p->textStart == textStart);
+        intUptos = intPool->buffers[p->intStart >> DocumentsWriter::INT_BLOCK_SHIFT];
+        intUptoStart = (p->intStart & DocumentsWriter::INT_BLOCK_MASK);
+        consumer->addTerm(p);
+    }
+}
 
-        // Refill?
-        if (perThread->freePostingsCount == 0) {
-            perThread->morePostings();
-        }
+void TermsHashPerField::addPosting(int32_t slot, int32_t code, int32_t textStart) {
+    TermsHashPerThreadPtr perThread(_perThread);
 
-        // Pull next free RawPostingList from free list
-        p = perThread->freePostings[--perThread->freePostingsCount];
-        BOOST_ASSERT(p);
+    // Refill?
+    if (perThread->freePostingsCount == 0) {
+        perThread->morePostings();
+    }
 
-        p->textStart = textStart;
+    // Pull next free RawPostingList from free list
+    p = perThread->freePostings[--perThread->freePostingsCount];
+    BOOST_ASSERT(p);
 
-        BOOST_ASSERT(!postingsHash[hashPos]);
-        postingsHash[hashPos] = p;
-        ++numPostings;
+    p->textStart = textStart;
 
-        if (numPostings == postingsHashHalfSize) {
-            rehashPostings(2 * postingsHashSize);
-        }
+    BOOST_ASSERT(postingsHashIds[slot] == -1);
+    postingsHashCodes[slot] = code;
+    postingsHashIds[slot] = numPostings;
+    postings[numPostings++] = p;
 
-        // Init stream slices
-        if (numPostingInt + intPool->intUpto > DocumentsWriter::INT_BLOCK_SIZE) {
-            intPool->nextBuffer();
-        }
+    if (numPostings == postingsHashHalfSize) {
+        rehashPostings(2 * postingsHashSize);
+    }
 
-        if (DocumentsWriter::BYTE_BLOCK_SIZE - bytePool->byteUpto < numPostingInt * ByteBlockPool::FIRST_LEVEL_SIZE()) {
-            bytePool->nextBuffer();
-        }
+    // Init stream slices
+    if (numPostingInt + intPool->intUpto > DocumentsWriter::INT_BLOCK_SIZE) {
+        intPool->nextBuffer();
+    }
 
-        intUptos = intPool->buffer;
-        intUptoStart = intPool->intUpto;
-        intPool->intUpto += streamCount;
+    if (DocumentsWriter::BYTE_BLOCK_SIZE - bytePool->byteUpto < numPostingInt * ByteBlockPool::FIRST_LEVEL_SIZE()) {
+        bytePool->nextBuffer();
+    }
 
-        p->intStart = intUptoStart + intPool->intOffset;
+    intUptos = intPool->buffer;
+    intUptoStart = intPool->intUpto;
+    intPool->intUpto += streamCount;
 
-        for (int32_t i = 0; i < streamCount; ++i) {
-            int32_t upto = bytePool->newSlice(ByteBlockPool::FIRST_LEVEL_SIZE());
-            intUptos[intUptoStart + i] = upto + bytePool->byteOffset;
-        }
-        p->byteStart = intUptos[intUptoStart];
+    p->intStart = intUptoStart + intPool->intOffset;
 
-        consumer->newTerm(p);
-    } else {
-        intUptos = intPool->buffers[p->intStart >> DocumentsWriter::INT_BLOCK_SHIFT];
-        intUptoStart = (p->intStart & DocumentsWriter::INT_BLOCK_MASK);
-        consumer->addTerm(p);
+    for (int32_t i = 0; i < streamCount; ++i) {
+        int32_t upto = bytePool->newSlice(ByteBlockPool::FIRST_LEVEL_SIZE());
+        intUptos[intUptoStart + i] = upto + bytePool->byteOffset;
     }
+    p->byteStart = intUptos[intUptoStart];
+
+    consumer->newTerm(p);
 }
 
 void TermsHashPerField::add() {
@@ -317,22 +343,11 @@ void TermsHashPerField::add() {
         code = (code * 31) + ch;
     }
 
-    int32_t hashPos = (code & postingsHashMask);
-
     // Locate RawPostingList in hash
-    p = postingsHash[hashPos];
-
-    if (p && !postingEquals(tokenText, tokenTextLen)) {
-        // Conflict: keep searching different locations in the hash table.
-        int32_t inc = (((code >> 8) + code) | 1);
-        do {
-            code += inc;
-            hashPos = (code & postingsHashMask);
-            p = postingsHash[hashPos];
-        } while (p && !postingEquals(tokenText, tokenTextLen));
-    }
+    int32_t slot = findSlot(code, tokenText, tokenTextLen);
+    int32_t id = postingsHashIds[slot];
 
-    if (!p) {
+    if (id == -1) {
         // First time we are seeing this token since we last flushed the hash.
         int32_t textLen1 = 1 + tokenTextLen;
         if (textLen1 + charPool->charUpto > DocumentsWriter::CHAR_BLOCK_SIZE) {
@@ -351,57 +366,17 @@ void TermsHashPerField::add() {
             charPool->nextBuffer();
         }
 
-        TermsHashPerThreadPtr perThread(_perThread);
-
-        // Refill?
-        if (perThread->freePostingsCount == 0) {
-            perThread->morePostings();
-        }
-
-        // Pull next free RawPostingList from free list
-        p = perThread->freePostings[--perThread->freePostingsCount];
-        BOOST_ASSERT(p);
-
         wchar_t* text = charPool->buffer.get();
         int32_t textUpto = charPool->charUpto;
-
-        p->textStart = textUpto + charPool->charOffset;
+        int32_t textStart = textUpto + charPool->charOffset;
         charPool->charUpto += textLen1;
 
         MiscUtils::arrayCopy(tokenText, 0, text, textUpto, tokenTextLen);
         text[textUpto + tokenTextLen] = UTF8Base::UNICODE_TERMINATOR;
 
-        BOOST_ASSERT(!postingsHash[hashPos]);
-        postingsHash[hashPos] = p;
-        ++numPostings;
-
-        if (numPostings == postingsHashHalfSize) {
-            rehashPostings(2 * postingsHashSize);
-        }
-
-        // Init stream slices
-        if (numPostingInt + intPool->intUpto > DocumentsWriter::INT_BLOCK_SIZE) {
-            intPool->nextBuffer();
-        }
-
-        if (DocumentsWriter::BYTE_BLOCK_SIZE - bytePool->byteUpto < numPostingInt * ByteBlockPool::FIRST_LEVEL_SIZE()) {
-            bytePool->nextBuffer();
-        }
-
-        intUptos = intPool->buffer;
-        intUptoStart = intPool->intUpto;
-        intPool->intUpto += streamCount;
-
-        p->intStart = intUptoStart + intPool->intOffset;
-
-        for (int32_t i = 0; i < streamCount; ++i) {
-            int32_t upto = bytePool->newSlice(ByteBlockPool::FIRST_LEVEL_SIZE());
-            intUptos[intUptoStart + i] = upto + bytePool->byteOffset;
-        }
-        p->byteStart = intUptos[intUptoStart];
-
-        consumer->newTerm(p);
+        addPosting(slot, code, textStart);
     } else {
+        p = postings[id];
         intUptos = intPool->buffers[p->intStart >> DocumentsWriter::INT_BLOCK_SHIFT];
         intUptoStart = (p->intStart & DocumentsWriter::INT_BLOCK_MASK);
         consumer->addTerm(p);
@@ -453,45 +428,29 @@ void TermsHashPerField::finish() {
 void TermsHashPerField::rehashPostings(int32_t newSize) {
     int32_t newMask = newSize - 1;
 
-    Collection<RawPostingListPtr> newHash(Collection<RawPostingListPtr>::newInstance(newSize));
-    TermsHashPerThreadPtr perThread(_perThread);
+    IntArray newCodes(IntArray::newInstance(newSize));
+    IntArray newIds(IntArray::newInstance(newSize));
+    MiscUtils::arrayFill(newIds.get(), 0, newSize, -1);
 
+    // The codes are kept in the table, so terms are moved without looking at their text
     for (int32_t i = 0; i < postingsHashSize; ++i) {
-        RawPostingListPtr p0(postingsHash[i]);
-        if (p0) {
-            int32_t code;
-            if (perThread->primary) {
-                int32_t start = (p0->textStart & DocumentsWriter::CHAR_BLOCK_MASK);
-                CharArray text = charPool->buffers[p0->textStart >> DocumentsWriter::CHAR_BLOCK_SHIFT];
-                int32_t pos = start;
-                while (text[pos] != UTF8Base::UNICODE_TERMINATOR) {
-                    ++pos;
-                }
-                code = 0;
-                while (pos > start) {
-                    code = (code * 31) + text[--pos];
-                }
-            } else {
-                code = p0->textStart;
-            }
-
-            int32_t hashPos = (code & newMask);
-            BOOST_ASSERT(hashPos >= 0);
-            if (newHash[hashPos]) {
-                int32_t inc = (((code >> 8) + code) | 1);
-                do {
-                    code += inc;
-                    hashPos = (code & newMask);
-                } while (newHash[hashPos]);
+        if (postingsHashIds[i] != -1) {
+            int32_t code = postingsHashCodes[i];
+            int32_t hashPos = hashStart(code, newMask) & ~(HASH_GROUP_SIZE - 1);
+            while (newIds[hashPos] != -1) {
+                hashPos = (hashPos + 1) & newMask;
             }
-            newHash[hashPos] = p0;
+            newCodes[hashPos] = code;
+            newIds[hashPos] = postingsHashIds[i];
         }
     }
 
     postingsHashMask = newMask;
-    postingsHash = newHash;
+    postingsHashCodes = newCodes;
+    postingsHashIds = newIds;
     postingsHashSize = newSize;
     postingsHashHalfSize = (newSize >> 1);
+    postings.resize(postingsHashHalfSize);
 }
 
 }
@@ -14,6 +14,7 @@
 #include "CharBlockPool.h"
 #include "IntBlockPool.h"
 #include "DocumentsWriter.h"
+#include "DocumentsWriterPerThread.h"
 
 namespace Lucene {
 
@@ -38,15 +39,15 @@ void TermsHashPerThread::initialize() {
 
     if (nextTermsHash) {
         // We are primary
-        charPool = newLucene<CharBlockPool>(DocumentsWriterPtr(termsHash->_docWriter));
+        charPool = newLucene<CharBlockPool>(DocumentsWriterPerThreadPtr(termsHash->_docWriter));
         primary = true;
     } else {
         charPool = TermsHashPerThreadPtr(_primaryPerThread)->charPool;
         primary = false;
     }
 
-    intPool = newLucene<IntBlockPool>(DocumentsWriterPtr(termsHash->_docWriter), termsHash->trackAllocations);
-    bytePool = newLucene<ByteBlockPool>(DocumentsWriterPtr(termsHash->_docWriter)->byteBlockAllocator, termsHash->trackAllocations);
+    intPool = newLucene<IntBlockPool>(DocumentsWriterPerThreadPtr(termsHash->_docWriter), termsHash->trackAllocations);
+    bytePool = newLucene<ByteBlockPool>(DocumentsWriterPerThreadPtr(termsHash->_docWriter)->byteBlockAllocator, termsHash->trackAllocations);
 
     if (nextTermsHash) {
         nextPerThread = nextTermsHash->addThread(docInverterPerThread, shared_from_this());
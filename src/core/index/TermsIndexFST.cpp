@@ -0,0 +1,259 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "TermsIndexFST.h"
+#include "MiscUtils.h"
+
+namespace Lucene {
+
+TermsIndexFST::TermsIndexFST() {
+    fields = Collection<String>::newInstance();
+    nodeArcs.push_back(0);
+    root = -1;
+    numKeys = 0;
+    frontier.resize(1);
+    frontier[0].final = false;
+    registry.resize(64, -1);
+    registered = 0;
+}
+
+TermsIndexFST::~TermsIndexFST() {
+}
+
+int32_t TermsIndexFST::add(const String& field, const wchar_t* text, int32_t length) {
+    if (root != -1) {
+        boost::throw_exception(IllegalStateException(L"terms index is already finished"));
+    }
+    if (fields.empty() || fields[fields.size() - 1] != field) {
+        if (!fields.empty() && field.compare(fields[fields.size() - 1]) < 0) {
+            boost::throw_exception(IllegalArgumentException(L"terms index keys must be added in order: " + field));
+        }
+        fields.add(field);
+    }
+    key.resize(length + 1);
+    key[0] = fields.size() - 1;
+    for (int32_t i = 0; i < length; ++i) {
+        key[i + 1] = (int32_t)text[i];
+    }
+
+    int32_t prefix = 0;
+    int32_t common = std::min((int32_t)key.size(), (int32_t)lastKey.size());
+    while (prefix < common && key[prefix] == lastKey[prefix]) {
+        ++prefix;
+    }
+    if (prefix == (int32_t)key.size() && prefix == (int32_t)lastKey.size()) {
+        return numKeys - 1; // same as the previous key
+    }
+    if (prefix < (int32_t)lastKey.size() && (prefix == (int32_t)key.size() || key[prefix] < lastKey[prefix])) {
+        boost::throw_exception(IllegalArgumentException(L"terms index keys must be added in order"));
+    }
+
+    // the nodes past the common prefix can no longer change
+    for (int32_t depth = (int32_t)lastKey.size(); depth > prefix; --depth) {
+        frontier[depth - 1].targets.back() = compileNode(frontier[depth]);
+    }
+
+    if ((int32_t)frontier.size() < (int32_t)key.size() + 1) {
+        frontier.resize(key.size() + 1);
+    }
+    for (int32_t depth = prefix; depth < (int32_t)key.size(); ++depth) {
+        frontier[depth].labels.push_back(key[depth]);
+        frontier[depth].targets.push_back(-1);
+        PendingNode& next = frontier[depth + 1];
+        next.final = false;
+        next.labels.clear();
+        next.targets.clear();
+    }
+    frontier[key.size()].final = true;
+    lastKey.swap(key);
+    return numKeys++;
+}
+
+void TermsIndexFST::finish() {
+    if (root != -1) {
+        return;
+    }
+    for (int32_t depth = (int32_t)lastKey.size(); depth > 0; --depth) {
+        frontier[depth - 1].targets.back() = compileNode(frontier[depth]);
+    }
+    root = compileNode(frontier[0]);
+
+    std::vector<PendingNode>().swap(frontier);
+    std::vector<int32_t>().swap(lastKey);
+    std::vector<int32_t>().swap(key);
+    std::vector<int32_t>().swap(registry);
+    nodeArcs.shrink_to_fit();
+    nodeCounts.shrink_to_fit();
+    nodeFinals.shrink_to_fit();
+    arcLabels.shrink_to_fit();
+    arcTargets.shrink_to_fit();
+    arcOutputs.shrink_to_fit();
+}
+
+int32_t TermsIndexFST::size() {
+    return numKeys;
+}
+
+int32_t TermsIndexFST::compileNode(PendingNode& node) {
+    int32_t mask = (int32_t)registry.size() - 1;
+    int32_t slot = hashPending(node) & mask;
+    while (registry[slot] != -1) {
+        if (equalsCompiled(node, registry[slot])) {
+            return registry[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    int32_t compiled = (int32_t)nodeCounts.size();
+    int32_t count = node.final ? 1 : 0;
+    for (int32_t i = 0; i < (int32_t)node.labels.size(); ++i) {
+        arcLabels.push_back(node.labels[i]);
+        arcTargets.push_back(node.targets[i]);
+        arcOutputs.push_back(count);
+        count += nodeCounts[node.targets[i]];
+    }
+    nodeCounts.push_back(count);
+    nodeFinals.push_back(node.final ? 1 : 0);
+    nodeArcs.push_back((int32_t)arcLabels.size());
+
+    registry[slot] = compiled;
+    if (++registered * 2 > (int32_t)registry.size()) {
+        growRegistry();
+    }
+    return compiled;
+}
+
+int32_t TermsIndexFST::hashPending(const PendingNode& node) {
+    uint32_t hash = node.final ? 1 : 0;
+    for (int32_t i = 0; i < (int32_t)node.labels.size(); ++i) {
+        hash = hash * 31 + (uint32_t)node.labels[i];
+        hash = hash * 31 + (uint32_t)node.targets[i];
+    }
+    return (int32_t)((hash * 0x9e3779b1) >> 1);
+}
+
+int32_t TermsIndexFST::hashCompiled(int32_t node) {
+    uint32_t hash = nodeFinals[node];
+    for (int32_t arc = nodeArcs[node]; arc < nodeArcs[node + 1]; ++arc) {
+        hash = hash * 31 + (uint32_t)arcLabels[arc];
+        hash = hash * 31 + (uint32_t)arcTargets[arc];
+    }
+    return (int32_t)((hash * 0x9e3779b1) >> 1);
+}
+
+bool TermsIndexFST::equalsCompiled(const PendingNode& node, int32_t compiled) {
+    int32_t start = nodeArcs[compiled];
+    if ((nodeFinals[compiled] != 0) != node.final || nodeArcs[compiled + 1] - start != (int32_t)node.labels.size()) {
+        return false;
+    }
+    for (int32_t i = 0; i < (int32_t)node.labels.size(); ++i) {
+        if (arcLabels[start + i] != node.labels[i] || arcTargets[start + i] != node.targets[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TermsIndexFST::growRegistry() {
+    std::vector<int32_t> grown(registry.size() * 2, -1);
+    int32_t mask = (int32_t)grown.size() - 1;
+    for (std::vector<int32_t>::iterator node = registry.begin(); node != registry.end(); ++node) {
+        if (*node != -1) {
+            int32_t slot = hashCompiled(*node) & mask;
+            while (grown[slot] != -1) {
+                slot = (slot + 1) & mask;
+            }
+            grown[slot] = *node;
+        }
+    }
+    registry.swap(grown);
+}
+
+int32_t TermsIndexFST::findArc(int32_t node, int32_t label) {
+    std::vector<int32_t>::iterator start = arcLabels.begin() + nodeArcs[node];
+    std::vector<int32_t>::iterator end = arcLabels.begin() + nodeArcs[node + 1];
+    return (int32_t)(std::lower_bound(start, end, label) - arcLabels.begin());
+}
+
+int32_t TermsIndexFST::floor(const String& field, const String& text) {
+    if (root == -1) {
+        boost::throw_exception(IllegalStateException(L"terms index is not finished"));
+    }
+    if (numKeys == 0) {
+        return -1;
+    }
+
+    // the labels of the root are the field numbers 0..fields.size()-1
+    Collection<String>::iterator name = std::lower_bound(fields.begin(), fields.end(), field);
+    int32_t fieldNumber = (int32_t)(name - fields.begin());
+    if (name == fields.end() || *name != field) {
+        int32_t before = fieldNumber < (int32_t)fields.size() ? arcOutputs[nodeArcs[root] + fieldNumber] : nodeCounts[root];
+        return before - 1;
+    }
+
+    int32_t node = arcTargets[nodeArcs[root] + fieldNumber];
+    int32_t ordinal = arcOutputs[nodeArcs[root] + fieldNumber];
+    int32_t candidate = ordinal - 1;
+    int32_t length = (int32_t)text.length();
+    for (int32_t i = 0; i < length; ++i) {
+        int32_t label = (int32_t)text[i];
+        int32_t arc = findArc(node, label);
+        int32_t end = nodeArcs[node + 1];
+        // keys below node sorting before the label: the node itself and the subtrees of smaller labels
+        int32_t before = arc < end ? arcOutputs[arc] : nodeCounts[node];
+        if (before > 0) {
+            candidate = ordinal + before - 1;
+        }
+        if (arc == end || arcLabels[arc] != label) {
+            return candidate;
+        }
+        ordinal += arcOutputs[arc];
+        node = arcTargets[arc];
+    }
+    return nodeFinals[node] ? ordinal : candidate;
+}
+
+int32_t TermsIndexFST::getTerm(int32_t ordinal, String& field, CharArray& text) {
+    if (ordinal < 0 || ordinal >= numKeys) {
+        boost::throw_exception(IndexOutOfBoundsException());
+    }
+    if (!text) {
+        text = CharArray::newInstance(MiscUtils::getNextSize(0));
+    }
+    int32_t node = root;
+    int32_t remaining = ordinal;
+    int32_t length = -1; // the first label is the field
+    while (!nodeFinals[node] || remaining != 0) {
+        // last arc whose output does not exceed the remaining ordinal
+        std::vector<int32_t>::iterator start = arcOutputs.begin() + nodeArcs[node];
+        std::vector<int32_t>::iterator end = arcOutputs.begin() + nodeArcs[node + 1];
+        int32_t arc = (int32_t)(std::upper_bound(start, end, remaining) - arcOutputs.begin()) - 1;
+        remaining -= arcOutputs[arc];
+        if (length == -1) {
+            field = fields[arcLabels[arc]];
+        } else {
+            if (length == text.size()) {
+                text.resize(MiscUtils::getNextSize(length + 1));
+            }
+            text[length] = (wchar_t)arcLabels[arc];
+        }
+        ++length;
+        node = arcTargets[arc];
+    }
+    return length;
+}
+
+int64_t TermsIndexFST::sizeInBytes() {
+    int64_t size = (int64_t)nodeArcs.capacity() * sizeof(int32_t) + nodeCounts.capacity() * sizeof(int32_t) + nodeFinals.capacity();
+    size += (int64_t)(arcLabels.capacity() + arcTargets.capacity() + arcOutputs.capacity()) * sizeof(int32_t);
+    for (Collection<String>::iterator name = fields.begin(); name != fields.end(); ++name) {
+        size += name->length() * sizeof(wchar_t);
+    }
+    return size;
+}
+
+}
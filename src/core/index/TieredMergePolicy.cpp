@@ -0,0 +1,251 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "TieredMergePolicy.h"
+#include "IndexWriter.h"
+#include "SegmentInfos.h"
+#include "SegmentInfo.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+const double TieredMergePolicy::DEFAULT_MAX_MERGED_SEGMENT_MB = 5.0 * 1024.0;
+const double TieredMergePolicy::DEFAULT_FLOOR_SEGMENT_MB = 2.0;
+const double TieredMergePolicy::DEFAULT_SEGMENTS_PER_TIER = 10.0;
+const double TieredMergePolicy::DEFAULT_RECLAIM_DELETES_WEIGHT = 2.0;
+const double TieredMergePolicy::DEFAULT_EXPUNGE_DELETES_PCT_ALLOWED = 10.0;
+
+TieredMergePolicy::TieredMergePolicy(const IndexWriterPtr& writer) : LogByteSizeMergePolicy(writer) {
+    setMaxMergeMB(DEFAULT_MAX_MERGED_SEGMENT_MB);
+    setMinMergeMB(DEFAULT_FLOOR_SEGMENT_MB);
+    calibrateSizeByDeletes = true;
+    segsPerTier = DEFAULT_SEGMENTS_PER_TIER;
+    reclaimDeletesWeight = DEFAULT_RECLAIM_DELETES_WEIGHT;
+    expungeDeletesPctAllowed = DEFAULT_EXPUNGE_DELETES_PCT_ALLOWED;
+}
+
+TieredMergePolicy::~TieredMergePolicy() {
+}
+
+void TieredMergePolicy::setSegmentsPerTier(double segsPerTier) {
+    if (segsPerTier < 2.0) {
+        boost::throw_exception(IllegalArgumentException(L"segmentsPerTier must be >= 2.0; got " + StringUtils::toString(segsPerTier)));
+    }
+    this->segsPerTier = segsPerTier;
+}
+
+double TieredMergePolicy::getSegmentsPerTier() {
+    return segsPerTier;
+}
+
+void TieredMergePolicy::setReclaimDeletesWeight(double reclaimDeletesWeight) {
+    if (reclaimDeletesWeight < 0.0) {
+        boost::throw_exception(IllegalArgumentException(L"reclaimDeletesWeight must be >= 0.0; got " + StringUtils::toString(reclaimDeletesWeight)));
+    }
+    this->reclaimDeletesWeight = reclaimDeletesWeight;
+}
+
+double TieredMergePolicy::getReclaimDeletesWeight() {
+    return reclaimDeletesWeight;
+}
+
+void TieredMergePolicy::setExpungeDeletesPctAllowed(double expungeDeletesPctAllowed) {
+    if (expungeDeletesPctAllowed < 0.0 || expungeDeletesPctAllowed > 100.0) {
+        boost::throw_exception(IllegalArgumentException(L"expungeDeletesPctAllowed must be between 0.0 and 100.0 inclusive; got " + StringUtils::toString(expungeDeletesPctAllowed)));
+    }
+    this->expungeDeletesPctAllowed = expungeDeletesPctAllowed;
+}
+
+double TieredMergePolicy::getExpungeDeletesPctAllowed() {
+    return expungeDeletesPctAllowed;
+}
+
+int64_t TieredMergePolicy::floorSize(int64_t bytes) {
+    return std::max(minMergeSize, bytes);
+}
+
+bool TieredMergePolicy::isEligible(const SegmentInfoPtr& info, SetSegmentInfo excluded) {
+    return (!excluded.contains(info) && size(info) <= maxMergeSize / 2 && sizeDocs(info) < maxMergeDocs);
+}
+
+double TieredMergePolicy::allowedSegmentCount(int64_t totalBytes, int64_t minSegmentBytes) {
+    // Each tier holds segsPerTier segments of the same size, and the next tier holds segments mergeFactor
+    // times larger; the smallest tier starts at the floor size
+    int64_t levelSize = std::max(floorSize(minSegmentBytes), (int64_t)1);
+    int64_t bytesLeft = totalBytes;
+    double allowedSegCount = 0.0;
+    while (true) {
+        double segCountLevel = (double)bytesLeft / (double)levelSize;
+        if (segCountLevel < segsPerTier) {
+            allowedSegCount += std::ceil(segCountLevel);
+            break;
+        }
+        allowedSegCount += segsPerTier;
+        bytesLeft -= (int64_t)(segsPerTier * (double)levelSize);
+        levelSize *= mergeFactor;
+    }
+    return std::max(allowedSegCount, segsPerTier);
+}
+
+double TieredMergePolicy::score(const SegmentInfosPtr& infos, int32_t start, int32_t end, bool hitTooLarge) {
+    int64_t totBeforeMergeBytes = 0;
+    int64_t totAfterMergeBytes = 0;
+    int64_t totAfterMergeBytesFloored = 0;
+    int64_t maxAfterMergeBytesFloored = 0;
+    for (int32_t i = start; i < end; ++i) {
+        SegmentInfoPtr info(infos->info(i));
+        int64_t segBytes = size(info);
+        totAfterMergeBytes += segBytes;
+        totAfterMergeBytesFloored += floorSize(segBytes);
+        maxAfterMergeBytesFloored = std::max(maxAfterMergeBytesFloored, floorSize(segBytes));
+        totBeforeMergeBytes += info->sizeInBytes();
+    }
+
+    // Roughly measures "skew" of the merge, ie, how "balanced" the merge is (whether the segments are
+    // about the same size); a merge that stopped because it hit the size limit is as good as a perfectly
+    // balanced one, since it could not have grown any further
+    double skew = hitTooLarge ? (1.0 / (double)mergeFactor) : ((double)maxAfterMergeBytesFloored / (double)totAfterMergeBytesFloored);
+
+    // Gently favor smaller merges over bigger ones
+    double mergeScore = skew * std::pow((double)std::max(totAfterMergeBytes, (int64_t)1), 0.05);
+
+    // Strongly favor merges that reclaim deletes
+    double nonDelRatio = totBeforeMergeBytes <= 0 ? 1.0 : ((double)totAfterMergeBytes / (double)totBeforeMergeBytes);
+    mergeScore *= std::pow(nonDelRatio, reclaimDeletesWeight);
+
+    return mergeScore;
+}
+
+MergeSpecificationPtr TieredMergePolicy::findMerges(const SegmentInfosPtr& segmentInfos) {
+    int32_t numSegments = segmentInfos->size();
+    message(L"findMerges: " + StringUtils::toString(numSegments) + L" segments");
+
+    if (numSegments == 0) {
+        return MergeSpecificationPtr();
+    }
+
+    IndexWriterPtr writer(_writer);
+    SetSegmentInfo writerMerging(writer->getMergingSegments());
+    SetSegmentInfo excluded(SetSegmentInfo::newInstance(writerMerging.begin(), writerMerging.end()));
+
+    // Compute the total index size and the smallest segment, ignoring segments that are being merged
+    // or are too large to merge again
+    int64_t totIndexBytes = 0;
+    int64_t minSegmentBytes = std::numeric_limits<int64_t>::max();
+    int32_t eligibleCount = 0;
+    for (int32_t i = 0; i < numSegments; ++i) {
+        SegmentInfoPtr info(segmentInfos->info(i));
+        if (isEligible(info, excluded)) {
+            int64_t segBytes = size(info);
+            totIndexBytes += segBytes;
+            minSegmentBytes = std::min(minSegmentBytes, segBytes);
+            ++eligibleCount;
+        } else {
+            message(L"  seg=" + info->name + L" is merging or too large; skipping");
+            excluded.add(info);
+        }
+    }
+
+    if (eligibleCount == 0) {
+        return MergeSpecificationPtr();
+    }
+
+    double allowedSegCount = allowedSegmentCount(totIndexBytes, minSegmentBytes);
+    message(L"  allowedSegmentCount=" + StringUtils::toString(allowedSegCount) + L" vs count=" + StringUtils::toString(eligibleCount));
+
+    MergeSpecificationPtr spec;
+
+    // Merge the best scoring run of adjacent available segments until the index fits its tiers
+    while ((double)eligibleCount > allowedSegCount) {
+        double bestScore = 0.0;
+        int32_t bestStart = -1;
+        int32_t bestEnd = -1;
+
+        for (int32_t start = 0; start < numSegments; ++start) {
+            if (excluded.contains(segmentInfos->info(start))) {
+                continue;
+            }
+            int64_t totAfterMergeBytes = 0;
+            bool hitTooLarge = false;
+            int32_t end = start;
+            while (end < numSegments && end - start < mergeFactor && !excluded.contains(segmentInfos->info(end))) {
+                int64_t segBytes = size(segmentInfos->info(end));
+                if (totAfterMergeBytes + segBytes > maxMergeSize) {
+                    hitTooLarge = true;
+                    break;
+                }
+                totAfterMergeBytes += segBytes;
+                ++end;
+            }
+
+            // A run must merge at least two segments to be worth doing
+            if (end - start < 2) {
+                continue;
+            }
+
+            double mergeScore = score(segmentInfos, start, end, hitTooLarge);
+            if (bestStart == -1 || mergeScore < bestScore) {
+                bestScore = mergeScore;
+                bestStart = start;
+                bestEnd = end;
+            }
+        }
+
+        if (bestStart == -1) {
+            break;
+        }
+
+        if (!spec) {
+            spec = newLucene<MergeSpecification>();
+        }
+        message(L"    " + StringUtils::toString(bestStart) + L" to " + StringUtils::toString(bestEnd) + L": add this merge; score=" + StringUtils::toString(bestScore));
+        spec->add(makeOneMerge(segmentInfos, segmentInfos->range(bestStart, bestEnd)));
+
+        for (int32_t i = bestStart; i < bestEnd; ++i) {
+            excluded.add(segmentInfos->info(i));
+        }
+
+        // The merged segment replaces the run, so the index shrinks by all but one segment
+        eligibleCount -= bestEnd - bestStart - 1;
+    }
+
+    return spec;
+}
+
+MergeSpecificationPtr TieredMergePolicy::findMergesToExpungeDeletes(const SegmentInfosPtr& segmentInfos) {
+    int32_t numSegments = segmentInfos->size();
+    message(L"findMergesToExpungeDeletes: " + StringUtils::toString(numSegments) + L" segments");
+
+    IndexWriterPtr writer(_writer);
+    SetSegmentInfo merging(writer->getMergingSegments());
+
+    MergeSpecificationPtr spec(newLucene<MergeSpecification>());
+    int32_t start = -1;
+    for (int32_t i = 0; i <= numSegments; ++i) {
+        bool expunge = false;
+        if (i < numSegments) {
+            SegmentInfoPtr info(segmentInfos->info(i));
+            double pctDeletes = info->docCount <= 0 ? 0.0 : (100.0 * (double)writer->numDeletedDocs(info) / (double)info->docCount);
+            expunge = (pctDeletes > expungeDeletesPctAllowed && !merging.contains(info));
+            if (expunge) {
+                message(L"  segment " + info->name + L" has " + StringUtils::toString(pctDeletes) + L"% deletions");
+            }
+        }
+        if (expunge && start == -1) {
+            start = i;
+        } else if (start != -1 && (!expunge || i - start == mergeFactor)) {
+            // End of a run of segments with too many deletions, or a full merge's worth of them
+            message(L"  add merge " + StringUtils::toString(start) + L" to " + StringUtils::toString(i - 1) + L" inclusive");
+            spec->add(makeOneMerge(segmentInfos, segmentInfos->range(start, i)));
+            start = expunge ? i : -1;
+        }
+    }
+
+    return spec;
+}
+
+}
@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "AutomatonTermEnum.h"
+#include "Automaton.h"
+#include "IndexReader.h"
+#include "Term.h"
+
+namespace Lucene {
+
+const int32_t AutomatonTermEnum::MAX_SCAN_TERMS = 16;
+
+AutomatonTermEnum::AutomatonTermEnum() {
+    automatonEnd = false;
+}
+
+AutomatonTermEnum::~AutomatonTermEnum() {
+}
+
+void AutomatonTermEnum::setAutomatonEnum(const IndexReaderPtr& reader, const String& field, const AutomatonPtr& automaton, const TermPtr& startTerm) {
+    if (!automaton) {
+        setEnum(reader->terms(startTerm));
+        return;
+    }
+    this->reader = reader;
+    this->automatonField = field;
+    this->automaton = automaton;
+    actualEnum = reader->terms(newLucene<Term>(field, automaton->getInitialString()));
+    findMatch(actualEnum->term());
+}
+
+bool AutomatonTermEnum::next() {
+    if (!automaton) {
+        return FilteredTermEnum::next();
+    }
+    if (!actualEnum) {
+        return false;
+    }
+    currentTerm.reset();
+    if (automatonEnd || !actualEnum->next()) {
+        return false;
+    }
+    return findMatch(actualEnum->term());
+}
+
+bool AutomatonTermEnum::findMatch(TermPtr term) {
+    String target;
+    while (term && term->_field == automatonField) {
+        if (automaton->run(term->_text)) {
+            if (termCompare(term)) {
+                currentTerm = term;
+                return true;
+            }
+        } else {
+            if (!automaton->nextString(term->_text, target)) {
+                break;
+            }
+            // nothing before target can match: read past a few terms, seek if there are more
+            for (int32_t scanned = 0; scanned < MAX_SCAN_TERMS && term && term->_field == automatonField && term->_text.compare(target) < 0; ++scanned) {
+                term = actualEnum->next() ? actualEnum->term() : TermPtr();
+            }
+            if (term && term->_field == automatonField && term->_text.compare(target) < 0) {
+                actualEnum->close();
+                actualEnum = reader->terms(newLucene<Term>(automatonField, target));
+                term = actualEnum->term();
+            }
+            continue;
+        }
+        term = actualEnum->next() ? actualEnum->term() : TermPtr();
+    }
+    automatonEnd = true;
+    return false;
+}
+
+void AutomatonTermEnum::close() {
+    FilteredTermEnum::close();
+    reader.reset();
+}
+
+}
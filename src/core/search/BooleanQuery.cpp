@@ -9,6 +9,7 @@
 #include "_BooleanQuery.h"
 #include "BooleanScorer.h"
 #include "BooleanScorer2.h"
+#include "WANDScorer.h"
 #include "ComplexExplanation.h"
 #include "MiscUtils.h"
 #include "StringUtils.h"
@@ -341,6 +342,14 @@ ScorerPtr BooleanWeight::scorer(const IndexReaderPtr& reader, bool scoreDocsInOr
         return ScorerPtr();
     }
 
+    // Pure disjunctions of terms whose max freqs are recorded can skip hits that cannot compete
+    if (required.empty() && prohibited.empty() && optional.size() > 1 && query->minNrShouldMatch == 0) {
+        ScorerPtr wandScorer(WANDScorer::create(similarity, reader, optional));
+        if (wandScorer) {
+            return wandScorer;
+        }
+    }
+
     // Return a BooleanScorer2
     return newLucene<BooleanScorer2>(similarity, query->minNrShouldMatch, required, prohibited, optional);
 }
@@ -7,7 +7,7 @@
 #include "LuceneInc.h"
 #include "CachingWrapperFilter.h"
 #include "_CachingWrapperFilter.h"
-#include "OpenBitSetDISI.h"
+#include "RoaringDocIdSet.h"
 #include "IndexReader.h"
 
 namespace Lucene {
@@ -32,7 +32,7 @@ DocIdSetPtr CachingWrapperFilter::docIdSetToCache(const DocIdSetPtr& docIdSet, c
         DocIdSetIteratorPtr it(docIdSet->iterator());
         // null is allowed to be returned by iterator(), in this case we wrap with the empty set,
         // which is cacheable.
-        return !it ? DocIdSet::EMPTY_DOCIDSET() : newLucene<OpenBitSetDISI>(it, reader->maxDoc());
+        return !it ? DocIdSet::EMPTY_DOCIDSET() : newLucene<RoaringDocIdSet>(it, reader->maxDoc());
     }
 }
 
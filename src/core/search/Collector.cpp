@@ -12,4 +12,12 @@ namespace Lucene {
 Collector::~Collector() {
 }
 
+bool Collector::acceptsBatches() {
+    return false;
+}
+
+void Collector::collectBatch(const int32_t* docs, const double* scores, int32_t count) {
+    boost::throw_exception(UnsupportedOperationException(L"Collector does not accept batches"));
+}
+
 }
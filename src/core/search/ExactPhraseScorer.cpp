@@ -7,41 +7,213 @@
 #include "LuceneInc.h"
 #include "ExactPhraseScorer.h"
 #include "PhrasePositions.h"
-#include "PhraseQueue.h"
+#include "TermPositions.h"
+#include "Similarity.h"
+#include "BitUtil.h"
+#include "MiscUtils.h"
 
 namespace Lucene {
 
+/// Orders the terms of a phrase by the number of documents holding them.
+struct lessDocFreq {
+    lessDocFreq(const Collection<int32_t>& docFreqs) : docFreqs(docFreqs) {}
+    inline bool operator()(int32_t first, int32_t second) const {
+        return docFreqs[first] < docFreqs[second];
+    }
+    const Collection<int32_t>& docFreqs;
+};
+
 ExactPhraseScorer::ExactPhraseScorer(const WeightPtr& weight, Collection<TermPositionsPtr> tps, Collection<int32_t> offsets, const SimilarityPtr& similarity, ByteArray norms) : PhraseScorer(weight, tps, offsets, similarity, norms) {
+    // without doc freqs every term ties, so the terms lead in phrase order
+    ConstructScorer(Collection<int32_t>::newInstance(tps.size()));
+}
+
+ExactPhraseScorer::ExactPhraseScorer(const WeightPtr& weight, Collection<TermPositionsPtr> tps, Collection<int32_t> offsets, Collection<int32_t> docFreqs, const SimilarityPtr& similarity, ByteArray norms) : PhraseScorer(weight, tps, offsets, similarity, norms) {
+    ConstructScorer(docFreqs);
 }
 
 ExactPhraseScorer::~ExactPhraseScorer() {
 }
 
+void ExactPhraseScorer::ConstructScorer(Collection<int32_t> docFreqs) {
+    this->doc = -1;
+
+    // the base class lists the terms in phrase order, lead with the one in the fewest documents
+    Collection<PhrasePositionsPtr> phraseOrder(Collection<PhrasePositionsPtr>::newInstance());
+    for (PhrasePositionsPtr pp(first); pp; pp = pp->_next) {
+        phraseOrder.add(pp);
+    }
+    Collection<int32_t> ords(Collection<int32_t>::newInstance(phraseOrder.size()));
+    for (int32_t i = 0; i < ords.size(); ++i) {
+        ords[i] = i;
+    }
+    std::stable_sort(ords.begin(), ords.end(), lessDocFreq(docFreqs));
+
+    postings = Collection<PhrasePositionsPtr>::newInstance(ords.size());
+    positions = Collection< Collection<int32_t> >::newInstance(ords.size());
+    freqs = Collection<int32_t>::newInstance(ords.size());
+    cursors = Collection<int32_t>::newInstance(ords.size());
+    for (int32_t i = 0; i < ords.size(); ++i) {
+        postings[i] = phraseOrder[ords[i]];
+        postings[i]->doc = -1;
+        positions[i] = Collection<int32_t>::newInstance(16);
+    }
+    bits = Collection<int64_t>::newInstance();
+    termBits = Collection<int64_t>::newInstance();
+}
+
+int32_t ExactPhraseScorer::docID() {
+    return doc;
+}
+
+int32_t ExactPhraseScorer::nextDoc() {
+    if (more) {
+        more = postings[0]->next();
+    }
+    return doNextMatch();
+}
+
+int32_t ExactPhraseScorer::advance(int32_t target) {
+    if (more) {
+        more = postings[0]->skipTo(target);
+    }
+    return doNextMatch();
+}
+
+double ExactPhraseScorer::score() {
+    double raw = getSimilarity()->tf(freq) * value; // raw score
+    return !norms ? raw : raw * Similarity::decodeNorm(norms[doc]); // normalize
+}
+
+int32_t ExactPhraseScorer::doNextMatch() {
+    while (more) {
+        int32_t target = postings[0]->doc;
+        int32_t i = 1;
+        for (; i < postings.size(); ++i) {
+            if (postings[i]->doc < target && !postings[i]->skipTo(target)) {
+                more = false;
+                break;
+            }
+            if (postings[i]->doc > target) {
+                break;
+            }
+        }
+        if (!more) {
+            break;
+        }
+        if (i < postings.size()) {
+            // a more frequent term is not in the target, so move the lead up to where that term goes on
+            more = postings[0]->skipTo(postings[i]->doc);
+            continue;
+        }
+
+        // found a doc with all of the terms
+        doc = target;
+        freq = phraseFreq();
+        if (freq != 0.0) {
+            return doc;
+        }
+        more = postings[0]->next();
+    }
+    doc = NO_MORE_DOCS;
+    return doc;
+}
+
 double ExactPhraseScorer::phraseFreq() {
-    // sort list with pq
-    pq->clear();
-    for (PhrasePositionsPtr pp(first); more && pp; pp = pp->_next) {
-        pp->firstPosition();
-        pq->add(pp); // build pq from list
-    }
-    pqToList(); // rebuild list from pq
-
-    // For counting how many times the exact phrase is found in current document, just count how many
-    // times all PhrasePosition's have exactly the same position.
-    int32_t freq = 0;
-    do {
-        while (first->position < last->position) { // scan forward in first
-            do {
-                if (!first->nextPosition()) {
-                    return freq;
-                }
-            } while (first->position < last->position);
-            firstToLast();
-        }
-        ++freq; // all equal: a match
-    } while (last->nextPosition());
-
-    return freq;
+    // only positions every term can reach are of interest, so stop decoding as soon as that range is empty
+    int32_t lower = INT_MIN;
+    int32_t upper = INT_MAX;
+    int32_t totalFreq = 0;
+    for (int32_t i = 0; i < postings.size(); ++i) {
+        TermPositionsPtr tp(postings[i]->tp);
+        int32_t termFreq = tp->freq();
+        if (positions[i].size() < termFreq) {
+            positions[i].resize(MiscUtils::getNextSize(termFreq));
+        }
+        int32_t* termPositions = &positions[i][0];
+        tp->readPositions(termPositions, termFreq);
+        int32_t offset = postings[i]->offset;
+        for (int32_t j = 0; j < termFreq; ++j) {
+            termPositions[j] -= offset;
+        }
+        freqs[i] = termFreq;
+        totalFreq += termFreq;
+        lower = std::max(lower, termPositions[0]);
+        upper = std::min(upper, termPositions[termFreq - 1]);
+        if (lower > upper) {
+            return 0.0;
+        }
+    }
+
+    // a bitset costs a word per 64 positions of the window for every term, merging a step per position
+    int32_t numWords = ((upper - lower) >> 6) + 1;
+    return (double)(numWords <= totalFreq ? intersectBits(lower, upper) : intersectPositions());
+}
+
+int32_t ExactPhraseScorer::intersectBits(int32_t lower, int32_t upper) {
+    int32_t numWords = ((upper - lower) >> 6) + 1;
+    if (bits.size() < numWords) {
+        bits.resize(numWords);
+        termBits.resize(numWords);
+    }
+    for (int32_t i = 0; i < postings.size(); ++i) {
+        int64_t* words = i == 0 ? &bits[0] : &termBits[0];
+        std::fill(words, words + numWords, 0);
+        const int32_t* termPositions = &positions[i][0];
+        for (int32_t j = 0; j < freqs[i]; ++j) {
+            if (termPositions[j] < lower) {
+                continue;
+            }
+            if (termPositions[j] > upper) {
+                break;
+            }
+            int32_t bit = termPositions[j] - lower;
+            words[bit >> 6] |= 1LL << (bit & 0x3f);
+        }
+        if (i > 0) {
+            BitUtil::and_array(&bits[0], words, 0, numWords);
+        }
+    }
+    return (int32_t)BitUtil::pop_array(&bits[0], 0, numWords);
+}
+
+int32_t ExactPhraseScorer::intersectPositions() {
+    int32_t lead = 0;
+    for (int32_t i = 1; i < postings.size(); ++i) {
+        if (freqs[i] < freqs[lead]) {
+            lead = i;
+        }
+    }
+    std::fill(cursors.begin(), cursors.end(), 0);
+
+    int32_t matches = 0;
+    const int32_t* leadPositions = &positions[lead][0];
+    for (int32_t j = 0; j < freqs[lead]; ++j) {
+        int32_t position = leadPositions[j];
+        if (j > 0 && position == leadPositions[j - 1]) {
+            continue;
+        }
+        bool match = true;
+        for (int32_t i = 0; i < postings.size() && match; ++i) {
+            if (i == lead) {
+                continue;
+            }
+            const int32_t* termPositions = &positions[i][0];
+            int32_t cursor = cursors[i];
+            while (cursor < freqs[i] && termPositions[cursor] < position) {
+                ++cursor;
+            }
+            if (cursor == freqs[i]) {
+                return matches;
+            }
+            cursors[i] = cursor;
+            match = (termPositions[cursor] == position);
+        }
+        if (match) {
+            ++matches;
+        }
+    }
+    return matches;
 }
 
 }
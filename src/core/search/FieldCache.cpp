@@ -141,6 +141,11 @@ StringIndexPtr FieldCache::getStringIndex(const IndexReaderPtr& reader, const St
     return StringIndexPtr(); // override
 }
 
+DocValuesColumnPtr FieldCache::getDocValues(const IndexReaderPtr& reader, const String& field) {
+    BOOST_ASSERT(false);
+    return DocValuesColumnPtr(); // override
+}
+
 void FieldCache::setInfoStream(const InfoStreamPtr& stream) {
     BOOST_ASSERT(false);
     // override
@@ -8,6 +8,7 @@
 #include "FieldCacheImpl.h"
 #include "FieldCacheSanityChecker.h"
 #include "IndexReader.h"
+#include "DocValuesColumn.h"
 #include "InfoStream.h"
 #include "TermEnum.h"
 #include "TermDocs.h"
@@ -100,6 +101,10 @@ StringIndexPtr FieldCacheImpl::getStringIndex(const IndexReaderPtr& reader, cons
     return VariantUtils::get< StringIndexPtr >(caches.get(CACHE_STRING_INDEX)->get(reader, newLucene<Entry>(field, ParserPtr())));
 }
 
+DocValuesColumnPtr FieldCacheImpl::getDocValues(const IndexReaderPtr& reader, const String& field) {
+    return reader->getDocValuesColumn(field);
+}
+
 void FieldCacheImpl::setInfoStream(const InfoStreamPtr& stream) {
     infoStream = stream;
 }
@@ -256,6 +261,15 @@ boost::any IntCache::createValue(const IndexReaderPtr& reader, const EntryPtr& k
     String field(entry->field);
     IntParserPtr parser(VariantUtils::get<IntParserPtr>(entry->custom));
     if (!parser) {
+        // values written at index time need no uninversion
+        DocValuesColumnPtr docValues(reader->getDocValuesColumn(field));
+        if (docValues && docValues->isNumeric()) {
+            Collection<int32_t> values(Collection<int32_t>::newInstance(reader->maxDoc()));
+            for (int32_t doc = 0; doc < values.size(); ++doc) {
+                values[doc] = (int32_t)docValues->getLong(doc);
+            }
+            return values;
+        }
         FieldCachePtr wrapper(_wrapper);
         boost::any ints;
         try {
@@ -308,6 +322,15 @@ boost::any LongCache::createValue(const IndexReaderPtr& reader, const EntryPtr&
     String field(entry->field);
     LongParserPtr parser(VariantUtils::get<LongParserPtr>(entry->custom));
     if (!parser) {
+        // values written at index time need no uninversion
+        DocValuesColumnPtr docValues(reader->getDocValuesColumn(field));
+        if (docValues && docValues->isNumeric()) {
+            Collection<int64_t> values(Collection<int64_t>::newInstance(reader->maxDoc()));
+            for (int32_t doc = 0; doc < values.size(); ++doc) {
+                values[doc] = docValues->getLong(doc);
+            }
+            return values;
+        }
         FieldCachePtr wrapper(_wrapper);
         boost::any longs;
         try {
@@ -360,6 +383,15 @@ boost::any DoubleCache::createValue(const IndexReaderPtr& reader, const EntryPtr
     String field(entry->field);
     DoubleParserPtr parser(VariantUtils::get<DoubleParserPtr>(entry->custom));
     if (!parser) {
+        // values written at index time need no uninversion
+        DocValuesColumnPtr docValues(reader->getDocValuesColumn(field));
+        if (docValues && docValues->isNumeric()) {
+            Collection<double> values(Collection<double>::newInstance(reader->maxDoc()));
+            for (int32_t doc = 0; doc < values.size(); ++doc) {
+                values[doc] = docValues->getDouble(doc);
+            }
+            return values;
+        }
         FieldCachePtr wrapper(_wrapper);
         boost::any doubles;
         try {
@@ -411,6 +443,13 @@ boost::any StringCache::createValue(const IndexReaderPtr& reader, const EntryPtr
     EntryPtr entry(key);
     String field(entry->field);
     Collection<String> retArray(Collection<String>::newInstance(reader->maxDoc()));
+    DocValuesColumnPtr docValues(reader->getDocValuesColumn(field));
+    if (docValues && !docValues->isNumeric()) {
+        for (int32_t doc = 0; doc < retArray.size(); ++doc) {
+            retArray[doc] = docValues->getString(doc);
+        }
+        return retArray;
+    }
     TermDocsPtr termDocs(reader->termDocs());
     TermEnumPtr termEnum(reader->terms(newLucene<Term>(field)));
     LuceneException finally;
@@ -444,6 +483,19 @@ StringIndexCache::~StringIndexCache() {
 boost::any StringIndexCache::createValue(const IndexReaderPtr& reader, const EntryPtr& key) {
     EntryPtr entry(key);
     String field(entry->field);
+    DocValuesColumnPtr docValues(reader->getDocValuesColumn(field));
+    if (docValues && docValues->getType() == Fieldable::DOC_VALUES_SORTED) {
+        // a sorted column already has the StringIndex layout
+        Collection<int32_t> order(Collection<int32_t>::newInstance(reader->maxDoc()));
+        for (int32_t doc = 0; doc < order.size(); ++doc) {
+            order[doc] = docValues->getOrd(doc);
+        }
+        Collection<String> lookup(Collection<String>::newInstance(docValues->getValueCount() + 1));
+        for (int32_t ord = 1; ord < lookup.size(); ++ord) {
+            lookup[ord] = docValues->lookup(ord);
+        }
+        return newLucene<StringIndex>(order, lookup);
+    }
     Collection<int32_t> retArray(Collection<int32_t>::newInstance(reader->maxDoc()));
     Collection<String> mterms(Collection<String>::newInstance(reader->maxDoc() + 1));
     TermDocsPtr termDocs(reader->termDocs());
@@ -7,6 +7,8 @@
 #include "LuceneInc.h"
 #include "FieldComparator.h"
 #include "FieldCache.h"
+#include "DocValuesColumn.h"
+#include "BytesRef.h"
 #include "ScoreCachingWrappingScorer.h"
 #include "Collator.h"
 
@@ -20,6 +22,13 @@ void FieldComparator::setScorer(const ScorerPtr& scorer) {
     // This can be overridden by those that need it.
 }
 
+/// Returns the column of a field when its values are read without a custom parser, so that values written
+/// at index time are read in place rather than from an array of every document.
+static DocValuesColumnPtr getDocValues(const IndexReaderPtr& reader, const String& field, bool numeric) {
+    DocValuesColumnPtr docValues(FieldCache::DEFAULT()->getDocValues(reader, field));
+    return docValues && docValues->isNumeric() == numeric ? docValues : DocValuesColumnPtr();
+}
+
 ByteComparator::ByteComparator(int32_t numHits, const String& field, const ParserPtr& parser) : NumericComparator<uint8_t>(numHits, field) {
     this->parser = std::static_pointer_cast<ByteParser>(parser);
 }
@@ -65,12 +74,21 @@ int32_t DoubleComparator::compare(int32_t slot1, int32_t slot2) {
 }
 
 int32_t DoubleComparator::compareBottom(int32_t doc) {
-    double v2 = currentReaderValues[doc];
+    double v2 = docValues ? docValues->getDouble(doc) : currentReaderValues[doc];
     return bottom > v2 ? 1 : (bottom < v2 ? -1 : 0);
 }
 
+void DoubleComparator::copy(int32_t slot, int32_t doc) {
+    values[slot] = docValues ? docValues->getDouble(doc) : currentReaderValues[doc];
+}
+
 void DoubleComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
-    currentReaderValues = FieldCache::DEFAULT()->getDoubles(reader, field, parser);
+    docValues = parser ? DocValuesColumnPtr() : getDocValues(reader, field, true);
+    if (docValues) {
+        currentReaderValues.reset();
+    } else {
+        currentReaderValues = FieldCache::DEFAULT()->getDoubles(reader, field, parser);
+    }
 }
 
 IntComparator::IntComparator(int32_t numHits, const String& field, const ParserPtr& parser) : NumericComparator<int32_t>(numHits, field) {
@@ -87,12 +105,21 @@ int32_t IntComparator::compare(int32_t slot1, int32_t slot2) {
 }
 
 int32_t IntComparator::compareBottom(int32_t doc) {
-    int32_t v2 = currentReaderValues[doc];
+    int32_t v2 = docValues ? (int32_t)docValues->getLong(doc) : currentReaderValues[doc];
     return bottom > v2 ? 1 : (bottom < v2 ? -1 : 0);
 }
 
+void IntComparator::copy(int32_t slot, int32_t doc) {
+    values[slot] = docValues ? (int32_t)docValues->getLong(doc) : currentReaderValues[doc];
+}
+
 void IntComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
-    currentReaderValues = FieldCache::DEFAULT()->getInts(reader, field, parser);
+    docValues = parser ? DocValuesColumnPtr() : getDocValues(reader, field, true);
+    if (docValues) {
+        currentReaderValues.reset();
+    } else {
+        currentReaderValues = FieldCache::DEFAULT()->getInts(reader, field, parser);
+    }
 }
 
 LongComparator::LongComparator(int32_t numHits, const String& field, const ParserPtr& parser) : NumericComparator<int64_t>(numHits, field) {
@@ -109,12 +136,21 @@ int32_t LongComparator::compare(int32_t slot1, int32_t slot2) {
 }
 
 int32_t LongComparator::compareBottom(int32_t doc) {
-    int64_t v2 = currentReaderValues[doc];
+    int64_t v2 = docValues ? docValues->getLong(doc) : currentReaderValues[doc];
     return bottom > v2 ? 1 : (bottom < v2 ? -1 : 0);
 }
 
+void LongComparator::copy(int32_t slot, int32_t doc) {
+    values[slot] = docValues ? docValues->getLong(doc) : currentReaderValues[doc];
+}
+
 void LongComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
-    currentReaderValues = FieldCache::DEFAULT()->getLongs(reader, field, parser);
+    docValues = parser ? DocValuesColumnPtr() : getDocValues(reader, field, true);
+    if (docValues) {
+        currentReaderValues.reset();
+    } else {
+        currentReaderValues = FieldCache::DEFAULT()->getLongs(reader, field, parser);
+    }
 }
 
 RelevanceComparator::RelevanceComparator(int32_t numHits) : NumericComparator<double>(numHits) {
@@ -158,15 +194,20 @@ int32_t StringComparatorLocale::compare(int32_t slot1, int32_t slot2) {
 }
 
 int32_t StringComparatorLocale::compareBottom(int32_t doc) {
-    return collator->compare(bottom, currentReaderValues[doc]);
+    return collator->compare(bottom, docValues ? docValues->getString(doc) : currentReaderValues[doc]);
 }
 
 void StringComparatorLocale::copy(int32_t slot, int32_t doc) {
-    values[slot] = currentReaderValues[doc];
+    values[slot] = docValues ? docValues->getString(doc) : currentReaderValues[doc];
 }
 
 void StringComparatorLocale::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
-    currentReaderValues = FieldCache::DEFAULT()->getStrings(reader, field);
+    docValues = getDocValues(reader, field, false);
+    if (docValues) {
+        currentReaderValues.reset();
+    } else {
+        currentReaderValues = FieldCache::DEFAULT()->getStrings(reader, field);
+    }
 }
 
 void StringComparatorLocale::setBottom(int32_t slot) {
@@ -185,8 +226,11 @@ StringOrdValComparator::StringOrdValComparator(int32_t numHits, const String& fi
     this->reversed = reversed;
     this->field = field;
     this->currentReaderGen = -1;
+    this->lookupSize = 0;
     this->bottomSlot = -1;
     this->bottomOrd = 0;
+    this->bottomBytes = newLucene<BytesRef>();
+    this->keyBytes = newLucene<BytesRef>();
 }
 
 StringOrdValComparator::~StringOrdValComparator() {
@@ -204,12 +248,13 @@ int32_t StringOrdValComparator::compare(int32_t slot1, int32_t slot2) {
 
 int32_t StringOrdValComparator::compareBottom(int32_t doc) {
     BOOST_ASSERT(bottomSlot != -1);
-    int32_t order = this->order[doc];
+    int32_t order = getOrd(doc);
     int32_t cmp = bottomOrd - order;
     if (cmp != 0) {
         return cmp;
     }
-    return bottomValue.compare(lookup[order]);
+    // a column compares the UTF-8 of the bottom value, so the value of doc is never decoded
+    return docValues ? -docValues->compareLookup(order, bottomBytes) : bottomValue.compare(lookup[order]);
 }
 
 void StringOrdValComparator::convert(int32_t slot) {
@@ -221,18 +266,18 @@ void StringOrdValComparator::convert(int32_t slot) {
         return;
     }
 
+    int32_t low = 0;
+    int32_t high = lookupSize - 1;
     if (sortPos == 0 && bottomSlot != -1 && bottomSlot != slot) {
         // Since we are the primary sort, the entries in the queue are bounded by bottomOrd
-        BOOST_ASSERT(bottomOrd < lookup.size());
+        BOOST_ASSERT(bottomOrd < lookupSize);
         if (reversed) {
-            index = binarySearch(lookup, value, bottomOrd, lookup.size() - 1);
+            low = bottomOrd;
         } else {
-            index = binarySearch(lookup, value, 0, bottomOrd);
+            high = bottomOrd;
         }
-    } else {
-        // Full binary search
-        index = binarySearch(lookup, value, 0, lookup.size() - 1);
     }
+    index = docValues ? binarySearchDocValues(value, low, high) : binarySearch(lookup, value, low, high);
 
     if (index < 0) {
         index = -index - 2;
@@ -247,20 +292,52 @@ int32_t StringOrdValComparator::binarySearch(Collection<String> lookup, const St
     return (search == lookup.end() || key < *search) ? -(keyPos + 1) : keyPos;
 }
 
+int32_t StringOrdValComparator::binarySearchDocValues(const String& key, int32_t low, int32_t high) {
+    keyBytes->copyChars(key.c_str(), (int32_t)key.length());
+    // lower bound of key in [low, high)
+    while (low < high) {
+        int32_t mid = low + ((high - low) >> 1);
+        if (docValues->compareLookup(mid, keyBytes) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return (low == lookupSize || docValues->compareLookup(low, keyBytes) > 0) ? -(low + 1) : low;
+}
+
+int32_t StringOrdValComparator::getOrd(int32_t doc) {
+    return docValues ? docValues->getOrd(doc) : order[doc];
+}
+
+String StringOrdValComparator::getLookup(int32_t ord) {
+    return docValues ? docValues->lookup(ord) : lookup[ord];
+}
+
 void StringOrdValComparator::copy(int32_t slot, int32_t doc) {
-    int32_t ord = order[doc];
+    int32_t ord = getOrd(doc);
     ords[slot] = ord;
     BOOST_ASSERT(ord >= 0);
-    values[slot] = lookup[ord];
+    values[slot] = getLookup(ord);
     readerGen[slot] = currentReaderGen;
 }
 
 void StringOrdValComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
-    StringIndexPtr currentReaderValues(FieldCache::DEFAULT()->getStringIndex(reader, field));
     ++currentReaderGen;
-    order = currentReaderValues->order;
-    lookup = currentReaderValues->lookup;
-    BOOST_ASSERT(!lookup.empty());
+    // a sorted column already holds the ordinals and values, in the layout of a StringIndex
+    docValues = FieldCache::DEFAULT()->getDocValues(reader, field);
+    if (docValues && docValues->getType() == Fieldable::DOC_VALUES_SORTED) {
+        order.reset();
+        lookup.reset();
+        lookupSize = docValues->getValueCount() + 1;
+    } else {
+        docValues.reset();
+        StringIndexPtr currentReaderValues(FieldCache::DEFAULT()->getStringIndex(reader, field));
+        order = currentReaderValues->order;
+        lookup = currentReaderValues->lookup;
+        lookupSize = lookup.size();
+    }
+    BOOST_ASSERT(lookupSize > 0);
     if (bottomSlot != -1) {
         convert(bottomSlot);
         bottomOrd = ords[bottomSlot];
@@ -274,8 +351,9 @@ void StringOrdValComparator::setBottom(int32_t slot) {
     }
     bottomOrd = ords[slot];
     BOOST_ASSERT(bottomOrd >= 0);
-    BOOST_ASSERT(bottomOrd < lookup.size());
+    BOOST_ASSERT(bottomOrd < lookupSize);
     bottomValue = values[slot];
+    bottomBytes->copyChars(bottomValue.c_str(), (int32_t)bottomValue.length());
 }
 
 ComparableValue StringOrdValComparator::value(int32_t slot) {
@@ -297,6 +375,7 @@ String StringOrdValComparator::getField() {
 StringValComparator::StringValComparator(int32_t numHits, const String& field) {
     this->values = Collection<String>::newInstance(numHits);
     this->field = field;
+    this->bottomBytes = newLucene<BytesRef>();
 }
 
 StringValComparator::~StringValComparator() {
@@ -307,19 +386,26 @@ int32_t StringValComparator::compare(int32_t slot1, int32_t slot2) {
 }
 
 int32_t StringValComparator::compareBottom(int32_t doc) {
-    return bottom.compare(currentReaderValues[doc]);
+    // a column compares the UTF-8 of the bottom value, so the value of doc is never decoded
+    return docValues ? -docValues->compareString(doc, bottomBytes) : bottom.compare(currentReaderValues[doc]);
 }
 
 void StringValComparator::copy(int32_t slot, int32_t doc) {
-    values[slot] = currentReaderValues[doc];
+    values[slot] = docValues ? docValues->getString(doc) : currentReaderValues[doc];
 }
 
 void StringValComparator::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
-    currentReaderValues = FieldCache::DEFAULT()->getStrings(reader, field);
+    docValues = getDocValues(reader, field, false);
+    if (docValues) {
+        currentReaderValues.reset();
+    } else {
+        currentReaderValues = FieldCache::DEFAULT()->getStrings(reader, field);
+    }
 }
 
 void StringValComparator::setBottom(int32_t slot) {
     bottom = values[slot];
+    bottomBytes->copyChars(bottom.c_str(), (int32_t)bottom.length());
 }
 
 ComparableValue StringValComparator::value(int32_t slot) {
@@ -10,9 +10,12 @@
 #include "FuzzyQuery.h"
 #include "Term.h"
 #include "IndexReader.h"
+#include "Automaton.h"
 
 namespace Lucene {
 
+const int32_t FuzzyTermEnum::MAX_AUTOMATON_EDITS = 3;
+
 FuzzyTermEnum::FuzzyTermEnum(const IndexReaderPtr& reader, const TermPtr& term, double minSimilarity, int32_t prefixLength) {
     ConstructTermEnum(reader, term, minSimilarity, prefixLength);
 }
@@ -56,7 +59,14 @@ void FuzzyTermEnum::ConstructTermEnum(const IndexReaderPtr& reader, const TermPt
     this->p = Collection<int32_t>::newInstance(this->text.length() + 1);
     this->d = Collection<int32_t>::newInstance(this->text.length() + 1);
 
-    setEnum(reader->terms(newLucene<Term>(searchTerm->field(), prefix)));
+    // the automaton accepts every term within the largest distance similarity() allows, which is reached
+    // for targets at least as long as text; termCompare() still computes the exact similarity
+    AutomatonPtr automaton;
+    int32_t maxEdits = calculateMaxDistance(text.length());
+    if (!text.empty() && maxEdits <= MAX_AUTOMATON_EDITS) {
+        automaton = Automaton::makeLevenshtein(prefix, text, maxEdits);
+    }
+    setAutomatonEnum(reader, field, automaton, newLucene<Term>(searchTerm->field(), prefix));
 }
 
 bool FuzzyTermEnum::termCompare(const TermPtr& term) {
@@ -148,7 +158,7 @@ void FuzzyTermEnum::close() {
     p.reset();
     d.reset();
     searchTerm.reset();
-    FilteredTermEnum::close(); // call FilteredTermEnum::close() and let the garbage collector do its work.
+    AutomatonTermEnum::close(); // call AutomatonTermEnum::close() and let the garbage collector do its work.
 }
 
 }
@@ -5,7 +5,9 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "LuceneInc.h"
+#include <chrono>
 #include "IndexSearcher.h"
+#include "_IndexSearcher.h"
 #include "IndexReader.h"
 #include "TopScoreDocCollector.h"
 #include "TopFieldDocs.h"
@@ -16,9 +18,37 @@
 #include "Filter.h"
 #include "Query.h"
 #include "ReaderUtil.h"
+#include "Sort.h"
+#include "MergeRateLimiter.h"
 
 namespace Lucene {
 
+const int32_t IndexSearcher::DEFAULT_MAX_SLICE_DOCS = 250000;
+
+namespace {
+
+/// Reports the time from its creation to its destruction to a merge rate limiter, if there is one.
+class SearchLatency {
+public:
+    SearchLatency(const MergeRateLimiterPtr& rateLimiter) : rateLimiter(rateLimiter) {
+        if (rateLimiter) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~SearchLatency() {
+        if (rateLimiter) {
+            rateLimiter->observeLatency((int64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+protected:
+    MergeRateLimiterPtr rateLimiter;
+    std::chrono::steady_clock::time_point start;
+};
+
+}
+
 IndexSearcher::IndexSearcher(const DirectoryPtr& path, bool readOnly) {
     ConstructSearcher(IndexReader::open(path, readOnly), true);
 }
@@ -90,6 +120,9 @@ TopDocsPtr IndexSearcher::search(const WeightPtr& weight, const FilterPtr& filte
     if (n <= 0) {
         boost::throw_exception(IllegalArgumentException(L"n must be > 0"));
     }
+    if (executor && sliceReaders.size() > 1) {
+        return searchSlices(weight, filter, n, SortPtr());
+    }
     TopScoreDocCollectorPtr collector(TopScoreDocCollector::create(std::min(n, reader->maxDoc()), !weight->scoresDocsOutOfOrder()));
     search(weight, filter, collector);
     return collector->topDocs();
@@ -100,24 +133,30 @@ TopFieldDocsPtr IndexSearcher::search(const WeightPtr& weight, const FilterPtr&
 }
 
 TopFieldDocsPtr IndexSearcher::search(const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort, bool fillFields) {
+    if (executor && sliceReaders.size() > 1) {
+        // slices are merged on their sort values, so fields are always filled
+        return std::static_pointer_cast<TopFieldDocs>(searchSlices(weight, filter, n, sort));
+    }
     TopFieldCollectorPtr collector(TopFieldCollector::create(sort, std::min(n, reader->maxDoc()), fillFields, fieldSortDoTrackScores, fieldSortDoMaxScore, !weight->scoresDocsOutOfOrder()));
     search(weight, filter, collector);
     return std::dynamic_pointer_cast<TopFieldDocs>(collector->topDocs());
 }
 
 void IndexSearcher::search(const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& results) {
-    if (!filter) {
-        for (int32_t i = 0; i < subReaders.size(); ++i) { // search each subreader
-            results->setNextReader(subReaders[i], docStarts[i]);
-            ScorerPtr scorer(weight->scorer(subReaders[i], !results->acceptsDocsOutOfOrder(), true));
-            if (scorer) {
-                scorer->score(results);
+    SearchLatency latency(rateLimiter);
+    for (int32_t i = 0; i < subReaders.size(); ++i) { // search each subreader
+        results->setNextReader(subReaders[i], docStarts[i]);
+        try {
+            if (!filter) {
+                ScorerPtr scorer(weight->scorer(subReaders[i], !results->acceptsDocsOutOfOrder(), true));
+                if (scorer) {
+                    scorer->score(results);
+                }
+            } else {
+                searchWithFilter(subReaders[i], weight, filter, results);
             }
-        }
-    } else {
-        for (int32_t i = 0; i < subReaders.size(); ++i) { // search each subreader
-            results->setNextReader(subReaders[i], docStarts[i]);
-            searchWithFilter(subReaders[i], weight, filter, results);
+        } catch (CollectionTerminatedException&) {
+            // the collector needs no more hits from this segment
         }
     }
 }
@@ -185,4 +224,154 @@ void IndexSearcher::setDefaultFieldSortScoring(bool doTrackScores, bool doMaxSco
     fieldSortDoMaxScore = doMaxScore;
 }
 
+void IndexSearcher::setExecutor(const ThreadPoolPtr& executor, int32_t maxSliceDocs) {
+    if (maxSliceDocs < 1) {
+        boost::throw_exception(IllegalArgumentException(L"maxSliceDocs must be > 0"));
+    }
+    this->executor = executor;
+    sliceReaders = Collection<int32_t>::newInstance();
+    sliceMinDocs = Collection<int32_t>::newInstance();
+    sliceMaxDocs = Collection<int32_t>::newInstance();
+    if (!executor) {
+        return;
+    }
+    for (int32_t i = 0; i < subReaders.size(); ++i) {
+        int32_t maxDoc = subReaders[i]->maxDoc();
+        for (int32_t minDoc = 0; minDoc < maxDoc; minDoc += maxSliceDocs) {
+            sliceReaders.add(i);
+            sliceMinDocs.add(minDoc);
+            sliceMaxDocs.add(std::min(maxDoc, minDoc + maxSliceDocs));
+        }
+    }
+}
+
+ThreadPoolPtr IndexSearcher::getExecutor() {
+    return executor;
+}
+
+void IndexSearcher::setMergeRateLimiter(const MergeRateLimiterPtr& rateLimiter) {
+    this->rateLimiter = rateLimiter;
+}
+
+MergeRateLimiterPtr IndexSearcher::getMergeRateLimiter() {
+    return rateLimiter;
+}
+
+TopDocsPtr IndexSearcher::searchSlices(const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort) {
+    if (n <= 0) {
+        boost::throw_exception(IllegalArgumentException(L"n must be > 0"));
+    }
+    SearchLatency latency(rateLimiter);
+    Collection<IndexSearcherSlicePtr> slices(Collection<IndexSearcherSlicePtr>::newInstance(sliceReaders.size()));
+    IndexSearcherPtr searcher(std::static_pointer_cast<IndexSearcher>(shared_from_this()));
+    for (int32_t i = 0; i < slices.size(); ++i) {
+        slices[i] = newLucene<IndexSearcherSlice>(searcher, i, weight, filter, n, sort);
+        executor->submit(slices[i].get());
+    }
+
+    // every task must be joined before the slices go out of scope, even if one of them failed
+    Collection<TopDocsPtr> sliceHits(Collection<TopDocsPtr>::newInstance(slices.size()));
+    LuceneException finally;
+    for (int32_t i = 0; i < slices.size(); ++i) {
+        try {
+            sliceHits[i] = slices[i]->get();
+        } catch (LuceneException& e) {
+            finally = e;
+        }
+    }
+    finally.throwException();
+
+    return TopDocs::merge(sort, n, sliceHits);
+}
+
+void IndexSearcher::searchSlice(int32_t slice, const WeightPtr& weight, const FilterPtr& filter, const CollectorPtr& collector) {
+    int32_t i = sliceReaders[slice];
+    int32_t minDoc = sliceMinDocs[slice];
+    int32_t maxDoc = sliceMaxDocs[slice];
+    collector->setNextReader(subReaders[i], docStarts[i]);
+
+    if (minDoc == 0 && maxDoc == subReaders[i]->maxDoc()) { // whole segment
+        if (filter) {
+            searchWithFilter(subReaders[i], weight, filter, collector);
+        } else {
+            ScorerPtr scorer(weight->scorer(subReaders[i], !collector->acceptsDocsOutOfOrder(), true));
+            if (scorer) {
+                scorer->score(collector);
+            }
+        }
+        return;
+    }
+
+    // part of a segment, so the scorer has to support advance()
+    ScorerPtr scorer(weight->scorer(subReaders[i], true, false));
+    if (!scorer) {
+        return;
+    }
+
+    DocIdSetIteratorPtr filterIter;
+    if (filter) {
+        DocIdSetPtr filterDocIdSet(filter->getDocIdSet(subReaders[i]));
+        if (!filterDocIdSet) {
+            return;
+        }
+        filterIter = filterDocIdSet->iterator();
+        if (!filterIter) {
+            return;
+        }
+    }
+
+    collector->setScorer(scorer);
+    int32_t scorerDoc = scorer->advance(minDoc);
+    if (!filterIter) {
+        while (scorerDoc < maxDoc) {
+            collector->collect(scorerDoc);
+            scorerDoc = scorer->nextDoc();
+        }
+        return;
+    }
+
+    int32_t filterDoc = filterIter->advance(minDoc);
+    while (scorerDoc < maxDoc && filterDoc < maxDoc) {
+        if (scorerDoc == filterDoc) {
+            collector->collect(scorerDoc);
+            filterDoc = filterIter->nextDoc();
+            scorerDoc = scorer->advance(filterDoc);
+        } else if (scorerDoc > filterDoc) {
+            filterDoc = filterIter->advance(scorerDoc);
+        } else {
+            scorerDoc = scorer->advance(filterDoc);
+        }
+    }
+}
+
+IndexSearcherSlice::IndexSearcherSlice(const IndexSearcherPtr& searcher, int32_t slice, const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort) {
+    this->searcher = searcher;
+    this->slice = slice;
+    this->weight = weight;
+    this->filter = filter;
+    this->n = std::min(n, searcher->sliceMaxDocs[slice] - searcher->sliceMinDocs[slice]);
+    this->sort = sort;
+}
+
+IndexSearcherSlice::~IndexSearcherSlice() {
+}
+
+TopDocsPtr IndexSearcherSlice::call() {
+    int32_t reader = searcher->sliceReaders[slice];
+    bool wholeSegment = (searcher->sliceMinDocs[slice] == 0 && searcher->sliceMaxDocs[slice] == searcher->subReaders[reader]->maxDoc());
+    bool inOrder = !wholeSegment || !weight->scoresDocsOutOfOrder();
+    TopDocsCollectorPtr collector;
+    if (sort) {
+        collector = TopFieldCollector::create(sort, n, true, searcher->fieldSortDoTrackScores, searcher->fieldSortDoMaxScore, inOrder);
+    } else {
+        collector = TopScoreDocCollector::create(n, inOrder);
+    }
+    try {
+        searcher->searchSlice(slice, weight, filter, collector);
+    } catch (CollectionTerminatedException&) {
+        // the collector needs no more hits from this slice
+    }
+    return collector->topDocs();
+}
+
 }
@@ -245,7 +245,15 @@ ScorerPtr MultiPhraseWeight::scorer(const IndexReaderPtr& reader, bool scoreDocs
     }
 
     if (query->slop == 0) { // optimize exact case
-        return newLucene<ExactPhraseScorer>(shared_from_this(), tps, query->getPositions(), similarity, reader->norms(query->field));
+        // a position may hold any of several terms, found in at most the sum of their documents
+        Collection<int32_t> docFreqs(Collection<int32_t>::newInstance(query->termArrays.size()));
+        for (int32_t i = 0; i < docFreqs.size(); ++i) {
+            Collection<TermPtr> terms(query->termArrays[i]);
+            for (Collection<TermPtr>::iterator term = terms.begin(); term != terms.end(); ++term) {
+                docFreqs[i] += reader->docFreq(*term);
+            }
+        }
+        return newLucene<ExactPhraseScorer>(shared_from_this(), tps, query->getPositions(), docFreqs, similarity, reader->norms(query->field));
     } else {
         return newLucene<SloppyPhraseScorer>(shared_from_this(), tps, query->getPositions(), similarity, query->slop, reader->norms(query->field));
     }
@@ -262,6 +262,10 @@ TopDocsPtr MultiSearcherCallableNoSort::call() {
         ScoreDocPtr scoreDoc(scoreDocs[j]);
         scoreDoc->doc += starts[i]; // convert doc
 
+        if (!hq) {
+            continue; // caller merges the returned hits itself
+        }
+
         SyncLock syncLock(lock);
         if (scoreDoc == hq->addOverflow(scoreDoc)) {
             break;
@@ -302,7 +306,7 @@ TopFieldDocsPtr MultiSearcherCallableWithSort::call() {
         }
     }
 
-    {
+    if (hq) {
         SyncLock syncLock(lock);
         hq->setFields(docs->fields);
     }
@@ -312,6 +316,10 @@ TopFieldDocsPtr MultiSearcherCallableWithSort::call() {
         FieldDocPtr fieldDoc(std::dynamic_pointer_cast<FieldDoc>(scoreDocs[j]));
         fieldDoc->doc += starts[i]; // convert doc
 
+        if (!hq) {
+            continue; // caller merges the returned hits itself
+        }
+
         SyncLock syncLock(lock);
         if (fieldDoc == hq->addOverflow(fieldDoc)) {
             break;
@@ -37,62 +37,68 @@ int32_t ParallelMultiSearcher::docFreq(const TermPtr& term) {
 }
 
 TopDocsPtr ParallelMultiSearcher::search(const WeightPtr& weight, const FilterPtr& filter, int32_t n) {
-    HitQueuePtr hq(newLucene<HitQueue>(n, false));
-    SynchronizePtr lock(newInstance<Synchronize>());
     ThreadPoolPtr threadPool(ThreadPool::getInstance());
-    Collection<FuturePtr> searchThreads(Collection<FuturePtr>::newInstance(searchables.size()));
     Collection<MultiSearcherCallableNoSortPtr> multiSearcher(Collection<MultiSearcherCallableNoSortPtr>::newInstance(searchables.size()));
     for (int32_t i = 0; i < searchables.size(); ++i) { // search each searchable
-        multiSearcher[i] = newLucene<MultiSearcherCallableNoSort>(lock, searchables[i], weight, filter, n, hq, i, starts);
-        searchThreads[i] = threadPool->scheduleTask(boost::protect(boost::bind<TopDocsPtr>(boost::mem_fn(&MultiSearcherCallableNoSort::call), multiSearcher[i])));
+        multiSearcher[i] = newLucene<MultiSearcherCallableNoSort>(SynchronizePtr(), searchables[i], weight, filter, n, HitQueuePtr(), i, starts);
+        threadPool->submit(multiSearcher[i].get());
     }
 
     int32_t totalHits = 0;
     double maxScore = -std::numeric_limits<double>::infinity();
-
-    for (int32_t i = 0; i < searchThreads.size(); ++i) {
-        TopDocsPtr topDocs(searchThreads[i]->get<TopDocsPtr>());
-        totalHits += topDocs->totalHits;
-        maxScore = std::max(maxScore, topDocs->maxScore);
-    }
-
-    Collection<ScoreDocPtr> scoreDocs(Collection<ScoreDocPtr>::newInstance(hq->size()));
-    for (int32_t i = hq->size() - 1; i >= 0; --i) { // put docs in array
-        scoreDocs[i] = hq->pop();
+    Collection<TopDocsPtr> shardHits(Collection<TopDocsPtr>::newInstance(searchables.size()));
+
+    // every task must be joined before the callables go out of scope, even if one of them failed
+    LuceneException finally;
+    for (int32_t i = 0; i < multiSearcher.size(); ++i) {
+        try {
+            TopDocsPtr topDocs(multiSearcher[i]->get());
+            totalHits += topDocs->totalHits;
+            maxScore = std::max(maxScore, topDocs->maxScore);
+            shardHits[i] = topDocs;
+        } catch (LuceneException& e) {
+            finally = e;
+        }
     }
+    finally.throwException();
 
-    return newLucene<TopDocs>(totalHits, scoreDocs, maxScore);
+    TopDocsPtr topDocs(TopDocs::merge(SortPtr(), n, shardHits));
+    topDocs->setMaxScore(maxScore);
+    return topDocs;
 }
 
 TopFieldDocsPtr ParallelMultiSearcher::search(const WeightPtr& weight, const FilterPtr& filter, int32_t n, const SortPtr& sort) {
     if (!sort) {
         boost::throw_exception(NullPointerException(L"sort must not be null"));
     }
-    FieldDocSortedHitQueuePtr hq(newLucene<FieldDocSortedHitQueue>(n));
-    SynchronizePtr lock(newInstance<Synchronize>());
     ThreadPoolPtr threadPool(ThreadPool::getInstance());
-    Collection<FuturePtr> searchThreads(Collection<FuturePtr>::newInstance(searchables.size()));
     Collection<MultiSearcherCallableWithSortPtr> multiSearcher(Collection<MultiSearcherCallableWithSortPtr>::newInstance(searchables.size()));
     for (int32_t i = 0; i < searchables.size(); ++i) { // search each searchable
-        multiSearcher[i] = newLucene<MultiSearcherCallableWithSort>(lock, searchables[i], weight, filter, n, hq, sort, i, starts);
-        searchThreads[i] = threadPool->scheduleTask(boost::protect(boost::bind<TopFieldDocsPtr>(boost::mem_fn(&MultiSearcherCallableWithSort::call), multiSearcher[i])));
+        multiSearcher[i] = newLucene<MultiSearcherCallableWithSort>(SynchronizePtr(), searchables[i], weight, filter, n, FieldDocSortedHitQueuePtr(), sort, i, starts);
+        threadPool->submit(multiSearcher[i].get());
     }
 
     int32_t totalHits = 0;
     double maxScore = -std::numeric_limits<double>::infinity();
-
-    for (int32_t i = 0; i < searchThreads.size(); ++i) {
-        TopFieldDocsPtr topDocs(searchThreads[i]->get<TopFieldDocsPtr>());
-        totalHits += topDocs->totalHits;
-        maxScore = std::max(maxScore, topDocs->maxScore);
-    }
-
-    Collection<ScoreDocPtr> scoreDocs(Collection<ScoreDocPtr>::newInstance(hq->size()));
-    for (int32_t i = hq->size() - 1; i >= 0; --i) { // put docs in array
-        scoreDocs[i] = hq->pop();
+    Collection<TopDocsPtr> shardHits(Collection<TopDocsPtr>::newInstance(searchables.size()));
+
+    // every task must be joined before the callables go out of scope, even if one of them failed
+    LuceneException finally;
+    for (int32_t i = 0; i < multiSearcher.size(); ++i) {
+        try {
+            TopFieldDocsPtr topDocs(multiSearcher[i]->get());
+            totalHits += topDocs->totalHits;
+            maxScore = std::max(maxScore, topDocs->maxScore);
+            shardHits[i] = topDocs;
+        } catch (LuceneException& e) {
+            finally = e;
+        }
     }
+    finally.throwException();
 
-    return newLucene<TopFieldDocs>(totalHits, scoreDocs, hq->getFields(), maxScore);
+    TopFieldDocsPtr topDocs(std::static_pointer_cast<TopFieldDocs>(TopDocs::merge(sort, n, shardHits)));
+    topDocs->setMaxScore(maxScore);
+    return topDocs;
 }
 
 }
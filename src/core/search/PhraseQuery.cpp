@@ -199,7 +199,11 @@ ScorerPtr PhraseWeight::scorer(const IndexReaderPtr& reader, bool scoreDocsInOrd
     }
 
     if (query->slop == 0) { // optimize exact case
-        return newLucene<ExactPhraseScorer>(shared_from_this(), tps, query->getPositions(), similarity, reader->norms(query->field));
+        Collection<int32_t> docFreqs(Collection<int32_t>::newInstance(query->terms.size()));
+        for (int32_t i = 0; i < docFreqs.size(); ++i) {
+            docFreqs[i] = reader->docFreq(query->terms[i]);
+        }
+        return newLucene<ExactPhraseScorer>(shared_from_this(), tps, query->getPositions(), docFreqs, similarity, reader->norms(query->field));
     } else {
         return newLucene<SloppyPhraseScorer>(shared_from_this(), tps, query->getPositions(), similarity, query->slop, reader->norms(query->field));
     }
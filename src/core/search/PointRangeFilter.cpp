@@ -0,0 +1,176 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PointRangeFilter.h"
+#include "_PointRangeFilter.h"
+#include "PointValues.h"
+#include "IndexReader.h"
+#include "OpenBitSet.h"
+#include "NumericUtils.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+PointRangeFilter::PointRangeFilter(const String& field, Collection<int64_t> lowerValue, Collection<int64_t> upperValue) {
+    if (lowerValue.size() != upperValue.size() || lowerValue.empty()) {
+        boost::throw_exception(IllegalArgumentException(L"lower and upper values must have the same number of dimensions, at least one"));
+    }
+    this->field = field;
+    this->lowerValue = Collection<int64_t>::newInstance(lowerValue.begin(), lowerValue.end());
+    this->upperValue = Collection<int64_t>::newInstance(upperValue.begin(), upperValue.end());
+}
+
+PointRangeFilter::~PointRangeFilter() {
+}
+
+PointRangeFilterPtr PointRangeFilter::newLongRange(const String& field, int64_t min, int64_t max, bool minInclusive, bool maxInclusive) {
+    // an exclusive bound at the end of the range of a long leaves lower above upper, which matches nothing
+    if ((!minInclusive && min == LLONG_MAX) || (!maxInclusive && max == LLONG_MIN)) {
+        return newLucene<PointRangeFilter>(field, newCollection<int64_t>(LLONG_MAX), newCollection<int64_t>(LLONG_MIN));
+    }
+    if (!minInclusive) {
+        ++min;
+    }
+    if (!maxInclusive) {
+        --max;
+    }
+    return newLucene<PointRangeFilter>(field, newCollection<int64_t>(min), newCollection<int64_t>(max));
+}
+
+PointRangeFilterPtr PointRangeFilter::newIntRange(const String& field, int32_t min, int32_t max, bool minInclusive, bool maxInclusive) {
+    return newLongRange(field, min, max, minInclusive, maxInclusive);
+}
+
+PointRangeFilterPtr PointRangeFilter::newDoubleRange(const String& field, double min, double max, bool minInclusive, bool maxInclusive) {
+    // the sortable longs of doubles are in the same order as the doubles, so the next double up or down is one away
+    return newLongRange(field, NumericUtils::doubleToSortableLong(min), NumericUtils::doubleToSortableLong(max), minInclusive, maxInclusive);
+}
+
+PointRangeFilterPtr PointRangeFilter::newBox(const String& field, Collection<int64_t> lowerValue, Collection<int64_t> upperValue) {
+    return newLucene<PointRangeFilter>(field, lowerValue, upperValue);
+}
+
+PointRangeFilterPtr PointRangeFilter::newDoubleBox(const String& field, Collection<double> lowerValue, Collection<double> upperValue) {
+    Collection<int64_t> lower(Collection<int64_t>::newInstance(lowerValue.size()));
+    Collection<int64_t> upper(Collection<int64_t>::newInstance(upperValue.size()));
+    for (int32_t dim = 0; dim < lowerValue.size(); ++dim) {
+        lower[dim] = NumericUtils::doubleToSortableLong(lowerValue[dim]);
+    }
+    for (int32_t dim = 0; dim < upperValue.size(); ++dim) {
+        upper[dim] = NumericUtils::doubleToSortableLong(upperValue[dim]);
+    }
+    return newLucene<PointRangeFilter>(field, lower, upper);
+}
+
+String PointRangeFilter::getField() {
+    return field;
+}
+
+Collection<int64_t> PointRangeFilter::getLowerValue() {
+    return lowerValue;
+}
+
+Collection<int64_t> PointRangeFilter::getUpperValue() {
+    return upperValue;
+}
+
+DocIdSetPtr PointRangeFilter::getDocIdSet(const IndexReaderPtr& reader) {
+    PointValuesPtr values(reader->getPointValues(field));
+    if (!values) {
+        return DocIdSet::EMPTY_DOCIDSET();
+    }
+    if (values->getNumDimensions() != lowerValue.size()) {
+        boost::throw_exception(IllegalArgumentException(L"field \"" + field + L"\" has points of " + StringUtils::toString(values->getNumDimensions()) +
+                               L" dimensions, not " + StringUtils::toString(lowerValue.size())));
+    }
+
+    OpenBitSetPtr bits(newLucene<OpenBitSet>(reader->maxDoc()));
+    values->intersect(newLucene<PointRangeVisitor>(lowerValue, upperValue, bits));
+
+    // the points of deleted documents stay in the tree until their segment is merged away
+    if (reader->hasDeletions()) {
+        for (int32_t doc = bits->nextSetBit((int32_t)0); doc != -1; doc = bits->nextSetBit(doc + 1)) {
+            if (reader->isDeleted(doc)) {
+                bits->fastClear(doc);
+            }
+        }
+    }
+    return bits;
+}
+
+String PointRangeFilter::toString() {
+    StringStream buffer;
+    buffer << field << L":[";
+    for (int32_t dim = 0; dim < lowerValue.size(); ++dim) {
+        buffer << (dim > 0 ? L"," : L"") << lowerValue[dim];
+    }
+    buffer << L" TO ";
+    for (int32_t dim = 0; dim < upperValue.size(); ++dim) {
+        buffer << (dim > 0 ? L"," : L"") << upperValue[dim];
+    }
+    buffer << L"]";
+    return buffer.str();
+}
+
+bool PointRangeFilter::equals(const LuceneObjectPtr& other) {
+    if (Filter::equals(other)) {
+        return true;
+    }
+    PointRangeFilterPtr otherFilter(std::dynamic_pointer_cast<PointRangeFilter>(other));
+    if (!otherFilter) {
+        return false;
+    }
+    return (field == otherFilter->field && lowerValue.equals(otherFilter->lowerValue) && upperValue.equals(otherFilter->upperValue));
+}
+
+int32_t PointRangeFilter::hashCode() {
+    int32_t code = StringUtils::hashCode(field);
+    for (int32_t dim = 0; dim < lowerValue.size(); ++dim) {
+        code = code * 31 + (int32_t)(lowerValue[dim] ^ MiscUtils::unsignedShift(lowerValue[dim], (int64_t)32));
+        code = code * 31 + (int32_t)(upperValue[dim] ^ MiscUtils::unsignedShift(upperValue[dim], (int64_t)32));
+    }
+    return code;
+}
+
+PointRangeVisitor::PointRangeVisitor(Collection<int64_t> lowerValue, Collection<int64_t> upperValue, const OpenBitSetPtr& bits) {
+    this->lowerValue = lowerValue;
+    this->upperValue = upperValue;
+    this->numDims = lowerValue.size();
+    this->bits = bits;
+}
+
+PointRangeVisitor::~PointRangeVisitor() {
+}
+
+void PointRangeVisitor::visit(int32_t doc) {
+    bits->fastSet(doc);
+}
+
+void PointRangeVisitor::visit(int32_t doc, const int64_t* point) {
+    for (int32_t dim = 0; dim < numDims; ++dim) {
+        if (point[dim] < lowerValue[dim] || point[dim] > upperValue[dim]) {
+            return;
+        }
+    }
+    bits->fastSet(doc);
+}
+
+PointVisitor::Relation PointRangeVisitor::compare(const int64_t* minValues, const int64_t* maxValues) {
+    bool crosses = false;
+    for (int32_t dim = 0; dim < numDims; ++dim) {
+        if (maxValues[dim] < lowerValue[dim] || minValues[dim] > upperValue[dim]) {
+            return CELL_OUTSIDE_QUERY;
+        }
+        if (minValues[dim] < lowerValue[dim] || maxValues[dim] > upperValue[dim]) {
+            crosses = true;
+        }
+    }
+    return crosses ? CELL_CROSSES_QUERY : CELL_INSIDE_QUERY;
+}
+
+}
@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PointRangeQuery.h"
+#include "PointRangeFilter.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+PointRangeQuery::PointRangeQuery(const PointRangeFilterPtr& filter) : ConstantScoreQuery(filter) {
+}
+
+PointRangeQuery::~PointRangeQuery() {
+}
+
+PointRangeQueryPtr PointRangeQuery::newLongRange(const String& field, int64_t min, int64_t max, bool minInclusive, bool maxInclusive) {
+    return newLucene<PointRangeQuery>(PointRangeFilter::newLongRange(field, min, max, minInclusive, maxInclusive));
+}
+
+PointRangeQueryPtr PointRangeQuery::newIntRange(const String& field, int32_t min, int32_t max, bool minInclusive, bool maxInclusive) {
+    return newLucene<PointRangeQuery>(PointRangeFilter::newIntRange(field, min, max, minInclusive, maxInclusive));
+}
+
+PointRangeQueryPtr PointRangeQuery::newDoubleRange(const String& field, double min, double max, bool minInclusive, bool maxInclusive) {
+    return newLucene<PointRangeQuery>(PointRangeFilter::newDoubleRange(field, min, max, minInclusive, maxInclusive));
+}
+
+PointRangeQueryPtr PointRangeQuery::newBox(const String& field, Collection<int64_t> lowerValue, Collection<int64_t> upperValue) {
+    return newLucene<PointRangeQuery>(PointRangeFilter::newBox(field, lowerValue, upperValue));
+}
+
+PointRangeQueryPtr PointRangeQuery::newDoubleBox(const String& field, Collection<double> lowerValue, Collection<double> upperValue) {
+    return newLucene<PointRangeQuery>(PointRangeFilter::newDoubleBox(field, lowerValue, upperValue));
+}
+
+String PointRangeQuery::toString(const String& field) {
+    return filter->toString() + (getBoost() == 1.0 ? L"" : L"^" + StringUtils::toString(getBoost()));
+}
+
+LuceneObjectPtr PointRangeQuery::clone(const LuceneObjectPtr& other) {
+    LuceneObjectPtr clone = other ? other : newLucene<PointRangeQuery>(std::static_pointer_cast<PointRangeFilter>(filter));
+    return ConstantScoreQuery::clone(clone);
+}
+
+}
@@ -33,6 +33,10 @@ namespace Lucene {
         }
     }
     
+    void Scorer::setMinCompetitiveScore(double minScore) {
+        // override
+    }
+    
     bool Scorer::score(const CollectorPtr& collector, int32_t max, int32_t firstDocID) {
         collector->setScorer(shared_from_this());
         int32_t doc = firstDocID;
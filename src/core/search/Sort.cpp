@@ -67,6 +67,17 @@ String Sort::toString() {
     return buffer.str();
 }
 
+String Sort::getIndexKey() {
+    StringStream buffer;
+    for (Collection<SortFieldPtr>::iterator field = fields.begin(); field != fields.end(); ++field) {
+        if (field != fields.begin()) {
+            buffer << L",";
+        }
+        buffer << (*field)->getIndexKey();
+    }
+    return buffer.str();
+}
+
 bool Sort::equals(const LuceneObjectPtr& other) {
     if (LuceneObject::equals(other)) {
         return true;
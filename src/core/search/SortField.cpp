@@ -185,6 +185,21 @@ String SortField::toString() {
     return buffer.str();
 }
 
+String SortField::getIndexKey() {
+    StringStream buffer;
+    buffer << toString();
+    if (locale) {
+        buffer << L"(locale: " << StringUtils::toUnicode(locale->name().c_str()) << L")";
+    }
+    if (comparatorSource) {
+        buffer << L"(" << comparatorSource->getClassName() << L")";
+    }
+    if (parser) {
+        buffer << L"(" << parser->getClassName() << L")";
+    }
+    return buffer.str();
+}
+
 bool SortField::equals(const LuceneObjectPtr& other) {
     if (LuceneObject::equals(other)) {
         return true;
@@ -9,7 +9,7 @@
 #include "SpanQuery.h"
 #include "SpanFilterResult.h"
 #include "Spans.h"
-#include "OpenBitSet.h"
+#include "RoaringDocIdSet.h"
 #include "IndexReader.h"
 
 namespace Lucene {
@@ -27,14 +27,14 @@ DocIdSetPtr SpanQueryFilter::getDocIdSet(const IndexReaderPtr& reader) {
 }
 
 SpanFilterResultPtr SpanQueryFilter::bitSpans(const IndexReaderPtr& reader) {
-    OpenBitSetPtr bits(newLucene<OpenBitSet>(reader->maxDoc()));
+    RoaringDocIdSetBuilderPtr bits(newLucene<RoaringDocIdSetBuilder>(reader->maxDoc()));
     SpansPtr spans(query->getSpans(reader));
     Collection<PositionInfoPtr> tmp(Collection<PositionInfoPtr>::newInstance());
     int32_t currentDoc = -1;
     PositionInfoPtr currentInfo;
     while (spans->next()) {
         int32_t doc = spans->doc();
-        bits->set(doc);
+        bits->add(doc);
         if (currentDoc != doc) {
             currentInfo = newLucene<PositionInfo>(doc);
             tmp.add(currentInfo);
@@ -42,7 +42,7 @@ SpanFilterResultPtr SpanQueryFilter::bitSpans(const IndexReaderPtr& reader) {
         }
         currentInfo->addPosition(spans->start(), spans->end());
     }
-    return newLucene<SpanFilterResult>(bits, tmp);
+    return newLucene<SpanFilterResult>(bits->build(), tmp);
 }
 
 SpanQueryPtr SpanQueryFilter::getQuery() {
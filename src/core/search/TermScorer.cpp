@@ -10,6 +10,8 @@
 #include "Similarity.h"
 #include "Weight.h"
 #include "Collector.h"
+#include "TermQuery.h"
+#include "Term.h"
 
 namespace Lucene {
 
@@ -26,6 +28,7 @@ TermScorer::TermScorer(const WeightPtr& weight, const TermDocsPtr& td, const Sim
     this->pointer = 0;
     this->pointerMax = 0;
     this->scoreCache = Collection<double>::newInstance(SCORE_CACHE_SIZE);
+    this->batchScores = Collection<double>::newInstance(docs.size());
 
     for (int32_t i = 0; i < SCORE_CACHE_SIZE; ++i) {
         scoreCache[i] = getSimilarity()->tf(i) * weightValue;
@@ -46,6 +49,9 @@ void TermScorer::score(const CollectorPtr& collector) {
 bool TermScorer::score(const CollectorPtr& collector, int32_t max, int32_t firstDocID) {
     // firstDocID is ignored since nextDoc() sets 'doc'
     collector->setScorer(shared_from_this());
+    if (collector->acceptsBatches()) {
+        return scoreBatches(collector, max);
+    }
     while (doc < max) { // for docs in window
         collector->collect(doc);
 
@@ -65,6 +71,51 @@ bool TermScorer::score(const CollectorPtr& collector, int32_t max, int32_t first
     return true;
 }
 
+bool TermScorer::scoreBatches(const CollectorPtr& collector, int32_t max) {
+    SimilarityPtr similarity(getSimilarity());
+    Collection<double> normDecoder(SIM_NORM_DECODER());
+    const double* decoder = &normDecoder[0];
+    const double* cache = &scoreCache[0];
+    double* scores = &batchScores[0];
+
+    while (doc < max) { // for docs in window
+        // 'doc' is docs[pointer]; take the rest of the buffer that falls in the window
+        const int32_t* bufferDocs = &docs[0];
+        const int32_t* bufferFreqs = &freqs[0];
+        int32_t end = pointer + 1;
+        while (end < pointerMax && bufferDocs[end] < max) {
+            ++end;
+        }
+
+        for (int32_t i = pointer; i < end; ++i) {
+            int32_t f = bufferFreqs[i];
+            scores[i] = f < SCORE_CACHE_SIZE ? cache[f] : similarity->tf(f) * weightValue; // compute tf(f) * weight
+        }
+        if (norms) {
+            const uint8_t* fieldNorms = norms.get();
+            for (int32_t i = pointer; i < end; ++i) {
+                scores[i] *= decoder[fieldNorms[bufferDocs[i]]]; // normalize for field
+            }
+        }
+        collector->collectBatch(bufferDocs + pointer, scores + pointer, end - pointer);
+
+        if (end < pointerMax) {
+            pointer = end;
+        } else {
+            pointerMax = termDocs->read(docs, freqs); // refill buffers
+            if (pointerMax == 0) {
+                termDocs->close(); // close stream
+                doc = INT_MAX; // set to sentinel value
+                return false;
+            }
+            pointer = 0;
+        }
+        doc = docs[pointer];
+        freq = freqs[pointer];
+    }
+    return true;
+}
+
 int32_t TermScorer::docID() {
     return doc;
 }
@@ -117,6 +168,32 @@ int32_t TermScorer::advance(int32_t target) {
     return doc;
 }
 
+int32_t TermScorer::maxFreq() {
+    return termDocs->maxFreq();
+}
+
+int32_t TermScorer::advanceShallow(int32_t target) {
+    return termDocs->advanceShallow(target);
+}
+
+int32_t TermScorer::blockMaxFreq() {
+    return termDocs->blockMaxFreq();
+}
+
+double TermScorer::scoreBound(int32_t freq, double normBound) {
+    double raw = freq < SCORE_CACHE_SIZE ? scoreCache[freq] : getSimilarity()->tf(freq) * weightValue;
+    return norms ? raw * normBound : raw;
+}
+
+ByteArray TermScorer::getNorms() {
+    return norms;
+}
+
+String TermScorer::getField() {
+    TermQueryPtr query(std::dynamic_pointer_cast<TermQuery>(weight->getQuery()));
+    return query ? query->getTerm()->field() : L"";
+}
+
 String TermScorer::toString() {
     return L"term scorer(" + weight->toString() + L")";
 }
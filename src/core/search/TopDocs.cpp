@@ -6,9 +6,73 @@
 
 #include "LuceneInc.h"
 #include "TopDocs.h"
+#include "TopFieldDocs.h"
+#include "FieldDocSortedHitQueue.h"
+#include "FieldDoc.h"
+#include "Sort.h"
+#include "MiscUtils.h"
 
 namespace Lucene {
 
+/// Ranks hits the same way as {@link HitQueue}: higher score first, lower doc id breaking ties.
+struct ScoreDocBefore {
+    bool operator()(const ScoreDocPtr& first, const ScoreDocPtr& second) const {
+        return first->score == second->score ? first->doc < second->doc : first->score > second->score;
+    }
+};
+
+/// Exposes the sort order of {@link FieldDocSortedHitQueue} to the shard merge.
+class FieldDocMergeQueue : public FieldDocSortedHitQueue {
+public:
+    FieldDocMergeQueue() : FieldDocSortedHitQueue(0) {
+    }
+
+    virtual ~FieldDocMergeQueue() {
+    }
+
+    LUCENE_CLASS(FieldDocMergeQueue);
+
+public:
+    bool before(const FieldDocPtr& first, const FieldDocPtr& second) {
+        return lessThan(second, first);
+    }
+};
+
+DECLARE_SHARED_PTR(FieldDocMergeQueue)
+
+struct FieldDocBefore {
+    FieldDocBefore(const FieldDocMergeQueuePtr& queue) : queue(queue) {
+    }
+
+    FieldDocMergeQueuePtr queue;
+
+    bool operator()(const FieldDocPtr& first, const FieldDocPtr& second) const {
+        return queue->before(first, second);
+    }
+};
+
+/// Merge the hits of each shard, already in rank order, into the overall top n.  Each step picks the best head
+/// among the shards, so the merge runs on the calling thread without any shared queue or lock.
+template <class DOC, class BEFORE>
+static Collection<ScoreDocPtr> mergeShardDocs(Collection< Collection<DOC> > shardDocs, int32_t n, BEFORE before) {
+    int32_t available = 0;
+    for (int32_t i = 0; i < shardDocs.size(); ++i) {
+        available += shardDocs[i].size();
+    }
+    Collection<ScoreDocPtr> scoreDocs(Collection<ScoreDocPtr>::newInstance(std::min(n, available)));
+    Collection<int32_t> heads(Collection<int32_t>::newInstance(shardDocs.size()));
+    for (int32_t doc = 0; doc < scoreDocs.size(); ++doc) {
+        int32_t best = -1;
+        for (int32_t i = 0; i < shardDocs.size(); ++i) {
+            if (heads[i] < shardDocs[i].size() && (best == -1 || before(shardDocs[i][heads[i]], shardDocs[best][heads[best]]))) {
+                best = i;
+            }
+        }
+        scoreDocs[doc] = shardDocs[best][heads[best]++];
+    }
+    return scoreDocs;
+}
+
 TopDocs::TopDocs(int32_t totalHits, Collection<ScoreDocPtr> scoreDocs) {
     this->totalHits = totalHits;
     this->scoreDocs = scoreDocs;
@@ -32,4 +96,42 @@ void TopDocs::setMaxScore(double maxScore) {
     this->maxScore = maxScore;
 }
 
+TopDocsPtr TopDocs::merge(const SortPtr& sort, int32_t n, Collection<TopDocsPtr> shardHits) {
+    int32_t totalHits = 0;
+    double maxScore = std::numeric_limits<double>::quiet_NaN();
+    Collection<SortFieldPtr> fields;
+    for (int32_t i = 0; i < shardHits.size(); ++i) {
+        totalHits += shardHits[i]->totalHits;
+        if (!MiscUtils::isNaN(shardHits[i]->maxScore)) {
+            maxScore = MiscUtils::isNaN(maxScore) ? shardHits[i]->maxScore : std::max(maxScore, shardHits[i]->maxScore);
+        }
+        TopFieldDocsPtr fieldDocs(std::dynamic_pointer_cast<TopFieldDocs>(shardHits[i]));
+        if (fieldDocs && !fields) {
+            fields = fieldDocs->fields;
+        }
+    }
+
+    if (!sort) {
+        Collection< Collection<ScoreDocPtr> > shardDocs(Collection< Collection<ScoreDocPtr> >::newInstance(shardHits.size()));
+        for (int32_t i = 0; i < shardHits.size(); ++i) {
+            shardDocs[i] = shardHits[i]->scoreDocs;
+        }
+        return newLucene<TopDocs>(totalHits, mergeShardDocs(shardDocs, n, ScoreDocBefore()), maxScore);
+    }
+
+    if (!fields) {
+        fields = sort->getSort();
+    }
+    Collection< Collection<FieldDocPtr> > shardDocs(Collection< Collection<FieldDocPtr> >::newInstance(shardHits.size()));
+    for (int32_t i = 0; i < shardHits.size(); ++i) {
+        shardDocs[i] = Collection<FieldDocPtr>::newInstance(shardHits[i]->scoreDocs.size());
+        for (int32_t j = 0; j < shardHits[i]->scoreDocs.size(); ++j) {
+            shardDocs[i][j] = std::static_pointer_cast<FieldDoc>(shardHits[i]->scoreDocs[j]);
+        }
+    }
+    FieldDocMergeQueuePtr mergeQueue(newLucene<FieldDocMergeQueue>());
+    mergeQueue->setFields(fields);
+    return newLucene<TopFieldDocs>(totalHits, mergeShardDocs(shardDocs, n, FieldDocBefore(mergeQueue)), fields, maxScore);
+}
+
 }
@@ -5,6 +5,7 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "LuceneInc.h"
+#include <boost/algorithm/string.hpp>
 #include "TopFieldCollector.h"
 #include "_TopFieldCollector.h"
 #include "FieldValueHitQueue.h"
@@ -13,6 +14,8 @@
 #include "Scorer.h"
 #include "Sort.h"
 #include "TopFieldDocs.h"
+#include "SegmentReader.h"
+#include "SegmentInfo.h"
 
 namespace Lucene {
 
@@ -22,6 +25,7 @@ TopFieldCollector::TopFieldCollector(const HitQueueBasePtr& pq, int32_t numHits,
     this->maxScore = std::numeric_limits<double>::quiet_NaN();
     this->queueFull = false;
     this->docBase = 0;
+    this->segmentSorted = false;
 }
 
 TopFieldCollector::~TopFieldCollector() {
@@ -115,6 +119,29 @@ bool TopFieldCollector::acceptsDocsOutOfOrder() {
     return false;
 }
 
+bool TopFieldCollector::isSorted(const IndexReaderPtr& reader) {
+    SegmentReaderPtr segmentReader(std::dynamic_pointer_cast<SegmentReader>(reader));
+    if (!segmentReader) {
+        return false;
+    }
+    MapStringString diagnostics(segmentReader->getSegmentInfo()->getDiagnostics());
+    String segmentSort(diagnostics ? diagnostics.get(L"sort") : L"");
+    if (segmentSort.empty()) {
+        return false;
+    }
+    if (sortKey.empty()) {
+        sortKey = newLucene<Sort>(std::static_pointer_cast<FieldValueHitQueue>(pq)->getFields())->getIndexKey();
+    }
+    // sorted by a longer sort, the documents are still in order for its leading fields
+    return (segmentSort == sortKey || boost::starts_with(segmentSort, sortKey + L","));
+}
+
+void TopFieldCollector::terminateIfSorted() {
+    if (segmentSorted) {
+        boost::throw_exception(CollectionTerminatedException());
+    }
+}
+
 OneComparatorNonScoringCollector::OneComparatorNonScoringCollector(const FieldValueHitQueuePtr& queue, int32_t numHits, bool fillFields) : TopFieldCollector(queue, numHits, fillFields) {
 }
 
@@ -140,6 +167,7 @@ void OneComparatorNonScoringCollector::collect(int32_t doc) {
         if ((reverseMul * comparator->compareBottom(doc)) <= 0) {
             // since docs are visited in doc Id order, if compare is 0, it means this document is largest
             // than anything else in the queue, and therefore not competitive.
+            terminateIfSorted();
             return;
         }
 
@@ -161,6 +189,7 @@ void OneComparatorNonScoringCollector::collect(int32_t doc) {
 
 void OneComparatorNonScoringCollector::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
     this->docBase = docBase;
+    this->segmentSorted = isSorted(reader);
     comparator->setNextReader(reader, docBase);
 }
 
@@ -221,6 +250,7 @@ void OneComparatorScoringNoMaxScoreCollector::collect(int32_t doc) {
         if ((reverseMul * comparator->compareBottom(doc)) <= 0) {
             // since docs are visited in doc Id order, if compare is 0, it means this document is largest
             // than anything else in the queue, and therefore not competitive.
+            terminateIfSorted();
             return;
         }
 
@@ -406,6 +436,7 @@ void MultiComparatorNonScoringCollector::collect(int32_t doc) {
             int32_t c = reverseMul[i] * comparators[i]->compareBottom(doc);
             if (c < 0) {
                 // Definitely not competitive.
+                terminateIfSorted();
                 return;
             } else if (c > 0) {
                 // Definitely competitive.
@@ -414,6 +445,7 @@ void MultiComparatorNonScoringCollector::collect(int32_t doc) {
                 // Here c=0. If we're at the last comparator, this doc is not competitive, since docs are
                 // visited in doc Id order, which means this doc cannot compete with any other document
                 // in the queue.
+                terminateIfSorted();
                 return;
             }
         }
@@ -446,6 +478,7 @@ void MultiComparatorNonScoringCollector::collect(int32_t doc) {
 
 void MultiComparatorNonScoringCollector::setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
     this->docBase = docBase;
+    this->segmentSorted = isSorted(reader);
     for (Collection<FieldComparatorPtr>::iterator cmp = comparators.begin(); cmp != comparators.end(); ++cmp) {
         (*cmp)->setNextReader(reader, docBase);
     }
@@ -667,6 +700,7 @@ void MultiComparatorScoringNoMaxScoreCollector::collect(int32_t doc) {
             int32_t c = reverseMul[i] * comparators[i]->compareBottom(doc);
             if (c < 0) {
                 // Definitely not competitive.
+                terminateIfSorted();
                 return;
             } else if (c > 0) {
                 // Definitely competitive.
@@ -675,6 +709,7 @@ void MultiComparatorScoringNoMaxScoreCollector::collect(int32_t doc) {
                 // Here c=0. If we're at the last comparator, this doc is not competitive, since docs are
                 // visited in doc Id order, which means this doc cannot compete with any other document
                 // in the queue.
+                terminateIfSorted();
                 return;
             }
         }
@@ -33,6 +33,14 @@ TopScoreDocCollectorPtr TopScoreDocCollector::create(int32_t numHits, bool docsS
     }
 }
 
+TopScoreDocCollectorPtr TopScoreDocCollector::create(int32_t numHits, bool docsScoredInOrder, bool trackTotalHits) {
+    if (trackTotalHits) {
+        return create(numHits, docsScoredInOrder);
+    } else {
+        return newLucene<MinCompetitiveTopScoreDocCollector>(numHits);
+    }
+}
+
 TopDocsPtr TopScoreDocCollector::newTopDocs(Collection<ScoreDocPtr> results, int32_t start) {
     if (!results) {
         return EMPTY_TOPDOCS();
@@ -91,6 +99,24 @@ bool InOrderTopScoreDocCollector::acceptsDocsOutOfOrder() {
     return false;
 }
 
+bool InOrderTopScoreDocCollector::acceptsBatches() {
+    return true;
+}
+
+void InOrderTopScoreDocCollector::collectBatch(const int32_t* docs, const double* scores, int32_t count) {
+    totalHits += count;
+    double minScore = pqTop->score;
+    for (int32_t i = 0; i < count; ++i) {
+        // same rule as collect(): a tie loses to the lower doc Id already in the queue
+        if (scores[i] > minScore) {
+            pqTop->doc = docs[i] + docBase;
+            pqTop->score = scores[i];
+            pqTop = pq->updateTop();
+            minScore = pqTop->score;
+        }
+    }
+}
+
 OutOfOrderTopScoreDocCollector::OutOfOrderTopScoreDocCollector(int32_t numHits) : TopScoreDocCollector(numHits) {
 }
 
@@ -117,4 +143,58 @@ bool OutOfOrderTopScoreDocCollector::acceptsDocsOutOfOrder() {
     return true;
 }
 
+bool OutOfOrderTopScoreDocCollector::acceptsBatches() {
+    return true;
+}
+
+void OutOfOrderTopScoreDocCollector::collectBatch(const int32_t* docs, const double* scores, int32_t count) {
+    totalHits += count;
+    for (int32_t i = 0; i < count; ++i) {
+        int32_t doc = docs[i] + docBase;
+        if (scores[i] < pqTop->score || (scores[i] == pqTop->score && doc > pqTop->doc)) {
+            continue;
+        }
+        pqTop->doc = doc;
+        pqTop->score = scores[i];
+        pqTop = pq->updateTop();
+    }
+}
+
+MinCompetitiveTopScoreDocCollector::MinCompetitiveTopScoreDocCollector(int32_t numHits) : InOrderTopScoreDocCollector(numHits) {
+}
+
+MinCompetitiveTopScoreDocCollector::~MinCompetitiveTopScoreDocCollector() {
+}
+
+void MinCompetitiveTopScoreDocCollector::setScorer(const ScorerPtr& scorer) {
+    InOrderTopScoreDocCollector::setScorer(scorer);
+    // carry the threshold reached on earlier segments over to this one
+    scorer->setMinCompetitiveScore(pqTop->score);
+}
+
+void MinCompetitiveTopScoreDocCollector::collect(int32_t doc) {
+    ScorerPtr scorer(_scorer);
+    double score = scorer->score();
+
+    // This collector cannot handle these scores
+    BOOST_ASSERT(score != -std::numeric_limits<double>::infinity());
+    BOOST_ASSERT(!MiscUtils::isNaN(score));
+
+    ++totalHits;
+    if (score <= pqTop->score) {
+        return;
+    }
+    pqTop->doc = doc + docBase;
+    pqTop->score = score;
+    pqTop = pq->updateTop();
+
+    // the sentinels keep this at negative infinity until the queue is full
+    scorer->setMinCompetitiveScore(pqTop->score);
+}
+
+void MinCompetitiveTopScoreDocCollector::collectBatch(const int32_t* docs, const double* scores, int32_t count) {
+    InOrderTopScoreDocCollector::collectBatch(docs, scores, count);
+    ScorerPtr(_scorer)->setMinCompetitiveScore(pqTop->score);
+}
+
 }
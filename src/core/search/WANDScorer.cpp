@@ -0,0 +1,181 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "WANDScorer.h"
+#include "TermScorer.h"
+#include "Similarity.h"
+#include "IndexReader.h"
+
+namespace Lucene {
+
+/// Bounds are summed in a different order than scores, so they are widened by a few ulps to stay above them.
+static const double BOUND_SLACK = 1.0 + 1e-9;
+
+WANDScorer::WANDScorer(const SimilarityPtr& similarity, Collection<TermScorerPtr> subScorers, Collection<double> normBounds) : Scorer(similarity) {
+    this->subScorers = subScorers;
+    this->nrScorers = subScorers.size();
+    this->normBounds = normBounds;
+    this->subDocs = Collection<int32_t>::newInstance(nrScorers);
+    this->ordered = Collection<int32_t>::newInstance(nrScorers);
+    this->maxScores = Collection<double>::newInstance(nrScorers);
+    for (int32_t i = 0; i < nrScorers; ++i) {
+        subDocs[i] = -1;
+        ordered[i] = i;
+        maxScores[i] = subScorers[i]->scoreBound(subScorers[i]->maxFreq(), normBounds[i]) * BOUND_SLACK;
+    }
+    this->coordFactors = Collection<double>::newInstance(nrScorers + 1);
+    this->maxCoordFactors = Collection<double>::newInstance(nrScorers + 1);
+    double maxCoord = 0.0;
+    for (int32_t i = 0; i <= nrScorers; ++i) {
+        coordFactors[i] = similarity->coord(i, nrScorers);
+        maxCoord = std::max(maxCoord, coordFactors[i]);
+        maxCoordFactors[i] = maxCoord;
+    }
+    this->minCompetitiveScore = -std::numeric_limits<double>::infinity();
+    this->currentDoc = -1;
+    this->currentScore = 0.0;
+}
+
+WANDScorer::~WANDScorer() {
+}
+
+ScorerPtr WANDScorer::create(const SimilarityPtr& similarity, const IndexReaderPtr& reader, Collection<ScorerPtr> subScorers) {
+    Collection<TermScorerPtr> termScorers(Collection<TermScorerPtr>::newInstance());
+    Collection<double> normBounds(Collection<double>::newInstance());
+    for (Collection<ScorerPtr>::iterator scorer = subScorers.begin(); scorer != subScorers.end(); ++scorer) {
+        TermScorerPtr termScorer(std::dynamic_pointer_cast<TermScorer>(*scorer));
+        if (!termScorer || termScorer->maxFreq() < 0) {
+            return ScorerPtr();
+        }
+        double normBound = 1.0;
+        if (termScorer->getNorms()) {
+            String field(termScorer->getField());
+            if (field.empty()) {
+                return ScorerPtr();
+            }
+            // a segment reader keeps the bound with the field's norms, so it is not scanned per query
+            normBound = reader->maxNorm(field);
+        }
+        termScorers.add(termScorer);
+        normBounds.add(normBound);
+    }
+    return newLucene<WANDScorer>(similarity, termScorers, normBounds);
+}
+
+int32_t WANDScorer::docID() {
+    return currentDoc;
+}
+
+int32_t WANDScorer::nextDoc() {
+    if (currentDoc == NO_MORE_DOCS) {
+        return currentDoc;
+    }
+    for (int32_t i = 0; i < nrScorers; ++i) {
+        if (subDocs[i] == currentDoc) {
+            subDocs[i] = subScorers[i]->nextDoc();
+        }
+    }
+    return findNext();
+}
+
+int32_t WANDScorer::advance(int32_t target) {
+    for (int32_t i = 0; i < nrScorers; ++i) {
+        if (subDocs[i] < target) {
+            subDocs[i] = subScorers[i]->advance(target);
+        }
+    }
+    return findNext();
+}
+
+double WANDScorer::score() {
+    return currentScore;
+}
+
+void WANDScorer::setMinCompetitiveScore(double minScore) {
+    minCompetitiveScore = minScore;
+}
+
+void WANDScorer::sortByDoc() {
+    for (int32_t i = 1; i < nrScorers; ++i) {
+        int32_t sub = ordered[i];
+        int32_t j = i;
+        for (; j > 0 && subDocs[ordered[j - 1]] > subDocs[sub]; --j) {
+            ordered[j] = ordered[j - 1];
+        }
+        ordered[j] = sub;
+    }
+}
+
+int32_t WANDScorer::findNext() {
+    while (true) {
+        sortByDoc();
+
+        // the pivot is the first sub-scorer at which a document may become competitive
+        int32_t pivot = -1;
+        double bound = 0.0;
+        for (int32_t i = 0; i < nrScorers && subDocs[ordered[i]] != NO_MORE_DOCS; ++i) {
+            bound += maxScores[ordered[i]];
+            if (bound * maxCoordFactors[i + 1] > minCompetitiveScore) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot == -1) {
+            currentDoc = NO_MORE_DOCS;
+            return currentDoc;
+        }
+
+        int32_t pivotDoc = subDocs[ordered[pivot]];
+        if (subDocs[ordered[0]] < pivotDoc) {
+            // documents before the pivot's can only match the sub-scorers ahead of it, whose bounds don't suffice
+            for (int32_t i = 0; i < pivot; ++i) {
+                int32_t sub = ordered[i];
+                if (subDocs[sub] < pivotDoc) {
+                    subDocs[sub] = subScorers[sub]->advance(pivotDoc);
+                }
+            }
+            continue;
+        }
+
+        int32_t last = pivot;
+        while (last + 1 < nrScorers && subDocs[ordered[last + 1]] == pivotDoc) {
+            ++last;
+        }
+
+        if (minCompetitiveScore > -std::numeric_limits<double>::infinity()) {
+            // bound the documents from the pivot's up to the end of the shortest current block
+            int32_t upTo = last + 1 < nrScorers ? subDocs[ordered[last + 1]] - 1 : NO_MORE_DOCS - 1;
+            double blockBound = 0.0;
+            for (int32_t i = 0; i <= last; ++i) {
+                int32_t sub = ordered[i];
+                upTo = std::min(upTo, subScorers[sub]->advanceShallow(pivotDoc));
+                blockBound += subScorers[sub]->scoreBound(subScorers[sub]->blockMaxFreq(), normBounds[sub]) * BOUND_SLACK;
+            }
+            if (blockBound * maxCoordFactors[last + 1] <= minCompetitiveScore) {
+                int32_t target = upTo + 1;
+                for (int32_t i = 0; i <= last; ++i) {
+                    int32_t sub = ordered[i];
+                    subDocs[sub] = target == NO_MORE_DOCS ? NO_MORE_DOCS : subScorers[sub]->advance(target);
+                }
+                continue;
+            }
+        }
+
+        // sum in clause order, as BooleanScorer does, so that equal scores tie the same way
+        currentDoc = pivotDoc;
+        double sum = 0.0;
+        for (int32_t i = 0; i < nrScorers; ++i) {
+            if (subDocs[i] == pivotDoc) {
+                sum += subScorers[i]->score();
+            }
+        }
+        currentScore = sum * coordFactors[last + 1];
+        return currentDoc;
+    }
+}
+
+}
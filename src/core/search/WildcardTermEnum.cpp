@@ -9,6 +9,7 @@
 #include "WildcardTermEnum.h"
 #include "Term.h"
 #include "IndexReader.h"
+#include "Automaton.h"
 
 namespace Lucene {
 
@@ -33,13 +34,16 @@ WildcardTermEnum::WildcardTermEnum(const IndexReaderPtr& reader, const TermPtr&
 
     preLen = pre.length();
     text = searchTermText.substr(preLen);
-    setEnum(reader->terms(newLucene<Term>(searchTerm->field(), pre)));
+    setAutomatonEnum(reader, field, Automaton::makeWildcard(searchTermText), newLucene<Term>(searchTerm->field(), pre));
 }
 
 WildcardTermEnum::~WildcardTermEnum() {
 }
 
 bool WildcardTermEnum::termCompare(const TermPtr& term) {
+    if (automaton) {
+        return true; // only called for terms the automaton accepts
+    }
     if (field == term->field()) {
         String searchText(term->text());
         if (boost::starts_with(searchText, pre)) {
@@ -7,6 +7,7 @@
 #include "LuceneInc.h"
 #include "BufferedIndexInput.h"
 #include "MiscUtils.h"
+#include "VIntUtils.h"
 #include "StringUtils.h"
 
 namespace Lucene {
@@ -31,6 +32,21 @@ uint8_t BufferedIndexInput::readByte() {
     return buffer[bufferPosition++];
 }
 
+void BufferedIndexInput::readVInts(int32_t* values, int32_t count) {
+    while (count > 0) {
+        if (bufferPosition < bufferLength) {
+            int32_t decoded = VIntUtils::decode(buffer.get(), bufferPosition, bufferLength, values, count);
+            values += decoded;
+            count -= decoded;
+        }
+        if (count > 0) {
+            // next value straddles the end of the buffer
+            *values++ = readVInt();
+            --count;
+        }
+    }
+}
+
 void BufferedIndexInput::setBufferSize(int32_t newSize) {
     if (newSize != bufferSize) {
         bufferSize = newSize;
@@ -43,6 +43,12 @@ int32_t IndexInput::readVInt() {
     return i;
 }
 
+void IndexInput::readVInts(int32_t* values, int32_t count) {
+    for (int32_t i = 0; i < count; ++i) {
+        values[i] = readVInt();
+    }
+}
+
 int64_t IndexInput::readLong() {
     int64_t i = (int64_t)readInt() << 32;
     i |= (readInt() & 0xffffffffLL);
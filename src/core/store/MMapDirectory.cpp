@@ -5,25 +5,41 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "LuceneInc.h"
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "MMapDirectory.h"
 #include "_MMapDirectory.h"
 #include "SimpleFSDirectory.h"
+#include "IndexWriter.h"
+#include "IndexFileNames.h"
 #include "_SimpleFSDirectory.h"
 #include "MiscUtils.h"
+#include "VIntUtils.h"
 #include "FileUtils.h"
 #include "StringUtils.h"
 
 namespace Lucene {
 
 MMapDirectory::MMapDirectory(const String& path, const LockFactoryPtr& lockFactory) : FSDirectory(path, lockFactory) {
+    preload = false;
 }
 
 MMapDirectory::~MMapDirectory() {
 }
 
+void MMapDirectory::setPreload(bool preload) {
+    this->preload = preload;
+}
+
+bool MMapDirectory::getPreload() {
+    return preload;
+}
+
 IndexInputPtr MMapDirectory::openInput(const String& name, int32_t bufferSize) {
     ensureOpen();
-    return newLucene<MMapIndexInput>(FileUtils::joinPath(directory, name));
+    return newLucene<MMapIndexInput>(FileUtils::joinPath(directory, name), readAdvice(name, bufferSize), preload);
 }
 
 IndexOutputPtr MMapDirectory::createOutput(const String& name) {
@@ -31,15 +47,35 @@ IndexOutputPtr MMapDirectory::createOutput(const String& name) {
     return newLucene<SimpleFSIndexOutput>(FileUtils::joinPath(directory, name));
 }
 
-MMapIndexInput::MMapIndexInput(const String& path) {
-    _length = path.empty() ? 0 : (int32_t)FileUtils::fileLength(path);
+MMapDirectory::ReadAdvice MMapDirectory::readAdvice(const String& name, int32_t bufferSize) {
+    if (bufferSize == IndexWriter::MERGE_READ_BUFFER_SIZE) {
+        return ADVICE_SEQUENTIAL;
+    }
+    String::size_type dot = name.rfind(L'.');
+    String extension(dot == String::npos ? L"" : name.substr(dot + 1));
+    if (extension == IndexFileNames::TERMS_EXTENSION() || extension == IndexFileNames::FIELDS_INDEX_EXTENSION() ||
+            extension == IndexFileNames::FIELDS_EXTENSION() || extension == IndexFileNames::VECTORS_INDEX_EXTENSION() ||
+            extension == IndexFileNames::VECTORS_DOCUMENTS_EXTENSION() || extension == IndexFileNames::VECTORS_FIELDS_EXTENSION()) {
+        return ADVICE_RANDOM;
+    }
+    return ADVICE_NORMAL;
+}
+
+MMapIndexInput::MMapIndexInput(const String& path, MMapDirectory::ReadAdvice advice, bool preload) {
+    _length = path.empty() ? 0 : FileUtils::fileLength(path);
     bufferPosition = 0;
+    data = NULL;
     if (!path.empty()) {
         try {
-            file.open(boost::filesystem::wpath(path), _length);
+            file.open(boost::filesystem::wpath(path), (size_t)_length);
         } catch (...) {
             boost::throw_exception(FileNotFoundException(path));
         }
+        data = (const uint8_t*)file.data();
+        advise(advice);
+        if (preload) {
+            touchPages();
+        }
     }
     isClone = false;
 }
@@ -47,22 +83,97 @@ MMapIndexInput::MMapIndexInput(const String& path) {
 MMapIndexInput::~MMapIndexInput() {
 }
 
+void MMapIndexInput::advise(MMapDirectory::ReadAdvice advice) {
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (_length > 0 && advice != MMapDirectory::ADVICE_NORMAL) {
+        // the mapping starts on a page boundary; the hint is only a hint, so failure is ignored
+        ::madvise((void*)data, (size_t)_length, advice == MMapDirectory::ADVICE_RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+    }
+#endif
+}
+
+void MMapIndexInput::touchPages() {
+    int64_t pageSize = 4096;
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (_length > 0) {
+        ::madvise((void*)data, (size_t)_length, MADV_WILLNEED);
+    }
+    pageSize = std::max((int64_t)sysconf(_SC_PAGESIZE), (int64_t)512);
+#endif
+    volatile uint8_t sum = 0;
+    for (int64_t offset = 0; offset < _length; offset += pageSize) {
+        sum += data[offset];
+    }
+}
+
 uint8_t MMapIndexInput::readByte() {
-    try {
-        return file.data()[bufferPosition++];
-    } catch (...) {
+    if (bufferPosition >= _length) {
         boost::throw_exception(IOException(L"Read past EOF"));
-        return 0;
     }
+    return data[bufferPosition++];
+}
+
+int32_t MMapIndexInput::readInt() {
+    if (_length - bufferPosition < 4) {
+        return IndexInput::readInt();
+    }
+    const uint8_t* bytes = data + bufferPosition;
+    bufferPosition += 4;
+    return ((int32_t)bytes[0] << 24) | ((int32_t)bytes[1] << 16) | ((int32_t)bytes[2] << 8) | (int32_t)bytes[3];
+}
+
+int32_t MMapIndexInput::readVInt() {
+    if (_length - bufferPosition < 5) {
+        return IndexInput::readVInt(); // near the end of the file, check every byte
+    }
+    const uint8_t* bytes = data + bufferPosition;
+    uint8_t b = *bytes++;
+    int32_t i = (b & 0x7f);
+    for (int32_t shift = 7; (b & 0x80) != 0 && shift < 35; shift += 7) {
+        b = *bytes++;
+        i |= (b & 0x7f) << shift;
+    }
+    bufferPosition = bytes - data;
+    return i;
+}
+
+void MMapIndexInput::readVInts(int32_t* values, int32_t count) {
+    while (count > 0) {
+        // decode offsets are 32-bit, so take the file a window at a time
+        int32_t end = (int32_t)std::min(_length - bufferPosition, (int64_t)INT_MAX);
+        int32_t offset = 0;
+        int32_t decoded = end > 0 ? VIntUtils::decode(data + bufferPosition, offset, end, values, count) : 0;
+        bufferPosition += offset;
+        values += decoded;
+        count -= decoded;
+        if (decoded == 0 && count > 0) {
+            *values++ = readVInt(); // throws past EOF
+            --count;
+        }
+    }
+}
+
+int64_t MMapIndexInput::readVLong() {
+    if (_length - bufferPosition < 10) {
+        return IndexInput::readVLong();
+    }
+    const uint8_t* bytes = data + bufferPosition;
+    uint8_t b = *bytes++;
+    int64_t i = (b & 0x7f);
+    for (int32_t shift = 7; (b & 0x80) != 0 && shift < 70; shift += 7) {
+        b = *bytes++;
+        i |= (int64_t)(b & 0x7f) << shift;
+    }
+    bufferPosition = bytes - data;
+    return i;
 }
 
 void MMapIndexInput::readBytes(uint8_t* b, int32_t offset, int32_t length) {
-    try {
-        MiscUtils::arrayCopy(file.data(), bufferPosition, b, offset, length);
-        bufferPosition += length;
-    } catch (...) {
+    if (length > _length - bufferPosition) {
         boost::throw_exception(IOException(L"Read past EOF"));
     }
+    std::memcpy(b + offset, data + bufferPosition, length);
+    bufferPosition += length;
 }
 
 int64_t MMapIndexInput::getFilePointer() {
@@ -70,11 +181,11 @@ int64_t MMapIndexInput::getFilePointer() {
 }
 
 void MMapIndexInput::seek(int64_t pos) {
-    bufferPosition = (int32_t)pos;
+    bufferPosition = pos;
 }
 
 int64_t MMapIndexInput::length() {
-    return (int64_t)_length;
+    return _length;
 }
 
 void MMapIndexInput::close() {
@@ -83,6 +194,7 @@ void MMapIndexInput::close() {
     }
     _length = 0;
     bufferPosition = 0;
+    data = NULL;
     file.close();
 }
 
@@ -94,6 +206,7 @@ LuceneObjectPtr MMapIndexInput::clone(const LuceneObjectPtr& other) {
     MMapIndexInputPtr cloneIndexInput(std::dynamic_pointer_cast<MMapIndexInput>(clone));
     cloneIndexInput->_length = _length;
     cloneIndexInput->file = file;
+    cloneIndexInput->data = data;
     cloneIndexInput->bufferPosition = bufferPosition;
     cloneIndexInput->isClone = true;
     return cloneIndexInput;
@@ -15,11 +15,16 @@
 
 namespace Lucene {
 
+const int32_t RAMDirectory::DEFAULT_PAGE_SIZE = 1 << 20;
+const int32_t RAMDirectory::MAX_FREE_PAGES = 4;
+
 RAMDirectory::RAMDirectory() {
     this->fileMap = MapStringRAMFile::newInstance();
     this->_sizeInBytes = 0;
     this->copyDirectory = false;
     this->closeDir = false;
+    this->pageSize = DEFAULT_PAGE_SIZE;
+    this->freePages = Collection<ByteArray>::newInstance();
     setLockFactory(newLucene<SingleInstanceLockFactory>());
 }
 
@@ -29,6 +34,8 @@ RAMDirectory::RAMDirectory(const DirectoryPtr& dir) {
     this->copyDirectory = true;
     this->_dirSource = dir;
     this->closeDir = false;
+    this->pageSize = DEFAULT_PAGE_SIZE;
+    this->freePages = Collection<ByteArray>::newInstance();
     setLockFactory(newLucene<SingleInstanceLockFactory>());
 }
 
@@ -38,6 +45,8 @@ RAMDirectory::RAMDirectory(const DirectoryPtr& dir, bool closeDir) {
     this->copyDirectory = true;
     this->_dirSource = dir;
     this->closeDir = closeDir;
+    this->pageSize = DEFAULT_PAGE_SIZE;
+    this->freePages = Collection<ByteArray>::newInstance();
     setLockFactory(newLucene<SingleInstanceLockFactory>());
 }
 
@@ -110,6 +119,40 @@ int64_t RAMDirectory::sizeInBytes() {
     return _sizeInBytes;
 }
 
+void RAMDirectory::setPageSize(int32_t pageSize) {
+    if (pageSize <= 0) {
+        boost::throw_exception(IllegalArgumentException(L"pageSize must be greater than 0"));
+    }
+    SyncLock syncLock(this);
+    this->pageSize = pageSize;
+    freePages.clear();
+}
+
+int32_t RAMDirectory::getPageSize() {
+    SyncLock syncLock(this);
+    return pageSize;
+}
+
+ByteArray RAMDirectory::newPage(int32_t size) {
+    {
+        SyncLock syncLock(this);
+        if (size == pageSize && !freePages.empty()) {
+            ByteArray page(freePages.removeLast());
+            return page;
+        }
+    }
+    return ByteArray::newInstance(size);
+}
+
+void RAMDirectory::recyclePages(Collection<ByteArray> pages) {
+    SyncLock syncLock(this);
+    for (Collection<ByteArray>::iterator page = pages.begin(); page != pages.end() && freePages.size() < MAX_FREE_PAGES; ++page) {
+        if (page->size() == pageSize) {
+            freePages.add(*page);
+        }
+    }
+}
+
 void RAMDirectory::deleteFile(const String& name) {
     SyncLock syncLock(this);
     ensureOpen();
@@ -118,6 +161,7 @@ void RAMDirectory::deleteFile(const String& name) {
         boost::throw_exception(FileNotFoundException(name));
     }
     _sizeInBytes -= ramFile->second->getSizeInBytes();
+    ramFile->second->_directory.reset();
     fileMap.remove(name);
 }
 
@@ -153,6 +197,7 @@ IndexInputPtr RAMDirectory::openInput(const String& name) {
 void RAMDirectory::close() {
     isOpen = false;
     fileMap.reset();
+    freePages.clear();
 }
 
 }
@@ -7,12 +7,14 @@
 #include "LuceneInc.h"
 #include "RAMFile.h"
 #include "RAMDirectory.h"
+#include "RAMOutputStream.h"
 #include "MiscUtils.h"
 
 namespace Lucene {
 
 RAMFile::RAMFile() {
     this->buffers = Collection<ByteArray>::newInstance();
+    this->bufferSize = RAMOutputStream::BUFFER_SIZE;
     this->length = 0;
     this->sizeInBytes = 0;
     this->lastModified = MiscUtils::currentTimeMillis();
@@ -20,6 +22,7 @@ RAMFile::RAMFile() {
 
 RAMFile::RAMFile(const RAMDirectoryPtr& directory) {
     this->buffers = Collection<ByteArray>::newInstance();
+    this->bufferSize = directory ? directory->getPageSize() : RAMOutputStream::BUFFER_SIZE;
     this->length = 0;
     this->sizeInBytes = 0;
     this->_directory = directory;
@@ -65,6 +68,26 @@ ByteArray RAMFile::addBuffer(int32_t size) {
     return buffer;
 }
 
+ByteArray RAMFile::growBuffer(int32_t size) {
+    ByteArray buffer(newBuffer(size));
+    int64_t sizeChange = 0;
+    {
+        SyncLock syncLock(this);
+        ByteArray current(buffers[0]);
+        MiscUtils::arrayCopy(current.get(), 0, buffer.get(), 0, current.size());
+        buffers[0] = buffer;
+        sizeChange = size - current.size();
+        sizeInBytes += sizeChange;
+    }
+
+    RAMDirectoryPtr directory(_directory.lock());
+    if (directory) {
+        SyncLock dirLock(directory);
+        directory->_sizeInBytes += sizeChange;
+    }
+    return buffer;
+}
+
 ByteArray RAMFile::getBuffer(int32_t index) {
     SyncLock syncLock(this);
     return buffers[index];
@@ -75,8 +98,44 @@ int32_t RAMFile::numBuffers() {
     return buffers.size();
 }
 
+int32_t RAMFile::getBufferSize() {
+    SyncLock syncLock(this);
+    return bufferSize;
+}
+
+void RAMFile::seal() {
+    RAMDirectoryPtr directory(_directory.lock());
+    if (!directory) {
+        return;
+    }
+    ByteArray page;
+    int64_t sizeChange = 0;
+    {
+        SyncLock syncLock(this);
+        if (bufferSize <= RAMOutputStream::BUFFER_SIZE || buffers.empty()) {
+            return;
+        }
+        int32_t last = buffers.size() - 1;
+        int64_t tail = length - (int64_t)bufferSize * last;
+        if (tail <= 0 || tail >= buffers[last].size()) {
+            return; // already sealed
+        }
+        page = buffers[last];
+        ByteArray trimmed(ByteArray::newInstance((int32_t)tail));
+        MiscUtils::arrayCopy(page.get(), 0, trimmed.get(), 0, (int32_t)tail);
+        buffers[last] = trimmed;
+        sizeChange = tail - page.size();
+        sizeInBytes += sizeChange;
+    }
+
+    SyncLock dirLock(directory);
+    directory->_sizeInBytes += sizeChange;
+    directory->recyclePages(newCollection<ByteArray>(page));
+}
+
 ByteArray RAMFile::newBuffer(int32_t size) {
-    return ByteArray::newInstance(size);
+    RAMDirectoryPtr directory(_directory.lock());
+    return directory ? directory->newPage(size) : ByteArray::newInstance(size);
 }
 
 int64_t RAMFile::getSizeInBytes() {
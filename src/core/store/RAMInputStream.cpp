@@ -9,6 +9,7 @@
 #include "RAMFile.h"
 #include "RAMOutputStream.h"
 #include "MiscUtils.h"
+#include "VIntUtils.h"
 #include "StringUtils.h"
 
 namespace Lucene {
@@ -16,6 +17,7 @@ namespace Lucene {
 const int32_t RAMInputStream::BUFFER_SIZE = RAMOutputStream::BUFFER_SIZE;
 
 RAMInputStream::RAMInputStream() {
+    bufferSize = BUFFER_SIZE;
     _length = 0;
 
     // make sure that we switch to the first needed buffer lazily
@@ -27,8 +29,9 @@ RAMInputStream::RAMInputStream() {
 
 RAMInputStream::RAMInputStream(const RAMFilePtr& f) {
     file = f;
+    bufferSize = file->getBufferSize();
     _length = file->length;
-    if (_length / BUFFER_SIZE >= INT_MAX) {
+    if (_length / bufferSize >= INT_MAX) {
         boost::throw_exception(IOException(L"Too large RAMFile: " + StringUtils::toString(_length)));
     }
 
@@ -58,6 +61,21 @@ uint8_t RAMInputStream::readByte() {
     return currentBuffer[bufferPosition++];
 }
 
+void RAMInputStream::readVInts(int32_t* values, int32_t count) {
+    while (count > 0) {
+        if (bufferPosition < bufferLength) {
+            int32_t decoded = VIntUtils::decode(currentBuffer.get(), bufferPosition, bufferLength, values, count);
+            values += decoded;
+            count -= decoded;
+        }
+        if (count > 0) {
+            // next value straddles the end of the buffer
+            *values++ = readVInt();
+            --count;
+        }
+    }
+}
+
 void RAMInputStream::readBytes(uint8_t* b, int32_t offset, int32_t length) {
     while (length > 0) {
         if (bufferPosition >= bufferLength) {
@@ -82,14 +100,14 @@ void RAMInputStream::switchCurrentBuffer(bool enforceEOF) {
         } else {
             // force eof if a read takes place at this position
             --currentBufferIndex;
-            bufferPosition = BUFFER_SIZE;
+            bufferPosition = bufferSize;
         }
     } else {
         currentBuffer = file->getBuffer(currentBufferIndex);
         bufferPosition = 0;
-        bufferStart = (int64_t)BUFFER_SIZE * (int64_t)currentBufferIndex;
+        bufferStart = (int64_t)bufferSize * (int64_t)currentBufferIndex;
         int64_t buflen = _length - bufferStart;
-        bufferLength = buflen > BUFFER_SIZE ? BUFFER_SIZE : (int32_t)buflen;
+        bufferLength = buflen > bufferSize ? bufferSize : (int32_t)buflen;
     }
 }
 
@@ -98,17 +116,18 @@ int64_t RAMInputStream::getFilePointer() {
 }
 
 void RAMInputStream::seek(int64_t pos) {
-    if (!currentBuffer || (int32_t)pos < bufferStart || (int32_t)pos >= bufferStart + BUFFER_SIZE) {
-        currentBufferIndex = (int32_t)(pos / BUFFER_SIZE);
+    if (!currentBuffer || pos < bufferStart || pos >= bufferStart + bufferSize) {
+        currentBufferIndex = (int32_t)(pos / bufferSize);
         switchCurrentBuffer(false);
     }
-    bufferPosition = (int32_t)(pos % BUFFER_SIZE);
+    bufferPosition = (int32_t)(pos % bufferSize);
 }
 
 LuceneObjectPtr RAMInputStream::clone(const LuceneObjectPtr& other) {
     LuceneObjectPtr clone = IndexInput::clone(other ? other : newLucene<RAMInputStream>());
     RAMInputStreamPtr cloneInputStream(std::dynamic_pointer_cast<RAMInputStream>(clone));
     cloneInputStream->file = file;
+    cloneInputStream->bufferSize = bufferSize;
     cloneInputStream->_length = _length;
     cloneInputStream->currentBuffer = currentBuffer;
     cloneInputStream->currentBufferIndex = currentBufferIndex;
@@ -16,6 +16,7 @@ const int32_t RAMOutputStream::BUFFER_SIZE = 1024;
 
 RAMOutputStream::RAMOutputStream() {
     file = newLucene<RAMFile>(RAMDirectoryPtr());
+    bufferSize = file->getBufferSize();
 
     // make sure that we switch to the first needed buffer lazily
     currentBufferIndex = -1;
@@ -26,6 +27,7 @@ RAMOutputStream::RAMOutputStream() {
 
 RAMOutputStream::RAMOutputStream(const RAMFilePtr& f) {
     file = f;
+    bufferSize = file->getBufferSize();
 
     // make sure that we switch to the first needed buffer lazily
     currentBufferIndex = -1;
@@ -42,8 +44,9 @@ void RAMOutputStream::writeTo(const IndexOutputPtr& out) {
     int64_t end = file->length;
     int64_t pos = 0;
     int32_t buffer = 0;
+    int32_t bufferSize = file->getBufferSize();
     while (pos < end) {
-        int32_t length = BUFFER_SIZE;
+        int32_t length = bufferSize;
         int64_t nextPos = pos + length;
         if (nextPos > end) { // at the last buffer
             length = (int32_t)(end - pos);
@@ -53,6 +56,23 @@ void RAMOutputStream::writeTo(const IndexOutputPtr& out) {
     }
 }
 
+void RAMOutputStream::writeTo(uint8_t* bytes, int32_t offset) {
+    flush();
+    int64_t end = file->length;
+    int64_t pos = 0;
+    int32_t buffer = 0;
+    int32_t bufferSize = file->getBufferSize();
+    while (pos < end) {
+        int32_t length = bufferSize;
+        int64_t nextPos = pos + length;
+        if (nextPos > end) { // at the last buffer
+            length = (int32_t)(end - pos);
+        }
+        MiscUtils::arrayCopy(file->getBuffer(buffer++).get(), 0, bytes, offset + (int32_t)pos, length);
+        pos = nextPos;
+    }
+}
+
 void RAMOutputStream::reset() {
     currentBuffer.reset();
     currentBufferIndex = -1;
@@ -64,16 +84,18 @@ void RAMOutputStream::reset() {
 
 void RAMOutputStream::close() {
     flush();
+    currentBuffer.reset();
+    file->seal();
 }
 
 void RAMOutputStream::seek(int64_t pos) {
     // set the file length in case we seek back and flush() has not been called yet
     setFileLength();
     if ((int64_t)pos < bufferStart || (int64_t)pos >= bufferStart + bufferLength) {
-        currentBufferIndex = (int32_t)(pos / BUFFER_SIZE);
+        currentBufferIndex = (int32_t)(pos / bufferSize);
         switchCurrentBuffer();
     }
-    bufferPosition = (int32_t)(pos % BUFFER_SIZE);
+    bufferPosition = (int32_t)(pos % bufferSize);
 }
 
 int64_t RAMOutputStream::length() {
@@ -81,9 +103,8 @@ int64_t RAMOutputStream::length() {
 }
 
 void RAMOutputStream::writeByte(uint8_t b) {
-    if (bufferPosition == bufferLength) {
-        ++currentBufferIndex;
-        switchCurrentBuffer();
+    while (bufferPosition >= bufferLength) {
+        nextBuffer();
     }
     currentBuffer[bufferPosition++] = b;
 }
@@ -91,9 +112,8 @@ void RAMOutputStream::writeByte(uint8_t b) {
 void RAMOutputStream::writeBytes(const uint8_t* b, int32_t offset, int32_t length) {
     while (length > 0) {
         BOOST_ASSERT(b != NULL);
-        if (bufferPosition == bufferLength) {
-            ++currentBufferIndex;
-            switchCurrentBuffer();
+        while (bufferPosition >= bufferLength) {
+            nextBuffer();
         }
 
         int32_t remainInBuffer = currentBuffer.size() - bufferPosition;
@@ -105,14 +125,25 @@ void RAMOutputStream::writeBytes(const uint8_t* b, int32_t offset, int32_t lengt
     }
 }
 
+void RAMOutputStream::nextBuffer() {
+    if (currentBufferIndex == 0 && bufferLength < bufferSize) {
+        currentBuffer = file->growBuffer(std::min(bufferLength * 2, bufferSize));
+        bufferLength = currentBuffer.size();
+    } else {
+        ++currentBufferIndex;
+        switchCurrentBuffer();
+    }
+}
+
 void RAMOutputStream::switchCurrentBuffer() {
     if (currentBufferIndex == file->numBuffers()) {
-        currentBuffer = file->addBuffer(BUFFER_SIZE);
+        // the first buffer starts small and grows to a whole page, so small files never take one
+        currentBuffer = file->addBuffer(currentBufferIndex == 0 ? std::min(bufferSize, BUFFER_SIZE) : bufferSize);
     } else {
         currentBuffer = file->getBuffer(currentBufferIndex);
     }
     bufferPosition = 0;
-    bufferStart = (int64_t)BUFFER_SIZE * (int64_t)currentBufferIndex;
+    bufferStart = (int64_t)bufferSize * (int64_t)currentBufferIndex;
     bufferLength = currentBuffer.size();
 }
 
@@ -133,7 +164,7 @@ int64_t RAMOutputStream::getFilePointer() {
 }
 
 int64_t RAMOutputStream::sizeInBytes() {
-    return file->numBuffers() * BUFFER_SIZE;
+    return file->getSizeInBytes();
 }
 
 }
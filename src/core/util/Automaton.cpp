@@ -0,0 +1,335 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include <map>
+#include "Automaton.h"
+
+namespace Lucene {
+
+const int32_t Automaton::MAX_CHAR = 0x10ffff;
+const int32_t Automaton::DEFAULT_MAX_STATES = 10000;
+
+/// Non-deterministic automaton with epsilon transitions, the input of subset construction.
+struct Automaton::NFA {
+    struct Transition {
+        Transition(int32_t min, int32_t max, int32_t target) : min(min), max(max), target(target) {
+        }
+        int32_t min;
+        int32_t max;
+        int32_t target;
+    };
+
+    std::vector< std::vector<Transition> > transitions;
+    std::vector< std::vector<int32_t> > epsilons;
+    std::vector<uint8_t> accept;
+
+    int32_t addState() {
+        transitions.push_back(std::vector<Transition>());
+        epsilons.push_back(std::vector<int32_t>());
+        accept.push_back(0);
+        return (int32_t)accept.size() - 1;
+    }
+
+    void addTransition(int32_t from, int32_t min, int32_t max, int32_t to) {
+        transitions[from].push_back(Transition(min, max, to));
+    }
+
+    void addEpsilon(int32_t from, int32_t to) {
+        epsilons[from].push_back(to);
+    }
+
+    /// Expands a set of states with the states reachable through epsilon transitions; sorts the set.
+    void closure(std::vector<int32_t>& states) const {
+        for (int32_t i = 0; i < (int32_t)states.size(); ++i) {
+            const std::vector<int32_t>& targets = epsilons[states[i]];
+            for (std::vector<int32_t>::const_iterator target = targets.begin(); target != targets.end(); ++target) {
+                if (std::find(states.begin(), states.end(), *target) == states.end()) {
+                    states.push_back(*target);
+                }
+            }
+        }
+        std::sort(states.begin(), states.end());
+    }
+};
+
+Automaton::Automaton() {
+}
+
+Automaton::~Automaton() {
+}
+
+AutomatonPtr Automaton::makeWildcard(const String& pattern, int32_t maxStates) {
+    NFA nfa;
+    int32_t state = nfa.addState();
+    for (String::const_iterator c = pattern.begin(); c != pattern.end(); ++c) {
+        if (*c == L'*') {
+            nfa.addTransition(state, 0, MAX_CHAR, state);
+            continue;
+        }
+        int32_t next = nfa.addState();
+        if (*c == L'?') {
+            nfa.addTransition(state, 0, MAX_CHAR, next);
+        } else {
+            nfa.addTransition(state, (int32_t)*c, (int32_t)*c, next);
+        }
+        state = next;
+    }
+    nfa.accept[state] = 1;
+    return determinize(nfa, maxStates);
+}
+
+AutomatonPtr Automaton::makeLevenshtein(const String& prefix, const String& text, int32_t maxEdits, int32_t maxStates) {
+    NFA nfa;
+    int32_t state = nfa.addState();
+    for (String::const_iterator c = prefix.begin(); c != prefix.end(); ++c) {
+        int32_t next = nfa.addState();
+        nfa.addTransition(state, (int32_t)*c, (int32_t)*c, next);
+        state = next;
+    }
+
+    // state (i, e): i characters of text consumed with e edits
+    int32_t length = (int32_t)text.length();
+    int32_t base = (int32_t)nfa.accept.size();
+    for (int32_t i = 0; i <= length; ++i) {
+        for (int32_t e = 0; e <= maxEdits; ++e) {
+            nfa.addState();
+        }
+    }
+    nfa.addEpsilon(state, base);
+    for (int32_t i = 0; i <= length; ++i) {
+        for (int32_t e = 0; e <= maxEdits; ++e) {
+            int32_t current = base + i * (maxEdits + 1) + e;
+            if (i < length) {
+                nfa.addTransition(current, (int32_t)text[i], (int32_t)text[i], current + maxEdits + 1);
+            }
+            if (e < maxEdits) {
+                nfa.addTransition(current, 0, MAX_CHAR, current + 1); // insertion
+                if (i < length) {
+                    nfa.addTransition(current, 0, MAX_CHAR, current + maxEdits + 2); // substitution
+                    nfa.addEpsilon(current, current + maxEdits + 2); // deletion
+                }
+            }
+            if (i == length) {
+                nfa.accept[current] = 1;
+            }
+        }
+    }
+    return determinize(nfa, maxStates);
+}
+
+AutomatonPtr Automaton::determinize(const NFA& nfa, int32_t maxStates) {
+    // split the alphabet into intervals that every transition either covers or misses
+    std::vector<int32_t> points;
+    points.push_back(0);
+    for (int32_t s = 0; s < (int32_t)nfa.transitions.size(); ++s) {
+        for (std::vector<NFA::Transition>::const_iterator t = nfa.transitions[s].begin(); t != nfa.transitions[s].end(); ++t) {
+            points.push_back(t->min);
+            if (t->max < MAX_CHAR) {
+                points.push_back(t->max + 1);
+            }
+        }
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    int32_t numIntervals = (int32_t)points.size();
+
+    AutomatonPtr automaton(newLucene<Automaton>());
+    std::map<std::vector<int32_t>, int32_t> ids;
+    std::vector< std::vector<int32_t> > sets;
+    std::vector<int32_t> start(1, 0);
+    nfa.closure(start);
+    ids[start] = 0;
+    sets.push_back(start);
+
+    std::vector< std::vector<int32_t> > targets(numIntervals);
+    for (int32_t current = 0; current < (int32_t)sets.size(); ++current) {
+        std::vector<int32_t> set(sets[current]);
+        bool accepting = false;
+        for (std::vector<int32_t>::iterator s = set.begin(); s != set.end(); ++s) {
+            accepting = accepting || nfa.accept[*s];
+            for (std::vector<NFA::Transition>::const_iterator t = nfa.transitions[*s].begin(); t != nfa.transitions[*s].end(); ++t) {
+                int32_t first = (int32_t)(std::lower_bound(points.begin(), points.end(), t->min) - points.begin());
+                for (int32_t interval = first; interval < numIntervals && points[interval] <= t->max; ++interval) {
+                    targets[interval].push_back(t->target);
+                }
+            }
+        }
+
+        automaton->stateTransitions.push_back((int32_t)automaton->transitionTarget.size());
+        automaton->accept.push_back(accepting ? 1 : 0);
+        for (int32_t interval = 0; interval < numIntervals; ++interval) {
+            std::vector<int32_t>& target = targets[interval];
+            if (target.empty()) {
+                continue;
+            }
+            nfa.closure(target);
+            target.erase(std::unique(target.begin(), target.end()), target.end());
+            std::map<std::vector<int32_t>, int32_t>::iterator id = ids.find(target);
+            int32_t targetState;
+            if (id == ids.end()) {
+                if ((int32_t)sets.size() >= maxStates) {
+                    return AutomatonPtr();
+                }
+                targetState = (int32_t)sets.size();
+                ids[target] = targetState;
+                sets.push_back(target);
+            } else {
+                targetState = id->second;
+            }
+            int32_t max = interval + 1 < numIntervals ? points[interval + 1] - 1 : MAX_CHAR;
+            int32_t last = (int32_t)automaton->transitionTarget.size() - 1;
+            if (last >= automaton->stateTransitions.back() && automaton->transitionTarget[last] == targetState && automaton->transitionMax[last] + 1 == points[interval]) {
+                automaton->transitionMax[last] = max; // extend the previous range
+            } else {
+                automaton->transitionMin.push_back(points[interval]);
+                automaton->transitionMax.push_back(max);
+                automaton->transitionTarget.push_back(targetState);
+            }
+            target.clear();
+        }
+    }
+    automaton->stateTransitions.push_back((int32_t)automaton->transitionTarget.size());
+    automaton->removeDeadTransitions();
+    return automaton;
+}
+
+void Automaton::removeDeadTransitions() {
+    int32_t numStates = getNumStates();
+    std::vector<uint8_t> live(accept);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int32_t s = numStates - 1; s >= 0; --s) {
+            if (live[s]) {
+                continue;
+            }
+            for (int32_t t = stateTransitions[s]; t < stateTransitions[s + 1]; ++t) {
+                if (live[transitionTarget[t]]) {
+                    live[s] = 1;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    int32_t kept = 0;
+    for (int32_t s = 0; s < numStates; ++s) {
+        int32_t first = stateTransitions[s];
+        stateTransitions[s] = kept;
+        for (int32_t t = first; t < stateTransitions[s + 1]; ++t) {
+            if (live[s] && live[transitionTarget[t]]) {
+                transitionMin[kept] = transitionMin[t];
+                transitionMax[kept] = transitionMax[t];
+                transitionTarget[kept] = transitionTarget[t];
+                ++kept;
+            }
+        }
+    }
+    stateTransitions[numStates] = kept;
+    transitionMin.resize(kept);
+    transitionMax.resize(kept);
+    transitionTarget.resize(kept);
+}
+
+int32_t Automaton::getNumStates() {
+    return (int32_t)accept.size();
+}
+
+int32_t Automaton::step(int32_t state, int32_t c) {
+    int32_t t = ceilTransition(state, c);
+    return (t != -1 && transitionMin[t] <= c) ? transitionTarget[t] : -1;
+}
+
+bool Automaton::isAccept(int32_t state) {
+    return accept[state] != 0;
+}
+
+bool Automaton::run(const String& text) {
+    int32_t state = 0;
+    for (String::const_iterator c = text.begin(); c != text.end() && state != -1; ++c) {
+        state = step(state, (int32_t)*c);
+    }
+    return state != -1 && accept[state];
+}
+
+int32_t Automaton::ceilTransition(int32_t state, int32_t c) {
+    // transitions are sorted and disjoint, find the first one ending at or after c
+    std::vector<int32_t>::iterator start = transitionMax.begin() + stateTransitions[state];
+    std::vector<int32_t>::iterator end = transitionMax.begin() + stateTransitions[state + 1];
+    std::vector<int32_t>::iterator t = std::lower_bound(start, end, c);
+    return t == end ? -1 : (int32_t)(t - transitionMax.begin());
+}
+
+void Automaton::appendMinimal(int32_t state, String& next) {
+    std::vector<uint8_t> visited(getNumStates(), 0);
+    // stop at a cycle: the characters appended so far are then only a lower bound
+    while (!accept[state] && !visited[state] && stateTransitions[state] < stateTransitions[state + 1]) {
+        visited[state] = 1;
+        int32_t t = stateTransitions[state];
+        next += (wchar_t)transitionMin[t];
+        state = transitionTarget[t];
+    }
+}
+
+String Automaton::getInitialString() {
+    String initial;
+    if (getNumStates() > 0) {
+        appendMinimal(0, initial);
+    }
+    return initial;
+}
+
+bool Automaton::nextString(const String& text, String& next) {
+    if (getNumStates() == 0) {
+        return false;
+    }
+    int32_t length = (int32_t)text.length();
+    std::vector<int32_t> path;
+    path.reserve(length + 1);
+    int32_t state = 0;
+    path.push_back(state);
+    for (int32_t i = 0; i < length; ++i) {
+        state = step(state, (int32_t)text[i]);
+        if (state == -1) {
+            break;
+        }
+        path.push_back(state);
+    }
+
+    int32_t consumed = (int32_t)path.size() - 1;
+    if (consumed == length) {
+        // the text is a live prefix: the next candidates extend it
+        state = path[consumed];
+        if (stateTransitions[state] < stateTransitions[state + 1]) {
+            int32_t t = stateTransitions[state];
+            next.assign(text);
+            next += (wchar_t)transitionMin[t];
+            appendMinimal(transitionTarget[t], next);
+            return true;
+        }
+        --consumed;
+    }
+
+    // replace the character at position i by the smallest greater one allowed, backing off to shorter prefixes
+    for (int32_t i = consumed; i >= 0; --i) {
+        int32_t c = (int32_t)text[i];
+        if (c >= MAX_CHAR) {
+            continue;
+        }
+        int32_t t = ceilTransition(path[i], c + 1);
+        if (t != -1) {
+            next.assign(text, 0, i);
+            next += (wchar_t)std::max(c + 1, transitionMin[t]);
+            appendMinimal(transitionTarget[t], next);
+            return true;
+        }
+    }
+    return false;
+}
+
+}
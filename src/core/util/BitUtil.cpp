@@ -8,8 +8,171 @@
 #include "BitUtil.h"
 #include "MiscUtils.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LPP_BITUTIL_DISPATCH
+#include <immintrin.h>
+#endif
+
 namespace Lucene {
 
+namespace {
+
+/// Word combiners shared by the popcount and bulk update kernels, in scalar and AVX2 flavours.
+struct WordFirst {
+    static inline int64_t apply(int64_t a, int64_t b) {
+        return a;
+    }
+#ifdef LPP_BITUTIL_DISPATCH
+    __attribute__((target("avx2"))) static inline __m256i apply(__m256i a, __m256i b) {
+        return a;
+    }
+#endif
+};
+
+struct WordAnd {
+    static inline int64_t apply(int64_t a, int64_t b) {
+        return a & b;
+    }
+#ifdef LPP_BITUTIL_DISPATCH
+    __attribute__((target("avx2"))) static inline __m256i apply(__m256i a, __m256i b) {
+        return _mm256_and_si256(a, b);
+    }
+#endif
+};
+
+struct WordOr {
+    static inline int64_t apply(int64_t a, int64_t b) {
+        return a | b;
+    }
+#ifdef LPP_BITUTIL_DISPATCH
+    __attribute__((target("avx2"))) static inline __m256i apply(__m256i a, __m256i b) {
+        return _mm256_or_si256(a, b);
+    }
+#endif
+};
+
+struct WordAndNot {
+    static inline int64_t apply(int64_t a, int64_t b) {
+        return a & ~b;
+    }
+#ifdef LPP_BITUTIL_DISPATCH
+    __attribute__((target("avx2"))) static inline __m256i apply(__m256i a, __m256i b) {
+        return _mm256_andnot_si256(b, a);
+    }
+#endif
+};
+
+struct WordXor {
+    static inline int64_t apply(int64_t a, int64_t b) {
+        return a ^ b;
+    }
+#ifdef LPP_BITUTIL_DISPATCH
+    __attribute__((target("avx2"))) static inline __m256i apply(__m256i a, __m256i b) {
+        return _mm256_xor_si256(a, b);
+    }
+#endif
+};
+
+#ifdef LPP_BITUTIL_DISPATCH
+
+/// CPU features probed once at startup.  Anything running before the probe sees them all off and takes
+/// the portable path, which gives the same answers.
+struct BitUtilFeatures {
+    BitUtilFeatures() {
+        __builtin_cpu_init();
+        popcnt = __builtin_cpu_supports("popcnt");
+        avx2 = popcnt && __builtin_cpu_supports("avx2");
+    }
+
+    bool popcnt;
+    bool avx2;
+};
+
+BitUtilFeatures cpuFeatures;
+
+__attribute__((target("popcnt"))) static int32_t popHardware(int64_t x) {
+    return __builtin_popcountll((uint64_t)x);
+}
+
+template <class OP>
+__attribute__((target("popcnt"))) static int64_t popHardware(const int64_t* A, const int64_t* B, int32_t i, int32_t n) {
+    int64_t tot = 0;
+    for (; i < n; ++i) {
+        tot += __builtin_popcountll((uint64_t)OP::apply(A[i], B[i]));
+    }
+    return tot;
+}
+
+/// Counts the bits of each 64 bit lane by looking nibbles up with a byte shuffle, then summing the bytes.
+__attribute__((target("avx2"))) static inline __m256i popLanes(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowMask));
+    __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+template <class OP>
+__attribute__((target("avx2,popcnt"))) static int64_t popAVX2(const int64_t* A, const int64_t* B, int32_t i, int32_t n) {
+    __m256i sums = _mm256_setzero_si256();
+    for (; i <= n - 4; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(A + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(B + i));
+        sums = _mm256_add_epi64(sums, popLanes(OP::apply(a, b)));
+    }
+    int64_t tot = _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+                  _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3);
+    for (; i < n; ++i) {
+        tot += __builtin_popcountll((uint64_t)OP::apply(A[i], B[i]));
+    }
+    return tot;
+}
+
+/// Returns true and sets tot when a hardware kernel counted the words.
+template <class OP>
+static inline bool popDispatch(const int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords, int64_t& tot) {
+    if (cpuFeatures.avx2) {
+        tot = popAVX2<OP>(A, B, wordOffset, wordOffset + numWords);
+        return true;
+    }
+    if (cpuFeatures.popcnt) {
+        tot = popHardware<OP>(A, B, wordOffset, wordOffset + numWords);
+        return true;
+    }
+    return false;
+}
+
+template <class OP>
+__attribute__((target("avx2"))) static void applyAVX2(int64_t* A, const int64_t* B, int32_t i, int32_t n) {
+    for (; i <= n - 4; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(A + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(B + i));
+        _mm256_storeu_si256((__m256i*)(A + i), OP::apply(a, b));
+    }
+    for (; i < n; ++i) {
+        A[i] = OP::apply(A[i], B[i]);
+    }
+}
+
+#endif
+
+template <class OP>
+static void applyWords(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+    int32_t n = wordOffset + numWords;
+#ifdef LPP_BITUTIL_DISPATCH
+    if (cpuFeatures.avx2) {
+        applyAVX2<OP>(A, B, wordOffset, n);
+        return;
+    }
+#endif
+    for (int32_t i = wordOffset; i < n; ++i) {
+        A[i] = OP::apply(A[i], B[i]);
+    }
+}
+
+}
+
 const uint8_t BitUtil::ntzTable[] = {
     8, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
     5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
@@ -25,6 +188,11 @@ BitUtil::~BitUtil() {
 }
 
 int32_t BitUtil::pop(int64_t x) {
+#ifdef LPP_BITUTIL_DISPATCH
+    if (cpuFeatures.popcnt) {
+        return popHardware(x);
+    }
+#endif
     x = x - (MiscUtils::unsignedShift(x, (int64_t)1) & 0x5555555555555555LL);
     x = (x & 0x3333333333333333LL) + (MiscUtils::unsignedShift(x, (int64_t)2) & 0x3333333333333333LL);
     x = (x + MiscUtils::unsignedShift(x, (int64_t)4)) & 0x0f0f0f0f0f0f0f0fLL;
@@ -35,6 +203,13 @@ int32_t BitUtil::pop(int64_t x) {
 }
 
 int64_t BitUtil::pop_array(const int64_t* A, int32_t wordOffset, int32_t numWords) {
+#ifdef LPP_BITUTIL_DISPATCH
+    int64_t counted;
+    if (popDispatch<WordFirst>(A, A, wordOffset, numWords, counted)) {
+        return counted;
+    }
+#endif
+
     int32_t n = wordOffset + numWords;
     int64_t tot = 0;
     int64_t tot8 = 0;
@@ -110,6 +285,13 @@ int64_t BitUtil::pop_array(const int64_t* A, int32_t wordOffset, int32_t numWord
 }
 
 int64_t BitUtil::pop_intersect(const int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+#ifdef LPP_BITUTIL_DISPATCH
+    int64_t counted;
+    if (popDispatch<WordAnd>(A, B, wordOffset, numWords, counted)) {
+        return counted;
+    }
+#endif
+
     int32_t n = wordOffset + numWords;
     int64_t tot = 0;
     int64_t tot8 = 0;
@@ -182,6 +364,13 @@ int64_t BitUtil::pop_intersect(const int64_t* A, const int64_t* B, int32_t wordO
 }
 
 int64_t BitUtil::pop_union(const int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+#ifdef LPP_BITUTIL_DISPATCH
+    int64_t counted;
+    if (popDispatch<WordOr>(A, B, wordOffset, numWords, counted)) {
+        return counted;
+    }
+#endif
+
     int32_t n = wordOffset + numWords;
     int64_t tot = 0;
     int64_t tot8 = 0;
@@ -254,6 +443,13 @@ int64_t BitUtil::pop_union(const int64_t* A, const int64_t* B, int32_t wordOffse
 }
 
 int64_t BitUtil::pop_andnot(const int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+#ifdef LPP_BITUTIL_DISPATCH
+    int64_t counted;
+    if (popDispatch<WordAndNot>(A, B, wordOffset, numWords, counted)) {
+        return counted;
+    }
+#endif
+
     int32_t n = wordOffset + numWords;
     int64_t tot = 0;
     int64_t tot8 = 0;
@@ -326,6 +522,13 @@ int64_t BitUtil::pop_andnot(const int64_t* A, const int64_t* B, int32_t wordOffs
 }
 
 int64_t BitUtil::pop_xor(const int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+#ifdef LPP_BITUTIL_DISPATCH
+    int64_t counted;
+    if (popDispatch<WordXor>(A, B, wordOffset, numWords, counted)) {
+        return counted;
+    }
+#endif
+
     int32_t n = wordOffset + numWords;
     int64_t tot = 0;
     int64_t tot8 = 0;
@@ -397,6 +600,39 @@ int64_t BitUtil::pop_xor(const int64_t* A, const int64_t* B, int32_t wordOffset,
     return tot;
 }
 
+int64_t BitUtil::pop_bytes(const uint8_t* A, int32_t numBytes) {
+    // copy whole words out in chunks so the word kernels never load through a misaligned pointer
+    int64_t words[64];
+    int64_t tot = 0;
+    int32_t i = 0;
+    while (numBytes - i >= 8) {
+        int32_t numWords = std::min((numBytes - i) >> 3, 64);
+        std::memcpy(words, A + i, numWords << 3);
+        tot += pop_array(words, 0, numWords);
+        i += numWords << 3;
+    }
+    for (; i < numBytes; ++i) {
+        tot += pop((int64_t)A[i]);
+    }
+    return tot;
+}
+
+void BitUtil::and_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+    applyWords<WordAnd>(A, B, wordOffset, numWords);
+}
+
+void BitUtil::or_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+    applyWords<WordOr>(A, B, wordOffset, numWords);
+}
+
+void BitUtil::andnot_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+    applyWords<WordAndNot>(A, B, wordOffset, numWords);
+}
+
+void BitUtil::xor_array(int64_t* A, const int64_t* B, int32_t wordOffset, int32_t numWords) {
+    applyWords<WordXor>(A, B, wordOffset, numWords);
+}
+
 void BitUtil::CSA(int64_t& h, int64_t& l, int64_t a, int64_t b, int64_t c) {
     int64_t u = a ^ b;
     h = (a & b) | (u & c);
@@ -404,6 +640,11 @@ void BitUtil::CSA(int64_t& h, int64_t& l, int64_t a, int64_t b, int64_t c) {
 }
 
 int32_t BitUtil::ntz(int64_t val) {
+#ifdef __GNUC__
+    // compiles to tzcnt (or bsf on CPUs that predate it), which is a single instruction
+    return val == 0 ? 64 : __builtin_ctzll((uint64_t)val);
+#else
+
     // A full binary search to determine the low byte was slower than a linear search for nextSetBit().
     // This is most likely because the implementation of nextSetBit() shifts bits to the right, increasing
     // the probability that the first non-zero byte is in the rhs.
@@ -449,9 +690,14 @@ int32_t BitUtil::ntz(int64_t val) {
         // no need to check for zero on the last byte either.
         return ntzTable[MiscUtils::unsignedShift(upper, 24)] + 56;
     }
+#endif
 }
 
 int32_t BitUtil::ntz(int32_t val) {
+#ifdef __GNUC__
+    return val == 0 ? 32 : __builtin_ctz((uint32_t)val);
+#else
+
     // This implementation does a single binary search at the top level only.  In addition, the case
     // of a non-zero first byte is checked for first because it is the most common in dense bit arrays.
 
@@ -470,6 +716,7 @@ int32_t BitUtil::ntz(int32_t val) {
     // no need to mask off low byte for the last byte.
     // no need to check for zero on the last byte either.
     return ntzTable[MiscUtils::unsignedShift(val, 24)] + 24;
+#endif
 }
 
 int32_t BitUtil::ntz2(int64_t x) {
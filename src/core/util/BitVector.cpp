@@ -10,6 +10,7 @@
 #include "IndexInput.h"
 #include "IndexOutput.h"
 #include "TestPoint.h"
+#include "BitUtil.h"
 #include "MiscUtils.h"
 
 namespace Lucene {
@@ -112,23 +113,13 @@ int32_t BitVector::size() {
 int32_t BitVector::count() {
     // if the vector has been modified
     if (_count == -1) {
-        int32_t c = 0;
-        int32_t end = bits.size();
-        for (int32_t i = 0; i < end; ++i) {
-            c += BYTE_COUNTS[bits[i] & 0xff];    // sum bits per byte
-        }
-        _count = c;
+        _count = (int32_t)BitUtil::pop_bytes(bits.get(), bits.size());
     }
     return _count;
 }
 
 int32_t BitVector::getRecomputedCount() {
-    int32_t c = 0;
-    int32_t end = bits.size();
-    for (int32_t i = 0; i < end; ++i) {
-        c += BYTE_COUNTS[bits[i] & 0xff];    // sum bits per byte
-    }
-    return c;
+    return (int32_t)BitUtil::pop_bytes(bits.get(), bits.size());
 }
 
 void BitVector::write(const DirectoryPtr& d, const String& name) {
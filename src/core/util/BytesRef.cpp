@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "BytesRef.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+BytesRef::BytesRef() {
+    bytes = ByteArray::newInstance(1);
+    offset = 0;
+    length = 0;
+}
+
+BytesRef::BytesRef(const String& text) {
+    bytes = ByteArray::newInstance(std::max((int32_t)text.length() * StringUtils::MAX_ENCODING_UTF8_SIZE, 1));
+    offset = 0;
+    length = 0;
+    copyChars(text.c_str(), (int32_t)text.length());
+}
+
+BytesRef::BytesRef(ByteArray bytes, int32_t offset, int32_t length) {
+    this->bytes = bytes;
+    this->offset = offset;
+    this->length = length;
+}
+
+BytesRef::~BytesRef() {
+}
+
+void BytesRef::copyChars(const wchar_t* text, int32_t length) {
+    int32_t maxLength = length * StringUtils::MAX_ENCODING_UTF8_SIZE;
+    if (offset != 0 || bytes.size() < maxLength) {
+        bytes = ByteArray::newInstance(std::max(maxLength, 1));
+    }
+    offset = 0;
+    this->length = StringUtils::toUTF8(text, length, bytes);
+}
+
+void BytesRef::copyBytes(const uint8_t* bytes, int32_t offset, int32_t length) {
+    if (this->offset != 0 || this->bytes.size() < length) {
+        this->bytes = ByteArray::newInstance(std::max(length, 1));
+    }
+    MiscUtils::arrayCopy(bytes, offset, this->bytes.get(), 0, length);
+    this->offset = 0;
+    this->length = length;
+}
+
+String BytesRef::utf8ToString() {
+    return length == 0 ? L"" : StringUtils::toUnicode(bytes.get() + offset, length);
+}
+
+int32_t BytesRef::compareBytes(const uint8_t* bytes1, int32_t length1, const uint8_t* bytes2, int32_t length2) {
+    int32_t end = std::min(length1, length2);
+    int32_t cmp = end == 0 ? 0 : std::memcmp(bytes1, bytes2, end);
+    return cmp != 0 ? cmp : length1 - length2;
+}
+
+int32_t BytesRef::compareTo(const LuceneObjectPtr& other) {
+    BytesRefPtr otherBytes(std::static_pointer_cast<BytesRef>(other));
+    return compareBytes(bytes.get() + offset, length, otherBytes->bytes.get() + otherBytes->offset, otherBytes->length);
+}
+
+bool BytesRef::equals(const LuceneObjectPtr& other) {
+    if (LuceneObject::equals(other)) {
+        return true;
+    }
+    BytesRefPtr otherBytes(std::dynamic_pointer_cast<BytesRef>(other));
+    if (!otherBytes) {
+        return false;
+    }
+    return (length == otherBytes->length && compareTo(otherBytes) == 0);
+}
+
+int32_t BytesRef::hashCode() {
+    int32_t hash = 0;
+    for (int32_t i = offset; i < offset + length; ++i) {
+        hash = 31 * hash + bytes[i];
+    }
+    return hash;
+}
+
+LuceneObjectPtr BytesRef::clone(const LuceneObjectPtr& other) {
+    LuceneObjectPtr clone = other ? other : newLucene<BytesRef>();
+    BytesRefPtr cloneBytes(std::dynamic_pointer_cast<BytesRef>(LuceneObject::clone(clone)));
+    cloneBytes->copyBytes(bytes.get(), offset, length);
+    return cloneBytes;
+}
+
+String BytesRef::toString() {
+    return utf8ToString();
+}
+
+}
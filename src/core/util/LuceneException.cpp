@@ -89,6 +89,8 @@ void LuceneException::throwException() {
         boost::throw_exception(TooManyClausesException(error, type));
     case LuceneException::UnsupportedOperation:
         boost::throw_exception(UnsupportedOperationException(error, type));
+    case LuceneException::CollectionTerminated:
+        boost::throw_exception(CollectionTerminatedException(error, type));
     case LuceneException::Null:
         // silence static analyzer
         break;
@@ -424,11 +424,7 @@ void OpenBitSet::intersect(const OpenBitSetPtr& other) {
     int32_t newLen= std::min(this->wlen, other->wlen);
     LongArray thisArr = this->bits;
     LongArray otherArr = other->bits;
-    // testing against zero can be more efficient
-    int32_t pos = newLen;
-    while (--pos >= 0) {
-        thisArr[pos] &= otherArr[pos];
-    }
+    BitUtil::and_array(thisArr.get(), otherArr.get(), 0, newLen);
     if (this->wlen > newLen) {
         // fill zeros from the new shorter length to the old length
         MiscUtils::arrayFill(bits.get(), newLen, this->wlen, 0LL);
@@ -442,10 +438,7 @@ void OpenBitSet::_union(const OpenBitSetPtr& other) {
 
     LongArray thisArr = this->bits;
     LongArray otherArr = other->bits;
-    int32_t pos = std::min(wlen, other->wlen);
-    while (--pos >= 0) {
-        thisArr[pos] |= otherArr[pos];
-    }
+    BitUtil::or_array(thisArr.get(), otherArr.get(), 0, std::min(wlen, other->wlen));
     if (this->wlen < newLen) {
         MiscUtils::arrayCopy(otherArr.get(), this->wlen, thisArr.get(), this->wlen, newLen - this->wlen);
     }
@@ -453,12 +446,9 @@ void OpenBitSet::_union(const OpenBitSetPtr& other) {
 }
 
 void OpenBitSet::remove(const OpenBitSetPtr& other) {
-    int32_t idx = std::min(wlen, other->wlen);
     LongArray thisArr = this->bits;
     LongArray otherArr = other->bits;
-    while (--idx >= 0) {
-        thisArr[idx] &= ~otherArr[idx];
-    }
+    BitUtil::andnot_array(thisArr.get(), otherArr.get(), 0, std::min(wlen, other->wlen));
 }
 
 void OpenBitSet::_xor(const OpenBitSetPtr& other) {
@@ -467,10 +457,7 @@ void OpenBitSet::_xor(const OpenBitSetPtr& other) {
 
     LongArray thisArr = this->bits;
     LongArray otherArr = other->bits;
-    int32_t pos = std::min(wlen, other->wlen);
-    while (--pos >= 0) {
-        thisArr[pos] ^= otherArr[pos];
-    }
+    BitUtil::xor_array(thisArr.get(), otherArr.get(), 0, std::min(wlen, other->wlen));
     if (this->wlen < newLen) {
         MiscUtils::arrayCopy(otherArr.get(), this->wlen, thisArr.get(), this->wlen, newLen - this->wlen);
     }
@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PForUtils.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+const int32_t PForUtils::BLOCK_SIZE = 128;
+
+/// Reads eight bytes as a little-endian word; the packed data is always followed by enough scratch space.
+static inline uint64_t readWord(const uint8_t* bytes) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+/// Unpacks values of a fixed bit width.  Eight values always span exactly BITS bytes, so each group of eight
+/// unrolls into loads and shifts by constants.
+template <int32_t BITS>
+static void unpack(const uint8_t* packed, int32_t* values, int32_t count) {
+    const uint64_t mask = ((uint64_t)1 << BITS) - 1;
+    int32_t i = 0;
+    for (; i + 8 <= count; i += 8, packed += BITS) {
+        for (int32_t j = 0; j < 8; ++j) {
+            values[i + j] = (int32_t)((readWord(packed + ((j * BITS) >> 3)) >> ((j * BITS) & 7)) & mask);
+        }
+    }
+    for (int32_t j = 0; i < count; ++i, ++j) {
+        values[i] = (int32_t)((readWord(packed + ((j * BITS) >> 3)) >> ((j * BITS) & 7)) & mask);
+    }
+}
+
+typedef void (*UnpackFunc)(const uint8_t* packed, int32_t* values, int32_t count);
+
+static const UnpackFunc unpackers[] = {
+    unpack<0>, unpack<1>, unpack<2>, unpack<3>, unpack<4>, unpack<5>,
+    unpack<6>, unpack<7>, unpack<8>, unpack<9>, unpack<10>, unpack<11>,
+    unpack<12>, unpack<13>, unpack<14>, unpack<15>, unpack<16>, unpack<17>,
+    unpack<18>, unpack<19>, unpack<20>, unpack<21>, unpack<22>, unpack<23>,
+    unpack<24>, unpack<25>, unpack<26>, unpack<27>, unpack<28>, unpack<29>,
+    unpack<30>, unpack<31>, unpack<32>
+};
+
+static inline int32_t bitLength(uint32_t value) {
+    int32_t length = 0;
+    while (value != 0) {
+        ++length;
+        value >>= 1;
+    }
+    return length;
+}
+
+static inline int32_t packedLength(int32_t bits, int32_t count) {
+    return (int32_t)(((int64_t)bits * count + 7) >> 3);
+}
+
+PForUtils::~PForUtils() {
+}
+
+int32_t PForUtils::scratchSize(int32_t count) {
+    return packedLength(32, count) + 8;
+}
+
+int32_t PForUtils::bitWidth(const int32_t* values, int32_t count) {
+    int32_t lengths[33] = {0};
+    for (int32_t i = 0; i < count; ++i) {
+        ++lengths[bitLength((uint32_t)values[i])];
+    }
+    int32_t bestBits = 32;
+    int64_t bestSize = packedLength(32, count);
+    for (int32_t bits = 0; bits < 32; ++bits) {
+        int64_t size = packedLength(bits, count);
+        for (int32_t length = bits + 1; length <= 32 && size < bestSize; ++length) {
+            // index byte plus the high bits as a VInt
+            size += (int64_t)lengths[length] * (1 + (length - bits + 6) / 7);
+        }
+        if (size < bestSize) {
+            bestSize = size;
+            bestBits = bits;
+        }
+    }
+    return bestBits;
+}
+
+void PForUtils::encode(const int32_t* values, int32_t count, const IndexOutputPtr& out, uint8_t* scratch) {
+    BOOST_ASSERT(count < 256);
+    int32_t bits = bitWidth(values, count);
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
+    int32_t exceptions = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        if ((uint64_t)(uint32_t)values[i] > mask) {
+            ++exceptions;
+        }
+    }
+    out->writeByte((uint8_t)bits);
+    out->writeByte((uint8_t)exceptions);
+
+    int32_t length = packedLength(bits, count);
+    std::memset(scratch, 0, length);
+    for (int32_t i = 0; i < count; ++i) {
+        int64_t bit = (int64_t)i * bits;
+        uint64_t value = ((uint64_t)(uint32_t)values[i] & mask) << (bit & 7);
+        for (uint8_t* byte = scratch + (bit >> 3); value != 0; ++byte, value >>= 8) {
+            *byte |= (uint8_t)value;
+        }
+    }
+    out->writeBytes(scratch, length);
+
+    for (int32_t i = 0; i < count && exceptions > 0; ++i) {
+        if ((uint64_t)(uint32_t)values[i] > mask) {
+            out->writeByte((uint8_t)i);
+            out->writeVInt((int32_t)((uint32_t)values[i] >> bits));
+            --exceptions;
+        }
+    }
+}
+
+void PForUtils::decode(const IndexInputPtr& in, int32_t* values, int32_t count, uint8_t* scratch) {
+    int32_t bits = in->readByte();
+    int32_t exceptions = in->readByte();
+    if (bits > 32) {
+        boost::throw_exception(CorruptIndexException(L"invalid packed block bit width: " + StringUtils::toString(bits)));
+    }
+    in->readBytes(scratch, 0, packedLength(bits, count));
+    unpackers[bits](scratch, values, count);
+    for (int32_t i = 0; i < exceptions; ++i) {
+        int32_t index = in->readByte();
+        if (index >= count) {
+            boost::throw_exception(CorruptIndexException(L"invalid packed block exception index: " + StringUtils::toString(index)));
+        }
+        values[index] |= (int32_t)((uint32_t)in->readVInt() << bits);
+    }
+}
+
+}
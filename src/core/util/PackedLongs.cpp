@@ -0,0 +1,102 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "PackedLongs.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
+
+namespace Lucene {
+
+PackedLongs::PackedLongs(const IndexInputPtr& input, int32_t count) {
+    this->count = count;
+    minValue = input->readLong();
+    bitsPerValue = input->readByte();
+    if (bitsPerValue < 0 || bitsPerValue > 64) {
+        boost::throw_exception(CorruptIndexException(L"invalid packed bits per value"));
+    }
+    int32_t numBlocks = (int32_t)(((int64_t)count * bitsPerValue + 63) >> 6);
+    blocks = LongArray::newInstance(numBlocks);
+    for (int32_t i = 0; i < numBlocks; ++i) {
+        blocks[i] = input->readLong();
+    }
+}
+
+PackedLongs::~PackedLongs() {
+}
+
+int32_t PackedLongs::bitsRequired(uint64_t maxValue) {
+    int32_t bits = 0;
+    while (maxValue != 0) {
+        ++bits;
+        maxValue >>= 1;
+    }
+    return bits;
+}
+
+void PackedLongs::write(const IndexOutputPtr& output, const int64_t* values, int32_t count) {
+    int64_t minValue = 0;
+    uint64_t maxDelta = 0;
+    if (count > 0) {
+        minValue = *std::min_element(values, values + count);
+        for (int32_t i = 0; i < count; ++i) {
+            maxDelta = std::max(maxDelta, (uint64_t)values[i] - (uint64_t)minValue);
+        }
+    }
+    int32_t bitsPerValue = bitsRequired(maxDelta);
+    output->writeLong(minValue);
+    output->writeByte((uint8_t)bitsPerValue);
+    if (bitsPerValue == 0) {
+        return;
+    }
+    uint64_t block = 0;
+    int32_t used = 0; // bits of block already filled
+    for (int32_t i = 0; i < count; ++i) {
+        uint64_t delta = (uint64_t)values[i] - (uint64_t)minValue;
+        block |= delta << used;
+        used += bitsPerValue;
+        if (used >= 64) {
+            output->writeLong((int64_t)block);
+            used -= 64;
+            // the bits of delta that did not fit in the block just written
+            block = used == 0 ? 0 : delta >> (bitsPerValue - used);
+        }
+    }
+    if (used > 0) {
+        output->writeLong((int64_t)block);
+    }
+}
+
+int64_t PackedLongs::get(int32_t index) {
+    if (bitsPerValue == 0) {
+        return minValue;
+    }
+    uint64_t bitPos = (uint64_t)index * bitsPerValue;
+    int32_t block = (int32_t)(bitPos >> 6);
+    int32_t shift = (int32_t)(bitPos & 63);
+    uint64_t value = (uint64_t)blocks[block] >> shift;
+    if (shift + bitsPerValue > 64) {
+        value |= (uint64_t)blocks[block + 1] << (64 - shift);
+    }
+    if (bitsPerValue < 64) {
+        value &= ((uint64_t)1 << bitsPerValue) - 1;
+    }
+    return (int64_t)((uint64_t)minValue + value);
+}
+
+int32_t PackedLongs::size() {
+    return count;
+}
+
+int32_t PackedLongs::getBitsPerValue() {
+    return bitsPerValue;
+}
+
+int64_t PackedLongs::sizeInBytes() {
+    return (int64_t)blocks.size() * sizeof(int64_t);
+}
+
+}
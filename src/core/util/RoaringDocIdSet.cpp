@@ -0,0 +1,427 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "RoaringDocIdSet.h"
+#include "_RoaringDocIdSet.h"
+#include "BitUtil.h"
+#include "MiscUtils.h"
+#include "StringUtils.h"
+
+namespace Lucene {
+
+const int32_t RoaringDocIdSet::BLOCK_SHIFT = 16;
+const int32_t RoaringDocIdSet::MAX_ARRAY_LENGTH = 4096;
+
+const int32_t RoaringContainer::BITMAP_WORDS = 1024;
+
+RoaringDocIdSet::RoaringDocIdSet(const DocIdSetIteratorPtr& iterator, int32_t maxDoc) {
+    RoaringDocIdSetBuilderPtr builder(newLucene<RoaringDocIdSetBuilder>(maxDoc));
+    int32_t doc;
+    while ((doc = iterator->nextDoc()) < maxDoc) {
+        builder->add(doc);
+    }
+    RoaringDocIdSetPtr set(builder->build());
+    this->containers = set->containers;
+    this->maxDoc = maxDoc;
+    this->cardinality = set->cardinality;
+}
+
+RoaringDocIdSet::RoaringDocIdSet(Collection<RoaringContainerPtr> containers, int32_t maxDoc) {
+    this->containers = containers;
+    this->maxDoc = maxDoc;
+    this->cardinality = 0;
+    for (Collection<RoaringContainerPtr>::iterator container = containers.begin(); container != containers.end(); ++container) {
+        if (*container) {
+            cardinality += (*container)->cardinality;
+        }
+    }
+}
+
+RoaringDocIdSet::~RoaringDocIdSet() {
+}
+
+int32_t RoaringDocIdSet::size() {
+    return cardinality;
+}
+
+bool RoaringDocIdSet::get(int32_t doc) {
+    if (doc < 0 || doc >= maxDoc) {
+        return false;
+    }
+    RoaringContainerPtr container(containers[doc >> BLOCK_SHIFT]);
+    return container && container->get(doc & 0xffff);
+}
+
+int64_t RoaringDocIdSet::sizeInBytes() {
+    int64_t bytes = (int64_t)containers.size() * sizeof(RoaringContainerPtr);
+    for (Collection<RoaringContainerPtr>::iterator container = containers.begin(); container != containers.end(); ++container) {
+        if (*container) {
+            bytes += (*container)->sizeInBytes();
+        }
+    }
+    return bytes;
+}
+
+RoaringDocIdSetPtr RoaringDocIdSet::intersect(const RoaringDocIdSetPtr& other) {
+    int32_t numBlocks = std::min(containers.size(), other->containers.size());
+    Collection<RoaringContainerPtr> result(Collection<RoaringContainerPtr>::newInstance(numBlocks));
+    for (int32_t block = 0; block < numBlocks; ++block) {
+        if (containers[block] && other->containers[block]) {
+            result[block] = RoaringContainer::intersect(containers[block], other->containers[block]);
+        }
+    }
+    return newLucene<RoaringDocIdSet>(result, std::min(maxDoc, other->maxDoc));
+}
+
+RoaringDocIdSetPtr RoaringDocIdSet::_union(const RoaringDocIdSetPtr& other) {
+    int32_t numBlocks = std::max(containers.size(), other->containers.size());
+    Collection<RoaringContainerPtr> result(Collection<RoaringContainerPtr>::newInstance(numBlocks));
+    for (int32_t block = 0; block < numBlocks; ++block) {
+        RoaringContainerPtr a(block < containers.size() ? containers[block] : RoaringContainerPtr());
+        RoaringContainerPtr b(block < other->containers.size() ? other->containers[block] : RoaringContainerPtr());
+        if (a && b) {
+            result[block] = RoaringContainer::_union(a, b);
+        } else {
+            result[block] = a ? a : b;
+        }
+    }
+    return newLucene<RoaringDocIdSet>(result, std::max(maxDoc, other->maxDoc));
+}
+
+bool RoaringDocIdSet::isCacheable() {
+    return true;
+}
+
+DocIdSetIteratorPtr RoaringDocIdSet::iterator() {
+    return newLucene<RoaringDocIdSetIterator>(shared_from_this());
+}
+
+RoaringDocIdSetBuilder::RoaringDocIdSetBuilder(int32_t maxDoc) {
+    this->maxDoc = maxDoc;
+    this->containers = Collection<RoaringContainerPtr>::newInstance((maxDoc + 0xffff) >> RoaringDocIdSet::BLOCK_SHIFT);
+    this->buffer = Array<uint16_t>::newInstance(std::min(maxDoc, 0x10000));
+    this->bufferSize = 0;
+    this->currentBlock = -1;
+    this->lastDoc = -1;
+}
+
+RoaringDocIdSetBuilder::~RoaringDocIdSetBuilder() {
+}
+
+void RoaringDocIdSetBuilder::add(int32_t doc) {
+    if (doc == lastDoc) {
+        return;
+    }
+    if (doc < lastDoc) {
+        boost::throw_exception(IllegalArgumentException(L"Docs must be added in order: " + StringUtils::toString(doc) + L" < " + StringUtils::toString(lastDoc)));
+    }
+    if (doc >= maxDoc) {
+        boost::throw_exception(IllegalArgumentException(L"Doc " + StringUtils::toString(doc) + L" is not less than maxDoc " + StringUtils::toString(maxDoc)));
+    }
+    int32_t block = doc >> RoaringDocIdSet::BLOCK_SHIFT;
+    if (block != currentBlock) {
+        flushBlock();
+        currentBlock = block;
+    }
+    buffer[bufferSize++] = (uint16_t)(doc & 0xffff);
+    lastDoc = doc;
+}
+
+RoaringDocIdSetPtr RoaringDocIdSetBuilder::build() {
+    flushBlock();
+    return newLucene<RoaringDocIdSet>(containers, maxDoc);
+}
+
+void RoaringDocIdSetBuilder::flushBlock() {
+    if (bufferSize > 0) {
+        containers[currentBlock] = RoaringContainer::fromSorted(buffer.get(), bufferSize);
+        bufferSize = 0;
+    }
+}
+
+RoaringContainer::RoaringContainer(ContainerType type, int32_t cardinality) {
+    this->type = type;
+    this->cardinality = cardinality;
+    this->numRuns = 0;
+}
+
+RoaringContainer::~RoaringContainer() {
+}
+
+RoaringContainerPtr RoaringContainer::fromSorted(const uint16_t* docs, int32_t count) {
+    if (count == 0) {
+        return RoaringContainerPtr();
+    }
+    int32_t numRuns = 1;
+    for (int32_t i = 1; i < count; ++i) {
+        if (docs[i] != docs[i - 1] + 1) {
+            ++numRuns;
+        }
+    }
+    RoaringContainerPtr container;
+    if (4 * numRuns < std::min(2 * count, BITMAP_WORDS * 8)) {
+        container = newLucene<RoaringContainer>(RUN, count);
+        container->numRuns = numRuns;
+        container->values = Array<uint16_t>::newInstance(2 * numRuns);
+        int32_t run = 0;
+        container->values[0] = docs[0];
+        for (int32_t i = 1; i < count; ++i) {
+            if (docs[i] != docs[i - 1] + 1) {
+                container->values[2 * run + 1] = docs[i - 1];
+                ++run;
+                container->values[2 * run] = docs[i];
+            }
+        }
+        container->values[2 * run + 1] = docs[count - 1];
+    } else if (count <= RoaringDocIdSet::MAX_ARRAY_LENGTH) {
+        container = newLucene<RoaringContainer>(ARRAY, count);
+        container->values = Array<uint16_t>::newInstance(count);
+        std::copy(docs, docs + count, container->values.get());
+    } else {
+        container = newLucene<RoaringContainer>(BITMAP, count);
+        container->bits = LongArray::newInstance(BITMAP_WORDS);
+        MiscUtils::arrayFill(container->bits.get(), 0, BITMAP_WORDS, 0);
+        for (int32_t i = 0; i < count; ++i) {
+            container->bits[docs[i] >> 6] |= (int64_t)1 << (docs[i] & 63);
+        }
+    }
+    return container;
+}
+
+RoaringContainerPtr RoaringContainer::fromBitmap(LongArray bits) {
+    int32_t count = (int32_t)BitUtil::pop_array(bits.get(), 0, BITMAP_WORDS);
+    if (count == 0) {
+        return RoaringContainerPtr();
+    }
+    // a run starts at every set bit whose preceding bit is clear
+    int32_t numRuns = 0;
+    uint64_t carry = 0;
+    for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+        uint64_t word = (uint64_t)bits[i];
+        numRuns += BitUtil::pop((int64_t)(word & ~((word << 1) | carry)));
+        carry = word >> 63;
+    }
+    if (4 * numRuns >= std::min(2 * count, BITMAP_WORDS * 8) && count > RoaringDocIdSet::MAX_ARRAY_LENGTH) {
+        RoaringContainerPtr container(newLucene<RoaringContainer>(BITMAP, count));
+        container->bits = bits;
+        return container;
+    }
+    Array<uint16_t> docs(Array<uint16_t>::newInstance(count));
+    int32_t upto = 0;
+    for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+        uint64_t word = (uint64_t)bits[i];
+        while (word != 0) {
+            docs[upto++] = (uint16_t)((i << 6) + BitUtil::ntz((int64_t)word));
+            word &= word - 1;
+        }
+    }
+    return fromSorted(docs.get(), count);
+}
+
+RoaringContainerPtr RoaringContainer::intersect(const RoaringContainerPtr& a, const RoaringContainerPtr& b) {
+    if (a->type == ARRAY || b->type == ARRAY) {
+        RoaringContainerPtr array(a->type == ARRAY ? a : b);
+        RoaringContainerPtr other(a->type == ARRAY ? b : a);
+        Array<uint16_t> docs(Array<uint16_t>::newInstance(array->cardinality));
+        int32_t count = 0;
+        if (other->type == ARRAY) {
+            for (int32_t i = 0, j = 0; i < array->cardinality && j < other->cardinality;) {
+                if (array->values[i] < other->values[j]) {
+                    ++i;
+                } else if (array->values[i] > other->values[j]) {
+                    ++j;
+                } else {
+                    docs[count++] = array->values[i];
+                    ++i;
+                    ++j;
+                }
+            }
+        } else {
+            for (int32_t i = 0; i < array->cardinality; ++i) {
+                if (other->get(array->values[i])) {
+                    docs[count++] = array->values[i];
+                }
+            }
+        }
+        return fromSorted(docs.get(), count);
+    }
+    LongArray bits(LongArray::newInstance(BITMAP_WORDS));
+    LongArray otherBits(LongArray::newInstance(BITMAP_WORDS));
+    MiscUtils::arrayFill(bits.get(), 0, BITMAP_WORDS, 0);
+    MiscUtils::arrayFill(otherBits.get(), 0, BITMAP_WORDS, 0);
+    a->toBitmap(bits.get());
+    b->toBitmap(otherBits.get());
+    for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+        bits[i] &= otherBits[i];
+    }
+    return fromBitmap(bits);
+}
+
+RoaringContainerPtr RoaringContainer::_union(const RoaringContainerPtr& a, const RoaringContainerPtr& b) {
+    if (a->type == ARRAY && b->type == ARRAY && a->cardinality + b->cardinality <= RoaringDocIdSet::MAX_ARRAY_LENGTH) {
+        Array<uint16_t> docs(Array<uint16_t>::newInstance(a->cardinality + b->cardinality));
+        int32_t count = (int32_t)(std::set_union(a->values.get(), a->values.get() + a->cardinality, b->values.get(), b->values.get() + b->cardinality, docs.get()) - docs.get());
+        return fromSorted(docs.get(), count);
+    }
+    LongArray bits(LongArray::newInstance(BITMAP_WORDS));
+    MiscUtils::arrayFill(bits.get(), 0, BITMAP_WORDS, 0);
+    a->toBitmap(bits.get());
+    b->toBitmap(bits.get());
+    return fromBitmap(bits);
+}
+
+bool RoaringContainer::get(int32_t doc) {
+    switch (type) {
+    case ARRAY:
+        return std::binary_search(values.get(), values.get() + cardinality, (uint16_t)doc);
+    case BITMAP:
+        return ((bits[doc >> 6] >> (doc & 63)) & 1) != 0;
+    default: {
+        // find the last run starting at or before doc
+        int32_t low = 0;
+        int32_t high = numRuns - 1;
+        while (low <= high) {
+            int32_t mid = (low + high) >> 1;
+            if (values[2 * mid] <= doc) {
+                low = mid + 1;
+            } else {
+                high = mid - 1;
+            }
+        }
+        return high >= 0 && doc <= values[2 * high + 1];
+    }
+    }
+}
+
+int32_t RoaringContainer::nextDoc(int32_t target, int32_t& index) {
+    switch (type) {
+    case ARRAY: {
+        if (index >= cardinality) {
+            return -1;
+        }
+        if (values[index] >= target) {
+            return values[index];
+        }
+        // gallop forward from the last position, then binary search the last step
+        int32_t bound = 1;
+        while (index + bound < cardinality && values[index + bound] < target) {
+            bound <<= 1;
+        }
+        uint16_t* start = values.get() + index + (bound >> 1) + 1;
+        uint16_t* end = values.get() + std::min(index + bound + 1, cardinality);
+        index = (int32_t)(std::lower_bound(start, end, (uint16_t)target) - values.get());
+        return index < cardinality ? values[index] : -1;
+    }
+    case BITMAP: {
+        int32_t word = target >> 6;
+        uint64_t bitsLeft = (uint64_t)bits[word] >> (target & 63);
+        if (bitsLeft != 0) {
+            return target + BitUtil::ntz((int64_t)bitsLeft);
+        }
+        while (++word < BITMAP_WORDS) {
+            if (bits[word] != 0) {
+                return (word << 6) + BitUtil::ntz(bits[word]);
+            }
+        }
+        return -1;
+    }
+    default: {
+        while (index < numRuns && values[2 * index + 1] < target) {
+            ++index;
+        }
+        return index < numRuns ? std::max(target, (int32_t)values[2 * index]) : -1;
+    }
+    }
+}
+
+void RoaringContainer::toBitmap(int64_t* bitmap) {
+    switch (type) {
+    case ARRAY:
+        for (int32_t i = 0; i < cardinality; ++i) {
+            bitmap[values[i] >> 6] |= (int64_t)1 << (values[i] & 63);
+        }
+        break;
+    case BITMAP:
+        for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+            bitmap[i] |= bits[i];
+        }
+        break;
+    default:
+        for (int32_t run = 0; run < numRuns; ++run) {
+            for (int32_t doc = values[2 * run]; doc <= values[2 * run + 1]; ++doc) {
+                bitmap[doc >> 6] |= (int64_t)1 << (doc & 63);
+            }
+        }
+        break;
+    }
+}
+
+int64_t RoaringContainer::sizeInBytes() {
+    int64_t bytes = sizeof(RoaringContainer);
+    switch (type) {
+    case ARRAY:
+        return bytes + cardinality * sizeof(uint16_t);
+    case BITMAP:
+        return bytes + BITMAP_WORDS * sizeof(int64_t);
+    default:
+        return bytes + numRuns * 2 * sizeof(uint16_t);
+    }
+}
+
+RoaringDocIdSetIterator::RoaringDocIdSetIterator(const RoaringDocIdSetPtr& set) {
+    this->containers = set->containers;
+    this->maxDoc = set->maxDoc;
+    this->block = -1;
+    this->index = 0;
+    this->doc = -1;
+}
+
+RoaringDocIdSetIterator::~RoaringDocIdSetIterator() {
+}
+
+int32_t RoaringDocIdSetIterator::docID() {
+    return doc;
+}
+
+int32_t RoaringDocIdSetIterator::nextDoc() {
+    return doc == NO_MORE_DOCS ? doc : advance(doc + 1);
+}
+
+int32_t RoaringDocIdSetIterator::advance(int32_t target) {
+    if (target >= maxDoc) {
+        doc = NO_MORE_DOCS;
+        return doc;
+    }
+    int32_t targetBlock = target >> RoaringDocIdSet::BLOCK_SHIFT;
+    if (targetBlock != block) {
+        // jump straight to the target's block, skipping those in between
+        block = targetBlock;
+        container = containers[block];
+        index = 0;
+    }
+    while (true) {
+        if (container) {
+            int32_t low = container->nextDoc(target & 0xffff, index);
+            if (low != -1) {
+                doc = (block << RoaringDocIdSet::BLOCK_SHIFT) | low;
+                return doc;
+            }
+        }
+        do {
+            ++block;
+        } while (block < containers.size() && !containers[block]);
+        if (block >= containers.size()) {
+            doc = NO_MORE_DOCS;
+            return doc;
+        }
+        container = containers[block];
+        index = 0;
+        target = block << RoaringDocIdSet::BLOCK_SHIFT;
+    }
+}
+
+}
@@ -0,0 +1,288 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "SearchArena.h"
+#include "LuceneThread.h"
+#include "cc/sync.h"
+
+namespace Lucene {
+
+/// Every allocation is preceded by a header naming the region it was carved from (null for heap requests),
+/// padded so that objects keep the alignment of malloc.
+static const size_t HEADER_SIZE = 16;
+static const size_t ALIGNMENT = 16;
+
+/// Blocks of the default size freed by regions, kept for the arenas of the next requests.
+namespace ArenaBlocks {
+
+static const int32_t MAX_FREE_BLOCKS = 64;
+
+struct Pool {
+    rt::Spin lock;
+    std::vector<uint8_t*> blocks;
+};
+
+/// Never destroyed, as objects released during static destruction may still free their blocks.
+static Pool& pool() {
+    static Pool* pool = new Pool();
+    return *pool;
+}
+
+static uint8_t* take(int32_t blockSize) {
+    if (blockSize == SearchArena::DEFAULT_BLOCK_SIZE) {
+        Pool& free = pool();
+        free.lock.Lock();
+        if (!free.blocks.empty()) {
+            uint8_t* block = free.blocks.back();
+            free.blocks.pop_back();
+            free.lock.Unlock();
+            return block;
+        }
+        free.lock.Unlock();
+    }
+    uint8_t* block = (uint8_t*)AllocMemory(blockSize);
+    if (block == NULL) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+static void give(uint8_t* block, int32_t blockSize) {
+    if (blockSize == SearchArena::DEFAULT_BLOCK_SIZE) {
+        Pool& free = pool();
+        free.lock.Lock();
+        if ((int32_t)free.blocks.size() < MAX_FREE_BLOCKS) {
+            free.blocks.push_back(block);
+            block = NULL;
+        }
+        free.lock.Unlock();
+    }
+    if (block != NULL) {
+        FreeMemory(block);
+    }
+}
+
+}
+
+/// Blocks of an arena, shared by the arena and every object still living in them.
+class SearchArena::Region {
+public:
+    Region(int32_t blockSize) : refs(1) {
+        this->blockSize = blockSize;
+        block = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    ~Region() {
+        for (std::vector<uint8_t*>::iterator b = blocks.begin(); b != blocks.end(); ++b) {
+            ArenaBlocks::give(*b, blockSize);
+        }
+    }
+
+    /// One reference for the owning arena plus one per live allocation.
+    std::atomic<int32_t> refs;
+    int32_t blockSize;
+    std::vector<uint8_t*> blocks;
+    int32_t block;
+    size_t offset;
+    int64_t used;
+
+    void release() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+};
+
+/// Arenas installed on running threads, keyed by {@link LuceneThread#currentId()}.  A thread only ever
+/// takes one of the few slots following its home slot, and only probes them if some thread with the same
+/// home slot holds one, so a thread without an arena is usually turned away by a single load.
+namespace ArenaSlots {
+
+static const int32_t SLOT_COUNT = 256;
+static const int32_t MAX_PROBES = 8;
+static const int64_t SLOT_FREE = 0;
+
+struct Slot {
+    std::atomic<int64_t> owner;
+    SearchArena* arena;
+};
+
+static Slot slots[SLOT_COUNT];
+
+/// Number of slots held by threads of each home slot.
+static std::atomic<int32_t> homeOwners[SLOT_COUNT];
+
+static int32_t homeSlot(int64_t id) {
+    uint64_t hash = (uint64_t)id * 0x9e3779b97f4a7c15ULL;
+    return (int32_t)(hash >> 56) & (SLOT_COUNT - 1);
+}
+
+/// Returns the slot owned by the given thread, or null.
+static Slot* find(int64_t id) {
+    int32_t home = homeSlot(id);
+    if (homeOwners[home].load(std::memory_order_relaxed) == 0) {
+        return NULL;
+    }
+    for (int32_t i = 0; i < MAX_PROBES; ++i) {
+        Slot& slot = slots[(home + i) & (SLOT_COUNT - 1)];
+        if (slot.owner.load(std::memory_order_relaxed) == id) {
+            return &slot;
+        }
+    }
+    return NULL;
+}
+
+/// Claims a free slot for the given thread; returns null if every slot it may take is taken.
+static Slot* claim(int64_t id) {
+    int32_t home = homeSlot(id);
+    for (int32_t i = 0; i < MAX_PROBES; ++i) {
+        Slot& slot = slots[(home + i) & (SLOT_COUNT - 1)];
+        int64_t owner = SLOT_FREE;
+        if (slot.owner.load(std::memory_order_relaxed) == SLOT_FREE && slot.owner.compare_exchange_strong(owner, id, std::memory_order_acquire)) {
+            homeOwners[home].fetch_add(1, std::memory_order_relaxed);
+            return &slot;
+        }
+    }
+    return NULL;
+}
+
+static void release(Slot* slot, int64_t id) {
+    slot->arena = NULL;
+    slot->owner.store(SLOT_FREE, std::memory_order_release);
+    homeOwners[homeSlot(id)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+}
+
+const int32_t SearchArena::DEFAULT_BLOCK_SIZE = 64 * 1024;
+std::atomic<int32_t> SearchArena::activeScopes(0);
+
+SearchArena::SearchArena(int32_t blockSize) {
+    this->blockSize = blockSize;
+    this->region = new Region(blockSize);
+}
+
+SearchArena::~SearchArena() {
+    region->release();
+}
+
+SearchArena::Scope::Scope(SearchArena& arena) {
+    int64_t id = LuceneThread::currentId();
+    ArenaSlots::Slot* slot = ArenaSlots::find(id);
+    previous = NULL;
+    claimed = (slot == NULL);
+    if (slot) {
+        previous = slot->arena;
+    } else {
+        slot = ArenaSlots::claim(id);
+    }
+    // when every slot the thread may take is taken objects simply come from the heap
+    installed = (slot != NULL);
+    if (installed) {
+        slot->arena = &arena;
+        activeScopes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SearchArena::Scope::~Scope() {
+    if (!installed) {
+        return;
+    }
+    int64_t id = LuceneThread::currentId();
+    ArenaSlots::Slot* slot = ArenaSlots::find(id);
+    if (claimed) {
+        ArenaSlots::release(slot, id);
+    } else {
+        slot->arena = previous;
+    }
+    activeScopes.fetch_sub(1, std::memory_order_relaxed);
+}
+
+SearchArena::Suspend::Suspend() {
+    suspended = NULL;
+    if (activeScopes.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    ArenaSlots::Slot* slot = ArenaSlots::find(LuceneThread::currentId());
+    if (slot) {
+        suspended = slot->arena;
+        slot->arena = NULL;
+    }
+}
+
+SearchArena::Suspend::~Suspend() {
+    if (suspended) {
+        ArenaSlots::find(LuceneThread::currentId())->arena = suspended;
+    }
+}
+
+SearchArena* SearchArena::lookupCurrent() {
+    ArenaSlots::Slot* slot = ArenaSlots::find(LuceneThread::currentId());
+    return slot ? slot->arena : NULL;
+}
+
+void* SearchArena::allocate(size_t size) {
+    size_t total = (HEADER_SIZE + size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    uint8_t* memory;
+    Region* owner = NULL;
+    if (total > (size_t)blockSize / 4) {
+        memory = (uint8_t*)AllocMemory(HEADER_SIZE + size);
+    } else {
+        if (region->blocks.empty() || region->offset + total > (size_t)blockSize) {
+            if (!region->blocks.empty()) {
+                ++region->block;
+            }
+            if (region->block == (int32_t)region->blocks.size()) {
+                region->blocks.push_back(ArenaBlocks::take(blockSize));
+            }
+            region->offset = 0;
+        }
+        memory = region->blocks[region->block] + region->offset;
+        region->offset += total;
+        region->used += total;
+        region->refs.fetch_add(1, std::memory_order_relaxed);
+        owner = region;
+    }
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<Region**>(memory) = owner;
+    return memory + HEADER_SIZE;
+}
+
+void SearchArena::deallocate(void* memory) {
+    uint8_t* header = static_cast<uint8_t*>(memory) - HEADER_SIZE;
+    Region* owner = *reinterpret_cast<Region**>(header);
+    if (owner) {
+        owner->release();
+    } else {
+        FreeMemory(header);
+    }
+}
+
+void SearchArena::reset() {
+    if (region->refs.load(std::memory_order_acquire) == 1) {
+        region->block = 0;
+        region->offset = 0;
+        region->used = 0;
+    } else {
+        region->release();
+        region = new Region(blockSize);
+    }
+}
+
+int64_t SearchArena::getBytesUsed() {
+    return region->used;
+}
+
+int32_t SearchArena::getNumBlocks() {
+    return (int32_t)region->blocks.size();
+}
+
+}
@@ -6,62 +6,226 @@
 
 #include "LuceneInc.h"
 #include "ThreadPool.h"
+#include "LuceneThread.h"
+#include "StringUtils.h"
 
 namespace Lucene {
 
+const int32_t ThreadPool::DEFAULT_POOL_SIZE = 10;
+int32_t ThreadPool::poolSize = ThreadPool::DEFAULT_POOL_SIZE;
+
+Future::Future() {
+    failed = false;
+}
+
 Future::~Future() {
 }
 
-ThreadPool::ThreadPool() {
+void Future::setCurrentException() {
+    try {
+        throw;
+    } catch (LuceneException& e) {
+        setException(e);
+    } catch (std::exception& e) {
+        setException(RuntimeException(StringUtils::toUnicode(e.what())));
+    } catch (...) {
+        setException(RuntimeException(L"Unknown exception in thread pool task"));
+    }
+}
+
+ThreadPoolTask::ThreadPoolTask() : done(false) {
+    detached = false;
+    pool = NULL;
+}
+
+ThreadPoolTask::~ThreadPoolTask() {
+}
+
+bool ThreadPoolTask::isDone() {
+    return done.load(std::memory_order_acquire);
+}
+
+void ThreadPoolTask::join() {
+    while (!isDone()) {
+        ThreadPoolTask* task = pool ? pool->nextTask(pool->currentQueue()) : NULL;
+        if (task) {
+            pool->execute(task);
+            continue;
+        }
+        if (!pool) {
+            LuceneThread::threadYield(); // not submitted yet
+            continue;
+        }
+
+        // nothing to help with, so sleep until a task finishes or more work is queued
+        pool->joinLock.Lock();
+        pool->joiners.fetch_add(1);
+        while (!done.load() && pool->pending.load() <= 0) {
+            pool->joinCV.Wait(&pool->joinLock);
+        }
+        pool->joiners.fetch_sub(1);
+        pool->joinLock.Unlock();
+    }
+    exception.throwException();
+}
+
+ThreadPool::ThreadPool(int32_t size) : pending(0), idleThreads(0), nextQueue(0), joiners(0) {
+    if (size < 1) {
+        boost::throw_exception(IllegalArgumentException(L"size must be greater than 0"));
+    }
+    this->size = size;
     running = true;
-    running_threads = THREADPOOL_SIZE;
-    for (int32_t i = 0; i < THREADPOOL_SIZE; ++i) {
-        threads[i] = rt::Thread(ThreadPool::run);
+    queues.reset(new WorkQueue[size]);
+    threads = Collection<threadPtr>::newInstance(size);
+    threadIds.reset(new std::atomic<int64_t>[size]);
+    for (int32_t i = 0; i < size; ++i) {
+        threadIds[i].store(0, std::memory_order_relaxed);
+    }
+    for (int32_t i = 0; i < size; ++i) {
+        threads[i] = newInstance<rt::Thread>(std::bind(&ThreadPool::run, this, i));
     }
 }
 
 ThreadPool::~ThreadPool() {
-    worksLock.Lock();
+    idleLock.Lock();
     running = false;
-    worksCV.SignalAll();
-    worksLock.Unlock();
+    idleCV.SignalAll();
+    idleLock.Unlock();
     // wait for all thread
-    for (int32_t i = 0; i < THREADPOOL_SIZE; ++i) {
-        threads[i].Join();
+    for (int32_t i = 0; i < size; ++i) {
+        threads[i]->Join();
     }
 }
 
 ThreadPoolPtr ThreadPool::getInstance() {
     static ThreadPoolPtr threadPool;
     if (!threadPool) {
-        threadPool = newLucene<ThreadPool>();
+        threadPool = newLucene<ThreadPool>(poolSize);
         CycleCheck::addStatic(threadPool);
     }
     return threadPool;
 }
 
-void ThreadPool::_run() {
-    while (true) {
-        worksLock.Lock();
-        while (works.empty() && running) {
-            running_threads--;
-            worksCV.Wait(&worksLock);
-	    running_threads++;
+void ThreadPool::setPoolSize(int32_t size) {
+    poolSize = size;
+}
+
+int32_t ThreadPool::getSize() {
+    return size;
+}
+
+void ThreadPool::submit(ThreadPoolTask* task) {
+    task->pool = this;
+    int32_t queue = currentQueue();
+    if (queue == -1) {
+        queue = (int32_t)(nextQueue.fetch_add(1, std::memory_order_relaxed) % (uint32_t)size);
+    }
+    queues[queue].lock.Lock();
+    queues[queue].tasks.push_back(task);
+    queues[queue].lock.Unlock();
+
+    pending.fetch_add(1);
+    if (idleThreads.load() > 0) {
+        idleLock.Lock();
+        idleCV.Signal();
+        idleLock.Unlock();
+    }
+    if (joiners.load() > 0) {
+        joinLock.Lock();
+        joinCV.SignalAll();
+        joinLock.Unlock();
+    }
+}
+
+int32_t ThreadPool::currentQueue() {
+    int64_t id = LuceneThread::currentId();
+    for (int32_t i = 0; i < size; ++i) {
+        if (threadIds[i].load(std::memory_order_relaxed) == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+ThreadPoolTask* ThreadPool::nextTask(int32_t queue) {
+    if (pending.load(std::memory_order_relaxed) <= 0) {
+        return NULL;
+    }
+    // own deque is used as a stack, other deques are stolen from in fifo order
+    if (queue != -1) {
+        WorkQueue& own = queues[queue];
+        own.lock.Lock();
+        if (!own.tasks.empty()) {
+            ThreadPoolTask* task = own.tasks.back();
+            own.tasks.pop_back();
+            own.lock.Unlock();
+            pending.fetch_sub(1);
+            return task;
+        }
+        own.lock.Unlock();
+    }
+    int32_t start = queue == -1 ? 0 : queue + 1;
+    for (int32_t i = 0; i < size; ++i) {
+        WorkQueue& victim = queues[(start + i) % size];
+        if (!victim.lock.TryLock()) {
+            continue;
         }
+        if (!victim.tasks.empty()) {
+            ThreadPoolTask* task = victim.tasks.front();
+            victim.tasks.pop_front();
+            victim.lock.Unlock();
+            pending.fetch_sub(1);
+            return task;
+        }
+        victim.lock.Unlock();
+    }
+    return NULL;
+}
 
-	if (!running) {
-            running_threads--;
-            worksLock.Unlock();
-	    return;
-	}
+void ThreadPool::execute(ThreadPoolTask* task) {
+    try {
+        task->run();
+    } catch (LuceneException& e) {
+        task->exception = e;
+    } catch (std::exception& e) {
+        task->exception = RuntimeException(StringUtils::toUnicode(e.what()));
+    } catch (...) {
+        task->exception = RuntimeException(L"Unknown exception in thread pool task");
+    }
+    if (task->detached) {
+        delete task;
+        return;
+    }
+    task->done.store(true); // task may be destroyed by its owner from here on
+    if (joiners.load() > 0) {
+        joinLock.Lock();
+        joinCV.SignalAll();
+        joinLock.Unlock();
+    }
+}
 
-	// retrieve a work
-	std::function<void()> f = works.front();
-	works.pop();
-	worksLock.Unlock();
+void ThreadPool::run(int32_t queue) {
+    threadIds[queue].store(LuceneThread::currentId(), std::memory_order_relaxed);
+    while (true) {
+        ThreadPoolTask* task = nextTask(queue);
+        if (task) {
+            execute(task);
+            continue;
+        }
+
+        idleLock.Lock();
+        idleThreads.fetch_add(1);
+        while (pending.load() <= 0 && running) {
+            idleCV.Wait(&idleLock);
+        }
+        idleThreads.fetch_sub(1);
+        bool stop = !running;
+        idleLock.Unlock();
 
-	// execute a work
-	f();
+        if (stop) {
+            return;
+        }
     }
 }
+
 }
@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "LuceneInc.h"
+#include "VIntUtils.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Lucene {
+
+VIntUtils::~VIntUtils() {
+}
+
+int32_t VIntUtils::decode(const uint8_t* bytes, int32_t& offset, int32_t end, int32_t* values, int32_t count) {
+    int32_t pos = offset;
+    int32_t decoded = 0;
+    while (decoded < count) {
+#ifdef __SSE2__
+        if (count - decoded >= 16 && end - pos >= 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(bytes + pos));
+            uint32_t continuation = (uint32_t)_mm_movemask_epi8(chunk);
+            if (continuation == 0) {
+                // sixteen single byte values, widen them straight into the output
+                __m128i zero = _mm_setzero_si128();
+                __m128i low = _mm_unpacklo_epi8(chunk, zero);
+                __m128i high = _mm_unpackhi_epi8(chunk, zero);
+                __m128i* out = (__m128i*)(values + decoded);
+                _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+                pos += 16;
+                decoded += 16;
+                continue;
+            }
+            // copy the single byte values ahead of the first multi-byte one
+            for (int32_t run = __builtin_ctz(continuation); run > 0; --run) {
+                values[decoded++] = bytes[pos++];
+            }
+        }
+#endif
+        if (pos >= end) {
+            break;
+        }
+        uint8_t b = bytes[pos];
+        if ((b & 0x80) == 0) {
+            values[decoded++] = b;
+            ++pos;
+            continue;
+        }
+        uint32_t value = (b & 0x7f);
+        int32_t next = pos + 1;
+        for (int32_t shift = 7; (b & 0x80) != 0; shift += 7) {
+            if (next >= end) {
+                offset = pos;
+                return decoded;
+            }
+            b = bytes[next++];
+            value |= (uint32_t)(b & 0x7f) << shift;
+        }
+        values[decoded++] = (int32_t)value;
+        pos = next;
+    }
+    offset = pos;
+    return decoded;
+}
+
+}
@@ -22,6 +22,11 @@
 #include "IndexFileDeleter.h"
 #include "KeepOnlyLastCommitDeletionPolicy.h"
 #include "TestPoint.h"
+#include "ThreadPool.h"
+#include "MergeRateLimiter.h"
+#include "NumericField.h"
+#include "DocValuesColumn.h"
+#include "TermFreqVector.h"
 
 using namespace Lucene;
 
@@ -346,3 +351,53 @@ TEST_F(ConcurrentMergeSchedulerTest, testSubclassConcurrentMergeScheduler) {
     dir->close();
     EXPECT_TRUE(ConcurrentMergeScheduler::anyUnhandledExceptions());
 }
+
+/// Merges that write their parts in parallel through a throttled directory must produce the same index
+/// as serial merges.
+TEST_F(ConcurrentMergeSchedulerTest, testParallelThrottledMerges) {
+    MockRAMDirectoryPtr dir = newLucene<MockRAMDirectory>();
+
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    ConcurrentMergeSchedulerPtr cms = newLucene<ConcurrentMergeScheduler>();
+    cms->setMergeExecutor(newLucene<ThreadPool>(2));
+    cms->getMergeRateLimiter()->setMBPerSec(20.0);
+    writer->setMergeScheduler(cms);
+    writer->setMaxBufferedDocs(10);
+    writer->setMergeFactor(3);
+
+    for (int32_t i = 0; i < 300; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(i), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"content", L"aaa bbb " + StringUtils::toString(i % 10), Field::STORE_NO, Field::INDEX_ANALYZED, Field::TERM_VECTOR_WITH_POSITIONS_OFFSETS));
+        NumericFieldPtr num = newLucene<NumericField>(L"num", Field::STORE_NO, false);
+        num->setIntValue(i);
+        num->setDocValuesType(Fieldable::DOC_VALUES_NUMERIC);
+        doc->add(num);
+        writer->addDocument(doc);
+        if (i % 7 == 0) {
+            writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(i / 2)));
+        }
+    }
+    writer->optimize();
+    writer->close();
+
+    EXPECT_TRUE(checkIndex(dir));
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(257, reader->numDocs());
+    EXPECT_EQ(257, reader->maxDoc());
+    EXPECT_EQ(257, reader->docFreq(newLucene<Term>(L"content", L"aaa")));
+
+    Collection<IndexReaderPtr> segments = reader->getSequentialSubReaders();
+    EXPECT_EQ(1, segments.size());
+    DocValuesColumnPtr num = segments[0]->getDocValuesColumn(L"num");
+    for (int32_t doc = 0; doc < reader->maxDoc(); ++doc) {
+        int32_t id = StringUtils::toInt(reader->document(doc)->get(L"id"));
+        EXPECT_EQ(id, num->getLong(doc));
+        TermFreqVectorPtr vector = reader->getTermFreqVector(doc, L"content");
+        EXPECT_EQ(3, vector->size());
+        EXPECT_TRUE(vector->indexOf(StringUtils::toString(id % 10)) != -1);
+    }
+    reader->close();
+    dir->close();
+}
@@ -0,0 +1,299 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "PackedLongs.h"
+#include "DocValuesColumn.h"
+#include "RAMDirectory.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "NumericField.h"
+#include "Term.h"
+#include "FieldCache.h"
+#include "IndexSearcher.h"
+#include "MatchAllDocsQuery.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "TopFieldDocs.h"
+#include "ScoreDoc.h"
+#include "Random.h"
+#include "StringUtils.h"
+#include "BytesRef.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture DocValuesTest;
+
+static const int32_t NUM_DOCS = 200;
+
+static String sortedValue(int32_t id) {
+    static const wchar_t* labels[] = {L"delta", L"alpha", L"echo", L"charlie", L"bravo"};
+    return id % 7 == 0 ? L"" : labels[id % 5];
+}
+
+static DocumentPtr createDocument(int32_t id) {
+    DocumentPtr doc(newLucene<Document>());
+    doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+
+    // stored but not indexed: FieldCache can only get these values from the doc values
+    NumericFieldPtr num(newLucene<NumericField>(L"num", Field::STORE_YES, false));
+    num->setIntValue(id * 3 - 500);
+    num->setDocValuesType(Fieldable::DOC_VALUES_NUMERIC);
+    doc->add(num);
+
+    NumericFieldPtr dbl(newLucene<NumericField>(L"dbl", Field::STORE_YES, false));
+    dbl->setDoubleValue((double)id / 4.0 - 10.0);
+    dbl->setDocValuesType(Fieldable::DOC_VALUES_DOUBLE);
+    doc->add(dbl);
+
+    FieldPtr bin(newLucene<Field>(L"bin", L"b" + StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NO));
+    bin->setDocValuesType(Fieldable::DOC_VALUES_BINARY);
+    doc->add(bin);
+
+    if (!sortedValue(id).empty()) {
+        FieldPtr sorted(newLucene<Field>(L"sorted", sortedValue(id), Field::STORE_YES, Field::INDEX_NO));
+        sorted->setDocValuesType(Fieldable::DOC_VALUES_SORTED);
+        doc->add(sorted);
+    }
+    return doc;
+}
+
+static void checkColumns(const IndexReaderPtr& reader) {
+    Collection<IndexReaderPtr> segments(reader->getSequentialSubReaders());
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        DocValuesColumnPtr num((*segment)->getDocValuesColumn(L"num"));
+        DocValuesColumnPtr dbl((*segment)->getDocValuesColumn(L"dbl"));
+        DocValuesColumnPtr bin((*segment)->getDocValuesColumn(L"bin"));
+        DocValuesColumnPtr sorted((*segment)->getDocValuesColumn(L"sorted"));
+        ASSERT_TRUE(num && dbl && bin && sorted);
+        EXPECT_FALSE((*segment)->getDocValuesColumn(L"id"));
+        EXPECT_EQ((*segment)->maxDoc(), num->size());
+        for (int32_t doc = 0; doc < (*segment)->maxDoc(); ++doc) {
+            if ((*segment)->isDeleted(doc)) {
+                continue;
+            }
+            int32_t id = StringUtils::toInt((*segment)->document(doc)->get(L"id"));
+            EXPECT_EQ(id * 3 - 500, num->getLong(doc));
+            EXPECT_EQ((double)id / 4.0 - 10.0, dbl->getDouble(doc));
+            EXPECT_EQ(L"b" + StringUtils::toString(id), bin->getString(doc));
+            EXPECT_EQ(sortedValue(id), sorted->getString(doc));
+            EXPECT_EQ(sortedValue(id), sorted->lookup(sorted->getOrd(doc)));
+            EXPECT_EQ(0, bin->compareString(doc, newLucene<BytesRef>(L"b" + StringUtils::toString(id))));
+            EXPECT_EQ(0, sorted->compareString(doc, newLucene<BytesRef>(sortedValue(id))));
+        }
+        for (int32_t ord = 2; ord <= sorted->getValueCount(); ++ord) {
+            EXPECT_TRUE(sorted->lookup(ord - 1) < sorted->lookup(ord));
+            EXPECT_TRUE(sorted->compareLookup(ord - 1, newLucene<BytesRef>(sorted->lookup(ord))) < 0);
+            EXPECT_TRUE(sorted->compareLookup(ord, newLucene<BytesRef>(sorted->lookup(ord - 1))) > 0);
+        }
+        EXPECT_TRUE(sorted->compareLookup(0, newLucene<BytesRef>(L"a")) < 0);
+    }
+}
+
+TEST_F(DocValuesTest, testPackedLongs) {
+    RandomPtr random(newLucene<Random>());
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    Collection< Collection<int64_t> > blocks(Collection< Collection<int64_t> >::newInstance());
+    blocks.add(Collection<int64_t>::newInstance());
+    blocks.add(newCollection<int64_t>(42, 42, 42));
+    blocks.add(newCollection<int64_t>(LLONG_MIN, LLONG_MAX, 0, -1));
+    for (int32_t bits = 1; bits < 64; bits += 7) {
+        Collection<int64_t> values(Collection<int64_t>::newInstance(1 + random->nextInt(100)));
+        for (int32_t i = 0; i < values.size(); ++i) {
+            values[i] = -1000 + (((int64_t)random->nextInt() << 32 | (uint32_t)random->nextInt()) & (((int64_t)1 << bits) - 1));
+        }
+        blocks.add(values);
+    }
+
+    IndexOutputPtr output(dir->createOutput(L"packed"));
+    for (Collection< Collection<int64_t> >::iterator values = blocks.begin(); values != blocks.end(); ++values) {
+        PackedLongs::write(output, values->empty() ? NULL : &(*values)[0], values->size());
+    }
+    output->close();
+
+    IndexInputPtr input(dir->openInput(L"packed"));
+    for (Collection< Collection<int64_t> >::iterator values = blocks.begin(); values != blocks.end(); ++values) {
+        PackedLongsPtr packed(newLucene<PackedLongs>(input, values->size()));
+        EXPECT_EQ(values->size(), packed->size());
+        for (int32_t i = 0; i < values->size(); ++i) {
+            EXPECT_EQ((*values)[i], packed->get(i));
+        }
+    }
+    EXPECT_EQ(input->length(), input->getFilePointer());
+    input->close();
+    EXPECT_EQ(0, PackedLongs::bitsRequired(0));
+    EXPECT_EQ(1, PackedLongs::bitsRequired(1));
+    EXPECT_EQ(64, PackedLongs::bitsRequired(ULLONG_MAX));
+}
+
+TEST_F(DocValuesTest, testFlushAndMerge) {
+    for (int32_t compound = 0; compound < 2; ++compound) {
+        RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+        IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+        writer->setUseCompoundFile(compound == 1);
+        writer->setMaxBufferedDocs(17);
+        writer->setMergeFactor(100);
+        for (int32_t id = 0; id < NUM_DOCS; ++id) {
+            writer->addDocument(createDocument(id));
+        }
+        writer->commit();
+
+        IndexReaderPtr reader(IndexReader::open(dir, true));
+        EXPECT_TRUE(reader->getSequentialSubReaders().size() > 1);
+        checkColumns(reader);
+        reader->close();
+
+        for (int32_t id = 0; id < NUM_DOCS; id += 3) {
+            writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(id)));
+        }
+        writer->optimize();
+        writer->close();
+
+        reader = IndexReader::open(dir, true);
+        EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+        EXPECT_EQ(NUM_DOCS - (NUM_DOCS + 2) / 3, reader->maxDoc());
+        checkColumns(reader);
+        reader->close();
+    }
+}
+
+TEST_F(DocValuesTest, testFieldCache) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        writer->addDocument(createDocument(id));
+    }
+    writer->optimize();
+    writer->close();
+
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    IndexReaderPtr segment(reader->getSequentialSubReaders()[0]);
+    Collection<int32_t> ints(FieldCache::DEFAULT()->getInts(segment, L"num"));
+    Collection<int64_t> longs(FieldCache::DEFAULT()->getLongs(segment, L"num"));
+    Collection<double> doubles(FieldCache::DEFAULT()->getDoubles(segment, L"dbl"));
+    Collection<String> strings(FieldCache::DEFAULT()->getStrings(segment, L"bin"));
+    StringIndexPtr index(FieldCache::DEFAULT()->getStringIndex(segment, L"sorted"));
+    EXPECT_EQ(6, index->lookup.size()); // null plus five labels
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        EXPECT_EQ(id * 3 - 500, ints[id]);
+        EXPECT_EQ(id * 3 - 500, longs[id]);
+        EXPECT_EQ((double)id / 4.0 - 10.0, doubles[id]);
+        EXPECT_EQ(L"b" + StringUtils::toString(id), strings[id]);
+        if (sortedValue(id).empty()) {
+            EXPECT_EQ(0, index->order[id]);
+        } else {
+            EXPECT_EQ(sortedValue(id), index->lookup[index->order[id]]);
+        }
+    }
+
+    // sorting uses the same values
+    IndexSearcherPtr searcher(newLucene<IndexSearcher>(reader));
+    TopFieldDocsPtr docs(searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), NUM_DOCS, newLucene<Sort>(newLucene<SortField>(L"num", SortField::INT, true))));
+    for (int32_t i = 0; i < NUM_DOCS; ++i) {
+        EXPECT_EQ(NUM_DOCS - 1 - i, docs->scoreDocs[i]->doc);
+    }
+    docs = searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), NUM_DOCS, newLucene<Sort>(newLucene<SortField>(L"sorted", SortField::STRING)));
+    for (int32_t i = 1; i < NUM_DOCS; ++i) {
+        EXPECT_TRUE(sortedValue(docs->scoreDocs[i - 1]->doc) <= sortedValue(docs->scoreDocs[i]->doc));
+    }
+    searcher->close();
+    reader->close();
+}
+
+/// Sorting reads the columns of each segment in place, without filling the field cache
+TEST_F(DocValuesTest, testSortOnColumns) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    writer->setMaxBufferedDocs(30);
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        writer->addDocument(createDocument(id));
+    }
+    writer->close();
+
+    FieldCache::DEFAULT()->purgeAllCaches();
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    Collection<IndexReaderPtr> segments(reader->getSequentialSubReaders());
+    EXPECT_TRUE(segments.size() > 1);
+
+    // a column is decoded once per segment
+    DocValuesColumnPtr column(FieldCache::DEFAULT()->getDocValues(segments[0], L"num"));
+    EXPECT_TRUE(column);
+    EXPECT_EQ(column, FieldCache::DEFAULT()->getDocValues(segments[0], L"num"));
+    EXPECT_FALSE(FieldCache::DEFAULT()->getDocValues(segments[0], L"id"));
+
+    IndexSearcherPtr searcher(newLucene<IndexSearcher>(reader));
+    TopFieldDocsPtr docs(searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), 10, newLucene<Sort>(newLucene<SortField>(L"num", SortField::INT, true))));
+    for (int32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(NUM_DOCS - 1 - i, docs->scoreDocs[i]->doc);
+    }
+    docs = searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), 10, newLucene<Sort>(newLucene<SortField>(L"num", SortField::LONG)));
+    for (int32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(i, docs->scoreDocs[i]->doc);
+    }
+    docs = searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), 10, newLucene<Sort>(newLucene<SortField>(L"dbl", SortField::DOUBLE, true)));
+    for (int32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(NUM_DOCS - 1 - i, docs->scoreDocs[i]->doc);
+    }
+    docs = searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), 20, newLucene<Sort>(newLucene<SortField>(L"bin", SortField::STRING_VAL)));
+    for (int32_t i = 1; i < 20; ++i) {
+        EXPECT_TRUE(StringUtils::toString(docs->scoreDocs[i - 1]->doc) <= StringUtils::toString(docs->scoreDocs[i]->doc));
+    }
+    for (int32_t reverse = 0; reverse < 2; ++reverse) {
+        docs = searcher->search(newLucene<MatchAllDocsQuery>(), FilterPtr(), 50, newLucene<Sort>(newLucene<SortField>(L"sorted", SortField::STRING, reverse == 1)));
+        EXPECT_EQ(50, docs->scoreDocs.size());
+        for (int32_t i = 1; i < docs->scoreDocs.size(); ++i) {
+            String previous(sortedValue(docs->scoreDocs[i - 1]->doc));
+            String current(sortedValue(docs->scoreDocs[i]->doc));
+            EXPECT_TRUE(reverse == 1 ? previous >= current : previous <= current);
+        }
+    }
+    EXPECT_EQ(0, FieldCache::DEFAULT()->getCacheEntries().size());
+    searcher->close();
+    reader->close();
+}
+
+/// Buffered doc values count towards the RAM that triggers a flush
+TEST_F(DocValuesTest, testRAMUsed) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    String value(10000, L'x');
+    for (int32_t id = 0; id < 10; ++id) {
+        DocumentPtr doc(newLucene<Document>());
+        FieldPtr bin(newLucene<Field>(L"bin", value, Field::STORE_NO, Field::INDEX_NO));
+        bin->setDocValuesType(Fieldable::DOC_VALUES_BINARY);
+        doc->add(bin);
+        writer->addDocument(doc);
+    }
+    EXPECT_TRUE(writer->ramSizeInBytes() >= (int64_t)(10 * value.length() * sizeof(wchar_t)));
+    writer->commit();
+    EXPECT_TRUE(writer->ramSizeInBytes() < (int64_t)(value.length() * sizeof(wchar_t)));
+    writer->close();
+}
+
+TEST_F(DocValuesTest, testTypeChange) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    DocumentPtr doc(newLucene<Document>());
+    FieldPtr field(newLucene<Field>(L"field", L"value", Field::STORE_YES, Field::INDEX_NO));
+    field->setDocValuesType(Fieldable::DOC_VALUES_BINARY);
+    doc->add(field);
+    writer->addDocument(doc);
+
+    field->setDocValuesType(Fieldable::DOC_VALUES_SORTED);
+    try {
+        writer->addDocument(doc);
+        FAIL() << "changing the doc values type of a field should fail";
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    writer->close();
+}
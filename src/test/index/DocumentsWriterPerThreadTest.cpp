@@ -0,0 +1,169 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "MockRAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "WhitespaceAnalyzer.h"
+#include "LuceneThread.h"
+#include "Document.h"
+#include "Field.h"
+#include "Term.h"
+#include "TermDocs.h"
+#include "SegmentInfos.h"
+#include "SegmentInfo.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture DocumentsWriterPerThreadTest;
+
+DECLARE_SHARED_PTR(PerThreadIndexerThread)
+
+static const int32_t NUM_THREADS = 4;
+static const int32_t NUM_DOCS = 150;
+
+static DocumentPtr createDocument(const String& id, int32_t version) {
+    DocumentPtr doc(newLucene<Document>());
+    doc->add(newLucene<Field>(L"id", id, Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    doc->add(newLucene<Field>(L"version", StringUtils::toString(version), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    doc->add(newLucene<Field>(L"content", L"aaa bbb ccc " + id, Field::STORE_NO, Field::INDEX_ANALYZED, Field::TERM_VECTOR_WITH_POSITIONS_OFFSETS));
+    return doc;
+}
+
+static int32_t countDocs(const IndexReaderPtr& reader, const TermPtr& term) {
+    int32_t count = 0;
+    TermDocsPtr termDocs(reader->termDocs(term));
+    while (termDocs->next()) {
+        ++count;
+    }
+    termDocs->close();
+    return count;
+}
+
+class PerThreadIndexerThread : public LuceneThread {
+public:
+    PerThreadIndexerThread(const IndexWriterPtr& writer, int32_t threadNum, bool update) {
+        this->writer = writer;
+        this->threadNum = threadNum;
+        this->update = update;
+        this->failed = false;
+    }
+
+    virtual ~PerThreadIndexerThread() {
+    }
+
+    LUCENE_CLASS(PerThreadIndexerThread);
+
+public:
+    IndexWriterPtr writer;
+    int32_t threadNum;
+    bool update;
+    bool failed;
+
+public:
+    virtual void run() {
+        try {
+            for (int32_t i = 0; i < NUM_DOCS; ++i) {
+                if (update) {
+                    // every thread updates the same ids, so most updates delete a document another thread added
+                    String id(StringUtils::toString(i % 25));
+                    writer->updateDocument(newLucene<Term>(L"id", id), createDocument(id, i));
+                } else {
+                    writer->addDocument(createDocument(StringUtils::toString(threadNum) + L"_" + StringUtils::toString(i), i));
+                }
+            }
+        } catch (LuceneException& e) {
+            failed = true;
+        }
+    }
+};
+
+static void runThreads(const IndexWriterPtr& writer, bool update) {
+    Collection<PerThreadIndexerThreadPtr> threads(Collection<PerThreadIndexerThreadPtr>::newInstance(NUM_THREADS));
+    for (int32_t i = 0; i < NUM_THREADS; ++i) {
+        threads[i] = newLucene<PerThreadIndexerThread>(writer, i, update);
+        threads[i]->start();
+    }
+    for (int32_t i = 0; i < NUM_THREADS; ++i) {
+        threads[i]->join();
+        EXPECT_FALSE(threads[i]->failed);
+    }
+}
+
+TEST_F(DocumentsWriterPerThreadTest, testConcurrentFlush) {
+    MockRAMDirectoryPtr dir(newLucene<MockRAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    writer->setMaxBufferedDocs(10);
+    writer->setMergeFactor(1000);
+    writer->setUseCompoundFile(false);
+    runThreads(writer, false);
+    writer->commit();
+
+    // segments are flushed with private doc stores, whichever thread filled them
+    SegmentInfosPtr infos(newLucene<SegmentInfos>());
+    infos->read(dir);
+    EXPECT_TRUE(infos->size() >= NUM_THREADS * NUM_DOCS / 10);
+    for (int32_t i = 0; i < infos->size(); ++i) {
+        EXPECT_EQ(-1, infos->info(i)->getDocStoreOffset());
+        EXPECT_TRUE(infos->info(i)->docCount <= 10);
+    }
+    writer->close();
+
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    EXPECT_EQ(NUM_THREADS * NUM_DOCS, reader->numDocs());
+    for (int32_t thread = 0; thread < NUM_THREADS; ++thread) {
+        for (int32_t i = 0; i < NUM_DOCS; ++i) {
+            EXPECT_EQ(1, countDocs(reader, newLucene<Term>(L"id", StringUtils::toString(thread) + L"_" + StringUtils::toString(i))));
+        }
+    }
+    reader->close();
+    dir->close();
+}
+
+TEST_F(DocumentsWriterPerThreadTest, testConcurrentUpdate) {
+    MockRAMDirectoryPtr dir(newLucene<MockRAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    writer->setMaxBufferedDocs(7);
+    writer->setMaxThreadStates(2);
+    runThreads(writer, true);
+    writer->close();
+
+    // each update deletes the older versions, whether they are in another thread's in-memory segment or flushed
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    EXPECT_EQ(25, reader->numDocs());
+    for (int32_t i = 0; i < 25; ++i) {
+        EXPECT_EQ(1, countDocs(reader, newLucene<Term>(L"id", StringUtils::toString(i))));
+    }
+    reader->close();
+    dir->close();
+}
+
+TEST_F(DocumentsWriterPerThreadTest, testMaxThreadStates) {
+    MockRAMDirectoryPtr dir(newLucene<MockRAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    EXPECT_EQ(IndexWriter::DEFAULT_MAX_THREAD_STATES, writer->getMaxThreadStates());
+    writer->setMaxThreadStates(1);
+    EXPECT_EQ(1, writer->getMaxThreadStates());
+    try {
+        writer->setMaxThreadStates(0);
+        FAIL() << "maxThreadStates must be at least 1";
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+
+    // a single in-memory segment is shared by all threads
+    writer->setMaxBufferedDocs(NUM_THREADS * NUM_DOCS + 1);
+    runThreads(writer, false);
+    EXPECT_EQ(NUM_THREADS * NUM_DOCS, writer->numRamDocs());
+    writer->commit();
+    SegmentInfosPtr infos(newLucene<SegmentInfos>());
+    infos->read(dir);
+    EXPECT_EQ(1, infos->size());
+    writer->close();
+    dir->close();
+}
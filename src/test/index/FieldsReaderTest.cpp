@@ -5,6 +5,7 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "TestInc.h"
+#include <boost/algorithm/string.hpp>
 #include "LuceneTestFixture.h"
 #include "TestUtils.h"
 #include "RAMDirectory.h"
@@ -22,6 +23,7 @@
 #include "IndexReader.h"
 #include "MiscUtils.h"
 #include "FileUtils.h"
+#include "StringUtils.h"
 
 using namespace Lucene;
 
@@ -435,3 +437,93 @@ TEST_F(FieldsReaderTest, testExceptions) {
     FileUtils::removeDirectory(indexDir);
     finally.throwException();
 }
+
+static String chunkDocText(int32_t id) {
+    StringStream text;
+    for (int32_t i = 0; i <= id % 40; ++i) {
+        text << L"stored text of document " << (id % 10) << L" ";
+    }
+    return text.str();
+}
+
+static void checkChunkDoc(const IndexReaderPtr& reader, int32_t doc, const FieldSelectorPtr& fieldSelector) {
+    DocumentPtr document(reader->document(doc, fieldSelector));
+    int32_t id = StringUtils::toInt(document->get(L"id"));
+    EXPECT_EQ(chunkDocText(id), document->getFieldable(L"text")->stringValue());
+    if (id % 3 == 0) {
+        ByteArray bytes(document->getFieldable(L"binary")->getBinaryValue());
+        ASSERT_EQ(id % 50, bytes.size());
+        for (int32_t i = 0; i < bytes.size(); ++i) {
+            EXPECT_EQ((uint8_t)(id + i), bytes[i]);
+        }
+    } else {
+        EXPECT_FALSE(document->getFieldable(L"binary"));
+    }
+}
+
+TEST_F(FieldsReaderTest, testCompressedChunks) {
+    static const int32_t NUM_DOCS = 700;
+
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    writer->setUseCompoundFile(false);
+    writer->setMaxBufferedDocs(300);
+    writer->setMergeFactor(100);
+    int64_t storedBytes = 0;
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        DocumentPtr doc(newLucene<Document>());
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"text", chunkDocText(id), Field::STORE_YES, Field::INDEX_ANALYZED));
+        if (id % 3 == 0) {
+            ByteArray bytes(ByteArray::newInstance(id % 50));
+            for (int32_t i = 0; i < bytes.size(); ++i) {
+                bytes[i] = (uint8_t)(id + i);
+            }
+            doc->add(newLucene<Field>(L"binary", bytes, Field::STORE_YES));
+        }
+        storedBytes += chunkDocText(id).length();
+        writer->addDocument(doc);
+    }
+    writer->commit();
+
+    // documents are compressed together, and each document's index entry still takes 8 bytes
+    int64_t fdtBytes = 0;
+    HashSet<String> files(dir->listAll());
+    for (HashSet<String>::iterator file = files.begin(); file != files.end(); ++file) {
+        if (boost::ends_with(*file, L".fdt")) {
+            fdtBytes += dir->fileLength(*file);
+        } else if (boost::ends_with(*file, L".fdx")) {
+            EXPECT_EQ(0, (dir->fileLength(*file) - 4) % 8);
+        }
+    }
+    EXPECT_TRUE(fdtBytes < storedBytes / 4);
+
+    HashSet<String> loadFieldNames(HashSet<String>::newInstance());
+    loadFieldNames.add(L"id");
+    HashSet<String> lazyFieldNames(HashSet<String>::newInstance());
+    lazyFieldNames.add(L"text");
+    lazyFieldNames.add(L"binary");
+    FieldSelectorPtr lazySelector(newLucene<SetBasedFieldSelector>(loadFieldNames, lazyFieldNames));
+
+    // read across chunks in both directions, loading fields eagerly and lazily
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    EXPECT_EQ(NUM_DOCS, reader->maxDoc());
+    for (int32_t doc = NUM_DOCS - 1; doc >= 0; doc -= 7) {
+        checkChunkDoc(reader, doc, FieldSelectorPtr());
+    }
+    for (int32_t doc = 0; doc < NUM_DOCS; ++doc) {
+        checkChunkDoc(reader, doc, lazySelector);
+    }
+    reader->close();
+
+    // merging copies the decompressed documents into new chunks
+    writer->optimize();
+    writer->close();
+    reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+    for (int32_t doc = 0; doc < NUM_DOCS; ++doc) {
+        checkChunkDoc(reader, doc, (doc % 2) == 0 ? FieldSelectorPtr() : lazySelector);
+        EXPECT_EQ(StringUtils::toString(doc), reader->document(doc)->get(L"id"));
+    }
+    reader->close();
+}
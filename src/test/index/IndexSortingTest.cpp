@@ -0,0 +1,300 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "TestUtils.h"
+#include "IndexWriter.h"
+#include "RAMDirectory.h"
+#include "WhitespaceAnalyzer.h"
+#include "SerialMergeScheduler.h"
+#include "Document.h"
+#include "Field.h"
+#include "NumericField.h"
+#include "IndexReader.h"
+#include "SegmentReader.h"
+#include "SegmentInfo.h"
+#include "DocValuesColumn.h"
+#include "TermFreqVector.h"
+#include "TermPositions.h"
+#include "TermDocs.h"
+#include "Term.h"
+#include "FieldCache.h"
+#include "IndexSearcher.h"
+#include "TermQuery.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "TopFieldCollector.h"
+#include "TopFieldDocs.h"
+#include "ScoreDoc.h"
+#include "QueryWrapperFilter.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture IndexSortingTest;
+
+/// Timestamps repeat every hundred documents, so ties are sorted as well
+static int32_t timestamp(int32_t id) {
+    return (id * 7919) % 100;
+}
+
+static void addDoc(const IndexWriterPtr& writer, int32_t id) {
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    doc->add(newLucene<Field>(L"time", StringUtils::toString(timestamp(id)), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    String parity(id % 2 == 0 ? L"even" : L"odd");
+    doc->add(newLucene<Field>(L"content", L"aaa " + parity + L" t" + StringUtils::toString(id % 10), Field::STORE_NO, Field::INDEX_ANALYZED, Field::TERM_VECTOR_WITH_POSITIONS_OFFSETS));
+    NumericFieldPtr num = newLucene<NumericField>(L"num", Field::STORE_NO, false);
+    num->setIntValue(id);
+    num->setDocValuesType(Fieldable::DOC_VALUES_NUMERIC);
+    doc->add(num);
+    writer->addDocument(doc);
+}
+
+static SortPtr newestFirst() {
+    return newLucene<Sort>(newLucene<SortField>(L"time", SortField::INT, true));
+}
+
+static void buildIndex(const DirectoryPtr& dir, const SortPtr& sort) {
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMergeScheduler(newLucene<SerialMergeScheduler>());
+    writer->setMaxBufferedDocs(10);
+    writer->setMergeFactor(3);
+    writer->setIndexSort(sort);
+    for (int32_t i = 0; i < 300; ++i) {
+        addDoc(writer, i);
+        if (i % 7 == 0) {
+            writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(i / 2)));
+        }
+    }
+    writer->close();
+}
+
+/// Checks that every segment is in sort order and that each document's postings, stored fields, vectors
+/// and doc values moved together
+static void checkSortedSegments(const IndexReaderPtr& reader, const SortPtr& sort) {
+    Collection<IndexReaderPtr> segments = reader->getSequentialSubReaders();
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        SegmentReaderPtr segmentReader = std::dynamic_pointer_cast<SegmentReader>(*segment);
+        EXPECT_EQ(sort->getIndexKey(), segmentReader->getSegmentInfo()->getDiagnostics().get(L"sort"));
+
+        Collection<int32_t> times = FieldCache::DEFAULT()->getInts(*segment, L"time");
+        DocValuesColumnPtr num = (*segment)->getDocValuesColumn(L"num");
+        int32_t lastTime = INT_MAX;
+        for (int32_t doc = 0; doc < (*segment)->maxDoc(); ++doc) {
+            if ((*segment)->isDeleted(doc)) {
+                continue;
+            }
+            int32_t id = StringUtils::toInt((*segment)->document(doc)->get(L"id"));
+            EXPECT_EQ(timestamp(id), times[doc]);
+            EXPECT_TRUE(times[doc] <= lastTime);
+            lastTime = times[doc];
+            EXPECT_EQ(id, num->getLong(doc));
+
+            TermDocsPtr termDocs = (*segment)->termDocs(newLucene<Term>(L"id", StringUtils::toString(id)));
+            EXPECT_TRUE(termDocs->next());
+            EXPECT_EQ(doc, termDocs->doc());
+            termDocs->close();
+
+            TermPositionsPtr positions = (*segment)->termPositions(newLucene<Term>(L"content", id % 2 == 0 ? L"even" : L"odd"));
+            EXPECT_TRUE(positions->skipTo(doc));
+            EXPECT_EQ(doc, positions->doc());
+            EXPECT_EQ(1, positions->nextPosition());
+            positions->close();
+
+            TermFreqVectorPtr vector = (*segment)->getTermFreqVector(doc, L"content");
+            EXPECT_TRUE(vector->indexOf(L"t" + StringUtils::toString(id % 10)) != -1);
+        }
+    }
+}
+
+TEST_F(IndexSortingTest, testMergesKeepSegmentsSorted) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    buildIndex(dir, newestFirst());
+    EXPECT_TRUE(checkIndex(dir));
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(257, reader->numDocs());
+    EXPECT_TRUE(reader->getSequentialSubReaders().size() > 1);
+    checkSortedSegments(reader, newestFirst());
+    reader->close();
+    dir->close();
+}
+
+/// Segments flushed in sort order are kept, the others are rewritten by a sort merge
+TEST_F(IndexSortingTest, testFlushedInOrderNotRewritten) {
+    for (int32_t reverse = 0; reverse < 2; ++reverse) {
+        DirectoryPtr dir = newLucene<RAMDirectory>();
+        IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+        writer->setMergeScheduler(newLucene<SerialMergeScheduler>());
+        writer->setMaxBufferedDocs(10);
+        writer->setMergeFactor(1000);
+        writer->setIndexSort(newLucene<Sort>(newLucene<SortField>(L"num", SortField::INT, reverse == 1)));
+        for (int32_t i = 0; i < 50; ++i) {
+            addDoc(writer, i);
+        }
+        writer->close();
+        EXPECT_TRUE(checkIndex(dir));
+
+        IndexReaderPtr reader = IndexReader::open(dir, true);
+        Collection<IndexReaderPtr> segments = reader->getSequentialSubReaders();
+        EXPECT_EQ(5, segments.size());
+        for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+            MapStringString diagnostics = std::dynamic_pointer_cast<SegmentReader>(*segment)->getSegmentInfo()->getDiagnostics();
+            EXPECT_EQ(reverse == 0 ? L"flush" : L"merge", diagnostics.get(L"source"));
+            EXPECT_TRUE(diagnostics.contains(L"sort"));
+        }
+        reader->close();
+        dir->close();
+    }
+}
+
+TEST_F(IndexSortingTest, testOptimizeSortsWholeIndex) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    buildIndex(dir, SortPtr());
+
+    // an existing unsorted index is sorted once the writer is told to
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), false, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setIndexSort(newestFirst());
+    writer->optimize();
+    writer->close();
+    EXPECT_TRUE(checkIndex(dir));
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(257, reader->numDocs());
+    EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+    checkSortedSegments(reader, newestFirst());
+    reader->close();
+    dir->close();
+}
+
+TEST_F(IndexSortingTest, testEarlyTermination) {
+    DirectoryPtr sortedDir = newLucene<RAMDirectory>();
+    buildIndex(sortedDir, newestFirst());
+    DirectoryPtr unsortedDir = newLucene<RAMDirectory>();
+    buildIndex(unsortedDir, SortPtr());
+
+    IndexSearcherPtr sorted = newLucene<IndexSearcher>(sortedDir, true);
+    IndexSearcherPtr unsorted = newLucene<IndexSearcher>(unsortedDir, true);
+    QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"content", L"even"));
+
+    TopFieldDocsPtr expected = unsorted->search(query, FilterPtr(), 10, newestFirst());
+    TopFieldDocsPtr actual = sorted->search(query, FilterPtr(), 10, newestFirst());
+    EXPECT_EQ(129, expected->totalHits);
+    EXPECT_TRUE(actual->totalHits < expected->totalHits);
+    EXPECT_EQ(expected->scoreDocs.size(), actual->scoreDocs.size());
+    for (int32_t i = 0; i < expected->scoreDocs.size(); ++i) {
+        // ties keep the order the documents were added in, so the hits are the same documents
+        EXPECT_EQ(unsorted->doc(expected->scoreDocs[i]->doc)->get(L"id"), sorted->doc(actual->scoreDocs[i]->doc)->get(L"id"));
+    }
+
+    // tracking the max score needs every hit
+    TopFieldCollectorPtr collector = TopFieldCollector::create(newestFirst(), 10, true, true, true, true);
+    sorted->search(query, collector);
+    EXPECT_EQ(129, collector->getTotalHits());
+
+    // so does a sort the segments are not in
+    SortPtr oldestFirst = newLucene<Sort>(newLucene<SortField>(L"time", SortField::INT));
+    EXPECT_EQ(129, sorted->search(query, FilterPtr(), 10, oldestFirst)->totalHits);
+
+    sorted->close();
+    unsorted->close();
+    sortedDir->close();
+    unsortedDir->close();
+}
+
+TEST_F(IndexSortingTest, testEarlyTerminationOnLeadingSortField) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    Collection<SortFieldPtr> fields = newCollection<SortFieldPtr>(newLucene<SortField>(L"time", SortField::INT, true), newLucene<SortField>(L"id", SortField::STRING));
+    buildIndex(dir, newLucene<Sort>(fields));
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"content", L"aaa"));
+    TopFieldCollectorPtr collector = TopFieldCollector::create(newestFirst(), 5, true, true, true, true);
+    searcher->search(query, collector);
+    TopDocsPtr expected = collector->topDocs();
+    EXPECT_EQ(257, expected->totalHits);
+
+    TopFieldDocsPtr hits = searcher->search(query, FilterPtr(), 5, newestFirst());
+    EXPECT_TRUE(hits->totalHits < 257);
+    EXPECT_EQ(5, hits->scoreDocs.size());
+    for (int32_t i = 0; i < hits->scoreDocs.size(); ++i) {
+        EXPECT_EQ(expected->scoreDocs[i]->doc, hits->scoreDocs[i]->doc);
+    }
+    searcher->close();
+    dir->close();
+}
+
+/// Without an executor every segment is searched in turn, and each one stops on its own
+TEST_F(IndexSortingTest, testEarlyTerminationWithoutSlices) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    buildIndex(dir, newestFirst());
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    EXPECT_FALSE(searcher->getExecutor());
+    EXPECT_TRUE(searcher->getIndexReader()->getSequentialSubReaders().size() > 1);
+    QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"content", L"even"));
+    FilterPtr filter = newLucene<QueryWrapperFilter>(newLucene<TermQuery>(newLucene<Term>(L"content", L"aaa")));
+
+    TopFieldCollectorPtr collector = TopFieldCollector::create(newestFirst(), 10, true, true, true, true);
+    searcher->search(query, collector);
+    TopDocsPtr expected = collector->topDocs();
+    EXPECT_EQ(129, expected->totalHits);
+
+    // early termination is not a RuntimeException, so it never reaches code catching those
+    try {
+        TopFieldDocsPtr hits = searcher->search(query, FilterPtr(), 10, newestFirst());
+        TopFieldDocsPtr filtered = searcher->search(query, filter, 10, newestFirst());
+        EXPECT_TRUE(hits->totalHits < 129);
+        EXPECT_EQ(hits->totalHits, filtered->totalHits);
+        EXPECT_EQ(10, hits->scoreDocs.size());
+        EXPECT_EQ(10, filtered->scoreDocs.size());
+        for (int32_t i = 0; i < hits->scoreDocs.size(); ++i) {
+            EXPECT_EQ(expected->scoreDocs[i]->doc, hits->scoreDocs[i]->doc);
+            EXPECT_EQ(expected->scoreDocs[i]->doc, filtered->scoreDocs[i]->doc);
+        }
+    } catch (RuntimeException&) {
+        FAIL() << "early termination escaped the search";
+    }
+    try {
+        boost::throw_exception(CollectionTerminatedException());
+    } catch (RuntimeException&) {
+        FAIL() << "CollectionTerminatedException must not be a RuntimeException";
+    } catch (CollectionTerminatedException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::CollectionTerminated)(e));
+    }
+    searcher->close();
+    dir->close();
+}
+
+/// A sort on the same field that orders it differently must not stop early
+TEST_F(IndexSortingTest, testLocaleSortNotTerminated) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    SortPtr byId = newLucene<Sort>(newLucene<SortField>(L"id", SortField::STRING));
+    buildIndex(dir, byId);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    QueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"content", L"aaa"));
+
+    EXPECT_TRUE(searcher->search(query, FilterPtr(), 5, byId)->totalHits < 257);
+    SortPtr byLocale = newLucene<Sort>(newLucene<SortField>(L"id", std::locale()));
+    EXPECT_EQ(byId->toString(), byLocale->toString());
+    EXPECT_NE(byId->getIndexKey(), byLocale->getIndexKey());
+    EXPECT_EQ(257, searcher->search(query, FilterPtr(), 5, byLocale)->totalHits);
+    searcher->close();
+    dir->close();
+}
+
+TEST_F(IndexSortingTest, testRelevanceSortRejected) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    try {
+        writer->setIndexSort(Sort::RELEVANCE());
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    EXPECT_FALSE(writer->getIndexSort());
+    writer->close();
+    dir->close();
+}
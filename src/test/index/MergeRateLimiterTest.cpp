@@ -0,0 +1,168 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "MergeRateLimiter.h"
+#include "_MergeRateLimiter.h"
+#include "RAMDirectory.h"
+#include "IndexOutput.h"
+#include "RAMOutputStream.h"
+#include "IndexInput.h"
+#include "LuceneThread.h"
+#include "MiscUtils.h"
+#include "IndexWriter.h"
+#include "IndexSearcher.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "TermQuery.h"
+#include "Term.h"
+#include "TopDocs.h"
+#include "ConcurrentMergeScheduler.h"
+#include "ThreadPool.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture MergeRateLimiterTest;
+
+namespace TestMergeRateLimiter {
+
+/// Records the length the file is set to
+class SetLengthOutput : public RAMOutputStream {
+public:
+    SetLengthOutput() {
+        setTo = -1;
+    }
+
+    virtual ~SetLengthOutput() {
+    }
+
+    LUCENE_CLASS(SetLengthOutput);
+
+    int64_t setTo;
+
+    virtual void setLength(int64_t length) {
+        setTo = length;
+    }
+};
+
+typedef std::shared_ptr<SetLengthOutput> SetLengthOutputPtr;
+
+}
+
+TEST_F(MergeRateLimiterTest, testUnthrottled) {
+    MergeRateLimiterPtr limiter = newLucene<MergeRateLimiter>();
+    EXPECT_EQ(0.0, limiter->getMBPerSec());
+    EXPECT_EQ(0, limiter->pause(100 * 1024 * 1024));
+}
+
+TEST_F(MergeRateLimiterTest, testPauseHoldsRate) {
+    MergeRateLimiterPtr limiter = newLucene<MergeRateLimiter>(1.0);
+    uint64_t start = MiscUtils::currentTimeMillis();
+    for (int32_t i = 0; i < 16; ++i) {
+        limiter->pause(16 * 1024);
+    }
+    // 256 KB at 1 MB/sec takes a quarter of a second, less the first write which goes out at once
+    EXPECT_TRUE(MiscUtils::currentTimeMillis() - start >= 200);
+}
+
+TEST_F(MergeRateLimiterTest, testAdaptsToLatency) {
+    MergeRateLimiterPtr limiter = newLucene<MergeRateLimiter>();
+    limiter->setMBPerSecRange(10.0, 80.0);
+    limiter->setTargetLatency(1000);
+    EXPECT_EQ(80.0, limiter->getMBPerSec());
+
+    // slow searches halve the rate, at most once per adjustment interval
+    limiter->observeLatency(5000);
+    EXPECT_EQ(40.0, limiter->getMBPerSec());
+    limiter->observeLatency(5000);
+    EXPECT_EQ(40.0, limiter->getMBPerSec());
+    for (int32_t i = 0; i < 3; ++i) {
+        LuceneThread::threadSleep(MergeRateLimiter::ADJUST_INTERVAL_MILLIS + 10);
+        limiter->observeLatency(5000);
+    }
+    EXPECT_EQ(10.0, limiter->getMBPerSec());
+
+    // once searches are fast again the rate grows back
+    for (int32_t i = 0; i < 50; ++i) {
+        limiter->observeLatency(100);
+    }
+    EXPECT_TRUE(limiter->getAverageLatency() < 1000.0);
+    LuceneThread::threadSleep(MergeRateLimiter::ADJUST_INTERVAL_MILLIS + 10);
+    limiter->observeLatency(100);
+    EXPECT_DOUBLE_EQ(12.0, limiter->getMBPerSec());
+}
+
+TEST_F(MergeRateLimiterTest, testRateLimitedOutput) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    DirectoryPtr limited = newLucene<RateLimitedDirectory>(dir, newLucene<MergeRateLimiter>(1.0));
+
+    IndexOutputPtr output = limited->createOutput(L"test");
+    for (int32_t i = 0; i < 100000; ++i) {
+        output->writeVInt(i);
+    }
+    int64_t pointer = output->getFilePointer();
+    EXPECT_EQ(pointer, output->length()); // counts the bytes still buffered
+    output->seek(0);
+    output->writeInt(12345);
+    output->close();
+
+    EXPECT_EQ(pointer, dir->fileLength(L"test"));
+    IndexInputPtr input = dir->openInput(L"test");
+    EXPECT_EQ(12345, input->readInt());
+    // the int replaced the single byte vints of 0 to 3
+    for (int32_t i = 4; i < 100000; ++i) {
+        EXPECT_EQ(i, input->readVInt());
+    }
+    EXPECT_EQ(pointer, input->getFilePointer());
+    input->close();
+    dir->close();
+}
+
+TEST_F(MergeRateLimiterTest, testSearcherReportsLatency) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 100; ++i) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"content", i % 2 == 0 ? L"even" : L"odd", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->close();
+
+    MergeRateLimiterPtr limiter = newLucene<MergeRateLimiter>();
+    limiter->setMBPerSecRange(10.0, 80.0);
+    limiter->setTargetLatency(1);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    EXPECT_EQ(50, searcher->search(newLucene<TermQuery>(newLucene<Term>(L"content", L"even")), 10)->totalHits);
+    EXPECT_EQ(0.0, limiter->getAverageLatency());
+
+    searcher->setMergeRateLimiter(limiter);
+    EXPECT_EQ(limiter, searcher->getMergeRateLimiter());
+    for (int32_t i = 0; i < 10 && limiter->getAverageLatency() == 0.0; ++i) {
+        EXPECT_EQ(50, searcher->search(newLucene<TermQuery>(newLucene<Term>(L"content", L"odd")), 10)->totalHits);
+    }
+    EXPECT_TRUE(limiter->getAverageLatency() > 0.0);
+    searcher->close();
+    dir->close();
+}
+
+TEST_F(MergeRateLimiterTest, testMergesUseOwnPool) {
+    ConcurrentMergeSchedulerPtr cms = newLucene<ConcurrentMergeScheduler>();
+    EXPECT_EQ(ConcurrentMergeScheduler::getMergePool(), cms->getMergeExecutor());
+    EXPECT_NE(ThreadPool::getInstance(), cms->getMergeExecutor());
+    EXPECT_EQ(ConcurrentMergeScheduler::MERGE_POOL_SIZE, cms->getMergeExecutor()->getSize());
+}
+
+TEST_F(MergeRateLimiterTest, testSetLengthForwarded) {
+    TestMergeRateLimiter::SetLengthOutputPtr wrapped = newLucene<TestMergeRateLimiter::SetLengthOutput>();
+    IndexOutputPtr output = newLucene<RateLimitedIndexOutput>(wrapped, newLucene<MergeRateLimiter>());
+    output->writeInt(42);
+    output->setLength(1000);
+    EXPECT_EQ(1000, wrapped->setTo);
+    EXPECT_EQ(4, wrapped->length());
+    output->close();
+}
@@ -0,0 +1,175 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "SegmentReader.h"
+#include "SegmentInfo.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "Term.h"
+#include "TermEnum.h"
+#include "TermDocs.h"
+#include "TermPositions.h"
+#include "Random.h"
+#include "StringUtils.h"
+
+using namespace Lucene;
+
+/// Indexes written with packed postings must read back exactly like the legacy format
+class PackedPostingsTest : public LuceneTestFixture {
+public:
+    virtual ~PackedPostingsTest() {
+    }
+
+public:
+    void addDocs(const IndexWriterPtr& writer, int32_t start, int32_t end) {
+        for (int32_t i = start; i < end; ++i) {
+            DocumentPtr doc = newLucene<Document>();
+            String body;
+            for (int32_t j = 0; j <= i % 5; ++j) {
+                body += L" common";
+            }
+            if (i % 37 == 0) {
+                body += L" sparse";
+            }
+            if (i % 1000 == 999) {
+                body += L" rare";
+            }
+            body += L" n" + StringUtils::toString(i % 300);
+            doc->add(newLucene<Field>(L"body", body, Field::STORE_NO, Field::INDEX_ANALYZED));
+            FieldPtr tags = newLucene<Field>(L"tags", (i % 3 == 0) ? L"all three" : L"all", Field::STORE_NO, Field::INDEX_ANALYZED);
+            tags->setOmitTermFreqAndPositions(true);
+            doc->add(tags);
+            writer->addDocument(doc);
+        }
+    }
+
+    DirectoryPtr createIndex(bool packed, int32_t numDocs) {
+        DirectoryPtr dir = newLucene<RAMDirectory>();
+        IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+        writer->setUsePackedPostings(packed);
+        EXPECT_EQ(packed, writer->getUsePackedPostings());
+        addDocs(writer, 0, numDocs);
+        writer->optimize();
+        writer->close();
+        return dir;
+    }
+
+    /// Returns the docs and freqs read by termDocs, interleaved
+    Collection<int32_t> readAll(const TermDocsPtr& termDocs, Collection<int32_t> docs, Collection<int32_t> freqs) {
+        Collection<int32_t> all = Collection<int32_t>::newInstance();
+        int32_t n;
+        while ((n = termDocs->read(docs, freqs)) != 0) {
+            for (int32_t i = 0; i < n; ++i) {
+                all.add(docs[i]);
+                all.add(freqs[i]);
+            }
+        }
+        return all;
+    }
+
+    void checkSame(const IndexReaderPtr& expected, const IndexReaderPtr& actual) {
+        RandomPtr random = newLucene<Random>(42);
+        TermEnumPtr terms = expected->terms();
+        Collection<int32_t> expectedDocs = Collection<int32_t>::newInstance(32);
+        Collection<int32_t> expectedFreqs = Collection<int32_t>::newInstance(32);
+        Collection<int32_t> actualDocs = Collection<int32_t>::newInstance(32);
+        Collection<int32_t> actualFreqs = Collection<int32_t>::newInstance(32);
+        while (terms->next()) {
+            TermPtr term = terms->term();
+            EXPECT_EQ(terms->docFreq(), actual->docFreq(term));
+
+            // positions, one doc at a time
+            TermPositionsPtr expectedPositions = expected->termPositions(term);
+            TermPositionsPtr actualPositions = actual->termPositions(term);
+            while (expectedPositions->next()) {
+                EXPECT_TRUE(actualPositions->next());
+                EXPECT_EQ(expectedPositions->doc(), actualPositions->doc());
+                EXPECT_EQ(expectedPositions->freq(), actualPositions->freq());
+                if (term->field() == L"body" && expectedPositions->doc() % 3 == 0) {
+                    for (int32_t i = 0; i < expectedPositions->freq(); ++i) {
+                        EXPECT_EQ(expectedPositions->nextPosition(), actualPositions->nextPosition());
+                    }
+                }
+            }
+            EXPECT_TRUE(!actualPositions->next());
+
+            // bulk reads, which may stop short at segment boundaries
+            Collection<int32_t> expectedAll = readAll(expected->termDocs(term), expectedDocs, expectedFreqs);
+            Collection<int32_t> actualAll = readAll(actual->termDocs(term), actualDocs, actualFreqs);
+            EXPECT_TRUE(expectedAll.equals(actualAll));
+
+            // skipping, with positions read after each skip
+            expectedPositions = expected->termPositions(term);
+            actualPositions = actual->termPositions(term);
+            int32_t target = 0;
+            while (true) {
+                target += 1 + random->nextInt(random->nextInt(2) == 0 ? 10 : 500);
+                bool found = expectedPositions->skipTo(target);
+                EXPECT_EQ(found, actualPositions->skipTo(target));
+                if (!found) {
+                    break;
+                }
+                EXPECT_EQ(expectedPositions->doc(), actualPositions->doc());
+                EXPECT_EQ(expectedPositions->freq(), actualPositions->freq());
+                if (term->field() == L"body") {
+                    EXPECT_EQ(expectedPositions->nextPosition(), actualPositions->nextPosition());
+                }
+                target = expectedPositions->doc();
+            }
+        }
+    }
+};
+
+TEST_F(PackedPostingsTest, testSameAsLegacy) {
+    DirectoryPtr legacy = createIndex(false, 3000);
+    DirectoryPtr packed = createIndex(true, 3000);
+    EXPECT_TRUE(!SegmentReader::getOnlySegmentReader(legacy)->getSegmentInfo()->getPackedPostings());
+    EXPECT_TRUE(SegmentReader::getOnlySegmentReader(packed)->getSegmentInfo()->getPackedPostings());
+    checkSame(IndexReader::open(legacy, true), IndexReader::open(packed, true));
+}
+
+TEST_F(PackedPostingsTest, testDeletions) {
+    DirectoryPtr legacy = createIndex(false, 1500);
+    DirectoryPtr packed = createIndex(true, 1500);
+    Collection<DirectoryPtr> dirs = newCollection<DirectoryPtr>(legacy, packed);
+    for (Collection<DirectoryPtr>::iterator dir = dirs.begin(); dir != dirs.end(); ++dir) {
+        IndexReaderPtr reader = IndexReader::open(*dir, false);
+        for (int32_t i = 0; i < 1500; i += 7) {
+            reader->deleteDocument(i);
+        }
+        for (int32_t i = 200; i < 600; ++i) {
+            reader->deleteDocument(i);
+        }
+        reader->close();
+    }
+    checkSame(IndexReader::open(legacy, true), IndexReader::open(packed, true));
+}
+
+TEST_F(PackedPostingsTest, testMixedSegments) {
+    DirectoryPtr legacy = createIndex(false, 2000);
+
+    // legacy segment plus packed segments, read side by side and then merged into one
+    DirectoryPtr mixed = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(mixed, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    addDocs(writer, 0, 700);
+    writer->commit();
+    writer->setUsePackedPostings(true);
+    writer->setMaxBufferedDocs(500);
+    addDocs(writer, 700, 2000);
+    writer->commit();
+    checkSame(IndexReader::open(legacy, true), IndexReader::open(mixed, true));
+
+    writer->optimize();
+    writer->close();
+    EXPECT_TRUE(SegmentReader::getOnlySegmentReader(mixed)->getSegmentInfo()->getPackedPostings());
+    checkSame(IndexReader::open(legacy, true), IndexReader::open(mixed, true));
+}
@@ -236,3 +236,70 @@ TEST_F(SegmentTermDocsTest, testIndexDivisor) {
     checkBadSeek(2);
     checkSkipTo(2);
 }
+
+TEST_F(SegmentTermDocsTest, testBlockRead) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 1000; ++i) {
+        String value = L"aaa";
+        if (i % 3 == 0) {
+            value += L" bbb bbb";
+        }
+        if (i % 200 == 0) {
+            value += L" ccc";
+        }
+        addDoc(writer, value);
+    }
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, false);
+    for (int32_t i = 500; i < 520; ++i) {
+        reader->deleteDocument(i);
+    }
+    reader->deleteDocument(5);
+    reader->deleteDocument(999);
+
+    Collection<String> terms = newCollection<String>(L"aaa", L"bbb", L"ccc");
+    for (Collection<String>::iterator term = terms.begin(); term != terms.end(); ++term) {
+        Collection<int32_t> expectedDocs = Collection<int32_t>::newInstance();
+        Collection<int32_t> expectedFreqs = Collection<int32_t>::newInstance();
+        TermDocsPtr termDocs = reader->termDocs(newLucene<Term>(L"content", *term));
+        while (termDocs->next()) {
+            expectedDocs.add(termDocs->doc());
+            expectedFreqs.add(termDocs->freq());
+        }
+        EXPECT_TRUE(!expectedDocs.empty());
+
+        // alternate bulk reads with single steps so both consume the same decoded block
+        termDocs = reader->termDocs(newLucene<Term>(L"content", *term));
+        Collection<int32_t> docs = Collection<int32_t>::newInstance(32);
+        Collection<int32_t> freqs = Collection<int32_t>::newInstance(32);
+        int32_t upto = 0;
+        while (true) {
+            int32_t n = termDocs->read(docs, freqs);
+            for (int32_t i = 0; i < n; ++i, ++upto) {
+                EXPECT_EQ(expectedDocs[upto], docs[i]);
+                EXPECT_EQ(expectedFreqs[upto], freqs[i]);
+            }
+            if (!termDocs->next()) {
+                break;
+            }
+            EXPECT_EQ(expectedDocs[upto], termDocs->doc());
+            EXPECT_EQ(expectedFreqs[upto], termDocs->freq());
+            ++upto;
+        }
+        EXPECT_EQ(expectedDocs.size(), upto);
+
+        // skipping past a partly consumed block
+        if (expectedDocs.size() > 64) {
+            termDocs = reader->termDocs(newLucene<Term>(L"content", *term));
+            EXPECT_EQ(32, termDocs->read(docs, freqs));
+            int32_t target = expectedDocs[expectedDocs.size() / 2];
+            EXPECT_TRUE(termDocs->skipTo(target));
+            EXPECT_EQ(target, termDocs->doc());
+            EXPECT_TRUE(termDocs->next());
+            EXPECT_EQ(expectedDocs[expectedDocs.size() / 2 + 1], termDocs->doc());
+        }
+    }
+    reader->close();
+}
@@ -17,6 +17,7 @@
 #include "Term.h"
 #include "SegmentReader.h"
 #include "SegmentTermEnum.h"
+#include "BytesRef.h"
 
 using namespace Lucene;
 
@@ -101,3 +102,56 @@ TEST_F(SegmentTermEnumTest, testPrevTermAtEnd) {
     EXPECT_TRUE(!termEnum->next());
     EXPECT_EQ(L"bbb", termEnum->prev()->text());
 }
+
+TEST_F(SegmentTermEnumTest, testUTF8Terms) {
+    // terms of one to four bytes per char, enough of them to span several terms index entries
+    static const wchar_t* suffixes[] = {L"a", L"\u00e9", L"\u4e2d", L"\U0001F600"};
+    Collection<String> terms(Collection<String>::newInstance());
+    for (int32_t i = 0; i < 300; ++i) {
+        terms.add(StringUtils::toString(i % 17) + suffixes[i % 4] + StringUtils::toString(i));
+    }
+
+    DirectoryPtr dir = newLucene<MockRAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < terms.size(); ++i) {
+        addDoc(writer, terms[i]);
+    }
+    writer->optimize();
+    writer->close();
+    std::sort(terms.begin(), terms.end());
+
+    SegmentReaderPtr reader = SegmentReader::getOnlySegmentReader(dir);
+    SegmentTermEnumPtr termEnum = std::dynamic_pointer_cast<SegmentTermEnum>(reader->terms());
+    BytesRefPtr bytes(newLucene<BytesRef>());
+    for (int32_t i = 0; i < terms.size(); ++i) {
+        EXPECT_TRUE(termEnum->next());
+        termEnum->termBytes(bytes);
+        EXPECT_TRUE(bytes->equals(newLucene<BytesRef>(terms[i])));
+        EXPECT_EQ(0, termEnum->compareTerm(newLucene<Term>(L"content", terms[i])));
+        EXPECT_EQ(terms[i], termEnum->term()->text());
+    }
+    EXPECT_TRUE(!termEnum->next());
+    termEnum->close();
+
+    // lookups compare the bytes of the dictionary, in random order and in order
+    for (int32_t i = terms.size() - 1; i >= 0; i -= 3) {
+        EXPECT_EQ(1, reader->docFreq(newLucene<Term>(L"content", terms[i])));
+    }
+    for (int32_t i = 0; i < terms.size(); ++i) {
+        EXPECT_EQ(1, reader->docFreq(newLucene<Term>(L"content", terms[i])));
+        EXPECT_EQ(0, reader->docFreq(newLucene<Term>(L"content", terms[i] + L"\u00e9")));
+    }
+
+    for (int32_t i = 0; i < terms.size(); i += 7) {
+        String target(terms[i] + L"\u00e9");
+        Collection<String>::iterator next = std::lower_bound(terms.begin(), terms.end(), target);
+        TermEnumPtr seekEnum = reader->terms(newLucene<Term>(L"content", target));
+        if (next == terms.end()) {
+            EXPECT_TRUE(!seekEnum->term());
+        } else {
+            EXPECT_EQ(*next, seekEnum->term()->text());
+        }
+        seekEnum->close();
+    }
+    reader->close();
+}
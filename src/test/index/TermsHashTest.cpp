@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "Term.h"
+#include "TermEnum.h"
+#include "TermDocs.h"
+#include "TermFreqVector.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture TermsHashTest;
+
+static const int32_t NUM_TERMS = 5000;
+
+/// Distinct terms sharing prefixes, whose hash codes differ in only a few bits
+static String termText(int32_t i) {
+    String text(L"t");
+    for (int32_t n = i; n > 0; n /= 26) {
+        text += (wchar_t)(L'a' + n % 26);
+    }
+    return text;
+}
+
+TEST_F(TermsHashTest, testManyTerms) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED));
+
+    // each document repeats every term it contains, and the hash is grown from its initial size for both
+    // the postings and the term vectors of every document
+    for (int32_t doc = 0; doc < 3; ++doc) {
+        StringStream content;
+        for (int32_t i = doc; i < NUM_TERMS; i += doc + 1) {
+            content << termText(i) << L" " << termText(i) << L" ";
+        }
+        DocumentPtr document(newLucene<Document>());
+        document->add(newLucene<Field>(L"content", content.str(), Field::STORE_NO, Field::INDEX_ANALYZED, Field::TERM_VECTOR_YES));
+        writer->addDocument(document);
+    }
+    writer->close();
+
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    for (int32_t i = 0; i < NUM_TERMS; ++i) {
+        TermPtr term(newLucene<Term>(L"content", termText(i)));
+        int32_t expected = 0;
+        for (int32_t doc = 0; doc < 3; ++doc) {
+            expected += (i >= doc && (i - doc) % (doc + 1) == 0) ? 1 : 0;
+        }
+        EXPECT_EQ(expected, reader->docFreq(term));
+        TermDocsPtr termDocs(reader->termDocs(term));
+        while (termDocs->next()) {
+            EXPECT_EQ(2, termDocs->freq());
+        }
+        termDocs->close();
+    }
+
+    // the flushed terms are in order and there are no duplicates
+    TermEnumPtr terms(reader->terms(newLucene<Term>(L"content", L"")));
+    int32_t count = 0;
+    String last;
+    do {
+        TermPtr term(terms->term());
+        if (!term || term->field() != L"content") {
+            break;
+        }
+        EXPECT_TRUE(count == 0 || last < term->text());
+        last = term->text();
+        ++count;
+    } while (terms->next());
+    terms->close();
+    EXPECT_EQ(NUM_TERMS, count);
+
+    for (int32_t doc = 0; doc < 3; ++doc) {
+        TermFreqVectorPtr vector(reader->getTermFreqVector(doc, L"content"));
+        Collection<String> vectorTerms(vector->getTerms());
+        Collection<int32_t> freqs(vector->getTermFrequencies());
+        EXPECT_EQ(NUM_TERMS / (doc + 1), vectorTerms.size());
+        for (int32_t i = 0; i < vectorTerms.size(); ++i) {
+            EXPECT_EQ(2, freqs[i]);
+            EXPECT_TRUE(i == 0 || vectorTerms[i - 1] < vectorTerms[i]);
+        }
+    }
+    reader->close();
+}
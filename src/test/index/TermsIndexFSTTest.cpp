@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "TermsIndexFST.h"
+#include "Term.h"
+#include "Random.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "TermEnum.h"
+#include "StringUtils.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture TermsIndexFSTTest;
+
+static String randomText(const RandomPtr& random) {
+    String text;
+    int32_t length = random->nextInt(8);
+    for (int32_t i = 0; i < length; ++i) {
+        text += (wchar_t)(L'a' + random->nextInt(4));
+    }
+    return text;
+}
+
+TEST_F(TermsIndexFSTTest, testFloor) {
+    RandomPtr random(newLucene<Random>());
+    Collection<TermPtr> terms(Collection<TermPtr>::newInstance());
+    Collection<String> fields(newCollection<String>(L"", L"body", L"title"));
+    for (int32_t i = 0; i < 2000; ++i) {
+        terms.add(newLucene<Term>(fields[random->nextInt(fields.size())], randomText(random)));
+    }
+    std::sort(terms.begin(), terms.end(), luceneCompare<TermPtr>());
+
+    TermsIndexFSTPtr index(newLucene<TermsIndexFST>());
+    Collection<TermPtr> keys(Collection<TermPtr>::newInstance());
+    for (Collection<TermPtr>::iterator term = terms.begin(); term != terms.end(); ++term) {
+        int32_t ordinal = index->add((*term)->field(), (*term)->text().c_str(), (int32_t)(*term)->text().length());
+        if (keys.empty() || !keys[keys.size() - 1]->equals(*term)) {
+            keys.add(*term);
+        }
+        EXPECT_EQ(keys.size() - 1, ordinal);
+    }
+    index->finish();
+    EXPECT_EQ(keys.size(), index->size());
+
+    String field;
+    CharArray text;
+    for (int32_t i = 0; i < keys.size(); ++i) {
+        int32_t length = index->getTerm(i, field, text);
+        EXPECT_EQ(keys[i]->field(), field);
+        EXPECT_EQ(keys[i]->text(), String(text.get(), length));
+        EXPECT_EQ(i, index->floor(keys[i]->field(), keys[i]->text()));
+    }
+
+    // probes between and around the keys, including fields that are not indexed
+    Collection<String> probeFields(newCollection<String>(L"", L"a", L"body", L"c", L"title", L"z"));
+    for (int32_t i = 0; i < 2000; ++i) {
+        TermPtr probe(newLucene<Term>(probeFields[random->nextInt(probeFields.size())], randomText(random)));
+        int32_t expected = (int32_t)(std::upper_bound(keys.begin(), keys.end(), probe, luceneCompare<TermPtr>()) - keys.begin()) - 1;
+        EXPECT_EQ(expected, index->floor(probe->field(), probe->text()));
+    }
+}
+
+TEST_F(TermsIndexFSTTest, testSharedSuffixes) {
+    TermsIndexFSTPtr index(newLucene<TermsIndexFST>());
+    int64_t textSize = 0;
+    for (int32_t i = 0; i < 1000; ++i) {
+        String text(StringUtils::toString(1000 + i) + L"suffix");
+        index->add(L"field", text.c_str(), (int32_t)text.length());
+        textSize += text.length() * sizeof(wchar_t);
+    }
+    index->finish();
+    EXPECT_EQ(1000, index->size());
+    EXPECT_TRUE(index->sizeInBytes() < textSize);
+}
+
+TEST_F(TermsIndexFSTTest, testOutOfOrder) {
+    TermsIndexFSTPtr index(newLucene<TermsIndexFST>());
+    index->add(L"field", L"b", 1);
+    try {
+        index->add(L"field", L"a", 1);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    try {
+        index->add(L"aaa", L"c", 1);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+}
+
+TEST_F(TermsIndexFSTTest, testTermLookups) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    writer->setTermIndexInterval(4);
+    for (int32_t i = 0; i < 500; ++i) {
+        DocumentPtr doc(newLucene<Document>());
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(i * 7), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"parity", i % 2 == 0 ? L"even" : L"odd", Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->optimize();
+    writer->close();
+
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    for (int32_t i = 0; i < 500 * 7; ++i) {
+        EXPECT_EQ(i % 7 == 0 ? 1 : 0, reader->docFreq(newLucene<Term>(L"id", StringUtils::toString(i))));
+    }
+    EXPECT_EQ(250, reader->docFreq(newLucene<Term>(L"parity", L"even")));
+    EXPECT_EQ(0, reader->docFreq(newLucene<Term>(L"missing", L"even")));
+
+    // seeking between terms positions the enum on the next one
+    TermEnumPtr termEnum(reader->terms(newLucene<Term>(L"id", L"1000")));
+    EXPECT_TRUE(termEnum->term()->equals(newLucene<Term>(L"id", L"1001")));
+    termEnum->close();
+    termEnum = reader->terms(newLucene<Term>(L"idz", L""));
+    EXPECT_TRUE(termEnum->term()->equals(newLucene<Term>(L"parity", L"even")));
+    termEnum->close();
+    reader->close();
+}
@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "IndexWriter.h"
+#include "RAMDirectory.h"
+#include "WhitespaceAnalyzer.h"
+#include "TieredMergePolicy.h"
+#include "SerialMergeScheduler.h"
+#include "Document.h"
+#include "Field.h"
+#include "IndexReader.h"
+#include "SegmentInfos.h"
+#include "SegmentInfo.h"
+#include "Term.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture TieredMergePolicyTest;
+
+static void addDoc(const IndexWriterPtr& writer, int32_t id) {
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+    doc->add(newLucene<Field>(L"content", L"aaa bbb ccc " + StringUtils::toString(id % 7), Field::STORE_NO, Field::INDEX_ANALYZED));
+    writer->addDocument(doc);
+}
+
+static IndexWriterPtr newWriter(const DirectoryPtr& dir) {
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMaxBufferedDocs(10);
+    writer->setMergeScheduler(newLucene<SerialMergeScheduler>());
+    writer->setMergePolicy(newLucene<TieredMergePolicy>(writer));
+    return writer;
+}
+
+TEST_F(TieredMergePolicyTest, testSegmentCountStaysWithinTiers) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newWriter(dir);
+    TieredMergePolicyPtr policy = std::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    policy->setMergeFactor(5);
+    policy->setSegmentsPerTier(5.0);
+
+    // Every segment is below the floor size, so the whole index is a single tier
+    for (int32_t i = 0; i < 500; ++i) {
+        addDoc(writer, i);
+        EXPECT_TRUE(writer->getSegmentCount() <= 5);
+    }
+
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(500, reader->numDocs());
+    reader->close();
+    dir->close();
+}
+
+TEST_F(TieredMergePolicyTest, testMaxMergedSegmentSize) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newWriter(dir);
+    writer->setUseCompoundFile(false);
+    TieredMergePolicyPtr policy = std::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    policy->setMergeFactor(5);
+    policy->setSegmentsPerTier(5.0);
+    policy->setMinMergeMB(0.001);
+    policy->setMaxMergeMB(0.02);
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        addDoc(writer, i);
+    }
+    writer->close();
+
+    // Merged segments may overshoot the estimate from their inputs a little, but never by much
+    SegmentInfosPtr infos = newLucene<SegmentInfos>();
+    infos->read(dir);
+    int64_t maxMergeSize = (int64_t)(0.02 * 1024 * 1024);
+    EXPECT_TRUE(infos->size() > 5);
+    for (int32_t i = 0; i < infos->size(); ++i) {
+        SegmentInfoPtr info = infos->info(i);
+        EXPECT_TRUE(info->docCount <= 10 || info->sizeInBytes() <= maxMergeSize + maxMergeSize / 2);
+    }
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1000, reader->numDocs());
+    reader->close();
+    dir->close();
+}
+
+TEST_F(TieredMergePolicyTest, testExpungeDeletes) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newWriter(dir);
+    TieredMergePolicyPtr policy = std::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    policy->setMergeFactor(10);
+    policy->setSegmentsPerTier(10.0);
+
+    for (int32_t i = 0; i < 200; ++i) {
+        addDoc(writer, i);
+    }
+    writer->commit();
+    for (int32_t i = 0; i < 200; i += 2) {
+        writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(i)));
+    }
+    writer->commit();
+    EXPECT_TRUE(writer->hasDeletions());
+
+    // Half of every segment is deleted, well above the allowed percentage
+    writer->expungeDeletes();
+    EXPECT_TRUE(!writer->hasDeletions());
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(100, reader->numDocs());
+    EXPECT_EQ(100, reader->maxDoc());
+    reader->close();
+    dir->close();
+}
+
+TEST_F(TieredMergePolicyTest, testExpungeDeletesPctAllowed) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newWriter(dir);
+    TieredMergePolicyPtr policy = std::dynamic_pointer_cast<TieredMergePolicy>(writer->getMergePolicy());
+    policy->setExpungeDeletesPctAllowed(20.0);
+
+    for (int32_t i = 0; i < 100; ++i) {
+        addDoc(writer, i);
+    }
+    writer->commit();
+
+    // One deletion per segment of ten stays under the allowed percentage
+    for (int32_t i = 0; i < 100; i += 10) {
+        writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(i)));
+    }
+    writer->commit();
+    writer->expungeDeletes();
+    EXPECT_TRUE(writer->hasDeletions());
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(90, reader->numDocs());
+    EXPECT_EQ(100, reader->maxDoc());
+    reader->close();
+    dir->close();
+
+    try {
+        policy->setExpungeDeletesPctAllowed(101.0);
+        FAIL() << "percentage above 100 must be rejected";
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+}
@@ -0,0 +1,193 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include <boost/algorithm/string.hpp>
+#include "LuceneTestFixture.h"
+#include "Automaton.h"
+#include "WildcardTermEnum.h"
+#include "FuzzyTermEnum.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "Term.h"
+#include "Random.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture AutomatonTermEnumTest;
+
+static String randomString(const RandomPtr& random, int32_t maxLength, const String& alphabet) {
+    String text;
+    int32_t length = random->nextInt(maxLength + 1);
+    for (int32_t i = 0; i < length; ++i) {
+        text += alphabet[random->nextInt(alphabet.length())];
+    }
+    return text;
+}
+
+static int32_t editDistance(const String& s, const String& t) {
+    Collection<int32_t> p(Collection<int32_t>::newInstance(t.length() + 1));
+    Collection<int32_t> d(Collection<int32_t>::newInstance(t.length() + 1));
+    for (int32_t j = 0; j <= (int32_t)t.length(); ++j) {
+        p[j] = j;
+    }
+    for (int32_t i = 1; i <= (int32_t)s.length(); ++i) {
+        d[0] = i;
+        for (int32_t j = 1; j <= (int32_t)t.length(); ++j) {
+            d[j] = std::min(std::min(d[j - 1] + 1, p[j] + 1), p[j - 1] + (s[i - 1] == t[j - 1] ? 0 : 1));
+        }
+        std::swap(p, d);
+    }
+    return p[t.length()];
+}
+
+/// Every string of the alphabet up to maxLength characters, sorted.
+static Collection<String> allStrings(const String& alphabet, int32_t maxLength) {
+    Collection<String> strings(newCollection<String>(L""));
+    for (int32_t i = 0; i < strings.size(); ++i) {
+        if ((int32_t)strings[i].length() < maxLength) {
+            for (String::const_iterator c = alphabet.begin(); c != alphabet.end(); ++c) {
+                strings.add(strings[i] + *c);
+            }
+        }
+    }
+    std::sort(strings.begin(), strings.end());
+    return strings;
+}
+
+static void checkNextString(const AutomatonPtr& automaton, const Collection<String>& strings) {
+    for (int32_t i = 0; i < strings.size(); ++i) {
+        if (automaton->run(strings[i])) {
+            continue;
+        }
+        String next;
+        bool found = automaton->nextString(strings[i], next);
+        if (found) {
+            EXPECT_TRUE(next > strings[i]);
+        }
+        // no accepted string lies between the rejected string and the next candidate
+        for (int32_t j = i + 1; j < strings.size() && (!found || strings[j] < next); ++j) {
+            EXPECT_FALSE(automaton->run(strings[j]));
+        }
+    }
+}
+
+TEST_F(AutomatonTermEnumTest, testWildcardAutomaton) {
+    RandomPtr random(newLucene<Random>());
+    Collection<String> strings(allStrings(L"abc", 5));
+    for (int32_t i = 0; i < 50; ++i) {
+        String pattern(randomString(random, 4, L"ab?*"));
+        AutomatonPtr automaton(Automaton::makeWildcard(pattern));
+        EXPECT_TRUE(automaton);
+        for (Collection<String>::iterator s = strings.begin(); s != strings.end(); ++s) {
+            EXPECT_EQ(WildcardTermEnum::wildcardEquals(pattern, 0, *s, 0), automaton->run(*s));
+        }
+        checkNextString(automaton, strings);
+    }
+}
+
+TEST_F(AutomatonTermEnumTest, testLevenshteinAutomaton) {
+    RandomPtr random(newLucene<Random>());
+    Collection<String> strings(allStrings(L"abc", 5));
+    for (int32_t i = 0; i < 30; ++i) {
+        String prefix(randomString(random, 1, L"ab"));
+        String text(randomString(random, 4, L"abc"));
+        int32_t maxEdits = random->nextInt(3);
+        AutomatonPtr automaton(Automaton::makeLevenshtein(prefix, text, maxEdits));
+        EXPECT_TRUE(automaton);
+        for (Collection<String>::iterator s = strings.begin(); s != strings.end(); ++s) {
+            bool expected = boost::starts_with(*s, prefix) && editDistance(s->substr(prefix.length()), text) <= maxEdits;
+            EXPECT_EQ(expected, automaton->run(*s));
+        }
+        checkNextString(automaton, strings);
+    }
+}
+
+TEST_F(AutomatonTermEnumTest, testMaxStates) {
+    EXPECT_FALSE(Automaton::makeLevenshtein(L"", L"abcdefghij", 3, 10));
+}
+
+static Collection<String> enumTerms(const FilteredTermEnumPtr& termEnum) {
+    Collection<String> terms(Collection<String>::newInstance());
+    do {
+        TermPtr term(termEnum->term());
+        if (!term) {
+            break;
+        }
+        terms.add(term->text());
+    } while (termEnum->next());
+    termEnum->close();
+    return terms;
+}
+
+TEST_F(AutomatonTermEnumTest, testEnumerations) {
+    RandomPtr random(newLucene<Random>());
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED));
+    for (int32_t i = 0; i < 500; ++i) {
+        DocumentPtr doc(newLucene<Document>());
+        doc->add(newLucene<Field>(L"body", randomString(random, 7, L"abcde") + L"x", Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        doc->add(newLucene<Field>(L"title", randomString(random, 3, L"abcde") + L"x", Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->close();
+
+    IndexReaderPtr reader(IndexReader::open(dir, true));
+    Collection<String> bodyTerms(Collection<String>::newInstance());
+    TermEnumPtr termEnum(reader->terms(newLucene<Term>(L"body", L"")));
+    do {
+        if (termEnum->term()->field() != L"body") {
+            break;
+        }
+        bodyTerms.add(termEnum->term()->text());
+    } while (termEnum->next());
+    termEnum->close();
+
+    for (int32_t i = 0; i < 50; ++i) {
+        String pattern(randomString(random, 5, L"abcde?*") + L"x");
+        Collection<String> expected(Collection<String>::newInstance());
+        for (Collection<String>::iterator term = bodyTerms.begin(); term != bodyTerms.end(); ++term) {
+            if (WildcardTermEnum::wildcardEquals(pattern, 0, *term, 0)) {
+                expected.add(*term);
+            }
+        }
+        EXPECT_TRUE(expected.equals(enumTerms(newLucene<WildcardTermEnum>(reader, newLucene<Term>(L"body", pattern)))));
+    }
+
+    for (int32_t i = 0; i < 50; ++i) {
+        String text(randomString(random, 6, L"abcde") + L"x");
+        int32_t prefixLength = random->nextInt(3);
+        double minSimilarity = 0.5 + 0.1 * (double)random->nextInt(4);
+        String prefix(text.substr(0, std::min(prefixLength, (int32_t)text.length())));
+        String suffix(text.substr(prefix.length()));
+        Collection<String> expected(Collection<String>::newInstance());
+        for (Collection<String>::iterator term = bodyTerms.begin(); term != bodyTerms.end(); ++term) {
+            if (!boost::starts_with(*term, prefix)) {
+                continue;
+            }
+            String target(term->substr(prefix.length()));
+            double similarity;
+            if (suffix.empty()) {
+                similarity = prefix.empty() ? 0.0 : 1.0 - ((double)target.length() / (double)prefix.length());
+            } else if (target.empty()) {
+                similarity = prefix.empty() ? 0.0 : 1.0 - ((double)suffix.length() / (double)prefix.length());
+            } else {
+                double length = (double)(prefix.length() + std::min(suffix.length(), target.length()));
+                similarity = 1.0 - ((double)editDistance(target, suffix) / length);
+            }
+            if (similarity > minSimilarity) {
+                expected.add(*term);
+            }
+        }
+        FuzzyTermEnumPtr fuzzyEnum(newLucene<FuzzyTermEnum>(reader, newLucene<Term>(L"body", text), minSimilarity, prefixLength));
+        EXPECT_TRUE(expected.equals(enumTerms(fuzzyEnum)));
+    }
+    reader->close();
+}
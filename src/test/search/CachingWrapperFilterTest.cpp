@@ -20,7 +20,7 @@
 #include "FieldCacheRangeFilter.h"
 #include "OpenBitSet.h"
 #include "DocIdSet.h"
-#include "OpenBitSetDISI.h"
+#include "RoaringDocIdSet.h"
 #include "IndexSearcher.h"
 #include "Field.h"
 #include "Document.h"
@@ -43,7 +43,7 @@ static void checkDocIdSetCacheable(const IndexReaderPtr& reader, const FilterPtr
     if (originalSet->isCacheable()) {
         EXPECT_TRUE(MiscUtils::equalTypes(originalSet, cachedSet));
     } else {
-        EXPECT_TRUE(MiscUtils::typeOf<OpenBitSetDISI>(cachedSet));
+        EXPECT_TRUE(MiscUtils::typeOf<RoaringDocIdSet>(cachedSet));
     }
 }
 
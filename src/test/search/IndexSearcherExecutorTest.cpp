@@ -0,0 +1,125 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "WhitespaceAnalyzer.h"
+#include "IndexSearcher.h"
+#include "IndexReader.h"
+#include "Document.h"
+#include "Field.h"
+#include "TermQuery.h"
+#include "BooleanQuery.h"
+#include "Term.h"
+#include "Sort.h"
+#include "SortField.h"
+#include "QueryWrapperFilter.h"
+#include "ScoreDoc.h"
+#include "TopDocs.h"
+#include "TopFieldDocs.h"
+#include "ThreadPool.h"
+#include "StringUtils.h"
+
+using namespace Lucene;
+
+/// Searches with an executor must return exactly what the sequential search returns
+class IndexSearcherExecutorTest : public LuceneTestFixture {
+public:
+    IndexSearcherExecutorTest() {
+        directory = newLucene<RAMDirectory>();
+        IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+        writer->setMaxBufferedDocs(37);
+        writer->setMergeFactor(1000);
+        for (int32_t i = 0; i < 500; ++i) {
+            DocumentPtr doc = newLucene<Document>();
+            String body = (i % 2 == 0) ? L"even" : L"odd";
+            if (i % 3 == 0) {
+                body += L" three";
+            }
+            if (i % 7 == 0) {
+                body += L" seven seven";
+            }
+            doc->add(newLucene<Field>(L"body", body, Field::STORE_NO, Field::INDEX_ANALYZED));
+            doc->add(newLucene<Field>(L"value", StringUtils::toString((i * 7919) % 1000), Field::STORE_NO, Field::INDEX_NOT_ANALYZED));
+            writer->addDocument(doc);
+        }
+        writer->close();
+        pool = newLucene<ThreadPool>(3);
+    }
+
+    virtual ~IndexSearcherExecutorTest() {
+    }
+
+protected:
+    DirectoryPtr directory;
+    ThreadPoolPtr pool;
+
+public:
+    void checkSame(const TopDocsPtr& expected, const TopDocsPtr& actual, bool scores = true) {
+        EXPECT_EQ(expected->totalHits, actual->totalHits);
+        EXPECT_EQ(expected->scoreDocs.size(), actual->scoreDocs.size());
+        for (int32_t i = 0; i < expected->scoreDocs.size() && i < actual->scoreDocs.size(); ++i) {
+            EXPECT_EQ(expected->scoreDocs[i]->doc, actual->scoreDocs[i]->doc);
+            if (scores) {
+                EXPECT_NEAR(expected->scoreDocs[i]->score, actual->scoreDocs[i]->score, 0.00001);
+            }
+        }
+    }
+
+    void checkQueries(int32_t maxSliceDocs) {
+        IndexSearcherPtr sequential = newLucene<IndexSearcher>(directory, true);
+        IndexSearcherPtr concurrent = newLucene<IndexSearcher>(directory, true);
+        concurrent->setExecutor(pool, maxSliceDocs);
+        EXPECT_TRUE(sequential->getIndexReader()->getSequentialSubReaders().size() > 1);
+
+        QueryPtr even = newLucene<TermQuery>(newLucene<Term>(L"body", L"even"));
+        QueryPtr three = newLucene<TermQuery>(newLucene<Term>(L"body", L"three"));
+        QueryPtr seven = newLucene<TermQuery>(newLucene<Term>(L"body", L"seven"));
+        BooleanQueryPtr disjunction = newLucene<BooleanQuery>();
+        disjunction->add(three, BooleanClause::SHOULD);
+        disjunction->add(seven, BooleanClause::SHOULD);
+        BooleanQueryPtr conjunction = newLucene<BooleanQuery>();
+        conjunction->add(even, BooleanClause::MUST);
+        conjunction->add(seven, BooleanClause::SHOULD);
+
+        Collection<QueryPtr> queries = newCollection<QueryPtr>(even, three, disjunction, conjunction);
+        FilterPtr filter = newLucene<QueryWrapperFilter>(three);
+        SortPtr sort = newLucene<Sort>(newLucene<SortField>(L"value", SortField::INT));
+
+        for (Collection<QueryPtr>::iterator query = queries.begin(); query != queries.end(); ++query) {
+            checkSame(sequential->search(*query, 10), concurrent->search(*query, 10));
+            checkSame(sequential->search(*query, 1000), concurrent->search(*query, 1000));
+            checkSame(sequential->search(*query, filter, 10), concurrent->search(*query, filter, 10));
+            checkSame(sequential->search(*query, FilterPtr(), 10, sort), concurrent->search(*query, FilterPtr(), 10, sort), false);
+            checkSame(sequential->search(*query, filter, 10, sort), concurrent->search(*query, filter, 10, sort), false);
+        }
+    }
+};
+
+TEST_F(IndexSearcherExecutorTest, testSegmentSlices) {
+    checkQueries(IndexSearcher::DEFAULT_MAX_SLICE_DOCS);
+}
+
+TEST_F(IndexSearcherExecutorTest, testDocIdSlices) {
+    checkQueries(10);
+}
+
+TEST_F(IndexSearcherExecutorTest, testMergeShardHits) {
+    Collection<ScoreDocPtr> first = newCollection<ScoreDocPtr>(newLucene<ScoreDoc>(3, 2.0), newLucene<ScoreDoc>(1, 1.0));
+    Collection<ScoreDocPtr> second = newCollection<ScoreDocPtr>(newLucene<ScoreDoc>(7, 3.0), newLucene<ScoreDoc>(2, 1.0), newLucene<ScoreDoc>(5, 0.5));
+    Collection<TopDocsPtr> shardHits = newCollection<TopDocsPtr>(newLucene<TopDocs>(10, first, 2.0), newLucene<TopDocs>(20, second, 3.0));
+
+    TopDocsPtr merged = TopDocs::merge(SortPtr(), 4, shardHits);
+    EXPECT_EQ(30, merged->totalHits);
+    EXPECT_EQ(3.0, merged->maxScore);
+    EXPECT_EQ(4, merged->scoreDocs.size());
+    EXPECT_EQ(7, merged->scoreDocs[0]->doc);
+    EXPECT_EQ(3, merged->scoreDocs[1]->doc);
+    EXPECT_EQ(1, merged->scoreDocs[2]->doc); // tie broken by doc id
+    EXPECT_EQ(2, merged->scoreDocs[3]->doc);
+}
@@ -23,6 +23,10 @@
 #include "TermQuery.h"
 #include "BooleanQuery.h"
 #include "QueryParser.h"
+#include "IndexReader.h"
+#include "Weight.h"
+#include "PhraseScorer.h"
+#include "Random.h"
 
 using namespace Lucene;
 
@@ -501,3 +505,109 @@ TEST_F(PhraseQueryTest, testEmptyPhraseQuery) {
     q2->add(newLucene<PhraseQuery>(), BooleanClause::MUST);
     EXPECT_EQ(q2->toString(), L"+\"?\"");
 }
+
+static int32_t phraseFreq(Collection<int32_t> tokens, Collection<int32_t> phrase) {
+    int32_t freq = 0;
+    for (int32_t position = 0; position + phrase.size() <= tokens.size(); ++position) {
+        bool match = true;
+        for (int32_t i = 0; i < phrase.size() && match; ++i) {
+            match = (tokens[position + i] == phrase[i]);
+        }
+        if (match) {
+            ++freq;
+        }
+    }
+    return freq;
+}
+
+/// Checks the phrase frequency of every document against its words, over short documents whose positions
+/// are intersected through bitsets and long sparse ones whose positions are merged
+TEST_F(PhraseQueryTest, testExactPhraseFrequencies) {
+    static const wchar_t* words[] = {L"a", L"b", L"c", L"d", L"e", L"f"};
+    RandomPtr random = newLucene<Random>(42);
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED);
+    Collection< Collection<int32_t> > docs = Collection< Collection<int32_t> >::newInstance();
+    for (int32_t i = 0; i < 300; ++i) {
+        Collection<int32_t> tokens;
+        if (i % 5 == 0) {
+            // a long document of filler words with a few phrases planted in it
+            tokens = Collection<int32_t>::newInstance(2000 + random->nextInt(2000));
+            for (int32_t j = 0; j < tokens.size(); ++j) {
+                tokens[j] = 3 + random->nextInt(3);
+            }
+            for (int32_t j = 0; j < 4; ++j) {
+                int32_t position = random->nextInt(tokens.size() - 3);
+                tokens[position] = 0;
+                tokens[position + 1] = 1;
+                tokens[position + 2] = random->nextInt(3);
+            }
+        } else {
+            tokens = Collection<int32_t>::newInstance(1 + random->nextInt(60));
+            for (int32_t j = 0; j < tokens.size(); ++j) {
+                tokens[j] = random->nextInt(4);
+            }
+        }
+        StringStream text;
+        for (int32_t j = 0; j < tokens.size(); ++j) {
+            text << words[tokens[j]] << L" ";
+        }
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"field", text.str(), Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+        docs.add(tokens);
+    }
+    writer->optimize();
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    IndexReaderPtr segment = reader->getSequentialSubReaders()[0];
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(reader);
+    Collection< Collection<int32_t> > phrases = newCollection< Collection<int32_t> >(
+        newCollection<int32_t>(0, 1), newCollection<int32_t>(1, 0), newCollection<int32_t>(0, 1, 2),
+        newCollection<int32_t>(0, 0), newCollection<int32_t>(0, 1, 0), newCollection<int32_t>(3, 4), newCollection<int32_t>(2, 3, 2)
+    );
+    for (Collection< Collection<int32_t> >::iterator phrase = phrases.begin(); phrase != phrases.end(); ++phrase) {
+        PhraseQueryPtr query = newLucene<PhraseQuery>();
+        for (Collection<int32_t>::iterator word = phrase->begin(); word != phrase->end(); ++word) {
+            query->add(newLucene<Term>(L"field", words[*word]));
+        }
+        Collection<int32_t> expected = Collection<int32_t>::newInstance(docs.size());
+        for (int32_t doc = 0; doc < docs.size(); ++doc) {
+            expected[doc] = phraseFreq(docs[doc], *phrase);
+        }
+
+        PhraseScorerPtr scorer = std::dynamic_pointer_cast<PhraseScorer>(query->weight(searcher)->scorer(segment, true, false));
+        int32_t last = -1;
+        for (int32_t doc = scorer->nextDoc(); doc != DocIdSetIterator::NO_MORE_DOCS; doc = scorer->nextDoc()) {
+            for (int32_t skipped = last + 1; skipped < doc; ++skipped) {
+                EXPECT_EQ(0, expected[skipped]);
+            }
+            EXPECT_EQ(expected[doc], (int32_t)scorer->currentFreq());
+            last = doc;
+        }
+        for (int32_t skipped = last + 1; skipped < docs.size(); ++skipped) {
+            EXPECT_EQ(0, expected[skipped]);
+        }
+
+        // advancing lands on the same documents
+        scorer = std::dynamic_pointer_cast<PhraseScorer>(query->weight(searcher)->scorer(segment, true, false));
+        int32_t target = random->nextInt(10);
+        while (true) {
+            int32_t expectedDoc = target;
+            while (expectedDoc < docs.size() && expected[expectedDoc] == 0) {
+                ++expectedDoc;
+            }
+            int32_t doc = scorer->advance(target);
+            if (expectedDoc >= docs.size()) {
+                EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, doc);
+                break;
+            }
+            EXPECT_EQ(expectedDoc, doc);
+            EXPECT_EQ(expected[expectedDoc], (int32_t)scorer->currentFreq());
+            target = expectedDoc + 1 + random->nextInt(20);
+        }
+    }
+    searcher->close();
+    reader->close();
+}
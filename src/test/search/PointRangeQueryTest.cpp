@@ -0,0 +1,237 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "TestUtils.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "IndexSearcher.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "NumericField.h"
+#include "PointField.h"
+#include "PointValues.h"
+#include "PointRangeQuery.h"
+#include "PointRangeFilter.h"
+#include "NumericRangeQuery.h"
+#include "MatchAllDocsQuery.h"
+#include "TopDocs.h"
+#include "ScoreDoc.h"
+#include "Term.h"
+#include "Random.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture PointRangeQueryTest;
+
+static const int32_t NUM_DOCS = 3000;
+
+static int32_t intValue(int32_t id) {
+    return (id * 37) % 1000 - 500;
+}
+
+static double latitude(int32_t id) {
+    return (double)(id % 97) / 2.0 - 20.0;
+}
+
+static double longitude(int32_t id) {
+    return (double)(id % 89) * 1.5 - 60.0;
+}
+
+/// Indexes every value both as trie terms and as points, and deletes every tenth document
+static DirectoryPtr createIndex(int32_t maxBufferedDocs) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setMaxBufferedDocs(maxBufferedDocs);
+    for (int32_t id = 0; id < NUM_DOCS; ++id) {
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(L"id", StringUtils::toString(id), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+        NumericFieldPtr value = newLucene<NumericField>(L"value", Field::STORE_YES, true);
+        value->setIntValue(intValue(id));
+        value->setPointIndexed(true);
+        doc->add(value);
+        doc->add(newLucene<PointField>(L"location", newCollection<double>(latitude(id), longitude(id))));
+        if (id % 3 == 0) {
+            // a second point in the same document
+            doc->add(newLucene<PointField>(L"location", newCollection<double>(-latitude(id), -longitude(id))));
+        }
+        writer->addDocument(doc);
+    }
+    for (int32_t id = 0; id < NUM_DOCS; id += 10) {
+        writer->deleteDocuments(newLucene<Term>(L"id", StringUtils::toString(id)));
+    }
+    writer->close();
+    return dir;
+}
+
+static Collection<int32_t> search(const IndexSearcherPtr& searcher, const QueryPtr& query) {
+    TopDocsPtr hits = searcher->search(query, FilterPtr(), NUM_DOCS);
+    Collection<int32_t> docs = Collection<int32_t>::newInstance();
+    for (int32_t i = 0; i < hits->scoreDocs.size(); ++i) {
+        docs.add(hits->scoreDocs[i]->doc);
+    }
+    std::sort(docs.begin(), docs.end());
+    return docs;
+}
+
+static bool insideBox(double lat, double lon, double minLat, double maxLat, double minLon, double maxLon) {
+    return lat >= minLat && lat <= maxLat && lon >= minLon && lon <= maxLon;
+}
+
+static void checkRanges(const DirectoryPtr& dir) {
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    RandomPtr random = newLucene<Random>(17);
+    for (int32_t i = 0; i < 50; ++i) {
+        int32_t lower = random->nextInt(1100) - 550;
+        int32_t upper = lower + random->nextInt(400);
+        bool lowerInclusive = random->nextInt(2) == 0;
+        bool upperInclusive = random->nextInt(2) == 0;
+        Collection<int32_t> expected = search(searcher, NumericRangeQuery::newIntRange(L"value", lower, upper, lowerInclusive, upperInclusive));
+        Collection<int32_t> actual = search(searcher, PointRangeQuery::newIntRange(L"value", lower, upper, lowerInclusive, upperInclusive));
+        EXPECT_TRUE(expected.equals(actual));
+    }
+
+    for (int32_t i = 0; i < 20; ++i) {
+        double minLat = (double)random->nextInt(60) - 30.0;
+        double maxLat = minLat + (double)random->nextInt(30);
+        double minLon = (double)random->nextInt(120) - 60.0;
+        double maxLon = minLon + (double)random->nextInt(70);
+        int32_t expected = 0;
+        for (int32_t id = 0; id < NUM_DOCS; ++id) {
+            if (id % 10 == 0) {
+                continue;
+            }
+            if (insideBox(latitude(id), longitude(id), minLat, maxLat, minLon, maxLon) ||
+                (id % 3 == 0 && insideBox(-latitude(id), -longitude(id), minLat, maxLat, minLon, maxLon))) {
+                ++expected;
+            }
+        }
+        QueryPtr box = PointRangeQuery::newDoubleBox(L"location", newCollection<double>(minLat, minLon), newCollection<double>(maxLat, maxLon));
+        EXPECT_EQ(expected, search(searcher, box).size());
+    }
+    searcher->close();
+}
+
+TEST_F(PointRangeQueryTest, testMatchesNumericRangeQuery) {
+    DirectoryPtr dir = createIndex(250);
+    checkRanges(dir);
+    dir->close();
+}
+
+TEST_F(PointRangeQueryTest, testSingleSegmentWithManyLeaves) {
+    DirectoryPtr dir = createIndex(NUM_DOCS);
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+    PointValuesPtr values = reader->getSequentialSubReaders()[0]->getPointValues(L"value");
+    EXPECT_EQ(1, values->getNumDimensions());
+    EXPECT_EQ(NUM_DOCS, values->size());
+    EXPECT_EQ(-500, values->getMinValue(0));
+    EXPECT_EQ(499, values->getMaxValue(0));
+    reader->close();
+    checkRanges(dir);
+    dir->close();
+}
+
+TEST_F(PointRangeQueryTest, testMergeDropsDeletedPoints) {
+    DirectoryPtr dir = createIndex(250);
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), false, IndexWriter::MaxFieldLengthLIMITED);
+    writer->optimize();
+    writer->close();
+    EXPECT_TRUE(checkIndex(dir));
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(1, reader->getSequentialSubReaders().size());
+    IndexReaderPtr segment = reader->getSequentialSubReaders()[0];
+    EXPECT_EQ(NUM_DOCS - NUM_DOCS / 10, segment->getPointValues(L"value")->size());
+    PointValuesPtr location = segment->getPointValues(L"location");
+    EXPECT_EQ(2, location->getNumDimensions());
+    EXPECT_EQ(NUM_DOCS - NUM_DOCS / 10 + NUM_DOCS / 3 - NUM_DOCS / 30, location->size());
+    EXPECT_FALSE(segment->getPointValues(L"id"));
+    reader->close();
+
+    checkRanges(dir);
+    dir->close();
+}
+
+TEST_F(PointRangeQueryTest, testExclusiveBoundsAtLimits) {
+    DirectoryPtr dir = createIndex(NUM_DOCS);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    EXPECT_EQ(0, search(searcher, PointRangeQuery::newLongRange(L"value", LLONG_MAX, LLONG_MAX, false, true)).size());
+    EXPECT_EQ(0, search(searcher, PointRangeQuery::newLongRange(L"value", LLONG_MIN, LLONG_MIN, true, false)).size());
+    EXPECT_EQ(NUM_DOCS - NUM_DOCS / 10, search(searcher, PointRangeQuery::newLongRange(L"value", LLONG_MIN, LLONG_MAX, true, true)).size());
+    EXPECT_EQ(0, search(searcher, PointRangeQuery::newIntRange(L"value", 10, 10, false, true)).size());
+    EXPECT_EQ(0, search(searcher, PointRangeQuery::newIntRange(L"missing", -1000, 1000, true, true)).size());
+    searcher->close();
+    dir->close();
+}
+
+TEST_F(PointRangeQueryTest, testDimensionsMustMatch) {
+    DirectoryPtr dir = createIndex(NUM_DOCS);
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    try {
+        searcher->search(PointRangeQuery::newDoubleRange(L"location", 0.0, 1.0, true, true), FilterPtr(), 10);
+        FAIL() << "searching two dimensional points with a one dimensional range should fail";
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    searcher->close();
+    dir->close();
+
+    dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<PointField>(L"location", newCollection<double>(1.0, 2.0)));
+    writer->addDocument(doc);
+    doc = newLucene<Document>();
+    doc->add(newLucene<PointField>(L"location", newCollection<double>(1.0)));
+    try {
+        writer->addDocument(doc);
+        FAIL() << "changing the point dimensions of a field should fail";
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+    writer->close();
+    dir->close();
+}
+
+TEST_F(PointRangeQueryTest, testEqualsAndToString) {
+    QueryPtr query = PointRangeQuery::newIntRange(L"value", 1, 5, true, false);
+    EXPECT_TRUE(query->equals(PointRangeQuery::newLongRange(L"value", 1, 4, true, true)));
+    EXPECT_FALSE(query->equals(PointRangeQuery::newIntRange(L"value", 1, 5, true, true)));
+    EXPECT_EQ(query->hashCode(), PointRangeQuery::newLongRange(L"value", 1, 4, true, true)->hashCode());
+    EXPECT_EQ(L"value:[1 TO 4]", query->toString());
+    EXPECT_EQ(L"box:[1,2 TO 3,4]", PointRangeQuery::newBox(L"box", newCollection<int64_t>(1, 2), newCollection<int64_t>(3, 4))->toString());
+    EXPECT_TRUE(query->equals(query->clone()));
+}
+
+TEST_F(PointRangeQueryTest, testRAMUsed) {
+    DirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    writer->setRAMBufferSizeMB(0.1);
+    DocumentPtr doc = newLucene<Document>();
+    doc->add(newLucene<PointField>(L"location", newCollection<int64_t>(1, 2)));
+    writer->addDocument(doc);
+    EXPECT_TRUE(writer->ramSizeInBytes() >= (int64_t)(2 * sizeof(int64_t)));
+
+    // documents with nothing but points still fill the RAM buffer and trigger flushes
+    for (int32_t id = 0; id < 20000; ++id) {
+        doc = newLucene<Document>();
+        doc->add(newLucene<PointField>(L"location", newCollection<int64_t>(id, -id)));
+        writer->addDocument(doc);
+    }
+    EXPECT_TRUE(writer->getFlushCount() > 0);
+    writer->commit();
+    EXPECT_TRUE(writer->ramSizeInBytes() < 1024);
+    writer->close();
+
+    IndexReaderPtr reader = IndexReader::open(dir, true);
+    EXPECT_EQ(20001, reader->numDocs());
+    reader->close();
+    dir->close();
+}
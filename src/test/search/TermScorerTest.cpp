@@ -18,6 +18,9 @@
 #include "IndexSearcher.h"
 #include "IndexReader.h"
 #include "Collector.h"
+#include "TopScoreDocCollector.h"
+#include "TopDocs.h"
+#include "ScoreDoc.h"
 #include "DocIdSetIterator.h"
 
 using namespace Lucene;
@@ -157,3 +160,91 @@ TEST_F(TermScorerTest, testSkipTo) {
     EXPECT_NE(ts->advance(3), DocIdSetIterator::NO_MORE_DOCS);
     EXPECT_EQ(ts->docID(), 5);
 }
+
+namespace TestBatchCollection {
+
+DECLARE_SHARED_PTR(AllHitsCollector)
+
+class AllHitsCollector : public Collector {
+public:
+    AllHitsCollector() {
+        hits = Collection<TestHitPtr>::newInstance();
+    }
+
+    virtual ~AllHitsCollector() {
+    }
+
+public:
+    ScorerPtr scorer;
+    Collection<TestHitPtr> hits;
+
+public:
+    virtual void setScorer(const ScorerPtr& scorer) {
+        this->scorer = scorer;
+    }
+
+    virtual void collect(int32_t doc) {
+        hits.add(newLucene<TestHit>(doc, scorer->score()));
+    }
+
+    virtual void setNextReader(const IndexReaderPtr& reader, int32_t docBase) {
+    }
+
+    virtual bool acceptsDocsOutOfOrder() {
+        return false;
+    }
+};
+
+struct lessHit {
+    inline bool operator()(const TestHitPtr& first, const TestHitPtr& second) const {
+        return first->score > second->score || (first->score == second->score && first->doc < second->doc);
+    }
+};
+
+}
+
+TEST_F(TermScorerTest, testBatchCollection) {
+    RAMDirectoryPtr dir = newLucene<RAMDirectory>();
+    IndexWriterPtr writer = newLucene<IndexWriter>(dir, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED);
+    for (int32_t i = 0; i < 300; ++i) {
+        String text;
+        if (i % 3 != 0) {
+            for (int32_t j = 0; j <= i % 40; ++j) {
+                text += L"all ";
+            }
+        }
+        for (int32_t j = 0; j < i % 5; ++j) {
+            text += L"pad ";
+        }
+        DocumentPtr doc = newLucene<Document>();
+        doc->add(newLucene<Field>(FIELD, text + L"end", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->optimize();
+    writer->close();
+
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(dir, true);
+    IndexReaderPtr reader = searcher->getIndexReader();
+    TermPtr allTerm = newLucene<Term>(FIELD, L"all");
+    WeightPtr weight = newLucene<TermQuery>(allTerm)->weight(searcher);
+
+    TestBatchCollection::AllHitsCollectorPtr expected = newLucene<TestBatchCollection::AllHitsCollector>();
+    newLucene<TermScorer>(weight, reader->termDocs(allTerm), searcher->getSimilarity(), reader->norms(FIELD))->score(expected);
+    EXPECT_EQ(200, expected->hits.size());
+    std::sort(expected->hits.begin(), expected->hits.end(), TestBatchCollection::lessHit());
+
+    for (int32_t inOrder = 0; inOrder < 2; ++inOrder) {
+        TopScoreDocCollectorPtr collector = TopScoreDocCollector::create(10, inOrder == 1);
+        EXPECT_TRUE(collector->acceptsBatches());
+        newLucene<TermScorer>(weight, reader->termDocs(allTerm), searcher->getSimilarity(), reader->norms(FIELD))->score(collector);
+
+        TopDocsPtr topDocs = collector->topDocs();
+        EXPECT_EQ(200, topDocs->totalHits);
+        EXPECT_EQ(10, topDocs->scoreDocs.size());
+        for (int32_t i = 0; i < topDocs->scoreDocs.size(); ++i) {
+            EXPECT_EQ(expected->hits[i]->doc, topDocs->scoreDocs[i]->doc);
+            EXPECT_EQ(expected->hits[i]->score, topDocs->scoreDocs[i]->score);
+        }
+    }
+    searcher->close();
+}
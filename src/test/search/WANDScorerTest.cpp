@@ -0,0 +1,159 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "IndexReader.h"
+#include "IndexSearcher.h"
+#include "WhitespaceAnalyzer.h"
+#include "Document.h"
+#include "Field.h"
+#include "Term.h"
+#include "TermDocs.h"
+#include "TermQuery.h"
+#include "BooleanQuery.h"
+#include "TopScoreDocCollector.h"
+#include "TopDocs.h"
+#include "ScoreDoc.h"
+#include "Random.h"
+#include "Similarity.h"
+
+using namespace Lucene;
+
+/// Top hits found by skipping uncompetitive documents must be those of a full disjunction
+class WANDScorerTest : public LuceneTestFixture {
+public:
+    WANDScorerTest() {
+        RandomPtr random = newLucene<Random>(17);
+        directory = newLucene<RAMDirectory>();
+        IndexWriterPtr writer = newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthUNLIMITED);
+        writer->setUsePackedPostings(true);
+        writer->setMaxBufferedDocs(1000);
+        for (int32_t i = 0; i < 3000; ++i) {
+            DocumentPtr doc = newLucene<Document>();
+            String body;
+            addTerm(body, L"alpha", random->nextInt(3));
+            addTerm(body, L"beta", random->nextInt(4) == 0 ? random->nextInt(6) : 0);
+            addTerm(body, L"gamma", random->nextInt(50) == 0 ? 1 + random->nextInt(10) : 0);
+            addTerm(body, L"filler", random->nextInt(20)); // vary the norms
+            doc->add(newLucene<Field>(L"body", body, Field::STORE_NO, Field::INDEX_ANALYZED));
+            doc->add(newLucene<Field>(L"title", random->nextInt(10) == 0 ? L"alpha" : L"other", Field::STORE_NO, Field::INDEX_ANALYZED));
+            writer->addDocument(doc);
+        }
+        writer->close();
+    }
+
+    virtual ~WANDScorerTest() {
+    }
+
+protected:
+    DirectoryPtr directory;
+
+public:
+    static void addTerm(String& body, const String& term, int32_t freq) {
+        for (int32_t i = 0; i < freq; ++i) {
+            body += L" " + term;
+        }
+    }
+
+    static QueryPtr disjunction(const String& field1, const String& text1, const String& field2, const String& text2, bool disableCoord = false) {
+        BooleanQueryPtr query = newLucene<BooleanQuery>(disableCoord);
+        query->add(newLucene<TermQuery>(newLucene<Term>(field1, text1)), BooleanClause::SHOULD);
+        query->add(newLucene<TermQuery>(newLucene<Term>(field2, text2)), BooleanClause::SHOULD);
+        return query;
+    }
+
+    void checkTopHits(const QueryPtr& query, int32_t numHits) {
+        IndexSearcherPtr searcher = newLucene<IndexSearcher>(directory, true);
+        TopScoreDocCollectorPtr counting = TopScoreDocCollector::create(numHits, false);
+        searcher->search(query, counting);
+        TopScoreDocCollectorPtr skipping = TopScoreDocCollector::create(numHits, false, false);
+        searcher->search(query, skipping);
+
+        TopDocsPtr expected = counting->topDocs();
+        TopDocsPtr actual = skipping->topDocs();
+        EXPECT_TRUE(actual->totalHits <= expected->totalHits);
+        EXPECT_EQ(expected->scoreDocs.size(), actual->scoreDocs.size());
+        for (int32_t i = 0; i < expected->scoreDocs.size() && i < actual->scoreDocs.size(); ++i) {
+            EXPECT_EQ(expected->scoreDocs[i]->doc, actual->scoreDocs[i]->doc);
+            EXPECT_NEAR(expected->scoreDocs[i]->score, actual->scoreDocs[i]->score, 0.00001);
+        }
+        searcher->close();
+    }
+};
+
+TEST_F(WANDScorerTest, testMaxFreqs) {
+    IndexReaderPtr reader = IndexReader::open(directory, true);
+    Collection<IndexReaderPtr> segments = reader->getSequentialSubReaders();
+    EXPECT_TRUE(segments.size() > 1);
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        Collection<String> terms = newCollection<String>(L"alpha", L"beta", L"gamma", L"filler");
+        for (Collection<String>::iterator text = terms.begin(); text != terms.end(); ++text) {
+            TermDocsPtr termDocs = (*segment)->termDocs(newLucene<Term>(L"body", *text));
+            int32_t maxFreq = termDocs->maxFreq();
+            int32_t actualMax = 0;
+            int32_t blockEnd = -1;
+            while (termDocs->next()) {
+                actualMax = std::max(actualMax, termDocs->freq());
+                if (termDocs->doc() > blockEnd) {
+                    blockEnd = termDocs->advanceShallow(termDocs->doc());
+                }
+                EXPECT_TRUE(termDocs->doc() <= blockEnd);
+                EXPECT_TRUE(termDocs->freq() <= termDocs->blockMaxFreq());
+            }
+            EXPECT_EQ(actualMax, maxFreq);
+        }
+    }
+    reader->close();
+}
+
+TEST_F(WANDScorerTest, testTopHits) {
+    checkTopHits(disjunction(L"body", L"alpha", L"body", L"gamma"), 10);
+    checkTopHits(disjunction(L"body", L"beta", L"body", L"gamma"), 1);
+    checkTopHits(disjunction(L"body", L"alpha", L"title", L"alpha"), 10);
+    checkTopHits(disjunction(L"body", L"alpha", L"body", L"beta", true), 100);
+    checkTopHits(disjunction(L"body", L"alpha", L"body", L"missing"), 10);
+
+    BooleanQueryPtr query = newLucene<BooleanQuery>();
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"body", L"alpha")), BooleanClause::SHOULD);
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"body", L"beta")), BooleanClause::SHOULD);
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"body", L"gamma")), BooleanClause::SHOULD);
+    query->add(newLucene<TermQuery>(newLucene<Term>(L"body", L"filler")), BooleanClause::SHOULD);
+    checkTopHits(query, 10);
+    checkTopHits(query, 3000);
+}
+
+TEST_F(WANDScorerTest, testSkipsUncompetitiveDocs) {
+    IndexSearcherPtr searcher = newLucene<IndexSearcher>(directory, true);
+    QueryPtr query = disjunction(L"body", L"alpha", L"body", L"gamma");
+    TopScoreDocCollectorPtr counting = TopScoreDocCollector::create(5, true);
+    searcher->search(query, counting);
+    TopScoreDocCollectorPtr skipping = TopScoreDocCollector::create(5, true, false);
+    searcher->search(query, skipping);
+    EXPECT_TRUE(skipping->getTotalHits() < counting->getTotalHits());
+    searcher->close();
+}
+
+TEST_F(WANDScorerTest, testMaxNorm) {
+    IndexReaderPtr reader = IndexReader::open(directory, false);
+    Collection<IndexReaderPtr> segments = reader->getSequentialSubReaders();
+    for (Collection<IndexReaderPtr>::iterator segment = segments.begin(); segment != segments.end(); ++segment) {
+        double maxNorm = (*segment)->maxNorm(L"body");
+        EXPECT_EQ(IndexReader::decodeMaxNorm((*segment)->norms(L"body")), maxNorm);
+        EXPECT_EQ(1.0, (*segment)->maxNorm(L"missing"));
+    }
+    EXPECT_EQ(IndexReader::decodeMaxNorm(reader->norms(L"title")), reader->maxNorm(L"title"));
+
+    // changing a norm updates the bound kept with the norms
+    IndexReaderPtr segment = segments[0];
+    double before = segment->maxNorm(L"body");
+    reader->setNorm(0, L"body", (uint8_t)0xfe);
+    EXPECT_TRUE(segment->maxNorm(L"body") > before);
+    EXPECT_EQ(Similarity::decodeNorm((uint8_t)0xfe), segment->maxNorm(L"body"));
+    reader->close();
+}
@@ -77,6 +77,37 @@ TEST_F(BufferedIndexInputTest, testReadVInt) {
     EXPECT_EQ(indexInput.readVInt(), 201696456);
 }
 
+TEST_F(BufferedIndexInputTest, testReadVInts) {
+    Collection<int32_t> expected = Collection<int32_t>::newInstance();
+    for (int32_t i = 0; i < 300; ++i) {
+        // runs of single byte values broken up by wider ones
+        expected.add(i % 37 == 0 ? (i * 104729) : (i % 100));
+    }
+    expected.add(INT_MAX);
+
+    ByteArray inputBytes(ByteArray::newInstance(expected.size() * 5));
+    int32_t length = 0;
+    for (Collection<int32_t>::iterator value = expected.begin(); value != expected.end(); ++value) {
+        uint32_t i = (uint32_t)*value;
+        while ((i & ~0x7f) != 0) {
+            inputBytes[length++] = (uint8_t)((i & 0x7f) | 0x80);
+            i >>= 7;
+        }
+        inputBytes[length++] = (uint8_t)i;
+    }
+
+    // small buffer, so values straddle refills
+    TestableBufferedIndexInputRead indexInput(inputBytes.get(), length);
+    indexInput.setBufferSize(29);
+    EXPECT_EQ(expected[0], indexInput.readVInt());
+    Collection<int32_t> values = Collection<int32_t>::newInstance(expected.size() - 1);
+    indexInput.readVInts(&values[0], values.size());
+    for (int32_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(expected[i + 1], values[i]);
+    }
+    EXPECT_EQ(length, indexInput.getFilePointer());
+}
+
 TEST_F(BufferedIndexInputTest, testReadLong) {
     ByteArray inputBytes(ByteArray::newInstance(10));
     uint8_t input[8] = { 32, 43, 32, 96, 12, 54, 22, 96 };
@@ -16,6 +16,8 @@
 #include "Field.h"
 #include "Random.h"
 #include "FileUtils.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
 
 using namespace Lucene;
 
@@ -65,3 +67,50 @@ TEST_F(MMapDirectoryTest, testMmapIndex) {
 
     FileUtils::removeDirectory(storePathname);
 }
+
+TEST_F(MMapDirectoryTest, testReadValues) {
+    String storePathname(FileUtils::joinPath(getTempDir(), L"testLuceneMmapValues"));
+    MMapDirectoryPtr storeDirectory(newLucene<MMapDirectory>(storePathname));
+    storeDirectory->setPreload(true);
+    EXPECT_TRUE(storeDirectory->getPreload());
+
+    IndexOutputPtr output(storeDirectory->createOutput(L"values.tis"));
+    for (int32_t i = 0; i < 1000; ++i) {
+        output->writeVInt(i * 7919);
+        output->writeVLong((int64_t)i << 40);
+        output->writeInt(-i);
+    }
+    output->writeByte(42);
+    output->writeVInt(INT_MAX); // ends the file, so read without the fast path
+    output->close();
+
+    IndexInputPtr input(storeDirectory->openInput(L"values.tis"));
+    for (int32_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(i * 7919, input->readVInt());
+        EXPECT_EQ((int64_t)i << 40, input->readVLong());
+        EXPECT_EQ(-i, input->readInt());
+    }
+    int64_t end = input->getFilePointer();
+    EXPECT_EQ(42, input->readByte());
+    EXPECT_EQ(INT_MAX, input->readVInt());
+    EXPECT_EQ(input->length(), input->getFilePointer());
+    try {
+        input->readByte();
+    } catch (IOException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IO)(e));
+    }
+
+    IndexInputPtr clone(std::dynamic_pointer_cast<IndexInput>(input->clone()));
+    clone->seek(0);
+    IntArray values(IntArray::newInstance(3));
+    clone->readVInts(values.get(), 1);
+    EXPECT_EQ(0, values[0]);
+    clone->seek(end);
+    EXPECT_EQ(42, clone->readByte());
+    clone->readVInts(values.get(), 1);
+    EXPECT_EQ(INT_MAX, values[0]);
+
+    input->close();
+    storeDirectory->close();
+    FileUtils::removeDirectory(storePathname);
+}
@@ -22,6 +22,7 @@ MockRAMDirectory::MockRAMDirectory() {
     noDeleteOpenFile = true;
     preventDoubleWrite = true;
     crashed = false;
+    setPageSize(RAMOutputStream::BUFFER_SIZE); // keep size accounting fine grained for disk full tests
     init();
 }
 
@@ -32,6 +33,7 @@ MockRAMDirectory::MockRAMDirectory(const DirectoryPtr& dir) : RAMDirectory(dir)
     noDeleteOpenFile = true;
     preventDoubleWrite = true;
     crashed = false;
+    setPageSize(RAMOutputStream::BUFFER_SIZE); // keep size accounting fine grained for disk full tests
     init();
 }
 
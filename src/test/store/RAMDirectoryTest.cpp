@@ -22,6 +22,7 @@
 #include "MockRAMDirectory.h"
 #include "LuceneThread.h"
 #include "FileUtils.h"
+#include "StringUtils.h"
 
 using namespace Lucene;
 
@@ -247,3 +248,121 @@ TEST_F(RAMDirectoryTest, testHugeFile) {
         }
     }
 }
+
+TEST_F(RAMDirectoryTest, testPagedFiles) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    dir->setPageSize(4096);
+    EXPECT_EQ(4096, dir->getPageSize());
+
+    int64_t closedSize = 0;
+    for (int32_t file = 0; file < 3; ++file) {
+        String name(L"paged" + StringUtils::toString(file));
+        int32_t length = 10000 + file * 3000;
+        IndexOutputPtr out(dir->createOutput(name));
+        for (int32_t i = 0; i < length; ++i) {
+            out->writeByte((uint8_t)(i * 7 + file));
+        }
+        // open files are counted in whole pages, closed files in their exact length
+        int32_t pages = (length + 4095) / 4096;
+        EXPECT_EQ(closedSize + pages * 4096, dir->sizeInBytes());
+        out->close();
+        out->close();
+        closedSize += length;
+        EXPECT_EQ(closedSize, dir->sizeInBytes());
+        EXPECT_EQ(length, dir->fileLength(name));
+    }
+
+    for (int32_t file = 0; file < 3; ++file) {
+        String name(L"paged" + StringUtils::toString(file));
+        int32_t length = 10000 + file * 3000;
+        IndexInputPtr in(dir->openInput(name));
+        for (int32_t i = 0; i < length; ++i) {
+            EXPECT_EQ((uint8_t)(i * 7 + file), in->readByte());
+        }
+        in->seek(4095);
+        EXPECT_EQ((uint8_t)(4095 * 7 + file), in->readByte());
+        EXPECT_EQ((uint8_t)(4096 * 7 + file), in->readByte());
+        in->seek(length);
+        try {
+            in->readByte();
+        } catch (IOException& e) {
+            EXPECT_TRUE(check_exception(LuceneException::IO)(e));
+        }
+        in->close();
+    }
+
+    // an empty file holds no page once closed
+    IndexOutputPtr empty(dir->createOutput(L"empty"));
+    empty->close();
+    EXPECT_EQ(0, dir->fileLength(L"empty"));
+    EXPECT_EQ(closedSize, dir->sizeInBytes());
+    dir->close();
+}
+
+TEST_F(RAMDirectoryTest, testDefaultPageSize) {
+    RAMDirectoryPtr dir(newLucene<RAMDirectory>());
+    int32_t pageSize = dir->getPageSize();
+    EXPECT_EQ(RAMDirectory::DEFAULT_PAGE_SIZE, pageSize);
+
+    // a small file grows from a small buffer rather than taking a page
+    IndexOutputPtr small(dir->createOutput(L"small"));
+    for (int32_t i = 0; i < 3000; ++i) {
+        small->writeByte((uint8_t)(i * 3));
+    }
+    EXPECT_EQ(4096, dir->sizeInBytes());
+    small->close();
+    EXPECT_EQ(3000, dir->sizeInBytes());
+
+    // a file over several pages only has its last page cut on close
+    int64_t length = (int64_t)pageSize * 2 + 12345;
+    IndexOutputPtr large(dir->createOutput(L"large"));
+    ByteArray bytes(ByteArray::newInstance(1000));
+    for (int64_t written = 0; written < length; written += bytes.size()) {
+        int32_t count = (int32_t)std::min((int64_t)bytes.size(), length - written);
+        for (int32_t i = 0; i < count; ++i) {
+            bytes[i] = (uint8_t)((written + i) * 7);
+        }
+        large->writeBytes(bytes.get(), 0, count);
+    }
+    EXPECT_EQ(3000 + (int64_t)pageSize * 3, dir->sizeInBytes());
+    large->close();
+    EXPECT_EQ(3000 + length, dir->sizeInBytes());
+    EXPECT_EQ(length, dir->fileLength(L"large"));
+
+    IndexInputPtr in(dir->openInput(L"small"));
+    for (int32_t i = 0; i < 3000; ++i) {
+        EXPECT_EQ((uint8_t)(i * 3), in->readByte());
+    }
+    in->close();
+
+    in = dir->openInput(L"large");
+    ByteArray read(ByteArray::newInstance(1000));
+    for (int64_t pos = 0; pos < length; pos += read.size()) {
+        int32_t count = (int32_t)std::min((int64_t)read.size(), length - pos);
+        in->readBytes(read.get(), 0, count);
+        for (int32_t i = 0; i < count; ++i) {
+            EXPECT_EQ((uint8_t)((pos + i) * 7), read[i]);
+        }
+    }
+    in->seek(pageSize - 1);
+    EXPECT_EQ((uint8_t)((int64_t)(pageSize - 1) * 7), in->readByte());
+    EXPECT_EQ((uint8_t)((int64_t)pageSize * 7), in->readByte());
+    in->seek(length - 1);
+    EXPECT_EQ((uint8_t)((length - 1) * 7), in->readByte());
+    in->close();
+
+    // a file seeked back into its first buffer is rewritten in place
+    IndexOutputPtr rewritten(dir->createOutput(L"rewritten"));
+    for (int32_t i = 0; i < 5000; ++i) {
+        rewritten->writeByte(0);
+    }
+    rewritten->seek(10);
+    rewritten->writeByte(42);
+    rewritten->close();
+    in = dir->openInput(L"rewritten");
+    EXPECT_EQ(5000, in->length());
+    in->seek(10);
+    EXPECT_EQ(42, in->readByte());
+    in->close();
+    dir->close();
+}
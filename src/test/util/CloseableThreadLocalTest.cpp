@@ -44,3 +44,102 @@ TEST_F(CloseableThreadLocalTest, testDefaultValueWithoutSetting) {
     EXPECT_TRUE(!ctl.get());
     EXPECT_TRUE(!ctl.get());
 }
+
+namespace TestRecycle {
+
+class CountingThreadLocal : public CloseableThreadLocal<String> {
+public:
+    CountingThreadLocal(bool recycle) : CloseableThreadLocal<String>(recycle) {
+        created = 0;
+    }
+
+    virtual ~CountingThreadLocal() {
+    }
+
+    int32_t created;
+
+protected:
+    virtual std::shared_ptr<String> initialValue() {
+        ++created;
+        return newInstance<String>(TEST_VALUE);
+    }
+};
+
+DECLARE_SHARED_PTR(GetThread)
+
+class GetThread : public LuceneThread {
+public:
+    GetThread(CountingThreadLocal* tl) {
+        this->tl = tl;
+    }
+
+    virtual ~GetThread() {
+    }
+
+    LUCENE_CLASS(GetThread);
+
+public:
+    CountingThreadLocal* tl;
+    std::shared_ptr<String> value;
+
+    virtual void run() {
+        value = tl->get();
+    }
+};
+
+}
+
+/// An idle value is handed to a new thread instead of creating another one
+TEST_F(CloseableThreadLocalTest, testRecycleIdleValue) {
+    TestRecycle::CountingThreadLocal tl(true);
+    String* first = tl.get().get();
+
+    TestRecycle::GetThreadPtr thread = newLucene<TestRecycle::GetThread>(&tl);
+    thread->start();
+    thread->join();
+
+    EXPECT_EQ(1, tl.created);
+    EXPECT_EQ(first, thread->value.get());
+}
+
+/// A value still referenced by its owner must never be shared
+TEST_F(CloseableThreadLocalTest, testNoRecycleWhileInUse) {
+    TestRecycle::CountingThreadLocal tl(true);
+    std::shared_ptr<String> first = tl.get();
+
+    TestRecycle::GetThreadPtr thread = newLucene<TestRecycle::GetThread>(&tl);
+    thread->start();
+    thread->join();
+
+    EXPECT_EQ(2, tl.created);
+    EXPECT_NE(first.get(), thread->value.get());
+}
+
+TEST_F(CloseableThreadLocalTest, testNoRecycleByDefault) {
+    TestRecycle::CountingThreadLocal tl(false);
+    tl.get();
+
+    TestRecycle::GetThreadPtr thread = newLucene<TestRecycle::GetThread>(&tl);
+    thread->start();
+    thread->join();
+
+    EXPECT_EQ(2, tl.created);
+}
+
+/// Closing releases the values of every thread
+TEST_F(CloseableThreadLocalTest, testCloseReleasesAll) {
+    TestRecycle::CountingThreadLocal tl(false);
+    std::weak_ptr<String> weak(tl.get());
+
+    TestRecycle::GetThreadPtr thread = newLucene<TestRecycle::GetThread>(&tl);
+    thread->start();
+    thread->join();
+    std::weak_ptr<String> otherWeak(thread->value);
+    thread->value.reset();
+
+    tl.close();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_TRUE(otherWeak.expired());
+    tl.get();
+    EXPECT_EQ(3, tl.created);
+}
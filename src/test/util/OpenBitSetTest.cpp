@@ -235,6 +235,72 @@ TEST_F(OpenBitSetTest, testBitUtils) {
     }
 }
 
+static int64_t naivePop(int64_t word) {
+    int64_t count = 0;
+    for (int32_t i = 0; i < 64; ++i) {
+        count += (word >> i) & 1;
+    }
+    return count;
+}
+
+TEST_F(OpenBitSetTest, testBulkWordOps) {
+    randBitSet->setSeed(17);
+    for (int32_t numWords = 0; numWords < 40; ++numWords) {
+        Collection<int64_t> a = Collection<int64_t>::newInstance(numWords + 3);
+        Collection<int64_t> b = Collection<int64_t>::newInstance(numWords + 3);
+        for (int32_t i = 0; i < a.size(); ++i) {
+            a[i] = ((int64_t)randBitSet->nextInt() << 32) ^ (uint32_t)randBitSet->nextInt();
+            b[i] = ((int64_t)randBitSet->nextInt() << 32) ^ (uint32_t)randBitSet->nextInt();
+        }
+        int32_t offset = numWords % 3;
+
+        int64_t popA = 0;
+        int64_t popAnd = 0;
+        int64_t popOr = 0;
+        int64_t popAndNot = 0;
+        int64_t popXor = 0;
+        for (int32_t i = offset; i < offset + numWords; ++i) {
+            popA += naivePop(a[i]);
+            popAnd += naivePop(a[i] & b[i]);
+            popOr += naivePop(a[i] | b[i]);
+            popAndNot += naivePop(a[i] & ~b[i]);
+            popXor += naivePop(a[i] ^ b[i]);
+        }
+        EXPECT_EQ(popA, BitUtil::pop_array(&a[0], offset, numWords));
+        EXPECT_EQ(popAnd, BitUtil::pop_intersect(&a[0], &b[0], offset, numWords));
+        EXPECT_EQ(popOr, BitUtil::pop_union(&a[0], &b[0], offset, numWords));
+        EXPECT_EQ(popAndNot, BitUtil::pop_andnot(&a[0], &b[0], offset, numWords));
+        EXPECT_EQ(popXor, BitUtil::pop_xor(&a[0], &b[0], offset, numWords));
+
+        int64_t popBytes = 0;
+        const uint8_t* bytes = (const uint8_t*)&a[0];
+        for (int32_t i = 1; i < numWords * 8; ++i) {
+            popBytes += naivePop(bytes[i]);
+        }
+        EXPECT_EQ(popBytes, BitUtil::pop_bytes(bytes + 1, std::max(numWords * 8 - 1, 0)));
+
+        Collection<int64_t> c = Collection<int64_t>::newInstance(a.begin(), a.end());
+        BitUtil::and_array(&c[0], &b[0], offset, numWords);
+        Collection<int64_t> d = Collection<int64_t>::newInstance(a.begin(), a.end());
+        BitUtil::or_array(&d[0], &b[0], offset, numWords);
+        Collection<int64_t> e = Collection<int64_t>::newInstance(a.begin(), a.end());
+        BitUtil::andnot_array(&e[0], &b[0], offset, numWords);
+        Collection<int64_t> f = Collection<int64_t>::newInstance(a.begin(), a.end());
+        BitUtil::xor_array(&f[0], &b[0], offset, numWords);
+        for (int32_t i = 0; i < a.size(); ++i) {
+            bool inRange = (i >= offset && i < offset + numWords);
+            EXPECT_EQ(inRange ? (a[i] & b[i]) : a[i], c[i]);
+            EXPECT_EQ(inRange ? (a[i] | b[i]) : a[i], d[i]);
+            EXPECT_EQ(inRange ? (a[i] & ~b[i]) : a[i], e[i]);
+            EXPECT_EQ(inRange ? (a[i] ^ b[i]) : a[i], f[i]);
+        }
+    }
+
+    EXPECT_EQ(64, BitUtil::ntz((int64_t)0));
+    EXPECT_EQ(32, BitUtil::ntz((int32_t)0));
+    EXPECT_EQ(64, BitUtil::pop((int64_t)-1));
+}
+
 TEST_F(OpenBitSetTest, testHashCodeEquals) {
     OpenBitSetPtr bs1 = newLucene<OpenBitSet>(200);
     OpenBitSetPtr bs2 = newLucene<OpenBitSet>(64);
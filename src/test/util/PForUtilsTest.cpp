@@ -0,0 +1,72 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "PForUtils.h"
+#include "RAMFile.h"
+#include "RAMOutputStream.h"
+#include "RAMInputStream.h"
+#include "Random.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture PForUtilsTest;
+
+static int64_t checkRoundTrip(Collection<int32_t> values) {
+    int32_t count = values.size();
+    ByteArray scratch(ByteArray::newInstance(PForUtils::scratchSize(count)));
+    RAMFilePtr file(newLucene<RAMFile>());
+    RAMOutputStreamPtr out(newLucene<RAMOutputStream>(file));
+    PForUtils::encode(&values[0], count, out, scratch.get());
+    out->writeByte(42); // marks the end of the block
+    out->close();
+
+    RAMInputStreamPtr in(newLucene<RAMInputStream>(file));
+    IntArray decoded(IntArray::newInstance(count));
+    PForUtils::decode(in, decoded.get(), count, scratch.get());
+    for (int32_t i = 0; i < count; ++i) {
+        EXPECT_EQ(values[i], decoded[i]);
+    }
+    EXPECT_EQ(42, in->readByte());
+    return file->getLength() - 1;
+}
+
+TEST_F(PForUtilsTest, testConstant) {
+    Collection<int32_t> values(Collection<int32_t>::newInstance(PForUtils::BLOCK_SIZE));
+    EXPECT_EQ(2, checkRoundTrip(values)); // only the header is needed
+    for (int32_t i = 0; i < values.size(); ++i) {
+        values[i] = 5;
+    }
+    EXPECT_EQ(2 + PForUtils::BLOCK_SIZE * 3 / 8, checkRoundTrip(values));
+}
+
+TEST_F(PForUtilsTest, testExceptions) {
+    Collection<int32_t> values(Collection<int32_t>::newInstance(PForUtils::BLOCK_SIZE));
+    for (int32_t i = 0; i < values.size(); ++i) {
+        values[i] = i % 4;
+    }
+    values[17] = 1000000;
+    values[100] = INT_MAX;
+    // the outliers are patched in, the rest stays at two bits per value
+    EXPECT_TRUE(checkRoundTrip(values) < 2 + PForUtils::BLOCK_SIZE * 2 / 8 + 12);
+}
+
+TEST_F(PForUtilsTest, testRandom) {
+    RandomPtr random(newLucene<Random>(17));
+    for (int32_t iter = 0; iter < 200; ++iter) {
+        int32_t count = iter < 100 ? PForUtils::BLOCK_SIZE : 1 + random->nextInt(255);
+        int32_t maxBits = 1 + random->nextInt(30);
+        Collection<int32_t> values(Collection<int32_t>::newInstance(count));
+        for (int32_t i = 0; i < count; ++i) {
+            values[i] = random->nextInt() & ((1 << maxBits) - 1);
+            if (random->nextInt(20) == 0) {
+                values[i] = random->nextInt();
+            }
+        }
+        checkRoundTrip(values);
+    }
+}
@@ -0,0 +1,151 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "RoaringDocIdSet.h"
+#include "OpenBitSet.h"
+#include "OpenBitSetIterator.h"
+#include "Random.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture RoaringDocIdSetTest;
+
+static const int32_t MAX_DOC = 300000;
+
+static RandomPtr randRoaring = newLucene<Random>(123);
+
+/// Sets docs with the given probability, in runs of up to maxRun docs
+static OpenBitSetPtr randomBits(double density, int32_t maxRun) {
+    OpenBitSetPtr bits(newLucene<OpenBitSet>(MAX_DOC));
+    for (int32_t doc = 0; doc < MAX_DOC; ++doc) {
+        if (randRoaring->nextDouble() < density) {
+            int32_t run = 1 + randRoaring->nextInt(maxRun);
+            for (int32_t i = 0; i < run && doc < MAX_DOC; ++i, ++doc) {
+                bits->set(doc);
+            }
+        }
+    }
+    return bits;
+}
+
+static RoaringDocIdSetPtr toRoaring(const OpenBitSetPtr& bits) {
+    return newLucene<RoaringDocIdSet>(newLucene<OpenBitSetIterator>(bits), MAX_DOC);
+}
+
+static void checkEquals(const OpenBitSetPtr& expected, const RoaringDocIdSetPtr& actual) {
+    EXPECT_EQ(expected->cardinality(), actual->size());
+    DocIdSetIteratorPtr iterator(actual->iterator());
+    int32_t doc = -1;
+    while ((doc = expected->nextSetBit(doc + 1)) != -1) {
+        EXPECT_EQ(doc, iterator->nextDoc());
+        EXPECT_TRUE(actual->get(doc));
+    }
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, iterator->nextDoc());
+    for (int32_t i = 0; i < 1000; ++i) {
+        int32_t doc = randRoaring->nextInt(MAX_DOC);
+        EXPECT_EQ(expected->get(doc), actual->get(doc));
+    }
+}
+
+static void checkAdvance(const OpenBitSetPtr& expected, const RoaringDocIdSetPtr& actual) {
+    DocIdSetIteratorPtr iterator(actual->iterator());
+    int32_t doc = -1;
+    while (doc != DocIdSetIterator::NO_MORE_DOCS) {
+        int32_t target = doc + 1 + randRoaring->nextInt(randRoaring->nextInt(2) == 0 ? 10 : 100000);
+        int32_t next = target < MAX_DOC ? expected->nextSetBit(target) : -1;
+        doc = iterator->advance(target);
+        EXPECT_EQ(next == -1 ? DocIdSetIterator::NO_MORE_DOCS : next, doc);
+    }
+}
+
+TEST_F(RoaringDocIdSetTest, testRandomSets) {
+    double densities[] = {0.0, 0.0001, 0.01, 0.1, 0.5, 0.99};
+    int32_t maxRuns[] = {1, 200};
+    for (int32_t i = 0; i < 6; ++i) {
+        for (int32_t j = 0; j < 2; ++j) {
+            OpenBitSetPtr bits(randomBits(densities[i], maxRuns[j]));
+            RoaringDocIdSetPtr set(toRoaring(bits));
+            checkEquals(bits, set);
+            checkAdvance(bits, set);
+        }
+    }
+}
+
+TEST_F(RoaringDocIdSetTest, testIntersectAndUnion) {
+    double densities[] = {0.001, 0.05, 0.6};
+    int32_t maxRuns[] = {1, 100};
+    for (int32_t i = 0; i < 3; ++i) {
+        for (int32_t j = 0; j < 3; ++j) {
+            OpenBitSetPtr a(randomBits(densities[i], maxRuns[i % 2]));
+            OpenBitSetPtr b(randomBits(densities[j], maxRuns[(j + 1) % 2]));
+            RoaringDocIdSetPtr setA(toRoaring(a));
+            RoaringDocIdSetPtr setB(toRoaring(b));
+
+            OpenBitSetPtr intersection(std::dynamic_pointer_cast<OpenBitSet>(a->clone()));
+            intersection->intersect(b);
+            checkEquals(intersection, setA->intersect(setB));
+
+            OpenBitSetPtr bitsUnion(std::dynamic_pointer_cast<OpenBitSet>(a->clone()));
+            bitsUnion->_union(b);
+            checkEquals(bitsUnion, setA->_union(setB));
+        }
+    }
+}
+
+TEST_F(RoaringDocIdSetTest, testContainers) {
+    // a sparse block, a dense block and a block of a few long runs
+    RoaringDocIdSetBuilderPtr builder(newLucene<RoaringDocIdSetBuilder>(MAX_DOC));
+    OpenBitSetPtr bits(newLucene<OpenBitSet>(MAX_DOC));
+    for (int32_t doc = 5; doc < 65536; doc += 1000) {
+        builder->add(doc);
+        builder->add(doc);
+        bits->set(doc);
+    }
+    for (int32_t doc = 65536; doc < 2 * 65536; doc += 3) {
+        builder->add(doc);
+        bits->set(doc);
+    }
+    for (int32_t doc = 2 * 65536; doc < 3 * 65536; ++doc) {
+        if ((doc / 10000) % 2 == 0) {
+            builder->add(doc);
+            bits->set(doc);
+        }
+    }
+    builder->add(MAX_DOC - 1);
+    bits->set(MAX_DOC - 1);
+    RoaringDocIdSetPtr set(builder->build());
+    checkEquals(bits, set);
+    checkAdvance(bits, set);
+
+    // only the dense block is a bitmap
+    EXPECT_TRUE(set->sizeInBytes() < 2 * 8192);
+
+    try {
+        builder = newLucene<RoaringDocIdSetBuilder>(MAX_DOC);
+        builder->add(10);
+        builder->add(9);
+        FAIL() << "docs must be added in order";
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+}
+
+TEST_F(RoaringDocIdSetTest, testSparseSizeInBytes) {
+    OpenBitSetPtr bits(randomBits(0.001, 1));
+    RoaringDocIdSetPtr set(toRoaring(bits));
+    EXPECT_TRUE(set->sizeInBytes() < MAX_DOC / 8 / 4);
+    EXPECT_TRUE(set->isCacheable());
+}
+
+TEST_F(RoaringDocIdSetTest, testEmpty) {
+    RoaringDocIdSetPtr set(newLucene<RoaringDocIdSetBuilder>(MAX_DOC)->build());
+    EXPECT_EQ(0, set->size());
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, set->iterator()->nextDoc());
+    EXPECT_EQ(DocIdSetIterator::NO_MORE_DOCS, set->iterator()->advance(70000));
+    EXPECT_FALSE(set->get(0));
+}
@@ -0,0 +1,206 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "SearchArena.h"
+#include "RAMDirectory.h"
+#include "IndexWriter.h"
+#include "WhitespaceAnalyzer.h"
+#include "IndexSearcher.h"
+#include "Document.h"
+#include "Field.h"
+#include "TermQuery.h"
+#include "Term.h"
+#include "ScoreDoc.h"
+#include "TopDocs.h"
+#include "IndexReader.h"
+#include "LuceneThread.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture SearchArenaTest;
+
+namespace TestSearchArena {
+
+/// Installs an arena and checks that it is the one the thread sees, over and over
+class ScopeThread : public LuceneThread {
+public:
+    ScopeThread() {
+        failures = 0;
+    }
+
+    virtual ~ScopeThread() {
+    }
+
+    LUCENE_CLASS(ScopeThread);
+
+    int32_t failures;
+
+    virtual void run() {
+        SearchArena arena;
+        for (int32_t i = 0; i < 1000; ++i) {
+            {
+                SearchArena::Scope scope(arena);
+                SearchArena* current = SearchArena::current();
+                // a thread whose slots are all taken falls back to the heap
+                if (current != &arena && current != NULL) {
+                    ++failures;
+                }
+            }
+            if (SearchArena::current() != NULL) {
+                ++failures;
+            }
+            LuceneThread::threadYield();
+        }
+    }
+};
+
+typedef std::shared_ptr<ScopeThread> ScopeThreadPtr;
+
+}
+
+TEST_F(SearchArenaTest, testScope) {
+    SearchArena arena;
+    EXPECT_FALSE(SearchArena::current());
+    {
+        SearchArena::Scope scope(arena);
+        EXPECT_EQ(&arena, SearchArena::current());
+        SearchArena nested;
+        {
+            SearchArena::Scope nestedScope(nested);
+            EXPECT_EQ(&nested, SearchArena::current());
+        }
+        EXPECT_EQ(&arena, SearchArena::current());
+        {
+            SearchArena::Suspend suspend;
+            EXPECT_TRUE(suspend.isSuspending());
+            EXPECT_FALSE(SearchArena::current());
+        }
+        EXPECT_EQ(&arena, SearchArena::current());
+    }
+    EXPECT_FALSE(SearchArena::current());
+    SearchArena::Suspend suspend;
+    EXPECT_FALSE(suspend.isSuspending());
+}
+
+TEST_F(SearchArenaTest, testScopesOnManyThreads) {
+    Collection<TestSearchArena::ScopeThreadPtr> threads(Collection<TestSearchArena::ScopeThreadPtr>::newInstance(20));
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i] = newLucene<TestSearchArena::ScopeThread>();
+        threads[i]->start();
+    }
+    // a thread without a scope sees no arena while the others have theirs
+    for (int32_t i = 0; i < 1000; ++i) {
+        EXPECT_FALSE(SearchArena::current());
+    }
+    for (int32_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+        EXPECT_EQ(0, threads[i]->failures);
+    }
+}
+
+TEST_F(SearchArenaTest, testReuseBlocks) {
+    SearchArena arena(4096);
+    {
+        SearchArena::Scope scope(arena);
+        Collection<ScoreDocPtr> docs(Collection<ScoreDocPtr>::newInstance());
+        for (int32_t i = 0; i < 1000; ++i) {
+            docs.add(newLucene<ScoreDoc>(i, (double)i));
+        }
+        EXPECT_TRUE(arena.getBytesUsed() > 1000 * (int64_t)sizeof(ScoreDoc));
+        EXPECT_TRUE(arena.getNumBlocks() > 1);
+        for (int32_t i = 0; i < 1000; ++i) {
+            EXPECT_EQ(i, docs[i]->doc);
+        }
+    }
+    int32_t numBlocks = arena.getNumBlocks();
+
+    // every object is gone, so the blocks are rewound
+    arena.reset();
+    EXPECT_EQ(0, arena.getBytesUsed());
+    EXPECT_EQ(numBlocks, arena.getNumBlocks());
+
+    // a live object keeps its blocks, the arena starts over with new ones
+    ScoreDocPtr kept;
+    {
+        SearchArena::Scope scope(arena);
+        kept = newLucene<ScoreDoc>(7, 1.0);
+    }
+    arena.reset();
+    EXPECT_EQ(0, arena.getNumBlocks());
+    EXPECT_EQ(7, kept->doc);
+}
+
+TEST_F(SearchArenaTest, testObjectsOutliveArena) {
+    ScoreDocPtr doc;
+    {
+        SearchArena arena(1024);
+        SearchArena::Scope scope(arena);
+        doc = newLucene<ScoreDoc>(42, 2.0);
+    }
+    EXPECT_EQ(42, doc->doc);
+    EXPECT_EQ(2.0, doc->score);
+    doc.reset();
+}
+
+TEST_F(SearchArenaTest, testSearch) {
+    RAMDirectoryPtr directory(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    for (int32_t i = 0; i < 100; ++i) {
+        DocumentPtr doc(newLucene<Document>());
+        doc->add(newLucene<Field>(L"body", i % 3 == 0 ? L"three" : L"other", Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->close();
+    IndexSearcherPtr searcher(newLucene<IndexSearcher>(directory, true));
+    TopDocsPtr expected(searcher->search(newLucene<TermQuery>(newLucene<Term>(L"body", L"three")), 10));
+
+    SearchArena arena;
+    for (int32_t request = 0; request < 3; ++request) {
+        {
+            SearchArena::Scope scope(arena);
+            TopDocsPtr topDocs(searcher->search(newLucene<TermQuery>(newLucene<Term>(L"body", L"three")), 10));
+            EXPECT_EQ(expected->totalHits, topDocs->totalHits);
+            EXPECT_EQ(expected->scoreDocs.size(), topDocs->scoreDocs.size());
+            for (int32_t i = 0; i < topDocs->scoreDocs.size(); ++i) {
+                EXPECT_EQ(expected->scoreDocs[i]->doc, topDocs->scoreDocs[i]->doc);
+                EXPECT_EQ(expected->scoreDocs[i]->score, topDocs->scoreDocs[i]->score);
+            }
+            EXPECT_TRUE(arena.getBytesUsed() > 0);
+        }
+        arena.reset();
+    }
+    searcher->close();
+}
+
+TEST_F(SearchArenaTest, testCachedTermsReleaseArena) {
+    RAMDirectoryPtr directory(newLucene<RAMDirectory>());
+    IndexWriterPtr writer(newLucene<IndexWriter>(directory, newLucene<WhitespaceAnalyzer>(), true, IndexWriter::MaxFieldLengthLIMITED));
+    for (int32_t i = 0; i < 500; ++i) {
+        DocumentPtr doc(newLucene<Document>());
+        doc->add(newLucene<Field>(L"body", L"t" + StringUtils::toString(i), Field::STORE_NO, Field::INDEX_ANALYZED));
+        writer->addDocument(doc);
+    }
+    writer->close();
+    IndexReaderPtr reader(IndexReader::open(directory, true));
+
+    // the first lookup creates the thread's terms enum and every lookup fills the term info cache
+    SearchArena arena;
+    for (int32_t request = 0; request < 500; request += 3) {
+        {
+            SearchArena::Scope scope(arena);
+            EXPECT_EQ(1, reader->docFreq(newLucene<Term>(L"body", L"t" + StringUtils::toString(request))));
+        }
+        // nothing from the request is kept, so the blocks are rewound instead of being handed over
+        arena.reset();
+        EXPECT_EQ(1, arena.getNumBlocks());
+    }
+    for (int32_t request = 0; request < 500; request += 3) {
+        EXPECT_EQ(1, reader->docFreq(newLucene<Term>(L"body", L"t" + StringUtils::toString(request))));
+    }
+    reader->close();
+}
@@ -0,0 +1,214 @@
+/////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2009-2014 Alan Wright. All rights reserved.
+// Distributable under the terms of either the Apache License (Version 2.0)
+// or the GNU Lesser General Public License.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "TestInc.h"
+#include "LuceneTestFixture.h"
+#include "ThreadPool.h"
+
+using namespace Lucene;
+
+typedef LuceneTestFixture ThreadPoolTest;
+
+namespace TestThreadPool {
+
+class SquareTask : public ThreadPoolCallable<int32_t> {
+public:
+    SquareTask(int32_t value = 0) {
+        this->value = value;
+    }
+
+    virtual ~SquareTask() {
+    }
+
+    int32_t value;
+
+    virtual int32_t call() {
+        return value * value;
+    }
+};
+
+/// Sums 1..n by forking one sub-task per value from inside a worker
+class ForkTask : public ThreadPoolCallable<int32_t> {
+public:
+    ForkTask(const ThreadPoolPtr& pool, int32_t n) {
+        this->pool = pool;
+        this->n = n;
+    }
+
+    virtual ~ForkTask() {
+    }
+
+    ThreadPoolPtr pool;
+    int32_t n;
+
+    virtual int32_t call() {
+        std::vector<SquareTask> tasks(n);
+        for (int32_t i = 0; i < n; ++i) {
+            tasks[i].value = i + 1;
+            pool->submit(&tasks[i]);
+        }
+        int32_t sum = 0;
+        for (int32_t i = 0; i < n; ++i) {
+            sum += tasks[i].get();
+        }
+        return sum;
+    }
+};
+
+class FailingTask : public ThreadPoolCallable<int32_t> {
+public:
+    virtual ~FailingTask() {
+    }
+
+    virtual int32_t call() {
+        boost::throw_exception(IllegalStateException(L"task failed"));
+        return 0;
+    }
+};
+
+/// Throws something other than a LuceneException
+class ForeignFailingTask : public ThreadPoolCallable<int32_t> {
+public:
+    ForeignFailingTask(bool standard = true) {
+        this->standard = standard;
+    }
+
+    virtual ~ForeignFailingTask() {
+    }
+
+    bool standard;
+
+    virtual int32_t call() {
+        if (standard) {
+            throw std::runtime_error("task failed");
+        }
+        throw 42;
+    }
+};
+
+/// Joins a failing sub-task from inside a worker
+class JoinFailingTask : public ThreadPoolCallable<int32_t> {
+public:
+    JoinFailingTask(const ThreadPoolPtr& pool) {
+        this->pool = pool;
+    }
+
+    virtual ~JoinFailingTask() {
+    }
+
+    ThreadPoolPtr pool;
+
+    virtual int32_t call() {
+        ForeignFailingTask task;
+        pool->submit(&task);
+        return task.get();
+    }
+};
+
+static int32_t answer() {
+    return 42;
+}
+
+static int32_t closed() {
+    boost::throw_exception(AlreadyClosedException(L"closed"));
+    return 0;
+}
+
+}
+
+TEST_F(ThreadPoolTest, testTypedTasks) {
+    ThreadPoolPtr pool(newLucene<ThreadPool>(3));
+    EXPECT_EQ(3, pool->getSize());
+
+    std::vector<TestThreadPool::SquareTask> tasks(100);
+    for (int32_t i = 0; i < 100; ++i) {
+        tasks[i].value = i;
+        pool->submit(&tasks[i]);
+    }
+    for (int32_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(i * i, tasks[i].get());
+        EXPECT_TRUE(tasks[i].isDone());
+    }
+}
+
+TEST_F(ThreadPoolTest, testNestedTasks) {
+    ThreadPoolPtr pool(newLucene<ThreadPool>(2));
+    std::vector<TestThreadPool::ForkTask*> tasks;
+    for (int32_t i = 0; i < 8; ++i) {
+        tasks.push_back(new TestThreadPool::ForkTask(pool, 10));
+        pool->submit(tasks.back());
+    }
+    for (int32_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(385, tasks[i]->get());
+        delete tasks[i];
+    }
+}
+
+TEST_F(ThreadPoolTest, testException) {
+    ThreadPoolPtr pool(newLucene<ThreadPool>(1));
+    TestThreadPool::FailingTask task;
+    pool->submit(&task);
+    try {
+        task.get();
+    } catch (IllegalStateException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalState)(e));
+    }
+    EXPECT_TRUE(task.isDone());
+}
+
+TEST_F(ThreadPoolTest, testForeignException) {
+    ThreadPoolPtr pool(newLucene<ThreadPool>(2));
+    TestThreadPool::ForeignFailingTask standardTask(true);
+    TestThreadPool::ForeignFailingTask unknownTask(false);
+    TestThreadPool::JoinFailingTask joinTask(pool);
+    pool->submit(&standardTask);
+    pool->submit(&unknownTask);
+    pool->submit(&joinTask);
+    try {
+        standardTask.get();
+        FAIL() << "expected RuntimeException";
+    } catch (RuntimeException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::Runtime)(e));
+    }
+    try {
+        unknownTask.get();
+        FAIL() << "expected RuntimeException";
+    } catch (RuntimeException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::Runtime)(e));
+    }
+    try {
+        joinTask.get();
+        FAIL() << "expected RuntimeException";
+    } catch (RuntimeException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::Runtime)(e));
+    }
+    EXPECT_TRUE(standardTask.isDone());
+    EXPECT_TRUE(unknownTask.isDone());
+    EXPECT_TRUE(joinTask.isDone());
+}
+
+TEST_F(ThreadPoolTest, testScheduleTask) {
+    FuturePtr future(ThreadPool::getInstance()->scheduleTask(TestThreadPool::answer));
+    EXPECT_EQ(42, future->get<int32_t>());
+}
+
+TEST_F(ThreadPoolTest, testScheduleTaskException) {
+    FuturePtr future(ThreadPool::getInstance()->scheduleTask(TestThreadPool::closed));
+    try {
+        future->get<int32_t>();
+        FAIL() << "expected AlreadyClosedException";
+    } catch (AlreadyClosedException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::AlreadyClosed)(e));
+    }
+}
+
+TEST_F(ThreadPoolTest, testInvalidSize) {
+    try {
+        newLucene<ThreadPool>(0);
+    } catch (IllegalArgumentException& e) {
+        EXPECT_TRUE(check_exception(LuceneException::IllegalArgument)(e));
+    }
+}